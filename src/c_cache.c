@@ -0,0 +1,506 @@
+/*
+
+Compile cache.
+
+Keeps the result of compiling a template (the bcode and process design in compiled_template, plus the user identifiers used by
+ the debug template) in a file in the user data directory, named after a hash of the preprocessed source.
+When compile() is asked to compile source that preprocesses to the same scode as a cached file, the result is loaded from
+ the cache instead of running the design parser (c_fix.c), the compiler and the code generator.
+
+The key is a 64-bit FNV-1a hash of:
+ - the scode text and its source line numbers (so an edit that only moves code to different lines still gives a new key,
+    as the bcode's src_line array would be different)
+ - whether the template is locked (c_fix.c ignores the design of a locked template)
+ - whether the optimiser (c_optimise.c) is turned on
+ - COMPILE_CACHE_VERSION (in c_header.h) and the sizes of the structures written to the file
+ - the identity of the compiler itself: the size and modification time of the game's executable, and the time this file was compiled.
+    So a rebuilt game never uses results cached by an earlier build, even if COMPILE_CACHE_VERSION wasn't increased.
+    If the executable can't be found, the cache isn't used at all.
+Since #included files are copied into the scode by the preprocessor, changes to them also change the key.
+
+The log lines written while compiling (compiler warnings and the bcode size summary) are saved in the file as well, and written to
+ the log again when the file is loaded, so a cache hit looks the same in the log as a compilation.
+
+Only successful compilations are cached. Any problem reading or writing a cache file just means that the source is compiled normally.
+
+load_compile_cache() only reads cache_state, so it can run outside the main thread (see compile_templates() in c_compile.c).
+ save_compile_cache() changes cache_state and must be called from the main thread.
+
+The directory is kept to COMPILE_CACHE_MAX_FILES files: when there are more (checked at startup and after saving), the oldest are
+ removed. Results cached by an earlier build are never used again, so this also clears them out over time.
+ Temporary files left by a save that didn't finish are removed at startup.
+
+*/
+
+#include <allegro5/allegro.h>
+#include "m_config.h"
+#include "g_header.h"
+#include "c_header.h"
+
+#include "g_misc.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "e_log.h"
+#include "e_slider.h"
+#include "e_header.h"
+#include "c_keywords.h"
+#include "c_cache.h"
+
+
+#define COMPILE_CACHE_PATH_LENGTH 300
+#define COMPILE_CACHE_MAX_FILES 256
+// a .tmp file older than this (in seconds) is left over from a save that didn't finish (a newer one may be being written by another instance of the game)
+#define COMPILE_CACHE_TEMP_FILE_AGE 3600
+
+struct compile_cache_header_struct
+{
+ char id [4]; // "LCcc"
+ int version; // COMPILE_CACHE_VERSION
+ unsigned long long key;
+ int scode_length; // checked as well as the key, in case of a hash collision
+ int template_size; // sizeof(struct template_struct)
+ int identifier_size; // sizeof(struct identifierstruct)
+ int user_identifiers; // number of identifiers saved after compiled_template
+ int log_lines; // number of log lines saved after the identifiers
+};
+
+// a line written to the log by the compiler
+struct compile_cache_log_line_struct
+{
+ char text [LOG_LINE_LENGTH];
+ int colour;
+ int source_line; // -1 if the line can't be clicked on to go to the source
+};
+
+struct compile_cache_state_struct
+{
+ int available; // 0 if init_compile_cache() hasn't been called or couldn't find a directory or the executable
+ char dir_path [COMPILE_CACHE_PATH_LENGTH]; // includes the trailing separator
+ unsigned long long compiler_id; // hash of the executable's size and modification time (see compile_cache_key())
+ int files; // number of cache files in the directory (counted by prune_compile_cache(), then increased by save_compile_cache())
+};
+
+struct compile_cache_file_struct
+{
+ char path [COMPILE_CACHE_PATH_LENGTH];
+ time_t mtime;
+};
+
+static struct compile_cache_state_struct cache_state;
+
+static unsigned long long compile_cache_key(struct cstatestruct* cstate);
+static unsigned long long hash_bytes(unsigned long long hash, const void* data, int length);
+static int compile_cache_file_path(char* file_path, unsigned long long key);
+static int find_compiler_id(void);
+static void prune_compile_cache(void);
+static int compare_cache_file_age(const void* a, const void* b);
+static void replay_compile_cache_log(struct cstatestruct* cstate, struct compile_cache_log_line_struct* log_lines, int lines);
+
+// Call once at startup (after al_init). If this isn't called, the cache isn't used.
+void init_compile_cache(void)
+{
+
+ cache_state.available = 0;
+
+ ALLEGRO_PATH *cache_path = al_get_standard_path(ALLEGRO_USER_DATA_PATH);
+ if (cache_path == NULL)
+		return;
+ al_append_path_component(cache_path, "compile_cache");
+
+ const char* dir_string = al_path_cstr(cache_path, ALLEGRO_NATIVE_PATH_SEP);
+
+ if (al_make_directory(dir_string)
+		&& strlen(dir_string) < COMPILE_CACHE_PATH_LENGTH - 24) // leaves room for the file name
+	{
+  strcpy(cache_state.dir_path, dir_string);
+  cache_state.available = find_compiler_id();
+	}
+
+ al_destroy_path(cache_path);
+
+ if (cache_state.available)
+		prune_compile_cache();
+
+}
+
+// Works out cache_state.compiler_id. Returns 1 on success, 0 if the executable couldn't be found.
+static int find_compiler_id(void)
+{
+
+ ALLEGRO_PATH* executable_path = al_get_standard_path(ALLEGRO_EXENAME_PATH);
+
+ if (executable_path == NULL)
+		return 0;
+
+ ALLEGRO_FS_ENTRY* executable_entry = al_create_fs_entry(al_path_cstr(executable_path, ALLEGRO_NATIVE_PATH_SEP));
+ al_destroy_path(executable_path);
+
+ if (executable_entry == NULL)
+		return 0;
+
+ if (!al_fs_entry_exists(executable_entry))
+	{
+		al_destroy_fs_entry(executable_entry);
+		return 0;
+	}
+
+ unsigned long long values [2];
+
+ values [0] = (unsigned long long) al_get_fs_entry_size(executable_entry);
+ values [1] = (unsigned long long) al_get_fs_entry_mtime(executable_entry);
+
+ al_destroy_fs_entry(executable_entry);
+
+ const char* build_time = __DATE__ " " __TIME__;
+
+ cache_state.compiler_id = hash_bytes(14695981039346656037ULL, values, sizeof(values));
+ cache_state.compiler_id = hash_bytes(cache_state.compiler_id, build_time, strlen(build_time));
+
+ return 1;
+
+}
+
+// Counts the files in the cache directory, removes old temporary files, and removes the oldest cache files if there are too many.
+static void prune_compile_cache(void)
+{
+
+ ALLEGRO_FS_ENTRY* dir_entry = al_create_fs_entry(cache_state.dir_path);
+
+ if (dir_entry == NULL)
+		return;
+
+ if (!al_open_directory(dir_entry))
+	{
+		al_destroy_fs_entry(dir_entry);
+		return;
+	}
+
+ int files_max = COMPILE_CACHE_MAX_FILES * 2;
+ struct compile_cache_file_struct* files = malloc(sizeof(struct compile_cache_file_struct) * files_max);
+
+ if (files == NULL)
+	{
+		al_close_directory(dir_entry);
+		al_destroy_fs_entry(dir_entry);
+		return;
+	}
+
+ int file_count = 0;
+ int i;
+ time_t now = time(NULL);
+ ALLEGRO_FS_ENTRY* file_entry;
+
+ while((file_entry = al_read_directory(dir_entry)) != NULL)
+	{
+		const char* name = al_get_fs_entry_name(file_entry);
+		int name_length = strlen(name);
+		if ((al_get_fs_entry_mode(file_entry) & ALLEGRO_FILEMODE_ISFILE)
+			&& name_length < COMPILE_CACHE_PATH_LENGTH)
+		{
+			if (name_length > 4
+				&& strcmp(name + name_length - 4, ".tmp") == 0)
+			{
+				if (now - al_get_fs_entry_mtime(file_entry) > COMPILE_CACHE_TEMP_FILE_AGE)
+					al_remove_fs_entry(file_entry);
+			}
+			 else
+				{
+// if there are very many files, the ones found after files_max are left alone until the next prune
+					if (name_length > 4
+						&& strcmp(name + name_length - 4, ".bin") == 0
+						&& file_count < files_max)
+					{
+						strcpy(files [file_count].path, name);
+						files [file_count].mtime = al_get_fs_entry_mtime(file_entry);
+						file_count ++;
+					}
+				}
+		}
+		al_destroy_fs_entry(file_entry);
+	}
+
+ al_close_directory(dir_entry);
+ al_destroy_fs_entry(dir_entry);
+
+ cache_state.files = file_count;
+
+ if (file_count > COMPILE_CACHE_MAX_FILES)
+	{
+// removes the oldest files, leaving room for some new ones so that this doesn't have to be done after every save:
+		qsort(files, file_count, sizeof(struct compile_cache_file_struct), compare_cache_file_age);
+		int remove_files = file_count - (COMPILE_CACHE_MAX_FILES * 3) / 4;
+		for (i = 0; i < remove_files; i ++)
+		{
+			if (remove(files [i].path) == 0)
+				cache_state.files --;
+		}
+	}
+
+ free(files);
+
+}
+
+// for qsort: oldest first
+static int compare_cache_file_age(const void* a, const void* b)
+{
+
+ const struct compile_cache_file_struct* file_a = a;
+ const struct compile_cache_file_struct* file_b = b;
+
+ if (file_a->mtime < file_b->mtime)
+		return -1;
+ if (file_a->mtime > file_b->mtime)
+		return 1;
+ return 0;
+
+}
+
+// Call after the source has been preprocessed into cstate->scode.
+// If there's a matching cache file, loads it into compiled_template and the identifier list, writes the log lines saved with it
+//  to the log and returns 1.
+// Otherwise returns 0 (and the source should be compiled, then save_compile_cache() called if it compiled successfully).
+int load_compile_cache(struct cstatestruct* cstate)
+{
+
+ struct compile_cache_header_struct header;
+ char file_path [COMPILE_CACHE_PATH_LENGTH];
+ FILE* file;
+
+ if (!cache_state.available)
+		return 0;
+
+ cstate->cache_key = compile_cache_key(cstate);
+
+ if (!compile_cache_file_path(file_path, cstate->cache_key))
+		return 0;
+
+ file = fopen(file_path, "rb");
+
+ if (file == NULL)
+		return 0;
+
+ if (fread(&header, sizeof(struct compile_cache_header_struct), 1, file) != 1
+		|| strncmp(header.id, "LCcc", 4) != 0
+		|| header.version != COMPILE_CACHE_VERSION
+		|| header.key != cstate->cache_key
+		|| header.scode_length != cstate->scode.text_length
+		|| header.template_size != (int) sizeof(struct template_struct)
+		|| header.identifier_size != (int) sizeof(struct identifierstruct)
+		|| header.user_identifiers < 0
+		|| header.user_identifiers >= IDENTIFIERS - USER_IDENTIFIERS
+		|| header.log_lines < 0
+		|| header.log_lines >= LOG_LINES)
+	{
+		fclose(file);
+		return 0;
+	}
+
+// read the template into a temporary struct so that compiled_template isn't left half-written if the file is truncated:
+ struct template_struct* cached_template = malloc(sizeof(struct template_struct));
+ struct compile_cache_log_line_struct log_lines [LOG_LINES];
+
+ if (cached_template == NULL)
+	{
+		fclose(file);
+		return 0;
+	}
+
+ if (fread(cached_template, sizeof(struct template_struct), 1, file) != 1
+		|| (header.user_identifiers > 0
+		 && fread(&cstate->identifier [USER_IDENTIFIERS], sizeof(struct identifierstruct), header.user_identifiers, file) != header.user_identifiers)
+		|| (header.log_lines > 0
+		 && fread(log_lines, sizeof(struct compile_cache_log_line_struct), header.log_lines, file) != header.log_lines))
+	{
+// the identifier list may have been partly overwritten, but it isn't used again until init_compiler() resets it
+		cstate->identifier [USER_IDENTIFIERS].type = CTOKEN_TYPE_NONE;
+		free(cached_template);
+		fclose(file);
+		return 0;
+	}
+
+ fclose(file);
+
+// these fields were set by compile() before the cached compilation and shouldn't be taken from the file:
+ cached_template->source_edit = cstate->templ->source_edit;
+ cached_template->active = cstate->templ->active;
+ cached_template->locked = cstate->templ->locked;
+ cached_template->player_index = cstate->templ->player_index;
+ cached_template->template_index = cstate->templ->template_index;
+
+ *cstate->templ = *cached_template;
+ free(cached_template);
+
+ cstate->identifier [USER_IDENTIFIERS + header.user_identifiers].type = CTOKEN_TYPE_NONE;
+
+ write_line_to_log_buffer(cstate->log, "Loaded from compile cache.", MLOG_COL_COMPILER);
+ replay_compile_cache_log(cstate, log_lines, header.log_lines);
+
+ return 1;
+
+}
+
+// writes log lines loaded from a cache file to cstate's log buffer, as if they had just been written by the compiler
+static void replay_compile_cache_log(struct cstatestruct* cstate, struct compile_cache_log_line_struct* log_lines, int lines)
+{
+
+ int i;
+
+ for (i = 0; i < lines; i ++)
+	{
+// the text can't contain a format string (write_to_log() just copies it), but make sure it's terminated:
+		log_lines [i].text [LOG_LINE_LENGTH - 1] = '\0';
+		start_log_buffer_line(cstate->log, log_lines [i].colour);
+		if (log_lines [i].source_line != -1)
+			set_log_buffer_line_source_position(cstate->log, cstate->source_edit->player_index, cstate->source_edit->template_index, log_lines [i].source_line);
+		write_to_log_buffer(cstate->log, log_lines [i].text);
+		finish_log_buffer_line(cstate->log);
+	}
+
+}
+
+// Call after a successful compilation for which load_compile_cache() returned 0.
+// The lines written to cstate's log buffer since compile_scode() started (from cstate->compile_log_start) are saved with the result.
+void save_compile_cache(struct cstatestruct* cstate)
+{
+
+ struct compile_cache_header_struct header;
+ struct compile_cache_log_line_struct log_lines [LOG_LINES];
+ char file_path [COMPILE_CACHE_PATH_LENGTH];
+ char temp_file_path [COMPILE_CACHE_PATH_LENGTH];
+ FILE* file;
+ int i;
+
+ if (!cache_state.available)
+		return;
+
+ header.id [0] = 'L';
+ header.id [1] = 'C';
+ header.id [2] = 'c';
+ header.id [3] = 'c';
+ header.version = COMPILE_CACHE_VERSION;
+ header.key = cstate->cache_key;
+ header.scode_length = cstate->scode.text_length;
+ header.template_size = sizeof(struct template_struct);
+ header.identifier_size = sizeof(struct identifierstruct);
+
+ header.user_identifiers = 0;
+ for (i = USER_IDENTIFIERS; i < IDENTIFIERS - 1; i ++)
+	{
+		if (cstate->identifier[i].type == CTOKEN_TYPE_NONE)
+			break;
+		header.user_identifiers ++;
+	}
+
+// if the compiler wrote more lines than the log buffer holds, the earlier ones have been overwritten and only the rest are saved:
+ header.log_lines = cstate->log->lines_written - cstate->compile_log_start;
+ if (header.log_lines > LOG_LINES - 1)
+		header.log_lines = LOG_LINES - 1;
+
+ for (i = 0; i < header.log_lines; i ++)
+	{
+		struct loglinestruct* log_line = get_log_buffer_line(cstate->log, header.log_lines - 1 - i);
+		memset(log_lines [i].text, 0, LOG_LINE_LENGTH);
+		strcpy(log_lines [i].text, log_line->text);
+		log_lines [i].colour = log_line->colour;
+		if (log_line->source_player_index == -1)
+			log_lines [i].source_line = -1;
+			 else
+				log_lines [i].source_line = log_line->source_line;
+	}
+
+ if (!compile_cache_file_path(file_path, cstate->cache_key))
+		return;
+
+// writes to a temporary file and then renames it, so that another instance of the game never sees a partly written file:
+ if (snprintf(temp_file_path, COMPILE_CACHE_PATH_LENGTH, "%s.tmp", file_path) >= COMPILE_CACHE_PATH_LENGTH)
+		return;
+
+ file = fopen(temp_file_path, "wb");
+
+ if (file == NULL)
+		return;
+
+ int written = fwrite(&header, sizeof(struct compile_cache_header_struct), 1, file) == 1
+	           && fwrite(cstate->templ, sizeof(struct template_struct), 1, file) == 1
+	           && (header.user_identifiers == 0
+														|| fwrite(&cstate->identifier [USER_IDENTIFIERS], sizeof(struct identifierstruct), header.user_identifiers, file) == header.user_identifiers)
+	           && (header.log_lines == 0
+														|| fwrite(log_lines, sizeof(struct compile_cache_log_line_struct), header.log_lines, file) == header.log_lines);
+
+ if (fclose(file) != 0)
+		written = 0;
+
+ if (!written)
+	{
+		remove(temp_file_path);
+		return;
+	}
+
+ remove(file_path); // rename() fails on some systems if the target exists
+ if (rename(temp_file_path, file_path) != 0)
+	{
+		remove(temp_file_path);
+		return;
+	}
+
+ cache_state.files ++;
+
+ if (cache_state.files > COMPILE_CACHE_MAX_FILES)
+		prune_compile_cache();
+
+}
+
+static unsigned long long compile_cache_key(struct cstatestruct* cstate)
+{
+
+ unsigned long long hash = 14695981039346656037ULL; // FNV-1a 64-bit offset basis
+ int values [6];
+
+ hash = hash_bytes(hash, &cache_state.compiler_id, sizeof(cache_state.compiler_id));
+
+ values [0] = COMPILE_CACHE_VERSION;
+ values [1] = cstate->templ->locked;
+ values [2] = sizeof(struct template_struct);
+ values [3] = sizeof(struct identifierstruct);
+ values [4] = cstate->optimise;
+ values [5] = sizeof(struct compile_cache_log_line_struct);
+
+ hash = hash_bytes(hash, values, sizeof(values));
+ hash = hash_bytes(hash, cstate->scode.text, cstate->scode.text_length);
+ hash = hash_bytes(hash, cstate->scode.src_line, cstate->scode.text_length * sizeof(s16b));
+
+ return hash;
+
+}
+
+static unsigned long long hash_bytes(unsigned long long hash, const void* data, int length)
+{
+
+ const unsigned char* bytes = data;
+ int i;
+
+ for (i = 0; i < length; i ++)
+	{
+		hash ^= bytes [i];
+		hash *= 1099511628211ULL; // FNV-1a 64-bit prime
+	}
+
+ return hash;
+
+}
+
+// file_path must be COMPILE_CACHE_PATH_LENGTH long.
+// Returns 1 on success, or 0 if the path didn't fit (in which case the cache isn't used for this file).
+static int compile_cache_file_path(char* file_path, unsigned long long key)
+{
+
+ int length = snprintf(file_path, COMPILE_CACHE_PATH_LENGTH, "%s%016llx.bin", cache_state.dir_path, key);
+
+ return (length >= 0 && length < COMPILE_CACHE_PATH_LENGTH);
+
+}
+
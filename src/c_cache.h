@@ -0,0 +1,10 @@
+
+#ifndef H_C_CACHE
+#define H_C_CACHE
+
+void init_compile_cache(void);
+int load_compile_cache(struct cstatestruct* cstate);
+void save_compile_cache(struct cstatestruct* cstate);
+
+#endif
+
@@ -4,6 +4,7 @@
 #include "c_header.h"
 
 #include "g_misc.h"
+#include "m_globvars.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -22,6 +23,8 @@
 #include "c_compile.h"
 #include "c_generate.h"
 #include "c_keywords.h"
+#include "c_cache.h"
+#include "c_optimise.h"
 
 #include "g_method.h"
 #include "g_method_core.h"
@@ -152,64 +155,53 @@ STATEMENT_END_BRACKET	// expects a closing bracket ) at end of statement, even i
 
 
 
-struct cstatestruct cstate;
 
-extern struct identifierstruct identifier [IDENTIFIERS];
-
-static int next_statement(int exit_point_break, int exit_point_continue, int ending_punctuation);
-static void add_intercode(int ic_type, int value1, int value2, int value3);
+static int compile_scode(struct cstatestruct* cstate);
+static int next_statement(struct cstatestruct* cstate, int exit_point_break, int exit_point_continue, int ending_punctuation);
+static void add_intercode(struct cstatestruct* cstate, int ic_type, int value1, int value2, int value3);
 static int get_operator_binding_level(int ctoken_subtype);
 static int is_ctoken_closing_punctuation(struct ctokenstruct* ctoken);
 
-static int variable_assignment(struct ctokenstruct* ctoken);
-
-static int next_expression(int exit_point, int bind_level);
-static int next_expression_value(int exit_point, int binding);
-static int next_expression_operator(struct ctokenstruct* ctoken_operator, int exit_point, int previous_operator_binding);
-static int parse_process_expression(int statement_start);
-static int parse_member_expression(int statement_start, int accept_object_method_call, int external_process_call);
-static int parse_core_method_call(int cmethod_index, int statement_start, int external_process_call);
-static int parse_std_method_call(int smethod_index);
-static int parse_uni_method_call(int umethod_index);
-static int parse_class_method_call(void);
-static int parse_class_name_in_expression(int class_index);
-static int parse_class_keyword_in_code(void);
-
-static int parse_if(int exit_point_break, int exit_point_continue);
-static int parse_for(void);
-static int parse_while(void);
-static int parse_do_while(void);
-static int parse_goto_or_gosub(void);
-static int parse_printf(int print_op, int printA_op);
-static int parse_enum(void);
-static int parse_switch(int exit_point_continue);
-static int add_print_string(char* source_string, int string_length, int print_op);
-
-static int allocate_exit_point(int type);
-static int variable_declaration(void);
-static int read_array_dimension_declaration(void);
-static int get_array_element_address(int id_index);
-
-struct template_struct compiled_template;
-
-// this function runs and initialises the compiler.
+static int variable_assignment(struct cstatestruct* cstate, struct ctokenstruct* ctoken);
+
+static int next_expression(struct cstatestruct* cstate, int exit_point, int bind_level);
+static int next_expression_value(struct cstatestruct* cstate, int exit_point, int binding);
+static int next_expression_operator(struct cstatestruct* cstate, struct ctokenstruct* ctoken_operator, int exit_point, int previous_operator_binding);
+static int parse_process_expression(struct cstatestruct* cstate, int statement_start);
+static int parse_member_expression(struct cstatestruct* cstate, int statement_start, int accept_object_method_call, int external_process_call);
+static int parse_core_method_call(struct cstatestruct* cstate, int cmethod_index, int statement_start, int external_process_call);
+static int parse_std_method_call(struct cstatestruct* cstate, int smethod_index);
+static int parse_uni_method_call(struct cstatestruct* cstate, int umethod_index);
+static int parse_class_method_call(struct cstatestruct* cstate);
+static int parse_class_name_in_expression(struct cstatestruct* cstate, int class_index);
+static int parse_class_keyword_in_code(struct cstatestruct* cstate);
+
+static int parse_if(struct cstatestruct* cstate, int exit_point_break, int exit_point_continue);
+static int parse_for(struct cstatestruct* cstate);
+static int parse_while(struct cstatestruct* cstate);
+static int parse_do_while(struct cstatestruct* cstate);
+static int parse_goto_or_gosub(struct cstatestruct* cstate);
+static int parse_printf(struct cstatestruct* cstate, int print_op, int printA_op);
+static int parse_enum(struct cstatestruct* cstate);
+static int parse_switch(struct cstatestruct* cstate, int exit_point_continue);
+static int add_print_string(struct cstatestruct* cstate, char* source_string, int string_length, int print_op);
+
+static int allocate_exit_point(struct cstatestruct* cstate, int type);
+static int variable_declaration(struct cstatestruct* cstate);
+static int read_array_dimension_declaration(struct cstatestruct* cstate);
+static int get_array_element_address(struct cstatestruct* cstate, int id_index);
+
+static void start_compile(struct compiler_context_struct* ccontext, struct template_struct* templ, struct source_edit_struct* source_edit, int compiler_mode);
+static void compile_source(struct compiler_context_struct* ccontext);
+static void* compile_source_thread(ALLEGRO_THREAD* thread, void* ccontext);
+static int finish_compile(struct compiler_context_struct* ccontext, struct template_struct* templ);
+
+// generates the template design and bcode in cstate->templ from cstate->scode.
 // returns 1 on success, 0 on failure.
-int compile(struct template_struct* templ, struct source_edit_struct* source_edit, int compiler_mode)
+static int compile_scode(struct cstatestruct* cstate)
 {
 
- write_line_to_log("Starting compiler.", MLOG_COL_COMPILER);
-
- compiled_template.source_edit = source_edit;
- compiled_template.active = 1;
- compiled_template.locked = templ->locked;
- cstate.source_edit = source_edit;
-
-	init_compiler(&compiled_template, compiler_mode);
-
-	if (!preprocess(source_edit)) // processes source_edit into cstate.scode
-		return 0;
-
- if (!fix_template_design_from_scode()) // updates the design in templ from scode. If compiler_mode is test, doesn't actually update it.
+ if (!fix_template_design_from_scode(cstate)) // updates the design in templ from scode. If compiler_mode is test, doesn't actually update it.
 		return 0;
 
 // if (compiler_mode == COMPILE_MO???
@@ -217,22 +209,207 @@ int compile(struct template_struct* templ, struct source_edit_struct* source_edi
 
  while(TRUE)
 	{
-		retval = next_statement(-1, -1, STATEMENT_END_SEMICOLON); // -1s mean break or continue gives an error
+		retval = next_statement(cstate, -1, -1, STATEMENT_END_SEMICOLON); // -1s mean break or continue gives an error
 		if (retval == 0)
 			return 0; // error
 	 if (retval == 2)
 			break; // finished
 	}
 
-	add_intercode(IC_OP, OP_stop, 0, 0);
+	add_intercode(cstate, IC_OP, OP_stop, 0, 0);
+
+ if (cstate->ic_pos >= INTERCODE_SIZE - 1)
+		return comp_error_text(cstate, "code generation failed (intermediate code size too large)", NULL); // shouldn't happen
+
+ if (cstate->error != CERR_NONE)
+		return 0;
+
+ if (cstate->optimise)
+		optimise_intercode(cstate); // in c_optimise.c
+
+ if (!intercode_to_bcode(cstate))
+		return 0;
+
+ return 1;
+
+}
+
+// this function runs and initialises the compiler.
+// returns 1 on success, 0 on failure.
+int compile(struct template_struct* templ, struct source_edit_struct* source_edit, int compiler_mode)
+{
 
- if (cstate.ic_pos >= INTERCODE_SIZE - 1)
-		return comp_error_text("code generation failed (intermediate code size too large)", NULL); // shouldn't happen
+ int success;
+ struct compiler_context_struct* ccontext = open_compiler_context();
 
- if (cstate.error != CERR_NONE)
+ if (ccontext == NULL)
 		return 0;
 
- if (!intercode_to_bcode())
+ start_compile(ccontext, templ, source_edit, compiler_mode);
+ compile_source(ccontext);
+ success = finish_compile(ccontext, templ);
+
+ close_compiler_context(ccontext);
+
+ return success;
+
+}
+
+/*
+
+Compiling more than one template at once
+
+A compilation is split into three parts:
+ - start_compile() takes what the compiler needs from the target template.
+ - compile_source() does everything that only uses the compiler context (preprocessing, loading from the compile cache or
+    compiling, optimising and generating bcode). Log lines go into the context's log buffer.
+ - finish_compile() copies the results into the target template, saves them in the compile cache and writes the log buffer to the log.
+start_compile() and finish_compile() must be called from the main thread, but compile_source() calls for different contexts can
+ run at the same time in different threads.
+
+compile_templates() uses this to compile several templates in parallel. The results (and the log) are the same as calling
+ compile() for each template in order.
+
+*/
+
+// compiles the templates in target_templ (each from its own source_edit), using up to settings.option [OPTION_COMPILE_THREADS]
+//  threads at once (0 means one for each CPU core).
+// returns the number of templates that compiled successfully.
+int compile_templates(struct template_struct* target_templ [], int templates, int compiler_mode)
+{
+
+ struct compiler_context_struct* ccontext [COMPILE_THREADS_MAX];
+ ALLEGRO_THREAD* thread [COMPILE_THREADS_MAX];
+ int threads = settings.option [OPTION_COMPILE_THREADS];
+ int compiled = 0;
+ int first, i;
+
+ if (threads == 0)
+		threads = al_get_cpu_count();
+ if (threads < 1)
+		threads = 1;
+ if (threads > COMPILE_THREADS_MAX)
+		threads = COMPILE_THREADS_MAX;
+
+ if (threads == 1)
+	{
+  for (i = 0; i < templates; i ++)
+		{
+			compiled += compile(target_templ [i], target_templ [i]->source_edit, compiler_mode);
+		}
+		return compiled;
+	}
+
+ init_keyword_hash(); // the lexer builds this the first time it's needed, which must happen before the threads start (see c_lexer.c)
+
+ for (first = 0; first < templates; first += threads)
+	{
+		int batch = templates - first;
+		if (batch > threads)
+			batch = threads;
+
+		for (i = 0; i < batch; i ++)
+		{
+			thread [i] = NULL;
+			ccontext [i] = open_compiler_context();
+			if (ccontext [i] == NULL)
+				continue;
+			start_compile(ccontext [i], target_templ [first + i], target_templ [first + i]->source_edit, compiler_mode);
+			thread [i] = al_create_thread(compile_source_thread, ccontext [i]);
+			if (thread [i] != NULL)
+			 al_start_thread(thread [i]);
+		}
+
+		for (i = 0; i < batch; i ++)
+		{
+			if (ccontext [i] == NULL)
+				continue;
+			if (thread [i] != NULL)
+			{
+			 al_join_thread(thread [i], NULL);
+			 al_destroy_thread(thread [i]);
+			}
+			 else
+				 compile_source(ccontext [i]); // couldn't start a thread, so compile it here
+			compiled += finish_compile(ccontext [i], target_templ [first + i]);
+			close_compiler_context(ccontext [i]);
+		}
+	}
+
+ return compiled;
+
+}
+
+static void* compile_source_thread(ALLEGRO_THREAD* thread, void* ccontext)
+{
+
+ compile_source(ccontext);
+
+ return NULL;
+
+}
+
+// sets up ccontext to compile source_edit for templ. Call from the main thread.
+static void start_compile(struct compiler_context_struct* ccontext, struct template_struct* templ, struct source_edit_struct* source_edit, int compiler_mode)
+{
+
+ struct template_struct* compiled_template = &ccontext->compiled_template;
+
+ compiled_template->source_edit = source_edit;
+ compiled_template->active = 1;
+ compiled_template->locked = templ->locked;
+
+ ccontext->source_edit = source_edit;
+ ccontext->compiler_mode = compiler_mode;
+ ccontext->result = 0;
+ ccontext->save_to_cache = 0;
+
+}
+
+// the part of the compilation that only uses ccontext (see above). Sets ccontext->result to 1 on success.
+static void compile_source(struct compiler_context_struct* ccontext)
+{
+
+ struct cstatestruct* cstate = &ccontext->cstate;
+ int compiler_mode = ccontext->compiler_mode;
+
+ write_line_to_log_buffer(cstate->log, "Starting compiler.", MLOG_COL_COMPILER);
+
+ cstate->source_edit = ccontext->source_edit;
+
+	init_compiler(cstate, &ccontext->compiled_template, compiler_mode);
+
+	if (!preprocess(cstate, ccontext->source_edit)) // processes source_edit into cstate->scode
+		return;
+
+ if (compiler_mode == COMPILE_MODE_TEST
+		|| !load_compile_cache(cstate)) // if this source has been compiled before, loads the results into ccontext->compiled_template (see c_cache.c)
+	{
+		cstate->compile_log_start = cstate->log->lines_written; // the lines compile_scode() writes to the log (warnings etc) are saved with the result
+  if (!compile_scode(cstate))
+			return;
+  if (compiler_mode != COMPILE_MODE_TEST)
+			ccontext->save_to_cache = 1;
+	}
+
+ ccontext->result = 1;
+
+}
+
+// copies the result of compile_source() into templ. Call from the main thread.
+// returns 1 on success, 0 on failure.
+static int finish_compile(struct compiler_context_struct* ccontext, struct template_struct* templ)
+{
+
+ struct cstatestruct* cstate = &ccontext->cstate;
+ struct template_struct* compiled_template = &ccontext->compiled_template;
+
+ if (ccontext->save_to_cache)
+		save_compile_cache(cstate);
+
+ flush_log_buffer(cstate->log); // the lines below go straight to the log, so the compiler's lines need to be written first
+
+ if (!ccontext->result)
 		return 0;
 
  // at this point can fail only if the mode is COMPILE_MODE_LOCK
@@ -240,7 +417,7 @@ int compile(struct template_struct* templ, struct source_edit_struct* source_edi
  int success = 1;
  int completed = 1;
 
- switch(cstate.compile_mode)
+ switch(cstate->compile_mode)
  {
   case COMPILE_MODE_TEST:
 
@@ -248,18 +425,18 @@ int compile(struct template_struct* templ, struct source_edit_struct* source_edi
 //  - if so, will need to make sure the previously called template design functions don't stop early in test compile mode (currently they do)
 
 /*
-// 		copy_template(templ, &compiled_template);
- 		if (check_template_collisions(&compiled_template) != 0)
+// 		copy_template(templ, compiled_template);
+ 		if (check_template_collisions(compiled_template) != 0)
     write_line_to_log("Warning: process component collision.", MLOG_COL_WARNING);
- 		if (check_move_objects_obstruction(&compiled_template) != 0)
+ 		if (check_move_objects_obstruction(compiled_template) != 0)
     write_line_to_log("Warning: move object obstructed by process component.", MLOG_COL_WARNING);
- 	 check_template_objects(&compiled_template, 0);
- 	 calculate_template_cost_and_power(&compiled_template);
+ 	 check_template_objects(compiled_template, 0);
+ 	 calculate_template_cost_and_power(compiled_template);
 // - test compile only tests the source code, not the design.
 //  - probably should test the design as well.*/
  	 break;
   case COMPILE_MODE_BUILD:
- 		copy_template(templ, &compiled_template, (templ->locked == 0));
+ 		copy_template(templ, compiled_template, (templ->locked == 0));
  		if (check_template_collisions(templ) != 0)
 			{
     write_line_to_log("Warning: process component collision.", MLOG_COL_WARNING);
@@ -273,10 +450,10 @@ int compile(struct template_struct* templ, struct source_edit_struct* source_edi
 			if (check_template_objects(templ, 1)) // returns 1 on error
 				completed = 0;
  	 calculate_template_cost_and_power(templ);
-   prepare_template_debug(templ->player_index, templ->template_index, 1); // ,1 means that the debug template will include identifier information
+   prepare_template_debug(templ->player_index, templ->template_index, cstate->identifier); // the debug template will include identifier information
  	 break;
  	case COMPILE_MODE_LOCK:
- 		copy_template(templ, &compiled_template, (templ->locked == 0));
+ 		copy_template(templ, compiled_template, (templ->locked == 0));
  		if (check_template_collisions(templ) != 0)
 			{
     write_line_to_log("Error: process component collision.", MLOG_COL_ERROR);
@@ -290,7 +467,7 @@ int compile(struct template_struct* templ, struct source_edit_struct* source_edi
 			if (check_template_objects(templ, 1)) // returns 1 on error
 				success = 0;
  	 calculate_template_cost_and_power(templ);
-   prepare_template_debug(templ->player_index, templ->template_index, 1); // ,1 means that the debug template will include identifier information
+   prepare_template_debug(templ->player_index, templ->template_index, cstate->identifier); // the debug template will include identifier information
 			break;
  }
 
@@ -377,13 +554,13 @@ int check_template_objects(struct template_struct* templ, int warning_or_error)
 //  0 on error
 //  1 on success
 //  2 on success, and finished file
-static int next_statement(int exit_point_break, int exit_point_continue, int ending_punctuation)
+static int next_statement(struct cstatestruct* cstate, int exit_point_break, int exit_point_continue, int ending_punctuation)
 {
 
- cstate.recursion_level ++; // this will be decremented later on (see comp_statement_success label) if the function returns successfully
+ cstate->recursion_level ++; // this will be decremented later on (see comp_statement_success label) if the function returns successfully
 
- if (cstate.recursion_level > RECURSION_LIMIT)
-  return comp_error(CERR_RECURSION_LIMIT_REACHED, NULL);
+ if (cstate->recursion_level > RECURSION_LIMIT)
+  return comp_error(cstate, CERR_RECURSION_LIMIT_REACHED, NULL);
 
  struct ctokenstruct ctoken;
  struct ctokenstruct operator_ctoken;
@@ -391,9 +568,9 @@ static int next_statement(int exit_point_break, int exit_point_continue, int end
  int retval;
 // int save_scode_pos, save_scode_pos2;
 
-   if (!read_next(&ctoken))
+   if (!read_next(cstate, &ctoken))
 			{
-				if (cstate.reached_end_of_source)
+				if (cstate->reached_end_of_source)
 					return 2; // finished
     return 0;
 			}
@@ -405,34 +582,34 @@ static int next_statement(int exit_point_break, int exit_point_continue, int end
      if (ctoken.subtype == CTOKEN_SUBTYPE_SEMICOLON)
       goto dont_need_semicolon; // does nothing
      if (ctoken.subtype != CTOKEN_SUBTYPE_BRACE_OPEN) // a brace is the only other punctuation that's accepted at the start of a line
-      return comp_error_text("unexpected punctuation or operator at statement start", NULL);
+      return comp_error_text(cstate, "unexpected punctuation or operator at statement start", NULL);
      while(TRUE)
      {
-      if (accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACE_CLOSE))
+      if (accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACE_CLOSE))
        goto dont_need_semicolon;
-      retval = next_statement(exit_point_break, exit_point_continue, STATEMENT_END_SEMICOLON);
+      retval = next_statement(cstate, exit_point_break, exit_point_continue, STATEMENT_END_SEMICOLON);
       if (retval == 0)
 							return 0; // error
       if (retval == 2)
-							return comp_error_text("reached end of source inside block of code", NULL);
+							return comp_error_text(cstate, "reached end of source inside block of code", NULL);
 // if retval == 1, just keep on going
      } // end code block loop
      goto dont_need_semicolon; // end case CTOKEN_TYPE_PUNCTUATION
 
     case CTOKEN_TYPE_IDENTIFIER_USER_VARIABLE:
 // should be an assignment:
-					if (!variable_assignment(&ctoken))
+					if (!variable_assignment(cstate, &ctoken))
 						return 0;
      break; // end case CTOKEN_TYPE_IDENTIFIER_USER_VARIABLE
 
     case CTOKEN_TYPE_IDENTIFIER_NEW:
     case CTOKEN_TYPE_IDENTIFIER_LABEL_UNDEFINED:
 // an undefined identifier should be a label
-     if (!accept_next(&operator_ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COLON))
-      return comp_error_text("syntax error at start of statement", &ctoken);
-     identifier[ctoken.identifier_index].type = CTOKEN_TYPE_IDENTIFIER_LABEL;
+     if (!accept_next(cstate, &operator_ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COLON))
+      return comp_error_text(cstate, "syntax error at start of statement", &ctoken);
+     cstate->identifier[ctoken.identifier_index].type = CTOKEN_TYPE_IDENTIFIER_LABEL;
 
-     add_intercode(IC_LABEL_DEFINITION, ctoken.identifier_index, 0, 0);
+     add_intercode(cstate, IC_LABEL_DEFINITION, ctoken.identifier_index, 0, 0);
 
 // no semicolon here
 					goto dont_need_any_punctuation; // end undefined labels
@@ -442,238 +619,238 @@ static int next_statement(int exit_point_break, int exit_point_continue, int end
 					switch(ctoken.identifier_index)
 					{
 					 case KEYWORD_C_INT:
-					 	if (!variable_declaration())
+					 	if (!variable_declaration(cstate))
 								return 0;
-							while (check_next(CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))
+							while (check_next(cstate, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))
 							{
-					 	 if (!variable_declaration())
+					 	 if (!variable_declaration(cstate))
 								 return 0;
 							}
 						 break;
 						case KEYWORD_C_IF:
-							if (!parse_if(exit_point_break, exit_point_continue))
+							if (!parse_if(cstate, exit_point_break, exit_point_continue))
 								return 0;
 							goto dont_need_semicolon;
 						case KEYWORD_C_FOR:
-							if (!parse_for()) // loop resets break/continue exit points
+							if (!parse_for(cstate)) // loop resets break/continue exit points
 								return 0;
 							goto dont_need_semicolon;
 						case KEYWORD_C_WHILE:
-							if (!parse_while()) // loop resets break/continue exit points
+							if (!parse_while(cstate)) // loop resets break/continue exit points
 								return 0;
 							goto dont_need_semicolon;
 						case KEYWORD_C_DO:
-							if (!parse_do_while()) // loop resets break/continue exit points
+							if (!parse_do_while(cstate)) // loop resets break/continue exit points
 								return 0;
 							break;
 						case KEYWORD_C_GOTO:
-							if (!parse_goto_or_gosub())
+							if (!parse_goto_or_gosub(cstate))
 								return 0;
 							break;
 						case KEYWORD_C_GOSUB:
-							add_intercode(IC_OP, OP_push_return_address, 0, 0);
-							if (!parse_goto_or_gosub())
+							add_intercode(cstate, IC_OP, OP_push_return_address, 0, 0);
+							if (!parse_goto_or_gosub(cstate))
 								return 0;
 							break;
 						case KEYWORD_C_RETURN:
-							add_intercode(IC_OP, OP_return_sub, 0, 0);
+							add_intercode(cstate, IC_OP, OP_return_sub, 0, 0);
 							break;
 						case KEYWORD_C_PRINTF:
-							if (!parse_printf(OP_print, OP_printA))
+							if (!parse_printf(cstate, OP_print, OP_printA))
 								return 0;
 							break;
 						case KEYWORD_C_BUBBLEF:
-							if (!parse_printf(OP_bubble, OP_bubbleA))
+							if (!parse_printf(cstate, OP_bubble, OP_bubbleA))
 								return 0;
 							break;
 						case KEYWORD_C_PROCESS:
-							if (!parse_process_expression(1))
+							if (!parse_process_expression(cstate, 1))
 								return 0;
 							break;
 						case KEYWORD_C_COMPONENT:
-							if (!parse_member_expression(1, 1, 0)) // calls a member/object method. can be an expression or a statement.
+							if (!parse_member_expression(cstate, 1, 1, 0)) // calls a member/object method. can be an expression or a statement.
 								return 0;
 							break;
 						case KEYWORD_C_CLASS:
-							if (!parse_class_keyword_in_code()) // e.g. class[2].method_call()
+							if (!parse_class_keyword_in_code(cstate)) // e.g. class[2].method_call()
 								return 0;
 							break;
 						case KEYWORD_C_EXIT: // stop execution
-							add_intercode(IC_OP, OP_stop, 0, 0);
+							add_intercode(cstate, IC_OP, OP_stop, 0, 0);
 							break;
 						case KEYWORD_C_TERMINATE: // self-destruct
-							add_intercode(IC_OP, OP_terminate, 0, 0);
+							add_intercode(cstate, IC_OP, OP_terminate, 0, 0);
 							break;
 						case KEYWORD_C_ENUM:
-							if (!parse_enum())
+							if (!parse_enum(cstate))
 								return 0;
 							break;
 						case KEYWORD_C_SWITCH:
-							if (!parse_switch(exit_point_continue)) // switch resets break exit point but retains continue
+							if (!parse_switch(cstate, exit_point_continue)) // switch resets break exit point but retains continue
 								return 0;
 							goto dont_need_semicolon;
 						case KEYWORD_C_CASE:
-							return comp_error_text("case outside of switch", &ctoken);
+							return comp_error_text(cstate, "case outside of switch", &ctoken);
 						case KEYWORD_C_DEFAULT:
-							return comp_error_text("default outside of switch", &ctoken);
+							return comp_error_text(cstate, "default outside of switch", &ctoken);
 // remember not to return on success; break or goto dont_need_punctuation instead
       case KEYWORD_C_BREAK:
       	if (exit_point_break == -1)
-								return comp_error_text("break outside loop or switch", &ctoken);
-							add_intercode(IC_JUMP_EXIT_POINT_FALSE, exit_point_break, 0, 0);
+								return comp_error_text(cstate, "break outside loop or switch", &ctoken);
+							add_intercode(cstate, IC_JUMP_EXIT_POINT_FALSE, exit_point_break, 0, 0);
 							break;
       case KEYWORD_C_CONTINUE:
       	if (exit_point_continue == -1)
-								return comp_error_text("continue outside loop", &ctoken);
-							add_intercode(IC_JUMP_EXIT_POINT_TRUE, exit_point_continue, 0, 0);
+								return comp_error_text(cstate, "continue outside loop", &ctoken);
+							add_intercode(cstate, IC_JUMP_EXIT_POINT_TRUE, exit_point_continue, 0, 0);
 							break;
 
 					}
 					break; // end case CTOKEN_TYPE_IDENTIFIER_C_KEYWORD/CTOKEN_TYPE_IDENTIFIER_NON_C_KEYWORD
 
 			case CTOKEN_TYPE_IDENTIFIER_CMETHOD:
-  		if (!parse_core_method_call(identifier[ctoken.identifier_index].value,  // see c_keywords.c for a list of these in the identifier initialiser
+  		if (!parse_core_method_call(cstate, cstate->identifier[ctoken.identifier_index].value,  // see c_keywords.c for a list of these in the identifier initialiser
 																																1, 0))
 					return 0;
 				break;
 
 			case CTOKEN_TYPE_IDENTIFIER_SMETHOD:
-				if (!parse_std_method_call(identifier[ctoken.identifier_index].value))
+				if (!parse_std_method_call(cstate, cstate->identifier[ctoken.identifier_index].value))
 					return 0;
 				break;
 
 			case CTOKEN_TYPE_IDENTIFIER_UMETHOD:
-				if (!parse_uni_method_call(identifier[ctoken.identifier_index].value))
+				if (!parse_uni_method_call(cstate, cstate->identifier[ctoken.identifier_index].value))
 					return 0;
 				break;
 
 			case CTOKEN_TYPE_IDENTIFIER_CLASS:
 // class method calls need to confirm that the class name is followed by a full stop
 //  (this is done here because class names can be used in expressions without the full stop)
-    if (!expect_punctuation(CTOKEN_SUBTYPE_FULL_STOP))
-		   return comp_error_text("expected full stop and object method call after class name in statement", NULL);
+    if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_FULL_STOP))
+		   return comp_error_text(cstate, "expected full stop and object method call after class name in statement", NULL);
 // push the class index:
-    add_intercode(IC_OP, OP_push_num, identifier[ctoken.identifier_index].value, 0);
-				if (!parse_class_method_call())
+    add_intercode(cstate, IC_OP, OP_push_num, cstate->identifier[ctoken.identifier_index].value, 0);
+				if (!parse_class_method_call(cstate))
 					return 0;
 				break;
 
    case CTOKEN_TYPE_IDENTIFIER_LABEL: // label for goto target
-    return comp_error_text("label already defined", &ctoken);
+    return comp_error_text(cstate, "label already defined", &ctoken);
 
    case CTOKEN_TYPE_IDENTIFIER_OMETHOD:
-    return comp_error_text("object method must be called for an object or class", &ctoken);
+    return comp_error_text(cstate, "object method must be called for an object or class", &ctoken);
 
    case CTOKEN_TYPE_IDENTIFIER_MMETHOD:
-    return comp_error_text("component method must be called for a component", &ctoken);
+    return comp_error_text(cstate, "component method must be called for a component", &ctoken);
 
    default:
-    return comp_error_text("error at statement start", &ctoken);
+    return comp_error_text(cstate, "error at statement start", &ctoken);
 
 
    } // end of ctoken.type switch
 
  if (ending_punctuation == STATEMENT_END_SEMICOLON
-		&& !expect_punctuation(CTOKEN_SUBTYPE_SEMICOLON))
+		&& !expect_punctuation(cstate, CTOKEN_SUBTYPE_SEMICOLON))
 //			return comp_error(CERR_EXPECTED_SEMICOLON, NULL);
-			return comp_error_text("expected ; after statement", NULL);
+			return comp_error_text(cstate, "expected ; after statement", NULL);
 
 dont_need_semicolon: // used for last statement in for loop header, which ends with ) rather than ;
 
 // require closing bracket here
  if (ending_punctuation == STATEMENT_END_BRACKET
-		&& !expect_punctuation(CTOKEN_SUBTYPE_BRACKET_CLOSE))
-			return comp_error_text("expected ) after statement", NULL);
+		&& !expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_CLOSE))
+			return comp_error_text(cstate, "expected ) after statement", NULL);
 
 dont_need_any_punctuation:
 
- cstate.recursion_level --;
+ cstate->recursion_level --;
  return 1;
 
 }
 
 
-static int parse_if(int exit_point_break, int exit_point_continue)
+static int parse_if(struct cstatestruct* cstate, int exit_point_break, int exit_point_continue)
 {
 
-  int exit_point = allocate_exit_point(EXPOINT_TYPE_BASIC);
+  int exit_point = allocate_exit_point(cstate, EXPOINT_TYPE_BASIC);
 
   if (exit_point == -1)
    return 0;
 
-  if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_OPEN))
-			return comp_error_text("expected open bracket after if", NULL);
-		if (!next_expression(exit_point, BIND_EXPRESSION_START))
+  if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_OPEN))
+			return comp_error_text(cstate, "expected open bracket after if", NULL);
+		if (!next_expression(cstate, exit_point, BIND_EXPRESSION_START))
 			return 0;
-  if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_CLOSE))
-			return comp_error_text("expected closing bracket at end of if expression", NULL);
+  if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_CLOSE))
+			return comp_error_text(cstate, "expected closing bracket at end of if expression", NULL);
 
 // so now we check whether the expression is true or false
-   add_intercode(IC_IFFALSE_JUMP_TO_EXIT_POINT, exit_point, 0, 0);
+   add_intercode(cstate, IC_IFFALSE_JUMP_TO_EXIT_POINT, exit_point, 0, 0);
 // here's the "true" exit point for the expression (any exit jumps from || logical operators (that aren't inside sub-expressions) are set to here)
-   add_intercode(IC_EXIT_POINT_TRUE, exit_point, 0, 0);
+   add_intercode(cstate, IC_EXIT_POINT_TRUE, exit_point, 0, 0);
 // here's the code that follows from the if statement
-   if (!next_statement(exit_point_break, exit_point_continue, STATEMENT_END_SEMICOLON))
+   if (!next_statement(cstate, exit_point_break, exit_point_continue, STATEMENT_END_SEMICOLON))
     return 0;
 // at this point, assume we've reached the end of the block or statement that followed the if. Check for else:
-   if (check_next(CTOKEN_TYPE_IDENTIFIER_C_KEYWORD, KEYWORD_C_ELSE))
+   if (check_next(cstate, CTOKEN_TYPE_IDENTIFIER_C_KEYWORD, KEYWORD_C_ELSE))
    {
 // first we create a new exit point.
-    int avoid_else_exit_point = allocate_exit_point(EXPOINT_TYPE_BASIC);
+    int avoid_else_exit_point = allocate_exit_point(cstate, EXPOINT_TYPE_BASIC);
     if (avoid_else_exit_point == -1)
      return 0;
 // if control reaches the end of the conditional code because the if statement was true and the code has finished executing, we jump past the else code.
-    add_intercode(IC_JUMP_EXIT_POINT_TRUE, avoid_else_exit_point, 0, 0); // this is an unconditional jump to the avoid_else exit point
+    add_intercode(cstate, IC_JUMP_EXIT_POINT_TRUE, avoid_else_exit_point, 0, 0); // this is an unconditional jump to the avoid_else exit point
  // this is the point where control will jump to if the if statement was false (as conditional_exit_point remains set from before):
-    add_intercode(IC_EXIT_POINT_FALSE, exit_point, 0, 0);
-    if (!next_statement(exit_point_break, exit_point_continue, STATEMENT_END_SEMICOLON)) // if the first thing comp_statement finds is {, it will call itself until it finds }
+    add_intercode(cstate, IC_EXIT_POINT_FALSE, exit_point, 0, 0);
+    if (!next_statement(cstate, exit_point_break, exit_point_continue, STATEMENT_END_SEMICOLON)) // if the first thing comp_statement finds is {, it will call itself until it finds }
      return 0;
-    add_intercode(IC_EXIT_POINT_TRUE, avoid_else_exit_point, 0, 0); // shouldn't be necessary to set the "false" exit point
+    add_intercode(cstate, IC_EXIT_POINT_TRUE, avoid_else_exit_point, 0, 0); // shouldn't be necessary to set the "false" exit point
    }
     else
 // no else, so we just set the "false" exit point for the if statement and go back to comp_statement
-     add_intercode(IC_EXIT_POINT_FALSE, exit_point, 0, 0);
+     add_intercode(cstate, IC_EXIT_POINT_FALSE, exit_point, 0, 0);
 
  return 1; // finished!
 
 
 }
 
-static int parse_while(void)
+static int parse_while(struct cstatestruct* cstate)
 {
 
 // first we need an exit point:
- int loop_exit_point = allocate_exit_point(EXPOINT_TYPE_LOOP);
+ int loop_exit_point = allocate_exit_point(cstate, EXPOINT_TYPE_LOOP);
  if (loop_exit_point == -1)
 		return 0;
 
 // true exit point is before while expression (used when end of loop, or continue within loop, found)
-	add_intercode(IC_EXIT_POINT_TRUE, loop_exit_point, 0, 0);
+	add_intercode(cstate, IC_EXIT_POINT_TRUE, loop_exit_point, 0, 0);
 
-	if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_OPEN))
-		return comp_error_text("expected ( after while", NULL);
-	if (!next_expression(-1, BIND_EXPRESSION_START))
+	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_OPEN))
+		return comp_error_text(cstate, "expected ( after while", NULL);
+	if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		return 0;
-	if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_CLOSE))
-		return comp_error_text("expected ) after while", NULL);
+	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_CLOSE))
+		return comp_error_text(cstate, "expected ) after while", NULL);
 
 // result of while(expression) should be in A. If false, jump straight to end of loop:
-	add_intercode(IC_IFFALSE_JUMP_TO_EXIT_POINT, loop_exit_point, 0, 0);
+	add_intercode(cstate, IC_IFFALSE_JUMP_TO_EXIT_POINT, loop_exit_point, 0, 0);
 // otherwise, fall through to the looped statement:
- if (!next_statement(loop_exit_point, loop_exit_point, STATEMENT_END_SEMICOLON))
+ if (!next_statement(cstate, loop_exit_point, loop_exit_point, STATEMENT_END_SEMICOLON))
 		return 0; // will treat a block as a single statement and parse the whole thing
 
 // now jump back and evaluate the while condition again:
- add_intercode(IC_JUMP_EXIT_POINT_TRUE, loop_exit_point, 0, 0);
+ add_intercode(cstate, IC_JUMP_EXIT_POINT_TRUE, loop_exit_point, 0, 0);
 
 // false exit point is at end of loop statement/block (used for failed while condition, and also break within loop)
-	add_intercode(IC_EXIT_POINT_FALSE, loop_exit_point, 0, 0);
+	add_intercode(cstate, IC_EXIT_POINT_FALSE, loop_exit_point, 0, 0);
 
 	return 1;
 
 }
 
-static int parse_do_while(void)
+static int parse_do_while(struct cstatestruct* cstate)
 {
 
 /*
@@ -689,51 +866,51 @@ ep 2: true is at start of loop (before do). Used where while expression evaluate
 
 
 // first we need an exit point right at the start (only true is used):
- int main_exit_point = allocate_exit_point(EXPOINT_TYPE_BASIC);
+ int main_exit_point = allocate_exit_point(cstate, EXPOINT_TYPE_BASIC);
  if (main_exit_point == -1)
 		return 0;
 
- int conditional_exit_point = allocate_exit_point(EXPOINT_TYPE_LOOP);
+ int conditional_exit_point = allocate_exit_point(cstate, EXPOINT_TYPE_LOOP);
  if (conditional_exit_point == -1)
 		return 0;
 
 // main exit point is before do (used when end of loop found and while() expression is true)
-	add_intercode(IC_EXIT_POINT_TRUE, main_exit_point, 0, 0);
+	add_intercode(cstate, IC_EXIT_POINT_TRUE, main_exit_point, 0, 0);
 
 // now we parse the statement after do
 // conditional_exit_point is the exit point used for continue and break within the statement.
- if (!next_statement(conditional_exit_point, conditional_exit_point, STATEMENT_END_SEMICOLON))
+ if (!next_statement(cstate, conditional_exit_point, conditional_exit_point, STATEMENT_END_SEMICOLON))
 		return 0; // will treat a block as a single statement and parse the whole thing
 
 // true conditional exit point is after the loop and before the while is evaluated (used for continue within loop)
-	add_intercode(IC_EXIT_POINT_TRUE, conditional_exit_point, 0, 0);
+	add_intercode(cstate, IC_EXIT_POINT_TRUE, conditional_exit_point, 0, 0);
 
 // now check for while:
- if (!check_next(CTOKEN_TYPE_IDENTIFIER_C_KEYWORD, KEYWORD_C_WHILE))
-  return comp_error_text("expected while after do loop", NULL);
+ if (!check_next(cstate, CTOKEN_TYPE_IDENTIFIER_C_KEYWORD, KEYWORD_C_WHILE))
+  return comp_error_text(cstate, "expected while after do loop", NULL);
 
-	if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_OPEN))
-		return comp_error_text("expected ( after while", NULL);
-	if (!next_expression(-1, BIND_EXPRESSION_START))
+	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_OPEN))
+		return comp_error_text(cstate, "expected ( after while", NULL);
+	if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		return 0;
-	if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_CLOSE))
-		return comp_error_text("expected ) after while", NULL);
+	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_CLOSE))
+		return comp_error_text(cstate, "expected ) after while", NULL);
 //	if (!expect_punctuation(CTOKEN_SUBTYPE_SEMICOLON))
 //		return comp_error(CERR_EXPECTED_SEMICOLON, NULL);
 
 // result of while(expression) should be in A. If true, jump back to start of loop:
-	add_intercode(IC_IFTRUE_JUMP_TO_EXIT_POINT, main_exit_point, 0, 0);
+	add_intercode(cstate, IC_IFTRUE_JUMP_TO_EXIT_POINT, main_exit_point, 0, 0);
 // otherwise, fall through to the next thing after the loop.
 
 // false conditional exit point is after the loop (used for break within loop)
-	add_intercode(IC_EXIT_POINT_FALSE, conditional_exit_point, 0, 0);
+	add_intercode(cstate, IC_EXIT_POINT_FALSE, conditional_exit_point, 0, 0);
 
 	return 1;
 
 }
 
 
-static int parse_for(void)
+static int parse_for(struct cstatestruct* cstate)
 {
 
 /*
@@ -766,95 +943,95 @@ ep2 false
 
 
 // first we need an exit point right at the start (only true is used):
- int main_exit_point = allocate_exit_point(EXPOINT_TYPE_LOOP);
+ int main_exit_point = allocate_exit_point(cstate, EXPOINT_TYPE_LOOP);
  if (main_exit_point == -1)
 		return 0;
 
- int conditional_exit_point = allocate_exit_point(EXPOINT_TYPE_BASIC);
+ int conditional_exit_point = allocate_exit_point(cstate, EXPOINT_TYPE_BASIC);
  if (conditional_exit_point == -1)
 		return 0;
 
- int statement_exit_point = allocate_exit_point(EXPOINT_TYPE_BASIC);
+ int statement_exit_point = allocate_exit_point(cstate, EXPOINT_TYPE_BASIC);
  if (statement_exit_point == -1)
 		return 0;
 
 // statement W
-	if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_OPEN))
-		return comp_error_text("expected ( after for", NULL);
- if (!next_statement(-1, -1, STATEMENT_END_SEMICOLON))
+	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_OPEN))
+		return comp_error_text(cstate, "expected ( after for", NULL);
+ if (!next_statement(cstate, -1, -1, STATEMENT_END_SEMICOLON))
 		return 0;
 
 // exit point 1 true
- add_intercode(IC_EXIT_POINT_TRUE, main_exit_point, 0, 0);
+ add_intercode(cstate, IC_EXIT_POINT_TRUE, main_exit_point, 0, 0);
 
 // expression X
- if (!next_expression(conditional_exit_point, BIND_EXPRESSION_START))
+ if (!next_expression(cstate, conditional_exit_point, BIND_EXPRESSION_START))
 		return 0;
-	if (!expect_punctuation(CTOKEN_SUBTYPE_SEMICOLON))
-		return comp_error_text("expected semicolon after expression", NULL);
+	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_SEMICOLON))
+		return comp_error_text(cstate, "expected semicolon after expression", NULL);
 
 // evaluate X:
- add_intercode(IC_IFTRUE_JUMP_TO_EXIT_POINT, conditional_exit_point, 0, 0);
- add_intercode(IC_IFFALSE_JUMP_TO_EXIT_POINT, conditional_exit_point, 0, 0);
+ add_intercode(cstate, IC_IFTRUE_JUMP_TO_EXIT_POINT, conditional_exit_point, 0, 0);
+ add_intercode(cstate, IC_IFFALSE_JUMP_TO_EXIT_POINT, conditional_exit_point, 0, 0);
 
 // exit point 3 true
- add_intercode(IC_EXIT_POINT_TRUE, statement_exit_point, 0, 0);
+ add_intercode(cstate, IC_EXIT_POINT_TRUE, statement_exit_point, 0, 0);
 
 // statement Y
- if (!next_statement(-1, -1, STATEMENT_END_BRACKET))
+ if (!next_statement(cstate, -1, -1, STATEMENT_END_BRACKET))
 		return 0;
 // now jump to ep 1 true (before	expression X evaluated)
- add_intercode(IC_JUMP_EXIT_POINT_TRUE, main_exit_point, 0, 0);
+ add_intercode(cstate, IC_JUMP_EXIT_POINT_TRUE, main_exit_point, 0, 0);
 
 // exit point 2 true
- add_intercode(IC_EXIT_POINT_TRUE, conditional_exit_point, 0, 0);
+ add_intercode(cstate, IC_EXIT_POINT_TRUE, conditional_exit_point, 0, 0);
 // statement Z
- if (!next_statement(main_exit_point, main_exit_point, STATEMENT_END_SEMICOLON))
+ if (!next_statement(cstate, main_exit_point, main_exit_point, STATEMENT_END_SEMICOLON))
 		return 0;
- add_intercode(IC_JUMP_EXIT_POINT_TRUE, statement_exit_point, 0, 0);
+ add_intercode(cstate, IC_JUMP_EXIT_POINT_TRUE, statement_exit_point, 0, 0);
 
 // final exit points:
- add_intercode(IC_EXIT_POINT_FALSE, main_exit_point, 0, 0); // reached from break within statement Z
- add_intercode(IC_EXIT_POINT_FALSE, conditional_exit_point, 0, 0); // reached from X evaluating to false
+ add_intercode(cstate, IC_EXIT_POINT_FALSE, main_exit_point, 0, 0); // reached from break within statement Z
+ add_intercode(cstate, IC_EXIT_POINT_FALSE, conditional_exit_point, 0, 0); // reached from X evaluating to false
 
 	return 1;
 
 }
 
 // for gosub, an OP_push_return_address should be written just before this function is called
-static int parse_goto_or_gosub(void)
+static int parse_goto_or_gosub(struct cstatestruct* cstate)
 {
 
 // goto is a little tricky because labels don't have to be declared or defined beforehand.
 
  struct ctokenstruct ctoken;
 
- if (!read_next(&ctoken))
+ if (!read_next(cstate, &ctoken))
 		return 0;
 
 	if (ctoken.type == CTOKEN_TYPE_IDENTIFIER_LABEL // previously defined
 		|| ctoken.type == CTOKEN_TYPE_IDENTIFIER_LABEL_UNDEFINED) // previously used by a goto but not yet defined
 	{
-		add_intercode(IC_GOTO_LABEL, ctoken.identifier_index, 0, 0);
+		add_intercode(cstate, IC_GOTO_LABEL, ctoken.identifier_index, 0, 0);
 		return 1;
 	}
 
 	if (ctoken.type == CTOKEN_TYPE_IDENTIFIER_NEW)
 	{
-		identifier[ctoken.identifier_index].type = CTOKEN_TYPE_IDENTIFIER_LABEL_UNDEFINED;
-		add_intercode(IC_GOTO_LABEL, ctoken.identifier_index, 0, 0);
+		cstate->identifier[ctoken.identifier_index].type = CTOKEN_TYPE_IDENTIFIER_LABEL_UNDEFINED;
+		add_intercode(cstate, IC_GOTO_LABEL, ctoken.identifier_index, 0, 0);
 		return 1;
 	}
 
-	return comp_error_text("goto/gosub must be followed by a label", &ctoken);
+	return comp_error_text(cstate, "goto/gosub must be followed by a label", &ctoken);
 
 }
 
-static int parse_enum(void)
+static int parse_enum(struct cstatestruct* cstate)
 {
 
-	if (!expect_punctuation(CTOKEN_SUBTYPE_BRACE_OPEN))
-	 return comp_error_text("expected { after enum", NULL);
+	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACE_OPEN))
+	 return comp_error_text(cstate, "expected { after enum", NULL);
 
 	struct ctokenstruct ctoken;
 	int enum_id_index;
@@ -862,27 +1039,27 @@ static int parse_enum(void)
 
 	while(TRUE)
 	{
-		if (!read_next(&ctoken))
+		if (!read_next(cstate, &ctoken))
 			return 0;
 		if (ctoken.type == CTOKEN_TYPE_PUNCTUATION
 			&& ctoken.subtype == CTOKEN_SUBTYPE_BRACE_CLOSE)
 			return 1; // finished (also checked for below)
 		if (ctoken.type != CTOKEN_TYPE_IDENTIFIER_NEW)
-			return comp_error_text("enum must be an unused identifier", &ctoken);
+			return comp_error_text(cstate, "enum must be an unused identifier", &ctoken);
 		enum_id_index = ctoken.identifier_index;
-		identifier[enum_id_index].type = CTOKEN_TYPE_ENUM;
+		cstate->identifier[enum_id_index].type = CTOKEN_TYPE_ENUM;
 // now check for what comes right after enum
-		if (!read_next(&ctoken))
+		if (!read_next(cstate, &ctoken))
 			return 0;
 		if (ctoken.type == CTOKEN_TYPE_OPERATOR_ASSIGN
 			&& ctoken.subtype == CTOKEN_SUBTYPE_EQ)
 		{
-			if (!expect_constant(&ctoken))
-				return comp_error_text("value assigned to enum must be a single constant number", &ctoken);
+			if (!expect_constant(cstate, &ctoken))
+				return comp_error_text(cstate, "value assigned to enum must be a single constant number", &ctoken);
 //	 	identifier[enum_id_index].value = ctoken.number_value;
 			enum_value = ctoken.number_value;// + 1;
 // now read in next thing , which should be , or }
-		 if (!read_next(&ctoken))
+		 if (!read_next(cstate, &ctoken))
 			 return 0;
 		}
 		if (ctoken.type == CTOKEN_TYPE_PUNCTUATION)
@@ -890,18 +1067,18 @@ static int parse_enum(void)
 			switch(ctoken.subtype)
 			{
 			 case CTOKEN_SUBTYPE_COMMA:
-			 	identifier[enum_id_index].value = enum_value;
+			 	cstate->identifier[enum_id_index].value = enum_value;
 			 	enum_value++;
 			 	continue; // read next one
 			 case CTOKEN_SUBTYPE_BRACE_CLOSE:
-			 	identifier[enum_id_index].value = enum_value;
+			 	cstate->identifier[enum_id_index].value = enum_value;
 					return 1; // finished (also checked for above)
 				default:
-					return comp_error_text("syntax error in enum list", &ctoken);
+					return comp_error_text(cstate, "syntax error in enum list", &ctoken);
 			}
 		}
 		 else
-				return comp_error_text("syntax error in enum list", &ctoken);
+				return comp_error_text(cstate, "syntax error in enum list", &ctoken);
 	} // back through the loop
 
 };
@@ -910,7 +1087,7 @@ static int parse_enum(void)
 #define SWITCH_JUMP_TABLE_MAX 32
 // if either of these values is changed, need to change error messages below as well.
 
-static int parse_switch(int exit_point_continue)
+static int parse_switch(struct cstatestruct* cstate, int exit_point_continue)
 {
 
  struct ctokenstruct ctoken;
@@ -924,118 +1101,118 @@ static int parse_switch(int exit_point_continue)
 
  int i;
 
- int end_epoint = allocate_exit_point(EXPOINT_TYPE_BASIC); // this is the point at the end of the switch
+ int end_epoint = allocate_exit_point(cstate, EXPOINT_TYPE_BASIC); // this is the point at the end of the switch
  if (end_epoint == -1)
 		return 0;
- int jump_table_epoint = allocate_exit_point(EXPOINT_TYPE_BASIC); // this is the point at the start of the jump table
+ int jump_table_epoint = allocate_exit_point(cstate, EXPOINT_TYPE_BASIC); // this is the point at the start of the jump table
  if (jump_table_epoint == -1)
 		return 0;
- int default_epoint = allocate_exit_point(EXPOINT_TYPE_SWITCH);
+ int default_epoint = allocate_exit_point(cstate, EXPOINT_TYPE_SWITCH);
  if (default_epoint == -1)
 		return 0;
 
- if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_OPEN))
-		return comp_error_text("expected ( after switch", NULL);
-	if (!next_expression(-1, BIND_EXPRESSION_START))
+ if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_OPEN))
+		return comp_error_text(cstate, "expected ( after switch", NULL);
+	if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		return 0;
- if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_CLOSE))
-		return comp_error_text("expected ) after switch expression", NULL);
+ if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_CLOSE))
+		return comp_error_text(cstate, "expected ) after switch expression", NULL);
 
- if (!expect_punctuation(CTOKEN_SUBTYPE_BRACE_OPEN))
-		return comp_error_text("expected { after switch()", NULL);
+ if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACE_OPEN))
+		return comp_error_text(cstate, "expected { after switch()", NULL);
 
-	switch_intercode = cstate.ic_pos;
+	switch_intercode = cstate->ic_pos;
 	if (switch_intercode >= INTERCODE_SIZE - 1)
 		return 0; // add_intercode() finds this error and notifies user, but does not break compilation.
-	add_intercode(IC_SWITCH, jump_table_epoint, 0, 0); // second and third operands will be corrected later (to lowest and highest values)
+	add_intercode(cstate, IC_SWITCH, jump_table_epoint, 0, 0); // second and third operands will be corrected later (to lowest and highest values)
 
  while(TRUE)
 	{
-		if (!peek_next(&ctoken))
-			return comp_error_text("reached end of source within switch?", NULL);
+		if (!peek_next(cstate, &ctoken))
+			return comp_error_text(cstate, "reached end of source within switch?", NULL);
 		if (ctoken.type == CTOKEN_TYPE_IDENTIFIER_C_KEYWORD)
 		{
 			switch(ctoken.identifier_index)
 			{
 				case KEYWORD_C_CASE:
-			  if (!read_next(&ctoken)) // read in the ctoken just peeked at
+			  if (!read_next(cstate, &ctoken)) // read in the ctoken just peeked at
 				  return 0; // shouldn't fail
-			  if (!expect_constant(&ctoken)) // read number
-			   return comp_error_text("expected constant number after case", &ctoken);
+			  if (!expect_constant(cstate, &ctoken)) // read number
+			   return comp_error_text(cstate, "expected constant number after case", &ctoken);
 			  if (current_case_entry >= SWITCH_CASES-1)
-  					return comp_error_text("too many cases in switch (maximum currently 32)", &ctoken);
+  					return comp_error_text(cstate, "too many cases in switch (maximum currently 32)", &ctoken);
 			  case_value [current_case_entry] = ctoken.number_value;
 			  if (ctoken.number_value < lowest_case)
 				  lowest_case = ctoken.number_value;
 			  if (ctoken.number_value > highest_case)
 				  highest_case = ctoken.number_value;
-			  case_epoint [current_case_entry] = allocate_exit_point(EXPOINT_TYPE_SWITCH);
+			  case_epoint [current_case_entry] = allocate_exit_point(cstate, EXPOINT_TYPE_SWITCH);
 			  if (case_epoint [current_case_entry] == -1)
 				  return 0;
-			  if (!expect_punctuation(CTOKEN_SUBTYPE_COLON))
-				  return comp_error_text("expected : after case value", NULL);
-			  add_intercode(IC_EXIT_POINT_TRUE, case_epoint [current_case_entry], 0, 0);
+			  if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_COLON))
+				  return comp_error_text(cstate, "expected : after case value", NULL);
+			  add_intercode(cstate, IC_EXIT_POINT_TRUE, case_epoint [current_case_entry], 0, 0);
 			  current_case_entry++;
 			  continue; // end case case
 			 case KEYWORD_C_DEFAULT:
-			  if (!read_next(&ctoken)) // read in the ctoken just peeked at
+			  if (!read_next(cstate, &ctoken)) // read in the ctoken just peeked at
 				  return 0; // shouldn't fail
 			  if (default_case)
-				  return comp_error_text("switch has more than one default?", &ctoken);
-			  if (!expect_punctuation(CTOKEN_SUBTYPE_COLON))
-				  return comp_error_text("expected : after default", NULL);
-			  add_intercode(IC_EXIT_POINT_TRUE, default_epoint, 0, 0);
+				  return comp_error_text(cstate, "switch has more than one default?", &ctoken);
+			  if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_COLON))
+				  return comp_error_text(cstate, "expected : after default", NULL);
+			  add_intercode(cstate, IC_EXIT_POINT_TRUE, default_epoint, 0, 0);
 			  default_case = 1;
 			  continue;
 			 case KEYWORD_C_BREAK:
-			  if (!read_next(&ctoken)) // read in the ctoken just peeked at
+			  if (!read_next(cstate, &ctoken)) // read in the ctoken just peeked at
 				  return 0; // shouldn't fail
-			  add_intercode(IC_JUMP_EXIT_POINT_FALSE, end_epoint, 0, 0);
+			  add_intercode(cstate, IC_JUMP_EXIT_POINT_FALSE, end_epoint, 0, 0);
 				 continue;
 		 } // end keywords switch
 		} // end keywords
 		if (ctoken.type == CTOKEN_TYPE_PUNCTUATION
 			&& ctoken.subtype == CTOKEN_SUBTYPE_BRACE_CLOSE)
 		{
-			if (!read_next(&ctoken)) // read in the ctoken just peeked at
+			if (!read_next(cstate, &ctoken)) // read in the ctoken just peeked at
 				return 0; // shouldn't fail
 			break; // finished!
 		}
-		if (!next_statement(end_epoint, exit_point_continue, STATEMENT_END_SEMICOLON))
+		if (!next_statement(cstate, end_epoint, exit_point_continue, STATEMENT_END_SEMICOLON))
 			return 0;
 	} // end switch statement loop
 
 // add a break at the end of the switch code:
- add_intercode(IC_JUMP_EXIT_POINT_FALSE, end_epoint, 0, 0);
+ add_intercode(cstate, IC_JUMP_EXIT_POINT_FALSE, end_epoint, 0, 0);
 
 // now we need to assemble the jump table.
 
 // first check that the switch isn't empty:
  if (highest_case == -80000) // this is impossible if there have been any cases (as -80000 is not a valid s16b value)
-		return comp_error_text("switch without cases", NULL); // should this really be an error?
+		return comp_error_text(cstate, "switch without cases", NULL); // should this really be an error?
 
 	int jump_table_size = (highest_case - lowest_case) + 1;
 
 	if (jump_table_size >= SWITCH_JUMP_TABLE_MAX)
-		return comp_error_text("difference between lowest and highest case is too great (max is 32)", NULL);
+		return comp_error_text(cstate, "difference between lowest and highest case is too great (max is 32)", NULL);
 
 // the switch instruction needs to know the lowest and highest cases: (value [0] is the exit point at the start of the jump table)
-	cstate.intercode[switch_intercode].value [1] = lowest_case;
-	cstate.intercode[switch_intercode].value [2] = highest_case;
+	cstate->intercode[switch_intercode].value [1] = lowest_case;
+	cstate->intercode[switch_intercode].value [2] = highest_case;
 
 // default exit point is just before the start of the rest of the jump table:
-	add_intercode(IC_JUMP_TABLE, default_epoint, 0, 0); // this will appear as a number in the bcode
+	add_intercode(cstate, IC_JUMP_TABLE, default_epoint, 0, 0); // this will appear as a number in the bcode
 
-	add_intercode(IC_EXIT_POINT_TRUE, jump_table_epoint, 0, 0);
+	add_intercode(cstate, IC_EXIT_POINT_TRUE, jump_table_epoint, 0, 0);
 
- int jump_table_intercode_start = cstate.ic_pos;
+ int jump_table_intercode_start = cstate->ic_pos;
  if (jump_table_intercode_start >= INTERCODE_SIZE + SWITCH_JUMP_TABLE_MAX + 2)
-		return comp_error_text("not enough space in bcode for jump table", NULL);
+		return comp_error_text(cstate, "not enough space in bcode for jump table", NULL);
 
 // fill the jump table with jumps to the default:
 	for (i = 0; i < jump_table_size; i ++)
 	{
-		add_intercode(IC_JUMP_TABLE, default_epoint, 0, 0);
+		add_intercode(cstate, IC_JUMP_TABLE, default_epoint, 0, 0);
 	}
 
 // current_case_entry++;
@@ -1047,20 +1224,20 @@ static int parse_switch(int exit_point_continue)
 	{
 //  fpr("\n jt %i jt_start %i setting intercode[%i] to %i", i, jump_table_intercode_start, jump_table_intercode_start + (case_value [i] - lowest_case), case_epoint [i]);
 // check for duplicate cases (remember that case_value array isn't sorted at all)
-		if (cstate.intercode[jump_table_intercode_start + case_value [i] - lowest_case].value [0] != default_epoint)
+		if (cstate->intercode[jump_table_intercode_start + case_value [i] - lowest_case].value [0] != default_epoint)
 		{
 			char duplicate_case_error [40];
 			snprintf(duplicate_case_error, 40, "duplicate case value %i", case_value [i]);
-			return comp_error_text(duplicate_case_error, NULL);
+			return comp_error_text(cstate, duplicate_case_error, NULL);
 		}
-		cstate.intercode[jump_table_intercode_start + (case_value [i] - lowest_case)].value [0] = case_epoint [i];
+		cstate->intercode[jump_table_intercode_start + (case_value [i] - lowest_case)].value [0] = case_epoint [i];
 	}
 
 // add the exit point for breaks within the switch:
- add_intercode(IC_EXIT_POINT_FALSE, end_epoint, 0, 0);
+ add_intercode(cstate, IC_EXIT_POINT_FALSE, end_epoint, 0, 0);
 // finally, if no default, add a default exit point:
  if (default_case == 0)
-  add_intercode(IC_EXIT_POINT_TRUE, default_epoint, 0, 0);
+  add_intercode(cstate, IC_EXIT_POINT_TRUE, default_epoint, 0, 0);
 
  return 1;
 
@@ -1068,7 +1245,7 @@ static int parse_switch(int exit_point_continue)
 
 
 // print_op and printA_op are set to the print or bubble ops as appropriate
-static int parse_printf(int print_op, int printA_op)
+static int parse_printf(struct cstatestruct* cstate, int print_op, int printA_op)
 {
 // assume that STRING_MAX_LENGTH >= BUBBLE_TEXT_LENGTH_MAX
  char raw_string [STRING_MAX_LENGTH];
@@ -1076,24 +1253,24 @@ static int parse_printf(int print_op, int printA_op)
  raw_string [0] = '\0';
  target_string [0] = '\0';
 
- if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_OPEN))
-		return comp_error_text("expected open bracket after printf/bubble", NULL);
- if (!expect_punctuation(CTOKEN_SUBTYPE_QUOTES))
-		return comp_error_text("expected open quote after printf/bubble", NULL);
+ if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_OPEN))
+		return comp_error_text(cstate, "expected open bracket after printf/bubble", NULL);
+ if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_QUOTES))
+		return comp_error_text(cstate, "expected open quote after printf/bubble", NULL);
 
 	int read_char;
 	int raw_string_length = 0;
 
 	while(TRUE)
 	{
-		read_char = c_get_next_char_from_scode();
+		read_char = c_get_next_char_from_scode(cstate);
 		if (read_char == REACHED_END_OF_SCODE)
- 		return comp_error_text("reached end of source inside string", NULL);
+ 		return comp_error_text(cstate, "reached end of source inside string", NULL);
 		if (read_char == 0)
- 		return comp_error_text("found null terminator inside string?", NULL);
+ 		return comp_error_text(cstate, "found null terminator inside string?", NULL);
 
   if (raw_string_length >= STRING_MAX_LENGTH - 2) // should probably check this against BUBBLE_TEXT_LENGTH_MAX if relevant...
- 		return comp_error_text("string too long", NULL);
+ 		return comp_error_text(cstate, "string too long", NULL);
 
  	if (read_char == '"')
  	 break;
@@ -1121,24 +1298,24 @@ static int parse_printf(int print_op, int printA_op)
 // if there is something in target_string_pos that needs to be printed, write intercode to print it:
 							if (target_string_pos > 0)
 							{
-								if (!add_print_string(target_string, target_string_pos, print_op))
+								if (!add_print_string(cstate, target_string, target_string_pos, print_op))
 									return 0;
 								target_string_pos = 0;
 							}
 							// now read expression after end of string:
-       if (check_next(CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACKET_CLOSE))
- 		     return comp_error_text("not enough arguments for format", NULL);
- 		    if (!expect_punctuation(CTOKEN_SUBTYPE_COMMA))
- 		     return comp_error_text("expected comma in format argument list", NULL);
- 		    if (!next_expression(-1, BIND_EXPRESSION_START))
+       if (check_next(cstate, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACKET_CLOSE))
+ 		     return comp_error_text(cstate, "not enough arguments for format", NULL);
+ 		    if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_COMMA))
+ 		     return comp_error_text(cstate, "expected comma in format argument list", NULL);
+ 		    if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 								return 0;
-						 add_intercode(IC_OP, printA_op, 0, 0); // prints contents of register A (which should have been set as result of parsing expression)
+						 add_intercode(cstate, IC_OP, printA_op, 0, 0); // prints contents of register A (which should have been set as result of parsing expression)
 						 target_string_pos = 0;
 //						 i--;
 						 continue;
 						}
 						 else
-								return comp_error_text("unrecognised format specifier (only %i currently supported)", NULL);
+								return comp_error_text(cstate, "unrecognised format specifier (only %i currently supported)", NULL);
 					}
 		} // end if raw_string [i] == '%'
 		if (raw_string [i] == '\\')
@@ -1155,7 +1332,7 @@ static int parse_printf(int print_op, int printA_op)
 						 continue;
 						}
 						 else
-								return comp_error_text("unrecognised escape sequence (only \\\\ and \\n currently supported)", NULL);
+								return comp_error_text(cstate, "unrecognised escape sequence (only \\\\ and \\n currently supported)", NULL);
 					}
 		}
 		target_string [target_string_pos] = raw_string [i];
@@ -1164,18 +1341,18 @@ static int parse_printf(int print_op, int printA_op)
 
 	if (target_string_pos > 0)
 	{
-		if (!add_print_string(target_string, target_string_pos, print_op))
+		if (!add_print_string(cstate, target_string, target_string_pos, print_op))
 			return 0;
 	}
 
 
- if (check_next(CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))
-  return comp_error_text("too many arguments for format", NULL);
+ if (check_next(cstate, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))
+  return comp_error_text(cstate, "too many arguments for format", NULL);
 
 // if (!expect_punctuation(CTOKEN_SUBTYPE_QUOTES))
 //		return comp_error_text("expected closing quote at end of printf statement", NULL);
- if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_CLOSE))
-		return comp_error_text("expected closing bracket after printf/bubble (too many arguments?)", NULL);
+ if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_CLOSE))
+		return comp_error_text(cstate, "expected closing bracket after printf/bubble (too many arguments?)", NULL);
 // if (!expect_punctuation(CTOKEN_SUBTYPE_SEMICOLON))
 //		return comp_error_text("expected semicolon at end of printf", NULL);
 
@@ -1185,24 +1362,24 @@ static int parse_printf(int print_op, int printA_op)
 
 // source_string shouldn't be null terminated within string_length (parse_printf checks for this)
 // formatting specifiers are ignored
-static int add_print_string(char* source_string, int string_length, int print_op)
+static int add_print_string(struct cstatestruct* cstate, char* source_string, int string_length, int print_op)
 {
-//fpr("\n*** add_print_string line %i [%s] length %i", cstate.src_line, source_string, string_length);
-	add_intercode(IC_OP, print_op, 0, 0);
+//fpr("\n*** add_print_string line %i [%s] length %i", cstate->src_line, source_string, string_length);
+	add_intercode(cstate, IC_OP, print_op, 0, 0);
 
 	int i;
 
 	for (i = 0; i < string_length; i ++)
 	{
-		add_intercode(IC_NUMBER, source_string[i], 0, 0);
+		add_intercode(cstate, IC_NUMBER, source_string[i], 0, 0);
 	}
 //	char temp_string [100];
 //	snprintf(temp_string, string_length, source_string);
 //fpr("\n add_string<%s>", temp_string);
 // terminate string with zero:
-	add_intercode(IC_NUMBER, 0, 0, 0);
+	add_intercode(cstate, IC_NUMBER, 0, 0, 0);
 
-	if (cstate.error != CERR_NONE)
+	if (cstate->error != CERR_NONE)
 		return 0;
 
 	return 1;
@@ -1261,80 +1438,80 @@ iffalse_jump <to exit point of if statement>
 
 // call this just after the "process" keyword is encountered in an expression
 //  - unlike "component", "process" should not occur at the start of a statement.
-static int parse_process_expression(int statement_start)
+static int parse_process_expression(struct cstatestruct* cstate, int statement_start)
 {
 
 	struct ctokenstruct ctoken;
 
-	if (!expect_punctuation(CTOKEN_SUBTYPE_SQUARE_OPEN))
-		return comp_error_text("expected [ after 'process'", NULL);
+	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_SQUARE_OPEN))
+		return comp_error_text(cstate, "expected [ after 'process'", NULL);
 
-	if (!next_expression(-1, BIND_EXPRESSION_START))
+	if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		return 0;
- add_intercode(IC_OP, OP_pushA, 0, 0);
+ add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
 
-	if (!expect_punctuation(CTOKEN_SUBTYPE_SQUARE_CLOSE))
-		return comp_error_text("expected ] after process index", NULL);
-	if (!expect_punctuation(CTOKEN_SUBTYPE_FULL_STOP))
-		return comp_error_text("expected full stop after process index", NULL);
+	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_SQUARE_CLOSE))
+		return comp_error_text(cstate, "expected ] after process index", NULL);
+	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_FULL_STOP))
+		return comp_error_text(cstate, "expected full stop after process index", NULL);
 
-	if (!read_next(&ctoken))
+	if (!read_next(cstate, &ctoken))
 		return 0;
 // There are the following possibilities here:
 //  - process[].core_method()
 //  - process[].component[].component_method()
 
  if (ctoken.type == CTOKEN_TYPE_IDENTIFIER_CMETHOD)
-		return parse_core_method_call(identifier[ctoken.identifier_index].value,  // see c_keywords.c for a list of these in the identifier initialiser
+		return parse_core_method_call(cstate, cstate->identifier[ctoken.identifier_index].value,  // see c_keywords.c for a list of these in the identifier initialiser
 																																statement_start, 1);
 
  if (ctoken.type == CTOKEN_TYPE_IDENTIFIER_NON_C_KEYWORD
 		&& ctoken.identifier_index == KEYWORD_C_OBJECT)
-		return parse_member_expression(statement_start, 0, 1); // 0 means an object method call is not accepted.
+		return parse_member_expression(cstate, statement_start, 0, 1); // 0 means an object method call is not accepted.
 
- return comp_error_text("expected process method or component reference after process", &ctoken);
+ return comp_error_text(cstate, "expected process method or component reference after process", &ctoken);
 
 
 }
 
-static int parse_core_method_call(int cmethod_index, int statement_start, int external_process_call)
+static int parse_core_method_call(struct cstatestruct* cstate, int cmethod_index, int statement_start, int external_process_call)
 {
 
 		int i;
 
-	 if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_OPEN))
- 		return comp_error_text("expected opening bracket after process method", NULL);
+	 if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_OPEN))
+ 		return comp_error_text(cstate, "expected opening bracket after process method", NULL);
 
 		if (cmethod_call_type[cmethod_index].parameters > 0)
 		{
 			for (i = 0; i < cmethod_call_type[cmethod_index].parameters; i++)
 			{
- 	  if (!next_expression(-1, BIND_EXPRESSION_START))
+ 	  if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		   return 0;
-		  add_intercode(IC_OP, OP_pushA, 0, 0);
+		  add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
 				if (i < cmethod_call_type[cmethod_index].parameters - 1)
 				{
-					if (!expect_punctuation(CTOKEN_SUBTYPE_COMMA))
-					 return comp_error_text("expected comma after process method parameter", NULL);
+					if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_COMMA))
+					 return comp_error_text(cstate, "expected comma after process method parameter", NULL);
 				}
 			}
 		}
 
-  if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_CLOSE))
+  if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_CLOSE))
 		{
  		if (cmethod_call_type[cmethod_index].parameters == 0)
-	   return comp_error_text("expected closing bracket (this process method has no parameters)", NULL);
+	   return comp_error_text(cstate, "expected closing bracket (this process method has no parameters)", NULL);
 
-	  return comp_error_text("expected closing bracket after process method parameters", NULL);
+	  return comp_error_text(cstate, "expected closing bracket after process method parameters", NULL);
 		}
 // finally, add the call and the call method type:
   if (external_process_call)
-   add_intercode(IC_OP, OP_call_extern_core, cmethod_index, 0); // could test for process[-1] and optimise it to self core method call
+   add_intercode(cstate, IC_OP, OP_call_extern_core, cmethod_index, 0); // could test for process[-1] and optimise it to self core method call
     else
-     add_intercode(IC_OP, OP_call_core, cmethod_index, 0);
+     add_intercode(cstate, IC_OP, OP_call_core, cmethod_index, 0);
 
   if (statement_start)
-			comp_warning_text("process method call with no effect? (return value unused)"); // core methods are read only and shouldn't be entire statements
+			comp_warning_text(cstate, "process method call with no effect? (return value unused)"); // core methods are read only and shouldn't be entire statements
 
   return 1;
 
@@ -1342,60 +1519,60 @@ static int parse_core_method_call(int cmethod_index, int statement_start, int ex
 
 // call this just after the "component" keyword is encountered in an expression
 //  - also when it's found at the start of a statement
-static int parse_member_expression(int statement_start, int accept_object_method_call, int external_process_call)
+static int parse_member_expression(struct cstatestruct* cstate, int statement_start, int accept_object_method_call, int external_process_call)
 {
 
 	struct ctokenstruct ctoken;
 
-	if (!expect_punctuation(CTOKEN_SUBTYPE_SQUARE_OPEN))
-		return comp_error_text("expected [ after 'component'", NULL);
+	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_SQUARE_OPEN))
+		return comp_error_text(cstate, "expected [ after 'component'", NULL);
 
-	if (!next_expression(-1, BIND_EXPRESSION_START))
+	if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		return 0;
- add_intercode(IC_OP, OP_pushA, 0, 0);
+ add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
 
-	if (!expect_punctuation(CTOKEN_SUBTYPE_SQUARE_CLOSE))
-		return comp_error_text("expected ] after component index", NULL);
-	if (!expect_punctuation(CTOKEN_SUBTYPE_FULL_STOP))
-		return comp_error_text("expected full stop after component index", NULL);
+	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_SQUARE_CLOSE))
+		return comp_error_text(cstate, "expected ] after component index", NULL);
+	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_FULL_STOP))
+		return comp_error_text(cstate, "expected full stop after component index", NULL);
 
-	if (!read_next(&ctoken))
+	if (!read_next(cstate, &ctoken))
 		return 0;
 
 	if (ctoken.type == CTOKEN_TYPE_IDENTIFIER_MMETHOD)
 	{
-	 if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_OPEN))
- 		return comp_error_text("expected opening bracket after component method", NULL);
-		int mmethod_index = identifier[ctoken.identifier_index].value; // see c_keywords.c for a list of these in the identifier initialiser
+	 if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_OPEN))
+ 		return comp_error_text(cstate, "expected opening bracket after component method", NULL);
+		int mmethod_index = cstate->identifier[ctoken.identifier_index].value; // see c_keywords.c for a list of these in the identifier initialiser
 		int i;
 		if (mmethod_call_type[mmethod_index].parameters > 0)
 		{
 			for (i = 0; i < mmethod_call_type[mmethod_index].parameters; i++)
 			{
- 	  if (!next_expression(-1, BIND_EXPRESSION_START))
+ 	  if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		   return 0;
-		  add_intercode(IC_OP, OP_pushA, 0, 0);
+		  add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
 				if (i < mmethod_call_type[mmethod_index].parameters - 1)
 				{
-					if (!expect_punctuation(CTOKEN_SUBTYPE_COMMA))
-					 return comp_error_text("expected comma after component method parameter", NULL);
+					if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_COMMA))
+					 return comp_error_text(cstate, "expected comma after component method parameter", NULL);
 				}
 			}
 		}
-	 if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_CLOSE))
+	 if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_CLOSE))
 		{
  		if (mmethod_call_type[mmethod_index].parameters == 0)
-	   return comp_error_text("expected closing bracket (this component method has no parameters)", NULL);
+	   return comp_error_text(cstate, "expected closing bracket (this component method has no parameters)", NULL);
 
- 		return comp_error_text("expected closing bracket after component method parameters", NULL);
+ 		return comp_error_text(cstate, "expected closing bracket after component method parameters", NULL);
 		}
 // finally, add the call and the call method type:
   if (external_process_call)
-   add_intercode(IC_OP, OP_call_extern_member, mmethod_index, 0);
+   add_intercode(cstate, IC_OP, OP_call_extern_member, mmethod_index, 0);
     else
-     add_intercode(IC_OP, OP_call_member, mmethod_index, 0);
+     add_intercode(cstate, IC_OP, OP_call_member, mmethod_index, 0);
   if (statement_start)
-			comp_warning_text("component method call with no effect?");
+			comp_warning_text(cstate, "component method call with no effect?");
 		return 1;
 	}
 
@@ -1405,76 +1582,76 @@ static int parse_member_expression(int statement_start, int accept_object_method
 // object methods.
 // These are not allowed if the component reference is part of a process expression:
   if (!accept_object_method_call)
-			return comp_error_text("can't call an object method here", &ctoken);
+			return comp_error_text(cstate, "can't call an object method here", &ctoken);
 // First, read which object:
-	 if (!expect_punctuation(CTOKEN_SUBTYPE_SQUARE_OPEN))
- 		return comp_error_text("expected [ after 'object'", NULL);
- 	if (!next_expression(-1, BIND_EXPRESSION_START))
+	 if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_SQUARE_OPEN))
+ 		return comp_error_text(cstate, "expected [ after 'object'", NULL);
+ 	if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		 return 0;
-  add_intercode(IC_OP, OP_pushA, 0, 0);
-	 if (!expect_punctuation(CTOKEN_SUBTYPE_SQUARE_CLOSE))
- 		return comp_error_text("expected ] after object index", NULL);
- 	if (!expect_punctuation(CTOKEN_SUBTYPE_FULL_STOP))
-		 return comp_error_text("expected full stop after object index", NULL);
+  add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
+	 if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_SQUARE_CLOSE))
+ 		return comp_error_text(cstate, "expected ] after object index", NULL);
+ 	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_FULL_STOP))
+		 return comp_error_text(cstate, "expected full stop after object index", NULL);
 // (TO DO: if component and object indices are constants, should be able to confirm that this method is valid for the known object type)
 // now expect an object method:
-  if (!read_next(&ctoken))
+  if (!read_next(cstate, &ctoken))
 			return 0;
 		if (ctoken.type != CTOKEN_TYPE_IDENTIFIER_OMETHOD)
-			return comp_error_text("expected object method after full stop", &ctoken);
-	 if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_OPEN))
- 		return comp_error_text("expected opening bracket after object method", NULL);
-		int omethod_index = identifier[ctoken.identifier_index].value; // see c_keywords.c for a list of these in the identifier initialiser
+			return comp_error_text(cstate, "expected object method after full stop", &ctoken);
+	 if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_OPEN))
+ 		return comp_error_text(cstate, "expected opening bracket after object method", NULL);
+		int omethod_index = cstate->identifier[ctoken.identifier_index].value; // see c_keywords.c for a list of these in the identifier initialiser
 		int i;
 		if (call_type[omethod_index].parameters > 0)
 		{
 			for (i = 0; i < call_type[omethod_index].parameters; i++)
 			{
- 	  if (!next_expression(-1, BIND_EXPRESSION_START))
+ 	  if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		   return 0;
-		  add_intercode(IC_OP, OP_pushA, 0, 0);
+		  add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
 				if (i < call_type[omethod_index].parameters - 1)
 				{
-					if (!expect_punctuation(CTOKEN_SUBTYPE_COMMA))
-					 return comp_error_text("expected comma after object method parameter", NULL);
+					if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_COMMA))
+					 return comp_error_text(cstate, "expected comma after object method parameter", NULL);
 				}
 			}
 		}
-	 if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_CLOSE))
+	 if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_CLOSE))
 		{
 			if (call_type[omethod_index].parameters == 0)
- 		 return comp_error_text("expected closing bracket (this object method has no parameters)", NULL);
+ 		 return comp_error_text(cstate, "expected closing bracket (this object method has no parameters)", NULL);
 
- 		return comp_error_text("expected closing bracket after object method parameters", NULL);
+ 		return comp_error_text(cstate, "expected closing bracket after object method parameters", NULL);
 		}
 // finally, add the call and the call method type:
-  add_intercode(IC_OP, OP_call_object, omethod_index, 0);
+  add_intercode(cstate, IC_OP, OP_call_object, omethod_index, 0);
   return 1;
 	}
 
- return comp_error_text("expected component method or object reference after component", &ctoken);
+ return comp_error_text(cstate, "expected component method or object reference after component", &ctoken);
 
 }
 
 
-static int parse_std_method_call(int smethod_index)
+static int parse_std_method_call(struct cstatestruct* cstate, int smethod_index)
 {
 		int i;
 
-	 if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_OPEN))
- 		return comp_error_text("expected opening bracket after std method", NULL);
+	 if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_OPEN))
+ 		return comp_error_text(cstate, "expected opening bracket after std method", NULL);
 
 		if (smethod_call_type[smethod_index].parameters > 0)
 		{
 			for (i = 0; i < smethod_call_type[smethod_index].parameters; i++)
 			{
- 	  if (!next_expression(-1, BIND_EXPRESSION_START))
+ 	  if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		   return 0;
-		  add_intercode(IC_OP, OP_pushA, 0, 0);
+		  add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
 				if (i < smethod_call_type[smethod_index].parameters - 1)
 				{
-					if (!expect_punctuation(CTOKEN_SUBTYPE_COMMA))
-					 return comp_error_text("expected comma after std method parameter", NULL);
+					if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_COMMA))
+					 return comp_error_text(cstate, "expected comma after std method parameter", NULL);
 				}
 			}
 		}
@@ -1486,35 +1663,35 @@ static int parse_std_method_call(int smethod_index)
 			while(TRUE)
 			{
 // must have at least one parameter
- 	  if (!next_expression(-1, BIND_EXPRESSION_START))
+ 	  if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		   return 0;
-		  add_intercode(IC_OP, OP_pushA, 0, 0);
+		  add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
 		  i ++;
- 	  if (check_next(CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACKET_CLOSE))
+ 	  if (check_next(cstate, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACKET_CLOSE))
  	   break;
-				if (!expect_punctuation(CTOKEN_SUBTYPE_COMMA))
-				 return comp_error_text("expected comma or bracket after parameter in variable-length call", NULL);
+				if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_COMMA))
+				 return comp_error_text(cstate, "expected comma or bracket after parameter in variable-length call", NULL);
  			if (i > SMETHOD_VARIABLE_PARAMS_MAX)
-	 			return comp_error_text("too many parameters in variable-length call", NULL);
+	 			return comp_error_text(cstate, "too many parameters in variable-length call", NULL);
 			}
 			if (i < smethod_call_type[smethod_index].parameters * -1)
-				return comp_error_text("too few parameters in variable-length call", NULL);
+				return comp_error_text(cstate, "too few parameters in variable-length call", NULL);
 
-   add_intercode(IC_OP, OP_call_std_var, smethod_index, i);
+   add_intercode(cstate, IC_OP, OP_call_std_var, smethod_index, i);
 
 		}
 		 else
 			{
-  	 if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_CLOSE))
+  	 if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_CLOSE))
 				{
     		if (smethod_call_type[smethod_index].parameters == 0)
- 	  	  return comp_error_text("expected closing bracket (this std method has no parameters)", NULL);
+ 	  	  return comp_error_text(cstate, "expected closing bracket (this std method has no parameters)", NULL);
  	  	   else
- 	  	    return comp_error_text("expected closing bracket after std method parameters", NULL);
+ 	  	    return comp_error_text(cstate, "expected closing bracket after std method parameters", NULL);
 				}
 
 // finally, add the call and the call method type:
-    add_intercode(IC_OP, OP_call_std, smethod_index, 0);
+    add_intercode(cstate, IC_OP, OP_call_std, smethod_index, 0);
 
 			}
 
@@ -1529,37 +1706,37 @@ static int parse_std_method_call(int smethod_index)
 }
 
 
-static int parse_uni_method_call(int umethod_index)
+static int parse_uni_method_call(struct cstatestruct* cstate, int umethod_index)
 {
 		int i;
 
-	 if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_OPEN))
- 		return comp_error_text("expected opening bracket after uni method", NULL);
+	 if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_OPEN))
+ 		return comp_error_text(cstate, "expected opening bracket after uni method", NULL);
 
 		if (umethod_call_type[umethod_index].parameters > 0)
 		{
 			for (i = 0; i < umethod_call_type[umethod_index].parameters; i++)
 			{
- 	  if (!next_expression(-1, BIND_EXPRESSION_START))
+ 	  if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		   return 0;
-		  add_intercode(IC_OP, OP_pushA, 0, 0);
+		  add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
 				if (i < umethod_call_type[umethod_index].parameters - 1)
 				{
-					if (!expect_punctuation(CTOKEN_SUBTYPE_COMMA))
-					 return comp_error_text("expected comma after uni method parameter", NULL);
+					if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_COMMA))
+					 return comp_error_text(cstate, "expected comma after uni method parameter", NULL);
 				}
 			}
 		}
 
-	 if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_CLOSE))
+	 if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_CLOSE))
 		{
  		if (umethod_call_type[umethod_index].parameters == 0)
- 	  return comp_error_text("expected closing bracket (this std method has no parameters)", NULL);
+ 	  return comp_error_text(cstate, "expected closing bracket (this std method has no parameters)", NULL);
  	   else
- 	    return comp_error_text("expected closing bracket after std method parameters", NULL); // currently no different between uni and std methods
+ 	    return comp_error_text(cstate, "expected closing bracket after std method parameters", NULL); // currently no different between uni and std methods
 		}
 // finally, add the call and the call method type:
-  add_intercode(IC_OP, OP_call_uni, umethod_index, 0);
+  add_intercode(cstate, IC_OP, OP_call_uni, umethod_index, 0);
 
 //  if (statement_start)
 //			comp_warning_text("std method call with no effect? (return value unused)"); // core methods are read only and shouldn't be entire statements
@@ -1574,23 +1751,23 @@ static int parse_uni_method_call(int umethod_index)
 // it allows a class to be called by index (which can be a variable) rather than by name
 // e.g. class[2].set_power(0);
 // It isn't called for class declarations in process headers (see c_fix.c for that)
-static int parse_class_keyword_in_code(void)
+static int parse_class_keyword_in_code(struct cstatestruct* cstate)
 {
 
- if (!expect_punctuation(CTOKEN_SUBTYPE_SQUARE_OPEN))
-		return comp_error_text("expected opening square bracket after class keyword", NULL);
+ if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_SQUARE_OPEN))
+		return comp_error_text(cstate, "expected opening square bracket after class keyword", NULL);
 // read the index expression:
-	if (!next_expression(-1, BIND_EXPRESSION_START))
+	if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		return 0;
 // push the index (so a following class method call can find it on the stack)
- add_intercode(IC_OP, OP_pushA, 0, 0);
+ add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
 
- if (!expect_punctuation(CTOKEN_SUBTYPE_SQUARE_CLOSE))
-		return comp_error_text("expected closing square bracket after class index expression", NULL);
- if (!expect_punctuation(CTOKEN_SUBTYPE_FULL_STOP))
-		return comp_error_text("expected full stop after class index expression", NULL);
+ if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_SQUARE_CLOSE))
+		return comp_error_text(cstate, "expected closing square bracket after class index expression", NULL);
+ if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_FULL_STOP))
+		return comp_error_text(cstate, "expected full stop after class index expression", NULL);
 
- return parse_class_method_call();
+ return parse_class_method_call(cstate);
 
 }
 
@@ -1598,18 +1775,18 @@ static int parse_class_keyword_in_code(void)
 // call this when a class name is found in an expression.
 // it will interpret the name as a constant equal to the class's index
 //  unless it's followed by a full stop, which means a class method call
-static int parse_class_name_in_expression(int class_index)
+static int parse_class_name_in_expression(struct cstatestruct* cstate, int class_index)
 {
 
- if (check_next(CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_FULL_STOP))
+ if (check_next(cstate, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_FULL_STOP))
 	{
 // class method call code assumes that the class index has just been pushed to the stack:
-  add_intercode(IC_OP, OP_push_num, class_index, 0);
-		return parse_class_method_call();
+  add_intercode(cstate, IC_OP, OP_push_num, class_index, 0);
+		return parse_class_method_call(cstate);
 	}
 
 // otherwise, set A to the class index
-	add_intercode(IC_OP, OP_setA_num, class_index, 0);
+	add_intercode(cstate, IC_OP, OP_setA_num, class_index, 0);
 	return 1;
 
 }
@@ -1618,7 +1795,7 @@ static int parse_class_name_in_expression(int class_index)
 // call this after:
 //  - finding the full stop after the class name in a class method call
 //  - and then pushing the class index
-static int parse_class_method_call(void)
+static int parse_class_method_call(struct cstatestruct* cstate)
 {
 
  struct ctokenstruct ctoken;
@@ -1626,17 +1803,17 @@ static int parse_class_method_call(void)
 // fpr("\n pcmc ci %i", class_index);
 
 // next thing after the full stop should be the method name:
- if (!read_next(&ctoken))
-		return comp_error(CERR_READ_FAIL, NULL);
+ if (!read_next(cstate, &ctoken))
+		return comp_error(cstate, CERR_READ_FAIL, NULL);
 	if (ctoken.type != CTOKEN_TYPE_IDENTIFIER_OMETHOD)
-		return comp_error_text("expected object method after class reference", &ctoken);
+		return comp_error_text(cstate, "expected object method after class reference", &ctoken);
 
-		int omethod_index = identifier[ctoken.identifier_index].value; // see c_keywords.c for a list of these in the identifier initialiser
+		int omethod_index = cstate->identifier[ctoken.identifier_index].value; // see c_keywords.c for a list of these in the identifier initialiser
 
 //  fpr(" omi %i (params %i)", omethod_index, call_type[omethod_index].parameters);
 
-	 if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_OPEN))
- 		return comp_error_text("expected opening bracket after object method", NULL);
+	 if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_OPEN))
+ 		return comp_error_text(cstate, "expected opening bracket after object method", NULL);
 
 		int i;
 
@@ -1644,25 +1821,25 @@ static int parse_class_method_call(void)
 		{
 			for (i = 0; i < call_type[omethod_index].parameters; i++)
 			{
- 	  if (!next_expression(-1, BIND_EXPRESSION_START))
+ 	  if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		   return 0;
-		  add_intercode(IC_OP, OP_pushA, 0, 0);
+		  add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
 				if (i < call_type[omethod_index].parameters - 1)
 				{
-					if (!expect_punctuation(CTOKEN_SUBTYPE_COMMA))
-					 return comp_error_text("expected comma after object method parameter", NULL);
+					if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_COMMA))
+					 return comp_error_text(cstate, "expected comma after object method parameter", NULL);
 				}
 			}
 		}
-	 if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_CLOSE))
+	 if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_CLOSE))
 		{
    if (call_type[omethod_index].parameters == 0)
- 		 return comp_error_text("expected closing bracket (this object method has no parameters)", NULL);
+ 		 return comp_error_text(cstate, "expected closing bracket (this object method has no parameters)", NULL);
 
-		 return comp_error_text("expected closing bracket after object method parameters", NULL);
+		 return comp_error_text(cstate, "expected closing bracket after object method parameters", NULL);
 		}
 // finally, add the call and the call method type:
-  add_intercode(IC_OP, OP_call_class, omethod_index, 0);
+  add_intercode(cstate, IC_OP, OP_call_class, omethod_index, 0);
 //  fpr(" finished");
 
   return 1;
@@ -1671,7 +1848,7 @@ static int parse_class_method_call(void)
 }
 
 
-static int variable_declaration(void)
+static int variable_declaration(struct cstatestruct* cstate)
 {
 
  int storage_size = 1;
@@ -1679,7 +1856,7 @@ static int variable_declaration(void)
 	struct ctokenstruct variable_ctoken;
 	struct identifierstruct* variable_id;
 
-	if (!read_next(&variable_ctoken))
+	if (!read_next(cstate, &variable_ctoken))
 		return 0;
 
 	switch(variable_ctoken.type)
@@ -1688,14 +1865,14 @@ static int variable_declaration(void)
 		 break; // this is the only one accepted
 		case CTOKEN_TYPE_IDENTIFIER_C_KEYWORD:
 		case CTOKEN_TYPE_IDENTIFIER_NON_C_KEYWORD:
- 		return comp_error_text("variable name already in use as keyword", &variable_ctoken);
+ 		return comp_error_text(cstate, "variable name already in use as keyword", &variable_ctoken);
 	 case CTOKEN_TYPE_IDENTIFIER_USER_VARIABLE:
- 		return comp_error_text("variable name already in use", &variable_ctoken);
+ 		return comp_error_text(cstate, "variable name already in use", &variable_ctoken);
  	default:
- 		return comp_error_text("invalid variable name", &variable_ctoken);
+ 		return comp_error_text(cstate, "invalid variable name", &variable_ctoken);
 	}
 
-	variable_id = &identifier[variable_ctoken.identifier_index];
+	variable_id = &cstate->identifier[variable_ctoken.identifier_index];
 
  variable_id->type = CTOKEN_TYPE_IDENTIFIER_USER_VARIABLE;
  variable_id->array_dims = 0;
@@ -1703,21 +1880,21 @@ static int variable_declaration(void)
 
 // check for array dimensions:
 
- if (check_next(CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_SQUARE_OPEN))
+ if (check_next(cstate, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_SQUARE_OPEN))
 	{
-		variable_id->array_dim_size [0] = read_array_dimension_declaration();
+		variable_id->array_dim_size [0] = read_array_dimension_declaration(cstate);
 		if (variable_id->array_dim_size [0] == 0) // error
 			return 0; // read_array_dimension_declaration will have already written an error message
 		variable_id->array_dims = 1;
-  if (check_next(CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_SQUARE_OPEN))
+  if (check_next(cstate, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_SQUARE_OPEN))
 	 {
-		 variable_id->array_dim_size [1] = read_array_dimension_declaration();
+		 variable_id->array_dim_size [1] = read_array_dimension_declaration(cstate);
 		 if (variable_id->array_dim_size [1] == 0) // error
  			return 0; // read_array_dimension_declaration will have already written an error message
 		 variable_id->array_dims = 2;
-   if (check_next(CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_SQUARE_OPEN))
+   if (check_next(cstate, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_SQUARE_OPEN))
 	  {
- 		 variable_id->array_dim_size [2] = read_array_dimension_declaration();
+ 		 variable_id->array_dim_size [2] = read_array_dimension_declaration(cstate);
 		  if (variable_id->array_dim_size [2] == 0) // error
   			return 0; // read_array_dimension_declaration will have already written an error message
 		  variable_id->array_dims = 3;
@@ -1743,34 +1920,34 @@ static int variable_declaration(void)
   }
 	}
 
- if (check_next(CTOKEN_TYPE_OPERATOR_ASSIGN, CTOKEN_SUBTYPE_EQ))
+ if (check_next(cstate, CTOKEN_TYPE_OPERATOR_ASSIGN, CTOKEN_SUBTYPE_EQ))
 	{
 // variable initialisation combined with declaration is currently not supported.
 // supporting it will require 2 things: constant folding, and treating initial memory contents as part of a process' binary code.
 // explain this error because it might come as a surprise:
-  comp_error_text("cannot combine variable declaration and initialisation", NULL);
-  write_line_to_log("(you may need initialisation code that runs once when the process is created)", MLOG_COL_ERROR);
+  comp_error_text(cstate, "cannot combine variable declaration and initialisation", NULL);
+  write_line_to_log_buffer(cstate->log, "(you may need initialisation code that runs once when the process is created)", MLOG_COL_ERROR);
 		return 0;
 	}
 
 // Now allocate memory:
 
- variable_id->address = cstate.mem_pos;
- cstate.mem_pos += storage_size;
+ variable_id->address = cstate->mem_pos;
+ cstate->mem_pos += storage_size;
 
 
- if (cstate.mem_pos >= MEMORY_SIZE)
+ if (cstate->mem_pos >= MEMORY_SIZE)
 	{
-		comp_error_text("not enough memory for variable", &variable_ctoken);
-  start_log_line(MLOG_COL_COMPILER);
-  write_to_log("Variable size is ");
-  write_number_to_log(storage_size);
-  write_to_log("; memory left is ");
-  write_number_to_log(MEMORY_SIZE - variable_id->address);
-  write_to_log("/");
-  write_number_to_log(MEMORY_SIZE);
-  write_to_log(".");
-  finish_log_line();
+		comp_error_text(cstate, "not enough memory for variable", &variable_ctoken);
+  start_log_buffer_line(cstate->log, MLOG_COL_COMPILER);
+  write_to_log_buffer(cstate->log, "Variable size is ");
+  write_number_to_log_buffer(cstate->log, storage_size);
+  write_to_log_buffer(cstate->log, "; memory left is ");
+  write_number_to_log_buffer(cstate->log, MEMORY_SIZE - variable_id->address);
+  write_to_log_buffer(cstate->log, "/");
+  write_number_to_log_buffer(cstate->log, MEMORY_SIZE);
+  write_to_log_buffer(cstate->log, ".");
+  finish_log_buffer_line(cstate->log);
 	}
 
 	return 1;
@@ -1783,25 +1960,25 @@ static int variable_declaration(void)
 // call this after the [ is read and before the number is read.
 // it will read the number and the following ]
 // returns size of array dimension (not accounting for further sub-dimensions) on success, 0 on failure
-static int read_array_dimension_declaration(void)
+static int read_array_dimension_declaration(struct cstatestruct* cstate)
 {
 	struct ctokenstruct ctoken;
 
-	if (!accept_next(&ctoken, CTOKEN_TYPE_NUMBER, -1))
-		return comp_error_text("array dimension must be a number (constant expressions not currently supported)", &ctoken);
+	if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_NUMBER, -1))
+		return comp_error_text(cstate, "array dimension must be a number (constant expressions not currently supported)", &ctoken);
 
 	if (ctoken.number_value <= 0)
-		return comp_error_text("array dimension must be at least 1", &ctoken);
+		return comp_error_text(cstate, "array dimension must be at least 1", &ctoken);
 
 	if (ctoken.number_value >= ARRAY_DIMENSION_MAX_SIZE)
 	{
 		char error_str [60];
 		snprintf(error_str, 60, "array dimension too large (max %i)", ARRAY_DIMENSION_MAX_SIZE);
-		return comp_error_text(error_str, &ctoken);
+		return comp_error_text(cstate, error_str, &ctoken);
 	}
 
-	if (!expect_punctuation(CTOKEN_SUBTYPE_SQUARE_CLOSE))
-		return comp_error_text("expected ] after array dimension (dimension must be a literal number)", &ctoken);
+	if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_SQUARE_CLOSE))
+		return comp_error_text(cstate, "expected ] after array dimension (dimension must be a literal number)", &ctoken);
 
 	return ctoken.number_value; // success!
 
@@ -1810,74 +1987,74 @@ static int read_array_dimension_declaration(void)
 
 // Call this when a user variable has been read into ctoken.
 // Should be an assignment
-static int variable_assignment(struct ctokenstruct* ctoken)
+static int variable_assignment(struct cstatestruct* cstate, struct ctokenstruct* ctoken)
 {
 
 	struct ctokenstruct operator_ctoken;
 
- if (identifier[ctoken->identifier_index].array_dims > 0)
+ if (cstate->identifier[ctoken->identifier_index].array_dims > 0)
 	{
-  if (!get_array_element_address(ctoken->identifier_index))
+  if (!get_array_element_address(cstate, ctoken->identifier_index))
 		 return 0;
 // this address is pushed below before the following expression is read	(except in cases of ++/--)
 	}
 
-	if (!accept_next(&operator_ctoken, CTOKEN_TYPE_OPERATOR_ASSIGN, -1))
-		return comp_error_text("expected assignment operator after variable", NULL);
+	if (!accept_next(cstate, &operator_ctoken, CTOKEN_TYPE_OPERATOR_ASSIGN, -1))
+		return comp_error_text(cstate, "expected assignment operator after variable", NULL);
 
 // check for ++ and --
 	if (operator_ctoken.subtype == CTOKEN_SUBTYPE_INCREMENT)
 	{
-  if (identifier[ctoken->identifier_index].array_dims == 0)
-		 add_intercode(IC_OP_WITH_VARIABLE_OPERAND, OP_incr_mem, ctoken->identifier_index, 0);
+  if (cstate->identifier[ctoken->identifier_index].array_dims == 0)
+		 add_intercode(cstate, IC_OP_WITH_VARIABLE_OPERAND, OP_incr_mem, ctoken->identifier_index, 0);
 		  else
-		   add_intercode(IC_OP, OP_incr_derefA, 0, 0); // A should hold the address of the target element (after get_array_element_address() call above)
+		   add_intercode(cstate, IC_OP, OP_incr_derefA, 0, 0); // A should hold the address of the target element (after get_array_element_address() call above)
 //		if (!expect_punctuation(CTOKEN_SUBTYPE_SEMICOLON))
 //			return comp_error(CERR_EXPECTED_SEMICOLON, NULL);
 		return 1;
 	}
 	if (operator_ctoken.subtype == CTOKEN_SUBTYPE_DECREMENT)
 	{
-  if (identifier[ctoken->identifier_index].array_dims == 0)
-		 add_intercode(IC_OP_WITH_VARIABLE_OPERAND, OP_decr_mem, ctoken->identifier_index, 0);
+  if (cstate->identifier[ctoken->identifier_index].array_dims == 0)
+		 add_intercode(cstate, IC_OP_WITH_VARIABLE_OPERAND, OP_decr_mem, ctoken->identifier_index, 0);
 		  else
-		   add_intercode(IC_OP, OP_decr_derefA, 0, 0); // A should hold the address of the target element (after get_array_element_address() call above)
+		   add_intercode(cstate, IC_OP, OP_decr_derefA, 0, 0); // A should hold the address of the target element (after get_array_element_address() call above)
 //		if (!expect_punctuation(CTOKEN_SUBTYPE_SEMICOLON))
 //			return comp_error(CERR_EXPECTED_SEMICOLON, NULL);
 		return 1;
 
 	}
 
- if (identifier[ctoken->identifier_index].array_dims > 0)
+ if (cstate->identifier[ctoken->identifier_index].array_dims > 0)
 	{
 // If not ++/--, push the address so it can be retried later:
-	 add_intercode(IC_OP, OP_pushA, 0, 0);
+	 add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
 	}
 
- if (!next_expression(-1, BIND_EXPRESSION_START))
+ if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 		return 0;
 // next_expression should have left result in A
 
  if (operator_ctoken.subtype == CTOKEN_SUBTYPE_EQ)
 	{
 // now just copy A to correct memory location:
-  if (identifier[ctoken->identifier_index].array_dims == 0)
-   add_intercode(IC_OP_WITH_VARIABLE_OPERAND, OP_copyA_to_mem, ctoken->identifier_index, 0);
+  if (cstate->identifier[ctoken->identifier_index].array_dims == 0)
+   add_intercode(cstate, IC_OP_WITH_VARIABLE_OPERAND, OP_copyA_to_mem, ctoken->identifier_index, 0);
     else
 				{
-					add_intercode(IC_OP, OP_popB, 0, 0); // this should be address of target, pushed above
-					add_intercode(IC_OP, OP_copyA_to_derefB, 0, 0); // copy contents of A to memory address pointed to by B
+					add_intercode(cstate, IC_OP, OP_popB, 0, 0); // this should be address of target, pushed above
+					add_intercode(cstate, IC_OP, OP_copyA_to_derefB, 0, 0); // copy contents of A to memory address pointed to by B
 				}
 //		if (!expect_punctuation(CTOKEN_SUBTYPE_SEMICOLON))
 //			return comp_error(CERR_EXPECTED_SEMICOLON, NULL);
 		return 1;
 	}
 
- if (identifier[ctoken->identifier_index].array_dims == 0)
+ if (cstate->identifier[ctoken->identifier_index].array_dims == 0)
 	{
-  add_intercode(IC_OP, OP_pushA, 0, 0);
-  add_intercode(IC_OP_WITH_VARIABLE_OPERAND, OP_setA_mem, ctoken->identifier_index, 0);
-  add_intercode(IC_OP, OP_popB, 0, 0);
+  add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
+  add_intercode(cstate, IC_OP_WITH_VARIABLE_OPERAND, OP_setA_mem, ctoken->identifier_index, 0);
+  add_intercode(cstate, IC_OP, OP_popB, 0, 0);
 	}
 	 else
 		{
@@ -1885,8 +2062,8 @@ static int variable_assignment(struct ctokenstruct* ctoken)
 // we need the result of the expression in B,
 //  and the value of the variable in A
 //  and the target address at the top of the stack
-			add_intercode(IC_OP, OP_copyAtoB, 0, 0);
-			add_intercode(IC_OP, OP_deref_stack_toA, 0, 0); // this instruction does not change the stack pointer
+			add_intercode(cstate, IC_OP, OP_copyAtoB, 0, 0);
+			add_intercode(cstate, IC_OP, OP_deref_stack_toA, 0, 0); // this instruction does not change the stack pointer
 		}
 
 // at this point, A holds variable's current value while B holds result of expression
@@ -1895,37 +2072,37 @@ static int variable_assignment(struct ctokenstruct* ctoken)
  switch(operator_ctoken.subtype)
  {
 	 case CTOKEN_SUBTYPE_PLUSEQ:
-   add_intercode(IC_OP, OP_add, 0, 0);
+   add_intercode(cstate, IC_OP, OP_add, 0, 0);
    break;
 	 case CTOKEN_SUBTYPE_MINUSEQ:
-   add_intercode(IC_OP, OP_sub_AB, 0, 0);
+   add_intercode(cstate, IC_OP, OP_sub_AB, 0, 0);
    break;
 	 case CTOKEN_SUBTYPE_MULEQ:
-   add_intercode(IC_OP, OP_mul, 0, 0);
+   add_intercode(cstate, IC_OP, OP_mul, 0, 0);
    break;
 	 case CTOKEN_SUBTYPE_DIVEQ:
-   add_intercode(IC_OP, OP_div_AB, 0, 0);
+   add_intercode(cstate, IC_OP, OP_div_AB, 0, 0);
    break;
 	 case CTOKEN_SUBTYPE_MODEQ:
-   add_intercode(IC_OP, OP_mod_AB, 0, 0);
+   add_intercode(cstate, IC_OP, OP_mod_AB, 0, 0);
    break;
 	 case CTOKEN_SUBTYPE_BITSHIFT_L_EQ:
-   add_intercode(IC_OP, OP_lsh_AB, 0, 0);
+   add_intercode(cstate, IC_OP, OP_lsh_AB, 0, 0);
    break;
 	 case CTOKEN_SUBTYPE_BITSHIFT_R_EQ:
-   add_intercode(IC_OP, OP_rsh_AB, 0, 0);
+   add_intercode(cstate, IC_OP, OP_rsh_AB, 0, 0);
    break;
 	 case CTOKEN_SUBTYPE_BITWISE_AND_EQ:
-   add_intercode(IC_OP, OP_and, 0, 0);
+   add_intercode(cstate, IC_OP, OP_and, 0, 0);
    break;
 	 case CTOKEN_SUBTYPE_BITWISE_OR_EQ:
-   add_intercode(IC_OP, OP_or, 0, 0);
+   add_intercode(cstate, IC_OP, OP_or, 0, 0);
    break;
 	 case CTOKEN_SUBTYPE_BITWISE_XOR_EQ:
-   add_intercode(IC_OP, OP_xor, 0, 0);
+   add_intercode(cstate, IC_OP, OP_xor, 0, 0);
    break;
 	 case CTOKEN_SUBTYPE_BITWISE_NOT_EQ: // pretty sure this is wrong as ~ is not a binary operator
-   add_intercode(IC_OP, OP_not, 0, 0); // but it will probably never be used.
+   add_intercode(cstate, IC_OP, OP_not, 0, 0); // but it will probably never be used.
    break;
 
   default:
@@ -1938,12 +2115,12 @@ static int variable_assignment(struct ctokenstruct* ctoken)
 // (arrays not yet done)
 
 // only some assignment types will get here (others, such as =, are done above)
-  if (identifier[ctoken->identifier_index].array_dims == 0)
-   add_intercode(IC_OP_WITH_VARIABLE_OPERAND, OP_copyA_to_mem, ctoken->identifier_index, 0);
+  if (cstate->identifier[ctoken->identifier_index].array_dims == 0)
+   add_intercode(cstate, IC_OP_WITH_VARIABLE_OPERAND, OP_copyA_to_mem, ctoken->identifier_index, 0);
     else
 				{
-					add_intercode(IC_OP, OP_popB, 0, 0); // this should be address of target, pushed above
-					add_intercode(IC_OP, OP_copyA_to_derefB, 0, 0);
+					add_intercode(cstate, IC_OP, OP_popB, 0, 0); // this should be address of target, pushed above
+					add_intercode(cstate, IC_OP, OP_copyA_to_derefB, 0, 0);
 				}
 //		if (!expect_punctuation(CTOKEN_SUBTYPE_SEMICOLON))
 //			return comp_error(CERR_EXPECTED_SEMICOLON, NULL);
@@ -1962,7 +2139,7 @@ static int variable_assignment(struct ctokenstruct* ctoken)
 
 	struct ctokenstruct operator_ctoken;
 
- if (identifier[ctoken->identifier_index].array_dims > 0)
+ if (cstate->identifier[ctoken->identifier_index].array_dims > 0)
 	{
   if (!get_array_element_address(ctoken->identifier_index))
 		 return 0;
@@ -1975,7 +2152,7 @@ static int variable_assignment(struct ctokenstruct* ctoken)
 // check for ++ and --
 	if (operator_ctoken.subtype == CTOKEN_SUBTYPE_INCREMENT)
 	{
-  if (identifier[ctoken->identifier_index].array_dims == 0)
+  if (cstate->identifier[ctoken->identifier_index].array_dims == 0)
 		 add_intercode(IC_OP_WITH_VARIABLE_OPERAND, OP_incr_mem, ctoken->identifier_index, 0);
 		  else
 		   add_intercode(IC_OP, OP_incr_derefA, 0, 0); // A should hold the address of the target element (after get_array_element_address() call above)
@@ -1985,7 +2162,7 @@ static int variable_assignment(struct ctokenstruct* ctoken)
 	}
 	if (operator_ctoken.subtype == CTOKEN_SUBTYPE_DECREMENT)
 	{
-  if (identifier[ctoken->identifier_index].array_dims == 0)
+  if (cstate->identifier[ctoken->identifier_index].array_dims == 0)
 		 add_intercode(IC_OP_WITH_VARIABLE_OPERAND, OP_decr_mem, ctoken->identifier_index, 0);
 		  else
 		   add_intercode(IC_OP, OP_decr_derefA, 0, 0); // A should hold the address of the target element (after get_array_element_address() call above)
@@ -1995,7 +2172,7 @@ static int variable_assignment(struct ctokenstruct* ctoken)
 
 	}
 
- if (identifier[ctoken->identifier_index].array_dims > 0)
+ if (cstate->identifier[ctoken->identifier_index].array_dims > 0)
 	{
 // If not ++/--, push the address so it can be retried later:
 	 add_intercode(IC_OP, OP_pushA, 0, 0);
@@ -2008,7 +2185,7 @@ static int variable_assignment(struct ctokenstruct* ctoken)
  if (operator_ctoken.subtype == CTOKEN_SUBTYPE_EQ)
 	{
 // now just copy A to correct memory location:
-  if (identifier[ctoken->identifier_index].array_dims == 0)
+  if (cstate->identifier[ctoken->identifier_index].array_dims == 0)
    add_intercode(IC_OP_WITH_VARIABLE_OPERAND, OP_copyA_to_mem, ctoken->identifier_index, 0);
     else
 				{
@@ -2020,7 +2197,7 @@ static int variable_assignment(struct ctokenstruct* ctoken)
 		return 1;
 	}
 
- if (identifier[ctoken->identifier_index].array_dims == 0)
+ if (cstate->identifier[ctoken->identifier_index].array_dims == 0)
 	{
   add_intercode(IC_OP, OP_pushA, 0, 0);
   add_intercode(IC_OP_WITH_VARIABLE_OPERAND, OP_setA_mem, ctoken->identifier_index, 0);
@@ -2085,7 +2262,7 @@ static int variable_assignment(struct ctokenstruct* ctoken)
 // (arrays not yet done)
 
 // only some assignment types will get here (others, such as =, are done above)
-  if (identifier[ctoken->identifier_index].array_dims == 0)
+  if (cstate->identifier[ctoken->identifier_index].array_dims == 0)
    add_intercode(IC_OP_WITH_VARIABLE_OPERAND, OP_copyA_to_mem, ctoken->identifier_index, 0);
     else
 				{
@@ -2102,15 +2279,15 @@ static int variable_assignment(struct ctokenstruct* ctoken)
 */
 
 // called at the start of an expression and also when an opening bracket is found within an expression.
-static int next_expression(int exit_point, int bind_level)
+static int next_expression(struct cstatestruct* cstate, int exit_point, int bind_level)
 {
 
- cstate.recursion_level ++;
+ cstate->recursion_level ++;
 
- if (cstate.recursion_level > RECURSION_LIMIT)
-  return comp_error(CERR_RECURSION_LIMIT_REACHED, NULL);
+ if (cstate->recursion_level > RECURSION_LIMIT)
+  return comp_error(cstate, CERR_RECURSION_LIMIT_REACHED, NULL);
 
- if (cstate.error != CERR_NONE)
+ if (cstate->error != CERR_NONE)
   return 0;
 
  struct ctokenstruct ctoken;
@@ -2123,21 +2300,21 @@ static int next_expression(int exit_point, int bind_level)
 
  if (exit_point == -1)
  {
-   exit_point = allocate_exit_point(EXPOINT_TYPE_BASIC);
+   exit_point = allocate_exit_point(cstate, EXPOINT_TYPE_BASIC);
    if (exit_point == -1)
     return 0;
    fix_exit_point = 1;
  }
 
 // now read the initial value into A:
- if (!next_expression_value(exit_point, bind_level))
+ if (!next_expression_value(cstate, exit_point, bind_level))
 		return 0;
 
 // now loop through any further operators and values in the expression:
   while(TRUE)
   {
-   if (!peek_next(&ctoken))
-    comp_error(CERR_READ_FAIL, &ctoken);
+   if (!peek_next(cstate, &ctoken))
+    comp_error(cstate, CERR_READ_FAIL, &ctoken);
 
 			if (is_ctoken_closing_punctuation(&ctoken))
 				break; // ??? is this correct?
@@ -2148,7 +2325,7 @@ static int next_expression(int exit_point, int bind_level)
     break; // may be finished*/
 // parse_expression_operator reads the following operator then reads the next value into second_register (passed as the first parameter)
 // if it needs to use first_register for anything, it needs to save it first then pop it afterwards
-   retval = next_expression_operator(&ctoken, exit_point, bind_level);
+   retval = next_expression_operator(cstate, &ctoken, exit_point, bind_level);
    if (!retval)
     return 0; // error
 // retval == 1 means next_expression_operator() was successful and we go to the next value
@@ -2159,12 +2336,12 @@ static int next_expression(int exit_point, int bind_level)
 // if an exit point was allocated in this function (rather than being passed to this function), set its true and false points at the end of the expression:
  if (fix_exit_point)
  {
-   add_intercode(IC_EXIT_POINT_TRUE, exit_point, 0, 0);
-   add_intercode(IC_EXIT_POINT_FALSE, exit_point, 0, 0);
+   add_intercode(cstate, IC_EXIT_POINT_TRUE, exit_point, 0, 0);
+   add_intercode(cstate, IC_EXIT_POINT_FALSE, exit_point, 0, 0);
  }
 
 
- cstate.recursion_level --;
+ cstate->recursion_level --;
  return 1; // success!
 
 }
@@ -2241,10 +2418,10 @@ Question: when does a value just read in need to be pushed? In the a = b example
 returns:
 same as parse_expression
 */
-static int next_expression_value(int exit_point, int bind_level)
+static int next_expression_value(struct cstatestruct* cstate, int exit_point, int bind_level)
 {
 
- if (cstate.error != CERR_NONE)
+ if (cstate->error != CERR_NONE)
   return 0;
 
  struct ctokenstruct ctoken;
@@ -2264,7 +2441,7 @@ static int next_expression_value(int exit_point, int bind_level)
   apply_bitwise_not = 1;
  }*/
 
- if (check_next(CTOKEN_TYPE_OPERATOR_ARITHMETIC, CTOKEN_SUBTYPE_NOT)) // !
+ if (check_next(cstate, CTOKEN_TYPE_OPERATOR_ARITHMETIC, CTOKEN_SUBTYPE_NOT)) // !
  {
   apply_not = 1;
  }
@@ -2281,15 +2458,15 @@ static int next_expression_value(int exit_point, int bind_level)
   dereference ++;
  };*/
 
- if (!read_next(&ctoken))
-  comp_error(CERR_READ_FAIL, &ctoken);
+ if (!read_next(cstate, &ctoken))
+  comp_error(cstate, CERR_READ_FAIL, &ctoken);
 
    switch(ctoken.type)
    {
 
     case CTOKEN_TYPE_PUNCTUATION: // only ( is accepted
      if (ctoken.subtype != CTOKEN_SUBTYPE_BRACKET_OPEN) // this is the only punctuation accepted at this point.
-      return comp_error(CERR_SYNTAX_PUNCTUATION_IN_EXPRESSION, &ctoken);
+      return comp_error(cstate, CERR_SYNTAX_PUNCTUATION_IN_EXPRESSION, &ctoken);
 /*
      if (exit_point == -1)
      {
@@ -2300,19 +2477,19 @@ static int next_expression_value(int exit_point, int bind_level)
      }*/
 //     fpr("\n - found open bracket.");
 
-     subexpression_exit_point = allocate_exit_point(EXPOINT_TYPE_BASIC);
+     subexpression_exit_point = allocate_exit_point(cstate, EXPOINT_TYPE_BASIC);
      if (subexpression_exit_point == -1)
       return 0;
 
-     if (!next_expression(subexpression_exit_point, BIND_EXPRESSION_START)) // new sub-expression resets binding.
+     if (!next_expression(cstate, subexpression_exit_point, BIND_EXPRESSION_START)) // new sub-expression resets binding.
       return 0;
 
-     if (!expect_punctuation(CTOKEN_SUBTYPE_BRACKET_CLOSE))
-						return comp_error_text("expected closing bracket after sub-expression", NULL);
+     if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_BRACKET_CLOSE))
+						return comp_error_text(cstate, "expected closing bracket after sub-expression", NULL);
 
 
-      add_intercode(IC_EXIT_POINT_TRUE, subexpression_exit_point, 0, 0);// * should combine these two separate calls to just one IC
-      add_intercode(IC_EXIT_POINT_FALSE, subexpression_exit_point, 0, 0);
+      add_intercode(cstate, IC_EXIT_POINT_TRUE, subexpression_exit_point, 0, 0);// * should combine these two separate calls to just one IC
+      add_intercode(cstate, IC_EXIT_POINT_FALSE, subexpression_exit_point, 0, 0);
 
 //     if (fix_exit_point)
      {
@@ -2322,16 +2499,16 @@ static int next_expression_value(int exit_point, int bind_level)
 
 //     dereference_loop(REGISTER_WORKING, &dereference);
      if (apply_not)
-      add_intercode(IC_OP, OP_lnot, 0, 0);
+      add_intercode(cstate, IC_OP, OP_lnot, 0, 0);
 
      break; // end case CTOKEN_TYPE_PUNCTUATION
 
     case CTOKEN_TYPE_NUMBER:
-     add_intercode(IC_OP, OP_setA_num, ctoken.number_value, 0);
+     add_intercode(cstate, IC_OP, OP_setA_num, ctoken.number_value, 0);
 //     dereference_loop(target_register, &dereference);
 
      if (apply_not)
-      add_intercode(IC_OP, OP_lnot, 0, 0);
+      add_intercode(cstate, IC_OP, OP_lnot, 0, 0);
 //     if (apply_bitwise_not)
 //      add_intercode(IC_OP, OP_not, 0, 0);
      break;
@@ -2340,20 +2517,20 @@ static int next_expression_value(int exit_point, int bind_level)
 // check for negative numbers:
     	if (ctoken.subtype == CTOKEN_SUBTYPE_MINUS)
 					{
-      if (!read_next(&ctoken)) // use read_next rather than expect_constant because expect_constant would accept another - sign
-       comp_error(CERR_READ_FAIL, &ctoken);
+      if (!read_next(cstate, &ctoken)) // use read_next rather than expect_constant because expect_constant would accept another - sign
+       comp_error(cstate, CERR_READ_FAIL, &ctoken);
       if (ctoken.type != CTOKEN_TYPE_NUMBER)
-							return comp_error(CERR_SYNTAX_EXPRESSION_VALUE, &ctoken);
-      add_intercode(IC_OP, OP_setA_num, ctoken.number_value * -1, 0);
+							return comp_error(cstate, CERR_SYNTAX_EXPRESSION_VALUE, &ctoken);
+      add_intercode(cstate, IC_OP, OP_setA_num, ctoken.number_value * -1, 0);
       if (apply_not)
-       add_intercode(IC_OP, OP_lnot, 0, 0);
+       add_intercode(cstate, IC_OP, OP_lnot, 0, 0);
 						break;
 					}
-     return comp_error(CERR_SYNTAX_EXPRESSION_VALUE, &ctoken);
+     return comp_error(cstate, CERR_SYNTAX_EXPRESSION_VALUE, &ctoken);
 
     case CTOKEN_TYPE_IDENTIFIER_USER_VARIABLE:
 /*
-     if (identifier[ctoken.identifier_index].array_dims > 0)
+     if (cstate->identifier[ctoken.identifier_index].array_dims > 0)
      {
       retval = parse_array_reference(target_register, secondary_register, save_secondary_register, ctoken.identifier_index, 0); // the ,0 means that we want the value of the element, not the address
       dereference_loop(target_register, &dereference);
@@ -2364,18 +2541,18 @@ static int next_expression_value(int exit_point, int bind_level)
       return 1;
      } // end code for arrays
 */
-     if (identifier[ctoken.identifier_index].array_dims > 0)
+     if (cstate->identifier[ctoken.identifier_index].array_dims > 0)
      {
-     	if (!get_array_element_address(ctoken.identifier_index))
+     	if (!get_array_element_address(cstate, ctoken.identifier_index))
 							return 0;
 // now A contains the address of the array element in memory. Need to dereference it to get the value:
-      add_intercode(IC_OP, OP_derefA, 0, 0);
+      add_intercode(cstate, IC_OP, OP_derefA, 0, 0);
      }
       else
-       add_intercode(IC_OP_WITH_VARIABLE_OPERAND, OP_setA_mem, ctoken.identifier_index, 0);
+       add_intercode(cstate, IC_OP_WITH_VARIABLE_OPERAND, OP_setA_mem, ctoken.identifier_index, 0);
 //     dereference_loop(target_register, &dereference);
      if (apply_not)
-      add_intercode(IC_OP, OP_lnot, 0, 0);
+      add_intercode(cstate, IC_OP, OP_lnot, 0, 0);
 //     if (apply_bitwise_not)
 //      add_intercode(IC_OP, OP_not, 0, 0);
      break; // end CTOKEN_TYPE_IDENTIFIER_USER_VARIABLE
@@ -2385,53 +2562,53 @@ static int next_expression_value(int exit_point, int bind_level)
 					switch(ctoken.identifier_index)
 					{
 					 case KEYWORD_C_PROCESS:
-					 	if (!parse_process_expression(0))
+					 	if (!parse_process_expression(cstate, 0))
 								return 0;
 							break;
 					 case KEYWORD_C_COMPONENT:
-					 	if (!parse_member_expression(0, 1, 0))
+					 	if (!parse_member_expression(cstate, 0, 1, 0))
 								return 0;
 							break;
 						case KEYWORD_C_CLASS: // indexed class reference (e.g. class[2].method())
-							if (!parse_class_keyword_in_code())
+							if (!parse_class_keyword_in_code(cstate))
 								return 0;
 							break;
 
 						default:
-					  return comp_error_text("unexpected keyword", &ctoken);
+					  return comp_error_text(cstate, "unexpected keyword", &ctoken);
 					}
      if (apply_not)
-      add_intercode(IC_OP, OP_lnot, 0, 0);
+      add_intercode(cstate, IC_OP, OP_lnot, 0, 0);
 					break; // end CTOKEN_TYPE_IDENTIFIER_C_KEYWORD/CTOKEN_TYPE_IDENTIFIER_NON_C_KEYWORD
 
 
 				case CTOKEN_TYPE_IDENTIFIER_CMETHOD:
-  		 if (!parse_core_method_call(identifier[ctoken.identifier_index].value,  // see c_keywords.c for a list of these in the identifier initialiser
+  		 if (!parse_core_method_call(cstate, cstate->identifier[ctoken.identifier_index].value,  // see c_keywords.c for a list of these in the identifier initialiser
 																																0, 0))
 					return 0;
     if (apply_not)
-     add_intercode(IC_OP, OP_lnot, 0, 0);
+     add_intercode(cstate, IC_OP, OP_lnot, 0, 0);
 				break; // end CTOKEN_TYPE_IDENTIFIER_CMETHOD
 
 				case CTOKEN_TYPE_IDENTIFIER_SMETHOD:
-					if (!parse_std_method_call(identifier[ctoken.identifier_index].value))
+					if (!parse_std_method_call(cstate, cstate->identifier[ctoken.identifier_index].value))
 						return 0;
     if (apply_not)
-     add_intercode(IC_OP, OP_lnot, 0, 0);
+     add_intercode(cstate, IC_OP, OP_lnot, 0, 0);
 				break; // end CTOKEN_TYPE_IDENTIFIER_SMETHOD
 
 				case CTOKEN_TYPE_IDENTIFIER_UMETHOD:
-					if (!parse_uni_method_call(identifier[ctoken.identifier_index].value))
+					if (!parse_uni_method_call(cstate, cstate->identifier[ctoken.identifier_index].value))
 						return 0;
     if (apply_not)
-     add_intercode(IC_OP, OP_lnot, 0, 0);
+     add_intercode(cstate, IC_OP, OP_lnot, 0, 0);
 				break; // end CTOKEN_TYPE_IDENTIFIER_UMETHOD
 
 				case CTOKEN_TYPE_IDENTIFIER_CLASS:
-					if (!parse_class_name_in_expression(identifier[ctoken.identifier_index].value))
+					if (!parse_class_name_in_expression(cstate, cstate->identifier[ctoken.identifier_index].value))
 						return 0;
     if (apply_not)
-     add_intercode(IC_OP, OP_lnot, 0, 0);
+     add_intercode(cstate, IC_OP, OP_lnot, 0, 0);
 				break; // end CTOKEN_TYPE_IDENTIFIER_CLASS
 
 /*
@@ -2448,10 +2625,10 @@ static int next_expression_value(int exit_point, int bind_level)
        comp_error(CERR_READ_FAIL, &ctoken);
       if (ctoken.type != CTOKEN_TYPE_IDENTIFIER_USER_VARIABLE)
        return comp_error(CERR_ADDRESS_OF_PREFIX_MISUSE, &ctoken);
-      if (identifier[ctoken.identifier_index].array_dims == 0)
+      if (cstate->identifier[ctoken.identifier_index].array_dims == 0)
       {
 // simplest case: address of non-array static variable:
-       if (identifier[ctoken.identifier_index].storage_class == STORAGE_STATIC)
+       if (cstate->identifier[ctoken.identifier_index].storage_class == STORAGE_STATIC)
        {
         add_intercode(IC_ID_ADDRESS_PLUS_OFFSET_TO_REGISTER, target_register, ctoken.identifier_index, 0);
         return 1;
@@ -2469,10 +2646,10 @@ static int next_expression_value(int exit_point, int bind_level)
 */
 
 				case CTOKEN_TYPE_IDENTIFIER_NEW:
-					return comp_error_text("unrecognised token", &ctoken);
+					return comp_error_text(cstate, "unrecognised token", &ctoken);
 
     default:
-     return comp_error(CERR_SYNTAX_EXPRESSION_VALUE, &ctoken);
+     return comp_error(cstate, CERR_SYNTAX_EXPRESSION_VALUE, &ctoken);
    }
 
 
@@ -2513,18 +2690,18 @@ NEXT_EXP_OPERATOR_RESULT_FINISHED // found punctuation indicating end of express
 
 
 // note that ctoken_operator has only been peeked and not read properly
-static int next_expression_operator(struct ctokenstruct* ctoken_operator, int exit_point, int previous_operator_binding)
+static int next_expression_operator(struct cstatestruct* cstate, struct ctokenstruct* ctoken_operator, int exit_point, int previous_operator_binding)
 {
 
 //   if (!peek_next(&ctoken_operator))
 //				return NEXT_EXP_OPERATOR_RESULT_ERROR;
 
-   cstate.recursion_level ++;
+   cstate->recursion_level ++;
 
-   if (cstate.recursion_level > RECURSION_LIMIT)
-    return comp_error(CERR_RECURSION_LIMIT_REACHED, NULL);
+   if (cstate->recursion_level > RECURSION_LIMIT)
+    return comp_error(cstate, CERR_RECURSION_LIMIT_REACHED, NULL);
 
-   if (cstate.error != CERR_NONE)
+   if (cstate->error != CERR_NONE)
     return NEXT_EXP_OPERATOR_RESULT_ERROR;
 
 //   int retval = 0;
@@ -2541,8 +2718,8 @@ static int next_expression_operator(struct ctokenstruct* ctoken_operator, int ex
 // operator binds as closely as, or closer than, previous operator:
 
 // read the operator properly (before it was just peeked)
-   if (!read_next(ctoken_operator))
-    return comp_error(CERR_READ_FAIL, ctoken_operator);
+   if (!read_next(cstate, ctoken_operator))
+    return comp_error(cstate, CERR_READ_FAIL, ctoken_operator);
 
 // logical operators are dealt with here:
    if (ctoken_operator->type == CTOKEN_TYPE_OPERATOR_LOGICAL)
@@ -2550,11 +2727,11 @@ static int next_expression_operator(struct ctokenstruct* ctoken_operator, int ex
      switch(ctoken_operator->subtype)
      {
       case CTOKEN_SUBTYPE_LOGICAL_AND:
-       add_intercode(IC_IFFALSE_JUMP_TO_EXIT_POINT, exit_point, 0, 0);
+       add_intercode(cstate, IC_IFFALSE_JUMP_TO_EXIT_POINT, exit_point, 0, 0);
        return_value = NEXT_EXP_OPERATOR_RESULT_CONTINUE;//next_expression(exit_point, BIND_LOGICAL_AND);
        break;
       case CTOKEN_SUBTYPE_LOGICAL_OR:
-       add_intercode(IC_IFTRUE_JUMP_TO_EXIT_POINT, exit_point, 0, 0);
+       add_intercode(cstate, IC_IFTRUE_JUMP_TO_EXIT_POINT, exit_point, 0, 0);
        return_value = NEXT_EXP_OPERATOR_RESULT_CONTINUE;//next_expression(exit_point, BIND_LOGICAL_OR);
        break;
      }
@@ -2562,14 +2739,14 @@ static int next_expression_operator(struct ctokenstruct* ctoken_operator, int ex
 			 else
 				{
 			  // if the operator isn't logical, put the existing contents of A onto the stack:
-     add_intercode(IC_OP, OP_pushA, 0, 0);
+     add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
      // logical operators discard the contents of A
 				}
 
 
 
 //			if (!next_expression_value(exit_point, operator_binding))
-			if (!next_expression(exit_point, operator_binding))
+			if (!next_expression(cstate, exit_point, operator_binding))
 			 return NEXT_EXP_OPERATOR_RESULT_ERROR;
 
 // The result of the next expression or value should now be in A.
@@ -2580,62 +2757,62 @@ static int next_expression_operator(struct ctokenstruct* ctoken_operator, int ex
     case CTOKEN_TYPE_OPERATOR_ARITHMETIC:
     case CTOKEN_TYPE_OPERATOR_COMPARISON:
 // First pop the previous value to B (this matches the pushA instruction just before the call to next_expression_value)
-       add_intercode(IC_OP, OP_popB, 0, 0);
+       add_intercode(cstate, IC_OP, OP_popB, 0, 0);
 // A should hold the result of the value or subexpression after the operator.
        switch(ctoken_operator->subtype)
        {
         case CTOKEN_SUBTYPE_PLUS:
-         add_intercode(IC_OP, OP_add, 0, 0);
+         add_intercode(cstate, IC_OP, OP_add, 0, 0);
          break;
         case CTOKEN_SUBTYPE_MINUS:
-         add_intercode(IC_OP, OP_sub_BA, 0, 0);
+         add_intercode(cstate, IC_OP, OP_sub_BA, 0, 0);
          break;
         case CTOKEN_SUBTYPE_MUL:
-         add_intercode(IC_OP, OP_mul, 0, 0);
+         add_intercode(cstate, IC_OP, OP_mul, 0, 0);
          break;
         case CTOKEN_SUBTYPE_DIV:
-         add_intercode(IC_OP, OP_div_BA, 0, 0);
+         add_intercode(cstate, IC_OP, OP_div_BA, 0, 0);
          break;
         case CTOKEN_SUBTYPE_MOD:
-         add_intercode(IC_OP, OP_mod_BA, 0, 0);
+         add_intercode(cstate, IC_OP, OP_mod_BA, 0, 0);
          break;
         case CTOKEN_SUBTYPE_BITWISE_AND:
-         add_intercode(IC_OP, OP_and, 0, 0);
+         add_intercode(cstate, IC_OP, OP_and, 0, 0);
          break;
         case CTOKEN_SUBTYPE_BITWISE_XOR:
-         add_intercode(IC_OP, OP_xor, 0, 0);
+         add_intercode(cstate, IC_OP, OP_xor, 0, 0);
          break;
         case CTOKEN_SUBTYPE_BITWISE_OR:
-         add_intercode(IC_OP, OP_or, 0, 0);
+         add_intercode(cstate, IC_OP, OP_or, 0, 0);
          break;
         case CTOKEN_SUBTYPE_BITWISE_NOT:
-         add_intercode(IC_OP, OP_not, 0, 0);
+         add_intercode(cstate, IC_OP, OP_not, 0, 0);
          break;
         case CTOKEN_SUBTYPE_BITSHIFT_L:
-         add_intercode(IC_OP, OP_lsh_BA, 0, 0);
+         add_intercode(cstate, IC_OP, OP_lsh_BA, 0, 0);
          break;
         case CTOKEN_SUBTYPE_BITSHIFT_R:
-         add_intercode(IC_OP, OP_rsh_BA, 0, 0);
+         add_intercode(cstate, IC_OP, OP_rsh_BA, 0, 0);
          break;
 
 
         case CTOKEN_SUBTYPE_EQ_EQ: // ==
-         add_intercode(IC_OP, OP_comp_eq, 0, 0); // this leaves register A with 1 if true, 0 if false
+         add_intercode(cstate, IC_OP, OP_comp_eq, 0, 0); // this leaves register A with 1 if true, 0 if false
          break;
         case CTOKEN_SUBTYPE_GR: // >
-         add_intercode(IC_OP, OP_comp_gr, 0, 0); // this leaves register A with 1 if true, 0 if false
+         add_intercode(cstate, IC_OP, OP_comp_gr, 0, 0); // this leaves register A with 1 if true, 0 if false
          break;
         case CTOKEN_SUBTYPE_GREQ: // >=
-         add_intercode(IC_OP, OP_comp_greq, 0, 0); // this leaves register A with 1 if true, 0 if false
+         add_intercode(cstate, IC_OP, OP_comp_greq, 0, 0); // this leaves register A with 1 if true, 0 if false
          break;
         case CTOKEN_SUBTYPE_LESS: // <
-         add_intercode(IC_OP, OP_comp_ls, 0, 0); // this leaves register A with 1 if true, 0 if false
+         add_intercode(cstate, IC_OP, OP_comp_ls, 0, 0); // this leaves register A with 1 if true, 0 if false
          break;
         case CTOKEN_SUBTYPE_LESEQ: // <=
-         add_intercode(IC_OP, OP_comp_lseq, 0, 0); // this leaves register A with 1 if true, 0 if false
+         add_intercode(cstate, IC_OP, OP_comp_lseq, 0, 0); // this leaves register A with 1 if true, 0 if false
          break;
         case CTOKEN_SUBTYPE_COMPARE_NOT: // !=
-         add_intercode(IC_OP, OP_comp_neq, 0, 0); // this leaves register A with 1 if true, 0 if false
+         add_intercode(cstate, IC_OP, OP_comp_neq, 0, 0); // this leaves register A with 1 if true, 0 if false
          break;
 
         default:
@@ -2747,7 +2924,7 @@ mul (A = c * d)
 
 */
 
-   cstate.recursion_level --;
+   cstate->recursion_level --;
 
    return return_value;
 
@@ -2827,29 +3004,29 @@ static int is_ctoken_closing_punctuation(struct ctokenstruct* ctoken)
 // Call this function just after an array variable is read in an assignment or expression.
 // It leaves the address of the element in A.
 // TO DO: optimise better (or at all) for constant indices
-static int get_array_element_address(int id_index)
+static int get_array_element_address(struct cstatestruct* cstate, int id_index)
 {
 
- struct identifierstruct* variable_id = &identifier[id_index];
+ struct identifierstruct* variable_id = &cstate->identifier[id_index];
 
  int i;
 
  for (i = 0; i < variable_id->array_dims; i ++)
 	{
-		if (!expect_punctuation(CTOKEN_SUBTYPE_SQUARE_OPEN))
-			return comp_error_text("expected [ at start of array index", NULL);
-		if (!next_expression(-1, BIND_EXPRESSION_START))
+		if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_SQUARE_OPEN))
+			return comp_error_text(cstate, "expected [ at start of array index", NULL);
+		if (!next_expression(cstate, -1, BIND_EXPRESSION_START))
 			return 0;
-		if (!expect_punctuation(CTOKEN_SUBTYPE_SQUARE_CLOSE))
-			return comp_error_text("expected ] at end of array index", NULL);
+		if (!expect_punctuation(cstate, CTOKEN_SUBTYPE_SQUARE_CLOSE))
+			return comp_error_text(cstate, "expected ] at end of array index", NULL);
 
 // If this isn't the final dimension, we multiply the index by the size of each element of the dimension:
 //   (the final dimension always has elements of size 1)
 		if (i < (variable_id->array_dims - 1))
 		{
 			if (variable_id->array_element_size [i] > 1) // possible if for some reason the dimension has just one element
-		  add_intercode(IC_OP, OP_mulA_num, variable_id->array_element_size [i], 0);
-		 add_intercode(IC_OP, OP_pushA, 0, 0);
+		  add_intercode(cstate, IC_OP, OP_mulA_num, variable_id->array_element_size [i], 0);
+		 add_intercode(cstate, IC_OP, OP_pushA, 0, 0);
 		}
 	}
 
@@ -2859,18 +3036,18 @@ static int get_array_element_address(int id_index)
 // If the array has >1 dimensions, need to add the indices for the other dimensions:
 	if (variable_id->array_dims > 1)
 	{
-	 add_intercode(IC_OP, OP_popB, 0, 0);
-	 add_intercode(IC_OP, OP_add, 0, 0);
+	 add_intercode(cstate, IC_OP, OP_popB, 0, 0);
+	 add_intercode(cstate, IC_OP, OP_add, 0, 0);
 	}
 	if (variable_id->array_dims == 3)
 	{
-	 add_intercode(IC_OP, OP_popB, 0, 0);
-	 add_intercode(IC_OP, OP_add, 0, 0);
+	 add_intercode(cstate, IC_OP, OP_popB, 0, 0);
+	 add_intercode(cstate, IC_OP, OP_add, 0, 0);
 	}
 
 // at this point, A should hold the offset from the first element of the entire array.
 // To get the element, just add the address of the first element:
- add_intercode(IC_OP_WITH_VARIABLE_OPERAND, OP_addA_num, id_index, 0); // id_index is converted to the variable's actual address later
+ add_intercode(cstate, IC_OP_WITH_VARIABLE_OPERAND, OP_addA_num, id_index, 0); // id_index is converted to the variable's actual address later
 
  return 1;
 
@@ -3035,27 +3212,27 @@ pop_B_to_address <number/address>
 */
 
 
-static void add_intercode(int ic_type, int value1, int value2, int value3)
+static void add_intercode(struct cstatestruct* cstate, int ic_type, int value1, int value2, int value3)
 {
 
- if (cstate.ic_pos >= INTERCODE_SIZE - 2)
+ if (cstate->ic_pos >= INTERCODE_SIZE - 2)
 	{
-		if (cstate.error == CERR_NONE)
-			comp_error(CERR_TOO_MUCH_INTERCODE, NULL);
+		if (cstate->error == CERR_NONE)
+			comp_error(cstate, CERR_TOO_MUCH_INTERCODE, NULL);
 		return;
 	}
 
- cstate.intercode[cstate.ic_pos].type = ic_type;
- cstate.intercode[cstate.ic_pos].value [0] = value1;
- cstate.intercode[cstate.ic_pos].value [1] = value2;
- cstate.intercode[cstate.ic_pos].value [2] = value3;
- cstate.intercode[cstate.ic_pos].src_line = cstate.src_line;
+ cstate->intercode[cstate->ic_pos].type = ic_type;
+ cstate->intercode[cstate->ic_pos].value [0] = value1;
+ cstate->intercode[cstate->ic_pos].value [1] = value2;
+ cstate->intercode[cstate->ic_pos].value [2] = value3;
+ cstate->intercode[cstate->ic_pos].src_line = cstate->src_line;
 
 //#define PRINT_INTERCODE
 
 #ifdef PRINT_INTERCODE
 
- fpr("\n[%i:%i] ", cstate.ic_pos, cstate.src_line);
+ fpr("\n[%i:%i] ", cstate->ic_pos, cstate->src_line);
 
 
  switch(ic_type)
@@ -3071,7 +3248,7 @@ static void add_intercode(int ic_type, int value1, int value2, int value3)
 		 	if (instruction_set[value1].operand_type [0] == OPERAND_TYPE_NUMBER)
 				 fpr("%i ", value2);
 		 	if (instruction_set[value1].operand_type [0] == OPERAND_TYPE_MEMORY)
-				 fpr("%s ", identifier[value2].name);
+				 fpr("%s ", cstate->identifier[value2].name);
 		 	if (instruction_set[value1].operand_type [0] == OPERAND_TYPE_BCODE_ADDRESS)
 				 fpr("%i ", value2); // not sure this will be useful
 		 }
@@ -3083,10 +3260,10 @@ static void add_intercode(int ic_type, int value1, int value2, int value3)
 			fpr(" exit point %i (false)", value1);
 			break;
 		case IC_LABEL_DEFINITION:
-			fpr("+++label [%s]", identifier[value1].name);
+			fpr("+++label [%s]", cstate->identifier[value1].name);
 			break;
 		case IC_GOTO_LABEL:
-			fpr("goto %s", identifier[value1].name);
+			fpr("goto %s", cstate->identifier[value1].name);
 			break;
 		case IC_IFFALSE_JUMP_TO_EXIT_POINT:
 			fpr("if_false_jump_to_exit_point %i", value1);
@@ -3110,32 +3287,32 @@ static void add_intercode(int ic_type, int value1, int value2, int value3)
 			fpr("jt %i", value1);
 			break;
 //		case IC_NUMBER:
-//			fpr("$%i", cstate.inter);
+//			fpr("$%i", cstate->inter);
 
  }
 
 
 #endif
 
- cstate.ic_pos ++;
+ cstate->ic_pos ++;
 
 }
 
 
-static int allocate_exit_point(int type)
+static int allocate_exit_point(struct cstatestruct* cstate, int type)
 {
 
- cstate.expoint_pos ++;
- if (cstate.expoint_pos >= EXPOINTS)
-  return comp_error_minus1(CERR_TOO_MANY_EXIT_POINTS, NULL);
+ cstate->expoint_pos ++;
+ if (cstate->expoint_pos >= EXPOINTS)
+  return comp_error_minus1(cstate, CERR_TOO_MANY_EXIT_POINTS, NULL);
 
- cstate.expoint[cstate.expoint_pos].type = type;
- cstate.expoint[cstate.expoint_pos].true_point_used = 0;
- cstate.expoint[cstate.expoint_pos].false_point_used = 0;
- cstate.expoint[cstate.expoint_pos].true_point_bcode = -1; // indicates undefined
- cstate.expoint[cstate.expoint_pos].false_point_bcode = -1;
+ cstate->expoint[cstate->expoint_pos].type = type;
+ cstate->expoint[cstate->expoint_pos].true_point_used = 0;
+ cstate->expoint[cstate->expoint_pos].false_point_used = 0;
+ cstate->expoint[cstate->expoint_pos].true_point_bcode = -1; // indicates undefined
+ cstate->expoint[cstate->expoint_pos].false_point_bcode = -1;
 
- return cstate.expoint_pos;
+ return cstate->expoint_pos;
 
 }
 
@@ -3179,101 +3356,101 @@ const char *error_name [CERRS] =
 };
 
 
-int comp_error(int error_type, struct ctokenstruct* ctoken)
+int comp_error(struct cstatestruct* cstate, int error_type, struct ctokenstruct* ctoken)
 {
 
-     start_log_line(MLOG_COL_ERROR);
-     set_log_line_source_position(cstate.source_edit->player_index, cstate.source_edit->template_index, cstate.src_line);
-     write_to_log("Compiler error at line ");
-     write_number_to_log(cstate.src_line + 1);
-     write_to_log(".");
-     finish_log_line();
+     start_log_buffer_line(cstate->log, MLOG_COL_ERROR);
+     set_log_buffer_line_source_position(cstate->log, cstate->source_edit->player_index, cstate->source_edit->template_index, cstate->src_line);
+     write_to_log_buffer(cstate->log, "Compiler error at line ");
+     write_number_to_log_buffer(cstate->log, cstate->src_line + 1);
+     write_to_log_buffer(cstate->log, ".");
+     finish_log_buffer_line(cstate->log);
 
-     start_log_line(MLOG_COL_ERROR);
-     set_log_line_source_position(cstate.source_edit->player_index, cstate.source_edit->template_index, cstate.src_line);
-     write_to_log("Error: ");
-     write_to_log(error_name [error_type]);
-     write_to_log(".");
-     finish_log_line();
+     start_log_buffer_line(cstate->log, MLOG_COL_ERROR);
+     set_log_buffer_line_source_position(cstate->log, cstate->source_edit->player_index, cstate->source_edit->template_index, cstate->src_line);
+     write_to_log_buffer(cstate->log, "Error: ");
+     write_to_log_buffer(cstate->log, error_name [error_type]);
+     write_to_log_buffer(cstate->log, ".");
+     finish_log_buffer_line(cstate->log);
 
      if (ctoken != NULL)
      {
-      start_log_line(MLOG_COL_COMPILER);
-      set_log_line_source_position(cstate.source_edit->player_index, cstate.source_edit->template_index, cstate.src_line);
-      write_to_log("Last token read: ");
-      write_to_log(ctoken->name);
-      write_to_log(".");
-      finish_log_line();
+      start_log_buffer_line(cstate->log, MLOG_COL_COMPILER);
+      set_log_buffer_line_source_position(cstate->log, cstate->source_edit->player_index, cstate->source_edit->template_index, cstate->src_line);
+      write_to_log_buffer(cstate->log, "Last token read: ");
+      write_to_log_buffer(cstate->log, ctoken->name);
+      write_to_log_buffer(cstate->log, ".");
+      finish_log_buffer_line(cstate->log);
      }
 
-     cstate.error = error_type;
+     cstate->error = error_type;
 //     error_call();
      return 0;
 }
 
 
 // call when comp_error is called from a function that returns -1 on failure (and so needs to return -1)
-int comp_error_minus1(int error_type, struct ctokenstruct* ctoken)
+int comp_error_minus1(struct cstatestruct* cstate, int error_type, struct ctokenstruct* ctoken)
 {
 
- comp_error(error_type, ctoken);
+ comp_error(cstate, error_type, ctoken);
  return -1;
 
 }
 
-int comp_error_text(const char* error_text, struct ctokenstruct* ctoken)
+int comp_error_text(struct cstatestruct* cstate, const char* error_text, struct ctokenstruct* ctoken)
 {
 
 
 
-     start_log_line(MLOG_COL_ERROR);
-     set_log_line_source_position(cstate.source_edit->player_index, cstate.source_edit->template_index, cstate.src_line);
-     write_to_log("Compiler error at line ");
-     write_number_to_log(cstate.src_line + 1);
-     write_to_log(".");
-     finish_log_line();
+     start_log_buffer_line(cstate->log, MLOG_COL_ERROR);
+     set_log_buffer_line_source_position(cstate->log, cstate->source_edit->player_index, cstate->source_edit->template_index, cstate->src_line);
+     write_to_log_buffer(cstate->log, "Compiler error at line ");
+     write_number_to_log_buffer(cstate->log, cstate->src_line + 1);
+     write_to_log_buffer(cstate->log, ".");
+     finish_log_buffer_line(cstate->log);
 
-     start_log_line(MLOG_COL_ERROR);
-     set_log_line_source_position(cstate.source_edit->player_index, cstate.source_edit->template_index, cstate.src_line);
-     write_to_log("Error: ");
-     write_to_log(error_text);
-     write_to_log(".");
-     finish_log_line();
+     start_log_buffer_line(cstate->log, MLOG_COL_ERROR);
+     set_log_buffer_line_source_position(cstate->log, cstate->source_edit->player_index, cstate->source_edit->template_index, cstate->src_line);
+     write_to_log_buffer(cstate->log, "Error: ");
+     write_to_log_buffer(cstate->log, error_text);
+     write_to_log_buffer(cstate->log, ".");
+     finish_log_buffer_line(cstate->log);
 
      if (ctoken != NULL)
      {
-      start_log_line(MLOG_COL_COMPILER);
-      set_log_line_source_position(cstate.source_edit->player_index, cstate.source_edit->template_index, cstate.src_line);
-      write_to_log("Last token read: ");
-      write_to_log(ctoken->name);
-      write_to_log(".");
-      finish_log_line();
+      start_log_buffer_line(cstate->log, MLOG_COL_COMPILER);
+      set_log_buffer_line_source_position(cstate->log, cstate->source_edit->player_index, cstate->source_edit->template_index, cstate->src_line);
+      write_to_log_buffer(cstate->log, "Last token read: ");
+      write_to_log_buffer(cstate->log, ctoken->name);
+      write_to_log_buffer(cstate->log, ".");
+      finish_log_buffer_line(cstate->log);
      }
 
-     cstate.error = CERR_GENERIC;
+     cstate->error = CERR_GENERIC;
 //     error_call();
      return 0;
 }
 
 
-void comp_warning_text(const char* warning_text)
+void comp_warning_text(struct cstatestruct* cstate, const char* warning_text)
 {
 
 
 
-     start_log_line(MLOG_COL_COMPILER);
-     set_log_line_source_position(cstate.source_edit->player_index, cstate.source_edit->template_index, cstate.src_line);
-     write_to_log("Compiler warning at line ");
-     write_number_to_log(cstate.src_line + 1);
-     write_to_log(".");
-     finish_log_line();
+     start_log_buffer_line(cstate->log, MLOG_COL_COMPILER);
+     set_log_buffer_line_source_position(cstate->log, cstate->source_edit->player_index, cstate->source_edit->template_index, cstate->src_line);
+     write_to_log_buffer(cstate->log, "Compiler warning at line ");
+     write_number_to_log_buffer(cstate->log, cstate->src_line + 1);
+     write_to_log_buffer(cstate->log, ".");
+     finish_log_buffer_line(cstate->log);
 
-     start_log_line(MLOG_COL_COMPILER);
-     set_log_line_source_position(cstate.source_edit->player_index, cstate.source_edit->template_index, cstate.src_line);
-     write_to_log("Warning: ");
-     write_to_log(warning_text);
-     write_to_log(".");
-     finish_log_line();
+     start_log_buffer_line(cstate->log, MLOG_COL_COMPILER);
+     set_log_buffer_line_source_position(cstate->log, cstate->source_edit->player_index, cstate->source_edit->template_index, cstate->src_line);
+     write_to_log_buffer(cstate->log, "Warning: ");
+     write_to_log_buffer(cstate->log, warning_text);
+     write_to_log_buffer(cstate->log, ".");
+     finish_log_buffer_line(cstate->log);
 
      return;
 }
@@ -19,6 +19,7 @@ Contains code for generated a template's process design from source code (actual
 #include "c_lexer.h"
 #include "c_prepr.h"
 #include "c_compile.h"
+#include "c_init.h"
 #include "d_design.h"
 #include "d_geo.h"
 #include "g_shapes.h"
@@ -27,30 +28,19 @@ Contains code for generated a template's process design from source code (actual
 #include "t_template.h"
 #include "c_fix.h"
 
-#define read_ctoken if (!read_next(&ctoken)) return 0
+#define read_ctoken if (!read_next(cstate, &ctoken)) return 0
 
-#define EXPECT_COMMA if (!accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))	return comp_error(CERR_EXPECTED_COMMA, &ctoken);
+#define EXPECT_COMMA if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))	return comp_error(cstate, CERR_EXPECTED_COMMA, &ctoken);
 //#define EXPECT_BRACE_OPEN if (!accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACE_OPEN))	return comp_error(CERR_EXPECTED_BRACE_OPEN, &ctoken);
 //#define EXPECT_BRACE_CLOSE if (!accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACE_CLOSE))	return comp_error(CERR_EXPECTED_BRACE_CLOSE, &ctoken);
 
-extern struct identifierstruct identifier [IDENTIFIERS];
 extern struct nshape_struct nshape [NSHAPES];
 extern struct object_type_struct otype [OBJECT_TYPES];
 
-extern struct cstatestruct cstate;
-
 int declare_new_class(struct ctokenstruct* ctoken);
 //int add_object_to_class(int member_index, int object_index, struct ctokenstruct* ctoken);
-int finalise_template_class_lists(void);
-
-struct fstatestruct
-{
-	struct template_struct* target_templ;
+int finalise_template_class_lists(struct cstatestruct* cstate);
 
-	int procdef_pos;
-};
-
-struct fstatestruct fstate;
 
 /*
 struct procdef_line_struct
@@ -63,7 +53,6 @@ struct procdef_line_struct
 #define PROCDEF_LINES (GROUP_MAX_MEMBERS*MAX_LINKS)
 */
 
-struct procdef_struct procdef;
 
 /*
 contents of procdef buffer:
@@ -88,31 +77,32 @@ Plan for rewriting this module:
 
 */
 
-static int generate_template_from_procdef(int compile_mode);
-int read_member_recursively(int parent_member_index, int parent_object, int parent_connection_index, int downlinks_from_core);
-int read_member_objects_recursively(int member_index, int downlinks_from_core);
-static int read_procdef(void);
-static int procdef_error(const char* error_text);
+static int generate_template_from_procdef(struct cstatestruct* cstate, int compile_mode);
+static int fix_design_from_procdef(struct cstatestruct* cstate, struct template_struct* target_templ);
+int read_member_recursively(struct cstatestruct* cstate, int parent_member_index, int parent_object, int parent_connection_index, int downlinks_from_core);
+int read_member_objects_recursively(struct cstatestruct* cstate, int member_index, int downlinks_from_core);
+static int read_procdef(struct cstatestruct* cstate);
+static int procdef_error(struct cstatestruct* cstate, const char* error_text);
 int finalise_template_details(struct template_struct* finish_templ);
 
-int	parse_process_definition(void);
+int	parse_process_definition(struct cstatestruct* cstate);
 
-// Reads the process structure definition from cstate.scode.
+// Reads the process structure definition from cstate->scode.
 // Depending on the compiler mode, may discard process structure (but always processes structure to test it and to declare classes)
 // Updates cstate with e.g. new scode_pos.
 // returns 1 on success, 0 on failure
-int	fix_template_design_from_scode(void)
+int	fix_template_design_from_scode(struct cstatestruct* cstate)
 {
 
-	fstate.target_templ = cstate.templ;
+	cstate->fstate.target_templ = cstate->templ;
 
 
- init_template_for_design(fstate.target_templ);
+ init_template_for_design(cstate->fstate.target_templ);
 
- if (!parse_process_definition())
+ if (!parse_process_definition(cstate))
 		return 0;
 
-	return generate_template_from_procdef(cstate.compile_mode);
+	return generate_template_from_procdef(cstate, cstate->compile_mode);
 
 }
 
@@ -128,28 +118,50 @@ void test_src_lines(const char* nametext)
 	{
 
 			char tempstr [2];
-			tempstr [0] = cstate.scode.text[i];
+			tempstr [0] = cstate->scode.text[i];
 			tempstr [1] = 0;
-			fpr("(%i:%i[%s]),", i, cstate.scode.src_line[i], tempstr);
+			fpr("(%i:%i[%s]),", i, cstate->scode.src_line[i], tempstr);
 	}
 
 }
 */
-// generates process structure definition from procdef that's already been filled in
+// generates process structure definition from source_procdef (which has already been filled in)
 // used when loading template files from disk
-// doesn't need to use cstate
-int fix_template_design_from_procdef(struct template_struct* target_templ)
+// this isn't part of a compile() call, but errors are reported through cstate, so it needs its own compiler context
+int fix_template_design_from_procdef(struct procdef_struct* source_procdef, struct template_struct* target_templ)
+{
+
+ int success;
+ struct compiler_context_struct* ccontext = open_compiler_context();
+
+ if (ccontext == NULL)
+		return 0;
+
+ struct cstatestruct* cstate = &ccontext->cstate;
+
+ cstate->source_edit = target_templ->source_edit; // used by error messages
+ cstate->procdef = *source_procdef;
+
+ success = fix_design_from_procdef(cstate, target_templ);
+
+ close_compiler_context(ccontext);
+
+ return success;
+
+}
+
+static int fix_design_from_procdef(struct cstatestruct* cstate, struct template_struct* target_templ)
 {
 
-	fstate.target_templ = target_templ;
+	cstate->fstate.target_templ = target_templ;
 
- init_template_for_design(fstate.target_templ); // don't think this is necessary as the file loading functions will already have cleared the template
+ init_template_for_design(cstate->fstate.target_templ); // don't think this is necessary as the file loading functions will already have cleared the template
 
- if (!generate_template_from_procdef(COMPILE_MODE_FIX))
+ if (!generate_template_from_procdef(cstate, COMPILE_MODE_FIX))
 		return 0;
 
- strcpy(target_templ->source_edit->src_file_name, procdef.template_name);
- strcpy(target_templ->source_edit->src_file_path, procdef.template_name); // not sure about this
+ strcpy(target_templ->source_edit->src_file_name, cstate->procdef.template_name);
+ strcpy(target_templ->source_edit->src_file_path, cstate->procdef.template_name); // not sure about this
 
 	target_templ->active = 1;
 
@@ -159,76 +171,76 @@ int fix_template_design_from_procdef(struct template_struct* target_templ)
 }
 
 
-static int read_procdef(void)
+static int read_procdef(struct cstatestruct* cstate)
 {
-	if (fstate.procdef_pos >= procdef.buffer_length)
+	if (cstate->fstate.procdef_pos >= cstate->procdef.buffer_length)
 		return 0; // this will probably cause an error.
 
-	return procdef.buffer [fstate.procdef_pos++];
+	return cstate->procdef.buffer [cstate->fstate.procdef_pos++];
 }
 
 
 // This function can be called either from the compiler or from the template file loading functions
 //  so don't use any compiler-related stuff.
 // When loading a file, compile_mode should be COMPILE_MODE_FIX or maybe BUILD
-static int generate_template_from_procdef(int compile_mode)
+static int generate_template_from_procdef(struct cstatestruct* cstate, int compile_mode)
 {
 
 // struct ctokenstruct ctoken;
 //fpr("\n read A(%i,%i) ", procdef.buffer[15], procdef.buffer[16]);
- strcpy(fstate.target_templ->name, procdef.template_name);
+ strcpy(cstate->fstate.target_templ->name, cstate->procdef.template_name);
 
- fstate.procdef_pos = 0;
+ cstate->fstate.procdef_pos = 0;
 
 // now read in core shape:
 //  (check for non-core shapes first because this is an obvious mistake to make)
- int core_shape = read_procdef();
+ int core_shape = read_procdef(cstate);
 #ifdef TEST_PROCDEF
- fpr("\nread core_shape %i (%i)", core_shape, fstate.procdef_pos);
+ fpr("\nread core_shape %i (%i)", core_shape, cstate->fstate.procdef_pos);
 #endif
  if (core_shape < 0
 		|| core_shape >= FIRST_NONCORE_SHAPE)
-		return procdef_error("invalid core type.");
+		return procdef_error(cstate, "invalid core type.");
 // the error messages here are not super-helpful, but these errors shouldn't really occur
-	fstate.target_templ->member[0].shape = core_shape;
+	cstate->fstate.target_templ->member[0].shape = core_shape;
 	if (core_shape < FIRST_MOBILE_NSHAPE)
-		fstate.target_templ->mobile = 0;
+		cstate->fstate.target_templ->mobile = 0;
  	 else
-  		fstate.target_templ->mobile = 1;
+  		cstate->fstate.target_templ->mobile = 1;
 // Core angle offset
- int core_angle = read_procdef() & ANGLE_MASK;
+ int core_angle = read_procdef(cstate) & ANGLE_MASK;
 #ifdef TEST_PROCDEF
- fpr("\nread core_angle %i (%i)", core_angle, fstate.procdef_pos);
+ fpr("\nread core_angle %i (%i)", core_angle, cstate->fstate.procdef_pos);
 #endif
-	fstate.target_templ->member[0].connection_angle_offset_angle = core_angle;
-	fstate.target_templ->member[0].group_angle_offset = int_angle_to_fixed(core_angle);
-	fstate.target_templ->member[0].connection_angle_offset = fstate.target_templ->member[0].group_angle_offset;
+	cstate->fstate.target_templ->member[0].connection_angle_offset_angle = core_angle;
+	cstate->fstate.target_templ->member[0].group_angle_offset = int_angle_to_fixed(core_angle);
+	cstate->fstate.target_templ->member[0].connection_angle_offset = cstate->fstate.target_templ->member[0].group_angle_offset;
 //	fstate.target_templ->member[0].downlinks_from_core = 0; this is set by read_member_objects_recursively
 
 // read objects:
- if (!read_member_objects_recursively(0, 0))
+ if (!read_member_objects_recursively(cstate, 0, 0))
 		return 0;
 
 	if (compile_mode == COMPILE_MODE_TEST) // locked template
 		return 1; // successful test.
 
-	if (fstate.target_templ->locked)
+	if (cstate->fstate.target_templ->locked)
 	{
-  fstate.target_templ->modified = 0; // design version of process should match source code version
+  cstate->fstate.target_templ->modified = 0; // design version of process should match source code version
 		return 1; // if template locked, process header is parsed but ignored (except to get class name identifiers)
 	}
 
- update_design_member_positions(fstate.target_templ);
+ update_design_member_positions(cstate->fstate.target_templ);
 
- if (!finalise_template_class_lists())
+ if (!finalise_template_class_lists(cstate))
 		return 0;
 
- calculate_template_cost_and_power(fstate.target_templ);
+ calculate_template_cost_and_power(cstate->fstate.target_templ);
 
- if (!finalise_template_details(fstate.target_templ))
+ if (!finalise_template_details(cstate->fstate.target_templ))
 		return 0;
 
- fstate.target_templ->modified = 0; // design version of process should match source code version
+ cstate->fstate.target_templ->modified = 0; // design version of process should match source code version
 
  return 1;
 
@@ -341,12 +353,12 @@ int finalise_template_details(struct template_struct* finish_templ)
 }
 
 
-int read_member_objects_recursively(int member_index, int downlinks_from_core)
+int read_member_objects_recursively(struct cstatestruct* cstate, int member_index, int downlinks_from_core)
 {
 
  int i, j;
- int links = nshape[fstate.target_templ->member[member_index].shape].links;
- fstate.target_templ->member[member_index].downlinks_from_core = downlinks_from_core;
+ int links = nshape[cstate->fstate.target_templ->member[member_index].shape].links;
+ cstate->fstate.target_templ->member[member_index].downlinks_from_core = downlinks_from_core;
 
 // struct ctokenstruct ctoken;
 
@@ -361,46 +373,46 @@ int read_member_objects_recursively(int member_index, int downlinks_from_core)
 
  for (i = 0; i < links; i ++)
 	{
-  int object_type = read_procdef();
+  int object_type = read_procdef(cstate);
 //fpr("\n   obj %i %i", i, object_type);
 #ifdef TEST_PROCDEF
- fpr("\nread object_type %i (%i)", object_type, fstate.procdef_pos);
+ fpr("\nread object_type %i (%i)", object_type, cstate->fstate.procdef_pos);
 #endif
   if (object_type < 0
 			|| object_type >= OBJECT_TYPES)
-				return procdef_error("expected object type");
-	 fstate.target_templ->member[member_index].object[i].type = object_type;
+				return procdef_error(cstate, "expected object type");
+	 cstate->fstate.target_templ->member[member_index].object[i].type = object_type;
 
-	 int number_of_classes = read_procdef();
+	 int number_of_classes = read_procdef(cstate);
 #ifdef TEST_PROCDEF
- fpr("\nread number of classes %i (%i)", number_of_classes, fstate.procdef_pos);
+ fpr("\nread number of classes %i (%i)", number_of_classes, cstate->fstate.procdef_pos);
 #endif
 	 if (number_of_classes < 0
 			|| number_of_classes >= CLASSES_PER_OBJECT)
-			return procdef_error("wrong number of classes");
+			return procdef_error(cstate, "wrong number of classes");
 //fpr("\n number of classes %i: ", number_of_classes);
 	 j = 0;
 	 while (j < number_of_classes)
 		{
-			int class_index = read_procdef();
+			int class_index = read_procdef(cstate);
 //			fpr("(%i:%i), ", j, class_index);
 #ifdef TEST_PROCDEF
- fpr("\nread class_index %i (%i)", class_index, fstate.procdef_pos);
+ fpr("\nread class_index %i (%i)", class_index, cstate->fstate.procdef_pos);
 #endif
 			if (class_index < 0
 				|| class_index >= OBJECT_CLASSES)
-				return procdef_error("invalid class index");
-  	fstate.target_templ->member[member_index].object[i].object_class[j] = class_index;
+				return procdef_error(cstate, "invalid class index");
+  	cstate->fstate.target_templ->member[member_index].object[i].object_class[j] = class_index;
   	j++;
 		}
 
-		int object_angle = read_procdef();
+		int object_angle = read_procdef(cstate);
 #ifdef TEST_PROCDEF
- fpr("\nread object_angle %i (%i)", object_angle, fstate.procdef_pos);
+ fpr("\nread object_angle %i (%i)", object_angle, cstate->fstate.procdef_pos);
 #endif
 		if (object_angle < -ANGLE_4
 			|| object_angle > ANGLE_4)
-			return procdef_error("invalid object angle");
+			return procdef_error(cstate, "invalid object angle");
 
 		if (otype[object_type].object_details.only_zero_angle_offset)
 		{
@@ -408,27 +420,27 @@ int read_member_objects_recursively(int member_index, int downlinks_from_core)
 			object_angle = 0; // some object types can only have zero offset
 		}
 
-	 fstate.target_templ->member[member_index].object[i].base_angle_offset_angle = object_angle;
+	 cstate->fstate.target_templ->member[member_index].object[i].base_angle_offset_angle = object_angle;
 //	fpr("\n read [%i] template %i member %i object %i angle_offset %i", fstate.procdef_pos, fstate.target_templ->template_index, member_index, i, fstate.target_templ->member[member_index].object[i].base_angle_offset_angle);
 
-	 fstate.target_templ->member[member_index].object[i].base_angle_offset = angle_difference_signed(0, int_angle_to_fixed(object_angle));
+	 cstate->fstate.target_templ->member[member_index].object[i].base_angle_offset = angle_difference_signed(0, int_angle_to_fixed(object_angle));
 //fpr("\n fix oa %i base_angle %i base_angle_f %f", object_angle, fstate.target_templ->member[member_index].object[i].base_angle_offset_angle, al_fixtof(fstate.target_templ->member[member_index].object[i].base_angle_offset));
 	 if (object_type == OBJECT_TYPE_DOWNLINK)
 		{
 		 for (j = 1; j < GROUP_CONNECTIONS; j ++)
 		 {
- 			if (fstate.target_templ->member[member_index].connection[j].template_member_index == -1)
+ 			if (cstate->fstate.target_templ->member[member_index].connection[j].template_member_index == -1)
 			 {
- 		  if (!read_member_recursively(member_index, i, j, downlinks_from_core + 1))
+ 		  if (!read_member_recursively(cstate, member_index, i, j, downlinks_from_core + 1))
 			   return 0;
 			  break;
 			 }
 		 }
 	 if (j >= GROUP_CONNECTIONS)
-			return comp_error_text("too many connections", NULL); // not sure this is possible (there should always be enough space in the connections array)
+			return comp_error_text(cstate, "too many connections", NULL); // not sure this is possible (there should always be enough space in the connections array)
 	}
 
-  if (cstate.error != CERR_NONE)
+  if (cstate->error != CERR_NONE)
 			return 0;
 	}
 
@@ -438,49 +450,49 @@ int read_member_objects_recursively(int member_index, int downlinks_from_core)
 
 
 // call this for every member except the core
-int read_member_recursively(int parent_member_index, int parent_object, int parent_connection_index, int downlinks_from_core)
+int read_member_recursively(struct cstatestruct* cstate, int parent_member_index, int parent_object, int parent_connection_index, int downlinks_from_core)
 {
 	int child_member_index;
 //	struct ctokenstruct ctoken;
 
 	if (downlinks_from_core >= MAX_DOWNLINKS_FROM_CORE - 1)
-	 return procdef_error("component too many downlinks away from core");
+	 return procdef_error(cstate, "component too many downlinks away from core");
 
 	for (child_member_index = parent_member_index + 1; child_member_index < GROUP_MAX_MEMBERS; child_member_index ++)
 	{
-		if (fstate.target_templ->member[child_member_index].exists == 0)
+		if (cstate->fstate.target_templ->member[child_member_index].exists == 0)
 		 break;
 	}
 	if (child_member_index >= GROUP_MAX_MEMBERS)
-	 return procdef_error("too many members");
+	 return procdef_error(cstate, "too many members");
 
- init_templ_group_member(fstate.target_templ, child_member_index);
+ init_templ_group_member(cstate->fstate.target_templ, child_member_index);
 
 // read member's shape:
- int member_nshape = read_procdef();
+ int member_nshape = read_procdef(cstate);
 #ifdef TEST_PROCDEF
- fpr("\nread member_nshape %i (%i)", member_nshape, fstate.procdef_pos);
+ fpr("\nread member_nshape %i (%i)", member_nshape, cstate->fstate.procdef_pos);
 #endif
 //  (check for core process shapees first because this is an obvious mistake to make)
  if (member_nshape < FIRST_NONCORE_SHAPE)
-  return procdef_error("only the process core can be a core shape");
+  return procdef_error(cstate, "only the process core can be a core shape");
 	if (member_nshape >= NSHAPES)
-			return procdef_error("invalid process shape");
-	fstate.target_templ->member[child_member_index].shape = member_nshape;
+			return procdef_error(cstate, "invalid process shape");
+	cstate->fstate.target_templ->member[child_member_index].shape = member_nshape;
 
-	fstate.target_templ->member[child_member_index].exists = 1;
+	cstate->fstate.target_templ->member[child_member_index].exists = 1;
 // location etc can wait until later
 
-	fstate.target_templ->member[child_member_index].connection[0].template_member_index = parent_member_index;
-	fstate.target_templ->member[child_member_index].connection[0].reverse_link_index = parent_object;
-	fstate.target_templ->member[child_member_index].connection[0].reverse_connection_index = parent_connection_index;
+	cstate->fstate.target_templ->member[child_member_index].connection[0].template_member_index = parent_member_index;
+	cstate->fstate.target_templ->member[child_member_index].connection[0].reverse_link_index = parent_object;
+	cstate->fstate.target_templ->member[child_member_index].connection[0].reverse_connection_index = parent_connection_index;
 // the final part of the connection structure, link_index, will be filled in below after the member's uplink object is found
-	fstate.target_templ->member[parent_member_index].connection[parent_connection_index].template_member_index = child_member_index;
-	fstate.target_templ->member[parent_member_index].connection[parent_connection_index].link_index = parent_object;
-	fstate.target_templ->member[parent_member_index].connection[parent_connection_index].reverse_connection_index = 0;
+	cstate->fstate.target_templ->member[parent_member_index].connection[parent_connection_index].template_member_index = child_member_index;
+	cstate->fstate.target_templ->member[parent_member_index].connection[parent_connection_index].link_index = parent_object;
+	cstate->fstate.target_templ->member[parent_member_index].connection[parent_connection_index].reverse_connection_index = 0;
 // reverse_link_index set below
 
- if (!read_member_objects_recursively(child_member_index, downlinks_from_core))
+ if (!read_member_objects_recursively(cstate, child_member_index, downlinks_from_core))
 		return 0;
 
 
@@ -489,20 +501,20 @@ int read_member_recursively(int parent_member_index, int parent_object, int pare
  int uplink_object_index = -1;
  for (i = 0; i < MAX_OBJECTS; i ++)
 	{
-		if (fstate.target_templ->member[child_member_index].object[i].type == OBJECT_TYPE_UPLINK)
+		if (cstate->fstate.target_templ->member[child_member_index].object[i].type == OBJECT_TYPE_UPLINK)
 		{
 			if (uplink_object_index != -1)
-				return procdef_error("member process has more than one uplink object");
+				return procdef_error(cstate, "member process has more than one uplink object");
 			uplink_object_index = i;
 		}
 	}
 
-	fstate.target_templ->member[child_member_index].connection[0].link_index = uplink_object_index;
-	fstate.target_templ->member[parent_member_index].connection[parent_connection_index].reverse_link_index = uplink_object_index;
+	cstate->fstate.target_templ->member[child_member_index].connection[0].link_index = uplink_object_index;
+	cstate->fstate.target_templ->member[parent_member_index].connection[parent_connection_index].reverse_link_index = uplink_object_index;
 
 // The angle of the parent member's downlink object should be sufficient to work out where this member is:
- fstate.target_templ->member[child_member_index].connection_angle_offset_angle = fstate.target_templ->member[parent_member_index].object[parent_object].base_angle_offset_angle;
- fstate.target_templ->member[child_member_index].connection_angle_offset = int_angle_to_fixed(fstate.target_templ->member[child_member_index].connection_angle_offset_angle);
+ cstate->fstate.target_templ->member[child_member_index].connection_angle_offset_angle = cstate->fstate.target_templ->member[parent_member_index].object[parent_object].base_angle_offset_angle;
+ cstate->fstate.target_templ->member[child_member_index].connection_angle_offset = int_angle_to_fixed(cstate->fstate.target_templ->member[child_member_index].connection_angle_offset_angle);
 
 
  return 1;
@@ -514,7 +526,7 @@ int read_member_recursively(int parent_member_index, int parent_object, int pare
 // it reads the classes that each object has been assigned to (in the objects' object_class arrays)
 //  and uses that to build the class lists in the main template struct.
 //  - can be called from code and design
-int finalise_template_class_lists(void)
+int finalise_template_class_lists(struct cstatestruct* cstate)
 {
 
  int i, j, k, m, class_index;
@@ -525,25 +537,25 @@ int finalise_template_class_lists(void)
 	{
   for (j = 0; j < OBJECT_CLASS_SIZE; j ++)
 		{
-			fstate.target_templ->object_class_member [i] [j] = -1;
-			fstate.target_templ->object_class_object [i] [j] = -1;
+			cstate->fstate.target_templ->object_class_member [i] [j] = -1;
+			cstate->fstate.target_templ->object_class_object [i] [j] = -1;
 		}
 	}
 
 // now go through each member, object, and object object_class
  for (i = 0; i < GROUP_MAX_MEMBERS; i ++)
 	{
-		if (fstate.target_templ->member[i].exists == 0)
+		if (cstate->fstate.target_templ->member[i].exists == 0)
 			continue;
 		for (j = 0; j < MAX_OBJECTS; j ++)
 		{
- 		if (fstate.target_templ->member[i].object[j].type == OBJECT_TYPE_NONE)
+ 		if (cstate->fstate.target_templ->member[i].object[j].type == OBJECT_TYPE_NONE)
 	 		continue;
 			for (k = 0; k < CLASSES_PER_OBJECT; k ++)
 			{
- 		 if (fstate.target_templ->member[i].object[j].object_class [k] == -1)
+ 		 if (cstate->fstate.target_templ->member[i].object[j].object_class [k] == -1)
 	 		 continue;
-	 		class_index = fstate.target_templ->member[i].object[j].object_class [k];
+	 		class_index = cstate->fstate.target_templ->member[i].object[j].object_class [k];
 #ifdef SANITY_CHECK
 if (class_index < 0 || class_index >= OBJECT_CLASSES)
 {
@@ -553,17 +565,17 @@ if (class_index < 0 || class_index >= OBJECT_CLASSES)
 #endif
 		  for (m = 0; m < OBJECT_CLASS_SIZE; m ++)
 				{
-					if (fstate.target_templ->object_class_member [class_index] [m] == -1)
+					if (cstate->fstate.target_templ->object_class_member [class_index] [m] == -1)
 						break;
 				}
 				if (m == OBJECT_CLASS_SIZE)
 				{
-					snprintf(error_text, 60, "object class %s has too many objects (maximum is %i)", fstate.target_templ->object_class_name [class_index], OBJECT_CLASS_SIZE);
-					return comp_error_text(error_text, NULL);
+					snprintf(error_text, 60, "object class %s has too many objects (maximum is %i)", cstate->fstate.target_templ->object_class_name [class_index], OBJECT_CLASS_SIZE);
+					return comp_error_text(cstate, error_text, NULL);
 				}
-				fstate.target_templ->object_class_active [class_index] = 1; // shouldn't be needed but can't hurt
-				fstate.target_templ->object_class_member [class_index] [m] = i;
-				fstate.target_templ->object_class_object [class_index] [m] = j;
+				cstate->fstate.target_templ->object_class_active [class_index] = 1; // shouldn't be needed but can't hurt
+				cstate->fstate.target_templ->object_class_member [class_index] [m] = i;
+				cstate->fstate.target_templ->object_class_object [class_index] [m] = j;
 			}
 		}
 	}
@@ -573,29 +585,29 @@ if (class_index < 0 || class_index >= OBJECT_CLASSES)
 }
 
 
-static int procdef_error(const char* error_text)
+static int procdef_error(struct cstatestruct* cstate, const char* error_text)
 {
 
-     start_log_line(MLOG_COL_ERROR);
-     if (fstate.procdef_pos > 0)
+     start_log_buffer_line(cstate->log, MLOG_COL_ERROR);
+     if (cstate->fstate.procdef_pos > 0)
 					{
-      write_to_log("Process definition error at line ");
-      write_number_to_log(procdef.buffer_source_line [fstate.procdef_pos-1]);
+      write_to_log_buffer(cstate->log, "Process definition error at line ");
+      write_number_to_log_buffer(cstate->log, cstate->procdef.buffer_source_line [cstate->fstate.procdef_pos-1]);
 					}
 					 else
 						{
-       write_to_log("Process definition error.");
+       write_to_log_buffer(cstate->log, "Process definition error.");
 						}
-     write_to_log(".");
-     finish_log_line();
+     write_to_log_buffer(cstate->log, ".");
+     finish_log_buffer_line(cstate->log);
 
-     start_log_line(MLOG_COL_ERROR);
-     write_to_log("Error: ");
-     write_to_log(error_text);
-     write_to_log(".");
-     finish_log_line();
+     start_log_buffer_line(cstate->log, MLOG_COL_ERROR);
+     write_to_log_buffer(cstate->log, "Error: ");
+     write_to_log_buffer(cstate->log, error_text);
+     write_to_log_buffer(cstate->log, ".");
+     finish_log_buffer_line(cstate->log);
 
-     cstate.error = CERR_GENERIC;
+     cstate->error = CERR_GENERIC;
      return 0;
 }
 
@@ -638,17 +650,17 @@ static int procdef_error(const char* error_text)
 
 // PROCDEF stuff!!!!!!!!!!!!!!!!!!!
 
-static int init_procdef(void);
-static void write_to_procdef(s16b value);
-static int procdef_read_member_objects_recursively(int shape_index);
-static int procdef_read_member_recursively(void);//, int parent_connection_index)
-static int procdef_declare_new_class(struct ctokenstruct* ctoken);
+static int init_procdef(struct procdef_struct* procdef);
+static void write_to_procdef(struct procdef_struct* procdef, s16b value, int src_line);
+static int procdef_read_member_objects_recursively(struct cstatestruct* cstate, int shape_index);
+static int procdef_read_member_recursively(struct cstatestruct* cstate);//, int parent_connection_index)
+static int procdef_declare_new_class(struct cstatestruct* cstate, struct ctokenstruct* ctoken);
 
 
-static int init_procdef(void)
+static int init_procdef(struct procdef_struct* procdef)
 {
 
- procdef.template_name [0] = '\0';
+ procdef->template_name [0] = '\0';
 
 // int i;
 
@@ -658,7 +670,7 @@ static int init_procdef(void)
 //		procdef.class_name [i] [0] = '\0'; - probably don't need this
 //	}
 
-	procdef.buffer_length = 0;
+	procdef->buffer_length = 0;
 // could clear the buffer but that's probably not necessary
 
  return 1;
@@ -667,49 +679,49 @@ static int init_procdef(void)
 
 
 // Call this when compiling process definition part of source code.
-// Reads the process structure definition from cstate.scode.
+// Reads the process structure definition from cstate->scode.
 // Depending on the compiler mode, may discard process structure (but always processes structure to test it and to declare classes)
 // Updates cstate with e.g. new scode_pos.
 // returns 1 on success, 0 on failure
-int	parse_process_definition(void)
+int	parse_process_definition(struct cstatestruct* cstate)
 {
 
-/*fpr("\n A sc_pos %i src_line %i", cstate.scode_pos, cstate.src_line);
+/*fpr("\n A sc_pos %i src_line %i", cstate->scode_pos, cstate->src_line);
 
 int k;
 
 for (k = 0; k < 100; k ++)
 {
-	fpr("\n scode_pos %i src_line %i", k, cstate.scode.src_line [k]);
+	fpr("\n scode_pos %i src_line %i", k, cstate->scode.src_line [k]);
 }
 */
 
-	fstate.target_templ = cstate.templ;
+	cstate->fstate.target_templ = cstate->templ;
 
- init_procdef();
-//fpr("\n template %i A(%i,%i) ", cstate.templ->template_index, procdef.buffer [15],procdef.buffer [16]);
- init_template_for_design(fstate.target_templ);
+ init_procdef(&cstate->procdef);
+//fpr("\n template %i A(%i,%i) ", cstate->templ->template_index, procdef.buffer [15],procdef.buffer [16]);
+ init_template_for_design(cstate->fstate.target_templ);
 //fpr("B(%i,%i) ", procdef.buffer [15],procdef.buffer [16]);
 
  struct ctokenstruct ctoken;
 
 // the first thing in the scode should be #process
 //  (deal with naming processes later)
-	if (!accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_HASH))
+	if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_HASH))
 	{
 //		fpr("\n # token type %i found", ctoken.type);
-		return comp_error(CERR_FIXER_EXPECTED_PROCESS_HEADER, &ctoken);
+		return comp_error(cstate, CERR_FIXER_EXPECTED_PROCESS_HEADER, &ctoken);
 	}
 
-	if (!accept_next(&ctoken, CTOKEN_TYPE_IDENTIFIER_NON_C_KEYWORD, KEYWORD_C_PROCESS))
+	if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_IDENTIFIER_NON_C_KEYWORD, KEYWORD_C_PROCESS))
 	{
 //		fpr("\n pr token type %i found", ctoken.type);
-		return comp_error(CERR_FIXER_EXPECTED_PROCESS_HEADER, &ctoken);
+		return comp_error(cstate, CERR_FIXER_EXPECTED_PROCESS_HEADER, &ctoken);
 	}
 
 // accept template name
 //  (this should be on the same line as #process, but technically doesn't have to be)
- if (accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_QUOTES))
+ if (accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_QUOTES))
 	{
   char template_name_string [TEMPLATE_NAME_LENGTH];
   template_name_string [0] = '\0';
@@ -719,14 +731,14 @@ for (k = 0; k < 100; k ++)
 
 	 while(TRUE)
 	 {
- 		read_char = c_get_next_char_from_scode();
+ 		read_char = c_get_next_char_from_scode(cstate);
 		 if (read_char == REACHED_END_OF_SCODE)
-  		return comp_error_text("reached end of source inside string", NULL);
+  		return comp_error_text(cstate, "reached end of source inside string", NULL);
 		 if (read_char == 0)
-  		return comp_error_text("found null character inside string?", NULL);
+  		return comp_error_text(cstate, "found null character inside string?", NULL);
 
    if (template_name_length >= TEMPLATE_NAME_LENGTH - 2)
-  		return comp_error_text("template name too long", NULL);
+  		return comp_error_text(cstate, "template name too long", NULL);
 
  	 if (read_char == '"')
   	 break;
@@ -736,26 +748,26 @@ for (k = 0; k < 100; k ++)
 
   template_name_string [template_name_length] = '\0';
 
-  strcpy(procdef.template_name, template_name_string);
+  strcpy(cstate->procdef.template_name, template_name_string);
 
 	}
 //fpr("C(%i,%i) ", procdef.buffer [15],procdef.buffer [16]);
 
 // accept classes
- while(accept_next(&ctoken, CTOKEN_TYPE_IDENTIFIER_NON_C_KEYWORD, KEYWORD_C_CLASS))
+ while(accept_next(cstate, &ctoken, CTOKEN_TYPE_IDENTIFIER_NON_C_KEYWORD, KEYWORD_C_CLASS))
 	{
-		if (!read_next(&ctoken))
+		if (!read_next(cstate, &ctoken))
 			return 0;
 		while (TRUE)
 		{
 		 if (ctoken.type != CTOKEN_TYPE_IDENTIFIER_NEW)
- 			return comp_error_text("expected new class name after class (word already in use?)", &ctoken);
- 		if (!procdef_declare_new_class(&ctoken))
+ 			return comp_error_text(cstate, "expected new class name after class (word already in use?)", &ctoken);
+ 		if (!procdef_declare_new_class(cstate, &ctoken))
 				return 0;
-		 if (accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_SEMICOLON))
+		 if (accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_SEMICOLON))
 				break;
-			if (!accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))
-				return comp_error_text("expected ; or , after class declaration", &ctoken);
+			if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))
+				return comp_error_text(cstate, "expected ; or , after class declaration", &ctoken);
 		};
 	};
 //fpr("D(%i,%i) ", procdef.buffer [15],procdef.buffer [16]);
@@ -766,30 +778,30 @@ for (k = 0; k < 100; k ++)
 
 // now read in core shape:
 //  (check for non-core shapes first because this is an obvious mistake to make)
-	if (accept_next(&ctoken, CTOKEN_TYPE_IDENTIFIER_SHAPE, -1))
-		return comp_error_text("the process core must be a core shape", &ctoken);
-	if (!accept_next(&ctoken, CTOKEN_TYPE_IDENTIFIER_CORE_SHAPE, -1))
-		return comp_error_text("expected a core shape", &ctoken);
+	if (accept_next(cstate, &ctoken, CTOKEN_TYPE_IDENTIFIER_SHAPE, -1))
+		return comp_error_text(cstate, "the process core must be a core shape", &ctoken);
+	if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_IDENTIFIER_CORE_SHAPE, -1))
+		return comp_error_text(cstate, "expected a core shape", &ctoken);
 //	fstate.target_templ->member[0].shape = identifier[ctoken.identifier_index].value;
- int core_shape = identifier[ctoken.identifier_index].value;
- write_to_procdef(core_shape);
+ int core_shape = cstate->identifier[ctoken.identifier_index].value;
+ write_to_procdef(&cstate->procdef, core_shape, cstate->src_line);
 #ifdef TEST_PROCDEF
- fpr("\nwrite core_shape %i (%i)", core_shape, procdef.buffer_length);
+ fpr("\nwrite core_shape %i (%i)", core_shape, cstate->procdef.buffer_length);
 #endif
-	if (!accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))
-		return comp_error_text("expected comma after core shape", &ctoken);
+	if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))
+		return comp_error_text(cstate, "expected comma after core shape", &ctoken);
 // Core angle offset
- if (!expect_angle(&ctoken))
-		return comp_error_text("core angle not a constant number?", &ctoken);
- write_to_procdef(ctoken.number_value);
+ if (!expect_angle(cstate, &ctoken))
+		return comp_error_text(cstate, "core angle not a constant number?", &ctoken);
+ write_to_procdef(&cstate->procdef, ctoken.number_value, cstate->src_line);
 #ifdef TEST_PROCDEF
- fpr("\nwrite core_angle %i (%i)", ctoken.number_value, procdef.buffer_length);
+ fpr("\nwrite core_angle %i (%i)", ctoken.number_value, cstate->procdef.buffer_length);
 #endif
 
-	if (!accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))
-		return comp_error_text("expected comma after core angle", &ctoken);
+	if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))
+		return comp_error_text(cstate, "expected comma after core angle", &ctoken);
 // read objects:
- if (!procdef_read_member_objects_recursively(core_shape))
+ if (!procdef_read_member_objects_recursively(cstate, core_shape))
 		return 0;
 
 // expect close brace:
@@ -798,17 +810,17 @@ for (k = 0; k < 100; k ++)
 		//return comp_error_text("expected open brace at start of process structure definition", &ctoken);
 
 // Finish by checking for #code directive
-	if (!accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_HASH))
-		return comp_error(CERR_FIXER_EXPECTED_CODE_HEADER, &ctoken);
-	if (!accept_next(&ctoken, CTOKEN_TYPE_IDENTIFIER_NON_C_KEYWORD, KEYWORD_C_CODE))
-		return comp_error(CERR_FIXER_EXPECTED_CODE_HEADER, &ctoken);
+	if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_HASH))
+		return comp_error(cstate, CERR_FIXER_EXPECTED_CODE_HEADER, &ctoken);
+	if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_IDENTIFIER_NON_C_KEYWORD, KEYWORD_C_CODE))
+		return comp_error(cstate, CERR_FIXER_EXPECTED_CODE_HEADER, &ctoken);
 //fpr("E(%i,%i) ", procdef.buffer [15],procdef.buffer [16]);
 
  return 1;
 
 }
 
-//	if (cstate.compile_mode == COMPILE_MODE_TEST)
+//	if (cstate->compile_mode == COMPILE_MODE_TEST)
 //		return 1; // successful test.
 
 // should not proceed past here if target_templ is not dwindow.templ
@@ -817,7 +829,7 @@ for (k = 0; k < 100; k ++)
 //* write process definition to template here.
 
 
-// update_design_member_positions(cstate.templ);  - not needed in procdef
+// update_design_member_positions(cstate->templ);  - not needed in procdef
 /*
 // Now, fix the template!
  int i;
@@ -867,18 +879,19 @@ core_basic_4, angle
 //}
 
 
-static void write_to_procdef(s16b value)
+// src_line is the source line that value came from (0 if there isn't one)
+static void write_to_procdef(struct procdef_struct* procdef, s16b value, int src_line)
 {
-	if (procdef.buffer_length <= PROCDEF_BUFFER - 1)
+	if (procdef->buffer_length <= PROCDEF_BUFFER - 1)
 	{
-		procdef.buffer [procdef.buffer_length] = value;
-		procdef.buffer_source_line [procdef.buffer_length] = cstate.src_line;
-		procdef.buffer_length ++;
+		procdef->buffer [procdef->buffer_length] = value;
+		procdef->buffer_source_line [procdef->buffer_length] = src_line;
+		procdef->buffer_length ++;
 	}
 // otherwise just ignore. Deal with excessively long procdef.buffer at the end.
 }
 
-static int procdef_read_member_objects_recursively(int shape_index)
+static int procdef_read_member_objects_recursively(struct cstatestruct* cstate, int shape_index)
 {
 
  int i, j;
@@ -900,21 +913,21 @@ static int procdef_read_member_objects_recursively(int shape_index)
 	{
 
 // check for end of objects list:
- 	if (accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACE_CLOSE))
+ 	if (accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACE_CLOSE))
 		{
    while (i < links)
 			{
-				write_to_procdef(OBJECT_TYPE_NONE);
+				write_to_procdef(&cstate->procdef, OBJECT_TYPE_NONE, cstate->src_line);
 #ifdef TEST_PROCDEF
- fpr("\nwrite object type %i (%i)", OBJECT_TYPE_NONE, procdef.buffer_length);
+ fpr("\nwrite object type %i (%i)", OBJECT_TYPE_NONE, cstate->procdef.buffer_length);
 #endif
-				write_to_procdef(0); // no classes
+				write_to_procdef(&cstate->procdef, 0, cstate->src_line); // no classes
 #ifdef TEST_PROCDEF
- fpr("\nwrite number_of_classes %i (%i)", 0, procdef.buffer_length);
+ fpr("\nwrite number_of_classes %i (%i)", 0, cstate->procdef.buffer_length);
 #endif
-				write_to_procdef(0); // angle
+				write_to_procdef(&cstate->procdef, 0, cstate->src_line); // angle
 #ifdef TEST_PROCDEF
- fpr("\nwrite object_angle %i (%i)", 0, procdef.buffer_length);
+ fpr("\nwrite object_angle %i (%i)", 0, cstate->procdef.buffer_length);
 #endif
 				i++;
 			}
@@ -922,69 +935,69 @@ static int procdef_read_member_objects_recursively(int shape_index)
 		}
 
 // expect open brace:
-	if (!accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACE_OPEN))
-		return comp_error_text("expected open brace at start of object", &ctoken);
+	if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACE_OPEN))
+		return comp_error_text(cstate, "expected open brace at start of object", &ctoken);
 // expect object type:
-	if (!accept_next(&ctoken, CTOKEN_TYPE_IDENTIFIER_OBJECT, -1))
-		return comp_error_text("expected object type", &ctoken);
-	int object_type = identifier[ctoken.identifier_index].value;
-	write_to_procdef(object_type);
+	if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_IDENTIFIER_OBJECT, -1))
+		return comp_error_text(cstate, "expected object type", &ctoken);
+	int object_type = cstate->identifier[ctoken.identifier_index].value;
+	write_to_procdef(&cstate->procdef, object_type, cstate->src_line);
 #ifdef TEST_PROCDEF
- fpr("\nwrite object_type %i (%i)", object_type, procdef.buffer_length);
+ fpr("\nwrite object_type %i (%i)", object_type, cstate->procdef.buffer_length);
 #endif
 //	fstate.target_templ->member[member_index].object[i].type = identifier[ctoken.identifier_index].value;
 	int classes_on_object = 0;
 	int object_class [CLASSES_PER_OBJECT];
-	while(accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COLON))
+	while(accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COLON))
 	{
  	if (classes_on_object >= CLASSES_PER_OBJECT)
-	 	return comp_error_text("objects can be members of maximum 4 classes", NULL);
+	 	return comp_error_text(cstate, "objects can be members of maximum 4 classes", NULL);
 
-		if (!read_next(&ctoken))
+		if (!read_next(cstate, &ctoken))
 			return 0;
 		if (ctoken.type != CTOKEN_TYPE_IDENTIFIER_CLASS)
-			return comp_error_text("expected class name after colon", &ctoken);
-		object_class [classes_on_object] =	identifier[ctoken.identifier_index].value;
+			return comp_error_text(cstate, "expected class name after colon", &ctoken);
+		object_class [classes_on_object] =	cstate->identifier[ctoken.identifier_index].value;
 		classes_on_object++;
 	}
-	write_to_procdef(classes_on_object);
+	write_to_procdef(&cstate->procdef, classes_on_object, cstate->src_line);
 #ifdef TEST_PROCDEF
- fpr("\nwrite classes_on_object %i (%i)", classes_on_object, procdef.buffer_length);
+ fpr("\nwrite classes_on_object %i (%i)", classes_on_object, cstate->procdef.buffer_length);
 #endif
 //	fpr("\nclasses on object: %i: ", classes_on_object);
 	j = 0;
 	while (j < classes_on_object)
 	{
- 	write_to_procdef(object_class [j]);
+ 	write_to_procdef(&cstate->procdef, object_class [j], cstate->src_line);
 #ifdef TEST_PROCDEF
- fpr("\nwrite object_class %i (%i)", object_class [j], procdef.buffer_length);
+ fpr("\nwrite object_class %i (%i)", object_class [j], cstate->procdef.buffer_length);
 #endif
 		j ++;
 	}
-	if (!accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))
-		return comp_error_text("expected , or : after object type or class", &ctoken);
-	if (!expect_angle(&ctoken))
-		return comp_error_text("expected object angle", &ctoken); // should accept } here for angle 0 (or unspecified, for objects without angles)
+	if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))
+		return comp_error_text(cstate, "expected , or : after object type or class", &ctoken);
+	if (!expect_angle(cstate, &ctoken))
+		return comp_error_text(cstate, "expected object angle", &ctoken); // should accept } here for angle 0 (or unspecified, for objects without angles)
 	if (ctoken.number_value < -ANGLE_4)
-		return comp_error_text("object angle offset too low (minimum is -2048)", &ctoken);
+		return comp_error_text(cstate, "object angle offset too low (minimum is -2048)", &ctoken);
 	if (ctoken.number_value > ANGLE_4)
-		return comp_error_text("object angle offset too high (maximum is 2048)", &ctoken);
-	write_to_procdef(ctoken.number_value);
+		return comp_error_text(cstate, "object angle offset too high (maximum is 2048)", &ctoken);
+	write_to_procdef(&cstate->procdef, ctoken.number_value, cstate->src_line);
 #ifdef TEST_PROCDEF
- fpr("\nwrite object_angle %i (%i)", ctoken.number_value, procdef.buffer_length);
+ fpr("\nwrite object_angle %i (%i)", ctoken.number_value, cstate->procdef.buffer_length);
 #endif
 //	fstate.target_templ->member[member_index].object[i].base_angle_offset_angle = ctoken.number_value;
 //	fstate.target_templ->member[member_index].object[i].base_angle_offset = angle_difference_signed(0, int_angle_to_fixed(ctoken.number_value));
 
  if (object_type == OBJECT_TYPE_DOWNLINK)
 	{
-	 if (!accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))
-		 return comp_error_text("expected comma after downlink object angle", &ctoken);
+	 if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA))
+		 return comp_error_text(cstate, "expected comma after downlink object angle", &ctoken);
 //		for (j = 1; j < GROUP_CONNECTIONS; j ++)
 //		{
 //			if (fstate.target_templ->member[member_index].connection[j].template_member_index == -1)
 //			{
-		  if (!procdef_read_member_recursively())
+		  if (!procdef_read_member_recursively(cstate))
 			  return 0;
 //			 break;
 //			}
@@ -993,13 +1006,13 @@ static int procdef_read_member_objects_recursively(int shape_index)
 //			return comp_error_text("too many connections", NULL); // not sure this is possible (there should always be enough space in the connections array)
 	}
 
-	 if (!accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACE_CLOSE))
-	 	return comp_error_text("expected closing brace at end of object", &ctoken);
+	 if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACE_CLOSE))
+	 	return comp_error_text(cstate, "expected closing brace at end of object", &ctoken);
 
 // finally, accept (but don't require) a comma:
- 	accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA);
+ 	accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA);
 // could check for error here...
-  if (cstate.error != CERR_NONE)
+  if (cstate->error != CERR_NONE)
 			return 0;
 	}
 
@@ -1009,7 +1022,7 @@ static int procdef_read_member_objects_recursively(int shape_index)
 
 
 // call this for every member except the core
-static int procdef_read_member_recursively(void)//, int parent_connection_index)
+static int procdef_read_member_recursively(struct cstatestruct* cstate)//, int parent_connection_index)
 {
 //	int child_member_index;
 	struct ctokenstruct ctoken;
@@ -1017,24 +1030,24 @@ static int procdef_read_member_recursively(void)//, int parent_connection_index)
 // init_templ_group_member(fstate.target_templ, child_member_index);
 
 // expect open brace:
-	if (!accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACE_OPEN))
-		return comp_error_text("expected open brace at start of process member", &ctoken);
+	if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACE_OPEN))
+		return comp_error_text(cstate, "expected open brace at start of process member", &ctoken);
 // read member's shape:
 //  (check for core process shapees first because this is an obvious mistake to make)
-	if (accept_next(&ctoken, CTOKEN_TYPE_IDENTIFIER_CORE_SHAPE, -1))
-		return comp_error_text("only the process core can be a core shape", &ctoken);
-	if (!accept_next(&ctoken, CTOKEN_TYPE_IDENTIFIER_SHAPE, -1))
-		return comp_error_text("expected process shape", &ctoken);
-	int component_shape = identifier[ctoken.identifier_index].value;
-	write_to_procdef(component_shape);
+	if (accept_next(cstate, &ctoken, CTOKEN_TYPE_IDENTIFIER_CORE_SHAPE, -1))
+		return comp_error_text(cstate, "only the process core can be a core shape", &ctoken);
+	if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_IDENTIFIER_SHAPE, -1))
+		return comp_error_text(cstate, "expected process shape", &ctoken);
+	int component_shape = cstate->identifier[ctoken.identifier_index].value;
+	write_to_procdef(&cstate->procdef, component_shape, cstate->src_line);
 #ifdef TEST_PROCDEF
- fpr("\nwrite component_shape %i (%i)", component_shape, procdef.buffer_length);
+ fpr("\nwrite component_shape %i (%i)", component_shape, cstate->procdef.buffer_length);
 #endif
 
 //	fstate.target_templ->member[child_member_index].shape = identifier[ctoken.identifier_index].value;
 
 // accept (but don't require) a comma:
-	accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA);
+	accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_COMMA);
 // could check for error here...
 
 //	fstate.target_templ->member[child_member_index].exists = 1;
@@ -1049,7 +1062,7 @@ static int procdef_read_member_recursively(void)//, int parent_connection_index)
 //	fstate.target_templ->member[parent_member_index].connection[parent_connection_index].reverse_connection_index = 0;
 // reverse_link_index set below
 
- if (!procdef_read_member_objects_recursively(component_shape))
+ if (!procdef_read_member_objects_recursively(cstate, component_shape))
 		return 0;
 
 /*
@@ -1073,8 +1086,8 @@ static int procdef_read_member_recursively(void)//, int parent_connection_index)
  fstate.target_templ->member[child_member_index].connection_angle_offset_angle = fstate.target_templ->member[parent_member_index].object[parent_object].base_angle_offset_angle;
  fstate.target_templ->member[child_member_index].connection_angle_offset = int_angle_to_fixed(fstate.target_templ->member[child_member_index].connection_angle_offset_angle);
 */
-	if (!accept_next(&ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACE_CLOSE))
-		return comp_error_text("expected closing brace at end of process member (too many objects?)", &ctoken);
+	if (!accept_next(cstate, &ctoken, CTOKEN_TYPE_PUNCTUATION, CTOKEN_SUBTYPE_BRACE_CLOSE))
+		return comp_error_text(cstate, "expected closing brace at end of process member (too many objects?)", &ctoken);
 
 //* not sure about these open/close braces
 
@@ -1083,27 +1096,27 @@ static int procdef_read_member_recursively(void)//, int parent_connection_index)
 }
 
 // This is a bit of a hack - it declares a class that will be used later when the template is being generated from the procdef.
-static int procdef_declare_new_class(struct ctokenstruct* ctoken)
+static int procdef_declare_new_class(struct cstatestruct* cstate, struct ctokenstruct* ctoken)
 {
-//fpr("\n procdef_declare_new_class(%s) scp %i srcl %i", identifier[ctoken->identifier_index].name, cstate.scode_pos, cstate.src_line);
+//fpr("\n procdef_declare_new_class(%s) scp %i srcl %i", identifier[ctoken->identifier_index].name, cstate->scode_pos, cstate->src_line);
 	int i;
 
 	for (i = 0; i < OBJECT_CLASSES; i ++)
 	{
-		if (fstate.target_templ->object_class_active [i] == 0)
+		if (cstate->fstate.target_templ->object_class_active [i] == 0)
 			break;
 	}
 
 	if (i == OBJECT_CLASSES)
-		return comp_error_text("too many classes declared (maximum 16)", ctoken);
+		return comp_error_text(cstate, "too many classes declared (maximum 16)", ctoken);
 
-	identifier[ctoken->identifier_index].type = CTOKEN_TYPE_IDENTIFIER_CLASS;
- identifier[ctoken->identifier_index].value = i;
+	cstate->identifier[ctoken->identifier_index].type = CTOKEN_TYPE_IDENTIFIER_CLASS;
+ cstate->identifier[ctoken->identifier_index].value = i;
 
- fstate.target_templ->object_class_active [i] = 1;
- if (strlen(identifier[ctoken->identifier_index].name) >= CLASS_NAME_LENGTH)
-		return comp_error_text("class name too long (maximum 16 characters)", ctoken); // maximum length for an identifier is longer than maximum class name length
- strcpy(fstate.target_templ->object_class_name [i], identifier[ctoken->identifier_index].name);
+ cstate->fstate.target_templ->object_class_active [i] = 1;
+ if (strlen(cstate->identifier[ctoken->identifier_index].name) >= CLASS_NAME_LENGTH)
+		return comp_error_text(cstate, "class name too long (maximum 16 characters)", ctoken); // maximum length for an identifier is longer than maximum class name length
+ strcpy(cstate->fstate.target_templ->object_class_name [i], cstate->identifier[ctoken->identifier_index].name);
 
  return 1;
 
@@ -1139,26 +1152,26 @@ int add_object_to_class(int member_index, int object_index, struct ctokenstruct*
 
 
 
-static int derive_member_objects_recursively(struct template_struct* derive_templ, int member_index);
+static int derive_member_objects_recursively(struct procdef_struct* procdef, struct template_struct* derive_templ, int member_index);
 
 
 // Code to derive procdef from template (needed when saving and loading template file in binary form)
 // Should probably only be called on a locked template, so we can be sure that the template's values are valid
 // Also, the source line fields of procdef will be wrong, so don't use them after deriving.
-int derive_procdef_from_template(struct template_struct* derive_templ)
+int derive_procdef_from_template(struct procdef_struct* procdef, struct template_struct* derive_templ)
 {
 
 	if (!derive_templ->active)
 		return 0; // just to make sure
 
- init_procdef();
+ init_procdef(procdef);
 
- strcpy(procdef.template_name, derive_templ->name);
+ strcpy(procdef->template_name, derive_templ->name);
 
-	write_to_procdef(derive_templ->member[0].shape);
-	write_to_procdef(derive_templ->member[0].connection_angle_offset_angle);
+	write_to_procdef(procdef, derive_templ->member[0].shape, 0);
+	write_to_procdef(procdef, derive_templ->member[0].connection_angle_offset_angle, 0);
 
- derive_member_objects_recursively(derive_templ, 0);
+ derive_member_objects_recursively(procdef, derive_templ, 0);
 
 
  return 1;
@@ -1166,7 +1179,7 @@ int derive_procdef_from_template(struct template_struct* derive_templ)
 }
 
 
-static int derive_member_objects_recursively(struct template_struct* derive_templ, int member_index)
+static int derive_member_objects_recursively(struct procdef_struct* procdef, struct template_struct* derive_templ, int member_index)
 {
 
  int i, j;
@@ -1174,7 +1187,7 @@ static int derive_member_objects_recursively(struct template_struct* derive_temp
 
  for (i = 0; i < links; i ++)
 	{
-  write_to_procdef(derive_templ->member[member_index].object[i].type);
+  write_to_procdef(procdef, derive_templ->member[member_index].object[i].type, 0);
 
   int number_of_classes = 0;
   int object_class [CLASSES_PER_OBJECT];
@@ -1188,18 +1201,18 @@ static int derive_member_objects_recursively(struct template_struct* derive_temp
 			}
 		}
 
-		write_to_procdef(number_of_classes);
+		write_to_procdef(procdef, number_of_classes, 0);
 //fpr("\n number_of_classes %i: ", number_of_classes);
 		if (number_of_classes > 0)
 		{
 		 for (j = 0; j < number_of_classes; j ++)
 		 {
-		 	write_to_procdef(object_class [j]);
+		 	write_to_procdef(procdef, object_class [j], 0);
 //		 	fpr("(%i:%i), ", j, object_class [j]);
 		 }
 		}
 
-		write_to_procdef(derive_templ->member[member_index].object[i].base_angle_offset_angle);
+		write_to_procdef(procdef, derive_templ->member[member_index].object[i].base_angle_offset_angle, 0);
 //		fpr("\n [%i] template %i member %i object %i angle_offset %i", procdef.buffer_length, derive_templ->template_index, member_index, i, derive_templ->member[member_index].object[i].base_angle_offset_angle);
 
 		if (derive_templ->member[member_index].object[i].type == OBJECT_TYPE_DOWNLINK)
@@ -1209,8 +1222,8 @@ static int derive_member_objects_recursively(struct template_struct* derive_temp
 				if (derive_templ->member[member_index].connection[j].link_index == i)
 					break; // should be able to assume that this search will find the right link (as long as this is only ever called on valid templates)
 			}
-			write_to_procdef(derive_templ->member[derive_templ->member[member_index].connection[j].template_member_index].shape);
-			derive_member_objects_recursively(derive_templ, derive_templ->member[member_index].connection[j].template_member_index);
+			write_to_procdef(procdef, derive_templ->member[derive_templ->member[member_index].connection[j].template_member_index].shape, 0);
+			derive_member_objects_recursively(procdef, derive_templ, derive_templ->member[member_index].connection[j].template_member_index);
 		}
 
 	}
@@ -2,6 +2,6 @@
 #ifndef H_C_GENERATE
 #define H_C_GENERATE
 
-int intercode_to_bcode(void);
+int intercode_to_bcode(struct cstatestruct* cstate);
 
 #endif
@@ -12,6 +12,10 @@
 #define RECURSION_LIMIT 1000
 // since the compiler uses recursive descent, we need to make sure it doesn't run out of stack space on bad input.
 
+#define COMPILE_CACHE_VERSION 4
+// COMPILE_CACHE_VERSION is part of the key for the compile cache (see c_cache.c). A rebuilt executable gets a new key anyway,
+//  but increase this whenever a change to the compiler changes the bcode or template design produced from the same source.
+
 
 enum
 {
@@ -21,6 +25,16 @@ COMPILE_MODE_LOCK, // like build, but fails (returns 0) if a template design pro
 COMPILE_MODE_FIX, // just fixes the template design.
 };
 
+// bits in settings.option [OPTION_OPTIMISE] (the "optimise" line in init.txt). Each turns the optimiser (c_optimise.c) on for a compile mode:
+#define OPTIMISE_MODE_TEST 1
+#define OPTIMISE_MODE_BUILD 2
+#define OPTIMISE_MODE_LOCK 4
+#define OPTIMISE_MODES_ALL (OPTIMISE_MODE_TEST | OPTIMISE_MODE_BUILD | OPTIMISE_MODE_LOCK)
+
+// maximum number of templates compile_templates() (in c_compile.c) compiles at once.
+// settings.option [OPTION_COMPILE_THREADS] (the "compile_threads" line in init.txt) can set it lower. 0 means use one thread for each CPU core.
+#define COMPILE_THREADS_MAX 16
+
 
 /*
 enum
@@ -293,9 +307,69 @@ struct scodestruct
 
 };
 
+// Hash table used by the lexer (c_lexer.c) to find identifiers by name. Each entry is an index in the identifier array, or -1 if empty.
+// Uses linear probing. Must be a power of 2, and should be a good deal larger than IDENTIFIERS so that chains stay short.
+#define IDENTIFIER_HASH_SIZE 2048
+#define IDENTIFIER_HASH_MASK (IDENTIFIER_HASH_SIZE - 1)
+
+// preprocessor state (see c_prepr.c)
+struct prstate_struct
+{
+	struct source_edit_struct* source_edit;
+	int src_line;
+	int src_pos;
+	int scode_pos;
+};
+
+#define PROCDEF_BUFFER (GROUP_MAX_MEMBERS*MAX_LINKS*10)
+ // I think this should be long enough.
+
+struct procdef_struct
+{
+// the procdef struct contains a numerical representation of the process definition.
+// first, the fixer parses the process definition from the source code and into the procdef
+//   OR the procdef is loaded directly from a binary file
+// then, the procdef is used to build the actual template.
+//  the procdef is checked for validity when used to build a template, so it can contain errors.
+
+ char template_name [TEMPLATE_NAME_LENGTH];
+// int class_declared [OBJECT_CLASSES];
+// char class_name [OBJECT_CLASSES] [CLASS_NAME_LENGTH];
+// class_names may be empty if procdef loaded from binary
+
+// the structure of a procdef reflects the structure of the source code, not the structure of the template data.
+ s16b buffer [PROCDEF_BUFFER]; // this is s16b because it is saved directly to template files.
+ int buffer_source_line [PROCDEF_BUFFER]; // used to display error messages when writing the procdef to template
+ int buffer_length;
+
+// struct procdef_line_struct procdef_line [PROCDEF_LINES];
+
+};
+
+// template design fixer state (see c_fix.c)
+struct fstatestruct
+{
+	struct template_struct* target_templ;
+
+	int procdef_pos;
+};
+
+// optimiser state (see c_optimise.c)
+struct optimise_state_struct
+{
+ int ic_length;
+ unsigned char exit_point_target [EXPOINTS]; // TARGET_ bits for each exit point that something jumps to
+ int exit_point_pos [EXPOINTS] [2]; // intercode position of each exit point's true [0] and false [1] point (-1 if not found)
+ int b_search_left;
+};
+
+// The compiler's working state. Everything the compiler changes while compiling is in here (or in the template that cstate->templ
+//  points to), and each of the compiler's functions is passed the cstate it works on.
+// So more than one compilation can run at once, each with its own cstate (see compile_templates() in c_compile.c).
 struct cstatestruct
 {
  int compile_mode; // a COMPILER_MODE enum
+ int optimise; // if 1, the intercode is optimised before bcode is generated (see c_optimise.c)
 
  int src_line; // source line of current position - remember that this must be passed through source_edit->line_index to find the entry in the source_edit->text array!
  int src_pos; // position in that line
@@ -326,6 +400,39 @@ struct cstatestruct
  struct bcode_struct* target_bcode;
 
  struct expointstruct expoint [EXPOINTS];
+
+// identifiers:
+// The fixed keywords at the start of the list are copied from the identifier array in c_keywords.c by init_compiler().
+//  User identifiers are added after them as they are found in the source.
+ struct identifierstruct identifier [IDENTIFIERS];
+ int identifier_hash [IDENTIFIER_HASH_SIZE];
+ int identifier_hash_end; // index of the first unused identifier (which terminates the list)
+
+// state of the other parts of the compiler:
+ struct prstate_struct prstate;
+ struct fstatestruct fstate;
+ struct procdef_struct procdef;
+ struct optimise_state_struct ostate;
+
+// The compiler doesn't write to the main log directly, as it may not be running in the main thread.
+// Lines written here are copied to the log by flush_log_buffer() (in e_log.c) when the compilation is finished.
+ struct log_buffer_struct* log;
+ int compile_log_start; // number of lines that had been written to log when compile_scode() started (see c_cache.c)
+
+ unsigned long long cache_key; // key of the scode (set by load_compile_cache() in c_cache.c)
+};
+
+// Everything needed for a single compilation.
+// It's allocated by open_compiler_context() (in c_init.c) when compilation starts and freed by close_compiler_context() when it
+//  finishes, so it only takes up memory while something is being compiled.
+struct compiler_context_struct
+{
+ struct cstatestruct cstate;
+ struct template_struct compiled_template; // the compiler writes the new template here (cstate.templ points to it), then compile() copies it into the target template
+ struct source_edit_struct* source_edit;
+ int compiler_mode;
+ int result; // 1 if the part of the compilation that can run outside the main thread succeeded (see compile_templates() in c_compile.c)
+ int save_to_cache; // 1 if the result was compiled (rather than loaded from the compile cache) and should be saved in the cache
 };
 
 #define BCODE_POS_MIN 8
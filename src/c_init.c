@@ -4,6 +4,7 @@
 #include "c_header.h"
 
 #include "g_misc.h"
+#include "m_globvars.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -17,9 +18,49 @@
 #include "i_console.h"
 #include "c_prepr.h"
 #include "c_keywords.h"
+#include "c_lexer.h"
+#include "c_optimise.h"
 
-extern struct cstatestruct cstate;
 extern struct identifierstruct identifier [IDENTIFIERS];
+
+// Allocates the compiler's working state (see compiler_context_struct in c_header.h).
+// Anything that runs the compiler (or any of the compiler's functions that take a cstate) needs to call this first, then call
+//  close_compiler_context() when finished.
+// Should be called from the main thread. The context can then be used by any one thread at a time.
+// Returns the new context, or NULL on failure (after writing an error to the log).
+struct compiler_context_struct* open_compiler_context(void)
+{
+
+ struct compiler_context_struct* ccontext = calloc(1, sizeof(struct compiler_context_struct));
+
+ if (ccontext != NULL)
+		ccontext->cstate.log = calloc(1, sizeof(struct log_buffer_struct));
+
+ if (ccontext == NULL
+		|| ccontext->cstate.log == NULL)
+	{
+		free(ccontext);
+  write_line_to_log("Error: not enough memory to run the compiler.", MLOG_COL_ERROR);
+  return NULL;
+	}
+
+ clear_log_buffer(ccontext->cstate.log);
+
+ return ccontext;
+
+}
+
+// copies anything left in the context's log buffer to the log, then frees the context
+// call from the main thread
+void close_compiler_context(struct compiler_context_struct* ccontext)
+{
+
+ flush_log_buffer(ccontext->cstate.log);
+
+ free(ccontext->cstate.log);
+ free(ccontext);
+
+}
 /*
 // call this once
 void init_compiler_at_startup(void)
@@ -30,49 +71,55 @@ void init_compiler_at_startup(void)
 
 // call this each time the compiler is needed
 // this function should not change templ at all (just refer to it)
-int init_compiler(struct template_struct* templ, int compiler_mode)
+int init_compiler(struct cstatestruct* cstate, struct template_struct* templ, int compiler_mode)
 {
 
  int i;
 
- cstate.src_line = 0;
- cstate.src_pos = 0;
- cstate.scode_pos = 0;
- cstate.expoint_pos = 0;
- cstate.error = 0;
- cstate.recursion_level = 0;
- cstate.just_returned = 0;
- cstate.reached_end_of_source = 0;
- cstate.recursion_level = 0;
- cstate.target_bcode = &templ->bcode;
+ cstate->src_line = 0;
+ cstate->src_pos = 0;
+ cstate->scode_pos = 0;
+ cstate->expoint_pos = 0;
+ cstate->error = 0;
+ cstate->recursion_level = 0;
+ cstate->just_returned = 0;
+ cstate->reached_end_of_source = 0;
+ cstate->recursion_level = 0;
+ cstate->target_bcode = &templ->bcode;
 
- cstate.mem_pos = 0;
+ cstate->mem_pos = 0;
 
- cstate.compile_mode = compiler_mode;
+ cstate->compile_mode = compiler_mode;
+ cstate->optimise = optimise_compile_mode(compiler_mode);
 
- cstate.templ = templ;
+ cstate->templ = templ;
 
 
- cstate.scode.text [0] = '\0';
- cstate.scode.text_length = 0;
+ cstate->scode.text [0] = '\0';
+ cstate->scode.text_length = 0;
 
-	identifier[USER_IDENTIFIERS].type = CTOKEN_TYPE_NONE; // terminates the identifier list just after the end of the list of fixed compiler keywords
+// the fixed compiler keywords (from c_keywords.c) aren't changed by compilation, so each cstate gets its own copy of them:
+ memcpy(cstate->identifier, identifier, sizeof(struct identifierstruct) * USER_IDENTIFIERS);
+
+	cstate->identifier[USER_IDENTIFIERS].type = CTOKEN_TYPE_NONE; // terminates the identifier list just after the end of the list of fixed compiler keywords
 
 	for (i = USER_IDENTIFIERS; i < IDENTIFIERS; i ++)
 	{
-		identifier[i].type = CTOKEN_TYPE_NONE;
-		identifier[i].address = -1;
-		identifier[i].value = 0;
+		cstate->identifier[i].type = CTOKEN_TYPE_NONE;
+		cstate->identifier[i].address = -1;
+		cstate->identifier[i].value = 0;
 	}
 
+	reset_identifier_hash(cstate);
+
 // intercode:
- cstate.ic_pos = 0;
+ cstate->ic_pos = 0;
 // + think about initialising intercode array (shouldn't really be needed if ic_pos is used properly)
 
  for (i = 0; i < EXPOINTS; i ++)
 	{
-		cstate.expoint[i].true_point_used = 0;
-		cstate.expoint[i].false_point_used = 0;
+		cstate->expoint[i].true_point_used = 0;
+		cstate->expoint[i].false_point_used = 0;
 	}
 
 
@@ -2,7 +2,9 @@
 #ifndef H_C_INIT
 #define H_C_INIT
 
-int init_compiler(struct template_struct* templ, int compiler_mode);
+struct compiler_context_struct* open_compiler_context(void);
+void close_compiler_context(struct compiler_context_struct* ccontext);
+int init_compiler(struct cstatestruct* cstate, struct template_struct* templ, int compiler_mode);
 
 #endif
 
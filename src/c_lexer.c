@@ -12,6 +12,7 @@
 #include <stdlib.h>
 
 #include "c_lexer.h"
+#include "c_keywords.h"
 
 
 enum
@@ -26,21 +27,27 @@ INITIAL_CTOKEN_TYPE_IDENTIFIER,
 INITIAL_CTOKEN_TYPE_INVALID
 };
 
-int c_get_next_char_from_scode(void);
+int c_get_next_char_from_scode(struct cstatestruct* cstate);
 int determine_initial_ctoken_type(struct ctokenstruct* ctoken, char read_source);
-int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char);
+int get_ctoken_one_or_two_char(struct cstatestruct* cstate, struct ctokenstruct* ctoken, char read_char);
 int parse_ctoken(struct ctokenstruct* ctoken, int parse_type);
 
-int get_ctoken_number(struct ctokenstruct* ctoken);
-int get_ctoken_number_zero(struct ctokenstruct* ctoken);
-int skip_spaces(void);
+int get_ctoken_number(struct cstatestruct* cstate, struct ctokenstruct* ctoken);
+int get_ctoken_number_zero(struct cstatestruct* cstate, struct ctokenstruct* ctoken);
+int skip_spaces(struct cstatestruct* cstate);
 void print_identifier_list(void);
-int read_identifier(struct ctokenstruct* ctoken, char read_char);
+int read_identifier(struct cstatestruct* cstate, struct ctokenstruct* ctoken, char read_char);
 
 //extern struct scodestruct *scode;
-extern struct cstatestruct cstate;
 extern struct identifierstruct identifier [IDENTIFIERS]; // defined in c_keywords.c
 
+// read_identifier() finds identifiers by name through cstate->identifier_hash (see IDENTIFIER_HASH_SIZE in c_header.h)
+static int keyword_hash [IDENTIFIER_HASH_SIZE]; // hash of just the fixed keywords, copied into cstate->identifier_hash by reset_identifier_hash()
+static int keyword_hash_ready = 0;
+
+static unsigned int hash_identifier_name(const char* name);
+static int find_identifier_hash_slot(int* hash_table, struct identifierstruct* id_list, const char* name);
+
 
 // This function is called by the compiler. It reads the next ctoken from the scode.
 // It starts by determining the basic type of the token from the first character.
@@ -53,44 +60,44 @@ extern struct identifierstruct identifier [IDENTIFIERS]; // defined in c_keyword
 // returns 1 if it finishes reading the ctoken without finding an error.
 // returns 0 on error (including if it finds the end of scode - this shouldn't happen while reading a token).
 // Don't call this to read the contents of a string
-int read_next(struct ctokenstruct* ctoken)
+int read_next(struct cstatestruct* cstate, struct ctokenstruct* ctoken)
 {
 
- cstate.recursion_level ++;
+ cstate->recursion_level ++;
 
- if (cstate.recursion_level > RECURSION_LIMIT)
-  return comp_error(CERR_RECURSION_LIMIT_REACHED, NULL);
+ if (cstate->recursion_level > RECURSION_LIMIT)
+  return comp_error(cstate, CERR_RECURSION_LIMIT_REACHED, NULL);
 
  int return_value = 1;
 
  strcpy(ctoken->name, "(empty)");
 
- if (cstate.error != CERR_NONE)
+ if (cstate->error != CERR_NONE)
   return 0;
 
- if (cstate.scode_pos < -1 || cstate.scode_pos >= SCODE_LENGTH)
-  return comp_error(CERR_PARSER_SCODE_BOUNDS, ctoken);
+ if (cstate->scode_pos < -1 || cstate->scode_pos >= SCODE_LENGTH)
+  return comp_error(cstate, CERR_PARSER_SCODE_BOUNDS, ctoken);
 
 // int tp;
  int read_source;
 
 // first we skip any spaces:
- int skipped = skip_spaces();
+ int skipped = skip_spaces(cstate);
 
  if (skipped == 0)
 	{
-		cstate.reached_end_of_source = 1;
+		cstate->reached_end_of_source = 1;
   return 0; // reached end of scode
 	}
 
- cstate.src_line = cstate.scode.src_line [cstate.scode_pos];
+ cstate->src_line = cstate->scode.src_line [cstate->scode_pos];
 
 // now we read the first character to work out what kind of ctoken we have here:
 
- read_source = c_get_next_char_from_scode();
+ read_source = c_get_next_char_from_scode(cstate);
  if (read_source == REACHED_END_OF_SCODE)
 	{
-		cstate.reached_end_of_source = 1;
+		cstate->reached_end_of_source = 1;
   return 0; // reached end of source
 	}
 
@@ -111,36 +118,36 @@ int read_next(struct ctokenstruct* ctoken)
    return_value = 1;
    goto parse_ctoken_success;
   case INITIAL_CTOKEN_TYPE_ONE_OR_TWO_CHAR:
-   if (!get_ctoken_one_or_two_char(ctoken, read_char)) // This function can fail (as reading the second character could reach the end of scode, which will be an error)
-    return comp_error(CERR_PARSER_SCODE_BOUNDS, ctoken);
+   if (!get_ctoken_one_or_two_char(cstate, ctoken, read_char)) // This function can fail (as reading the second character could reach the end of scode, which will be an error)
+    return comp_error(cstate, CERR_PARSER_SCODE_BOUNDS, ctoken);
 //   fprintf(stdout, "\nCtoken: single or double character");
    // if it doesn't fail, the ctokenstruct will have been filled in.
    return_value = 1;
    goto parse_ctoken_success;
   case INITIAL_CTOKEN_TYPE_NUMBER:
-   cstate.scode_pos --;
-   if (!get_ctoken_number(ctoken))
+   cstate->scode_pos --;
+   if (!get_ctoken_number(cstate, ctoken))
     return 0;
 //    fprintf(stdout, "\nCtoken: %i (single number)", ctoken->number_value);
    return_value = 1;
    goto parse_ctoken_success;
   case INITIAL_CTOKEN_TYPE_ZERO:
-   cstate.scode_pos --;
+   cstate->scode_pos --;
 // any changes here may need to be reflected in the enum-reading code below in case INITIAL_CTOKEN_TYPE_IDENTIFIER
-   if (!get_ctoken_number_zero(ctoken))
+   if (!get_ctoken_number_zero(cstate, ctoken))
     return 0;
 //    fprintf(stdout, "\nCtoken: %i (single number)", ctoken->number_value);
    return_value = 1;
    goto parse_ctoken_success;
 // if it doesn't fail, the ctokenstruct will have been filled in.
   case INITIAL_CTOKEN_TYPE_IDENTIFIER:
-   ctoken->identifier_index = read_identifier(ctoken, read_char);
+   ctoken->identifier_index = read_identifier(cstate, ctoken, read_char);
    if (ctoken->identifier_index == -1) // This function can fail (as reading further characters could reach the end of scode, which will be an error)
-    return comp_error(CERR_PARSER_REACHED_END_WHILE_READING, ctoken);
+    return comp_error(cstate, CERR_PARSER_REACHED_END_WHILE_READING, ctoken);
 // if it's an enum, it's converted into a number. The code here should correspond to the code for number ctokens above
    if (ctoken->type == CTOKEN_TYPE_ENUM)
    {
-    ctoken->number_value = identifier[ctoken->identifier_index].value;
+    ctoken->number_value = cstate->identifier[ctoken->identifier_index].value;
     ctoken->type = CTOKEN_TYPE_NUMBER;
    }
    return_value = 1;
@@ -149,20 +156,20 @@ int read_next(struct ctokenstruct* ctoken)
 
  } // end switch(initial_ctoken_type)
 
- return comp_error(CERR_PARSER_UNKNOWN_TOKEN_TYPE, ctoken);
+ return comp_error(cstate, CERR_PARSER_UNKNOWN_TOKEN_TYPE, ctoken);
 
 parse_ctoken_success:
 
- cstate.recursion_level --;
+ cstate->recursion_level --;
  return return_value;
 
 }
 
 
 // This function will be changed to verify the range of the angle somehow
-int expect_angle(struct ctokenstruct* ctoken)
+int expect_angle(struct cstatestruct* cstate, struct ctokenstruct* ctoken)
 {
-	if (!expect_constant(ctoken))
+	if (!expect_constant(cstate, ctoken))
 		return 0;
 // Note: can't & ANGLE_MASK because this may be a negative angle offset
 	return 1;
@@ -171,17 +178,17 @@ int expect_angle(struct ctokenstruct* ctoken)
 // reads a constant and leaves its value in ctoken->number_value.
 //  does not currently perform constant folding! sorry
 // returns 1 on success, 0 on failure (no constant found means failure)
-int expect_constant(struct ctokenstruct* ctoken)
+int expect_constant(struct cstatestruct* cstate, struct ctokenstruct* ctoken)
 {
 	int sign = 1;
-	if (!read_next(ctoken))
+	if (!read_next(cstate, ctoken))
 		return 0;
 // check for negative number
  if (ctoken->type == CTOKEN_TYPE_OPERATOR_ARITHMETIC
 		&& ctoken->subtype == CTOKEN_SUBTYPE_MINUS)
 	{
 		sign = -1;
-		if (!read_next(ctoken))
+		if (!read_next(cstate, ctoken))
 			return 0;
 	}
 // now ctoken must be a number
@@ -198,22 +205,22 @@ int expect_constant(struct ctokenstruct* ctoken)
 // leaves src_pos with a new value (which may be at end of the scode struct)
 // assumes scode text array is null-terminated.
 // can be called directly from c_compile.c (e.g. in reading a string)
-int c_get_next_char_from_scode(void)
+int c_get_next_char_from_scode(struct cstatestruct* cstate)
 {
 
- cstate.scode_pos ++;
+ cstate->scode_pos ++;
 
- if (cstate.scode.text [cstate.scode_pos] == '\0') // reached end
+ if (cstate->scode.text [cstate->scode_pos] == '\0') // reached end
 	{
   return REACHED_END_OF_SCODE;
 	}
 /*
  char tstr[2];
- tstr[0] = cstate.scode.text [cstate.scode_pos];
+ tstr[0] = cstate->scode.text [cstate->scode_pos];
  tstr[1] = 0;
  fprintf(stdout, "%s", tstr);*/
 
- return cstate.scode.text [cstate.scode_pos];
+ return cstate->scode.text [cstate->scode_pos];
 
 }
 
@@ -301,10 +308,10 @@ int determine_initial_ctoken_type(struct ctokenstruct* ctoken, char read_source)
 This function is called if a character that could be a one- or two-character token is found.
 Returns 1 on success (read a token) or 0 on error (which I guess can only happen if the end of scode is reached)
 */
-int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
+int get_ctoken_one_or_two_char(struct cstatestruct* cstate, struct ctokenstruct* ctoken, char read_char)
 {
 
- int read_source2 = c_get_next_char_from_scode();
+ int read_source2 = c_get_next_char_from_scode(cstate);
  if (read_source2 == REACHED_END_OF_SCODE)
   return 0; // reached end of scode (error)
 
@@ -323,7 +330,7 @@ int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
      ctoken->subtype = CTOKEN_SUBTYPE_INCREMENT; return 1;
    }
    ctoken->subtype = CTOKEN_SUBTYPE_PLUS;
-   cstate.scode_pos--;
+   cstate->scode_pos--;
    return 1;
   case '-': // - -= ->
    switch(read_char2)
@@ -335,7 +342,7 @@ int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
    }
 // need to deal with the possibility that this is a negative number!
    ctoken->subtype = CTOKEN_SUBTYPE_MINUS;
-   cstate.scode_pos--;
+   cstate->scode_pos--;
    return 1;
   case '*': // could be * *= *(pointer)
    switch(read_char2)
@@ -344,7 +351,7 @@ int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
      ctoken->subtype = CTOKEN_SUBTYPE_MULEQ; return 1;
    }
    ctoken->subtype = CTOKEN_SUBTYPE_MUL;
-   cstate.scode_pos--;
+   cstate->scode_pos--;
    return 1;
   case '/': // / /=
    switch(read_char2)
@@ -353,7 +360,7 @@ int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
      ctoken->subtype = CTOKEN_SUBTYPE_DIVEQ; return 1;
    }
    ctoken->subtype = CTOKEN_SUBTYPE_DIV;
-   cstate.scode_pos--;
+   cstate->scode_pos--;
    return 1;
   case '=': // = ==
    switch(read_char2)
@@ -363,7 +370,7 @@ int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
    }
    ctoken->type = CTOKEN_TYPE_OPERATOR_ASSIGN;
    ctoken->subtype = CTOKEN_SUBTYPE_EQ;
-   cstate.scode_pos--;
+   cstate->scode_pos--;
    return 1;
   case '<': // < <= <<
    switch(read_char2)
@@ -374,7 +381,7 @@ int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
    }
    ctoken->type = CTOKEN_TYPE_OPERATOR_COMPARISON;
    ctoken->subtype = CTOKEN_SUBTYPE_LESS;
-   cstate.scode_pos--;
+   cstate->scode_pos--;
    return 1;
   case '>': // > >= >>
    switch(read_char2)
@@ -385,7 +392,7 @@ int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
    }
    ctoken->type = CTOKEN_TYPE_OPERATOR_COMPARISON;
    ctoken->subtype = CTOKEN_SUBTYPE_GR;
-   cstate.scode_pos--;
+   cstate->scode_pos--;
    return 1;
   case '&': // & &= &&
    switch(read_char2)
@@ -396,7 +403,7 @@ int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
      ctoken->subtype = CTOKEN_SUBTYPE_LOGICAL_AND; return 1;
    }
    ctoken->subtype = CTOKEN_SUBTYPE_BITWISE_AND;
-   cstate.scode_pos--;
+   cstate->scode_pos--;
    return 1;
   case '|': // | |= ||
    switch(read_char2)
@@ -407,7 +414,7 @@ int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
      ctoken->subtype = CTOKEN_SUBTYPE_LOGICAL_OR; return 1;
    }
    ctoken->subtype = CTOKEN_SUBTYPE_BITWISE_OR;
-   cstate.scode_pos--;
+   cstate->scode_pos--;
    return 1;
   case '^': // ^ ^=
    switch(read_char2)
@@ -416,7 +423,7 @@ int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
      ctoken->subtype = CTOKEN_SUBTYPE_BITWISE_XOR_EQ; return 1;
    }
    ctoken->subtype = CTOKEN_SUBTYPE_BITWISE_XOR;
-   cstate.scode_pos--;
+   cstate->scode_pos--;
    return 1;
   case '~': // ~ ~=
    switch(read_char2)
@@ -425,7 +432,7 @@ int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
      ctoken->subtype = CTOKEN_SUBTYPE_BITWISE_NOT_EQ; return 1;
    }
    ctoken->subtype = CTOKEN_SUBTYPE_BITWISE_NOT;
-   cstate.scode_pos--;
+   cstate->scode_pos--;
    return 1;
   case '%': // % %=
    switch(read_char2)
@@ -434,7 +441,7 @@ int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
      ctoken->subtype = CTOKEN_SUBTYPE_MODEQ; return 1;
    }
    ctoken->subtype = CTOKEN_SUBTYPE_MOD;
-   cstate.scode_pos--;
+   cstate->scode_pos--;
    return 1;
   case '!': // ! !=
    switch(read_char2)
@@ -443,7 +450,7 @@ int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
      ctoken->subtype = CTOKEN_SUBTYPE_COMPARE_NOT; return 1;
    }
    ctoken->subtype = CTOKEN_SUBTYPE_NOT;
-   cstate.scode_pos--;
+   cstate->scode_pos--;
    return 1;
 
 
@@ -455,7 +462,7 @@ int get_ctoken_one_or_two_char(struct ctokenstruct* ctoken, char read_char)
 
 // Assumes that scode_pos is set so that the next char read will be the first char of a number (could be the only char of the number).
 // assumes that if the number is negative and starts with -, the - has already been read (see read_number_value())
-int get_ctoken_number(struct ctokenstruct* ctoken)
+int get_ctoken_number(struct cstatestruct* cstate, struct ctokenstruct* ctoken)
 {
 
  int number [10] = {0,0,0,0,0,0,0,0,0,0};
@@ -467,16 +474,16 @@ int get_ctoken_number(struct ctokenstruct* ctoken)
 
  do
  {
-  read_source2 = c_get_next_char_from_scode();
+  read_source2 = c_get_next_char_from_scode(cstate);
   if (read_source2 == REACHED_END_OF_SCODE)
-   return comp_error(CERR_PARSER_REACHED_END_WHILE_READING, ctoken);
+   return comp_error(cstate, CERR_PARSER_REACHED_END_WHILE_READING, ctoken);
 
   read_char = (char) read_source2;
 
   if (read_char >= '0' && read_char <= '9')
   {
    if (i > 5) // maximum length of 16-bit int as a decimal string
-    return comp_error(CERR_PARSER_NUMBER_TOO_LARGE, ctoken);
+    return comp_error(cstate, CERR_PARSER_NUMBER_TOO_LARGE, ctoken);
    number [i] = read_char - '0';
    i ++;
    continue;
@@ -485,10 +492,10 @@ int get_ctoken_number(struct ctokenstruct* ctoken)
   if ((read_char >= 'a' && read_char <= 'z')
    || (read_char >= 'A' && read_char <= 'Z')
    || read_char == '_')
-    return comp_error(CERR_PARSER_LETTER_IN_NUMBER, ctoken);
+    return comp_error(cstate, CERR_PARSER_LETTER_IN_NUMBER, ctoken);
 
 // if it's not a number or a letter, it's probably a space or an operator. So we stop reading the number, decrement *scode_pos and let whatever's been found be dealt with as the next ctoken:
-  cstate.scode_pos --;
+  cstate->scode_pos --;
   break;
 
  } while (TRUE);
@@ -506,7 +513,7 @@ int get_ctoken_number(struct ctokenstruct* ctoken)
 
  if (ctoken_value > BCODE_VALUE_MAXIMUM
   || ctoken_value < BCODE_VALUE_MINIMUM)
-   return comp_error(CERR_PARSER_NUMBER_TOO_LARGE, ctoken);
+   return comp_error(cstate, CERR_PARSER_NUMBER_TOO_LARGE, ctoken);
 
  ctoken->type = CTOKEN_TYPE_NUMBER;
  ctoken->number_value = ctoken_value;
@@ -523,7 +530,7 @@ int get_ctoken_number(struct ctokenstruct* ctoken)
 
 // Like get_ctoken_number, but is called when first digit of a number is 0.
 // This can mean it's just a zero, or that it's a hex number in 0x form.
-int get_ctoken_number_zero(struct ctokenstruct* ctoken)
+int get_ctoken_number_zero(struct cstatestruct* cstate, struct ctokenstruct* ctoken)
 {
 
  int number [NUMBER_STRING_SIZE];
@@ -542,9 +549,9 @@ int get_ctoken_number_zero(struct ctokenstruct* ctoken)
  i = 0;
 
 // read the zero again:
- read_source2 = c_get_next_char_from_scode();
+ read_source2 = c_get_next_char_from_scode(cstate);
  if (read_source2 == REACHED_END_OF_SCODE)
-  return comp_error(CERR_PARSER_REACHED_END_WHILE_READING, ctoken);
+  return comp_error(cstate, CERR_PARSER_REACHED_END_WHILE_READING, ctoken);
 
 // fprintf(stdout, "\nget_ctoken_number_zero");
 
@@ -554,14 +561,14 @@ int get_ctoken_number_zero(struct ctokenstruct* ctoken)
 //  - the next character is also a digit, so this is an error (decimal numbers shouldn't start with 0, and octal numbers are not supported)
 //  - any other case - the number is just zero.
 
- read_source2 = c_get_next_char_from_scode();
+ read_source2 = c_get_next_char_from_scode(cstate);
  if (read_source2 == REACHED_END_OF_SCODE)
-  return comp_error(CERR_PARSER_REACHED_END_WHILE_READING, ctoken);
+  return comp_error(cstate, CERR_PARSER_REACHED_END_WHILE_READING, ctoken);
 
  read_char = (char) read_source2;
 
  if (read_char >= '0' && read_char <= '9')
-  return comp_error(CERR_PARSER_NUMBER_STARTS_WITH_ZERO, ctoken);
+  return comp_error(cstate, CERR_PARSER_NUMBER_STARTS_WITH_ZERO, ctoken);
 
 
 // May be a number in 0x hex form:
@@ -570,16 +577,16 @@ int get_ctoken_number_zero(struct ctokenstruct* ctoken)
  {
   do
   {
-   read_source2 = c_get_next_char_from_scode();
+   read_source2 = c_get_next_char_from_scode(cstate);
    if (read_source2 == REACHED_END_OF_SCODE)
-    return comp_error(CERR_PARSER_REACHED_END_WHILE_READING, ctoken);
+    return comp_error(cstate, CERR_PARSER_REACHED_END_WHILE_READING, ctoken);
 
    read_char = (char) read_source2;
 
    if (read_char >= '0' && read_char <= '9')
    {
     if (i > 4) // maximum length of 16-bit int as a hex string
-     return comp_error(CERR_PARSER_NUMBER_TOO_LARGE, ctoken);
+     return comp_error(cstate, CERR_PARSER_NUMBER_TOO_LARGE, ctoken);
     number [i] = read_char - '0';
     i ++;
     continue;
@@ -588,7 +595,7 @@ int get_ctoken_number_zero(struct ctokenstruct* ctoken)
    if (read_char >= 'a' && read_char <= 'f')
    {
     if (i > 4) // maximum length of 16-bit int as a hex string
-     return comp_error(CERR_PARSER_NUMBER_TOO_LARGE, ctoken);
+     return comp_error(cstate, CERR_PARSER_NUMBER_TOO_LARGE, ctoken);
     number [i] = read_char - 'a' + 10;
     i ++;
     continue;
@@ -597,7 +604,7 @@ int get_ctoken_number_zero(struct ctokenstruct* ctoken)
    if (read_char >= 'A' && read_char <= 'F')
    {
     if (i > 4) // maximum length of 16-bit int as a hex string
-     return comp_error(CERR_PARSER_NUMBER_TOO_LARGE, ctoken);
+     return comp_error(cstate, CERR_PARSER_NUMBER_TOO_LARGE, ctoken);
     number [i] = read_char - 'A' + 10;
     i ++;
     continue;
@@ -606,10 +613,10 @@ int get_ctoken_number_zero(struct ctokenstruct* ctoken)
    if ((read_char > 'f' && read_char <= 'z')
     || (read_char > 'F' && read_char <= 'Z')
     || read_char == '_')
-     return comp_error(CERR_PARSER_LETTER_IN_HEX_NUMBER, ctoken);
+     return comp_error(cstate, CERR_PARSER_LETTER_IN_HEX_NUMBER, ctoken);
 
 // if it's not a number or a letter, it's probably a space or an operator. So we stop reading the number, decrement scode_pos and let whatever's been found be dealt with as the next ctoken:
-   cstate.scode_pos --;
+   cstate->scode_pos --;
    break;
 
   } while (TRUE);
@@ -651,31 +658,31 @@ int get_ctoken_number_zero(struct ctokenstruct* ctoken)
 
   do
   {
-   read_source2 = c_get_next_char_from_scode();
+   read_source2 = c_get_next_char_from_scode(cstate);
    if (read_source2 == REACHED_END_OF_SCODE)
-    return comp_error(CERR_PARSER_REACHED_END_WHILE_READING, ctoken);
+    return comp_error(cstate, CERR_PARSER_REACHED_END_WHILE_READING, ctoken);
 
    read_char = (char) read_source2;
 
    if (read_char == '0' || read_char == '1')
    {
     if (i > 15) // maximum length of 16-bit int
-     return comp_error(CERR_PARSER_NUMBER_TOO_LARGE, ctoken);
+     return comp_error(cstate, CERR_PARSER_NUMBER_TOO_LARGE, ctoken);
     number [i] = read_char - '0';
     i ++;
     continue;
    }
 
    if (read_char >= '2' && read_char <= '9')
-     return comp_error(CERR_INVALID_NUMBER_IN_BINARY_NUMBER, ctoken);
+     return comp_error(cstate, CERR_INVALID_NUMBER_IN_BINARY_NUMBER, ctoken);
 
    if ((read_char >= 'a' && read_char <= 'z')
     || (read_char >= 'A' && read_char <= 'Z')
     || read_char == '_')
-     return comp_error(CERR_PARSER_LETTER_IN_BINARY_NUMBER, ctoken);
+     return comp_error(cstate, CERR_PARSER_LETTER_IN_BINARY_NUMBER, ctoken);
 
 // if it's not a number or a letter, it's probably a space or an operator. So we stop reading the number, decrement *scode_pos and let whatever's been found be dealt with as the next ctoken:
-   cstate.scode_pos --;
+   cstate->scode_pos --;
    break;
 
   } while (TRUE);
@@ -694,7 +701,7 @@ int get_ctoken_number_zero(struct ctokenstruct* ctoken)
 
   if (ctoken_value > BCODE_VALUE_MAXIMUM
    || ctoken_value < BCODE_VALUE_MINIMUM)
-    return comp_error(CERR_PARSER_NUMBER_TOO_LARGE, ctoken);
+    return comp_error(cstate, CERR_PARSER_NUMBER_TOO_LARGE, ctoken);
 
   ctoken->type = CTOKEN_TYPE_NUMBER;
   ctoken->number_value = ctoken_value;
@@ -708,7 +715,7 @@ int get_ctoken_number_zero(struct ctokenstruct* ctoken)
 // number was just a zero followed by something else, so we set up a zero number ctoken and return.
   ctoken->type = CTOKEN_TYPE_NUMBER;
   ctoken->number_value = 0;
-  cstate.scode_pos --;
+  cstate->scode_pos --;
   return 1;
 
 }
@@ -719,7 +726,7 @@ Returns index of identifier on success
 read_char is the first character of the token (this function starts from the second)
 Returns -1 on failure
 */
-int read_identifier(struct ctokenstruct* ctoken, char read_char)
+int read_identifier(struct cstatestruct* cstate, struct ctokenstruct* ctoken, char read_char)
 {
 
  int i;
@@ -736,7 +743,7 @@ int read_identifier(struct ctokenstruct* ctoken, char read_char)
 
  do
  {
-  read_source2 = c_get_next_char_from_scode();
+  read_source2 = c_get_next_char_from_scode(cstate);
   if (read_source2 == REACHED_END_OF_SCODE)
    return -1; // reached end of scode (error)
 
@@ -749,7 +756,7 @@ int read_identifier(struct ctokenstruct* ctoken, char read_char)
   {
    i ++;
    if (i >= IDENTIFIER_MAX_LENGTH)
-    return comp_error_minus1(CERR_PARSER_TOKEN_TOO_LONG, ctoken);
+    return comp_error_minus1(cstate, CERR_PARSER_TOKEN_TOO_LONG, ctoken);
    ctoken->name [i] = read_char2;
    ctoken->name [i + 1] = '\0';
    continue;
@@ -761,35 +768,37 @@ int read_identifier(struct ctokenstruct* ctoken, char read_char)
 //  }
 
 // if it's not a number or a letter, it's probably a space or an operator. So we stop reading the number and let whatever's been found be dealt with as the next ctoken:
-  cstate.scode_pos --;
+  cstate->scode_pos --;
   break;
 
  } while (TRUE);
 
- for (i = 0; i < IDENTIFIERS; i ++)
- {
-  if (identifier[i].type == CTOKEN_TYPE_NONE)
-   break;
+ int hash_slot = find_identifier_hash_slot(cstate->identifier_hash, cstate->identifier, ctoken->name);
 
-  if (strcmp(ctoken->name, identifier[i].name) == 0) // match found!
-  {
-			ctoken->type = identifier[i].type;
-   return i; // ctoken->identifier_index is set to this return value
-  }
+ if (cstate->identifier_hash [hash_slot] != -1) // match found!
+ {
+		i = cstate->identifier_hash [hash_slot];
+		ctoken->type = cstate->identifier[i].type;
+  return i; // ctoken->identifier_index is set to this return value
  }
 
+ i = cstate->identifier_hash_end;
+
  if (i >= IDENTIFIERS - 1)
-  return comp_error(CERR_PARSER_TOO_MANY_IDENTIFIERS, ctoken);
+  return comp_error(cstate, CERR_PARSER_TOO_MANY_IDENTIFIERS, ctoken);
 
 // create a new untyped identifier:
 
- strcpy(identifier[i].name, ctoken->name);
- identifier[i].type = CTOKEN_TYPE_IDENTIFIER_NEW;
- identifier[i].value = 0;
- identifier[i].address = -1; // indicates undefined (for identifiers with addresses)
+ cstate->identifier_hash [hash_slot] = i;
+ cstate->identifier_hash_end = i + 1;
+
+ strcpy(cstate->identifier[i].name, ctoken->name);
+ cstate->identifier[i].type = CTOKEN_TYPE_IDENTIFIER_NEW;
+ cstate->identifier[i].value = 0;
+ cstate->identifier[i].address = -1; // indicates undefined (for identifiers with addresses)
 
 // terminate the identifier list
- identifier[i+1].type = CTOKEN_TYPE_NONE;
+ cstate->identifier[i+1].type = CTOKEN_TYPE_NONE;
 
  ctoken->type = CTOKEN_TYPE_IDENTIFIER_NEW;
  ctoken->identifier_index = i;
@@ -801,22 +810,92 @@ int read_identifier(struct ctokenstruct* ctoken, char read_char)
 
 }
 
+// Works out the hash table of the fixed keywords (in the identifier array in c_keywords.c). Only does anything the first time it's called.
+// reset_identifier_hash() calls this, but it must also be called before compilers are started in other threads (see compile_templates() in c_compile.c).
+void init_keyword_hash(void)
+{
+
+ int i;
+
+ if (keyword_hash_ready)
+		return;
+
+	for (i = 0; i < IDENTIFIER_HASH_SIZE; i ++)
+	{
+		keyword_hash [i] = -1;
+	}
+// if two keywords had the same name, read_identifier() used to find the first one. So keep the first one here as well:
+	for (i = 0; i < USER_IDENTIFIERS; i ++)
+	{
+		int hash_slot = find_identifier_hash_slot(keyword_hash, identifier, identifier[i].name);
+		if (keyword_hash [hash_slot] == -1)
+			keyword_hash [hash_slot] = i;
+	}
+	keyword_hash_ready = 1;
+
+}
+
+// Call each time the user identifiers are cleared (in init_compiler()). Resets the identifier hash table so that it contains only the fixed keywords.
+void reset_identifier_hash(struct cstatestruct* cstate)
+{
+
+ init_keyword_hash();
+
+ memcpy(cstate->identifier_hash, keyword_hash, sizeof(cstate->identifier_hash));
+ cstate->identifier_hash_end = USER_IDENTIFIERS;
+
+}
+
+// FNV-1a hash of an identifier name
+static unsigned int hash_identifier_name(const char* name)
+{
+
+ unsigned int hash = 2166136261u;
+
+ while (*name != '\0')
+	{
+		hash ^= (unsigned char) *name;
+		hash *= 16777619u;
+		name ++;
+	}
+
+	return hash;
+
+}
+
+// Returns the slot in hash_table that holds the identifier called name, or the empty slot where it would go if it isn't there
+static int find_identifier_hash_slot(int* hash_table, struct identifierstruct* id_list, const char* name)
+{
+
+ int hash_slot = hash_identifier_name(name) & IDENTIFIER_HASH_MASK;
+
+ while (hash_table [hash_slot] != -1)
+	{
+		if (strcmp(name, id_list[hash_table [hash_slot]].name) == 0)
+			break;
+		hash_slot = (hash_slot + 1) & IDENTIFIER_HASH_MASK;
+	}
+
+	return hash_slot;
+
+}
+
 
 
 
 
 // this function checks whether the next ctoken is of ctoken_type. For some ctoken types, also checks against check_subtype if it isn't -1.
 // returns 1 if yes, zero if no (or if error).
-// if yes, advances cstate.scode_pos and fills in ctoken for use by calling function
-// if no, returns 0 without advancing cstate.scode_pos and without writing an error message.
+// if yes, advances cstate->scode_pos and fills in ctoken for use by calling function
+// if no, returns 0 without advancing cstate->scode_pos and without writing an error message.
 // in either case, may create a new identifier (of IDENTIFIER_NEW type)
 // if check_subtype is -1, only checks type
-int accept_next(struct ctokenstruct* ctoken, int ctoken_type, int check_subtype)
+int accept_next(struct cstatestruct* cstate, struct ctokenstruct* ctoken, int ctoken_type, int check_subtype)
 {
 
- int save_scode_pos = cstate.scode_pos;
+ int save_scode_pos = cstate->scode_pos;
 
- if (!read_next(ctoken))
+ if (!read_next(cstate, ctoken))
 		goto accept_failed;
 
 	if (ctoken->type != ctoken_type)
@@ -847,21 +926,21 @@ int accept_next(struct ctokenstruct* ctoken, int ctoken_type, int check_subtype)
 
 accept_failed:
 
- cstate.scode_pos = save_scode_pos;
+ cstate->scode_pos = save_scode_pos;
  return 0;
 
 }
 
 
 // same as accept_next but doesn't fill in a ctoken from the calling function
-int check_next(int ctoken_type, int check_subtype)
+int check_next(struct cstatestruct* cstate, int ctoken_type, int check_subtype)
 {
 
- int save_scode_pos = cstate.scode_pos;
+ int save_scode_pos = cstate->scode_pos;
 
  struct ctokenstruct ctoken;
 
- if (!read_next(&ctoken))
+ if (!read_next(cstate, &ctoken))
 		goto accept_failed;
 
 	if (ctoken.type != ctoken_type)
@@ -892,19 +971,19 @@ int check_next(int ctoken_type, int check_subtype)
 
 accept_failed:
 
- cstate.scode_pos = save_scode_pos;
+ cstate->scode_pos = save_scode_pos;
  return 0; // may not be an error
 
 }
 
 
 
-int expect_punctuation(int ctoken_subtype)
+int expect_punctuation(struct cstatestruct* cstate, int ctoken_subtype)
 {
 
  struct ctokenstruct ctoken;
 
- if (!read_next(&ctoken))
+ if (!read_next(cstate, &ctoken))
 		return 0;
 
 	if (ctoken.type != CTOKEN_TYPE_PUNCTUATION)
@@ -920,35 +999,35 @@ int expect_punctuation(int ctoken_subtype)
 
 
 // peek next looks at the next ctoken and fills in the ctoken struct, but does not advance scode_pos
-int peek_next(struct ctokenstruct* ctoken)
+int peek_next(struct cstatestruct* cstate, struct ctokenstruct* ctoken)
 {
 
- int save_scode_pos = cstate.scode_pos;
+ int save_scode_pos = cstate->scode_pos;
 
- int retval = read_next(ctoken);
+ int retval = read_next(cstate, ctoken);
 
- cstate.scode_pos = save_scode_pos;
+ cstate->scode_pos = save_scode_pos;
 
  return retval;
 
 }
 
 
-int skip_spaces(void)
+int skip_spaces(struct cstatestruct* cstate)
 {
 
  int read_source;
 
  while (TRUE)
  {
-  read_source = c_get_next_char_from_scode(); // note scode_pos is a pointer, and is incremented by get_next_char_from_scode
+  read_source = c_get_next_char_from_scode(cstate); // note scode_pos is a pointer, and is incremented by get_next_char_from_scode
   if (read_source == REACHED_END_OF_SCODE)
 		{
    return 0;
 		}
   if (read_source != ' ')
   {
-   (cstate.scode_pos) --;
+   (cstate->scode_pos) --;
    return 1;
   }
  };
@@ -0,0 +1,715 @@
+/*
+
+Intercode optimiser.
+
+Runs after the compiler (c_compile.c) has finished writing intercode and before the code generator (c_generate.c) turns it into bcode.
+It rewrites cstate->intercode in place. Jump targets (exit points and labels) are still symbolic at this stage and are only resolved
+ by the code generator, so instructions can be removed or replaced without breaking any addresses.
+
+What it does:
+ - constant folding:
+    setA_num a; pushA; setA_num b; popB; <op>   ->  setA_num (a <op> b)
+    setA_num a; lnot/mulA_num n/addA_num n      ->  setA_num (result)
+ - constant operands:
+    pushA; setA_num n; popB; add/sub_BA/mul     ->  addA_num n/addA_num -n/mulA_num n
+ - push/pop fusion:
+    pushA; setA_num/setA_mem x; popB           ->  copyAtoB; setA_num/setA_mem x
+ - constant conditions (e.g. while(1)):
+    setA_num k; iffalse/iftrue jump             ->  unconditional jump, or nothing (setA_num stays, as the code at the exit point may use A)
+ - dead jumps: a jump to an exit point that comes straight after the jump is removed
+ - unreachable code: instructions after an unconditional jump (or stop etc) are removed, up to the next point that can be jumped to
+
+Things it relies on:
+ - nothing is moved across an exit point that is jumped to, or across a label.
+ - constant folding and the constant operand rules leave B with a different value than the original code would. They are only used
+    if b_dead_after() can show that B is set again (or the program stops) before anything reads it, on every path from the instruction.
+    If it can't (e.g. because of a goto, a computed jump or a long search), the code is left alone.
+ - push/pop fusion leaves B and the stack the same as the original code. The only difference is that the original pushA would stop
+    the program with a stack error if the stack were already full.
+ - folded arithmetic is truncated to s16b, and division or modulus by zero gives 0, in the same way as in the interpreter (v_interp.c).
+
+Because each rule leaves code that other rules can match (e.g. a + 2 * 3 is folded to addA_num 6), passes are repeated until nothing changes.
+
+The optimiser is off by default, as it changes the number of instructions that a program uses. The "optimise" line in init.txt
+ turns it on for particular compile modes (see optimise_compile_mode()). The headless runner's -check_optimise option (m_headless.c)
+ plays the same games with and without it to check that optimised programs behave in the same way.
+
+*/
+
+#include <allegro5/allegro.h>
+#include "m_config.h"
+#include "g_header.h"
+#include "c_header.h"
+
+#include "g_misc.h"
+#include "m_globvars.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "c_optimise.h"
+
+
+// the maximum number of passes through the intercode (each pass normally removes a whole level of nested constant expression, so this shouldn't be reached)
+#define OPTIMISE_PASSES_MAX 16
+
+// bits in exit_point_target:
+#define TARGET_TRUE_POINT 1
+#define TARGET_FALSE_POINT 2
+
+// the maximum number of intercode entries b_dead_after() looks at (over all paths) before giving up
+#define B_DEAD_SEARCH_MAX 256
+
+enum
+{
+B_USE_NONE, // doesn't read or set B
+B_USE_READ, // reads B
+B_USE_SET, // sets B without reading it
+B_USE_END, // stops the program (B doesn't keep its value between executions - see v_interp.c)
+B_USE_UNKNOWN // jumps somewhere that can't be followed
+};
+
+static void find_exit_point_targets(struct cstatestruct* cstate);
+static int optimise_at(struct cstatestruct* cstate, int ic);
+static int optimise_constant_A(struct cstatestruct* cstate, int ic);
+static int optimise_pushA(struct cstatestruct* cstate, int ic);
+static int remove_dead_jump(struct cstatestruct* cstate, int ic);
+static int remove_unreachable_code(struct cstatestruct* cstate, int ic);
+static int is_unconditional_exit(struct cstatestruct* cstate, int ic);
+static int is_transparent(struct cstatestruct* cstate, int ic);
+static int next_ic(struct cstatestruct* cstate, int ic);
+static int is_op(struct cstatestruct* cstate, int ic, int op);
+static int b_dead_after(struct cstatestruct* cstate, int ic);
+static int b_dead_from(struct cstatestruct* cstate, int ic);
+static int b_dead_at_exit_point(struct cstatestruct* cstate, int exit_point, int point_type);
+static int b_register_use(int op);
+static void remove_ic(struct cstatestruct* cstate, int ic);
+static int fold_constant(int op, s16b b, s16b a, s16b* result);
+static void compact_intercode(struct cstatestruct* cstate);
+
+// returns 1 if the optimiser should be used when compiling in compile_mode (a COMPILE_MODE_ value)
+int optimise_compile_mode(int compile_mode)
+{
+
+ switch(compile_mode)
+ {
+	 case COMPILE_MODE_TEST:
+	 	return (settings.option [OPTION_OPTIMISE] & OPTIMISE_MODE_TEST) != 0;
+	 case COMPILE_MODE_BUILD:
+	 	return (settings.option [OPTION_OPTIMISE] & OPTIMISE_MODE_BUILD) != 0;
+	 case COMPILE_MODE_LOCK:
+	 	return (settings.option [OPTION_OPTIMISE] & OPTIMISE_MODE_LOCK) != 0;
+ }
+
+ return 0; // COMPILE_MODE_FIX doesn't generate bcode
+
+}
+
+// call after the compiler has written the intercode (including the final stop) without errors.
+// updates cstate->ic_pos to the new length of the intercode.
+void optimise_intercode(struct cstatestruct* cstate)
+{
+
+ int i;
+ int changed = 1;
+ int passes = 0;
+
+ cstate->ostate.ic_length = cstate->ic_pos;
+
+ while(changed
+		&& passes < OPTIMISE_PASSES_MAX)
+	{
+		changed = 0;
+// this is only worked out once per pass, so code removed during the pass may leave some exit points looking like targets
+//  until the next pass. That just means a few optimisations are left for the next pass.
+		find_exit_point_targets(cstate);
+		for (i = 0; i < cstate->ostate.ic_length; i ++)
+		{
+			if (cstate->intercode[i].type == IC_NONE)
+				continue;
+			if (optimise_at(cstate, i))
+				changed = 1;
+		}
+		passes ++;
+	}
+
+ compact_intercode(cstate);
+
+}
+
+static void find_exit_point_targets(struct cstatestruct* cstate)
+{
+
+ int i;
+
+ for (i = 0; i < EXPOINTS; i ++)
+	{
+		cstate->ostate.exit_point_target [i] = 0;
+		cstate->ostate.exit_point_pos [i] [0] = -1;
+		cstate->ostate.exit_point_pos [i] [1] = -1;
+	}
+
+ for (i = 0; i < cstate->ostate.ic_length; i ++)
+	{
+		switch(cstate->intercode[i].type)
+		{
+// removed intercode is only set to IC_NONE until compact_intercode(), so these positions stay valid for the whole pass:
+		 case IC_EXIT_POINT_TRUE:
+		 	cstate->ostate.exit_point_pos [cstate->intercode[i].value [0]] [0] = i;
+		 	break;
+		 case IC_EXIT_POINT_FALSE:
+		 	cstate->ostate.exit_point_pos [cstate->intercode[i].value [0]] [1] = i;
+		 	break;
+		 case IC_IFFALSE_JUMP_TO_EXIT_POINT:
+		 case IC_JUMP_EXIT_POINT_FALSE:
+		 	cstate->ostate.exit_point_target [cstate->intercode[i].value [0]] |= TARGET_FALSE_POINT;
+		 	break;
+		 case IC_IFTRUE_JUMP_TO_EXIT_POINT:
+		 case IC_JUMP_EXIT_POINT_TRUE:
+		 case IC_SWITCH: // the switch's jump table starts at its exit point's true point
+		 case IC_JUMP_TABLE:
+		 	cstate->ostate.exit_point_target [cstate->intercode[i].value [0]] |= TARGET_TRUE_POINT;
+		 	break;
+		}
+	}
+
+}
+
+// returns 1 if anything was changed
+static int optimise_at(struct cstatestruct* cstate, int ic)
+{
+
+ if (optimise_constant_A(cstate, ic))
+		return 1;
+
+ if (optimise_pushA(cstate, ic))
+		return 1;
+
+// addA_num 0 and mulA_num 1 don't do anything (these can be left by constant folding).
+// addA_num with a variable operand is IC_OP_WITH_VARIABLE_OPERAND, so is_op() won't match it.
+ if ((is_op(cstate, ic, OP_addA_num) && cstate->intercode[ic].value [1] == 0)
+		|| (is_op(cstate, ic, OP_mulA_num) && cstate->intercode[ic].value [1] == 1))
+	{
+		remove_ic(cstate, ic);
+		return 1;
+	}
+
+ if (remove_dead_jump(cstate, ic))
+		return 1;
+
+ if (remove_unreachable_code(cstate, ic))
+		return 1;
+
+ return 0;
+
+}
+
+// deals with things that follow a setA_num
+static int optimise_constant_A(struct cstatestruct* cstate, int ic)
+{
+
+ if (!is_op(cstate, ic, OP_setA_num))
+		return 0;
+
+ s16b a = cstate->intercode[ic].value [1];
+ s16b result;
+ int next = next_ic(cstate, ic);
+
+ if (next >= cstate->ostate.ic_length)
+		return 0;
+
+// setA_num a; pushA; setA_num b; popB; <op>
+ if (is_op(cstate, next, OP_pushA))
+	{
+		int value_b = next_ic(cstate, next);
+		int pop = next_ic(cstate, value_b);
+		int operation = next_ic(cstate, pop);
+		if (is_op(cstate, value_b, OP_setA_num)
+			&& is_op(cstate, pop, OP_popB)
+			&& operation < cstate->ostate.ic_length
+			&& cstate->intercode[operation].type == IC_OP
+			&& b_dead_after(cstate, operation)
+			&& fold_constant(cstate->intercode[operation].value [0], a, cstate->intercode[value_b].value [1], &result))
+		{
+			cstate->intercode[ic].value [1] = result;
+			remove_ic(cstate, next);
+			remove_ic(cstate, value_b);
+			remove_ic(cstate, pop);
+			remove_ic(cstate, operation);
+			return 1;
+		}
+		return 0;
+	}
+
+ if (is_op(cstate, next, OP_lnot))
+	{
+		cstate->intercode[ic].value [1] = (a == 0);
+		remove_ic(cstate, next);
+		return 1;
+	}
+
+ if (is_op(cstate, next, OP_mulA_num))
+	{
+		cstate->intercode[ic].value [1] = (s16b) (a * (s16b) cstate->intercode[next].value [1]);
+		remove_ic(cstate, next);
+		return 1;
+	}
+
+ if (is_op(cstate, next, OP_addA_num))
+	{
+		cstate->intercode[ic].value [1] = (s16b) (a + (s16b) cstate->intercode[next].value [1]);
+		remove_ic(cstate, next);
+		return 1;
+	}
+
+// constant conditions. The setA_num stays because A may be used at the exit point (e.g. as the result of a && expression)
+ if (cstate->intercode[next].type == IC_IFFALSE_JUMP_TO_EXIT_POINT)
+	{
+		if (a != 0)
+			remove_ic(cstate, next);
+			 else
+				 cstate->intercode[next].type = IC_JUMP_EXIT_POINT_FALSE;
+		return 1;
+	}
+
+ if (cstate->intercode[next].type == IC_IFTRUE_JUMP_TO_EXIT_POINT)
+	{
+		if (a != 0)
+		 cstate->intercode[next].type = IC_JUMP_EXIT_POINT_TRUE;
+		  else
+				 remove_ic(cstate, next);
+		return 1;
+	}
+
+ return 0;
+
+}
+
+// deals with values pushed to the stack and then popped straight back to B
+static int optimise_pushA(struct cstatestruct* cstate, int ic)
+{
+
+ if (!is_op(cstate, ic, OP_pushA))
+		return 0;
+
+ int value = next_ic(cstate, ic);
+ int pop = next_ic(cstate, value);
+
+ if (!is_op(cstate, pop, OP_popB))
+		return 0;
+
+ if (is_op(cstate, value, OP_setA_num))
+	{
+		int operation = next_ic(cstate, pop);
+		s16b n = cstate->intercode[value].value [1];
+		int new_op = -1;
+
+		if (is_op(cstate, operation, OP_add))
+			new_op = OP_addA_num;
+		if (is_op(cstate, operation, OP_mul))
+			new_op = OP_mulA_num;
+		if (is_op(cstate, operation, OP_sub_BA)
+			&& n != -32768) // -n wouldn't fit
+		{
+			new_op = OP_addA_num;
+			n = -n;
+		}
+
+		if (new_op != -1
+			&& b_dead_after(cstate, operation))
+		{
+			cstate->intercode[ic].value [0] = new_op;
+			cstate->intercode[ic].value [1] = n;
+			remove_ic(cstate, value);
+			remove_ic(cstate, pop);
+			remove_ic(cstate, operation);
+			return 1;
+		}
+	}
+
+ if (is_op(cstate, value, OP_setA_num)
+		|| (value < cstate->ostate.ic_length
+		 && cstate->intercode[value].type == IC_OP_WITH_VARIABLE_OPERAND
+		 && cstate->intercode[value].value [0] == OP_setA_mem))
+	{
+		cstate->intercode[ic].value [0] = OP_copyAtoB;
+		remove_ic(cstate, pop);
+		return 1;
+	}
+
+ return 0;
+
+}
+
+// returns 1 if B is set again, or the program stops, before B is read on every path that execution can take after ic.
+// returns 0 if B may be read, or if this can't be worked out.
+static int b_dead_after(struct cstatestruct* cstate, int ic)
+{
+
+ cstate->ostate.b_search_left = B_DEAD_SEARCH_MAX;
+
+ return b_dead_from(cstate, ic + 1);
+
+}
+
+static int b_dead_from(struct cstatestruct* cstate, int ic)
+{
+
+ int i;
+
+ for (i = ic; i < cstate->ostate.ic_length; i ++)
+	{
+		cstate->ostate.b_search_left --;
+		if (cstate->ostate.b_search_left <= 0)
+			return 0; // probably a loop
+		switch(cstate->intercode[i].type)
+		{
+		 case IC_NONE:
+		 case IC_EXIT_POINT_TRUE:
+		 case IC_EXIT_POINT_FALSE:
+		 	continue;
+		 case IC_OP:
+		 case IC_OP_WITH_VARIABLE_OPERAND:
+		 	switch(b_register_use(cstate->intercode[i].value [0]))
+		 	{
+		 	 case B_USE_NONE:
+		 	 	continue;
+		 	 case B_USE_SET:
+		 	 case B_USE_END:
+		 	 	return 1;
+		 	 default:
+		 	 	return 0;
+		 	}
+		 case IC_JUMP_EXIT_POINT_TRUE:
+		 	return b_dead_at_exit_point(cstate, cstate->intercode[i].value [0], IC_EXIT_POINT_TRUE);
+		 case IC_JUMP_EXIT_POINT_FALSE:
+		 	return b_dead_at_exit_point(cstate, cstate->intercode[i].value [0], IC_EXIT_POINT_FALSE);
+		 case IC_IFTRUE_JUMP_TO_EXIT_POINT:
+		 	if (!b_dead_at_exit_point(cstate, cstate->intercode[i].value [0], IC_EXIT_POINT_TRUE))
+					return 0;
+				continue; // also check the path where the jump isn't taken
+		 case IC_IFFALSE_JUMP_TO_EXIT_POINT:
+		 	if (!b_dead_at_exit_point(cstate, cstate->intercode[i].value [0], IC_EXIT_POINT_FALSE))
+					return 0;
+				continue;
+		 default:
+// labels, gotos, data and switches aren't followed
+		 	return 0;
+		}
+	}
+
+ return 0;
+
+}
+
+static int b_dead_at_exit_point(struct cstatestruct* cstate, int exit_point, int point_type)
+{
+
+ int pos = cstate->ostate.exit_point_pos [exit_point] [point_type == IC_EXIT_POINT_TRUE? 0 : 1];
+
+ if (pos == -1)
+		return 0;
+
+ return b_dead_from(cstate, pos + 1);
+
+}
+
+// returns a B_USE_ value for what op does with register B (see v_interp.c)
+static int b_register_use(int op)
+{
+
+ switch(op)
+ {
+	 case OP_add:
+	 case OP_sub_BA:
+	 case OP_sub_AB:
+	 case OP_mul:
+	 case OP_div_BA:
+	 case OP_div_AB:
+	 case OP_mod_BA:
+	 case OP_mod_AB:
+	 case OP_and:
+	 case OP_or:
+	 case OP_xor:
+	 case OP_lsh_BA:
+	 case OP_lsh_AB:
+	 case OP_rsh_BA:
+	 case OP_rsh_AB:
+	 case OP_comp_eq:
+	 case OP_comp_gr:
+	 case OP_comp_greq:
+	 case OP_comp_ls:
+	 case OP_comp_lseq:
+	 case OP_comp_neq:
+	 case OP_copyA_to_derefB:
+	 	return B_USE_READ;
+	 case OP_popB:
+	 case OP_copyAtoB:
+	 	return B_USE_SET;
+	 case OP_stop:
+	 case OP_terminate:
+	 	return B_USE_END;
+	 case OP_jump_num:
+	 case OP_jumpA:
+	 case OP_iftrue_jump:
+	 case OP_iffalse_jump:
+	 case OP_return_sub:
+	 case OP_switchA:
+// print and bubble are followed by data:
+	 case OP_print:
+	 case OP_bubble:
+	 	return B_USE_UNKNOWN;
+ }
+
+ return B_USE_NONE;
+
+}
+
+// removes a jump to an exit point that comes immediately after the jump
+static int remove_dead_jump(struct cstatestruct* cstate, int ic)
+{
+
+ int target_type;
+
+ switch(cstate->intercode[ic].type)
+ {
+	 case IC_IFFALSE_JUMP_TO_EXIT_POINT:
+	 case IC_JUMP_EXIT_POINT_FALSE:
+	 	target_type = IC_EXIT_POINT_FALSE; break;
+	 case IC_IFTRUE_JUMP_TO_EXIT_POINT:
+	 case IC_JUMP_EXIT_POINT_TRUE:
+	 	target_type = IC_EXIT_POINT_TRUE; break;
+	 default:
+	 	return 0;
+ }
+
+ int i;
+
+// only exit points can be between the jump and its target (whether they're targets of other jumps doesn't matter, as no code runs between them)
+ for (i = ic + 1; i < cstate->ostate.ic_length; i ++)
+	{
+		if (cstate->intercode[i].type == IC_NONE)
+			continue;
+		if (cstate->intercode[i].type == target_type
+			&& cstate->intercode[i].value [0] == cstate->intercode[ic].value [0])
+		{
+			remove_ic(cstate, ic);
+			return 1;
+		}
+		if (cstate->intercode[i].type != IC_EXIT_POINT_TRUE
+			&& cstate->intercode[i].type != IC_EXIT_POINT_FALSE)
+			return 0;
+	}
+
+ return 0;
+
+}
+
+// removes instructions after an unconditional jump or stop, up to the next point that can be jumped to
+static int remove_unreachable_code(struct cstatestruct* cstate, int ic)
+{
+
+ if (!is_unconditional_exit(cstate, ic))
+		return 0;
+
+ int i;
+ int removed = 0;
+
+ for (i = ic + 1; i < cstate->ostate.ic_length; i ++)
+	{
+		switch(cstate->intercode[i].type)
+		{
+		 case IC_NONE:
+		 	continue;
+		 case IC_EXIT_POINT_TRUE:
+		 case IC_EXIT_POINT_FALSE:
+		 	if (!is_transparent(cstate, i))
+					return removed;
+				continue; // leave it there (it doesn't generate any bcode)
+		 case IC_OP:
+		 	switch(cstate->intercode[i].value [0])
+		 	{
+// these are followed by data or need to stay with the instruction after them:
+		 	 case OP_print:
+		 	 case OP_bubble:
+		 	 case OP_switchA:
+		 	 case OP_push_return_address:
+		 	 	return removed;
+// stop is left in place (there's always one at the end of the code, so falling through from any unexpected place still stops)
+		 	 case OP_stop:
+		 	 	continue;
+		 	}
+		 	break;
+		 case IC_OP_WITH_VARIABLE_OPERAND:
+		 case IC_IFFALSE_JUMP_TO_EXIT_POINT:
+		 case IC_IFTRUE_JUMP_TO_EXIT_POINT:
+		 case IC_JUMP_EXIT_POINT_TRUE:
+		 case IC_JUMP_EXIT_POINT_FALSE:
+		 	break;
+		 default:
+// labels, data (IC_NUMBER and IC_JUMP_TABLE) and gotos (kept so that an undefined label is still reported)
+		 	return removed;
+		}
+		remove_ic(cstate, i);
+		removed = 1;
+	}
+
+ return removed;
+
+}
+
+// returns 1 if execution never continues to the intercode after ic
+static int is_unconditional_exit(struct cstatestruct* cstate, int ic)
+{
+
+ int i;
+
+ switch(cstate->intercode[ic].type)
+ {
+	 case IC_JUMP_EXIT_POINT_TRUE:
+	 case IC_JUMP_EXIT_POINT_FALSE:
+	 	return 1;
+	 case IC_GOTO_LABEL:
+// a gosub is a push_return_address followed by a goto, and returns to just after the goto
+	 	for (i = ic - 1; i >= 0; i --)
+			{
+				if (cstate->intercode[i].type == IC_NONE)
+					continue;
+				return !is_op(cstate, i, OP_push_return_address);
+			}
+	 	return 1;
+	 case IC_OP:
+	 	switch(cstate->intercode[ic].value [0])
+	 	{
+	 	 case OP_stop:
+	 	 case OP_terminate:
+	 	 case OP_return_sub:
+	 	 case OP_jumpA:
+	 	 	return 1;
+	 	}
+	 	return 0;
+ }
+
+ return 0;
+
+}
+
+// returns 1 if ic doesn't generate any bcode and can't be jumped to
+static int is_transparent(struct cstatestruct* cstate, int ic)
+{
+
+ switch(cstate->intercode[ic].type)
+ {
+	 case IC_NONE:
+	 	return 1;
+	 case IC_EXIT_POINT_TRUE:
+	 	return (cstate->ostate.exit_point_target [cstate->intercode[ic].value [0]] & TARGET_TRUE_POINT) == 0;
+	 case IC_EXIT_POINT_FALSE:
+	 	return (cstate->ostate.exit_point_target [cstate->intercode[ic].value [0]] & TARGET_FALSE_POINT) == 0;
+ }
+
+ return 0;
+
+}
+
+// returns the index of the next intercode after ic that isn't transparent (or ostate.ic_length if there isn't one)
+static int next_ic(struct cstatestruct* cstate, int ic)
+{
+
+ ic ++;
+
+ while(ic < cstate->ostate.ic_length
+		&& is_transparent(cstate, ic))
+	{
+		ic ++;
+	}
+
+ return ic;
+
+}
+
+static int is_op(struct cstatestruct* cstate, int ic, int op)
+{
+
+ return (ic < cstate->ostate.ic_length
+									&& cstate->intercode[ic].type == IC_OP
+									&& cstate->intercode[ic].value [0] == op);
+
+}
+
+static void remove_ic(struct cstatestruct* cstate, int ic)
+{
+
+ cstate->intercode[ic].type = IC_NONE;
+
+}
+
+// works out the result of (b <op> a) (where op is an instruction that sets A from B and A) in the same way as the interpreter.
+// returns 1 if op can be folded, 0 if not
+static int fold_constant(int op, s16b b, s16b a, s16b* result)
+{
+
+ switch(op)
+ {
+	 case OP_add: *result = b + a; return 1;
+	 case OP_sub_BA: *result = b - a; return 1;
+	 case OP_mul: *result = b * a; return 1;
+	 case OP_div_BA:
+	 	if (a == 0)
+				*result = 0;
+			 else
+				 *result = b / a;
+			return 1;
+	 case OP_mod_BA:
+	 	if (a == 0)
+				*result = 0;
+			 else
+				 *result = b % a;
+			return 1;
+	 case OP_and: *result = b & a; return 1;
+	 case OP_or: *result = b | a; return 1;
+	 case OP_xor: *result = b ^ a; return 1;
+// shifts are left for the interpreter if the shift is out of range (as the result then depends on the machine)
+	 case OP_lsh_BA:
+	 	if (a < 0 || a > 15)
+				return 0;
+			*result = b << a;
+			return 1;
+	 case OP_rsh_BA:
+	 	if (a < 0 || a > 15)
+				return 0;
+			*result = b >> a;
+			return 1;
+	 case OP_comp_eq: *result = (b == a); return 1;
+	 case OP_comp_gr: *result = (b > a); return 1;
+	 case OP_comp_greq: *result = (b >= a); return 1;
+	 case OP_comp_ls: *result = (b < a); return 1;
+	 case OP_comp_lseq: *result = (b <= a); return 1;
+	 case OP_comp_neq: *result = (b != a); return 1;
+ }
+
+ return 0;
+
+}
+
+// removes all of the IC_NONE entries left by remove_ic()
+static void compact_intercode(struct cstatestruct* cstate)
+{
+
+ int i;
+ int new_length = 0;
+
+ for (i = 0; i < cstate->ostate.ic_length; i ++)
+	{
+		if (cstate->intercode[i].type == IC_NONE)
+			continue;
+		if (i != new_length)
+			cstate->intercode[new_length] = cstate->intercode[i];
+		new_length ++;
+	}
+
+ cstate->ic_pos = new_length;
+
+}
+
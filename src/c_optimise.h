@@ -0,0 +1,9 @@
+
+#ifndef H_C_OPTIMISE
+#define H_C_OPTIMISE
+
+int optimise_compile_mode(int compile_mode);
+void optimise_intercode(struct cstatestruct* cstate);
+
+#endif
+
@@ -23,78 +23,68 @@ int remove_file_name_from_path(char* file_path);
 
 int letter_number(char read_char);
 int letter(char read_char);
-int find_end_of_comment(void);
+int find_end_of_comment(struct cstatestruct* cstate);
 //int prepr_error(int error_type);
 //int prepr_error_minus1(int error_type);
 //int prepr_error_no_source(int error_type, const char* file_name);
 //int prepr_error_no_source_minus1(int error_type, const char* file_name);
-int prepr_error(const char* error_str);
+int prepr_error(struct cstatestruct* cstate, const char* error_str);
 
 
 int load_source_file(const char* file_path, struct source_struct* target_source);
 //int load_source_file(const char* file_path, struct source_struct* target_source);
 //int load_binary_file(const char* file_path, struct bcode_struct* bcode, int src_file_index, int preprocessing);
 
-extern struct cstatestruct cstate;
-
-struct prstate_struct
-{
-	struct source_edit_struct* source_edit;
-	int src_line;
-	int src_pos;
-	int scode_pos;
-};
-struct prstate_struct prstate;
 
 
-int preprocess(struct source_edit_struct* source_edit)
+int preprocess(struct cstatestruct* cstate, struct source_edit_struct* source_edit)
 {
 
-	prstate.src_line = 0;
-	prstate.src_pos = 0;
-	prstate.source_edit = source_edit;
-//	cstate.scode.text_length = 0; - compiler should already have been initialised
-//	cstate.scode.text [0] = 0;
+	cstate->prstate.src_line = 0;
+	cstate->prstate.src_pos = 0;
+	cstate->prstate.source_edit = source_edit;
+//	cstate->scode.text_length = 0; - compiler should already have been initialised
+//	cstate->scode.text [0] = 0;
 	char read_char;
 	char read_char2;
 	int writing_space = 0;
 
 // Need to start scode with a space as the lexer
-	prstate.scode_pos = 1;
-	cstate.scode.text [0] = ' ';
-	cstate.scode.text [1] = '\0';
-	cstate.scode.text_length = 1;
+	cstate->prstate.scode_pos = 1;
+	cstate->scode.text [0] = ' ';
+	cstate->scode.text [1] = '\0';
+	cstate->scode.text_length = 1;
 
 
 	while(TRUE)
 	{
-		read_char = prstate.source_edit->text[prstate.source_edit->line_index[prstate.src_line]][prstate.src_pos];
+		read_char = cstate->prstate.source_edit->text[cstate->prstate.source_edit->line_index[cstate->prstate.src_line]][cstate->prstate.src_pos];
 		if (read_char == '\0')
 		{
-			prstate.src_line++;
-			prstate.src_pos = 0;
-			if (prstate.src_line >= SOURCE_TEXT_LINES)
+			cstate->prstate.src_line++;
+			cstate->prstate.src_pos = 0;
+			if (cstate->prstate.src_line >= SOURCE_TEXT_LINES)
 				break; // finished!
 			if (writing_space == 1)
 				continue; // don't need to write multiple spaces
 			read_char = ' '; // replace end-of-line with a space.
- 		prstate.src_pos --; // make sure the first actual character of new line is read.
+ 		cstate->prstate.src_pos --; // make sure the first actual character of new line is read.
 		}
 		if (read_char == '/')
 		{
- 		read_char2 = prstate.source_edit->text[prstate.source_edit->line_index[prstate.src_line]][prstate.src_pos + 1]; // note + 1
+ 		read_char2 = cstate->prstate.source_edit->text[cstate->prstate.source_edit->line_index[cstate->prstate.src_line]][cstate->prstate.src_pos + 1]; // note + 1
  		if (read_char2 == '/') // single-line comment
 			{
-			 prstate.src_line ++;
-			 prstate.src_pos = 0;
-			 if (prstate.src_line >= SOURCE_TEXT_LINES)
+			 cstate->prstate.src_line ++;
+			 cstate->prstate.src_pos = 0;
+			 if (cstate->prstate.src_line >= SOURCE_TEXT_LINES)
 			 	break; // finished!
 			 continue;
 			}
 			if (read_char2 == '*') // multi-line comment
 			{
-				prstate.src_pos++;
-				if (!find_end_of_comment())
+				cstate->prstate.src_pos++;
+				if (!find_end_of_comment(cstate))
 					break; // finished! (don't really care if the source ends in an unclosed comment)
 // find_end_of_comment leaves src_pos just after end of comment
 				continue;
@@ -106,21 +96,21 @@ int preprocess(struct source_edit_struct* source_edit)
 			temp_text [0] = read_char;
 			temp_text [1] = 0;
 			fpr("\nInvalid character in source code: %i [%s]", read_char, temp_text);
-		 return prepr_error("invalid character");
+		 return prepr_error(cstate, "invalid character");
 		}
 		if (read_char == ' ')
 		{
 			if (writing_space == 1)
 			{
-  		prstate.src_pos ++; // this shouldn't put src_pos past the end of the line (even though end-of-line is replaced by a space above) because of the continue in the end-of-line check.
+  		cstate->prstate.src_pos ++; // this shouldn't put src_pos past the end of the line (even though end-of-line is replaced by a space above) because of the continue in the end-of-line check.
   		continue;
 			}
 			writing_space = 1;
 		}
 		 else
 			 writing_space = 0;
-	 cstate.scode.text [prstate.scode_pos] = read_char;
-	 cstate.scode.src_line [prstate.scode_pos] = prstate.src_line;
+	 cstate->scode.text [cstate->prstate.scode_pos] = read_char;
+	 cstate->scode.src_line [cstate->prstate.scode_pos] = cstate->prstate.src_line;
 /*
 		if (prstate.scode_pos < 100)
 		{
@@ -131,16 +121,16 @@ int preprocess(struct source_edit_struct* source_edit)
 		}*/
 
 
-	 prstate.scode_pos ++;
-		prstate.src_pos ++;
+	 cstate->prstate.scode_pos ++;
+		cstate->prstate.src_pos ++;
 
-		if (prstate.scode_pos >= SCODE_LENGTH - 3)
-			return prepr_error("source code too long");
+		if (cstate->prstate.scode_pos >= SCODE_LENGTH - 3)
+			return prepr_error(cstate, "source code too long");
 
 	} // end while loop
 
- cstate.scode.text [prstate.scode_pos] = '\0';
-	cstate.scode.text_length = prstate.scode_pos;
+ cstate->scode.text [cstate->prstate.scode_pos] = '\0';
+	cstate->scode.text_length = cstate->prstate.scode_pos;
 
  return 1;
 
@@ -150,28 +140,28 @@ int preprocess(struct source_edit_struct* source_edit)
 // call this when src_pos is at the * in the start of a multi-line comment.
 // leaves src_pos just after the / that ends the comment (which may be at the end of line)
 // returns 1 if still reading, 0 if end of source reached
-int find_end_of_comment(void)
+int find_end_of_comment(struct cstatestruct* cstate)
 {
 	char read_char;
 
 	while(TRUE)
 	{
-		read_char = prstate.source_edit->text[prstate.source_edit->line_index[prstate.src_line]][prstate.src_pos];
+		read_char = cstate->prstate.source_edit->text[cstate->prstate.source_edit->line_index[cstate->prstate.src_line]][cstate->prstate.src_pos];
 		if (read_char == '\0')
 		{
-			prstate.src_line++;
-			prstate.src_pos = 0;
-			if (prstate.src_line >= SOURCE_TEXT_LINES)
+			cstate->prstate.src_line++;
+			cstate->prstate.src_pos = 0;
+			if (cstate->prstate.src_line >= SOURCE_TEXT_LINES)
 				return 0; // finished!
 			continue;
 		}
 		if (read_char == '*'
-			&& prstate.source_edit->text[prstate.source_edit->line_index[prstate.src_line]][prstate.src_pos+1] == '/')
+			&& cstate->prstate.source_edit->text[cstate->prstate.source_edit->line_index[cstate->prstate.src_line]][cstate->prstate.src_pos+1] == '/')
 		{
-			prstate.src_pos += 2; // assume each line of text is null terminated
+			cstate->prstate.src_pos += 2; // assume each line of text is null terminated
 			break;
 		}
-		prstate.src_pos++;
+		cstate->prstate.src_pos++;
 	} // end while loop
 
 	return 1;
@@ -610,27 +600,27 @@ int remove_file_name_from_path(char* file_path)
 }
 
 
-int prepr_error(const char* error_str)
+int prepr_error(struct cstatestruct* cstate, const char* error_str)
 {
 
-     start_log_line(MLOG_COL_ERROR);
-     write_to_log("Preprocessor error at line ");
-     write_number_to_log(prstate.src_line + 1);
+     start_log_buffer_line(cstate->log, MLOG_COL_ERROR);
+     write_to_log_buffer(cstate->log, "Preprocessor error at line ");
+     write_number_to_log_buffer(cstate->log, cstate->prstate.src_line + 1);
 /*     if (prstate.source_file == 0)
       write_to_log(" of file ");
        else
         write_to_log(" of included file ");
      write_to_log(prstate.source [prstate.source_file]->src_file_name);*/
-     write_to_log(".");
-     finish_log_line();
+     write_to_log_buffer(cstate->log, ".");
+     finish_log_buffer_line(cstate->log);
 
 //     if (error_type != PRERR_EMPTY)
      {
-      start_log_line(MLOG_COL_ERROR);
-      write_to_log("Error: ");
-      write_to_log(error_str);//prepr_error_name [error_type]);
-      write_to_log(".");
-      finish_log_line();
+      start_log_buffer_line(cstate->log, MLOG_COL_ERROR);
+      write_to_log_buffer(cstate->log, "Error: ");
+      write_to_log_buffer(cstate->log, error_str);//prepr_error_name [error_type]);
+      write_to_log_buffer(cstate->log, ".");
+      finish_log_buffer_line(cstate->log);
      }
 
 
@@ -2,7 +2,7 @@
 #ifndef H_C_PREPR
 #define H_C_PREPR
 
-int preprocess(struct source_edit_struct* source_edit);
+int preprocess(struct cstatestruct* cstate, struct source_edit_struct* source_edit);
 int valid_source_character(char read_char);
 
 int load_source_file(const char* file_path, struct source_struct* target_source);
@@ -94,6 +94,8 @@ int write_design_structure_to_source_edit(int verified_clear_file)
 	if (editor.current_source_edit_index == -1)
 		return 0;
 	dcode_state.ses = &editor.source_edit [editor.current_source_edit_index];
+	if (dcode_state.ses->text == NULL)
+		clear_source_edit_text(dcode_state.ses); // source_edit hasn't been used since being released
 	dcode_state.source_line = 0;
 	dcode_state.cursor_pos = 0;
 	dcode_state.indent_level = 0;
@@ -353,7 +353,7 @@ int add_text_at_start_of_line(struct source_edit_struct* se, char* add_str)
 // if it won't fit, put the existing text on a new line:
      if (insert_empty_lines(se, se->cursor_line + 1, 1))
      {
-      strcpy(se->text [se->line_index [se->cursor_line + 1]], se->text [se->line_index [se->cursor_line]]);
+      copy_source_edit_line(se->text [se->line_index [se->cursor_line + 1]], se->text [se->line_index [se->cursor_line]]);
       strcpy(se->text [se->line_index [se->cursor_line]], add_str);
       se->cursor_line ++;
 //       write_line_to_log("new line", -1, -1);
@@ -836,7 +836,7 @@ void call_undo(void)
    se->saved = 0; // indicates that source has been modified
    se->cursor_line = editor.undo_cursor_line [editor.undo_pos];
    se->cursor_pos = editor.undo_cursor_pos [editor.undo_pos]; // ??
-   strcat(se->text [se->line_index [se->cursor_line]], se->text [se->line_index [se->cursor_line + 1]]);
+   append_source_edit_line(se->text [se->line_index [se->cursor_line]], se->text [se->line_index [se->cursor_line + 1]]);
    delete_lines(se, se->cursor_line + 1, 1);
    update_source_lines(se, se->cursor_line, 2);
    editor.undone [editor.undo_pos] = 1;
@@ -875,7 +875,7 @@ void call_undo(void)
     i ++;
    };
 // now add remainder of last line to first, then delete last line:
-   strcat(se->text [se->line_index [se->cursor_line]], se->text [se->line_index [editor.undo_end_line [editor.undo_pos]]]);
+   append_source_edit_line(se->text [se->line_index [se->cursor_line]], se->text [se->line_index [editor.undo_end_line [editor.undo_pos]]]);
 
    delete_lines(se, se->cursor_line + 1, editor.undo_end_line [editor.undo_pos] - se->cursor_line);
 
@@ -1021,7 +1021,7 @@ void call_redo(void)
    se->saved = 0; // indicates that source has been modified
    se->cursor_line = editor.undo_cursor_line [editor.undo_pos];
    se->cursor_pos = editor.undo_cursor_pos [editor.undo_pos]; // ??
-   strcat(se->text [se->line_index [se->cursor_line]], se->text [se->line_index [se->cursor_line + 1]]);
+   append_source_edit_line(se->text [se->line_index [se->cursor_line]], se->text [se->line_index [se->cursor_line + 1]]);
    delete_lines(se, se->cursor_line + 1, 1);
    update_source_lines(se, se->cursor_line, 2);
    editor.undone [editor.undo_pos] = 0;
@@ -1043,7 +1043,7 @@ void call_redo(void)
     i ++;
    };
 // now add remainder of last line to first, then delete last line:
-   strcat(se->text [se->line_index [se->cursor_line]], se->text [se->line_index [editor.undo_end_line [editor.undo_pos]]]);
+   append_source_edit_line(se->text [se->line_index [se->cursor_line]], se->text [se->line_index [editor.undo_end_line [editor.undo_pos]]]);
 
    delete_lines(se, se->cursor_line + 1, editor.undo_end_line [editor.undo_pos] - se->cursor_line);
 
@@ -4,6 +4,7 @@
 
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "m_config.h"
@@ -305,11 +306,44 @@ void clear_source_edit_struct(struct source_edit_struct* se)
 
 }
 
+// Frees the text of a source_edit that isn't being used (e.g. an empty or deleted template's source).
+// The text is allocated again by clear_source_edit_text() when the source_edit is used.
+void release_source_edit_struct(struct source_edit_struct* se)
+{
+
+ strcpy(se->src_file_name, "unsaved");
+ strcpy(se->src_file_path, "unsaved");
+
+ se->active = 0;
+ se->type = SOURCE_EDIT_TYPE_SOURCE;
+ se->from_a_file = 0;
+ se->saved = 0;
+
+ free(se->text);
+ se->text = NULL;
+ free(se->source_colour);
+ se->source_colour = NULL;
+
+}
+
 // clears source_edit text and resets editor stuff like cursor location without reinitialising the source_edit in any other way.
 // used to e.g. prepare for autocoder.
+// allocates the text if the source_edit doesn't have any (see release_source_edit_struct())
 void clear_source_edit_text(struct source_edit_struct* se)
 {
 
+ if (se->text == NULL)
+	{
+  se->text = calloc(SOURCE_TEXT_LINES, sizeof(*se->text));
+  se->source_colour = calloc(SOURCE_TEXT_LINES, sizeof(*se->source_colour));
+  if (se->text == NULL
+			|| se->source_colour == NULL)
+  {
+   fprintf(stdout, "\ne_editor.c: Out of memory in allocating source_edit text.");
+   error_call();
+  }
+	}
+
  se->cursor_line = 0;
  se->cursor_pos = 0;
  se->cursor_base = 0;
@@ -329,6 +363,23 @@ void clear_source_edit_text(struct source_edit_struct* se)
 
 }
 
+// Copies one line of a source_edit's text to another (or anything else to a line).
+// se->text is a single allocation (see clear_source_edit_text()), so gcc can't tell that two lines don't overlap; this uses memmove instead of strcpy.
+void copy_source_edit_line(char* target_line, const char* source_text)
+{
+
+ memmove(target_line, source_text, strlen(source_text) + 1);
+
+}
+
+// Adds text (which may be another line of the same source_edit) to the end of a line. The caller must check that it fits.
+void append_source_edit_line(char* target_line, const char* source_text)
+{
+
+ memmove(target_line + strlen(target_line), source_text, strlen(source_text) + 1);
+
+}
+
 // currently this function cannot fail
 int source_to_editor(struct source_struct* src, int esource)
 {
@@ -2912,7 +2963,7 @@ static void cursor_etc_key(int key_press)
    se->cursor_pos = strlen(se->text [se->line_index [se->cursor_line - 1]]);
    add_undo_remove_enter();
 // copy current line to end of previous line, and update it:
-   strcat(se->text [se->line_index [se->cursor_line - 1]], se->text [se->line_index [se->cursor_line]]);
+   append_source_edit_line(se->text [se->line_index [se->cursor_line - 1]], se->text [se->line_index [se->cursor_line]]);
 // now delete the current line:
    delete_lines(se, se->cursor_line, 1);
 // finally reduce cursor_line and run syntax highlighting:
@@ -2966,7 +3017,7 @@ static void cursor_etc_key(int key_press)
    }
    add_undo_remove_enter();
 // now copy next line to end of current line, and update it:
-   strcat(se->text [se->line_index [se->cursor_line]], se->text [se->line_index [se->cursor_line + 1]]);
+   append_source_edit_line(se->text [se->line_index [se->cursor_line]], se->text [se->line_index [se->cursor_line + 1]]);
 // now delete the next line:
    delete_lines(se, se->cursor_line + 1, 1);
 // finally run syntax highlighting:
@@ -3473,7 +3524,7 @@ TO DO:  put this code back in (with undo)
  se->text [se->line_index [start_line]] [start_pos] = '\0';
 // add end line to start line:
  char* end_line_end_pos = &se->text [se->line_index [end_line]] [end_pos];
- strcat(se->text [se->line_index [start_line]], end_line_end_pos);
+ append_source_edit_line(se->text [se->line_index [start_line]], end_line_end_pos);
 // strcat(se->text [se->line_index [start_line]], se->text [se->line_index [end_line]]);
 // delete end line:
  delete_lines(se, end_line, 1);
@@ -3525,11 +3576,13 @@ int is_something_selected(struct source_edit_struct* se)
 
 // returns pointer to currently open source_edit (based on which tab is open)
 // returns NULL if none open (e.g. current tab is not a source file)
+// also returns NULL if the current source_edit has no text allocated (see release_source_edit_struct())
 struct source_edit_struct* get_current_source_edit(void)
 {
 
 // current source_edit should really be a struct pointer in editor struct
- if (editor.current_source_edit_index == -1)
+ if (editor.current_source_edit_index == -1
+		|| editor.source_edit [editor.current_source_edit_index].text == NULL)
 		return NULL;
 
  return &editor.source_edit [editor.current_source_edit_index];
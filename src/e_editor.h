@@ -31,6 +31,9 @@ void open_overwindow(int ow_type);
 void init_source_edit_struct(struct source_edit_struct* se);
 void clear_source_edit_struct(struct source_edit_struct* se);
 void clear_source_edit_text(struct source_edit_struct* se);
+void release_source_edit_struct(struct source_edit_struct* se);
+void copy_source_edit_line(char* target_line, const char* source_text);
+void append_source_edit_line(char* target_line, const char* source_text);
 int source_to_editor(struct source_struct* src, int esource);
 
 void flush_game_event_queues(void);
@@ -317,6 +317,15 @@ struct loglinestruct
 };
 
 
+// Log lines that are written somewhere other than the log, then copied to the log later by flush_log_buffer() (in e_log.c).
+// Used by the compiler, which may be running outside the main thread.
+struct log_buffer_struct
+{
+ struct loglinestruct log_line [LOG_LINES]; // used in the same way as the log's log_line array (if more than LOG_LINES lines are written, the earliest are lost)
+ int lpos;
+ int lines_written; // number of lines finished since the buffer was last flushed
+};
+
 struct log_struct
 {
 
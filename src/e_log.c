@@ -44,6 +44,8 @@ void write_to_log(const char* str);
 void start_log_line(int mcol);
 void finish_log_line(void);
 void reset_log(void);
+static void write_to_log_line(struct loglinestruct* log_line, const char* str);
+static void write_number_to_log_line(struct loglinestruct* log_line, int num);
 
 int log_visible_line_mouseover(void);
 int log_visible_line_to_log_line(int visible_line);
@@ -129,9 +131,16 @@ void write_to_log(const char* str)
   start_log_line(source, source_line);
  }*/
 
+ write_to_log_line(&mlog.log_line[mlog.lpos], str);
+
+}
+
+static void write_to_log_line(struct loglinestruct* log_line, const char* str)
+{
+
  int max_length = LOG_LINE_LENGTH; // used to be mlog.w_letters
 
- int current_length = strlen(mlog.log_line[mlog.lpos].text);
+ int current_length = strlen(log_line->text);
 
  int space_left = max_length - current_length;
 
@@ -157,14 +166,14 @@ void write_to_log(const char* str)
    j ++;
    continue;
   }*/
-  mlog.log_line[mlog.lpos].text [i] = str [j];
+  log_line->text [i] = str [j];
   j ++;
   i ++;
   counter --;
  };
 
- mlog.log_line[mlog.lpos].text [i] = '\0';
- mlog.log_line[mlog.lpos].text [max_length - 1] = '\0';
+ log_line->text [i] = '\0';
+ log_line->text [max_length - 1] = '\0';
 
 }
 
@@ -183,7 +192,14 @@ void write_number_to_log(int num) //, int source, int source_line)
 
 //fpr("\n num %i", num);
 
- int current_length = strlen(mlog.log_line[mlog.lpos].text);
+ write_number_to_log_line(&mlog.log_line[mlog.lpos], num);
+
+}
+
+static void write_number_to_log_line(struct loglinestruct* log_line, int num)
+{
+
+ int current_length = strlen(log_line->text);
 
  int space_left = mlog.w_letters - current_length;
 
@@ -194,7 +210,7 @@ void write_number_to_log(int num) //, int source, int source_line)
  if (space_left <= strlen(num_str) + 1) // make sure number will fit on line
   return;
 
- strcat(mlog.log_line[mlog.lpos].text, num_str);
+ strcat(log_line->text, num_str);
 
 
 }
@@ -241,6 +257,106 @@ void write_line_to_log(char* str, int mcol)
  finish_log_line();
 }
 
+
+/*
+
+Log buffers
+
+These work like the log functions above, but write to a log_buffer_struct instead of the log.
+They don't use anything outside the buffer except mlog.w_letters (which is only changed by the main thread when the display is resized),
+ so they can be used outside the main thread. flush_log_buffer() must be called from the main thread.
+
+*/
+
+void clear_log_buffer(struct log_buffer_struct* lbuf)
+{
+
+ lbuf->lpos = 0;
+ lbuf->lines_written = 0;
+ lbuf->log_line[0].text [0] = '\0';
+
+}
+
+void start_log_buffer_line(struct log_buffer_struct* lbuf, int mcol)
+{
+
+ lbuf->log_line[lbuf->lpos].text [0] = '\0';
+ lbuf->log_line[lbuf->lpos].source_player_index = -1;
+ lbuf->log_line[lbuf->lpos].used = 1;
+ lbuf->log_line[lbuf->lpos].colour = mcol;
+
+}
+
+void set_log_buffer_line_source_position(struct log_buffer_struct* lbuf, int player_index, int template_index, int src_line)
+{
+
+	lbuf->log_line[lbuf->lpos].source_player_index = player_index;
+	lbuf->log_line[lbuf->lpos].source_template_index = template_index;
+	lbuf->log_line[lbuf->lpos].source_line = src_line;
+
+}
+
+void write_to_log_buffer(struct log_buffer_struct* lbuf, const char* str)
+{
+
+ write_to_log_line(&lbuf->log_line[lbuf->lpos], str);
+
+}
+
+void write_number_to_log_buffer(struct log_buffer_struct* lbuf, int num)
+{
+
+ write_number_to_log_line(&lbuf->log_line[lbuf->lpos], num);
+
+}
+
+void finish_log_buffer_line(struct log_buffer_struct* lbuf)
+{
+
+ lbuf->lpos ++;
+ if (lbuf->lpos >= LOG_LINES)
+  lbuf->lpos = 0;
+ lbuf->lines_written ++;
+
+}
+
+void write_line_to_log_buffer(struct log_buffer_struct* lbuf, char* str, int mcol)
+{
+ start_log_buffer_line(lbuf, mcol);
+ write_to_log_buffer(lbuf, str);
+ finish_log_buffer_line(lbuf);
+}
+
+// returns the line that was finished lines_ago lines before the most recent one (0 is the most recent).
+// lines_ago must be less than both LOG_LINES and lbuf->lines_written.
+struct loglinestruct* get_log_buffer_line(struct log_buffer_struct* lbuf, int lines_ago)
+{
+
+ return &lbuf->log_line[(lbuf->lpos + LOG_LINES - 1 - lines_ago) % LOG_LINES];
+
+}
+
+// copies the lines in lbuf to the log, in the order they were written, and clears lbuf.
+// Must be called from the main thread.
+void flush_log_buffer(struct log_buffer_struct* lbuf)
+{
+
+ int lines = lbuf->lines_written;
+ int i;
+
+ if (lines > LOG_LINES)
+		lines = LOG_LINES;
+
+ for (i = lines - 1; i >= 0; i --)
+	{
+		mlog.log_line[mlog.lpos] = *get_log_buffer_line(lbuf, i);
+		finish_log_line();
+	}
+
+ clear_log_buffer(lbuf);
+
+}
+
 // this function assumes target bitmap has been set
 void display_log(void)
 {
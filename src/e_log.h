@@ -33,6 +33,18 @@ void write_line_to_log(char* str, int mcol);
 
 void write_number_to_log(int num);
 
+struct log_buffer_struct;
+struct loglinestruct;
+void clear_log_buffer(struct log_buffer_struct* lbuf);
+void start_log_buffer_line(struct log_buffer_struct* lbuf, int mcol);
+void set_log_buffer_line_source_position(struct log_buffer_struct* lbuf, int player_index, int template_index, int src_line);
+void write_to_log_buffer(struct log_buffer_struct* lbuf, const char* str);
+void write_number_to_log_buffer(struct log_buffer_struct* lbuf, int num);
+void finish_log_buffer_line(struct log_buffer_struct* lbuf);
+void write_line_to_log_buffer(struct log_buffer_struct* lbuf, char* str, int mcol);
+struct loglinestruct* get_log_buffer_line(struct log_buffer_struct* lbuf, int lines_ago);
+void flush_log_buffer(struct log_buffer_struct* lbuf);
+
 void mouse_click_on_log_window(void);
 
 #endif
@@ -4,6 +4,7 @@
 #include <allegro5/allegro_native_dialog.h>
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "m_config.h"
@@ -16,8 +17,11 @@
 #include "g_misc.h"
 #include "g_world.h"
 #include "g_motion.h"
+#include "g_packet.h"
 #include "g_proc.h"
 #include "g_game.h"
+#include "g_method_std.h"
+#include "g_shapes.h"
 //#include "i_header.h"
 #include "i_console.h"
 #include "i_view.h"
@@ -29,7 +33,11 @@
 #include "e_editor.h"
 
 #include "s_mission.h"
+#include "h_mission.h"
+#include "h_story.h"
+#include "i_background.h"
 
+#include "f_save.h"
 #include "f_load.h"
 
 extern ALLEGRO_DISPLAY* display;
@@ -40,6 +48,9 @@ extern struct control_struct control;
 
 extern struct world_init_struct w_init;
 extern struct game_struct game;
+extern struct mission_state_struct mission_state;
+extern struct template_struct templ [PLAYERS] [TEMPLATES_PER_PLAYER];
+extern struct nshape_struct nshape [NSHAPES];
 
 
 #define WORLD_TIME_LIMIT (1<<30)
@@ -50,6 +61,22 @@ struct load_statestruct load_state;
 
 
 int load_game_from_file(void);
+static int load_section(int type, void* data, int record_size, int records);
+static int load_section_header(int type, int record_size, int records);
+static int verify_loaded_w_init(struct world_init_struct* loaded_w_init);
+static int verify_loaded_game(struct game_struct* loaded_game, int players);
+static int use_loaded_world(struct world_struct* loaded_world);
+static int verify_loaded_world(unsigned long long proc_base);
+static void verify_loaded_world_struct(void);
+static void verify_loaded_core(struct core_struct* core);
+static void verify_loaded_proc(struct proc_struct* proc, unsigned long long proc_base);
+static void verify_loaded_objects(struct object_struct* object, const char* name);
+static void verify_loaded_packet(struct packet_struct* pack);
+static void verify_loaded_blocks(void);
+static int use_loaded_templates(struct template_struct* loaded_templ);
+static void verify_loaded_template(struct template_struct* lt);
+static void verify_optional_index(int value, int max, const char* name);
+static int read_saved_game(void);
 int load_game_struct_from_file(void);
 int load_world_from_file(void);
 int load_world_properties_from_file(void);
@@ -90,68 +117,723 @@ void verify_any_value(int value, int min, int max, const char* name);
 // call this when load game item selected from game system menu
 // opens native file dialogue and loads file
 // writes to mlog on failure or error
+// on failure the present world may already have been deallocated (w.allocated will be 0 if so)
 int load_game(void)
 {
-/*
+
  if (!open_load_file("Open saved game", "*.*"))
   return 0;
 
- load_state.bp = -1; // means first entry read will be 0
- load_state.error = 0;
- load_state.current_buffer_size = 0;
+ if (!read_saved_game())
+  return 0;
 
-// we've started loading a world, so we may need to deallocate the present world:
- if (w.allocated == 1)
-  deallocate_world();
+ flush_game_event_queues(); // loading may have taken some time
+
+ return 1; // success!!
+
+}
+
+// like load_game(), but loads from file_path instead of asking for a file (used by the headless runner's save/load check - see m_headless.c)
+int load_game_from_path(const char* file_path)
+{
 
-// load first buffer:
- if (!read_load_buffer())
+ load_state.file = fopen(file_path, "rb");
+
+ if (!load_state.file)
  {
-  close_load_file();
+  write_line_to_log("Error: failed to open target file.", MLOG_COL_ERROR);
   return 0;
  }
 
+ return read_saved_game();
+
+}
+
+// reads a saved game from load_state.file, then closes it
+static int read_saved_game(void)
+{
+
+ load_state.bp = -1; // means first entry read will be 0
+ load_state.error = 0;
+ load_state.current_buffer_size = 0; // load_bytes() will read the first buffer
+
  if (!load_game_from_file())
  {
   close_load_file();
   return 0;
  }
 
- flush_game_event_queues(); // loading may have taken some time
-
  close_load_file();
  write_line_to_log("Save file loaded.", MLOG_COL_FILE);
 
-*/
- return 1; // success!!
+ return 1;
 
 }
 
 // call this as part of loading a game
 //  - does not initialise bp, so it can be called after other stuff (e.g. turn file details) has been read
+// reads the format described in f_save.h
 int load_game_from_file(void)
 {
-/*
- initialise_view(settings.option [OPTION_WINDOW_W], settings.option [OPTION_WINDOW_H]);
- init_consoles();
 
- if (!load_game_struct_from_file()
-  || !load_world_from_file()
-  || !load_view_from_file()
-  || !load_templates_from_file()
-  || !load_consoles_etc_from_file()
-  || !load_control_from_file())
+ struct save_file_header_struct header;
+ struct world_init_struct loaded_w_init;
+ struct game_struct loaded_game;
+ struct mission_state_struct loaded_mission_state;
+ struct world_struct* loaded_world = NULL;
+ struct template_struct* loaded_templ = NULL;
+ int i, p;
+
+ load_bytes(&header, sizeof(struct save_file_header_struct), "file header");
+
+ if (load_state.error == 1)
+  return 0;
+
+ if (strncmp(header.id, "LCsg", 4) != 0
+  || header.version != SAVE_FILE_VERSION
+  || header.sections != SAVE_SECTIONS)
  {
+  simple_load_error("not a saved game, or saved by a different version.");
   return 0;
  }
 
+// these are loaded into temporary structures so that nothing is changed if there's a problem with them:
+ if (!load_section(SAVE_SECTION_WORLD_INIT, &loaded_w_init, sizeof(struct world_init_struct), 1)
+  || !load_section(SAVE_SECTION_GAME, &loaded_game, sizeof(struct game_struct), 1)
+  || !load_section(SAVE_SECTION_MISSION_STATE, &loaded_mission_state, sizeof(struct mission_state_struct), 1)
+  || !verify_loaded_w_init(&loaded_w_init)
+  || !verify_loaded_game(&loaded_game, loaded_w_init.players))
+  return 0;
+
+ loaded_world = malloc(sizeof(struct world_struct));
+ loaded_templ = malloc(sizeof(struct template_struct) * PLAYERS * TEMPLATES_PER_PLAYER);
+
+ if (loaded_world == NULL
+  || loaded_templ == NULL)
+  simple_load_error("out of memory.");
+
  if (load_state.error == 1)
+  goto load_fail_keep_world;
+
+// from here on the present world is replaced. The new one is allocated at the saved size, then the saved arrays are loaded straight into it:
+ if (w.allocated == 1)
+  deallocate_world();
+
+ w_init = loaded_w_init;
+ new_world_from_world_init();
+
+ if (!load_section(SAVE_SECTION_WORLD, loaded_world, sizeof(struct world_struct), 1)
+  || !use_loaded_world(loaded_world))
+  goto load_fail;
+
+ load_section(SAVE_SECTION_CORES, w.core, sizeof(struct core_struct), w.max_cores);
+ load_section(SAVE_SECTION_PROCS, w.proc, sizeof(struct proc_struct), w.max_procs);
+ load_section(SAVE_SECTION_PROC_BOXES, w.proc_box, sizeof(struct proc_box_struct), w.max_procs);
+ load_section(SAVE_SECTION_PACKETS, w.packet, sizeof(struct packet_struct), w.max_packets);
+ load_section(SAVE_SECTION_CLOUDS, w.cloud, sizeof(struct cloud_struct), w.max_clouds);
+
+// block arrays are read a column at a time (see save_game_to_file()):
+ if (load_section_header(SAVE_SECTION_BLOCKS, sizeof(struct block_struct), w.blocks.x * w.blocks.y))
+ {
+  for (i = 0; i < w.blocks.x; i ++)
+  {
+   load_bytes(w.block [i], sizeof(struct block_struct) * w.blocks.y, "blocks");
+  }
+ }
+ if (load_section_header(SAVE_SECTION_BACKBLOCKS, sizeof(struct backblock_struct), w.blocks.x * w.blocks.y))
+ {
+  for (i = 0; i < w.blocks.x; i ++)
+  {
+   load_bytes(w.backblock [i], sizeof(struct backblock_struct) * w.blocks.y, "backblocks");
+  }
+ }
+ if (load_section_header(SAVE_SECTION_VISION_BLOCKS, sizeof(struct vision_block_struct), w.blocks.x * w.blocks.y))
+ {
+  for (i = 0; i < w.blocks.x; i ++)
+  {
+   load_bytes(w.vision_block [i], sizeof(struct vision_block_struct) * w.blocks.y, "vision blocks");
+  }
+ }
+ if (load_section_header(SAVE_SECTION_VISION_AREAS, sizeof(struct vision_area_struct), w.players * w.vision_areas_x * w.vision_areas_y))
+ {
+  for (p = 0; p < w.players; p ++)
+  {
+   for (i = 0; i < w.vision_areas_x; i ++)
+   {
+    load_bytes(w.vision_area [p] [i], sizeof(struct vision_area_struct) * w.vision_areas_y, "vision areas");
+   }
+  }
+ }
+
+ load_section(SAVE_SECTION_TEMPLATES, loaded_templ, sizeof(struct template_struct), PLAYERS * TEMPLATES_PER_PLAYER);
+ load_section_header(SAVE_SECTION_END, 0, 0);
+
+ if (load_state.error == 1
+  || !verify_loaded_world(header.proc_base)
+  || !use_loaded_templates(loaded_templ))
+  goto load_fail;
+
+ game = loaded_game;
+ game.watching = WATCH_OFF; // the bcode panel isn't saved
+ mission_state = loaded_mission_state;
+
+// the free bitmaps need to be rebuilt first, as the blocklist functions use them to find procs and packets
+ rebuild_free_bits();
+ rebuild_channel_listeners();
+// the saved blocklists contain pointers from the game that was saved, so they're rebuilt (the display uses them before the next tick):
+ rebuild_blocklists();
+ rebuild_packet_blocklists();
+
+ free(loaded_world);
+ free(loaded_templ);
+ return 1;
+
+load_fail:
+ deallocate_world(); // don't leave a partly loaded world around
+load_fail_keep_world:
+ free(loaded_world);
+ free(loaded_templ);
+ return 0;
+
+}
+
+// reads a section header and checks that it's what's expected, then loads the section's records into data.
+// returns 1 on success, 0 on failure (after writing an error to the log)
+static int load_section(int type, void* data, int record_size, int records)
+{
+
+ if (!load_section_header(type, record_size, records))
   return 0;
-*/
+
+ load_bytes(data, record_size * records, "section");
+
+ return (load_state.error == 0);
+
+}
+
+// like load_section(), but just reads and checks the header so that the calling function can load the records itself
+static int load_section_header(int type, int record_size, int records)
+{
+
+ struct save_section_header_struct section_header;
+
+ load_bytes(&section_header, sizeof(struct save_section_header_struct), "section header");
+
+ verify_any_value(section_header.type, type, type, "section type");
+ verify_any_value(section_header.record_size, record_size, record_size, "section record size");
+ verify_any_value(section_header.records, records, records, "section records");
+
+ return (load_state.error == 0);
+
+}
+
+// w_init is used to allocate the new world, so it's checked before anything else
+static int verify_loaded_w_init(struct world_init_struct* loaded_w_init)
+{
+
+ int i;
+
+ verify_any_value(loaded_w_init->players, 1, PLAYERS, "w_init.players");
+ verify_any_value(loaded_w_init->core_setting, 0, 3, "w_init.core_setting");
+ verify_any_value(loaded_w_init->map_size_blocks, 1, MAXIMUM_BLOCK_SIZE, "w_init.map_size_blocks");
+
+ for (i = 0; i < PLAYERS; i ++)
+ {
+  loaded_w_init->player_name [i] [PLAYER_NAME_LENGTH - 1] = '\0';
+ }
+
+ return (load_state.error == 0);
+
+}
+
+// checks the values in the game_struct that are used as array indices
+static int verify_loaded_game(struct game_struct* loaded_game, int players)
+{
+
+ verify_any_value(loaded_game->phase, 0, GAME_PHASES - 1, "game.phase");
+ verify_any_value(loaded_game->type, 0, GAME_TYPES - 1, "game.type");
+ verify_any_value(loaded_game->story_type, 0, STORY_TYPES - 1, "game.story_type");
+ verify_any_value(loaded_game->area_index, 0, STORY_AREAS - 1, "game.area_index");
+ verify_any_value(loaded_game->user_player_index, 0, players - 1, "game.user_player_index");
+ verify_any_value(loaded_game->fast_forward_type, 0, FAST_FORWARD_TYPES - 1, "game.fast_forward_type");
+ verify_any_value(loaded_game->game_over_status, 0, GAME_END_STATES - 1, "game.game_over_status");
+ if (loaded_game->type == GAME_TYPE_MISSION)
+ {
+  verify_any_value(loaded_game->mission_index, 0, MISSIONS - 1, "game.mission_index");
+  verify_any_value(loaded_game->region_index, 0, STORY_REGIONS - 1, "game.region_index");
+ }
+
+ return (load_state.error == 0);
+
+}
+
+// copies the saved world_struct into w, keeping w's own arrays
+static int use_loaded_world(struct world_struct* loaded_world)
+{
+
+ int i;
+
+ verify_any_value(loaded_world->players, w.players, w.players, "w.players");
+ verify_any_value(loaded_world->max_cores, w.max_cores, w.max_cores, "w.max_cores");
+ verify_any_value(loaded_world->max_procs, w.max_procs, w.max_procs, "w.max_procs");
+ verify_any_value(loaded_world->max_packets, w.max_packets, w.max_packets, "w.max_packets");
+ verify_any_value(loaded_world->max_clouds, w.max_clouds, w.max_clouds, "w.max_clouds");
+ verify_any_value(loaded_world->cores_per_player, w.cores_per_player, w.cores_per_player, "w.cores_per_player");
+ verify_any_value(loaded_world->procs_per_player, w.procs_per_player, w.procs_per_player, "w.procs_per_player");
+ verify_any_value(loaded_world->blocks.x, w.blocks.x, w.blocks.x, "w.blocks.x");
+ verify_any_value(loaded_world->blocks.y, w.blocks.y, w.blocks.y, "w.blocks.y");
+ verify_any_value(loaded_world->vision_areas_x, w.vision_areas_x, w.vision_areas_x, "w.vision_areas_x");
+ verify_any_value(loaded_world->vision_areas_y, w.vision_areas_y, w.vision_areas_y, "w.vision_areas_y");
+ verify_any_value(loaded_world->fragment_count, 0, FRAGMENTS, "w.fragment_count");
+ verify_any_value(loaded_world->data_wells, 0, DATA_WELLS, "w.data_wells");
+
+ for (i = 0; i < w.players; i ++)
+ {
+  verify_any_value(loaded_world->player[i].core_index_start, w.player[i].core_index_start, w.player[i].core_index_start, "core_index_start");
+  verify_any_value(loaded_world->player[i].proc_index_start, w.player[i].proc_index_start, w.player[i].proc_index_start, "proc_index_start");
+  verify_any_value(loaded_world->player[i].core_index_end, w.player[i].core_index_end, w.player[i].core_index_end, "core_index_end");
+  verify_any_value(loaded_world->player[i].proc_index_end, w.player[i].proc_index_end, w.player[i].proc_index_end, "proc_index_end");
+ }
+
+ if (load_state.error == 1)
+  return 0;
+
+ if (loaded_world->grand_state == 0)
+  loaded_world->grand_state = w.grand_state; // grand() needs a nonzero state
+
+#ifdef USE_DYNAMIC_MEMORY
+// when adding a pointer to the world_struct, remember to add it here as well
+ loaded_world->core = w.core;
+ loaded_world->proc = w.proc;
+ loaded_world->proc_box = w.proc_box;
+ loaded_world->packet = w.packet;
+ loaded_world->cloud = w.cloud;
+ loaded_world->block = w.block;
+ loaded_world->backblock = w.backblock;
+ loaded_world->vision_block = w.vision_block;
+ for (i = 0; i < PLAYERS; i ++)
+ {
+  loaded_world->vision_area [i] = w.vision_area [i];
+ }
+ for (i = 0; i < CHANNELS; i ++)
+ {
+  loaded_world->channel_listener [i] = w.channel_listener [i];
+ }
+ loaded_world->core_free_bits = w.core_free_bits;
+ loaded_world->proc_free_bits = w.proc_free_bits;
+ loaded_world->packet_free_bits = w.packet_free_bits;
+#endif
+
+ loaded_world->allocated = 1;
+
+ w = *loaded_world;
+
  return 1;
 
 }
 
+// checks every value restored from the file that is used as an array index (by the game or the display), and fixes pointers.
+// (other values aren't checked, so a damaged file may still cause strange behaviour, but it shouldn't cause anything out of bounds to be read or written)
+// proc_base is the address of w.proc [0] when the game was saved
+static int verify_loaded_world(unsigned long long proc_base)
+{
+
+ int c, p, pk, i;
+
+ verify_loaded_world_struct();
+
+ for (c = 0; c < w.max_cores; c ++)
+ {
+  verify_any_value(w.core [c].index, c, c, "core index");
+  if (load_state.error == 1)
+   return 0;
+  verify_loaded_core(&w.core [c]);
+ }
+
+ for (p = 0; p < w.max_procs; p ++)
+ {
+  verify_any_value(w.proc [p].index, p, p, "proc index");
+  if (load_state.error == 1)
+   return 0;
+  verify_loaded_proc(&w.proc [p], proc_base);
+  w.proc_box [p].blocklist_down = -1; // rebuilt with the blocklists
+ }
+
+ for (pk = 0; pk < w.max_packets; pk ++)
+ {
+  verify_any_value(w.packet [pk].index, pk, pk, "packet index");
+  verify_loaded_packet(&w.packet [pk]);
+ }
+
+// clouds are display effects that only last a moment, and their data means something different for each type of cloud (often an index),
+//  so they aren't restored:
+ for (i = 0; i < w.max_clouds; i ++)
+ {
+  w.cloud [i].exists = 0;
+  w.cloud [i].created_timestamp = 0;
+  w.cloud [i].lifetime = 0;
+  w.cloud [i].destruction_timestamp = 0; // this is what new_cloud() and the display check
+  w.cloud [i].index = i;
+ }
+
+ verify_loaded_blocks();
+
+ return (load_state.error == 0);
+
+}
+
+// checks the world_struct fields that aren't checked by use_loaded_world()
+static void verify_loaded_world_struct(void)
+{
+
+ int i, j;
+
+ verify_any_value(w.story_area, 0, STORY_AREAS - 1, "w.story_area");
+
+ for (i = 0; i < w.players; i ++)
+ {
+  w.player[i].name [PLAYER_NAME_LENGTH - 1] = '\0';
+  for (j = 0; j < BUILD_QUEUE_LENGTH; j ++)
+  {
+   if (!w.player[i].build_queue[j].active)
+    continue;
+   verify_any_value(w.player[i].build_queue[j].core_index, w.player[i].core_index_start, w.player[i].core_index_end - 1, "build queue core_index");
+   verify_any_value(w.player[i].build_queue[j].template_index, 0, TEMPLATES_PER_PLAYER - 1, "build queue template_index");
+  }
+ }
+
+ for (i = 0; i < w.data_wells; i ++)
+ {
+  verify_any_value(w.data_well[i].block_position.x, 0, w.blocks.x - 1, "data well block_position.x");
+  verify_any_value(w.data_well[i].block_position.y, 0, w.blocks.y - 1, "data well block_position.y");
+  verify_any_value(w.data_well[i].data_max, 1, 1000000, "data well data_max");
+  verify_any_value(w.data_well[i].reserve_squares, 0, 8, "data well reserve_squares"); // the display draws this many squares
+ }
+
+ for (i = 0; i < FRAGMENTS; i ++)
+ {
+  verify_any_value(w.fragment[i].colour, 0, PLAYERS - 1, "fragment colour");
+ }
+
+}
+
+static void verify_loaded_core(struct core_struct* core)
+{
+
+ int i;
+ int c = core->index;
+
+// vision is unstamped after a core is destroyed, so this is checked whether or not the core exists:
+ if (core->vision_stamped)
+ {
+  verify_any_value(core->vision_block_x, 0, w.blocks.x - 1, "core vision_block_x");
+  verify_any_value(core->vision_block_y, 0, w.blocks.y - 1, "core vision_block_y");
+ }
+
+ core->core_blocklist_down = -1; // rebuilt with the blocklists
+
+ if (core->exists == 0)
+  return;
+
+ int player_index = c / w.cores_per_player;
+
+ verify_any_value(core->player_index, player_index, player_index, "core player_index");
+ verify_any_value(core->template_index, 0, TEMPLATES_PER_PLAYER - 1, "core template_index");
+ verify_any_value(core->process_index, w.player[player_index].proc_index_start, w.player[player_index].proc_index_end - 1, "core process_index");
+ verify_any_value(core->group_members_max, 1, GROUP_MAX_MEMBERS, "core group_members_max");
+ block_cart position_block = cart_to_block(core->core_position); // used by add_core_to_blocklist()
+ verify_any_value(position_block.x, 0, w.blocks.x - 1, "core position.x");
+ verify_any_value(position_block.y, 0, w.blocks.y - 1, "core position.y");
+ verify_optional_index(core->contact_core_index, w.max_cores, "core contact_core_index");
+ verify_optional_index(core->damage_source_core_index, w.max_cores, "core damage_source_core_index");
+ verify_optional_index(core->first_build_object_member, GROUP_MAX_MEMBERS, "core first_build_object_member");
+ if (core->first_build_object_member != -1)
+  verify_any_value(core->first_build_object_link, 0, MAX_LINKS - 1, "core first_build_object_link");
+ verify_optional_index(core->first_repair_object_member, GROUP_MAX_MEMBERS, "core first_repair_object_member");
+ if (core->first_repair_object_member != -1)
+  verify_any_value(core->first_repair_object_link, 0, MAX_LINKS - 1, "core first_repair_object_link");
+ verify_any_value(core->bubble_text_length, 0, BUBBLE_TEXT_LENGTH_MAX - 1, "core bubble_text_length");
+ core->bubble_text [BUBBLE_TEXT_LENGTH_MAX - 1] = '\0';
+
+ if (load_state.error == 1)
+  return;
+
+ for (i = 0; i < core->group_members_max; i ++)
+ {
+  if (core->group_member[i].index != -1) // -1 means no member here
+   verify_any_value(core->group_member[i].index, w.player[player_index].proc_index_start, w.player[player_index].proc_index_end - 1, "core group member index");
+ }
+
+ for (i = 0; i < COMMAND_QUEUE; i ++)
+ {
+  if (core->command_queue[i].type == COM_NONE)
+   continue; // the other fields may not have been set
+  verify_optional_index(core->command_queue[i].target_core, w.max_cores, "command target_core");
+  if (core->command_queue[i].target_core != -1)
+   verify_any_value(core->command_queue[i].target_member, 0, GROUP_MAX_MEMBERS - 1, "command target_member");
+ }
+
+ verify_any_value(core->messages_received, 0, MESSAGES, "core messages_received");
+ if (load_state.error == 1)
+  return;
+ verify_any_value(core->message_reading, -1, core->messages_received, "core message_reading");
+ verify_any_value(core->message_position, 0, MESSAGE_LENGTH, "core message_position");
+
+ for (i = 0; i < core->messages_received; i ++)
+ {
+  verify_any_value(core->message[i].length, 0, MESSAGE_LENGTH, "message length");
+  verify_any_value(core->message[i].channel, 0, CHANNELS - 1, "message channel");
+  verify_optional_index(core->message[i].source_index, w.max_cores, "message source_index");
+  verify_optional_index(core->message[i].target_core_index, w.max_cores, "message target_core_index");
+ }
+
+}
+
+static void verify_loaded_proc(struct proc_struct* proc, unsigned long long proc_base)
+{
+
+ int i, connected_proc_index;
+ unsigned long long ptr_value;
+ int p = proc->index;
+
+ verify_any_value(proc->shape, 0, NSHAPES - 1, "proc shape");
+ if (load_state.error == 1)
+  return;
+ proc->nshape_ptr = &nshape [proc->shape];
+ proc->blocklist_up = NULL;
+ proc->blocklist_down = NULL;
+
+ for (i = 0; i < GROUP_CONNECTIONS; i ++)
+ {
+  if (proc->group_connection_ptr [i] == NULL)
+   continue;
+// group connections can point to reserved (destroyed but restorable) procs, so they're converted to indices whether or not this proc exists:
+  ptr_value = (unsigned long long) (size_t) proc->group_connection_ptr [i];
+  if (ptr_value < proc_base
+   || (ptr_value - proc_base) % sizeof(struct proc_struct) != 0)
+   connected_proc_index = -1;
+    else
+     connected_proc_index = (ptr_value - proc_base) / sizeof(struct proc_struct);
+  verify_any_value(connected_proc_index, 0, w.max_procs - 1, "proc group connection");
+  if (load_state.error == 1)
+   return;
+  proc->group_connection_ptr [i] = &w.proc [connected_proc_index];
+ }
+
+ if (proc->exists == 0
+  && proc->reserved == 0)
+  return;
+
+ int player_index = p / w.procs_per_player;
+
+ verify_any_value(proc->player_index, player_index, player_index, "proc player_index");
+ verify_any_value(proc->core_index, w.player[player_index].core_index_start, w.player[player_index].core_index_end - 1, "proc core_index");
+ verify_any_value(proc->group_member_index, 0, GROUP_MAX_MEMBERS - 1, "proc group_member_index");
+ verify_any_value(proc->block_position.x, 0, w.blocks.x - 1, "proc block_position.x");
+ verify_any_value(proc->block_position.y, 0, w.blocks.y - 1, "proc block_position.y");
+// rebuild_blocklists() works out the block of each proc that exists from its position:
+ if (proc->exists == 1)
+ {
+  block_cart position_block = cart_to_block(proc->position);
+  verify_any_value(position_block.x, 0, w.blocks.x - 1, "proc position.x");
+  verify_any_value(position_block.y, 0, w.blocks.y - 1, "proc position.y");
+ }
+ verify_any_value(proc->number_of_group_connections, 0, GROUP_CONNECTIONS, "proc number_of_group_connections");
+
+ for (i = 0; i < GROUP_CONNECTIONS; i ++)
+ {
+  if (proc->group_connection_ptr [i] == NULL)
+   continue;
+  verify_any_value(proc->connected_from [i], 0, GROUP_CONNECTIONS - 1, "proc connected_from");
+  verify_any_value(proc->connection_link [i], 0, proc->nshape_ptr->links - 1, "proc connection_link");
+  verify_any_value(proc->connected_from_link [i], 0, MAX_LINKS - 1, "proc connected_from_link");
+ }
+
+ verify_loaded_objects(proc->object, "proc");
+
+}
+
+// checks the object array of a proc or a template member
+static void verify_loaded_objects(struct object_struct* object, const char* name)
+{
+
+ int i, j;
+
+ for (i = 0; i < MAX_LINKS; i ++)
+ {
+  verify_any_value(object[i].type, 0, OBJECT_TYPES - 1, name);
+  for (j = 0; j < CLASSES_PER_OBJECT; j ++)
+  {
+   verify_optional_index(object[i].object_class [j], OBJECT_CLASSES, name);
+  }
+  verify_optional_index(object[i].next_similar_object_member, GROUP_MAX_MEMBERS, name);
+  if (object[i].next_similar_object_member != -1)
+   verify_any_value(object[i].next_similar_object_link, 0, MAX_LINKS - 1, name);
+ }
+
+}
+
+static void verify_loaded_packet(struct packet_struct* pack)
+{
+
+ pack->blocklist_up = NULL;
+ pack->blocklist_down = NULL;
+
+ if (pack->exists == 0)
+  return;
+
+ verify_any_value(pack->type, 0, PACKET_TYPES - 1, "packet type");
+ verify_any_value(pack->player_index, 0, w.players - 1, "packet player_index");
+ verify_any_value(pack->colour, 0, PLAYERS - 1, "packet colour");
+ verify_any_value(pack->block_position.x, 0, w.blocks.x - 1, "packet block_position.x");
+ verify_any_value(pack->block_position.y, 0, w.blocks.y - 1, "packet block_position.y");
+ verify_optional_index(pack->source_core_index, w.max_cores, "packet source_core_index");
+ verify_optional_index(pack->source_proc, w.max_procs, "packet source_proc");
+
+ switch(pack->type)
+ {
+  case PACKET_TYPE_SPIKE1:
+  case PACKET_TYPE_SPIKE2:
+  case PACKET_TYPE_SPIKE3:
+   verify_optional_index(pack->status, w.max_clouds, "packet status"); // status is the index of the packet's latest trail cloud
+   break;
+ }
+
+}
+
+// checks block types and backblock values, and clears the saved blocklists (rebuild_blocklists() and rebuild_packet_blocklists() fill them in again)
+static void verify_loaded_blocks(void)
+{
+
+ int x, y, k;
+ struct block_struct* bl;
+ struct backblock_struct* backbl;
+
+ for (x = 0; x < w.blocks.x; x ++)
+ {
+  for (y = 0; y < w.blocks.y; y ++)
+  {
+   bl = &w.block [x] [y];
+   verify_any_value(bl->block_type, 0, BLOCK_TYPES - 1, "block type");
+// the rebuild functions increment the tags, so setting the tags to the current values means that none of these lists will be used:
+   bl->tag = w.blocktag;
+   bl->blocklist_down = NULL;
+   bl->core_tag = w.blocktag;
+   bl->core_down = -1;
+   bl->packet_tag = w.packet_blocktag;
+   bl->packet_down = NULL;
+   backbl = &w.backblock [x] [y];
+   verify_any_value(backbl->backblock_type, 0, BACKBLOCK_TYPES - 1, "backblock type");
+   if (backbl->backblock_type == BACKBLOCK_DATA_WELL
+    || backbl->backblock_type == BACKBLOCK_DATA_WELL_EDGE)
+    verify_any_value(backbl->backblock_value, 0, w.data_wells - 1, "backblock data well");
+   for (k = 0; k < BLOCK_NODES; k ++)
+   {
+    verify_any_value(backbl->node_depth [k], 0, BACKBLOCK_LAYERS - 1, "backblock node_depth");
+    verify_any_value(backbl->node_team_col [k], 0, PLAYERS - 1, "backblock node_team_col");
+    verify_any_value(backbl->node_new_colour [k], 0, PLAYERS - 1, "backblock node_new_colour");
+    verify_any_value(backbl->node_col_saturation [k], 0, BACK_COL_SATURATIONS - 1, "backblock node_col_saturation");
+    verify_any_value(backbl->node_new_saturation [k], 0, BACK_COL_SATURATIONS - 1, "backblock node_new_saturation");
+   }
+   if (load_state.error == 1)
+    return;
+  }
+ }
+
+}
+
+// for indices that can be -1 to mean none
+static void verify_optional_index(int value, int max, const char* name)
+{
+
+ verify_any_value(value, -1, max - 1, name);
+
+}
+
+// copies the loaded templates into templ, keeping each template's link to the editor
+static int use_loaded_templates(struct template_struct* loaded_templ)
+{
+
+ int p, t;
+ struct template_struct* lt;
+
+ for (p = 0; p < PLAYERS; p ++)
+ {
+  for (t = 0; t < TEMPLATES_PER_PLAYER; t ++)
+  {
+   lt = &loaded_templ [(p * TEMPLATES_PER_PLAYER) + t];
+   verify_any_value(lt->player_index, p, p, "template player_index");
+   verify_any_value(lt->template_index, t, t, "template template_index");
+   verify_loaded_template(lt);
+  }
+ }
+
+ if (load_state.error == 1)
+  return 0;
+
+ for (p = 0; p < PLAYERS; p ++)
+ {
+  for (t = 0; t < TEMPLATES_PER_PLAYER; t ++)
+  {
+   lt = &loaded_templ [(p * TEMPLATES_PER_PLAYER) + t];
+   lt->source_edit = templ[p][t].source_edit;
+   lt->esource_index = templ[p][t].esource_index;
+   templ[p][t] = *lt;
+  }
+ }
+
+ return 1;
+
+}
+
+static void verify_loaded_template(struct template_struct* lt)
+{
+
+ int i, j;
+
+ lt->name [TEMPLATE_NAME_LENGTH - 1] = '\0';
+ lt->menu_button_title [TEMPLATE_BUTTON_TITLE_STRING_LENGTH - 1] = '\0';
+
+ for (i = 0; i < OBJECT_CLASSES; i ++)
+ {
+  lt->object_class_name [i] [CLASS_NAME_LENGTH - 1] = '\0';
+  for (j = 0; j < OBJECT_CLASS_SIZE; j ++)
+  {
+   verify_optional_index(lt->object_class_member [i] [j], GROUP_MAX_MEMBERS, "template object_class_member");
+   verify_optional_index(lt->object_class_object [i] [j], MAX_LINKS, "template object_class_object");
+  }
+ }
+
+ if (!lt->active)
+  return;
+
+ verify_optional_index(lt->first_build_object_member, GROUP_MAX_MEMBERS, "template first_build_object_member");
+ if (lt->first_build_object_member != -1)
+  verify_any_value(lt->first_build_object_link, 0, MAX_LINKS - 1, "template first_build_object_link");
+ verify_optional_index(lt->first_repair_object_member, GROUP_MAX_MEMBERS, "template first_repair_object_member");
+ if (lt->first_repair_object_member != -1)
+  verify_any_value(lt->first_repair_object_link, 0, MAX_LINKS - 1, "template first_repair_object_link");
+
+ for (i = 0; i < GROUP_MAX_MEMBERS; i ++)
+ {
+  if (!lt->member[i].exists)
+   continue;
+  verify_any_value(lt->member[i].shape, 0, NSHAPES - 1, "template member shape");
+  if (load_state.error == 1)
+   return;
+  verify_loaded_objects(lt->member[i].object, "template member object");
+  for (j = 0; j < GROUP_CONNECTIONS; j ++)
+  {
+   verify_optional_index(lt->member[i].connection[j].template_member_index, GROUP_MAX_MEMBERS, "template connection member");
+   if (lt->member[i].connection[j].template_member_index == -1)
+    continue;
+   verify_any_value(lt->member[i].connection[j].link_index, 0, nshape[lt->member[i].shape].links - 1, "template connection link");
+   verify_any_value(lt->member[i].connection[j].reverse_connection_index, 0, GROUP_CONNECTIONS - 1, "template reverse connection");
+   verify_any_value(lt->member[i].connection[j].reverse_link_index, 0, MAX_LINKS - 1, "template reverse link");
+  }
+ }
+
+}
 
 int load_game_struct_from_file(void)
 {
@@ -286,6 +968,9 @@ int load_world_properties_from_file(void)
 
  load_unsigned_int(&w.world_time, 0, WORLD_TIME_LIMIT, "world time");
  load_unsigned_int(&w.total_time, 0, WORLD_TIME_LIMIT, "total time");
+ load_unsigned_int_unchecked(&w.grand_state, "random number state");
+ if (w.grand_state == 0)
+  w.grand_state = 1;
 
 // These values are currently set up when loading programs from templates, which won't be done when loading a file.
 // Need to initialise properly. ??? <- I can't remember what this comment means now
@@ -1725,13 +2410,9 @@ void load_colours(int* cols, const char* name)
 
 void load_int(int* value, int min, int max, const char* name)
 {
- int loaded [4];
-// char cvalues [4];
+ unsigned char loaded [4];
 
- loaded[0] = load_8b(name);
- loaded[1] = load_8b(name);
- loaded[2] = load_8b(name);
- loaded[3] = load_8b(name);
+ load_bytes(loaded, 4, name);
 
  *value = (loaded[0] * (1<<24)) + (loaded[1] * (1<<16)) + (loaded[2] * (1<<8)) + (loaded[3]);
 
@@ -1748,13 +2429,9 @@ void load_int(int* value, int min, int max, const char* name)
 // just like int but unsigned
 void load_unsigned_int(unsigned int* value, int min, int max, const char* name)
 {
- int loaded [4];
-// char cvalues [4];
+ unsigned char loaded [4];
 
- loaded[0] = load_8b(name);
- loaded[1] = load_8b(name);
- loaded[2] = load_8b(name);
- loaded[3] = load_8b(name);
+ load_bytes(loaded, 4, name);
 
 /* if (!loaded[0]
   || !loaded[1]
@@ -1777,13 +2454,9 @@ void load_unsigned_int(unsigned int* value, int min, int max, const char* name)
 
 void load_int_unchecked(int* value, const char* name)
 {
- int loaded [4];
-// char cvalues [4];
+ unsigned char loaded [4];
 
- loaded[0] = load_8b(name);
- loaded[1] = load_8b(name);
- loaded[2] = load_8b(name);
- loaded[3] = load_8b(name);
+ load_bytes(loaded, 4, name);
 
 /* if (!loaded[0]
   || !loaded[1]
@@ -1798,13 +2471,9 @@ void load_int_unchecked(int* value, const char* name)
 
 void load_unsigned_int_unchecked(unsigned int* value, const char* name)
 {
- int loaded [4];
-// char cvalues [4];
+ unsigned char loaded [4];
 
- loaded[0] = load_8b(name);
- loaded[1] = load_8b(name);
- loaded[2] = load_8b(name);
- loaded[3] = load_8b(name);
+ load_bytes(loaded, 4, name);
 
 /* if (!loaded[0]
   || !loaded[1]
@@ -1819,11 +2488,9 @@ void load_unsigned_int_unchecked(unsigned int* value, const char* name)
 
 void load_short(s16b* value, int check_min_max, int min, int max, const char* name)
 {
- int loaded [2];
-// char cvalues [2];
+ unsigned char loaded [2];
 
- loaded[0] = load_8b(name);
- loaded[1] = load_8b(name);
+ load_bytes(loaded, 2, name);
 
 /* if (!loaded[0]
   || !loaded[1])
@@ -1844,16 +2511,12 @@ void load_short(s16b* value, int check_min_max, int min, int max, const char* na
 
 void load_fixed(al_fixed* value, int check_min_max, al_fixed min, al_fixed max, const char* name)
 {
- int loaded [4];
-// char cvalues [4];
+ unsigned char loaded [4];
 
  min = al_fixsub(min, 1); // give fixed values a little bit of leeway
  max = al_fixadd(max, 1);
 
- loaded[0] = load_8b(name);
- loaded[1] = load_8b(name);
- loaded[2] = load_8b(name);
- loaded[3] = load_8b(name);
+ load_bytes(loaded, 4, name);
 
 /* if (!loaded[0]
   || !loaded[1]
@@ -1885,10 +2548,7 @@ void load_string(char* str, int length, int accept_line_breaks, const char* name
 
  int i;
 
- for (i = 0; i < length; i ++)
- {
-  load_char(str+i, name);
- }
+ load_bytes(str, length, name);
 
  if (load_state.error == 1)
   return;
@@ -1960,6 +2620,65 @@ int load_8b(const char* name)
 
 }
 
+// copies the next length bytes of the file into data, reading more of the file into the buffer as needed.
+// anything at least as big as the buffer is read straight from the file.
+// on failure, sets load_state.error, writes an error to the log and fills the rest of data with zeros
+void load_bytes(void* data, int length, const char* name)
+{
+
+ char* bytes = data;
+ int available, read_in;
+
+ while (length > 0)
+ {
+  if (load_state.error == 1)
+  {
+   memset(bytes, 0, length); // fail silently (an error message should already have been written)
+   return;
+  }
+
+  available = load_state.current_buffer_size - (load_state.bp + 1);
+
+  if (available > 0)
+  {
+   if (available > length)
+    available = length;
+   memcpy(bytes, &load_state.buffer [load_state.bp + 1], available);
+   load_state.bp += available;
+   bytes += available;
+   length -= available;
+   continue;
+  }
+
+// the buffer has been used up:
+  if (length >= LOAD_BUFFER_SIZE)
+  {
+   read_in = fread(bytes, 1, length, load_state.file);
+   bytes += read_in;
+   length -= read_in;
+   if (length == 0)
+    return;
+   write_line_to_log("Error: file read failed.", MLOG_COL_ERROR);
+   load_state.error = 1;
+  }
+   else
+   {
+    if (read_load_buffer()) // read_buffer should display its own error message
+    {
+     load_state.bp = -1;
+     continue;
+    }
+   }
+
+  start_log_line(MLOG_COL_ERROR);
+  write_to_log("While reading ");
+  write_to_log(name);
+  write_to_log(".");
+  finish_log_line();
+ }
+
+}
+
 // loads an int and converts it to a pointer to proc[loaded value] (or NULL if value is -1)
 void load_proc_pointer(struct proc_struct** pr, const char* name)
 {
@@ -18,6 +18,7 @@ struct load_statestruct
 
 
 int load_game(void);
+int load_game_from_path(const char* file_path);
 
 void load_template(int t, int load_basic_template_details);
 
@@ -31,6 +32,7 @@ void load_string(char* str, int length, int accept_line_breaks, const char* name
 void load_char(char* value, const char* name);
 //int load_8b(char* value, const char* name);
 int load_8b(const char* name);
+void load_bytes(void* data, int length, const char* name);
 void load_proc_pointer(struct proc_struct** pr, const char* name);
 void load_packet_pointer(struct packet_struct** pk, const char* name);
 void load_object_coordinates(al_fixed* x, al_fixed* y, const char* name);
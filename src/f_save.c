@@ -16,12 +16,16 @@
 
 #include "e_log.h"
 #include "e_editor.h"
+#include "h_mission.h"
 
 #include "f_save.h"
 
 extern ALLEGRO_DISPLAY* display; // used to display the native file dialog
 
 extern struct game_struct game;
+extern struct world_init_struct w_init;
+extern struct mission_state_struct mission_state;
+extern struct template_struct templ [PLAYERS] [TEMPLATES_PER_PLAYER];
 extern struct view_struct view;
 //extern struct templstruct templ [TEMPLATES]; // see t_template.c
 //extern struct consolestruct console [CONSOLES];
@@ -53,6 +57,9 @@ Format:
 */
 
 int save_game_to_file(void);
+static int write_saved_game(void);
+static void save_section(int type, const void* data, int record_size, int records);
+static void save_section_header(int type, int record_size, int records);
 
 int save_game_struct_to_file(void);
 int save_world_to_file(void);
@@ -100,45 +107,141 @@ void save_game(void)
  if (!open_save_file("Save game", "*.sav"))
   return;
 
+ write_saved_game();
+
+ flush_game_event_queues(); // opening may have taken some time
+
+}
+
+// like save_game(), but saves to file_path instead of asking for a file (used by the headless runner's save/load check - see m_headless.c)
+// returns 1 on success, 0 on failure
+int save_game_to_path(const char* file_path)
+{
+
+ save_state.file = fopen(file_path, "wb");
+
+ if (!save_state.file)
+ {
+  write_line_to_log("Error: failed to open target file.", MLOG_COL_ERROR);
+  return 0;
+ }
+
+ return write_saved_game();
+
+}
+
+// writes the game to save_state.file, then closes it
+static int write_saved_game(void)
+{
+
  save_state.bp = 0;
  save_state.error = 0;
 
  if (!save_game_to_file())
  {
   close_save_file();
-  return;
+  return 0;
  }
 
  if (save_state.bp != 0) // is probably something left in the buffer
   write_save_buffer();
 
- flush_game_event_queues(); // opening may have taken some time
-
  close_save_file();
+
+ if (save_state.error == 1)
+  return 0; // write_save_buffer() will have written an error message
+
  write_line_to_log("Game saved.", MLOG_COL_FILE);
- return; // success!
+ return 1; // success!
 
 }
 
 // call this as part of saving a game
 //  - does not initialise bp, so it can be called after other stuff (e.g. turn file details) is written
+// writes the format described in f_save.h
 int save_game_to_file(void)
 {
 
- if (!save_game_struct_to_file()
-  || !save_world_to_file()
-  || !save_view_to_file()
-  || !save_templates_to_file()
-  || !save_consoles_etc_to_file()
-  || !save_control_to_file())
- {
+ struct save_file_header_struct header;
+ int i, p;
+
+ memset(&header, 0, sizeof(struct save_file_header_struct));
+ header.id [0] = 'L';
+ header.id [1] = 'C';
+ header.id [2] = 's';
+ header.id [3] = 'g';
+ header.version = SAVE_FILE_VERSION;
+ header.sections = SAVE_SECTIONS;
+ header.proc_base = (unsigned long long) (size_t) &w.proc [0];
+
+ save_bytes(&header, sizeof(struct save_file_header_struct));
+
+ save_section(SAVE_SECTION_WORLD_INIT, &w_init, sizeof(struct world_init_struct), 1);
+ save_section(SAVE_SECTION_GAME, &game, sizeof(struct game_struct), 1);
+ save_section(SAVE_SECTION_MISSION_STATE, &mission_state, sizeof(struct mission_state_struct), 1);
+ save_section(SAVE_SECTION_WORLD, &w, sizeof(struct world_struct), 1);
+ save_section(SAVE_SECTION_CORES, w.core, sizeof(struct core_struct), w.max_cores);
+ save_section(SAVE_SECTION_PROCS, w.proc, sizeof(struct proc_struct), w.max_procs);
+ save_section(SAVE_SECTION_PROC_BOXES, w.proc_box, sizeof(struct proc_box_struct), w.max_procs);
+ save_section(SAVE_SECTION_PACKETS, w.packet, sizeof(struct packet_struct), w.max_packets);
+ save_section(SAVE_SECTION_CLOUDS, w.cloud, sizeof(struct cloud_struct), w.max_clouds);
+
+// block arrays are written a column at a time, as they aren't contiguous without USE_DYNAMIC_MEMORY:
+ save_section_header(SAVE_SECTION_BLOCKS, sizeof(struct block_struct), w.blocks.x * w.blocks.y);
+ for (i = 0; i < w.blocks.x; i ++)
+	{
+		save_bytes(w.block [i], sizeof(struct block_struct) * w.blocks.y);
+	}
+ save_section_header(SAVE_SECTION_BACKBLOCKS, sizeof(struct backblock_struct), w.blocks.x * w.blocks.y);
+ for (i = 0; i < w.blocks.x; i ++)
+	{
+		save_bytes(w.backblock [i], sizeof(struct backblock_struct) * w.blocks.y);
+	}
+ save_section_header(SAVE_SECTION_VISION_BLOCKS, sizeof(struct vision_block_struct), w.blocks.x * w.blocks.y);
+ for (i = 0; i < w.blocks.x; i ++)
+	{
+		save_bytes(w.vision_block [i], sizeof(struct vision_block_struct) * w.blocks.y);
+	}
+ save_section_header(SAVE_SECTION_VISION_AREAS, sizeof(struct vision_area_struct), w.players * w.vision_areas_x * w.vision_areas_y);
+ for (p = 0; p < w.players; p ++)
+	{
+  for (i = 0; i < w.vision_areas_x; i ++)
+	 {
+		 save_bytes(w.vision_area [p] [i], sizeof(struct vision_area_struct) * w.vision_areas_y);
+	 }
+	}
+
+ save_section(SAVE_SECTION_TEMPLATES, templ, sizeof(struct template_struct), PLAYERS * TEMPLATES_PER_PLAYER);
+ save_section_header(SAVE_SECTION_END, 0, 0);
+
+ if (save_state.error)
   return 0;
- }
 
  return 1;
 
 }
 
+static void save_section(int type, const void* data, int record_size, int records)
+{
+
+ save_section_header(type, record_size, records);
+ save_bytes(data, record_size * records);
+
+}
+
+static void save_section_header(int type, int record_size, int records)
+{
+
+ struct save_section_header_struct section_header;
+
+ section_header.type = type;
+ section_header.record_size = record_size;
+ section_header.records = records;
+
+ save_bytes(&section_header, sizeof(struct save_section_header_struct));
+
+}
+
 
 
 int save_game_struct_to_file(void)
@@ -201,6 +304,7 @@ int save_world_properties_to_file(void)
 
  save_int(w.world_time);
  save_int(w.total_time);
+ save_int(w.grand_state);
 // save_int(w.permit_operator_player);
  save_int(w.actual_operator_player);
 
@@ -1010,40 +1114,29 @@ int save_int(int num)
 
 // fprintf(stdout, "\nsave int: %i", num);
 
- if (!save_char((num >> 24) & 0xff))
-  return 0;
- if (!save_char((num >> 16) & 0xff))
-  return 0;
- if (!save_char((num >> 8) & 0xff))
-  return 0;
- if (!save_char(num & 0xff))
-  return 0;
+ char bytes [4];
 
- return 1;
+ bytes [0] = (num >> 24) & 0xff;
+ bytes [1] = (num >> 16) & 0xff;
+ bytes [2] = (num >> 8) & 0xff;
+ bytes [3] = num & 0xff;
+
+ return save_bytes(bytes, 4);
 }
 
 int save_short(s16b num)
 {
- if (!save_char((num >> 8) & 0xff))
-  return 0;
- if (!save_char(num & 0xff))
-  return 0;
+ char bytes [2];
 
- return 1;
+ bytes [0] = (num >> 8) & 0xff;
+ bytes [1] = num & 0xff;
+
+ return save_bytes(bytes, 2);
 }
 
 int save_fixed(al_fixed num)
 {
- if (!save_char((num >> 24) & 0xff))
-  return 0;
- if (!save_char((num >> 16) & 0xff))
-  return 0;
- if (!save_char((num >> 8) & 0xff))
-  return 0;
- if (!save_char(num & 0xff))
-  return 0;
-
- return 1;
+ return save_int(num);
 }
 
 int save_char(char num)
@@ -1060,6 +1153,49 @@ int save_char(char num)
  return 1;
 }
 
+// copies length bytes into the save buffer, writing the buffer to disk whenever it fills up.
+// anything at least as big as the buffer is written straight to the file.
+int save_bytes(const void* data, int length)
+{
+ const char* bytes = data;
+ int space;
+
+ if (save_state.error == 1)
+  return 0;
+
+ space = SAVE_BUFFER_SIZE - save_state.bp;
+
+ if (length < space)
+ {
+  memcpy(save_state.buffer + save_state.bp, bytes, length);
+  save_state.bp += length;
+  return 1;
+ }
+
+// fill the buffer and write it:
+ memcpy(save_state.buffer + save_state.bp, bytes, space);
+ save_state.bp = SAVE_BUFFER_SIZE;
+ bytes += space;
+ length -= space;
+ if (!write_save_buffer())
+  return 0;
+
+ if (length >= SAVE_BUFFER_SIZE)
+ {
+  if (fwrite(bytes, 1, length, save_state.file) != (size_t) length)
+  {
+   write_line_to_log("Error: file write failed.", MLOG_COL_ERROR);
+   save_state.error = 1;
+   return 0;
+  }
+  return 1;
+ }
+
+ memcpy(save_state.buffer, bytes, length);
+ save_state.bp = length;
+ return 1;
+}
+
 
 
 // This is used anytime we need to save a (binary) file to disk (currently used for saved games, gamefiles and turnfiles)
@@ -5,9 +5,69 @@
 #define H_F_SAVE
 
 void save_game(void);
+int save_game_to_path(const char* file_path);
 
 #define SAVE_BUFFER_SIZE 8192
 
+/*
+
+Saved game format
+
+A saved game is a save_file_header_struct followed by a series of sections. Each section is a save_section_header_struct
+ followed by header.records records of header.record_size bytes each.
+Records are copies of the game's own structures (core_struct, proc_struct etc), written in bulk as they are in memory, so
+ a saved game can only be loaded by a build of the game that has the same structures. SAVE_FILE_VERSION and the record
+ sizes in the section headers make sure that a file from another version is rejected rather than misread.
+
+Every section must be present, in the order of the SAVE_SECTION enum. The loader (load_game() in f_load.c) checks each
+ section's header against what it expects, then checks every value in the records that is used as an array index.
+
+Some things aren't used from the file because the loader rebuilds them: the broadcast listener lists, the free entry bitmaps
+ and the blocklists. Clouds are saved but not restored (they're short display effects).
+The map display isn't saved, so the code that starts a loaded game needs to set it up.
+Pointers in the saved records are either blocklist pointers (which are rebuilt) or group_connection_ptr values, which the loader
+ converts using header.proc_base.
+
+*/
+
+#define SAVE_FILE_VERSION 1
+
+enum
+{
+SAVE_SECTION_WORLD_INIT, // w_init (1 record)
+SAVE_SECTION_GAME, // game (1 record)
+SAVE_SECTION_MISSION_STATE, // mission_state (1 record)
+SAVE_SECTION_WORLD, // w, including pointers (which are replaced when loading) (1 record)
+SAVE_SECTION_CORES, // w.max_cores records
+SAVE_SECTION_PROCS, // w.max_procs records
+SAVE_SECTION_PROC_BOXES, // w.max_procs records
+SAVE_SECTION_PACKETS, // w.max_packets records
+SAVE_SECTION_CLOUDS, // w.max_clouds records
+SAVE_SECTION_BLOCKS, // w.blocks.x * w.blocks.y records, one column (x) at a time
+SAVE_SECTION_BACKBLOCKS, // same
+SAVE_SECTION_VISION_BLOCKS, // same
+SAVE_SECTION_VISION_AREAS, // w.players * w.vision_areas_x * w.vision_areas_y records, for each player one column at a time
+SAVE_SECTION_TEMPLATES, // PLAYERS * TEMPLATES_PER_PLAYER records
+SAVE_SECTION_END, // no records
+
+SAVE_SECTIONS
+};
+
+struct save_file_header_struct
+{
+ char id [4]; // "LCsg"
+ int version; // SAVE_FILE_VERSION
+ int sections; // SAVE_SECTIONS
+ unsigned long long proc_base; // address of w.proc [0] when saved. Used to turn the group_connection_ptr values in the saved procs back into proc indices.
+};
+
+struct save_section_header_struct
+{
+ int type; // SAVE_SECTION_* enum
+ int record_size;
+ int records;
+};
+
 
 
 struct save_statestruct
@@ -30,6 +90,7 @@ int save_int(int num);
 int save_short(s16b num);
 int save_fixed(al_fixed num);
 int save_char(char num);
+int save_bytes(const void* data, int length);
 void close_save_file(void);
 int write_save_buffer(void);
 
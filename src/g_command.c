@@ -26,6 +26,7 @@
 #include "x_sound.h"
 
 #include "p_panels.h"
+#include "g_sim.h"
 
 #include "g_command.h"
 
@@ -45,6 +46,8 @@ struct command_struct command;
 static void select_a_core(int core_index);
 static void add_core_to_selection(int core_index);
 static void reset_select_mode(void);
+static void reset_user_build_queue_buttons(int queue_length);
+static void cancel_build_queue_drag(void);
 static int check_clicked_on_data_well(al_fixed mouse_x_fixed, al_fixed mouse_y_fixed);
 static void select_box(al_fixed xa, al_fixed ya, al_fixed xb, al_fixed yb);
 static void select_by_template(int core_index);
@@ -1216,29 +1219,51 @@ static void add_core_to_selection(int core_index)
 void remove_core_from_selection(int core_index)
 {
 
+ int select_index;
+
  sancheck(core_index, 0, w.max_cores, "remove_core_from_selection:core_index");
 
-// first check for destroyed core being only selected core:
-	if (w.core[core_index].selected == 0 // means it's at 0 position in command.selected_core array
-		&& command.select_mode == SELECT_MODE_SINGLE_CORE)
+ select_index = w.core[core_index].selected;
+
+	if (select_index == -1)
+		return; // must not be selected...
+
+	w.core[core_index].selected = -1;
+	w.core[core_index].deselect_time = game.total_time;
+
+	if (on_sim_thread())
 	{
-		command.select_mode = SELECT_MODE_NONE;
-		command.selected_core [0] = SELECT_TERMINATE;
-		w.core[core_index].selected = -1;
-		w.core[core_index].deselect_time = game.total_time;
-		command.display_build_buttons = 0;
+// the display may be using the selection, so it's changed after the tick (see g_sim.c):
+		defer_selection_removal(select_index);
 		return;
 	}
 
-	if (w.core[core_index].selected != -1)
+	remove_selection_entries(&select_index, 1);
+
+}
+
+// removes entries from command.selected_core (after their cores have been removed from the selection by remove_core_from_selection()).
+// select_index is a list of indices in command.selected_core
+void remove_selection_entries(int* select_index, int entries)
+{
+
+	int i;
+
+	for (i = 0; i < entries; i ++)
 	{
-		command.selected_core [w.core[core_index].selected] = SELECT_EMPTY;
-		w.core[core_index].selected = -1;
-		w.core[core_index].deselect_time = game.total_time;
-		reset_select_mode();
+// first check for destroyed core being only selected core:
+	 if (select_index [i] == 0 // means it's at 0 position in command.selected_core array
+		 && command.select_mode == SELECT_MODE_SINGLE_CORE)
+	 {
+		 command.select_mode = SELECT_MODE_NONE;
+		 command.selected_core [0] = SELECT_TERMINATE;
+		 command.display_build_buttons = 0;
+		 return;
+	 }
+	 command.selected_core [select_index [i]] = SELECT_EMPTY;
 	}
 
-// must not be selected...
+	reset_select_mode();
 
 }
 
@@ -1811,7 +1836,7 @@ s16b add_to_build_queue(int player_index, int builder_core_index, int template_i
  if (player_index == game.user_player_index
 		&& command.display_build_buttons)
 	{
-  reset_build_queue_buttons_y1(build_queue_index + 1);
+  reset_user_build_queue_buttons(build_queue_index + 1);
  	w.player[game.user_player_index].build_queue_fail_reason = BUILD_SUCCESS; // reset any error from a previous build attempt
 	}
 
@@ -1849,13 +1874,12 @@ void clear_build_queue_for_core(int player_index, int remove_core_index)
 		&& command.display_build_buttons)
 	{
 
-  reset_build_queue_buttons_y1(-1);
+  reset_user_build_queue_buttons(-1);
 
  	w.player[game.user_player_index].build_queue_fail_reason = BUILD_SUCCESS; // reset any error from a previous build attempt
 
-  if (write_index != 0
- 		&& control.mouse_drag == MOUSE_DRAG_BUILD_QUEUE)
-			 control.mouse_drag = MOUSE_DRAG_NONE;
+  if (write_index != 0)
+			 cancel_build_queue_drag();
 	}
 
 }
@@ -1885,7 +1909,7 @@ void requeue_repeat_build(int player_index)
  if (player_index == game.user_player_index
 		&& command.display_build_buttons)
 	{
-  reset_build_queue_buttons_y1(-1);
+  reset_user_build_queue_buttons(-1);
  	w.player[game.user_player_index].build_queue_fail_reason = BUILD_SUCCESS; // reset any error from a previous build attempt
 	}
 
@@ -1901,8 +1925,7 @@ void build_queue_next(int player_index, int reset_build_queue_buttons)
 		w.player[player_index].build_queue [i] = w.player[player_index].build_queue [i+1];
 	}
 
- if (control.mouse_drag == MOUSE_DRAG_BUILD_QUEUE)
-			control.mouse_drag = MOUSE_DRAG_NONE;
+ cancel_build_queue_drag();
 
 //		if (w.player[player_index].build_queue[0].core_index == remove_core_index)
 	w.player[player_index].build_queue_fail_reason = BUILD_SUCCESS; // means no error
@@ -1911,12 +1934,41 @@ void build_queue_next(int player_index, int reset_build_queue_buttons)
 		&& player_index == game.user_player_index
 		&& command.display_build_buttons)
 	{
-  reset_build_queue_buttons_y1(-1);
+  reset_user_build_queue_buttons(-1);
  	w.player[game.user_player_index].build_queue_fail_reason = BUILD_SUCCESS; // reset any error from a previous build attempt
 	}
 
 
 
+}
+
+// the build queue functions above can be called by a tick on the simulation thread (see g_sim.c), which leaves changes to the
+//  build queue buttons for the main thread to make after the tick
+static void reset_user_build_queue_buttons(int queue_length)
+{
+
+ if (on_sim_thread())
+	{
+		defer_build_queue_buttons_reset();
+		return;
+	}
+
+ reset_build_queue_buttons_y1(queue_length);
+
+}
+
+static void cancel_build_queue_drag(void)
+{
+
+ if (on_sim_thread())
+	{
+		defer_build_queue_drag_cancel();
+		return;
+	}
+
+ if (control.mouse_drag == MOUSE_DRAG_BUILD_QUEUE)
+		control.mouse_drag = MOUSE_DRAG_NONE;
+
 }
 
 // called when the user has dragged a build queue button to another position in the queue.
@@ -72,6 +72,7 @@ void init_commands(void);
 void run_commands(void);
 
 void remove_core_from_selection(int core_index);
+void remove_selection_entries(int* select_index, int entries);
 void build_button_pressed(int template_index);
 int check_proc_visible_to_user(int proc_index);
 void clear_selection(void);
@@ -41,6 +41,9 @@
 #include "p_init.h"
 #include "v_draw_panel.h"
 #include "v_interp.h"
+#include "m_profile.h"
+#include "g_sim.h"
+#include "i_snapshot.h"
 
 ALLEGRO_EVENT_QUEUE* event_queue; // these queues are initialised in main.c
 ALLEGRO_EVENT_QUEUE* fps_queue;
@@ -63,9 +66,15 @@ static void set_game_over(void);
 static int run_game_over(void);
 
 void start_game(void);
+int start_world_phase(void);
+void run_world_tick(void);
+void simulate_world_tick(void);
 
 static void run_pregame(void);
+static void finish_world_tick(void);
+static void end_world_tick(void);
 static void update_vision_area(void);
+static void stamp_vision_area(int p, int base_x, int base_y, timestamp stamp_time);
 //static void vision_block_check(struct block_struct* bl, int dist);
 //static void vision_block_check(struct block_struct* bl, int base_pos, int* subblock_pos);
 //static void vision_block_check_corner(struct block_struct* bl, int base_pos_x, int base_pos_y);
@@ -143,6 +152,8 @@ void init_main_loop(void)
 
  flush_game_event_queues();
 
+ profile_start_game();
+
 // game.play_sound = 0;
 // game.play_sound_counter = 0;
 
@@ -157,11 +168,18 @@ void run_game(void)
 
  init_main_loop();
 
+ if (settings.option [OPTION_SIM_THREAD])
+		start_sim_thread();
 
  main_game_loop();
 
+ stop_sim_thread();
+ stop_world_snapshots();
+
 // ends when game over (or user quit)
 
+ profile_end_game();
+
  game.watching = WATCH_OFF;
 // bcp_state.bcp_mode = BCP_MODE_EMPTY;
  init_bcode_panel();
@@ -200,11 +218,47 @@ void main_game_loop(void)
 
 
  int skip_frame = 0; // if game is running too slowly, it will skip frames to save drawing time.
+ int sim_tick_due; // 1 if the next tick is going to be run on the simulation thread
 // if (game.phase == GAME_PHASE_PREGAME)
 //  skip_frame = 1; // display is not updated during pregame phase.
 
  do // main game loop
  {
+// while a tick is running on the simulation thread (see g_sim.c), nothing on this thread can look at w, so the display just
+//  keeps drawing the latest snapshot (see i_snapshot.c) until the tick has finished:
+  if (sim_tick_running())
+		{
+   if (al_get_next_event(fps_queue, &ev))
+   {
+    view.fps = fps;
+    fps = 0;
+    view.cycles_per_second = cps;
+    cps = 0;
+   }
+   if (!al_get_next_event(event_queue, &ev))
+			{
+    interpolate_world_snapshot();
+    PROFILE_START(PROFILE_DISPLAY);
+    run_display();
+    PROFILE_END(PROFILE_DISPLAY);
+    fps ++;
+    al_wait_for_event(event_queue, &ev);
+			}
+			continue;
+		}
+
+  if (finish_sim_tick())
+		{
+// the tick has finished, so input, panels and commands can use w again until the next tick is started (the snapshot is
+//  still there for the next publish_world_snapshot() to update):
+			dw = &w;
+// now do the things the tick would have done on this thread:
+			apply_sim_ui_changes();
+			end_world_tick();
+			cps ++;
+			play_sound_list();
+		}
+
 //  if (game.phase != GAME_PHASE_PREGAME) // no input in pregame phase
    get_ex_control(0, (game.pause_soft == 0)); // ex_control needs to be updated even when halted (control will not be updated)
 
@@ -225,6 +279,8 @@ void main_game_loop(void)
 */
   game.total_time++;
 
+  sim_tick_due = 0;
+
 //  if (game.pause_hard == 0)
 //  {
 
@@ -241,6 +297,15 @@ void main_game_loop(void)
 			{
 				if (!game.pause_soft)
 				{
+				if (sim_thread_running()
+					&& game.watching == WATCH_OFF
+					&& game.fast_forward == FAST_FORWARD_OFF
+					&& !panel[PANEL_BCODE].open)
+				{
+// the tick will be started on the simulation thread after the rest of the loop has finished with w (see below)
+					sim_tick_due = 1;
+				}
+				 else
 				if (game.watching != WATCH_PAUSED_TO_WATCH)
     {
 
@@ -270,7 +335,9 @@ void main_game_loop(void)
 						}
 						 else
 							{
+        PROFILE_START(PROFILE_RUN_WORLD);
         run_world(); // runs the world and also the mission, if this is a mission. Can end the game.
+        PROFILE_END(PROFILE_RUN_WORLD);
 // should run_world be after the next three function calls? Maybe.
 
 //      run_clouds(); clouds don't need to be run
@@ -281,21 +348,10 @@ void main_game_loop(void)
 						if (game.watching != WATCH_PAUSED_TO_WATCH) // this may have been set in either of the run_cores_and_procs() calls above
 						{
 
-       run_packets();
+       finish_world_tick();
+       end_world_tick();
 
        cps ++;
-       w.world_time ++;
-       w.world_seconds = (w.world_time - BASE_WORLD_TIME) / 60;
-
-       update_vision_area(); // update fog of war after w.world_time is incremented so that the vision_time timestamps are up to date
-
-       if (game.phase != GAME_PHASE_OVER)
-						 {
-        if (game.type == GAME_TYPE_BASIC)
-						 	 run_custom_game();
-						    else
-						 			 run_mission(); // for now ignore return values
-						 }
 
        play_sound_list();
 
@@ -411,6 +467,14 @@ void main_game_loop(void)
     }
    }
 
+  if (sim_tick_due)
+		{
+			publish_world_snapshot();
+			start_sim_tick();
+		}
+		 else
+			stop_world_snapshots();
+
 // now check whether the timer has expired during game processing. If it has, don't generate a display this tick (unless force_display_update==1)
   if (al_get_next_event(event_queue, &ev))
   {
@@ -425,7 +489,10 @@ void main_game_loop(void)
 
   if (!skip_frame || force_display_update)
   {
+   interpolate_world_snapshot();
+   PROFILE_START(PROFILE_DISPLAY);
    run_display();
+   PROFILE_END(PROFILE_DISPLAY);
    fps ++;
    force_display_update = 0;
   }
@@ -447,6 +514,63 @@ void main_game_loop(void)
 
 }
 
+// Runs the parts of a world tick that come after process execution (packets, world time and fog of war).
+static void finish_world_tick(void)
+{
+
+ PROFILE_START(PROFILE_PACKETS);
+ run_packets();
+ PROFILE_END(PROFILE_PACKETS);
+
+ w.world_time ++;
+ w.world_seconds = (w.world_time - BASE_WORLD_TIME) / 60;
+
+ PROFILE_START(PROFILE_VISION);
+ update_vision_area(); // update fog of war after w.world_time is incremented so that the vision_time timestamps are up to date
+ PROFILE_END(PROFILE_VISION);
+
+}
+
+// Runs the parts of a world tick that have to be run on the main thread (game end checks and missions), after finish_world_tick().
+static void end_world_tick(void)
+{
+
+ profile_end_tick();
+
+ if (game.phase != GAME_PHASE_OVER)
+	{
+  if (game.type == GAME_TYPE_BASIC)
+		 run_custom_game();
+		  else
+				run_mission(); // for now ignore return values
+	}
+
+}
+
+// Runs a single world tick with no input, display or sound.
+// This is what main_game_loop() does each tick when nothing is being watched; it's used by the headless runner (m_headless.c).
+void run_world_tick(void)
+{
+
+ simulate_world_tick();
+ end_world_tick();
+
+}
+
+// Runs the parts of a world tick that don't need the main thread. Called by run_world_tick(), and by the simulation thread (g_sim.c).
+void simulate_world_tick(void)
+{
+
+ PROFILE_START(PROFILE_RUN_WORLD);
+ run_world();
+ PROFILE_END(PROFILE_RUN_WORLD);
+ run_fragments();
+ run_cores_and_procs(-1);
+
+ finish_world_tick();
+
+}
+
 /*
 // closes editor, template window or system window, if open
 // see also mode_button() in m_input.c
@@ -482,7 +606,6 @@ static void run_pregame(void)
 {
 
  int i,j;
- struct template_struct* spawn_templ;
 
 
 // make a visible area around player's spawn position
@@ -526,6 +649,25 @@ static void run_pregame(void)
 // for button dimensions, see also code in i_
 		&& control.mbutton_press [0] == BUTTON_JUST_PRESSED)
 	{
+		if (!start_world_phase())
+			return;
+
+// make sure the click on the start game button doesn't also select the first process (messes up the tutorial):
+  control.mbutton_press [0] = BUTTON_HELD;
+
+	}
+
+}
+
+// Checks that every player can spawn from template 0, then leaves the pregame phase and spawns each player's first process.
+// Called from run_pregame() when the user clicks the start button, and directly by the headless runner (m_headless.c).
+// Returns 1 on success; 0 (with game.spawn_fail and game.spawn_fail_reason set) if a player can't spawn.
+int start_world_phase(void)
+{
+
+ int i;
+ struct template_struct* spawn_templ;
+
   for (i = 0; i < w.players; i ++)
 		{
 			spawn_templ = &templ[i][0];
@@ -534,13 +676,13 @@ static void run_pregame(void)
 			{
 				game.spawn_fail = i;
 				game.spawn_fail_reason = SPAWN_FAIL_LOCK;
-				return;
+				return 0;
 			}
 			if (spawn_templ->data_cost > w.player[i].data)
 			{
 				game.spawn_fail = i;
 				game.spawn_fail_reason = SPAWN_FAIL_DATA;
-				return;
+				return 0;
 			}
 		}
 
@@ -565,10 +707,7 @@ static void run_pregame(void)
  	if (game.type == GAME_TYPE_MISSION)
 			mission_spawn_extra_processes();
 
-// make sure the click on the start game button doesn't also select the first process (messes up the tutorial):
-  control.mbutton_press [0] = BUTTON_HELD;
-
-	}
+ return 1;
 
 }
 
@@ -615,29 +754,69 @@ void init_vision_area_map(void)
 
 }
 
+// Keeps each player's vision_area vision_time values up to date.
+// A block's vision_time should be the last tick at which it was within SCAN_RANGE_BASE_BLOCKS (octagonally) of one of the player's cores.
+//  But stamping every core's area every tick is a lot of writes for a large stationary base, so instead each core's area is only
+//  stamped when the core moves to a new block, and otherwise every VISION_AREA_RESTAMP_TIME ticks (which is always recent enough
+//  to pass the VISION_AREA_VISIBLE_TIME tests).
+// When a core moves or stops being counted, its old area is stamped with the last tick the core was there, so vision_time
+//  values for areas the player can no longer see are the same as if every area were stamped every tick.
 static void update_vision_area(void)
 {
 	struct core_struct* core;
 	int c;
-	int base_min_x, base_max_x, base_min_y, base_max_y;
-	int min_x, max_x, min_y, max_y;
-//	int clipped_left, clipped_right, clipped_top, clipped_bottom;
-	int i,j;
-
  int p;
 
 for (p = 0; p < w.players; p ++)
 {
 	for (c = w.player[p].core_index_start; c < w.player[p].core_index_end; c ++)
 	{
-		if (w.core[c].exists <= 0
-			&& w.core[c].destroyed_timestamp < w.world_time - DEALLOCATE_COUNTER) // this means deallocating cores are still seen for a little while
-			continue;
 		core = &w.core[c];
+		if (core->exists <= 0
+			&& core->destroyed_timestamp < w.world_time - DEALLOCATE_COUNTER) // this means deallocating cores are still seen for a little while
+		{
+			if (core->vision_stamped)
+			{
+				stamp_vision_area(p, core->vision_block_x, core->vision_block_y, w.world_time - 1);
+				core->vision_stamped = 0;
+			}
+			continue;
+		}
 
 		int base_x = w.proc[core->process_index].block_position.x;
 		int base_y = w.proc[core->process_index].block_position.y;
 
+		if (core->vision_stamped)
+		{
+			if (base_x == core->vision_block_x
+				&& base_y == core->vision_block_y)
+			{
+				if (w.world_time - core->vision_stamp_timestamp < VISION_AREA_RESTAMP_TIME)
+					continue; // area stamped recently enough
+			}
+			 else
+				 stamp_vision_area(p, core->vision_block_x, core->vision_block_y, w.world_time - 1); // core has moved
+		}
+
+		stamp_vision_area(p, base_x, base_y, w.world_time);
+
+		core->vision_stamped = 1;
+		core->vision_block_x = base_x;
+		core->vision_block_y = base_y;
+		core->vision_stamp_timestamp = w.world_time;
+
+	} // end for c
+} // end for p
+
+}
+
+// Sets vision_time to stamp_time (unless it's already later) for player p's blocks in the octagonal area around base_x/base_y
+static void stamp_vision_area(int p, int base_x, int base_y, timestamp stamp_time)
+{
+	int base_min_x, base_max_x, base_min_y, base_max_y;
+	int min_x, max_x, min_y, max_y;
+	int i,j;
+
 		base_min_x = base_x - SCAN_RANGE_BASE_BLOCKS;
 		base_min_y = base_y - SCAN_RANGE_BASE_BLOCKS;
 		base_max_x = base_x + SCAN_RANGE_BASE_BLOCKS + 1;
@@ -670,16 +849,14 @@ for (p = 0; p < w.players; p ++)
 				row_min_x = base_x + octagonal_min_max [column_offset] [0];
 			if (row_max_x > base_x + octagonal_min_max [column_offset] [1])
 				row_max_x = base_x + octagonal_min_max [column_offset] [1];
-//			fpr("\n j %i min_y %i max_y %i column_offset %i min_x %i max_x %i row_min_x %i row_max_x %i", j, min_y, max_y, column_offset, min_x, max_x, row_min_x, row_max_x);
 		 for (i = row_min_x; i < row_max_x;	i ++)
 		 {
 
-		   w.vision_area[p][i][j].vision_time = w.world_time;
+		   if (w.vision_area[p][i][j].vision_time < stamp_time)
+		    w.vision_area[p][i][j].vision_time = stamp_time;
 
 		 }
 		}
-	} // end for c
-} // end for p
 
 }
 
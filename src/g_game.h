@@ -8,6 +8,10 @@ void init_vision_area_map(void);
 //void main_loop(void);
 void run_game(void);
 
+int start_world_phase(void);
+void run_world_tick(void);
+void simulate_world_tick(void);
+
 
 
 #endif
@@ -757,11 +757,17 @@ struct core_struct
 	timestamp destroyed_timestamp;
  int index; // this is the index in the w.core array (which is invisible to the player)
  int process_index; // this is the process occupied by the core.
+ int core_blocklist_down; // index of the next core in the same block's core list (-1 if none) - see block_struct
  int player_index;
  int template_index; // can be used with player_index to work out the template
 
  timestamp construction_complete_timestamp;
 
+// fog of war (see update_vision_area() in g_game.c). The core's vision area is only restamped when it moves to a new block or every VISION_AREA_RESTAMP_TIME ticks:
+ int vision_stamped; // 1 if the area around vision_block_x/y has been stamped and needs to be finished off when the core moves or is deallocated
+ int vision_block_x, vision_block_y; // block the area was last stamped around
+ timestamp vision_stamp_timestamp; // when it was last stamped
+
 // PROBABLY NEED deallocation counter so that core is deallocated along with core process.
 //  otherwise process could exist without a core, or with a subsequently created core
 
@@ -1163,6 +1169,7 @@ struct packet_struct
 
  struct packet_struct* blocklist_up;
  struct packet_struct* blocklist_down;
+ timestamp blocklist_tag; // w.packet_blocktag when this packet was put on a blocklist. If it's not current, the packet isn't on any list.
 
 };
 
@@ -1294,7 +1301,7 @@ struct well_struct
 	int reserve_data [DATA_WELL_RESERVES];
 	int reserve_squares; // currently the same for both reserves
 
-	timestamp last_drawn; // last value of game.total_time when this data well was drawn
+	timestamp last_drawn; // display frame (see run_display()) when this data well was last drawn
 
 };
 
@@ -1311,11 +1318,23 @@ struct block_struct
 // REMEMBER: When anything is added to this structure, it may need to be added to load/save routines in f_load.c/f_save.c
   unsigned int tag;
   struct proc_struct* blocklist_down;
-  unsigned int packet_tag;
-  struct packet_struct* packet_down;
+  unsigned int packet_tag; // compared with w.packet_blocktag (not w.blocktag)
+  struct packet_struct* packet_down; // only valid if packet_tag == w.packet_blocktag. Kept up to date through the whole tick (see g_packet.c), so the display can use it
+  unsigned int core_tag;
+  int core_down; // index of the top core in this block's core list (-1 if none). Only valid if core_tag == w.blocktag. Used by build_scanlist() in g_method_std.c
   int block_type; // this is the type used for edge-of-map collision detection
 };
 
+// proc_box_struct holds a packed copy of the values the collision broadphase needs from each proc, so that block lists can be walked without touching each (large) proc_struct.
+// There's one for each proc (in w.proc_box). They're set whenever a proc is put on a blocklist (see g_motion.c), which is the only time these values are used.
+// They're rebuilt every tick, so don't need to be saved.
+struct proc_box_struct
+{
+  al_fixed x, y; // copy of position
+  al_fixed max_length; // copy of nshape_ptr->max_length
+  int blocklist_down; // index of the next proc in the blocklist (-1 if none) - same as proc_struct blocklist_down
+};
+
 // backblock_struct is used for display-related stuff
 struct backblock_struct
 {
@@ -1368,6 +1387,8 @@ struct vision_block_struct
 
 // VISION_AREA_VISIBLE_TIME is how long a vision_area remains visible to a process. 128 may actually be a bit long - not sure
 #define VISION_AREA_VISIBLE_TIME 128
+// VISION_AREA_RESTAMP_TIME is how often a stationary core's vision area is restamped. Must be less than VISION_AREA_VISIBLE_TIME.
+#define VISION_AREA_RESTAMP_TIME 32
 
 struct vision_area_struct
 {
@@ -1423,40 +1444,72 @@ struct world_struct
 #define MAX_PROCS (MAX_PROCS_PER_PLAYER * PLAYERS)
 #define MAX_PACKETS 800
 
-//#define USE_DYNAMIC_MEMORY
+#define MAXIMUM_BLOCK_SIZE 120
+
+// With USE_DYNAMIC_MEMORY, the arrays below are allocated in new_world_from_world_init() (g_world.c) at the size actually needed
+//  for the world (w.max_cores, w.blocks etc) and freed in deallocate_world().
+// The block-sized arrays are each allocated as a single contiguous array with a pointer to each column, so they're used exactly like the static ones (e.g. w.block [x] [y]).
+// The vision_area arrays for all players are allocated together in one contiguous array.
+#define USE_DYNAMIC_MEMORY
+
+#define POOL_BITS_WORDS(entries) (((entries) + 31) / 32)
 
 #ifdef USE_DYNAMIC_MEMORY
 
   struct core_struct* core;
   struct proc_struct* proc;
+  struct proc_box_struct* proc_box;
   struct packet_struct* packet;
   struct cloud_struct* cloud;
   struct block_struct** block;
+  struct backblock_struct** backblock;
+  struct vision_block_struct** vision_block;
   struct vision_area_struct** vision_area [PLAYERS];
+  int* channel_listener [CHANNELS]; // each is w.max_cores long (see channel_listeners below)
+  unsigned int* core_free_bits;
+  unsigned int* proc_free_bits;
+  unsigned int* packet_free_bits;
 
 #else
 
-#define MAXIMUM_BLOCK_SIZE 120
-
   struct core_struct core [MAX_CORES];
   struct proc_struct proc [MAX_PROCS];
+  struct proc_box_struct proc_box [MAX_PROCS];
   struct packet_struct packet [MAX_PACKETS];
   struct cloud_struct cloud [CLOUDS];
-		int fragment_count;
-  struct fragment_struct fragment [FRAGMENTS];
   struct block_struct block [MAXIMUM_BLOCK_SIZE] [MAXIMUM_BLOCK_SIZE];
   struct backblock_struct backblock [MAXIMUM_BLOCK_SIZE] [MAXIMUM_BLOCK_SIZE];
-  float backblock_parallax [BACKBLOCK_LAYERS];
   struct vision_block_struct vision_block [MAXIMUM_BLOCK_SIZE] [MAXIMUM_BLOCK_SIZE];
   struct vision_area_struct vision_area [PLAYERS] [MAXIMUM_BLOCK_SIZE] [MAXIMUM_BLOCK_SIZE];
+  int channel_listener [CHANNELS] [MAX_CORES];
+  unsigned int core_free_bits [POOL_BITS_WORDS(MAX_CORES)];
+  unsigned int proc_free_bits [POOL_BITS_WORDS(MAX_PROCS)];
+  unsigned int packet_free_bits [POOL_BITS_WORDS(MAX_PACKETS)];
 
 #endif
 
+// channel_listener [ch] lists the indices of the cores listening to channel ch, in index order. Each player's cores are listed
+//  in their own part of the array, starting at w.player[p].core_index_start, and channel_listeners [p] [ch] is how many there are.
+// Used by broadcasts. Maintained by set_core_listen_channel() and core_ignore_all_channels() in g_method_std.c.
+  int channel_listeners [PLAYERS] [CHANNELS];
+
+// The free_bits arrays have one bit for each core, proc or packet. The bit is set if the entry isn't in use, so that new ones can
+//  be found with find_pool_bit() (g_misc.c) instead of checking every entry:
+//  - core: set if exists == 0 (the entry may still be deallocating - see find_empty_core() in g_proc_new.c)
+//  - proc: set if exists == 0 and reserved == 0 (also may still be deallocating). Updated by update_proc_free_bit() (g_proc_new.c)
+//  - packet: set if exists == 0
+
+		int fragment_count;
+  struct fragment_struct fragment [FRAGMENTS];
+  float backblock_parallax [BACKBLOCK_LAYERS];
+
   int vision_areas_x, vision_areas_y;
 
   timestamp blocktag;
+  timestamp packet_blocktag; // like blocktag, but for packet blocklists (which are rebuilt in run_packets(), before motion increments blocktag)
 #define BASE_WORLD_TIME 255
   timestamp world_time; // stars at BASE_WORLD_TIME. Doesn't include time spent paused.
+  unsigned int grand_state; // state of the random number generator used by grand() (see g_misc.c). Never 0.
   int world_seconds; // number of seconds; used for time limits and display (may be slightly out because it's an integer calculation)
 
   int max_cores;
@@ -1907,6 +1960,11 @@ OPTION_DOUBLE_FONTS,
 OPTION_LARGE_FONTS,
 OPTION_DEBUG, // can be used to set certain debug values without recompiling.
 OPTION_STANDARD_PATHS, // 0, 1 or 2 - affects whether Allegro's standard path functions are used to locate various files.
+OPTION_PROFILE, // 0, 1 or 2 - turns on the tick-phase profiler (see m_profile.h)
+OPTION_OPTIMISE, // OPTIMISE_MODE_ bits (in c_header.h) for the compile modes in which the compiler optimises bcode (see c_optimise.c). 0 (off) by default
+OPTION_COMPILE_THREADS, // number of templates compiled at once when loading default templates (see compile_templates() in c_compile.c). 0 (one per CPU core) by default
+OPTION_CORE_THREADS, // number of threads that execute cores at once (see g_proc_par.c). 0 (cores are executed one at a time, without phases) by default
+OPTION_SIM_THREAD, // if 1, world ticks run on a simulation thread while the display draws a snapshot of the world (see g_sim.c)
 OPTIONS
 };
 
@@ -2382,13 +2440,14 @@ struct source_edit_struct
 
 // The following values are relevant to source code source_edit_structs:
 
- char text [SOURCE_TEXT_LINES] [SOURCE_TEXT_LINE_LENGTH]; // note that these lines may not be in the correct order. Need to use line_index to work out order.
-//  *** text array must be the same as in source_struct (as the code that converts bcode to source code assumes that it can treat source.text in the same way as source_edit.text)
+ char (*text) [SOURCE_TEXT_LINE_LENGTH]; // note that these lines may not be in the correct order. Need to use line_index to work out order.
+//  *** text lines must be the same as in source_struct (as the code that converts bcode to source code assumes that it can treat source.text in the same way as source_edit.text)
+// text and source_colour are SOURCE_TEXT_LINES long. They're only allocated while the source_edit is in use (see clear_source_edit_text() in e_editor.c), so they're always there if active == 1.
 
  int line_index [SOURCE_TEXT_LINES]; // this lists lines of text from the text array in the order they appear in in the source.
 // int src_file [SOURCE_TEXT_LINES]; // stores the index of the file that the line came from
 
- int source_colour [SOURCE_TEXT_LINES] [SOURCE_TEXT_LINE_LENGTH]; // contains colour information for syntax highlighting
+ unsigned char (*source_colour) [SOURCE_TEXT_LINE_LENGTH]; // contains colour information (STOKEN_TYPE_*) for syntax highlighting
  int comment_line [SOURCE_TEXT_LINES]; // is 1 if the line starts within a multi-line comment
 
  int cursor_line;
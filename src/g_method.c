@@ -40,7 +40,7 @@ extern struct control_struct control; // defined in i_input.c. Used here for cli
 extern struct game_struct game;
 //extern struct object_type_struct otype [OBJECT_TYPES];
 extern struct template_struct templ [PLAYERS] [TEMPLATES_PER_PLAYER];
-extern struct vmstate_struct vmstate; // defined in v_interp.c
+extern THREAD_LOCAL struct vmstate_struct vmstate; // defined in v_interp.c
 
 //static s16b repair_process(struct core_struct* target_core, struct core_struct* repairer, int repair_amount);
 //static s16b repair_specific_component(struct core_struct* target_core, int component_index, int repair_amount);
@@ -39,11 +39,12 @@ Functions for calls to built-in (core) methods (i.e. ones that don't require an
 #include "g_method_core.h"
 
 #include "v_interp.h"
+#include "g_proc_par.h"
 
 extern struct view_struct view; // TO DO: think about putting a pointer to this in the worldstruct instead of externing it
 extern struct control_struct control; // defined in i_input.c. Used here for client process methods.
 extern struct game_struct game;
-extern struct vmstate_struct vmstate; // defined in v_interp.c
+extern THREAD_LOCAL struct vmstate_struct vmstate; // defined in v_interp.c
 
 #define CMETHOD_CALL_PARAMETERS 6
 
@@ -401,16 +402,19 @@ This is currently not possible
 
 // If this function has been called by the same calling core in the same execution,
 //  we can re-use the result of the earlier call.
-			if ((*target_core)->visibility_checked_by_core_index == calling_core->index
-				&& (*target_core)->visibility_checked_timestamp == w.world_time)
-				return (*target_core)->visibility_check_result;
-
-
+// The result is kept in the target core, so cores executing in the parallel phase (see g_proc_par.c) can't use it
+//  (they just do the check again, which gives the same result).
+   if (current_commit == NULL)
+			{
+			 if ((*target_core)->visibility_checked_by_core_index == calling_core->index
+				 && (*target_core)->visibility_checked_timestamp == w.world_time)
+				 return (*target_core)->visibility_check_result;
 
 // No? so set up the pre-check values for the next call:
-   (*target_core)->visibility_checked_by_core_index = calling_core->index;
-   (*target_core)->visibility_checked_timestamp = w.world_time;
-   (*target_core)->visibility_check_result = 0; // is set to 1 below if visibility check succeeds
+    (*target_core)->visibility_checked_by_core_index = calling_core->index;
+    (*target_core)->visibility_checked_timestamp = w.world_time;
+    (*target_core)->visibility_check_result = 0; // is set to 1 below if visibility check succeeds
+			}
 
 
 
@@ -452,7 +456,8 @@ This is currently not possible
 
 // *target_core = &w.core[target_core_world_index];
 
- (*target_core)->visibility_check_result = 1; // other visibility check values set above
+ if (current_commit == NULL)
+  (*target_core)->visibility_check_result = 1; // other visibility check values set above
 	return 1;
 
 }
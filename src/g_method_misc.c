@@ -43,7 +43,7 @@ extern struct view_struct view; // TO DO: think about putting a pointer to this
 extern unsigned char nshape_collision_mask [NSHAPES] [COLLISION_MASK_SIZE] [COLLISION_MASK_SIZE];
 
 extern struct control_struct control; // defined in i_input.c. Used here for client process methods.
-extern struct vmstate_struct vmstate;
+extern THREAD_LOCAL struct vmstate_struct vmstate;
 
 
 //static void scan_block(int block_x, int block_y, al_fixed scan_x, al_fixed scan_y, int range, struct core_struct* ignore_core);
@@ -389,7 +389,7 @@ void new_proc_fail_cloud(al_fixed x, al_fixed y, int angle, int shape, int size,
 
 }
 
-char method_error_string [120];
+THREAD_LOCAL char method_error_string [120];
 
 void	print_method_error(const char* error_message, int values, int value1)
 {
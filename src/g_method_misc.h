@@ -32,7 +32,7 @@ void new_proc_fail_cloud(al_fixed x, al_fixed y, al_fixed angle, int shape, int
 int copy_bcode_to_template(int t, struct bcode_struct* bcode, int source_program_type, int source_player_index, int template_origin, int start_address, int end_address, int name_address);
 
 
-extern char method_error_string [120];
+extern THREAD_LOCAL char method_error_string [120];
 
 void	print_method_error(const char* error_message, int values, int value1);
 void	print_method_error_string(void);
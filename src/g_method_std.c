@@ -43,6 +43,7 @@ Functions for calls to built-in (core) methods (i.e. ones that don't require an
 #include "i_background.h"
 
 #include "v_interp.h"
+#include "g_proc_par.h"
 
 #include "g_method_std.h"
 #include "c_keywords.h"
@@ -50,7 +51,7 @@ Functions for calls to built-in (core) methods (i.e. ones that don't require an
 extern struct view_struct view; // TO DO: think about putting a pointer to this in the worldstruct instead of externing it
 extern struct control_struct control; // defined in i_input.c. Used here for client process methods.
 extern struct game_struct game;
-extern struct vmstate_struct vmstate; // defined in v_interp.c
+extern THREAD_LOCAL struct vmstate_struct vmstate; // defined in v_interp.c
 extern struct command_struct command;
 extern struct template_struct templ [PLAYERS] [TEMPLATES_PER_PLAYER];
 
@@ -785,16 +786,7 @@ s16b call_std_method(struct core_struct* core, int call_value, int variable_para
 				}
 				vmstate.instructions_left -= 64; // seems reasonable - this should be an expensive operation. Could cost more.
 // additional power cost for broadcast?
-    for (i = w.player[core->player_index].core_index_start; i < w.player[core->player_index].core_index_end; i ++)
-				{
-					if (w.core[i].exists > 0
-						&& i != core->index
-      && distance_oct_xyxy(core->core_position.x, core->core_position.y, w.core[i].core_position.x, w.core[i].core_position.y) < broadcast_range
-						&& w.core[i].listen_channel [stack_parameters [1]])
-					{
-      write_message(&w.core[i], stack_parameters [1], stack_parameters [2], MESSAGE_TYPE_BROADCAST, core, -1, 0, variable_parameters - BROADCAST_PARAMETERS, &stack_parameters [BROADCAST_PARAMETERS]);
-					}
-				}
+    broadcast_message(core, broadcast_range, stack_parameters [1], stack_parameters [2], MESSAGE_TYPE_BROADCAST, -1, 0, variable_parameters - BROADCAST_PARAMETERS, &stack_parameters [BROADCAST_PARAMETERS]);
 			}
 			return 1;
 
@@ -824,16 +816,7 @@ s16b call_std_method(struct core_struct* core, int call_value, int variable_para
 // shouldn't be necessary to check whether the transmitted_target actually exists
 				vmstate.instructions_left -= 64; // seems reasonable - this should be an expensive operation. Could cost more.
 // additional power cost for broadcast?
-    for (i = w.player[core->player_index].core_index_start; i < w.player[core->player_index].core_index_end; i ++)
-				{
-					if (w.core[i].exists > 0
-						&& i != core->index
-      && distance_oct_xyxy(core->core_position.x, core->core_position.y, w.core[i].core_position.x, w.core[i].core_position.y) < broadcast_range
-						&& w.core[i].listen_channel [stack_parameters [1]])
-					{
-      write_message(&w.core[i], stack_parameters [1], stack_parameters [2], MESSAGE_TYPE_BROADCAST_TARGET, core, core->process_memory [transmitted_target_index], core->process_memory_timestamp [transmitted_target_index], variable_parameters - BROADCAST_TARGET_PARAMETERS, &stack_parameters [BROADCAST_TARGET_PARAMETERS]);
-					}
-				}
+    broadcast_message(core, broadcast_range, stack_parameters [1], stack_parameters [2], MESSAGE_TYPE_BROADCAST_TARGET, core->process_memory [transmitted_target_index], core->process_memory_timestamp [transmitted_target_index], variable_parameters - BROADCAST_TARGET_PARAMETERS, &stack_parameters [BROADCAST_TARGET_PARAMETERS]);
 			}
 			return 1;
 
@@ -905,19 +888,16 @@ s16b call_std_method(struct core_struct* core, int call_value, int variable_para
 			if (stack_parameters[0] < 0
 				|| stack_parameters[0] >= CHANNELS)
 					return 1;
-			core->listen_channel [stack_parameters[0]] = 0;
+			set_core_listen_channel(core, stack_parameters[0], 0);
 			return 1;
 		case SMETHOD_CALL_LISTEN_CHANNEL:
 			if (stack_parameters[0] < 0
 				|| stack_parameters[0] >= CHANNELS)
 					return 1;
-			core->listen_channel [stack_parameters[0]] = 1;
+			set_core_listen_channel(core, stack_parameters[0], 1);
 			return 1;
 		case SMETHOD_CALL_IGNORE_ALL_CHANNELS:
-			for (i = 0; i < CHANNELS; i ++)
-			{
-				core->listen_channel [i] = 0;
-			}
+			core_ignore_all_channels(core);
 			return 1;
 		case SMETHOD_CALL_COPY_COMMANDS:
 			{
@@ -1161,8 +1141,12 @@ s16b call_std_method(struct core_struct* core, int call_value, int variable_para
 					if (stack_parameters [0] <= 0) // mod
 						return 0;
 
-     w.player[core->player_index].random_seed = w.player[core->player_index].random_seed * 1103515245 + 12345;
-     return (unsigned int)(w.player[core->player_index].random_seed / 65536) % stack_parameters [0];
+// in the parallel phase each core has its own seed (see g_proc_par.c):
+     unsigned int* random_seed = &w.player[core->player_index].random_seed;
+     if (current_commit != NULL)
+						random_seed = &current_commit->random_seed;
+     *random_seed = *random_seed * 1103515245 + 12345;
+     return (unsigned int)(*random_seed / 65536) % stack_parameters [0];
 
 				}
 
@@ -1724,6 +1708,188 @@ static s16b write_message(struct core_struct* target_core, int channel, int prio
 }
 
 
+// Sends a message to each core of source_core's player that is listening to channel and is within broadcast_range of source_core.
+// Recipients are found either from the player's listener list for the channel (see set_core_listen_channel() below) or,
+//  if the broadcast range covers fewer blocks than there are listeners, from the per-block core lists built in run_motion() (g_motion.c).
+// Each recipient gets the same message whichever way it's found, so the result doesn't depend on which method is used.
+// A core executing in the parallel phase (see g_proc_par.c) can only broadcast as itself, and the broadcast is sent in the commit phase.
+void broadcast_message(struct core_struct* source_core, al_fixed broadcast_range, int channel, int priority, int message_type, int transmitted_target_core_index, timestamp transmitted_target_core_timestamp, int message_length, s16b* message)
+{
+
+ if (current_commit != NULL)
+	{
+		defer_broadcast(broadcast_range, channel, priority, message_type, transmitted_target_core_index, transmitted_target_core_timestamp, message_length, message);
+		return;
+	}
+
+ int player_index = source_core->player_index;
+ int listeners = w.channel_listeners [player_index] [channel];
+ int* listener = &w.channel_listener [channel] [w.player[player_index].core_index_start];
+ al_fixed source_x = source_core->core_position.x;
+ al_fixed source_y = source_core->core_position.y;
+ struct core_struct* target_core;
+ int i, c;
+
+ if (listeners == 0
+		|| (listeners == 1
+			&& listener [0] == source_core->index))
+		return;
+
+// same block search area as build_scanlist():
+ al_fixed block_range = broadcast_range + (broadcast_range / 8) + BLOCK_SIZE_FIXED;
+
+ int min_block_x = block_range >= source_x? 0 : al_fixtoi(source_x - block_range) / BLOCK_SIZE_PIXELS;
+ int min_block_y = block_range >= source_y? 0 : al_fixtoi(source_y - block_range) / BLOCK_SIZE_PIXELS;
+ int max_block_x = (al_fixtoi(source_x) + al_fixtoi(block_range)) / BLOCK_SIZE_PIXELS;
+ int max_block_y = (al_fixtoi(source_y) + al_fixtoi(block_range)) / BLOCK_SIZE_PIXELS;
+
+ if (max_block_x >= w.blocks.x)
+		max_block_x = w.blocks.x - 1;
+ if (max_block_y >= w.blocks.y)
+		max_block_y = w.blocks.y - 1;
+
+ if ((max_block_x - min_block_x + 1) * (max_block_y - min_block_y + 1) >= listeners)
+	{
+// the listener list is shorter, so just go through it:
+  for (i = 0; i < listeners; i ++)
+		{
+			target_core = &w.core [listener [i]];
+			if (target_core->exists > 0
+				&& target_core->index != source_core->index
+    && distance_oct_xyxy(source_x, source_y, target_core->core_position.x, target_core->core_position.y) < broadcast_range)
+    write_message(target_core, channel, priority, message_type, source_core, transmitted_target_core_index, transmitted_target_core_timestamp, message_length, message);
+		}
+		return;
+	}
+
+ int bx, by;
+ struct block_struct* bl;
+
+ for (bx = min_block_x; bx <= max_block_x; bx ++)
+	{
+		for (by = min_block_y; by <= max_block_y; by ++)
+		{
+			bl = &w.block [bx] [by];
+			if (bl->core_tag != w.blocktag)
+				continue;
+			c = bl->core_down;
+			while (c != -1)
+			{
+				target_core = &w.core [c];
+				if (target_core->exists > 0
+					&& target_core->player_index == player_index
+					&& target_core->listen_channel [channel]
+					&& c != source_core->index
+     && distance_oct_xyxy(source_x, source_y, target_core->core_position.x, target_core->core_position.y) < broadcast_range)
+     write_message(target_core, channel, priority, message_type, source_core, transmitted_target_core_index, transmitted_target_core_timestamp, message_length, message);
+				c = target_core->core_blocklist_down;
+			}
+		}
+	}
+
+}
+
+// core->listen_channel should only be changed through this function (or core_ignore_all_channels()), as it also keeps
+//  the player's listener list for the channel (w.channel_listener - see g_header.h) up to date.
+// Listening changes are rare compared to broadcasts, so the list is kept in index order by shifting entries along.
+// (a core executing in the parallel phase can only change its own channels, and the change is made in the commit phase)
+void set_core_listen_channel(struct core_struct* core, int channel, int listen)
+{
+
+ if (current_commit != NULL)
+	{
+		defer_listen_channel(channel, listen);
+		return;
+	}
+
+ if (core->listen_channel [channel] == listen)
+		return;
+
+ core->listen_channel [channel] = listen;
+
+ int* listener = &w.channel_listener [channel] [w.player[core->player_index].core_index_start];
+ int* listeners = &w.channel_listeners [core->player_index] [channel];
+ int i;
+
+ if (listen)
+	{
+		i = *listeners;
+		while (i > 0
+			&& listener [i - 1] > core->index)
+		{
+			listener [i] = listener [i - 1];
+			i --;
+		}
+		listener [i] = core->index;
+		(*listeners) ++;
+		return;
+	}
+
+ for (i = 0; i < *listeners; i ++)
+	{
+		if (listener [i] == core->index)
+			break;
+	}
+
+ if (i == *listeners)
+		return; // shouldn't happen
+
+ (*listeners) --;
+
+ for (; i < *listeners; i ++)
+	{
+		listener [i] = listener [i + 1];
+	}
+
+}
+
+// called when a core is created or destroyed, as well as by the ignore_all_channels() method
+void core_ignore_all_channels(struct core_struct* core)
+{
+
+ int i;
+
+ if (current_commit != NULL)
+	{
+		defer_listen_channel(-1, 0);
+		return;
+	}
+
+ for (i = 0; i < CHANNELS; i ++)
+	{
+		set_core_listen_channel(core, i, 0);
+	}
+
+}
+
+// Rebuilds all of the listener lists from the cores' listen_channel values. Used after loading a saved game (the lists aren't saved).
+void rebuild_channel_listeners(void)
+{
+
+ int c, i, p;
+
+ for (p = 0; p < PLAYERS; p ++)
+	{
+		for (i = 0; i < CHANNELS; i ++)
+		{
+			w.channel_listeners [p] [i] = 0;
+		}
+	}
+
+ for (c = 0; c < w.max_cores; c ++)
+	{
+		for (i = 0; i < CHANNELS; i ++)
+		{
+			if (w.core[c].listen_channel [i] == 0)
+				continue;
+			w.core[c].listen_channel [i] = 0;
+			if (w.core[c].exists != 0)
+				set_core_listen_channel(&w.core[c], i, 1);
+		}
+	}
+
+}
+
 
 // searches for a nearby well and updates vmstate.nearby_well_index
 // ideally wells should be spaced far enough apart that it doesn't matter that this is a very rough calculation
@@ -2102,11 +2268,13 @@ s16b lower_general_interface(struct core_struct* core)
 }
 
 
-struct scanlist_struct scanlist;
+THREAD_LOCAL struct scanlist_struct scanlist;
 
 // builds a list of all cores in scanning range of scanning_core (or at least SCANLIST_SIZE of them)
 // the list can then be used in other scanning functions.
 // any scanning function that uses the scanlist should check scanlist.current, and call this if it's false.
+// Only checks cores in blocks that could be in range, using the per-block core lists built each tick in run_motion() (g_motion.c).
+// The resulting list is in core index order, which is the same as if every core in the world had been checked.
 static void build_scanlist(struct core_struct* scanning_core)
 {
 
@@ -2116,44 +2284,75 @@ static void build_scanlist(struct core_struct* scanning_core)
 
 	al_fixed scan_range = scanning_core->scan_range_fixed;
 
-	int i;
+	int i, j;
 	al_fixed scan_x = scanning_core->core_position.x;
 	al_fixed scan_y = scanning_core->core_position.y;
 	int scanning_core_index = scanning_core->index;
 
-	int total_cores = w.cores_per_player * w.players;
+// distance_oct_xyxy() can be up to about 6% less than the larger of the x/y distances, so the block search area is made a bit bigger than scan_range:
+ al_fixed block_range = scan_range + (scan_range / 8) + BLOCK_SIZE_FIXED;
 
-	for (i = 0; i < total_cores; i ++)
+ int min_block_x = block_range >= scan_x? 0 : al_fixtoi(scan_x - block_range) / BLOCK_SIZE_PIXELS;
+ int min_block_y = block_range >= scan_y? 0 : al_fixtoi(scan_y - block_range) / BLOCK_SIZE_PIXELS;
+ int max_block_x = (al_fixtoi(scan_x) + al_fixtoi(block_range)) / BLOCK_SIZE_PIXELS;
+ int max_block_y = (al_fixtoi(scan_y) + al_fixtoi(block_range)) / BLOCK_SIZE_PIXELS;
+
+ if (max_block_x >= w.blocks.x)
+		max_block_x = w.blocks.x - 1;
+ if (max_block_y >= w.blocks.y)
+		max_block_y = w.blocks.y - 1;
+
+// found_core collects the cores in range, kept sorted by index so that if there are more than SCANLIST_SIZE of them the same ones are kept as if every core were checked in order:
+ static THREAD_LOCAL int found_core [MAX_CORES];
+ int found_cores = 0;
+ int bx, by, c;
+ struct block_struct* bl;
+
+ for (bx = min_block_x; bx <= max_block_x; bx ++)
 	{
-// don't exclude friendly cores
-			if (w.core[i].exists == 0
-				|| i == scanning_core_index)
+		for (by = min_block_y; by <= max_block_y; by ++)
+		{
+			bl = &w.block [bx] [by];
+			if (bl->core_tag != w.blocktag)
 				continue;
+			c = bl->core_down;
+			while (c != -1)
+			{
+// don't exclude friendly cores
+			 if (w.core[c].exists != 0
+				 && c != scanning_core_index
 // need to test both distance and visibility, even though both should have the same range, because the way they're calculated is slightly different.
-			if (distance_oct_xyxy(w.core[i].core_position.x, w.core[i].core_position.y,
+				 && distance_oct_xyxy(w.core[c].core_position.x, w.core[c].core_position.y,
 																									scan_x, scan_y) <= scan_range
-				&& w.vision_area[scanning_core->player_index]
-				                [w.proc[w.core[i].process_index].block_position.x]
-										          [w.proc[w.core[i].process_index].block_position.y].vision_time >= w.world_time - VISION_AREA_VISIBLE_TIME)
-//			if (abs(w.core[i].core_position.x - scan_x) + abs(w.core[i].core_position.y - scan_y) <= scan_range)
-			{
-/*
-if (w.vision_area[scanning_core->player_index]
-				                [w.proc[w.core[i].process_index].block_position.x]
-										          [w.proc[w.core[i].process_index].block_position.y].vision_time < w.world_time - VISION_AREA_VISIBLE_TIME)
-*/
-
-				scanlist.index [scanlist.list_size] = i;
-				scanlist.core_x [scanlist.list_size] = w.core[i].core_position.x;
-				scanlist.core_y [scanlist.list_size] = w.core[i].core_position.y;
-//				fpr("\n scanlist scan_range %i oct %i hypot %i", al_fixtoi(scan_range), al_fixtoi(distance_oct_xyxy(w.core[i].core_position.x, w.core[i].core_position.y,
-//																									scan_x, scan_y)),
-//												al_fixtoi(distance(scan_y - w.core[i].core_position.y, scan_x - w.core[i].core_position.x)));
-//				scanlist.scan_bitfield [scanlist.list_size] = w.core[i].scan_bitfield;
-				scanlist.list_size ++;
-			 if (scanlist.list_size >= SCANLIST_SIZE)
-				 break; // unlikely but possible.
+				 && w.vision_area[scanning_core->player_index]
+				                 [w.proc[w.core[c].process_index].block_position.x]
+										           [w.proc[w.core[c].process_index].block_position.y].vision_time >= w.world_time - VISION_AREA_VISIBLE_TIME)
+			 {
+// insert c into found_core in index order:
+			 	i = found_cores;
+			 	while (i > 0
+							 && found_core [i - 1] > c)
+						{
+							found_core [i] = found_core [i - 1];
+							i --;
+						}
+						found_core [i] = c;
+						found_cores ++;
+			 }
+			 c = w.core[c].core_blocklist_down;
 			}
+		}
+	}
+
+	for (j = 0; j < found_cores; j ++)
+	{
+		i = found_core [j];
+		scanlist.index [scanlist.list_size] = i;
+		scanlist.core_x [scanlist.list_size] = w.core[i].core_position.x;
+		scanlist.core_y [scanlist.list_size] = w.core[i].core_position.y;
+		scanlist.list_size ++;
+	 if (scanlist.list_size >= SCANLIST_SIZE)
+		 break; // unlikely but possible.
 	}
 
 	scanlist.current = 1;
@@ -11,6 +11,11 @@ s16b scan_for_auto_attack(struct core_struct* core, int angle, int scan_distance
 
 int check_static_build_location_for_data_wells(al_fixed build_x, al_fixed build_y);
 
+void broadcast_message(struct core_struct* source_core, al_fixed broadcast_range, int channel, int priority, int message_type, int transmitted_target_core_index, timestamp transmitted_target_core_timestamp, int message_length, s16b* message);
+void set_core_listen_channel(struct core_struct* core, int channel, int listen);
+void core_ignore_all_channels(struct core_struct* core);
+void rebuild_channel_listeners(void);
+
 
 #define SMETHOD_VARIABLE_PARAMS_MAX 16
 // this is the most parameters a call with a variable number of parameters will accept
@@ -27,7 +27,7 @@ Functions for calls to built-in (core) methods (i.e. ones that don't require an
 #include "c_keywords.h"
 
 extern struct game_struct game;
-extern struct vmstate_struct vmstate; // defined in v_interp.c
+extern THREAD_LOCAL struct vmstate_struct vmstate; // defined in v_interp.c
 
 #define UMETHOD_CALL_PARAMETERS 6
 
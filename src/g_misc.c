@@ -5,6 +5,7 @@
 
 #include "m_config.h"
 #include "g_header.h"
+#include "m_globvars.h"
 #include "g_misc.h"
 #include "x_init.h"
 
@@ -16,36 +17,53 @@ extern struct settingsstruct settings;
 
 //void error_call(void);
 //void wait_for_space(void);
+static int find_pool_bit_value(unsigned int* bits, int start, int end, unsigned int invert);
 
 #define IRAND_BUFFER_SIZE 1024
 
 
-// irand (interface rand) is a random number generator to be used for all random number generation that doesn't affect the game state (so that the state of rand isn't affected)
+// irand (interface rand) is a random number generator to be used for all random number generation that doesn't affect the game state (so that the state of grand isn't affected)
 //unsigned int irand_buffer [IRAND_BUFFER_SIZE]; // list of pseudorandom numbers - entropy doesn't really matter that much for irand as it's really just used for interface stuff
 //int irand_pos; // position in the irand buffer
 
+// Seeds grand(). Called by new_world_from_world_init() with the game seed, so that a world started from the same w_init
+//  gets the same random numbers. A loaded game should set w.grand_state to the saved value after this.
 void init_random_numbers(int grand_seed)
 {
-// srand(grand_seed);
-// TO DO: need to be able to init grand when starting a world - and should use saved seed if loading game from disk
 
-// int i;
+// spreads small seeds (game seeds are 0 to 999) across all of the bits:
+ unsigned int state = (unsigned int) grand_seed * 2654435761u + 0x9e3779b9u;
 
-// for (i = 0; i < IRAND_BUFFER_SIZE; i ++)
-// {
-  //irand_buffer [i] = (int) ((int) rand() + ((int) rand() << 16)); // assumes that rand returns 16 bits
-// }
+ state ^= state >> 16;
+ state *= 0x45d9f3bu;
+ state ^= state >> 16;
+
+ if (state == 0) // xorshift never leaves 0
+  state = 1;
+
+ w.grand_state = state;
 
 }
 
 // game rand - used for random numbers that may affect the game state
+// This is a 32-bit xorshift generator. Its state is in the world struct (rather than using rand()) so that it can be seeded
+//  for each world and saved with it, and so that the results don't depend on the C library.
 unsigned int grand(unsigned int max)
 {
 
- return (rand() + (rand() << 16)) % max; // needs two calls to rand as rand returns a 16-bit number (I think)
+ unsigned int x = w.grand_state;
+
+ x ^= x << 13;
+ x ^= x >> 17;
+ x ^= x << 5;
+
+ w.grand_state = x;
+
+ return x % max;
 
 }
 
+// interface rand - used for random numbers that don't affect the game state (e.g. menu decorations)
 unsigned int irand(unsigned int max)
 {
 /*
@@ -54,7 +72,106 @@ unsigned int irand(unsigned int max)
  if (irand_pos == IRAND_BUFFER_SIZE)
   irand_pos = 0;
 */
- return 1;//irand_buffer [irand_pos] % max; // irand_buffer is int so it only needs one value, not 2 as in grand
+ return (rand() + (rand() << 16)) % max; // needs two calls to rand as rand returns a 16-bit number (I think)
+
+}
+
+
+// Pool bitmaps have one bit per entry, 32 entries to each unsigned int (see the free_bits arrays in the world_struct in g_header.h).
+void set_pool_bit(unsigned int* bits, int index)
+{
+
+ bits [index >> 5] |= 1u << (index & 31);
+
+}
+
+void clear_pool_bit(unsigned int* bits, int index)
+{
+
+ bits [index >> 5] &= ~(1u << (index & 31));
+
+}
+
+// Returns the lowest index from start to end - 1 with its bit set, or -1 if there isn't one.
+// The result is the same as checking each entry in order, but 32 entries are checked at a time.
+int find_pool_bit(unsigned int* bits, int start, int end)
+{
+
+ return find_pool_bit_value(bits, start, end, 0);
+
+}
+
+// Like find_pool_bit(), but finds the lowest bit that isn't set.
+int find_pool_clear_bit(unsigned int* bits, int start, int end)
+{
+
+ return find_pool_bit_value(bits, start, end, ~0u);
+
+}
+
+// These return the lowest index from start onwards of an entry that is in use, or -1 if there isn't one.
+// Loops that go through every core, proc or packet can use them to skip unused entries, e.g.:
+//  for (c = next_used_core(0); c != -1; c = next_used_core(c + 1))
+// This goes through entries in index order, and sees entries created or destroyed during the loop in the same way as
+//  a loop that checks every entry's exists value.
+// next_used_core() and next_used_packet() only return entries with exists != 0.
+// next_used_proc() also returns reserved procs that have been destroyed, so exists still needs to be checked.
+int next_used_core(int start)
+{
+
+ return find_pool_clear_bit(w.core_free_bits, start, w.max_cores);
+
+}
+
+int next_used_proc(int start)
+{
+
+ return find_pool_clear_bit(w.proc_free_bits, start, w.max_procs);
+
+}
+
+int next_used_packet(int start)
+{
+
+ return find_pool_clear_bit(w.packet_free_bits, start, w.max_packets);
+
+}
+
+// invert is 0 to look for set bits, or ~0u to look for clear bits
+static int find_pool_bit_value(unsigned int* bits, int start, int end, unsigned int invert)
+{
+
+ if (start >= end)
+		return -1;
+
+ int word = start >> 5;
+ int last_word = (end - 1) >> 5;
+ unsigned int word_bits = (bits [word] ^ invert) & (~0u << (start & 31)); // ignores bits below start
+
+ while(TRUE)
+	{
+		if (word == last_word
+			&& ((end & 31) != 0))
+			word_bits &= (1u << (end & 31)) - 1; // ignores bits from end onwards
+		if (word_bits != 0)
+			break;
+		word ++;
+		if (word > last_word)
+			return -1;
+		word_bits = bits [word] ^ invert;
+	};
+
+#ifdef __GNUC__
+ return (word << 5) + __builtin_ctz(word_bits);
+#else
+ int i = 0;
+ while ((word_bits & 1) == 0)
+	{
+		word_bits >>= 1;
+		i ++;
+	}
+ return (word << 5) + i;
+#endif
 
 }
 
@@ -66,6 +183,9 @@ void error_call(void)
 
  ALLEGRO_KEYBOARD_STATE error_key_State;
 
+ if (event_queue == NULL) // no display to wait on (e.g. the headless runner in m_headless.c)
+  safe_exit(1);
+
  fprintf(stdout, "\n\r\n\rPress space to exit (with game window as focus)");
 
  while(TRUE)
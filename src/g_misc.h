@@ -9,6 +9,14 @@ unsigned int grand(unsigned int max);
 unsigned int irand(unsigned int max);
 void error_call(void);
 
+void set_pool_bit(unsigned int* bits, int index);
+void clear_pool_bit(unsigned int* bits, int index);
+int find_pool_bit(unsigned int* bits, int start, int end);
+int find_pool_clear_bit(unsigned int* bits, int start, int end);
+int next_used_core(int start);
+int next_used_proc(int start);
+int next_used_packet(int start);
+
 void wait_for_space(void);
 void print_binary(int num);
 void print_binary8(int num);
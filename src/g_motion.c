@@ -46,6 +46,7 @@ static void group_group_collision(struct proc_struct* pr, struct proc_struct* pr
 static void check_group_collision(struct core_struct* group_core);
 static int test_group_collision(struct core_struct* group_core);
 static void check_block_collision_group_member(struct proc_struct* pr, struct block_struct* bl);
+static void set_proc_box(struct proc_struct* pr);
 
 static void set_group_motion_prov_values(struct core_struct* group_core);
 static void set_group_member_prov_values(struct core_struct* group_core, struct proc_struct* pr, struct proc_struct* upstream_pr, int connection_index);
@@ -102,7 +103,7 @@ void run_motion(void)
 
 
 // First set up movement values for each core
- for (c = 0; c < w.max_cores; c ++)
+ for (c = next_used_core(0); c != -1; c = next_used_core(c + 1))
  {
 
   if (w.core [c].exists == 0)
@@ -222,7 +223,7 @@ void run_motion(void)
 
 // Second loop: check for any collisions that would occur if all procs moved freely:
 
- for (c = 0; c < w.max_cores; c ++)
+ for (c = next_used_core(0); c != -1; c = next_used_core(c + 1))
  {
   if (w.core [c].exists == 0)
 //			|| w.core [c].mobile	== 0) // immobile cores don't need collision detection   <- this is wrong now
@@ -445,7 +446,7 @@ void run_motion(void)
  }
 
 // Third loop: let's move all of the procs that haven't collided:
- for (c = 0; c < w.max_cores; c ++)
+ for (c = next_used_core(0); c != -1; c = next_used_core(c + 1))
  {
 //  pr->group_check = 0;
 
@@ -516,13 +517,25 @@ void run_motion(void)
  }
 
 // Finally we update block lists based on all proc movement:
+ rebuild_blocklists();
+
+}
+
+// Rebuilds the proc and core blocklists from scratch.
+// Called at the end of each run_motion(), and after a saved game is loaded (see f_load.c) so that the display and scans can use the lists straight away.
+// Procs and cores created between calls are added by add_proc_to_blocklist() and add_core_to_blocklist().
+void rebuild_blocklists(void)
+{
+
+ int p, c;
+ struct proc_struct* pr;
 
  w.blocktag ++;
 
  int blocktag = w.blocktag;
 
 // Note that unlike the previous loops, this one goes through procs rather than cores:
- for (p = 0; p < w.max_procs; p ++)
+ for (p = next_used_proc(0); p != -1; p = next_used_proc(p + 1))
  {
   pr = &w.proc [p];
 
@@ -553,9 +566,18 @@ void run_motion(void)
      pr->blocklist_down->blocklist_up = pr;
    }
 
- }
+  set_proc_box(pr);
 
+ }
 
+// Now do the same for cores. Each block has a separate list of cores in it, which is used to find cores in scanning range without checking every core in the world (see build_scanlist() in g_method_std.c).
+// Only cores with exists == 1 are put on the lists. A destroyed core has exists set straight to 0 (its deallocation delay is counted from destroyed_timestamp), so scans never find it.
+ for (c = next_used_core(0); c != -1; c = next_used_core(c + 1))
+ {
+  if (w.core[c].exists == 0)
+   continue;
+  add_core_to_blocklist(&w.core[c]);
+ }
 
 }
 
@@ -608,6 +630,49 @@ void add_proc_to_blocklist(struct proc_struct* pr)
      pr->blocklist_down->blocklist_up = pr;
    }
 
+  set_proc_box(pr);
+
+}
+
+// Copies the values used by the collision broadphase into pr's entry in w.proc_box.
+// Must be called whenever pr is put on a blocklist.
+static void set_proc_box(struct proc_struct* pr)
+{
+
+ struct proc_box_struct* box = &w.proc_box [pr->index];
+
+ box->x = pr->position.x;
+ box->y = pr->position.y;
+ box->max_length = pr->nshape_ptr->max_length;
+ if (pr->blocklist_down == NULL)
+  box->blocklist_down = -1;
+   else
+    box->blocklist_down = pr->blocklist_down->index;
+
+}
+
+/*
+This function adds a core to the core list of the block it's in.
+It's called for every core each tick at the end of run_motion(), and when a new core is created.
+Unlike the proc blocklists, the core lists are singly linked (by core index) as they're only ever read from top to bottom.
+
+Assumes w.blocktag is correct
+*/
+void add_core_to_blocklist(struct core_struct* core)
+{
+
+  block_cart core_block = cart_to_block(core->core_position);
+  struct block_struct* bl = &w.block [core_block.x] [core_block.y];
+
+  if (bl->core_tag != w.blocktag)
+  {
+   bl->core_tag = w.blocktag;
+   bl->core_down = -1;
+  }
+
+  core->core_blocklist_down = bl->core_down;
+  bl->core_down = core->index;
+
 }
 
 
@@ -624,7 +689,11 @@ static void check_block_collision(struct proc_struct* pr, struct block_struct* b
   return; // nothing in this block this tick
 
  struct proc_struct* check_proc;
- check_proc = bl->blocklist_down;
+// the blocklist is walked through w.proc_box, which also has the values needed for the bounding box test (see set_proc_box())
+ struct proc_box_struct* check_box;
+ int check_index = -1;
+ if (bl->blocklist_down != NULL)
+  check_index = bl->blocklist_down->index;
 
  int collision_vertex;
  cart collision_position;
@@ -634,21 +703,24 @@ static void check_block_collision(struct proc_struct* pr, struct block_struct* b
 
  struct nshape_struct* pr1_nshape = &nshape [pr->shape];
 
- while(check_proc != NULL)
+ while(check_index != -1)
  {
-// this function is only for non-group processes (i.e. just a core, with no components) so we don't
-//  need to exclude the possibility that check_proc is in the same group as pr
-  if (check_proc != pr // i.e. we don't check the proc against itself
-   && check_proc->exists // a proc destroyed immediately before this may still be on the blocklist, but needs to be ignored
-   && (check_proc->player_index != pr->player_index
-				|| (w.core[check_proc->core_index].mobile
-					&& w.core[pr->core_index].mobile)))
+  check_box = &w.proc_box [check_index];
+  if (check_box->x + check_box->max_length > pr->provisional_position.x - pr->nshape_ptr->max_length
+   && check_box->x - check_box->max_length < pr->provisional_position.x + pr->nshape_ptr->max_length
+   && check_box->y + check_box->max_length > pr->provisional_position.y - pr->nshape_ptr->max_length
+   && check_box->y - check_box->max_length < pr->provisional_position.y + pr->nshape_ptr->max_length)
   {
 
-    if (check_proc->position.x + check_proc->nshape_ptr->max_length > pr->provisional_position.x - pr->nshape_ptr->max_length
-     && check_proc->position.x - check_proc->nshape_ptr->max_length < pr->provisional_position.x + pr->nshape_ptr->max_length
-     && check_proc->position.y + check_proc->nshape_ptr->max_length > pr->provisional_position.y - pr->nshape_ptr->max_length
-     && check_proc->position.y - check_proc->nshape_ptr->max_length < pr->provisional_position.y + pr->nshape_ptr->max_length)
+    check_proc = &w.proc [check_index];
+
+// this function is only for non-group processes (i.e. just a core, with no components) so we don't
+//  need to exclude the possibility that check_proc is in the same group as pr
+    if (check_proc != pr // i.e. we don't check the proc against itself
+     && check_proc->exists // a proc destroyed immediately before this may still be on the blocklist, but needs to be ignored
+     && (check_proc->player_index != pr->player_index
+				  || (w.core[check_proc->core_index].mobile
+					  && w.core[pr->core_index].mobile)))
      {
 
         collision_vertex = check_nshape_nshape_collision(pr1_nshape, check_proc->shape, pr->provisional_position.x, pr->provisional_position.y, pr->provisional_angle, check_proc->position.x, check_proc->position.y, check_proc->angle);
@@ -743,7 +815,7 @@ To do next: use check_shape_shape_collision to:
 
      }
   }
-  check_proc = check_proc->blocklist_down;
+  check_index = check_box->blocklist_down;
  };
 
 }
@@ -759,25 +831,32 @@ static void check_block_collision_group_member(struct proc_struct* pr, struct bl
   return;
 
  struct proc_struct* check_proc;
- check_proc = bl->blocklist_down;
+// the blocklist is walked through w.proc_box, which also has the values needed for the bounding box test (see set_proc_box())
+ struct proc_box_struct* check_box;
+ int check_index = -1;
+ if (bl->blocklist_down != NULL)
+  check_index = bl->blocklist_down->index;
  int collision_vertex;
 
  struct nshape_struct* pr1_nshape = &nshape [pr->shape];
 
- while(check_proc != NULL)
+ while(check_index != -1)
  {
-  if (check_proc->core_index
-						!= pr->core_index // i.e. we don't check the proc against itself or against members of its own group
-   && check_proc->exists
-   && (check_proc->player_index != pr->player_index
-				|| (w.core[check_proc->core_index].mobile
-					&& w.core[pr->core_index].mobile)))
+  check_box = &w.proc_box [check_index];
+  if (check_box->x + check_box->max_length > pr->provisional_position.x - pr->nshape_ptr->max_length
+   && check_box->x - check_box->max_length < pr->provisional_position.x + pr->nshape_ptr->max_length
+   && check_box->y + check_box->max_length > pr->provisional_position.y - pr->nshape_ptr->max_length
+   && check_box->y - check_box->max_length < pr->provisional_position.y + pr->nshape_ptr->max_length)
   {
 
-    if (check_proc->position.x + check_proc->nshape_ptr->max_length > pr->provisional_position.x - pr->nshape_ptr->max_length
-     && check_proc->position.x - check_proc->nshape_ptr->max_length < pr->provisional_position.x + pr->nshape_ptr->max_length
-     && check_proc->position.y + check_proc->nshape_ptr->max_length > pr->provisional_position.y - pr->nshape_ptr->max_length
-     && check_proc->position.y - check_proc->nshape_ptr->max_length < pr->provisional_position.y + pr->nshape_ptr->max_length)
+    check_proc = &w.proc [check_index];
+
+    if (check_proc->core_index
+						  != pr->core_index // i.e. we don't check the proc against itself or against members of its own group
+     && check_proc->exists
+     && (check_proc->player_index != pr->player_index
+				  || (w.core[check_proc->core_index].mobile
+					  && w.core[pr->core_index].mobile)))
      {
 //      if ((collision_vertex = check_proc_proc_collision(pr, check_proc, cp_x, cp_y, cp_angle)) != -1)
 //      collision_vertex = check_proc_proc_collision(pr, check_proc, pr->provisional_x, pr->provisional_y, pr->provisional_angle, check_proc->provisional_x, check_proc->provisional_y, check_proc->provisional_angle);
@@ -826,7 +905,7 @@ static void check_block_collision_group_member(struct proc_struct* pr, struct bl
      }
 
   }
-  check_proc = check_proc->blocklist_down;
+  check_index = check_box->blocklist_down;
  };
 
 }
@@ -920,24 +999,31 @@ static int check_notional_block_collision(struct block_struct* bl, int notional_
   return 0; // nothing currently in this block
 
  struct proc_struct* check_proc;
- check_proc = bl->blocklist_down;
+// the blocklist is walked through w.proc_box, which also has the values needed for the bounding box test (see set_proc_box())
+ struct proc_box_struct* check_box;
+ int check_index = -1;
+ if (bl->blocklist_down != NULL)
+  check_index = bl->blocklist_down->index;
 
 // static int collision_x, collision_y, force, impulse_angle, vertex_speed_x, vertex_speed_y, collision_vertex;
 
  struct nshape_struct* notional_nshape = &nshape [notional_shape];
 
- while(check_proc != NULL)
+ while(check_index != -1)
  {
+  check_box = &w.proc_box [check_index];
   //if (check_proc != pr) // i.e. we don't check the proc against itself   <---- not needed for notional check
-  if (check_proc->exists
-			&& (check_proc->mobile == notional_proc_mobile // mobile procs collide with other mobile procs; static with other static
-				|| check_proc->player_index != notional_proc_player_index))	// although mobile procs will also collide with enemy static procs
+  if (check_box->x + check_box->max_length > notional_x - notional_nshape->max_length
+   && check_box->x - check_box->max_length < notional_x + notional_nshape->max_length
+   && check_box->y + check_box->max_length > notional_y - notional_nshape->max_length
+   && check_box->y - check_box->max_length < notional_y + notional_nshape->max_length)
   {
 
-    if (check_proc->position.x + check_proc->nshape_ptr->max_length > notional_x - notional_nshape->max_length
-     && check_proc->position.x - check_proc->nshape_ptr->max_length < notional_x + notional_nshape->max_length
-     && check_proc->position.y + check_proc->nshape_ptr->max_length > notional_y - notional_nshape->max_length
-     && check_proc->position.y - check_proc->nshape_ptr->max_length < notional_y + notional_nshape->max_length)
+    check_proc = &w.proc [check_index];
+
+    if (check_proc->exists
+			  && (check_proc->mobile == notional_proc_mobile // mobile procs collide with other mobile procs; static with other static
+				  || check_proc->player_index != notional_proc_player_index))	// although mobile procs will also collide with enemy static procs
      {
 
 // This works differently to the usual check_block_collision function.
@@ -963,7 +1049,7 @@ static int check_notional_block_collision(struct block_struct* bl, int notional_
      }
 
   }
-  check_proc = check_proc->blocklist_down;
+  check_index = check_box->blocklist_down;
  };
 
 // collision_core will not have been set if this function returns 0
@@ -1128,10 +1214,17 @@ int check_nshape_nshape_collision(struct nshape_struct* nshape1, int nshape2_ind
 
  al_fixed dist = distance_oct(sh1_y - sh2_y, sh1_x - sh2_x);
 
+// if the shapes are too far apart for any of nshape1's vertices to reach the solid part of nshape2's collision mask, there's no need to work out where each vertex is.
+// (the al_itofix(4) allows for rounding in the vertex position calculations below)
+ if (dist > nshape1->max_length + nshape[nshape2_index].collision_mask_radius + al_itofix(4))
+		return -1;
+
  al_fixed angle = get_angle(sh1_y - sh2_y, sh1_x - sh2_x);
  al_fixed angle_diff = angle - sh2_angle;
+ al_fixed vertex_angle_diff = sh1_angle - sh2_angle; // vertex angles in nshape2's frame are this + vertex_angle_fixed
 
  unsigned int v, mask_x, mask_y;
+ al_fixed vertex_angle;
 
  al_fixed sh1_centre_x = MASK_CENTRE_FIXED + fixed_xpart(angle_diff, dist);
  al_fixed sh1_centre_y = MASK_CENTRE_FIXED + fixed_ypart(angle_diff, dist);
@@ -1139,9 +1232,10 @@ int check_nshape_nshape_collision(struct nshape_struct* nshape1, int nshape2_ind
  for (v = 0; v < nshape1->vertices; v ++)
  {
 
-  mask_x = al_fixtoi(sh1_centre_x + fixed_xpart(sh1_angle + nshape1->vertex_angle_fixed [v] - sh2_angle, nshape1->vertex_dist_fixed [v]));// + al_itofix(1)));
+  vertex_angle = vertex_angle_diff + nshape1->vertex_angle_fixed [v];
+  mask_x = al_fixtoi(sh1_centre_x + fixed_xpart(vertex_angle, nshape1->vertex_dist_fixed [v]));// + al_itofix(1)));
   mask_x >>= COLLISION_MASK_BITSHIFT;
-  mask_y = al_fixtoi(sh1_centre_y + fixed_ypart(sh1_angle + nshape1->vertex_angle_fixed [v] - sh2_angle, nshape1->vertex_dist_fixed [v]));// + al_itofix(1)));
+  mask_y = al_fixtoi(sh1_centre_y + fixed_ypart(vertex_angle, nshape1->vertex_dist_fixed [v]));// + al_itofix(1)));
   mask_y >>= COLLISION_MASK_BITSHIFT;
 
   if (mask_x < COLLISION_MASK_SIZE // don't check for < 0 because they're unsigned
@@ -5,8 +5,10 @@
 //void init_drag_table(void);
 
 void run_motion(void);
+void rebuild_blocklists(void);
 
 void add_proc_to_blocklist(struct proc_struct* pr);
+void add_core_to_blocklist(struct core_struct* core);
 //int check_proc_point_collision(struct proc_struct* pr, al_fixed x, al_fixed y);
 
 int check_notional_block_collision_multi(int notional_shape, al_fixed notional_x, al_fixed notional_y, al_fixed notional_angle, int notional_proc_mobile, int notional_proc_player_index, struct core_struct** collision_core);
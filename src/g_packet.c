@@ -20,19 +20,28 @@
 
 int check_packet_collision(struct packet_struct* pack, struct block_struct* bl, al_fixed x, al_fixed y);
 void destroy_packet(struct packet_struct* pack);
+static void add_packet_to_blocklist(struct packet_struct* pack);
 void packet_explodes(struct packet_struct* pk, struct proc_struct* pr_hit);
 
 extern unsigned char nshape_collision_mask [NSHAPES] [COLLISION_MASK_SIZE] [COLLISION_MASK_SIZE];
+extern al_fixed largest_nshape_max_length; // in g_shapes.c
 
 void init_packets(void)
 {
 
  int pk;
 
+ for (pk = 0; pk < POOL_BITS_WORDS(w.max_packets); pk++)
+ {
+  w.packet_free_bits [pk] = 0;
+ }
+
  for (pk = 0; pk < w.max_packets; pk++)
  {
+  set_pool_bit(w.packet_free_bits, pk);
   w.packet[pk].exists = 0;
   w.packet[pk].index = pk;
+  w.packet[pk].blocklist_tag = 0;
 //  w.packet[pk].source_proc = -1;
  }
 
@@ -45,17 +54,14 @@ int new_packet(int type, int player_index, int source_core_index, timestamp sour
  int pk;
  struct packet_struct* pack;
 
- for (pk = 0; pk < w.max_packets; pk++)
- {
-  if (!w.packet[pk].exists)
-   break;
- }
+ pk = find_pool_bit(w.packet_free_bits, 0, w.max_packets); // lowest unused packet
 
- if (pk == w.max_packets)
+ if (pk == -1)
   return -1;
  pack = &w.packet[pk];
 
  pack->exists = 1;
+ clear_pool_bit(w.packet_free_bits, pk);
  pack->player_index = player_index;
  pack->source_core_index = source_core_index;
  pack->source_core_timestamp = source_core_created;
@@ -70,6 +76,9 @@ int new_packet(int type, int player_index, int source_core_index, timestamp sour
 
  pack->collision_size = 0;
 
+// packets created after run_packets() (e.g. by cores) go straight onto the blocklist so that the display can find them this tick
+ add_packet_to_blocklist(pack);
+
  return pk;
 
 }
@@ -84,7 +93,10 @@ void run_packets(void)
  int i, j, bx, by;
  int proc_hit, finished;
 
- for (pk = 0; pk < w.max_packets; pk++)
+// all packets are taken off their blocklists and put back on below:
+ w.packet_blocktag ++;
+
+ for (pk = next_used_packet(0); pk != -1; pk = next_used_packet(pk + 1))
  {
   if (!w.packet[pk].exists)
    continue;
@@ -465,13 +477,27 @@ How to do the trail?
 		}
 
 // check collisions:
+// a proc can only be hit if the packet is within max_length of its centre, so only the blocks around the packet that could hold such a proc need to be checked.
+// (usually this is 4 of the 9 surrounding blocks. Blocks are checked in the same order as if all 9 were checked, so the result is the same)
   finished = 0;
-  for (i = -1; i < 2; i ++)
+  int min_i = fixed_to_block(pack->position.x - largest_nshape_max_length) - pack->block_position.x;
+  int max_i = fixed_to_block(pack->position.x + largest_nshape_max_length) - pack->block_position.x;
+  int min_j = fixed_to_block(pack->position.y - largest_nshape_max_length) - pack->block_position.y;
+  int max_j = fixed_to_block(pack->position.y + largest_nshape_max_length) - pack->block_position.y;
+  if (min_i < -1)
+   min_i = -1;
+  if (max_i > 1)
+   max_i = 1;
+  if (min_j < -1)
+   min_j = -1;
+  if (max_j > 1)
+   max_j = 1;
+  for (i = min_i; i <= max_i; i ++)
   {
    bx = pack->block_position.x + i;
    if (bx < 0 || bx >= w.blocks.x)
     continue;
-   for (j = -1; j < 2; j ++)
+   for (j = min_j; j <= max_j; j ++)
    {
     by = pack->block_position.y + j;
     if (by < 0 || by >= w.blocks.y)
@@ -498,24 +524,7 @@ How to do the trail?
 //  pack->tail_count++;
 
 // now put it on the blocklist:
-// This works just like blocktags for procs - see g_motion.c
-  if (w.block [pack->block_position.x] [pack->block_position.y].packet_tag != w.blocktag)
-  {
-   w.block [pack->block_position.x] [pack->block_position.y].packet_tag = w.blocktag;
-   pack->blocklist_down = NULL;
-   pack->blocklist_up = NULL;
-   w.block [pack->block_position.x] [pack->block_position.y].packet_down = pack;
-  }
-   else
-   {
-// The block's packet_blocktag is up to date. So we put the new packet on top and set its downlink to the top packet of the block:
-    pack->blocklist_down = w.block [pack->block_position.x] [pack->block_position.y].packet_down;
-    pack->blocklist_up = NULL;
-    w.block [pack->block_position.x] [pack->block_position.y].packet_down = pack;
-// we also set the previous top proc's uplink to pack:
-    if (pack->blocklist_down != NULL) // not sure that this is necessary.
-     pack->blocklist_down->blocklist_up = pack;
-   }
+  add_packet_to_blocklist(pack);
 
  }
 
@@ -536,13 +545,18 @@ int check_packet_collision(struct packet_struct* pack, struct block_struct* bl,
 
 
  struct proc_struct* check_proc;
- check_proc = bl->blocklist_down;
+// the blocklist is walked through w.proc_box, which has the values needed for the bounding box test (see g_motion.c)
+ struct proc_box_struct* check_box;
+ int check_index = -1;
+ if (bl->blocklist_down != NULL)
+  check_index = bl->blocklist_down->index;
 // static int collision_x, collision_y;
 
 // int size_check;
 
- while(check_proc != NULL)
+ while(check_index != -1)
  {
+  check_box = &w.proc_box [check_index];
 /* 	fpr(" check_proc %i exists %i ts %i:%i from %i,%i to %i,%i packet %i,%i", check_proc->index,
 							check_proc->exists,
 							check_proc->player_index,
@@ -553,13 +567,17 @@ int check_packet_collision(struct packet_struct* pack, struct block_struct* bl,
 							al_fixtoi(check_proc->position.y + check_proc->nshape_ptr->max_length),
 							al_fixtoi(x), al_fixtoi(y));*/
 
-// first check team safety and do a bounding box
+// first do a bounding box, then check team safety
+  if (check_box->x + check_box->max_length > x
+   && check_box->x - check_box->max_length < x
+   && check_box->y + check_box->max_length > y
+   && check_box->y - check_box->max_length < y)
+  {
+
+    check_proc = &w.proc [check_index];
+
     if (check_proc->player_index != pack->team_safe
-     && check_proc->exists
-     && check_proc->position.x + check_proc->nshape_ptr->max_length > x
-     && check_proc->position.x - check_proc->nshape_ptr->max_length < x
-     && check_proc->position.y + check_proc->nshape_ptr->max_length > y
-     && check_proc->position.y - check_proc->nshape_ptr->max_length < y)
+     && check_proc->exists)
      {
 
       al_fixed dist = distance(y - check_proc->position.y, x - check_proc->position.x);
@@ -591,8 +609,9 @@ int check_packet_collision(struct packet_struct* pack, struct block_struct* bl,
        }
 
      }
+  }
 
-  check_proc = check_proc->blocklist_down;
+  check_index = check_box->blocklist_down;
  };
 
  return -1;
@@ -892,10 +911,70 @@ void packet_explodes(struct packet_struct* pk, struct proc_struct* pr_hit)
 
 
 
+// Puts every packet back on the blocklists (like a run_packets() call without the movement).
+// Used after a saved game is loaded (see f_load.c), as the saved lists contain pointers from the game that was saved.
+void rebuild_packet_blocklists(void)
+{
+
+ int pk;
+
+ w.packet_blocktag ++;
+
+ for (pk = next_used_packet(0); pk != -1; pk = next_used_packet(pk + 1))
+ {
+  if (!w.packet[pk].exists)
+   continue;
+  add_packet_to_blocklist(&w.packet[pk]);
+ }
+
+}
+
+// Puts a packet on top of its block's blocklist.
+// This works just like blocktags for procs (see g_motion.c) but uses w.packet_blocktag, which is incremented at the start of run_packets()
+//  rather than in run_motion(), so that the lists stay valid (and include new packets) until the next run_packets() call.
+static void add_packet_to_blocklist(struct packet_struct* pack)
+{
+
+ struct block_struct* bl = &w.block [pack->block_position.x] [pack->block_position.y];
+
+ pack->blocklist_tag = w.packet_blocktag;
+ pack->blocklist_up = NULL;
+
+ if (bl->packet_tag != w.packet_blocktag)
+ {
+// The block's packet_tag is old, so this is the first packet on it:
+  bl->packet_tag = w.packet_blocktag;
+  pack->blocklist_down = NULL;
+  bl->packet_down = pack;
+  return;
+ }
+
+// The block's packet_tag is up to date. So we put the new packet on top and set its downlink to the top packet of the block:
+ pack->blocklist_down = bl->packet_down;
+ bl->packet_down = pack;
+// we also set the previous top packet's uplink to pack:
+ if (pack->blocklist_down != NULL)
+  pack->blocklist_down->blocklist_up = pack;
+
+}
+
 void destroy_packet(struct packet_struct* pack)
 {
 
  pack->exists = 0;
+ set_pool_bit(w.packet_free_bits, pack->index);
+
+// if the packet is on a current blocklist, takes it off (otherwise new_packet() could reuse it while it's still linked):
+ if (pack->blocklist_tag == w.packet_blocktag)
+ {
+  if (pack->blocklist_up != NULL)
+   pack->blocklist_up->blocklist_down = pack->blocklist_down;
+    else
+     w.block [pack->block_position.x] [pack->block_position.y].packet_down = pack->blocklist_down;
+  if (pack->blocklist_down != NULL)
+   pack->blocklist_down->blocklist_up = pack->blocklist_up;
+  pack->blocklist_tag = 0;
+ }
 
 }
 
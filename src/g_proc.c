@@ -22,6 +22,7 @@
 #include "g_proc_new.h"
 #include "g_world.h"
 #include "g_shapes.h"
+#include "g_sim.h"
 #include "h_story.h"
 #include "i_error.h"
 #include "t_template.h"
@@ -218,7 +219,9 @@ void core_proc_explodes(struct proc_struct* core_pr, int destroyer_team)
 		special_AI_destroyed(core); // this may create a bubble that will be turned into a cloud below.
 
 	core->exists = 0;
+	set_pool_bit(w.core_free_bits, core->index);
 	core->destroyed_timestamp = w.world_time;
+	core_ignore_all_channels(core); // takes the core off the broadcast listener lists
 
 	if (core->bubble_text_time > w.world_time - BUBBLE_TOTAL_TIME)
 	{
@@ -240,11 +243,13 @@ void core_proc_explodes(struct proc_struct* core_pr, int destroyer_team)
 
 	destroy_a_proc(&w.proc[core->process_index], destroyer_team);
  w.proc[core->process_index].reserved = 0;
+ update_proc_free_bit(&w.proc[core->process_index]);
 
 	for (i = 1; i < core->group_members_max; i++) // note for i = 1
 	{
 		sancheck(core->group_member[i].index, 0, w.max_procs, "core_proc_explodes: core->group_member[i].index");
 		w.proc[core->group_member[i].index].reserved = 0; // core has been destroyed, so proc no longer reserved
+		update_proc_free_bit(&w.proc[core->group_member[i].index]);
 		if (core->group_member[i].exists)
 		{
     cl = new_cloud(CLOUD_SUB_PROC_EXPLODE, 64, w.proc[core->group_member[i].index].position.x, w.proc[core->group_member[i].index].position.y);
@@ -550,9 +555,15 @@ static void destroy_a_proc(struct proc_struct* destroyed_pr, int destroyer_team)
 
  if (w.core[destroyed_pr->core_index].selected == 0 // 0 means it's the first in the selection list
 		&& command.select_mode == SELECT_MODE_SINGLE_CORE)
-		command.selected_member = -1; // deselect this proc (but not core) if it was specifically selected
+	{
+		if (on_sim_thread())
+			defer_member_deselection(); // see g_sim.c
+		  else
+		   command.selected_member = -1; // deselect this proc (but not core) if it was specifically selected
+	}
 
  destroyed_pr->exists = 0;
+ update_proc_free_bit(destroyed_pr);
  destroyed_pr->hp = 0;
  destroyed_pr->destroyed_timestamp = w.world_time;
 
@@ -150,6 +150,7 @@ int create_new_from_template(struct template_struct* build_templ, int player_ind
 					al_fixtoi(w.proc[core->process_index].position.x), al_fixtoi(w.proc[core->process_index].position.y));*/
 
 	core->core_position = w.proc[core->process_index].position;
+	add_core_to_blocklist(core); // so that the new core can be found by scans during the rest of this tick
 
 	if (w.proc[core->process_index].shape < FIRST_MOBILE_NSHAPE)
 		core->mobile = 0;
@@ -270,8 +271,10 @@ int start_setting_up_core_from_template(int c, struct core_struct* core, struct
 
 
  core->exists = 1;
+ clear_pool_bit(w.core_free_bits, c);
  core->created_timestamp = w.world_time;
  core->destroyed_timestamp = 0;
+ core->vision_stamped = 0;
  core->index = c;
  core->process_index = notional_member[0].index; // core is always process 0
  core->player_index = player_index;
@@ -378,7 +381,7 @@ int start_setting_up_core_from_template(int c, struct core_struct* core, struct
  core->message_reading = -1;
  for (i = 0; i < CHANNELS; i ++)
 	{
-		core->listen_channel [i] = 0; // could default to 1 instead but 0 avoids some unnecessary calculations
+		set_core_listen_channel(core, i, 0); // could default to 1 instead but 0 avoids some unnecessary calculations. Also removes the core from the listener lists (see g_method_std.c) if for some reason it was still on them.
 	}
 // contents of message_struct not initialised; we rely on core->messages_received to avoid reading uninitialised contents of struct
 
@@ -539,14 +542,14 @@ void set_group_member_values_from_notional(struct core_struct* core)
 int find_empty_proc(int player_index, int proc_index_start)
 {
 
- int p;
+ int p = find_pool_bit(w.proc_free_bits, proc_index_start, w.player[player_index].proc_index_end);
 
- for (p = proc_index_start; p < w.player[player_index].proc_index_end; p ++)
+// the free bitmap only has unused, unreserved procs, but some of them may still be deallocating:
+ while (p != -1)
  {
-  if (w.proc[p].exists == 0
-			&& w.proc[p].reserved == 0
-			&& w.proc[p].destroyed_timestamp < w.world_time - DEALLOCATE_COUNTER)
+  if (w.proc[p].destroyed_timestamp < w.world_time - DEALLOCATE_COUNTER)
    return p;
+  p = find_pool_bit(w.proc_free_bits, p + 1, w.player[player_index].proc_index_end);
  }
 
  return -1; // team is full
@@ -556,19 +559,31 @@ int find_empty_proc(int player_index, int proc_index_start)
 int find_empty_core(int player_index)
 {
 
- int c;
+ int c = find_pool_bit(w.core_free_bits, w.player[player_index].core_index_start, w.player[player_index].core_index_end);
 
- for (c = w.player[player_index].core_index_start; c < w.player[player_index].core_index_end; c ++)
+ while (c != -1)
  {
-  if (w.core[c].exists == 0
-			&& w.core[c].destroyed_timestamp < w.world_time - DEALLOCATE_COUNTER)
+  if (w.core[c].destroyed_timestamp < w.world_time - DEALLOCATE_COUNTER)
    return c;
+  c = find_pool_bit(w.core_free_bits, c + 1, w.player[player_index].core_index_end);
  }
 
  return -1; // team is full
 
 }
 
+// Call after changing a proc's exists or reserved value, to keep w.proc_free_bits up to date.
+void update_proc_free_bit(struct proc_struct* proc)
+{
+
+ if (proc->exists == 0
+		&& proc->reserved == 0)
+		set_pool_bit(w.proc_free_bits, proc->index);
+	  else
+ 		clear_pool_bit(w.proc_free_bits, proc->index);
+
+}
+
 
 void add_process_from_template(int p, struct template_struct* build_templ, struct core_struct* core, int member_index)
 {
@@ -671,6 +686,7 @@ static void init_added_or_restored_proc_details(struct proc_struct* proc, int me
 {
 
 	proc->exists = 1;
+	update_proc_free_bit(proc);
  proc->created_timestamp = w.world_time;
 	proc->selected = 0;
 	proc->select_time = 0;
@@ -10,6 +10,7 @@ void set_basic_group_properties(struct core_struct* core);
 void calculate_move_object_properties(struct core_struct* group_core, struct proc_struct* proc, int object_index);
 int add_notional_member_recursively(struct template_struct* templ, int member_index, cart new_position, al_fixed new_angle, int allow_failure);
 s16b restore_component(struct core_struct* core, int player_index, int template_index, int member_index);
+void update_proc_free_bit(struct proc_struct* proc);
 
 // This struct is set up with basic physical properties of procs
 //  to allow collision detection to be done before a group is properly created.
@@ -0,0 +1,469 @@
+#include <allegro5/allegro.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "m_config.h"
+#include "m_globvars.h"
+
+#include "g_misc.h"
+#include "g_header.h"
+#include "c_header.h"
+
+#include "g_method.h"
+#include "g_method_std.h"
+#include "i_console.h"
+#include "x_sound.h"
+
+#include "v_interp.h"
+#include "g_proc_par.h"
+
+/*
+
+Running cores in parallel
+
+When settings.option [OPTION_CORE_THREADS] is not 0, run_cores_and_procs() (g_proc_run.c) executes the cores in three phases:
+ - a serial pre-pass sets up each core that is due to execute this tick.
+ - the parallel phase executes those cores on up to OPTION_CORE_THREADS threads (see execute_cores_in_parallel() below).
+ - the commit phase goes through the cores in index order and, for each core, does whatever its execution left for it
+    (see commit_core_execution() below), then finishes it as usual.
+
+During the parallel phase a core can only read the world and change its own state. Anything else it does is either:
+ - deferred: console text, sounds, broadcasts and channel changes are put in the core's effect list by the defer_*() functions
+    below (write_text_to_console(), play_game_sound() etc. call them when current_commit is set) and replayed in the commit phase.
+    None of these change the return value of the call that makes them.
+ - waited for: calls whose results depend on the rest of the world changing (building, data transfer, transmit, repair etc.
+    - see parallel_call_must_wait()) stop execution in the parallel phase. The interpreter keeps its state in the core's
+    commit record and the core resumes from the same instruction in the commit phase, when it can change the world directly.
+
+Each core's results depend only on the world at the start of the tick and on the cores committed before it, so they
+ don't depend on the number of threads or on which thread runs which core. They aren't the same as the results of running
+ the cores one at a time, though (which is why this is an option): e.g. a core no longer sees a message broadcast
+ earlier in the same tick unless it stopped to wait for the commit phase, and random() uses a separate seed for each core.
+
+*/
+
+extern struct template_struct templ [PLAYERS] [TEMPLATES_PER_PLAYER];
+extern THREAD_LOCAL struct vmstate_struct vmstate; // defined in v_interp.c
+
+THREAD_LOCAL struct core_commit_struct* current_commit = NULL;
+
+static struct core_commit_struct core_commit [MAX_CORES];
+
+struct core_thread_pool_struct
+{
+ int threads_wanted; // the main thread also executes cores, so this is one less than OPTION_CORE_THREADS
+ int threads; // number of worker threads actually running
+ ALLEGRO_THREAD* thread [CORE_THREADS_MAX];
+ ALLEGRO_MUTEX* mutex; // everything below is protected by mutex
+ ALLEGRO_COND* start_cond; // signalled when a new batch of cores is ready or the workers should close
+ ALLEGRO_COND* done_cond; // signalled when the last core in a batch has finished executing
+ int batch; // incremented each time a new batch is ready
+ int cores; // number of cores in the current batch
+ int next_core; // index in core_commit of the next core that needs a thread
+ int running; // number of cores that are currently being executed
+ int closing;
+};
+
+static struct core_thread_pool_struct pool;
+
+static void* core_thread(ALLEGRO_THREAD* thread, void* arg);
+static void start_core_threads(int threads);
+static void close_core_threads(void);
+static void execute_waiting_cores(void);
+static void execute_core_in_phase(struct core_commit_struct* commit);
+static struct core_effect_struct* new_effect(int type);
+
+
+// executes the cores in core_list (each of which must be due to execute this tick, and must have been set up by the serial
+//  pre-pass) using up to settings.option [OPTION_CORE_THREADS] threads.
+// Afterwards, core_execution_suspended() and commit_core_execution() take the index of a core in core_list.
+void execute_cores_in_parallel(int* core_list, int cores)
+{
+
+ int threads = settings.option [OPTION_CORE_THREADS];
+ int i;
+ struct core_struct* core;
+
+ for (i = 0; i < cores; i ++)
+	{
+		core = &w.core [core_list [i]];
+		core_commit[i].core_index = core->index;
+		core_commit[i].created_timestamp = core->created_timestamp;
+		core_commit[i].random_seed = w.player[core->player_index].random_seed + core->index * 2654435761u + w.world_time;
+		core_commit[i].suspended = 0;
+		core_commit[i].effects = 0;
+	}
+
+ if (threads < 1)
+		threads = 1;
+ if (threads > CORE_THREADS_MAX)
+		threads = CORE_THREADS_MAX;
+
+ if (pool.threads_wanted != threads - 1)
+		start_core_threads(threads - 1);
+
+ if (pool.threads == 0
+		|| cores < 2)
+	{
+// no point waking any other threads:
+		for (i = 0; i < cores; i ++)
+		{
+			execute_core_in_phase(&core_commit [i]);
+		}
+		return;
+	}
+
+ al_lock_mutex(pool.mutex);
+ pool.cores = cores;
+ pool.next_core = 0;
+ pool.batch ++;
+ al_broadcast_cond(pool.start_cond);
+
+ execute_waiting_cores(); // the main thread executes cores too
+
+ while (pool.running > 0)
+	{
+		al_wait_cond(pool.done_cond, pool.mutex);
+	}
+ al_unlock_mutex(pool.mutex);
+
+}
+
+int core_execution_suspended(int list_index)
+{
+
+ return core_commit[list_index].suspended;
+
+}
+
+// does whatever the core's execution in the parallel phase left for the commit phase.
+// The caller must make sure that the core still exists (its created_timestamp is in core_commit[list_index])
+void commit_core_execution(int list_index)
+{
+
+ struct core_commit_struct* commit = &core_commit [list_index];
+ struct core_struct* core = &w.core [commit->core_index];
+ struct core_effect_struct* effect;
+ int i;
+
+ for (i = 0; i < commit->effects; i ++)
+	{
+		effect = &commit->effect [i];
+		switch(effect->type)
+		{
+		 case EFFECT_CONSOLE_TEXT:
+				write_text_to_console(effect->console_text.console_index, effect->console_text.print_colour, effect->console_text.text_source, effect->console_text.source_core_created_timestamp, effect->console_text.text);
+				break;
+		 case EFFECT_SOUND:
+				play_game_sound(effect->sound.s, effect->sound.pitch, effect->sound.vol, effect->sound.priority, effect->sound.x, effect->sound.y);
+				break;
+		 case EFFECT_BROADCAST:
+				broadcast_message(core, effect->broadcast.range, effect->broadcast.channel, effect->broadcast.priority, effect->broadcast.message_type,
+																						effect->broadcast.transmitted_target_core_index, effect->broadcast.transmitted_target_core_timestamp,
+																						effect->broadcast.message_length, effect->broadcast.message);
+				break;
+		 case EFFECT_LISTEN_CHANNEL:
+				if (effect->listen_channel.channel == -1)
+					core_ignore_all_channels(core);
+				  else
+  				set_core_listen_channel(core, effect->listen_channel.channel, effect->listen_channel.listen);
+				break;
+		}
+	}
+
+ if (commit->suspended)
+	 resume_bcode(core, &commit->vmstate); // current_commit is NULL here, so this runs to the end
+
+}
+
+// returns 1 if a core executing in the parallel phase has to wait for the commit phase before making this call.
+// op is the call (or print) instruction; call_value is the method type that follows it in the bcode (or -1 if there isn't one).
+int parallel_call_must_wait(int op, int call_value)
+{
+
+ if (current_commit->effects > CORE_EFFECTS - CORE_EFFECTS_RESERVE)
+		return 1;
+
+ switch(op)
+	{
+	 case OP_call_object:
+	 case OP_call_class:
+			switch(call_value)
+			{
+			 case CALL_GATHER_DATA:
+			 case CALL_GIVE_DATA:
+			 case CALL_TAKE_DATA:
+			 case CALL_ALLOCATE_DATA:
+					return 1;
+			}
+			return 0;
+
+	 case OP_call_std:
+	 case OP_call_std_var:
+			switch(call_value)
+			{
+// these change things that other cores can see, or have results that depend on things other cores can change:
+			 case SMETHOD_CALL_BUILD_FROM_QUEUE:
+			 case SMETHOD_CALL_ADD_TO_BUILD_QUEUE:
+			 case SMETHOD_CALL_CANCEL_BUILD_QUEUE:
+			 case SMETHOD_CALL_BUILD_PROCESS:
+			 case SMETHOD_CALL_BUILD_REPEAT:
+			 case SMETHOD_CALL_CHARGE_INTERFACE:
+			 case SMETHOD_CALL_CHARGE_INTERFACE_MAX:
+			 case SMETHOD_CALL_SET_INTERFACE_GENERAL:
+			 case SMETHOD_CALL_SET_DEBUG_MODE:
+			 case SMETHOD_CALL_TRANSMIT:
+			 case SMETHOD_CALL_TRANSMIT_TARGET:
+			 case SMETHOD_CALL_COPY_COMMANDS:
+			 case SMETHOD_CALL_GIVE_COMMAND:
+			 case SMETHOD_CALL_GIVE_BUILD_COMMAND:
+			 case SMETHOD_CALL_REPAIR_SELF:
+			 case SMETHOD_CALL_REPAIR_OTHER:
+			 case SMETHOD_CALL_REPAIR_SCAN:
+			 case SMETHOD_CALL_RESTORE_SELF:
+			 case SMETHOD_CALL_RESTORE_OTHER:
+			 case SMETHOD_CALL_RESTORE_SCAN:
+			 case SMETHOD_CALL_SPECIAL_AI:
+					return 1;
+			}
+			return 0;
+
+	}
+
+ return 0;
+
+}
+
+// The defer_*() functions are called instead of the functions they replace when current_commit is not NULL.
+// Console text and sounds are dropped if the effect list is full; parallel_call_must_wait() makes sure there's room for the others.
+
+void defer_console_text(int console_index, int print_colour, int text_source, int source_core_created_timestamp, char* write_text)
+{
+
+ struct core_effect_struct* effect = new_effect(EFFECT_CONSOLE_TEXT);
+
+ if (effect == NULL)
+		return;
+
+ effect->console_text.console_index = console_index;
+ effect->console_text.print_colour = print_colour;
+ effect->console_text.text_source = text_source;
+ effect->console_text.source_core_created_timestamp = source_core_created_timestamp;
+ strncpy(effect->console_text.text, write_text, EFFECT_TEXT_LENGTH - 1);
+ effect->console_text.text [EFFECT_TEXT_LENGTH - 1] = '\0';
+
+}
+
+void defer_game_sound(int s, int pitch, int vol, int priority, al_fixed x, al_fixed y)
+{
+
+ struct core_effect_struct* effect = new_effect(EFFECT_SOUND);
+
+ if (effect == NULL)
+		return;
+
+ effect->sound.s = s;
+ effect->sound.pitch = pitch;
+ effect->sound.vol = vol;
+ effect->sound.priority = priority;
+ effect->sound.x = x;
+ effect->sound.y = y;
+
+}
+
+// the source core is always the core that made the call
+void defer_broadcast(al_fixed broadcast_range, int channel, int priority, int message_type, int transmitted_target_core_index, timestamp transmitted_target_core_timestamp, int message_length, s16b* message)
+{
+
+ struct core_effect_struct* effect = new_effect(EFFECT_BROADCAST);
+ int i;
+
+ if (effect == NULL)
+		return;
+
+ if (message_length > MESSAGE_LENGTH)
+		message_length = MESSAGE_LENGTH;
+
+ effect->broadcast.range = broadcast_range;
+ effect->broadcast.channel = channel;
+ effect->broadcast.priority = priority;
+ effect->broadcast.message_type = message_type;
+ effect->broadcast.transmitted_target_core_index = transmitted_target_core_index;
+ effect->broadcast.transmitted_target_core_timestamp = transmitted_target_core_timestamp;
+ effect->broadcast.message_length = message_length;
+ for (i = 0; i < message_length; i ++)
+	{
+		effect->broadcast.message [i] = message [i];
+	}
+
+}
+
+// channel -1 means ignore all channels
+void defer_listen_channel(int channel, int listen)
+{
+
+ struct core_effect_struct* effect = new_effect(EFFECT_LISTEN_CHANNEL);
+
+ if (effect == NULL)
+		return;
+
+ effect->listen_channel.channel = channel;
+ effect->listen_channel.listen = listen;
+
+}
+
+static struct core_effect_struct* new_effect(int type)
+{
+
+ if (current_commit->effects >= CORE_EFFECTS)
+		return NULL;
+
+ struct core_effect_struct* effect = &current_commit->effect [current_commit->effects];
+
+ current_commit->effects ++;
+ effect->type = type;
+
+ return effect;
+
+}
+
+static void execute_core_in_phase(struct core_commit_struct* commit)
+{
+
+ struct core_struct* core = &w.core [commit->core_index];
+
+ current_commit = commit;
+ commit->suspended = execute_bcode(core, &templ[core->player_index][core->template_index].bcode, core->memory);
+ if (commit->suspended)
+		commit->vmstate = vmstate;
+ current_commit = NULL;
+
+}
+
+// executes cores from the current batch until there are none left. pool.mutex must be locked when this is called (it's locked on return)
+static void execute_waiting_cores(void)
+{
+
+ struct core_commit_struct* commit;
+
+ while (pool.next_core < pool.cores)
+	{
+		commit = &core_commit [pool.next_core];
+		pool.next_core ++;
+		pool.running ++;
+		al_unlock_mutex(pool.mutex);
+
+		execute_core_in_phase(commit);
+
+		al_lock_mutex(pool.mutex);
+		pool.running --;
+	}
+
+ if (pool.running == 0)
+		al_broadcast_cond(pool.done_cond);
+
+}
+
+static void* core_thread(ALLEGRO_THREAD* thread, void* arg)
+{
+
+ int batch;
+
+ al_lock_mutex(pool.mutex);
+
+ batch = pool.batch;
+
+ while(TRUE)
+	{
+		while (pool.batch == batch
+			&& !pool.closing)
+		{
+			al_wait_cond(pool.start_cond, pool.mutex);
+		}
+		if (pool.closing)
+			break;
+		batch = pool.batch;
+		execute_waiting_cores();
+	}
+
+ al_unlock_mutex(pool.mutex);
+
+ return NULL;
+
+}
+
+// starts the worker threads (closing any that are already running). If a thread can't be started the others still work.
+static void start_core_threads(int threads)
+{
+
+ int i;
+
+ close_core_threads();
+
+ pool.threads_wanted = threads;
+
+ if (threads <= 0)
+		return;
+
+ pool.mutex = al_create_mutex();
+ pool.start_cond = al_create_cond();
+ pool.done_cond = al_create_cond();
+ pool.batch = 0;
+ pool.cores = 0;
+ pool.next_core = 0;
+ pool.running = 0;
+ pool.closing = 0;
+
+ if (pool.mutex == NULL
+		|| pool.start_cond == NULL
+		|| pool.done_cond == NULL)
+	{
+		fpr("\nUnable to start core threads.");
+		close_core_threads();
+		return;
+	}
+
+ for (i = 0; i < threads; i ++)
+	{
+		pool.thread [pool.threads] = al_create_thread(core_thread, NULL);
+		if (pool.thread [pool.threads] == NULL)
+			continue;
+		al_start_thread(pool.thread [pool.threads]);
+		pool.threads ++;
+	}
+
+}
+
+static void close_core_threads(void)
+{
+
+ int i;
+
+ if (pool.threads > 0)
+	{
+  al_lock_mutex(pool.mutex);
+  pool.closing = 1;
+  al_broadcast_cond(pool.start_cond);
+  al_unlock_mutex(pool.mutex);
+
+  for (i = 0; i < pool.threads; i ++)
+		{
+			al_join_thread(pool.thread [i], NULL);
+			al_destroy_thread(pool.thread [i]);
+		}
+		pool.threads = 0;
+	}
+
+ if (pool.mutex != NULL)
+		al_destroy_mutex(pool.mutex);
+ if (pool.start_cond != NULL)
+		al_destroy_cond(pool.start_cond);
+ if (pool.done_cond != NULL)
+		al_destroy_cond(pool.done_cond);
+ pool.mutex = NULL;
+ pool.start_cond = NULL;
+ pool.done_cond = NULL;
+
+}
+
@@ -0,0 +1,99 @@
+
+#ifndef H_G_PROC_PAR
+#define H_G_PROC_PAR
+
+#include "v_interp.h"
+
+#define CORE_THREADS_MAX 16
+// settings.option [OPTION_CORE_THREADS] (the "core_threads" line in init.txt) is the number of threads that execute cores at once.
+//  0 (the default) means cores are executed one at a time in the usual way (see run_cores_and_procs() in g_proc_run.c).
+
+#define CORE_EFFECTS 16
+// the most effects that a core running in the parallel phase can leave for the commit phase
+#define CORE_EFFECTS_RESERVE 4
+// a core in the parallel phase waits for the commit phase before any call or print if fewer than this many effects are free
+//  (so that there's always room for the broadcast or channel change a single call can make)
+#define EFFECT_TEXT_LENGTH 120
+
+enum
+{
+EFFECT_CONSOLE_TEXT, // write_text_to_console()
+EFFECT_SOUND, // play_game_sound()
+EFFECT_BROADCAST, // broadcast_message()
+EFFECT_LISTEN_CHANNEL, // set_core_listen_channel(). channel -1 means core_ignore_all_channels()
+};
+
+struct core_effect_struct
+{
+ int type; // EFFECT_ enum
+
+ union
+	{
+		struct
+		{
+			int console_index;
+			int print_colour;
+			int text_source;
+			int source_core_created_timestamp;
+			char text [EFFECT_TEXT_LENGTH];
+		} console_text;
+
+		struct
+		{
+			int s;
+			int pitch;
+			int vol;
+			int priority;
+			al_fixed x, y;
+		} sound;
+
+		struct
+		{
+			al_fixed range;
+			int channel;
+			int priority;
+			int message_type;
+			int transmitted_target_core_index;
+			timestamp transmitted_target_core_timestamp;
+			int message_length;
+			s16b message [MESSAGE_LENGTH];
+		} broadcast;
+
+		struct
+		{
+			int channel;
+			int listen;
+		} listen_channel;
+	};
+};
+
+// what happened when a core was executed in the parallel phase, and what's left to do for it in the commit phase
+struct core_commit_struct
+{
+ int core_index;
+ timestamp created_timestamp;
+ unsigned int random_seed; // used by the random() smethod instead of the player's random seed (see call_std_method())
+
+ int suspended; // 1 if execution stopped at a call that has to wait for the commit phase. vmstate is the state to resume from.
+ struct vmstate_struct vmstate;
+
+ int effects;
+ struct core_effect_struct effect [CORE_EFFECTS];
+};
+
+// the commit record of the core this thread is executing in the parallel phase, or NULL if it isn't (which is always the case for
+//  the main thread outside execute_cores_in_parallel())
+extern THREAD_LOCAL struct core_commit_struct* current_commit;
+
+void execute_cores_in_parallel(int* core_list, int cores);
+int core_execution_suspended(int list_index);
+void commit_core_execution(int list_index);
+
+int parallel_call_must_wait(int op, int call_value);
+
+void defer_console_text(int console_index, int print_colour, int text_source, int source_core_created_timestamp, char* write_text);
+void defer_game_sound(int s, int pitch, int vol, int priority, al_fixed x, al_fixed y);
+void defer_broadcast(al_fixed broadcast_range, int channel, int priority, int message_type, int transmitted_target_core_index, timestamp transmitted_target_core_timestamp, int message_length, s16b* message);
+void defer_listen_channel(int channel, int listen);
+
+#endif
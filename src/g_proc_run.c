@@ -18,17 +18,30 @@
 #include "g_method_std.h"
 
 #include "v_interp.h"
+#include "g_proc_par.h"
+#include "g_proc_run.h"
+#include "g_sim.h"
 #include "v_draw_panel.h"
 #include "x_sound.h"
+#include "m_profile.h"
 
 extern struct template_struct templ [PLAYERS] [TEMPLATES_PER_PLAYER];
 extern struct game_struct game;
 extern struct view_struct view;
 extern struct bcode_panel_state_struct bcp_state;
 
-static void	place_under_attack_marker(al_fixed marker_x, al_fixed marker_y);
+static void run_cores_in_phases(void);
+static void prepare_core_for_execution(struct core_struct* core);
+static int finish_core_execution(struct core_struct* core, int clear_messages);
+static void clear_core_messages(struct core_struct* core);
+static void clear_messages_received_before(struct core_struct* core, int messages);
 
 // resume_loop_after_watch_with_core should be -1 if we're not resuming after watching
+// Cores are normally executed one at a time in index order, and this order is part of the game's behaviour:
+//  - method calls change the world immediately (e.g. building a new process, harvesting data, spending data, sending messages to other cores)
+//     and cores executed later in the same tick see these changes.
+// If settings.option [OPTION_CORE_THREADS] is set, cores are instead executed in phases across several threads (see run_cores_in_phases() below
+//  and g_proc_par.c). This gives different (but still deterministic) results, so it's optional. It isn't used while watching a core execute.
 void run_cores_and_procs(int resume_loop_after_watch_with_core)
 {
 
@@ -36,8 +49,16 @@ void run_cores_and_procs(int resume_loop_after_watch_with_core)
 
  if (resume_loop_after_watch_with_core == -1)
 	{
+  PROFILE_START(PROFILE_MOTION);
   run_motion();
+  PROFILE_END(PROFILE_MOTION);
   first_core = 0;
+  if (settings.option [OPTION_CORE_THREADS] != 0
+			&& game.watching == WATCH_OFF)
+		{
+			run_cores_in_phases();
+			return;
+		}
 	}
 	 else
 			first_core = resume_loop_after_watch_with_core;
@@ -47,7 +68,7 @@ void run_cores_and_procs(int resume_loop_after_watch_with_core)
  int c;
  struct core_struct* core;
 
- for (c = first_core; c < w.max_cores; c ++)
+ for (c = next_used_core(first_core); c != -1; c = next_used_core(c + 1))
 	{
 
   if (w.core[c].exists == 0)
@@ -66,20 +87,7 @@ void run_cores_and_procs(int resume_loop_after_watch_with_core)
 			{
 // none of the following code needs to run if we're resuming after pausing to watch a process execute:
 //  (however, some of the later code does need to run)
-    if (core->player_index == game.user_player_index
-			 	&& core->damage_this_cycle > 0)
-			 {
-			 	place_under_attack_marker(core->core_position.x, core->core_position.y);
-			 }
-
-			 core->power_left = core->power_capacity;
-			 core->power_use_excess = 0;
-
-    run_objects_before_execution(core);
-
-    core->last_execution_timestamp = w.world_time;
-    core->next_execution_timestamp = w.world_time + EXECUTION_COUNT;
-    core->cycles_executed ++;
+    prepare_core_for_execution(core);
 
     if (game.watching == WATCH_ON
 				 && bcp_state.watch_core_index == c
@@ -91,25 +99,16 @@ void run_cores_and_procs(int resume_loop_after_watch_with_core)
      return;
 			 }
  			 else
+				 {
+      PROFILE_START(PROFILE_CORES);
       execute_bcode(core, &templ[core->player_index][core->template_index].bcode, core->memory);
+      PROFILE_END(PROFILE_CORES);
+      profile.cores_executed ++;
+				 }
 			} // end if (c != first_core)
 
-
-   if (core->self_destruct)
-			{
-				core_proc_explodes(&w.proc[core->process_index], core->player_index);
-				continue;
-			}
-
-   core->messages_received = 0;
-   core->message_reading = -1; // starts at -1 because next_message() increments it. If this is >= core->messages_received, core has finished reading messages
-   core->message_position = 0;
-
-   core->contact_core_index = -1;
-   core->damage_this_cycle = 0;
-   core->damage_source_core_index = -1;
-
-   run_objects_after_execution(core);
+   if (!finish_core_execution(core, 1))
+				continue; // core self-destructed
   }
 
   run_objects_each_tick(core);
@@ -150,23 +149,166 @@ void run_cores_and_procs(int resume_loop_after_watch_with_core)
 
 }
 
-static void	place_under_attack_marker(al_fixed marker_x, al_fixed marker_y)
+// Executes the cores that are due this tick in three phases:
+//  - a serial pre-pass that does everything that happens before a core executes,
+//  - a parallel phase that executes the cores using OPTION_CORE_THREADS threads (execute_cores_in_parallel() in g_proc_par.c),
+//  - a serial commit phase that, for each core in index order, does whatever its execution left for this phase
+//     (commit_core_execution()) and then everything that happens after a core executes.
+// Then every core's objects are run for this tick, as usual.
+// The cores are executed in the same order whatever the number of threads, so the results don't depend on it.
+static void run_cores_in_phases(void)
+{
+
+ static int execute_list [MAX_CORES];
+ static int messages_before_commit [MAX_CORES];
+ int executing = 0;
+ int c, i;
+ struct core_struct* core;
+
+ w.debug_mode = w.debug_mode_general;
+
+ for (c = next_used_core(0); c != -1; c = next_used_core(c + 1))
+	{
+  if (w.core[c].exists == 0
+			|| w.core[c].next_execution_timestamp != w.world_time)
+   continue;
+  prepare_core_for_execution(&w.core[c]);
+  execute_list [executing] = c;
+  executing ++;
+	}
+
+ PROFILE_START(PROFILE_CORES);
+ execute_cores_in_parallel(execute_list, executing);
+ PROFILE_END(PROFILE_CORES);
+ profile.cores_executed += executing;
+
+// Messages sent in the commit phase should be read at the core's next execution, so cores that have finished executing
+//  clear their messages before any are sent. Cores that are still executing can read messages from cores committed before
+//  them (as they can when executed one at a time), but may already have stopped reading, so when they finish they only clear
+//  the messages they had when the commit phase started.
+ for (i = 0; i < executing; i ++)
+	{
+		if (!core_execution_suspended(i))
+			clear_core_messages(&w.core [execute_list [i]]);
+		  else
+		   messages_before_commit [i] = w.core [execute_list [i]].messages_received;
+	}
+
+ for (i = 0; i < executing; i ++)
+	{
+		core = &w.core [execute_list [i]];
+// a core can't be destroyed by anything done in the commit phase for a core before it, but check anyway:
+		if (core->exists == 0)
+			continue;
+  w.debug_mode = w.debug_mode_general;
+		commit_core_execution(i);
+		if (finish_core_execution(core, 0)
+			&& core_execution_suspended(i))
+			clear_messages_received_before(core, messages_before_commit [i]);
+	}
+
+ for (c = next_used_core(0); c != -1; c = next_used_core(c + 1))
+	{
+  if (w.core[c].exists == 0)
+   continue;
+  run_objects_each_tick(&w.core[c]);
+	}
+
+}
+
+// everything that happens just before a core executes
+static void prepare_core_for_execution(struct core_struct* core)
+{
+
+ if (core->player_index == game.user_player_index
+		&& core->damage_this_cycle > 0)
+	{
+	 if (on_sim_thread())
+			defer_under_attack_marker(core->core_position.x, core->core_position.y, w.world_time); // the display may be using the markers (see g_sim.c)
+		  else
+		   place_under_attack_marker(core->core_position.x, core->core_position.y, w.world_time);
+	}
+
+	core->power_left = core->power_capacity;
+	core->power_use_excess = 0;
+
+ run_objects_before_execution(core);
+
+ core->last_execution_timestamp = w.world_time;
+ core->next_execution_timestamp = w.world_time + EXECUTION_COUNT;
+ core->cycles_executed ++;
+
+}
+
+// everything that happens just after a core executes.
+// returns 0 if the core self-destructed, 1 otherwise
+static int finish_core_execution(struct core_struct* core, int clear_messages)
+{
+
+ if (core->self_destruct)
+	{
+		core_proc_explodes(&w.proc[core->process_index], core->player_index);
+		return 0;
+	}
+
+ if (clear_messages)
+		clear_core_messages(core);
+
+ core->contact_core_index = -1;
+ core->damage_this_cycle = 0;
+ core->damage_source_core_index = -1;
+
+ run_objects_after_execution(core);
+
+ return 1;
+
+}
+
+static void clear_core_messages(struct core_struct* core)
+{
+
+ core->messages_received = 0;
+ core->message_reading = -1; // starts at -1 because next_message() increments it. If this is >= core->messages_received, core has finished reading messages
+ core->message_position = 0;
+
+}
+
+// clears the first messages messages received by core and keeps any received after them.
+// (a message received when the core's list is full may replace an earlier one, in which case it's cleared too)
+static void clear_messages_received_before(struct core_struct* core, int messages)
+{
+
+ int i;
+
+ for (i = messages; i < core->messages_received; i ++)
+	{
+		core->message [i - messages] = core->message [i];
+	}
+
+ core->messages_received -= messages; // messages are never removed during the commit phase, so this can't be negative
+ core->message_reading = -1;
+ core->message_position = 0;
+
+}
+
+// time_placed is the w.world_time of the tick that placed the marker (see also apply_sim_ui_changes() in g_sim.c)
+void	place_under_attack_marker(al_fixed marker_x, al_fixed marker_y, timestamp time_placed)
 {
 
 	int marker_index = 0;
 
-	if (view.under_attack_marker_last_time >= w.world_time - UNDER_ATTACK_MARKER_DURATION)
+	if (view.under_attack_marker_last_time >= time_placed - UNDER_ATTACK_MARKER_DURATION)
 	{
 // first make sure there isn't already one here:
   int i;
   for (i = 0; i < UNDER_ATTACK_MARKERS; i ++)
 		{
-			if (view.under_attack_marker [i].time_placed_world >= w.world_time - UNDER_ATTACK_MARKER_DURATION
+			if (view.under_attack_marker [i].time_placed_world >= time_placed - UNDER_ATTACK_MARKER_DURATION
 			 && abs(marker_x - view.under_attack_marker[i].position.x) < al_itofix(2000)
 				&& abs(marker_y - view.under_attack_marker[i].position.y) < al_itofix(2000))
 					return;
 		}
-		while(view.under_attack_marker [marker_index].time_placed_world >= w.world_time - UNDER_ATTACK_MARKER_DURATION)
+		while(view.under_attack_marker [marker_index].time_placed_world >= time_placed - UNDER_ATTACK_MARKER_DURATION)
 		{
 			marker_index ++;
 		}
@@ -174,8 +316,8 @@ static void	place_under_attack_marker(al_fixed marker_x, al_fixed marker_y)
 			return; // already too many
 	}
 
-	view.under_attack_marker[marker_index].time_placed_world = w.world_time;
-	view.under_attack_marker_last_time = w.world_time;
+	view.under_attack_marker[marker_index].time_placed_world = time_placed;
+	view.under_attack_marker_last_time = time_placed;
 	view.under_attack_marker[marker_index].position.x = marker_x;
 	view.under_attack_marker[marker_index].position.y = marker_y;
 
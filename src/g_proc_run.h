@@ -3,5 +3,6 @@
 #define H_G_PROC_RUN
 
 void run_cores_and_procs(int resume_loop_after_watch_with_core);
+void place_under_attack_marker(al_fixed marker_x, al_fixed marker_y, timestamp time_placed);
 
 #endif
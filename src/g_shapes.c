@@ -17,6 +17,7 @@
 
 struct nshape_struct nshape [NSHAPES];
 struct dshape_struct dshape [NSHAPES]; // uses same indices as NSHAPES
+al_fixed largest_nshape_max_length; // largest max_length of any nshape. Set in init_nshape_collision_masks()
 
 // this struct holds polygon information for use in the collision mask drawing function.
 // it could be held in nshape instead, but is only used during initialisation
@@ -3079,6 +3080,8 @@ void init_nshape_collision_masks(void)
 //  int base_area = 0;
 
 
+ largest_nshape_max_length = 0;
+
  for (s = 0; s < NSHAPES; s ++)
  {
   for (x = 0; x < COLLISION_MASK_SIZE; x ++)
@@ -3202,6 +3205,31 @@ test_draw_mask(s);
 		}
 */
 
+  if (nshape[s].max_length > largest_nshape_max_length)
+   largest_nshape_max_length = nshape[s].max_length;
+
+// work out how far the solid part of the mask (level 2 or above) extends from the centre.
+// check_nshape_nshape_collision() uses this to skip pairs of shapes that are too far apart to collide.
+// Each mask pixel covers (1<<COLLISION_MASK_BITSHIFT) world pixels, plus rounding, so the furthest edge of each pixel is used.
+  nshape[s].collision_mask_radius = 0;
+  for (x = 0; x < COLLISION_MASK_SIZE; x ++)
+  {
+   for (y = 0; y < COLLISION_MASK_SIZE; y ++)
+   {
+    if (nshape_collision_mask [s] [x] [y] < 2)
+     continue;
+    int offset_x = abs((x << COLLISION_MASK_BITSHIFT) - MASK_CENTRE);
+    if (abs(((x + 1) << COLLISION_MASK_BITSHIFT) - 1 - MASK_CENTRE) > offset_x)
+     offset_x = abs(((x + 1) << COLLISION_MASK_BITSHIFT) - 1 - MASK_CENTRE);
+    int offset_y = abs((y << COLLISION_MASK_BITSHIFT) - MASK_CENTRE);
+    if (abs(((y + 1) << COLLISION_MASK_BITSHIFT) - 1 - MASK_CENTRE) > offset_y)
+     offset_y = abs(((y + 1) << COLLISION_MASK_BITSHIFT) - 1 - MASK_CENTRE);
+    al_fixed radius = distance(al_itofix(offset_y + 1), al_itofix(offset_x + 1));
+    if (radius > nshape[s].collision_mask_radius)
+     nshape[s].collision_mask_radius = radius;
+   }
+  }
+
  } // end of NSHAPES loop
 
 
@@ -103,6 +103,7 @@ struct nshape_struct
  al_fixed vertex_dist_fixed [NSHAPE_VERTICES]; // from centre of shape
 
  al_fixed max_length; // longest radius (from zero point) of any point in the shape (in GRAIN units)
+ al_fixed collision_mask_radius; // distance from centre to the furthest part of the collision mask at level 2 or above (set in init_nshape_collision_masks())
 
  int links; // how many links it can have. Probably max 4.
  al_fixed link_angle_fixed [MAX_LINKS];
@@ -0,0 +1,361 @@
+#include <allegro5/allegro.h>
+
+#include <stdio.h>
+
+#include "m_config.h"
+#include "m_globvars.h"
+
+#include "g_header.h"
+#include "g_game.h"
+#include "g_command.h"
+#include "g_proc_run.h"
+#include "i_console.h"
+
+#include "g_sim.h"
+
+extern struct command_struct command;
+
+/*
+
+Simulation thread
+
+When settings.option [OPTION_SIM_THREAD] is set, main_game_loop() (g_game.c) runs world ticks on a simulation thread while
+ the main thread keeps drawing the display:
+ - at the end of each tick, the main thread (the only thread that touches the world between ticks) handles input, commands
+    and the rest of the interface as usual, then publishes a snapshot of the world (see i_snapshot.c) and starts the next tick
+    on the simulation thread.
+ - while the tick is running, the display draws the snapshot instead of w (it uses the dw pointer, which points to the snapshot
+    while ticks are running on this thread, and to w otherwise). Nothing else on the main thread looks at the world until the
+    tick has finished, so frames drawn during a tick do nothing but draw.
+ - the parts of a tick that need the main thread (fog of war and game end checks, sounds, etc.) are run by main_game_loop()
+    after the tick has finished.
+
+A tick on the simulation thread can't change the interface while the display is using it, so anything it would have done
+ to the interface (deselecting a destroyed core, placing an under attack marker, resetting the build queue buttons) is left
+ for apply_sim_ui_changes() to do after the tick. Console text is the exception: it's protected by lock_consoles() because
+ the display needs to show it as soon as it's written.
+
+Ticks run on the main thread in the usual way while anything else needs to look at the world during a tick (the process
+ debugger panel and watched processes) or while the game is paused or fast-forwarding.
+
+*/
+
+enum
+{
+SIM_TICK_NONE, // no tick has been started
+SIM_TICK_STARTED, // set by the main thread
+SIM_TICK_FINISHED // set by the simulation thread
+};
+
+struct sim_thread_struct
+{
+ int running; // 1 if the thread has been started for this game
+ ALLEGRO_THREAD* thread;
+ ALLEGRO_MUTEX* mutex;
+ ALLEGRO_COND* cond;
+ int tick_state; // SIM_TICK_* - protected by mutex
+ ALLEGRO_MUTEX* console_mutex; // see lock_consoles()
+};
+
+static struct sim_thread_struct sim_thread;
+
+static THREAD_LOCAL int this_is_sim_thread = 0;
+
+#define DEFERRED_MARKERS 16
+
+struct sim_ui_changes_struct
+{
+ int selections_removed;
+ int selection_removed [SELECT_MAX + 1]; // indices in command.selected_core of cores deselected during the tick
+ int member_deselected;
+
+ int markers;
+ struct
+	{
+		al_fixed x, y;
+		timestamp time_placed;
+	} marker [DEFERRED_MARKERS];
+
+ int reset_build_queue_buttons;
+ int cancel_build_queue_drag;
+};
+
+static struct sim_ui_changes_struct sim_ui_changes;
+
+static void* sim_thread_function(ALLEGRO_THREAD* thread, void* arg);
+
+
+void start_sim_thread(void)
+{
+
+ sim_thread.running = 0;
+ sim_thread.tick_state = SIM_TICK_NONE;
+
+ sim_ui_changes.selections_removed = 0;
+ sim_ui_changes.member_deselected = 0;
+ sim_ui_changes.markers = 0;
+ sim_ui_changes.reset_build_queue_buttons = 0;
+ sim_ui_changes.cancel_build_queue_drag = 0;
+
+ sim_thread.mutex = al_create_mutex();
+ sim_thread.cond = al_create_cond();
+ sim_thread.console_mutex = al_create_mutex();
+
+ if (sim_thread.mutex == NULL
+		|| sim_thread.cond == NULL
+		|| sim_thread.console_mutex == NULL)
+	{
+		fprintf(stdout, "\nFailed to create simulation thread mutex or condition. Running simulation on main thread.");
+		if (sim_thread.mutex != NULL)
+			al_destroy_mutex(sim_thread.mutex);
+		if (sim_thread.cond != NULL)
+			al_destroy_cond(sim_thread.cond);
+		if (sim_thread.console_mutex != NULL)
+			al_destroy_mutex(sim_thread.console_mutex);
+		return;
+	}
+
+ sim_thread.thread = al_create_thread(sim_thread_function, NULL);
+
+ if (sim_thread.thread == NULL)
+	{
+		fprintf(stdout, "\nFailed to create simulation thread. Running simulation on main thread.");
+		al_destroy_mutex(sim_thread.mutex);
+		al_destroy_cond(sim_thread.cond);
+		al_destroy_mutex(sim_thread.console_mutex);
+		return;
+	}
+
+ al_start_thread(sim_thread.thread);
+
+ sim_thread.running = 1;
+
+}
+
+// waits for any tick that is still running (its results are discarded, so this should only be called at the end of a game)
+void stop_sim_thread(void)
+{
+
+ if (!sim_thread.running)
+		return;
+
+ finish_sim_tick();
+
+ al_lock_mutex(sim_thread.mutex);
+ al_set_thread_should_stop(sim_thread.thread);
+ al_broadcast_cond(sim_thread.cond);
+ al_unlock_mutex(sim_thread.mutex);
+
+ al_join_thread(sim_thread.thread, NULL);
+ al_destroy_thread(sim_thread.thread);
+ al_destroy_cond(sim_thread.cond);
+ al_destroy_mutex(sim_thread.mutex);
+ al_destroy_mutex(sim_thread.console_mutex);
+
+ sim_thread.running = 0;
+
+}
+
+int sim_thread_running(void)
+{
+
+ return sim_thread.running;
+
+}
+
+// returns 1 if this is the simulation thread (which means that anything the caller does to the interface needs to be deferred)
+int on_sim_thread(void)
+{
+
+ return this_is_sim_thread;
+
+}
+
+// the world and the interface must be ready for the tick (see main_game_loop())
+void start_sim_tick(void)
+{
+
+ al_lock_mutex(sim_thread.mutex);
+ sim_thread.tick_state = SIM_TICK_STARTED;
+ al_broadcast_cond(sim_thread.cond);
+ al_unlock_mutex(sim_thread.mutex);
+
+}
+
+// returns 1 if a tick started by start_sim_tick() hasn't finished yet
+int sim_tick_running(void)
+{
+
+ int running;
+
+ if (!sim_thread.running)
+		return 0;
+
+ al_lock_mutex(sim_thread.mutex);
+ running = (sim_thread.tick_state == SIM_TICK_STARTED);
+ al_unlock_mutex(sim_thread.mutex);
+
+ return running;
+
+}
+
+// Waits for a tick started by start_sim_tick() to finish.
+// Returns 1 if a tick finished (so the caller should finish it on the main thread), or 0 if no tick was started.
+int finish_sim_tick(void)
+{
+
+ if (!sim_thread.running)
+		return 0;
+
+ al_lock_mutex(sim_thread.mutex);
+ if (sim_thread.tick_state == SIM_TICK_NONE)
+	{
+		al_unlock_mutex(sim_thread.mutex);
+		return 0;
+	}
+ while (sim_thread.tick_state != SIM_TICK_FINISHED)
+	{
+		al_wait_cond(sim_thread.cond, sim_thread.mutex);
+	}
+ sim_thread.tick_state = SIM_TICK_NONE;
+ al_unlock_mutex(sim_thread.mutex);
+
+ return 1;
+
+}
+
+static void* sim_thread_function(ALLEGRO_THREAD* thread, void* arg)
+{
+
+ this_is_sim_thread = 1;
+
+ while(TRUE)
+	{
+		al_lock_mutex(sim_thread.mutex);
+		while (sim_thread.tick_state != SIM_TICK_STARTED
+			&& !al_get_thread_should_stop(thread))
+		{
+			al_wait_cond(sim_thread.cond, sim_thread.mutex);
+		}
+		al_unlock_mutex(sim_thread.mutex);
+
+		if (al_get_thread_should_stop(thread))
+			break;
+
+  simulate_world_tick();
+
+		al_lock_mutex(sim_thread.mutex);
+		sim_thread.tick_state = SIM_TICK_FINISHED;
+		al_broadcast_cond(sim_thread.cond);
+		al_unlock_mutex(sim_thread.mutex);
+	}
+
+ return NULL;
+
+}
+
+// the consoles are written to by ticks on the simulation thread while the display is drawing them.
+// These do nothing if the simulation thread isn't running.
+void lock_consoles(void)
+{
+
+ if (sim_thread.running)
+		al_lock_mutex(sim_thread.console_mutex);
+
+}
+
+void unlock_consoles(void)
+{
+
+ if (sim_thread.running)
+		al_unlock_mutex(sim_thread.console_mutex);
+
+}
+
+// select_index is the core's index in command.selected_core (see remove_core_from_selection())
+void defer_selection_removal(int select_index)
+{
+
+ if (sim_ui_changes.selections_removed >= SELECT_MAX + 1)
+		return; // can't happen, as each selected core can only be removed once
+
+ sim_ui_changes.selection_removed [sim_ui_changes.selections_removed] = select_index;
+ sim_ui_changes.selections_removed ++;
+
+}
+
+void defer_member_deselection(void)
+{
+
+ sim_ui_changes.member_deselected = 1;
+
+}
+
+void defer_under_attack_marker(al_fixed marker_x, al_fixed marker_y, timestamp time_placed)
+{
+
+ if (sim_ui_changes.markers >= DEFERRED_MARKERS)
+		return; // place_under_attack_marker() won't place more than UNDER_ATTACK_MARKERS anyway
+
+ sim_ui_changes.marker [sim_ui_changes.markers].x = marker_x;
+ sim_ui_changes.marker [sim_ui_changes.markers].y = marker_y;
+ sim_ui_changes.marker [sim_ui_changes.markers].time_placed = time_placed;
+ sim_ui_changes.markers ++;
+
+}
+
+void defer_build_queue_buttons_reset(void)
+{
+
+ sim_ui_changes.reset_build_queue_buttons = 1;
+
+}
+
+void defer_build_queue_drag_cancel(void)
+{
+
+ sim_ui_changes.cancel_build_queue_drag = 1;
+
+}
+
+// called by main_game_loop() after a tick on the simulation thread has finished.
+// Does the same things to the interface that the tick would have done if it had been run on the main thread.
+void apply_sim_ui_changes(void)
+{
+
+ int i;
+
+ if (sim_ui_changes.selections_removed > 0)
+	{
+	 remove_selection_entries(sim_ui_changes.selection_removed, sim_ui_changes.selections_removed);
+	 sim_ui_changes.selections_removed = 0;
+	}
+
+ if (sim_ui_changes.member_deselected)
+	{
+		command.selected_member = -1;
+		sim_ui_changes.member_deselected = 0;
+	}
+
+ for (i = 0; i < sim_ui_changes.markers; i ++)
+	{
+		place_under_attack_marker(sim_ui_changes.marker[i].x, sim_ui_changes.marker[i].y, sim_ui_changes.marker[i].time_placed);
+	}
+ sim_ui_changes.markers = 0;
+
+ if (sim_ui_changes.cancel_build_queue_drag)
+	{
+		if (control.mouse_drag == MOUSE_DRAG_BUILD_QUEUE)
+			control.mouse_drag = MOUSE_DRAG_NONE;
+		sim_ui_changes.cancel_build_queue_drag = 0;
+	}
+
+ if (sim_ui_changes.reset_build_queue_buttons)
+	{
+// the queue length is worked out again from the queue as it is at the end of the tick:
+		if (command.display_build_buttons)
+ 		reset_build_queue_buttons_y1(-1);
+		sim_ui_changes.reset_build_queue_buttons = 0;
+	}
+
+}
@@ -0,0 +1,27 @@
+
+#ifndef H_G_SIM
+#define H_G_SIM
+
+// settings.option [OPTION_SIM_THREAD] (the "sim_thread" line in init.txt) runs world ticks on a simulation thread while
+//  the display draws a snapshot of the world (see g_sim.c and i_snapshot.c).
+
+void start_sim_thread(void);
+void stop_sim_thread(void);
+int sim_thread_running(void);
+int on_sim_thread(void);
+
+void start_sim_tick(void);
+int sim_tick_running(void);
+int finish_sim_tick(void);
+
+void lock_consoles(void);
+void unlock_consoles(void);
+
+void defer_selection_removal(int select_index);
+void defer_member_deselection(void);
+void defer_under_attack_marker(al_fixed marker_x, al_fixed marker_y, timestamp time_placed);
+void defer_build_queue_buttons_reset(void);
+void defer_build_queue_drag_cancel(void);
+void apply_sim_ui_changes(void);
+
+#endif
@@ -34,6 +34,8 @@
 #include "m_maths.h"
 #include "i_disp_in.h"
 #include "i_background.h"
+#include "i_back_cache.h"
+#include "i_snapshot.h"
 #include "s_menu.h"
 
 #include "c_prepr.h"
@@ -160,26 +162,66 @@ void new_world_from_world_init(void)
 
  int p;
 
+ if (w.allocated)
+  deallocate_world(); // shouldn't happen, but just in case
+
+// each block array is allocated as one contiguous array, with w.block [i] pointing to the start of column i
  w.block = calloc(w.blocks.x, sizeof(struct block_struct*));
  if (w.block == NULL)
  {
       fprintf(stdout, "g_world.c: Out of memory in allocating w.block");
       error_call();
  }
- for (i = 0; i < w.blocks.x; i ++)
+ w.block [0] = calloc(w.blocks.x * w.blocks.y, sizeof(struct block_struct));
+ if (w.block [0] == NULL)
  {
-   w.block [i] = calloc(w.blocks.y, sizeof(struct block_struct));
-   if (w.block [i] == NULL)
-   {
       fprintf(stdout, "g_world.c: Out of memory in allocating w.block");
       error_call();
-   }
+ }
+ for (i = 1; i < w.blocks.x; i ++)
+ {
+   w.block [i] = w.block [0] + (i * w.blocks.y);
  }
 
-// allocation code for backblocks not done yet
+ w.backblock = calloc(w.blocks.x, sizeof(struct backblock_struct*));
+ if (w.backblock == NULL)
+ {
+      fprintf(stdout, "g_world.c: Out of memory in allocating w.backblock");
+      error_call();
+ }
+ w.backblock [0] = calloc(w.blocks.x * w.blocks.y, sizeof(struct backblock_struct));
+ if (w.backblock [0] == NULL)
+ {
+      fprintf(stdout, "g_world.c: Out of memory in allocating w.backblock");
+      error_call();
+ }
+ for (i = 1; i < w.blocks.x; i ++)
+ {
+   w.backblock [i] = w.backblock [0] + (i * w.blocks.y);
+ }
+
+ w.vision_block = calloc(w.blocks.x, sizeof(struct vision_block_struct*));
+ if (w.vision_block == NULL)
+ {
+      fprintf(stdout, "g_world.c: Out of memory in allocating w.vision_block");
+      error_call();
+ }
+ w.vision_block [0] = calloc(w.blocks.x * w.blocks.y, sizeof(struct vision_block_struct));
+ if (w.vision_block [0] == NULL)
+ {
+      fprintf(stdout, "g_world.c: Out of memory in allocating w.vision_block");
+      error_call();
+ }
+ for (i = 1; i < w.blocks.x; i ++)
+ {
+   w.vision_block [i] = w.vision_block [0] + (i * w.blocks.y);
+ }
 
 #endif
 
+// the display's cache of background node vertices (i_back_cache.c) is divided up in the same way as the blocks:
+ init_back_cache();
+
 
 // block_type is used for collision detection:
 
@@ -226,22 +268,25 @@ void new_world_from_world_init(void)
 #ifdef USE_DYNAMIC_MEMORY
 
 
- for (p = 0; p < w.players; p ++)
-	{
-  w.vision_area [p] = calloc(w.vision_areas_x, sizeof(struct vision_area_struct*));
-  if (w.vision_area [p] == NULL)
-  {
+// all players' vision areas are allocated together: one array of column pointers (w.vision_area [p] points to player p's part of it)
+//  and one contiguous array of vision_area_structs
+ struct vision_area_struct** vision_area_columns;
+ struct vision_area_struct* vision_area_data;
+
+ vision_area_columns = calloc(w.players * w.vision_areas_x, sizeof(struct vision_area_struct*));
+ vision_area_data = calloc(w.players * w.vision_areas_x * w.vision_areas_y, sizeof(struct vision_area_struct));
+ if (vision_area_columns == NULL
+		|| vision_area_data == NULL)
+ {
       fprintf(stdout, "g_world.c: Out of memory in allocating w.vision_area");
       error_call();
-  }
+ }
+ for (p = 0; p < w.players; p ++)
+	{
+  w.vision_area [p] = vision_area_columns + (p * w.vision_areas_x);
   for (i = 0; i < w.vision_areas_x; i ++)
   {
-   w.vision_area [p] [i] = calloc(w.vision_areas_y, sizeof(struct vision_area_struct));
-   if (w.vision_area [p] [i] == NULL)
-   {
-      fprintf(stdout, "g_world.c: Out of memory in allocating w.vision_area");
-      error_call();
-   }
+   w.vision_area [p] [i] = vision_area_data + ((p * w.vision_areas_x + i) * w.vision_areas_y);
   }
 	}
 
@@ -262,6 +307,13 @@ void new_world_from_world_init(void)
       fprintf(stdout, "g_world.c: Out of memory in allocating w.proc");
       error_call();
  }
+
+ w.proc_box = calloc(w.max_procs, sizeof(struct proc_box_struct));
+ if (w.proc_box == NULL)
+ {
+      fprintf(stdout, "g_world.c: Out of memory in allocating w.proc_box");
+      error_call();
+ }
 // when adding any dynamic memory allocation to this function, remember to free the memory in deallocate_world() below
 
 // now allocate the packet array:
@@ -280,6 +332,29 @@ void new_world_from_world_init(void)
       fprintf(stdout, "g_world.c: Out of memory in allocating w.cloud");
       error_call();
  }
+
+// broadcast listener lists:
+ for (i = 0; i < CHANNELS; i ++)
+	{
+  w.channel_listener [i] = calloc(w.max_cores, sizeof(int));
+  if (w.channel_listener [i] == NULL)
+  {
+      fprintf(stdout, "g_world.c: Out of memory in allocating w.channel_listener");
+      error_call();
+  }
+	}
+
+// free entry bitmaps (set up in initialise_world() and init_packets()):
+ w.core_free_bits = calloc(POOL_BITS_WORDS(w.max_cores), sizeof(unsigned int));
+ w.proc_free_bits = calloc(POOL_BITS_WORDS(w.max_procs), sizeof(unsigned int));
+ w.packet_free_bits = calloc(POOL_BITS_WORDS(w.max_packets), sizeof(unsigned int));
+ if (w.core_free_bits == NULL
+		|| w.proc_free_bits == NULL
+		|| w.packet_free_bits == NULL)
+ {
+      fprintf(stdout, "g_world.c: Out of memory in allocating free bitmaps");
+      error_call();
+ }
 // when adding any dynamic memory allocation to this function, remember to free the memory in deallocate_world() below
 #endif
 
@@ -310,6 +385,8 @@ void new_world_from_world_init(void)
 
  }
 
+ init_random_numbers(w_init.game_seed);
+
 // w.system_output_console = 0;
 // w.system_error_console = 0;
 
@@ -326,6 +403,38 @@ w.player[0].data = 2000;
 
 
 
+// Sets the free entry bitmaps (see g_header.h) from the exists and reserved values of every core, proc and packet.
+// Used after loading a saved game (the bitmaps aren't saved).
+void rebuild_free_bits(void)
+{
+
+ int i;
+
+ for (i = 0; i < w.max_cores; i ++)
+ {
+  if (w.core[i].exists == 0)
+   set_pool_bit(w.core_free_bits, i);
+    else
+     clear_pool_bit(w.core_free_bits, i);
+ }
+
+ for (i = 0; i < w.max_procs; i ++)
+ {
+  update_proc_free_bit(&w.proc[i]);
+ }
+
+ for (i = 0; i < w.max_packets; i ++)
+ {
+  if (w.packet[i].exists == 0)
+   set_pool_bit(w.packet_free_bits, i);
+    else
+     clear_pool_bit(w.packet_free_bits, i);
+ }
+
+}
+
+
+
 // This function clears an existing world so it can be re-used (or initialises one just created in new_world_from_world_init()).
 // The world's basic parameters (e.g. size, number of procs etc) should have been established, so new_world_from_world_init() must have been called first.
 void initialise_world(void)
@@ -345,18 +454,42 @@ void initialise_world(void)
 
 // world_time starts after 0 so that things like deallocation counters can be subtracted from it without running into unsigned int problems
 
+ for (i = 0; i < POOL_BITS_WORDS(w.max_cores); i ++)
+ {
+  w.core_free_bits [i] = 0;
+ }
+
+ for (i = 0; i < POOL_BITS_WORDS(w.max_procs); i ++)
+ {
+  w.proc_free_bits [i] = 0;
+ }
+
  for (c = 0; c < w.max_cores; c ++)
  {
   core = &w.core [c];
+  set_pool_bit(w.core_free_bits, c);
   core->exists = 0;
   core->destroyed_timestamp = 0;
   core->index = c;
+  for (i = 0; i < CHANNELS; i ++)
+		{
+		 core->listen_channel [i] = 0;
+		}
+ }
+
+ for (p = 0; p < PLAYERS; p ++)
+ {
+  for (i = 0; i < CHANNELS; i ++)
+		{
+   w.channel_listeners [p] [i] = 0;
+		}
  }
 
 
  for (p = 0; p < w.max_procs; p ++)
  {
   proc = &w.proc [p];
+  set_pool_bit(w.proc_free_bits, p);
   proc->exists = 0;
   proc->reserved = 0;
   proc->destroyed_timestamp = 0;
@@ -369,10 +502,15 @@ void initialise_world(void)
   {
     w.block [i] [j].tag = 0;
     w.block [i] [j].blocklist_down = NULL;
+    w.block [i] [j].packet_tag = 0;
+    w.block [i] [j].packet_down = NULL;
+    w.block [i] [j].core_tag = 0;
+    w.block [i] [j].core_down = -1;
   }
  }
 
  w.blocktag = 1; // should probably be 1 more than the value that all of the blocks in the world are set to.
+ w.packet_blocktag = 1;
 
  init_packets();
  init_clouds();
@@ -400,36 +538,40 @@ void deallocate_world(void)
 
 #ifdef USE_DYNAMIC_MEMORY
 
- int i, p;
-
-// first, free each column of blocks:
- for (i = 0; i < w.blocks.x; i ++)
- {
-  free(w.block [i]);
- }
+ int i;
 
-// now free the row of pointers to the columns:
+// each block array was allocated as one contiguous array plus an array of pointers to its columns (see new_world_from_world_init() above):
+ free(w.block [0]);
  free(w.block);
+ free(w.backblock [0]);
+ free(w.backblock);
+ free(w.vision_block [0]);
+ free(w.vision_block);
 
-// now do the same for vision areas:
- for (p = 0; p < w.players; p ++)
-	{
-  for (i = 0; i < w.vision_areas_x; i ++)
-  {
-   free(w.vision_area [p] [i]);
-  }
-  free(w.vision_area [p]);
- }
+// all players' vision areas were allocated together, so player 0's pointers point to the start of both arrays:
+ free(w.vision_area [0] [0]);
+ free(w.vision_area [0]);
 
 // free the rest of the arrays:
  free(w.core);
  free(w.proc);
+ free(w.proc_box);
  free(w.packet);
  free(w.cloud);
+ for (i = 0; i < CHANNELS; i ++)
+	{
+	 free(w.channel_listener [i]);
+	}
+ free(w.core_free_bits);
+ free(w.proc_free_bits);
+ free(w.packet_free_bits);
 
 
 #endif
 
+ free_back_cache();
+ free_world_snapshot();
+
  w.allocated = 0;
 
 }
@@ -487,6 +629,8 @@ void disrupt_block_nodes(al_fixed x, al_fixed y, int player_cause, int size)
 
  struct backblock_struct* backbl = &w.backblock [bx] [by];
 
+ back_cache_block_changed(bx, by);
+
  for (i = 0; i < 9; i ++)
  {
   change_block_node(backbl, i, backbl->node_x [i] + grand(size) - grand(size), backbl->node_y [i] + grand(size) - grand(size), backbl->node_size [i] + grand(size) - grand(size));
@@ -532,6 +676,8 @@ void disrupt_single_block_node(al_fixed x, al_fixed y, int player_cause, int siz
  int_y /= BLOCK_SIZE_PIXELS;
 
  i = (int_x * 3) + int_y;
+
+ back_cache_block_changed(bx, by);
 //  fprintf(stdout, "\nnode (%i) from source (%i, %i)", i, int_x, int_y);
 
 #ifdef SANITY_CHECK
@@ -7,6 +7,7 @@ void start_world(void);
 void initialise_world(void);
 void new_world_from_world_init(void);
 void deallocate_world(void);
+void rebuild_free_bits(void);
 
 void run_world(void);
 
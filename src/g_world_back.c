@@ -19,6 +19,7 @@ World background generation etc code
 #include "m_maths.h"
 #include "i_disp_in.h"
 #include "i_background.h"
+#include "i_back_cache.h"
 #include "s_menu.h"
 #include "g_world_back.h"
 #include "g_world_map_2.h"
@@ -269,6 +270,7 @@ void explosion_affects_block_nodes(al_fixed explosion_x, al_fixed explosion_y, i
 			if (w.backblock[i][j].backblock_type != BACKBLOCK_BASIC_HEX)
 				continue;
 			backbl = &w.backblock[i][j];
+			back_cache_block_changed(i, j);
 			for (k = 0; k < BLOCK_NODES; k ++)
 			{
 				if (w.backblock[i][j].node_exists [k] == 0)
@@ -346,6 +348,7 @@ void static_build_affects_block_nodes(al_fixed build_x, al_fixed build_y, int ef
 				&& w.backblock[i][j].backblock_type != BACKBLOCK_BASIC_HEX_NO_NODES) // new nodes can be added
 				continue;
 			backbl = &w.backblock[i][j];
+			back_cache_block_changed(i, j);
 			nodes_added = 0;
 //			fpr("\n %i,%i type %i ", i, j, w.backblock[i][j].backblock_type);
 			for (k = 0; k < BLOCK_NODES; k ++)
@@ -440,6 +443,7 @@ void pulse_block_node(al_fixed pulse_x, al_fixed pulse_y)
 #endif
 
  backbl->node_pending_explosion_timestamp [node_index] = w.world_time + 32;
+ back_cache_block_changed(block_x, block_y);
 
 // fpr("\n pulse at %i,%i block %i,%i node %i", al_fixtoi(pulse_x), al_fixtoi(pulse_y), block_x, block_y, node_index);
 
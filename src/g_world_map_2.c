@@ -26,6 +26,7 @@ Code to convert map_init into w_init and w,
 #include "g_world_map_2.h"
 #include "h_story.h"
 #include "i_header.h"
+#include "i_display.h"
 
 extern struct world_init_struct w_init; // this is the world_init generated by world setup menus - declared in s_menu.c
 extern struct map_init_struct map_init;
@@ -1990,6 +1991,8 @@ void reset_map_vision_masks(void)
 		}
 	}
 
+ reset_map_vision_cache();
+
 
 
 }
@@ -2077,6 +2080,8 @@ void draw_map_vision_pixels(void)
 
 	draw_map_mask_pixels();
 
+	reset_map_vision_cache(); // the vision mask needs to be redrawn from the new mask bitmaps
+
 
 
 }
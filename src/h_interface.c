@@ -514,8 +514,8 @@ srand(30);
 
 	for (i = 0; i < STORY_REGIONS; i ++)
 	{
-		story_inter.region_inter[i].x_screen += grand(26) * story_inter.zoom;// - grand(6);
-		story_inter.region_inter[i].y_screen += grand(26) * story_inter.zoom;// - grand(6);
+		story_inter.region_inter[i].x_screen += irand(26) * story_inter.zoom;// - irand(6);
+		story_inter.region_inter[i].y_screen += irand(26) * story_inter.zoom;// - irand(6);
 	}
 */
 
@@ -0,0 +1,640 @@
+/*
+
+Retained geometry for the background hex nodes.
+
+run_display() used to rebuild the vertices for every background node on the screen each frame. The nodes hardly ever change, so
+ this file keeps the triangles for them in vertex arrays for each chunk of the map (a chunk is BACK_CACHE_CHUNK_BLOCKS x BACK_CACHE_CHUNK_BLOCKS blocks)
+ and only rebuilds a chunk when something in it changes.
+
+The vertices are stored in world pixel coordinates, without parallax or zoom. Each depth layer is drawn with a transform
+ that applies that layer's parallax and the zoom, so moving or zooming the camera doesn't need a rebuild.
+
+A chunk is rebuilt when:
+ - it's marked dirty by back_cache_block_changed(), which the functions that change block nodes call
+    (disrupt_block_nodes() in g_world.c, explosion_affects_block_nodes() in g_world_back.c etc). While the display is drawing a
+    snapshot of the world, changes are marked when they're copied to the snapshot (see i_snapshot.c).
+ - the world time reaches the chunk's valid_until time. A node can change by itself without any of those functions being called:
+    its colour changes after node_colour_change_timestamp, and it grows and fades for NODE_EXPLOSION_ANIMATION ticks
+    before node_pending_explosion_timestamp. Nodes that are part-way through that animation aren't put in the vertex arrays;
+    they're added to vbuf each frame in the same way that all nodes used to be.
+ - the colours are remapped (map_hex_colours() in i_disp_in.c calls invalidate_back_cache())
+ - the fast_background setting changes
+
+Chunks that haven't been drawn for a while have their vertices freed, so memory use depends on how much of the map has been near the screen recently
+ rather than on the size of the map.
+
+*/
+
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_primitives.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "m_config.h"
+#include "g_header.h"
+#include "m_globvars.h"
+#include "i_header.h"
+
+#include "g_misc.h"
+#include "i_background.h"
+#include "i_display.h"
+#include "i_back_cache.h"
+#include "i_snapshot.h"
+
+extern struct view_struct view;
+
+#define BACK_CACHE_CHUNK_BITS 3
+#define BACK_CACHE_CHUNK_BLOCKS (1<<BACK_CACHE_CHUNK_BITS)
+#define BACK_CACHE_CHUNK_NODES (BACK_CACHE_CHUNK_BLOCKS * BACK_CACHE_CHUNK_BLOCKS * BLOCK_NODES)
+// a chunk that hasn't been drawn for this many frames has its vertices freed:
+#define BACK_CACHE_EXPIRY_FRAMES 300
+// valid_until value for a chunk that won't change by itself:
+#define BACK_CACHE_NEVER 0xFFFFFFFF
+// a node starts to grow this many ticks before its node_pending_explosion_timestamp:
+#define NODE_EXPLOSION_ANIMATION 32
+
+// vertices for a node in a triangle list:
+#define HEX_NODE_VERTICES 12
+#define SQUARE_NODE_VERTICES 6
+
+struct back_cache_chunk_struct
+{
+ int dirty; // 1 if vertex needs to be rebuilt before being drawn
+ timestamp valid_until; // rebuild when w.world_time reaches this
+ unsigned int last_drawn_frame;
+
+ ALLEGRO_VERTEX* vertex; // triangle list for all layers (layer_start and layer_vertices say which part is for each layer)
+ int vertex_capacity;
+ int layer_start [BACKBLOCK_LAYERS]; // indexed by node_depth
+ int layer_vertices [BACKBLOCK_LAYERS];
+
+// nodes that are animating and aren't in vertex. Each entry is (block index in chunk * BLOCK_NODES) + node index:
+ unsigned short* live_node; // allocated the first time the chunk has a live node
+ int live_nodes;
+};
+
+struct back_cache_struct
+{
+ struct back_cache_chunk_struct* chunk; // NULL if no world allocated
+ int chunks_x, chunks_y;
+ int fast_background; // settings.option [OPTION_FAST_BACKGROUND] when the chunks were built
+
+ unsigned int frame;
+
+// set by prepare_back_cache() and used by draw_back_cache_layer() when draw_vbuf() is next called:
+ int draw_pending;
+ int draw_min_chunk_x, draw_min_chunk_y;
+ int draw_max_chunk_x, draw_max_chunk_y; // inclusive
+ float layer_scale [BACKBLOCK_LAYERS]; // indexed by node_depth
+ float layer_x [BACKBLOCK_LAYERS]; // screen position of world pixel 0,0 in each layer
+ float layer_y [BACKBLOCK_LAYERS];
+};
+
+static struct back_cache_struct back_cache;
+
+static struct back_cache_chunk_struct* get_chunk(int cx, int cy);
+static void build_chunk(struct back_cache_chunk_struct* ch, int cx, int cy);
+static void add_live_back_nodes(struct back_cache_chunk_struct* ch, int cx, int cy);
+static void expire_chunks(void);
+static void free_chunk_vertices(struct back_cache_chunk_struct* ch);
+static timestamp node_next_change(struct backblock_struct* backbl, int k, int* live);
+static ALLEGRO_COLOR node_appearance(struct backblock_struct* backbl, int k, float* nsize);
+static void set_cache_vertex(ALLEGRO_VERTEX* vertex, float x, float y, ALLEGRO_COLOR col);
+
+// Call after the world's blocks have been allocated (new_world_from_world_init() in g_world.c). Every chunk starts dirty.
+void init_back_cache(void)
+{
+
+ int i;
+
+ free_back_cache();
+
+ back_cache.chunks_x = (w.blocks.x + BACK_CACHE_CHUNK_BLOCKS - 1) >> BACK_CACHE_CHUNK_BITS;
+ back_cache.chunks_y = (w.blocks.y + BACK_CACHE_CHUNK_BLOCKS - 1) >> BACK_CACHE_CHUNK_BITS;
+
+ back_cache.chunk = calloc(back_cache.chunks_x * back_cache.chunks_y, sizeof(struct back_cache_chunk_struct));
+ if (back_cache.chunk == NULL)
+ {
+      fprintf(stdout, "i_back_cache.c: Out of memory in allocating back_cache.chunk");
+      error_call();
+ }
+
+ for (i = 0; i < back_cache.chunks_x * back_cache.chunks_y; i ++)
+	{
+		back_cache.chunk[i].dirty = 1;
+		back_cache.chunk[i].valid_until = BACK_CACHE_NEVER;
+	}
+
+ back_cache.fast_background = settings.option [OPTION_FAST_BACKGROUND];
+ back_cache.frame = 0;
+ back_cache.draw_pending = 0;
+
+}
+
+// Call when the world is deallocated. Safe to call if init_back_cache() hasn't been called.
+void free_back_cache(void)
+{
+
+ int i;
+
+ if (back_cache.chunk == NULL)
+		return;
+
+ for (i = 0; i < back_cache.chunks_x * back_cache.chunks_y; i ++)
+	{
+		free_chunk_vertices(&back_cache.chunk[i]);
+	}
+
+ free(back_cache.chunk);
+ back_cache.chunk = NULL;
+ back_cache.chunks_x = 0;
+ back_cache.chunks_y = 0;
+ back_cache.draw_pending = 0;
+
+}
+
+// Call whenever anything about the nodes of block bx,by changes.
+void back_cache_block_changed(int bx, int by)
+{
+
+ if (back_cache.chunk == NULL
+		|| bx < 0
+		|| by < 0
+		|| bx >= w.blocks.x
+		|| by >= w.blocks.y)
+		return;
+
+ if (dw != &w)
+	{
+// the display is drawing a snapshot of the world, so the chunk can't be rebuilt until the change has been copied to the snapshot:
+		snapshot_block_changed(bx, by);
+		return;
+	}
+
+ mark_back_cache_block_dirty(bx, by);
+
+}
+
+// Like back_cache_block_changed(), but always marks the chunk dirty straight away (even while the display is drawing a snapshot).
+// Called by i_snapshot.c once a change has been copied to the snapshot.
+void mark_back_cache_block_dirty(int bx, int by)
+{
+
+ if (back_cache.chunk == NULL
+		|| bx < 0
+		|| by < 0
+		|| bx >= w.blocks.x
+		|| by >= w.blocks.y)
+		return;
+
+ get_chunk(bx >> BACK_CACHE_CHUNK_BITS, by >> BACK_CACHE_CHUNK_BITS)->dirty = 1;
+
+}
+
+// Call if the colours used for the nodes change.
+void invalidate_back_cache(void)
+{
+
+ int i;
+
+ if (back_cache.chunk == NULL)
+		return;
+
+ for (i = 0; i < back_cache.chunks_x * back_cache.chunks_y; i ++)
+	{
+		back_cache.chunk[i].dirty = 1;
+	}
+
+}
+
+// Called by run_display() instead of adding each background node to vbuf.
+// Rebuilds any chunks in the block range that need it, adds animating nodes to vbuf and sets up the cached layers
+//  to be drawn by the next call to draw_vbuf().
+// top_left_corner_x/y are the same arrays that run_display() uses for data wells.
+void prepare_back_cache(int min_block_x, int min_block_y, int max_block_x, int max_block_y, float* top_left_corner_x, float* top_left_corner_y)
+{
+
+ int cx, cy, d;
+ struct back_cache_chunk_struct* ch;
+
+ back_cache.draw_pending = 0;
+
+ if (back_cache.chunk == NULL
+		|| max_block_x <= min_block_x
+		|| max_block_y <= min_block_y)
+		return;
+
+ if (back_cache.fast_background != settings.option [OPTION_FAST_BACKGROUND])
+	{
+		back_cache.fast_background = settings.option [OPTION_FAST_BACKGROUND];
+		invalidate_back_cache();
+	}
+
+ back_cache.frame ++;
+
+ back_cache.draw_min_chunk_x = min_block_x >> BACK_CACHE_CHUNK_BITS;
+ back_cache.draw_min_chunk_y = min_block_y >> BACK_CACHE_CHUNK_BITS;
+ back_cache.draw_max_chunk_x = (max_block_x - 1) >> BACK_CACHE_CHUNK_BITS;
+ back_cache.draw_max_chunk_y = (max_block_y - 1) >> BACK_CACHE_CHUNK_BITS;
+
+// run_display() works out where block i,j of layer d is on the screen as:
+//  top_left_corner_x [d] + (BLOCK_SIZE_PIXELS * view.zoom * dw->backblock_parallax [d]) * i
+// so each layer is just a scale and a translation of world pixel coordinates:
+ for (d = 0; d < BACKBLOCK_LAYERS; d ++)
+	{
+		back_cache.layer_scale [d] = view.zoom * dw->backblock_parallax [d];
+		back_cache.layer_x [d] = top_left_corner_x [d];
+		back_cache.layer_y [d] = top_left_corner_y [d];
+	}
+
+ for (cx = back_cache.draw_min_chunk_x; cx <= back_cache.draw_max_chunk_x; cx ++)
+	{
+		for (cy = back_cache.draw_min_chunk_y; cy <= back_cache.draw_max_chunk_y; cy ++)
+		{
+			ch = get_chunk(cx, cy);
+			if (ch->dirty
+				|| dw->world_time >= ch->valid_until)
+				build_chunk(ch, cx, cy);
+			ch->last_drawn_frame = back_cache.frame;
+		}
+	}
+
+// this is set before the live nodes are added because adding them may fill vbuf and cause it to be drawn,
+//  and the cached layers need to be drawn underneath them:
+ back_cache.draw_pending = 1;
+
+ for (cx = back_cache.draw_min_chunk_x; cx <= back_cache.draw_max_chunk_x; cx ++)
+	{
+		for (cy = back_cache.draw_min_chunk_y; cy <= back_cache.draw_max_chunk_y; cy ++)
+		{
+			ch = get_chunk(cx, cy);
+			if (ch->live_nodes > 0)
+				add_live_back_nodes(ch, cx, cy);
+		}
+	}
+
+ if ((back_cache.frame & 63) == 0)
+		expire_chunks();
+
+}
+
+// Called by draw_vbuf() before it draws each display layer's triangles.
+void draw_back_cache_layer(int layer)
+{
+
+ int cx, cy;
+ struct back_cache_chunk_struct* ch;
+ int d = (BACKBLOCK_LAYERS - 1) - layer; // the reverse of what's passed to add_orthogonal_hexagon() for each node
+
+ if (!back_cache.draw_pending
+		|| d < 0
+		|| d >= BACKBLOCK_LAYERS)
+		return;
+
+ ALLEGRO_TRANSFORM old_transform, layer_transform;
+
+ al_copy_transform(&old_transform, al_get_current_transform());
+ al_identity_transform(&layer_transform);
+ al_scale_transform(&layer_transform, back_cache.layer_scale [d], back_cache.layer_scale [d]);
+ al_translate_transform(&layer_transform, back_cache.layer_x [d], back_cache.layer_y [d]);
+ al_compose_transform(&layer_transform, &old_transform);
+ al_use_transform(&layer_transform);
+
+ for (cx = back_cache.draw_min_chunk_x; cx <= back_cache.draw_max_chunk_x; cx ++)
+	{
+		for (cy = back_cache.draw_min_chunk_y; cy <= back_cache.draw_max_chunk_y; cy ++)
+		{
+			ch = get_chunk(cx, cy);
+			if (ch->layer_vertices [d] == 0)
+				continue;
+			al_draw_prim(ch->vertex,
+																NULL, // vertex declaration
+																NULL, // texture
+																ch->layer_start [d],
+																ch->layer_start [d] + ch->layer_vertices [d],
+																ALLEGRO_PRIM_TRIANGLE_LIST);
+		}
+	}
+
+ al_use_transform(&old_transform);
+
+}
+
+// Called by draw_vbuf() after all layers have been drawn, so that the cached layers are only drawn once each frame.
+void finish_back_cache_draw(void)
+{
+
+ back_cache.draw_pending = 0;
+
+}
+
+static struct back_cache_chunk_struct* get_chunk(int cx, int cy)
+{
+
+ return &back_cache.chunk [(cx * back_cache.chunks_y) + cy];
+
+}
+
+static void build_chunk(struct back_cache_chunk_struct* ch, int cx, int cy)
+{
+
+ int bx, by, k, d, live;
+ int first_bx = cx << BACK_CACHE_CHUNK_BITS;
+ int first_by = cy << BACK_CACHE_CHUNK_BITS;
+ int end_bx = first_bx + BACK_CACHE_CHUNK_BLOCKS;
+ int end_by = first_by + BACK_CACHE_CHUNK_BLOCKS;
+ int write_pos [BACKBLOCK_LAYERS];
+ int node_vertices = back_cache.fast_background? SQUARE_NODE_VERTICES : HEX_NODE_VERTICES;
+ timestamp next_change;
+ struct backblock_struct* backbl;
+
+ if (end_bx > dw->blocks.x)
+		end_bx = dw->blocks.x;
+ if (end_by > dw->blocks.y)
+		end_by = dw->blocks.y;
+
+ ch->valid_until = BACK_CACHE_NEVER;
+ ch->live_nodes = 0;
+
+ for (d = 0; d < BACKBLOCK_LAYERS; d ++)
+	{
+		ch->layer_vertices [d] = 0;
+	}
+
+// first pass: count the vertices needed for each layer and find the live nodes
+ for (bx = first_bx; bx < end_bx; bx ++)
+	{
+		for (by = first_by; by < end_by; by ++)
+		{
+			backbl = &dw->backblock [bx] [by];
+			if (backbl->backblock_type != BACKBLOCK_BASIC_HEX)
+				continue;
+			for (k = 0; k < BLOCK_NODES; k ++)
+			{
+				if (backbl->node_exists [k] == 0)
+					continue;
+				next_change = node_next_change(backbl, k, &live);
+				if (next_change < ch->valid_until)
+					ch->valid_until = next_change;
+				if (live)
+				{
+					if (ch->live_node == NULL)
+					{
+						ch->live_node = malloc(BACK_CACHE_CHUNK_NODES * sizeof(unsigned short));
+						if (ch->live_node == NULL)
+						{
+							fprintf(stdout, "i_back_cache.c: Out of memory in allocating live_node");
+							error_call();
+						}
+					}
+					ch->live_node [ch->live_nodes] = ((((bx - first_bx) * BACK_CACHE_CHUNK_BLOCKS) + (by - first_by)) * BLOCK_NODES) + k;
+					ch->live_nodes ++;
+					continue;
+				}
+				ch->layer_vertices [backbl->node_depth [k]] += node_vertices;
+			}
+		}
+	}
+
+ int total_vertices = 0;
+
+ for (d = 0; d < BACKBLOCK_LAYERS; d ++)
+	{
+		ch->layer_start [d] = total_vertices;
+		write_pos [d] = total_vertices;
+		total_vertices += ch->layer_vertices [d];
+	}
+
+ if (total_vertices > ch->vertex_capacity)
+	{
+		free(ch->vertex);
+		ch->vertex = malloc(total_vertices * sizeof(ALLEGRO_VERTEX));
+		if (ch->vertex == NULL)
+		{
+			fprintf(stdout, "i_back_cache.c: Out of memory in allocating chunk vertices");
+			error_call();
+		}
+		ch->vertex_capacity = total_vertices;
+	}
+
+// second pass: write the vertices. Live nodes are found in the same way as above.
+ float x, y, nsize;
+ ALLEGRO_COLOR col;
+ ALLEGRO_VERTEX* v;
+
+ for (bx = first_bx; bx < end_bx; bx ++)
+	{
+		for (by = first_by; by < end_by; by ++)
+		{
+			backbl = &dw->backblock [bx] [by];
+			if (backbl->backblock_type != BACKBLOCK_BASIC_HEX)
+				continue;
+			for (k = 0; k < BLOCK_NODES; k ++)
+			{
+				if (backbl->node_exists [k] == 0)
+					continue;
+				node_next_change(backbl, k, &live);
+				if (live)
+					continue;
+				col = node_appearance(backbl, k, &nsize);
+				x = (bx * BLOCK_SIZE_PIXELS) + backbl->node_x [k];
+				y = (by * BLOCK_SIZE_PIXELS) + backbl->node_y [k];
+				d = backbl->node_depth [k];
+				v = &ch->vertex [write_pos [d]];
+				write_pos [d] += node_vertices;
+				if (back_cache.fast_background)
+				{
+// same as add_diamond_layer() call in add_live_back_nodes() (which despite the name makes a square):
+					set_cache_vertex(&v [0], x - nsize, y - nsize, col);
+					set_cache_vertex(&v [1], x + nsize, y - nsize, col);
+					set_cache_vertex(&v [2], x + nsize, y + nsize, col);
+					set_cache_vertex(&v [3], x + nsize, y + nsize, col);
+					set_cache_vertex(&v [4], x - nsize, y + nsize, col);
+					set_cache_vertex(&v [5], x - nsize, y - nsize, col);
+				}
+				 else
+					{
+// same triangles as add_orthogonal_hexagon() in i_display.c:
+						float hx = 0.866 * nsize;
+						float hy = 0.5 * nsize;
+						set_cache_vertex(&v [0], x, y - nsize, col);
+						set_cache_vertex(&v [1], x + hx, y - hy, col);
+						set_cache_vertex(&v [2], x - hx, y - hy, col);
+						set_cache_vertex(&v [3], x + hx, y - hy, col);
+						set_cache_vertex(&v [4], x + hx, y + hy, col);
+						set_cache_vertex(&v [5], x - hx, y - hy, col);
+						set_cache_vertex(&v [6], x + hx, y + hy, col);
+						set_cache_vertex(&v [7], x - hx, y + hy, col);
+						set_cache_vertex(&v [8], x - hx, y - hy, col);
+						set_cache_vertex(&v [9], x + hx, y + hy, col);
+						set_cache_vertex(&v [10], x, y + nsize, col);
+						set_cache_vertex(&v [11], x - hx, y + hy, col);
+					}
+			}
+		}
+	}
+
+ ch->dirty = 0;
+
+}
+
+// Adds the nodes that were left out of the chunk's vertices to vbuf, in screen coordinates.
+static void add_live_back_nodes(struct back_cache_chunk_struct* ch, int cx, int cy)
+{
+
+ int i, k, d, block_index;
+ int bx, by;
+ float x, y, nsize, scale;
+ ALLEGRO_COLOR col;
+ struct backblock_struct* backbl;
+
+ for (i = 0; i < ch->live_nodes; i ++)
+	{
+		block_index = ch->live_node [i] / BLOCK_NODES;
+		k = ch->live_node [i] % BLOCK_NODES;
+		bx = (cx << BACK_CACHE_CHUNK_BITS) + (block_index / BACK_CACHE_CHUNK_BLOCKS);
+		by = (cy << BACK_CACHE_CHUNK_BITS) + (block_index % BACK_CACHE_CHUNK_BLOCKS);
+		backbl = &dw->backblock [bx] [by];
+
+		col = node_appearance(backbl, k, &nsize);
+		d = backbl->node_depth [k];
+		scale = back_cache.layer_scale [d];
+		x = back_cache.layer_x [d] + ((bx * BLOCK_SIZE_PIXELS) + backbl->node_x [k]) * scale;
+		y = back_cache.layer_y [d] + ((by * BLOCK_SIZE_PIXELS) + backbl->node_y [k]) * scale;
+		nsize *= scale;
+
+		check_vbuf();
+
+		if (back_cache.fast_background)
+			add_diamond_layer((BACKBLOCK_LAYERS - 1) - d,
+																					x - nsize, y - nsize,
+																					x + nsize, y - nsize,
+																					x + nsize, y + nsize,
+																					x - nsize, y + nsize,
+																					col);
+			 else
+					add_orthogonal_hexagon((BACKBLOCK_LAYERS - 1) - d, x, y, nsize, col);
+	}
+
+}
+
+// Frees the vertices of chunks that haven't been drawn recently. They'll be rebuilt if they come back into view.
+static void expire_chunks(void)
+{
+
+ int i;
+
+ for (i = 0; i < back_cache.chunks_x * back_cache.chunks_y; i ++)
+	{
+		if (back_cache.chunk[i].vertex != NULL
+			&& back_cache.frame - back_cache.chunk[i].last_drawn_frame > BACK_CACHE_EXPIRY_FRAMES)
+		{
+			free_chunk_vertices(&back_cache.chunk[i]);
+			back_cache.chunk[i].dirty = 1;
+		}
+	}
+
+}
+
+static void free_chunk_vertices(struct back_cache_chunk_struct* ch)
+{
+
+ free(ch->vertex);
+ ch->vertex = NULL;
+ ch->vertex_capacity = 0;
+ free(ch->live_node);
+ ch->live_node = NULL;
+ ch->live_nodes = 0;
+
+ int d;
+
+ for (d = 0; d < BACKBLOCK_LAYERS; d ++)
+	{
+		ch->layer_vertices [d] = 0;
+	}
+
+}
+
+// Returns the next time that node k will look different without being changed (or BACK_CACHE_NEVER).
+// Sets *live to 1 if the node is currently animating (and so looks different every tick).
+static timestamp node_next_change(struct backblock_struct* backbl, int k, int* live)
+{
+
+ timestamp next_change = BACK_CACHE_NEVER;
+ timestamp explosion_time = backbl->node_pending_explosion_timestamp [k];
+
+ *live = 0;
+
+ if (explosion_time > dw->world_time)
+	{
+		if (explosion_time < dw->world_time + NODE_EXPLOSION_ANIMATION)
+		{
+			*live = 1;
+			next_change = explosion_time;
+		}
+		 else
+			 next_change = explosion_time - (NODE_EXPLOSION_ANIMATION - 1); // the first time that the test above will be true
+	}
+
+// the node changes colour when world_time becomes greater than node_colour_change_timestamp:
+ if (backbl->node_colour_change_timestamp [k] >= dw->world_time
+		&& backbl->node_colour_change_timestamp [k] + 1 < next_change)
+		next_change = backbl->node_colour_change_timestamp [k] + 1;
+
+ return next_change;
+
+}
+
+// Works out the colour and size (in world pixels) of node k at the current time.
+// This is the same as the code that run_display() used to run for each node every frame.
+static ALLEGRO_COLOR node_appearance(struct backblock_struct* backbl, int k, float* nsize)
+{
+
+ int nfillcol = 0;
+ int node_colour = backbl->node_team_col [k];
+ int node_saturation = backbl->node_col_saturation [k];
+
+ *nsize = backbl->node_size [k];
+
+ if (dw->world_time > backbl->node_colour_change_timestamp [k])
+	{
+  node_colour = backbl->node_new_colour [k];
+	 node_saturation = backbl->node_new_saturation [k];
+	}
+
+ if (backbl->node_pending_explosion_timestamp [k] > dw->world_time
+		&& backbl->node_pending_explosion_timestamp [k] < dw->world_time + NODE_EXPLOSION_ANIMATION)
+	{
+  float size_increase = (backbl->node_pending_explosion_timestamp [k] - dw->world_time) / 2;
+  if (size_increase > 6)
+			size_increase = 6;
+  *nsize += size_increase;
+  nfillcol = (backbl->node_pending_explosion_timestamp [k] - dw->world_time) / 4;
+
+  if (nfillcol >= BACK_COL_FADE)
+   nfillcol = BACK_COL_FADE - 1;
+  if (nfillcol < 0)
+			nfillcol = 0;
+	}
+
+// node_size is set a bit smaller (in the world generation functions) with fast_background, and doesn't get this:
+ if (!back_cache.fast_background)
+  *nsize += 0.5;
+
+ return colours.back_fill [backbl->node_depth [k]] [node_colour] [node_saturation] [nfillcol];
+
+}
+
+static void set_cache_vertex(ALLEGRO_VERTEX* vertex, float x, float y, ALLEGRO_COLOR col)
+{
+
+ vertex->x = x;
+ vertex->y = y;
+ vertex->z = 0;
+ vertex->u = 0;
+ vertex->v = 0;
+ vertex->color = col;
+
+}
+
@@ -0,0 +1,16 @@
+
+#ifndef H_I_BACK_CACHE
+#define H_I_BACK_CACHE
+
+void init_back_cache(void);
+void free_back_cache(void);
+void back_cache_block_changed(int bx, int by);
+void mark_back_cache_block_dirty(int bx, int by);
+void invalidate_back_cache(void);
+
+void prepare_back_cache(int min_block_x, int min_block_y, int max_block_x, int max_block_y, float* top_left_corner_x, float* top_left_corner_y);
+void draw_back_cache_layer(int layer);
+void finish_back_cache_draw(void);
+
+#endif
+
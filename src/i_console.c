@@ -23,6 +23,10 @@
 #include "p_panels.h"
 
 #include "x_sound.h"
+#include "v_interp.h"
+#include "g_proc_par.h"
+#include "g_sim.h"
+#include "i_snapshot.h"
 
 extern struct control_struct control;
 extern struct game_struct game;
@@ -161,6 +165,8 @@ void display_consoles_and_buttons(void)
 	int line_index;
 	int c;
 
+ lock_consoles(); // ticks on the simulation thread can write to the consoles while they're being drawn (see g_sim.c)
+
 //	for (c = 0; c < CONSOLES; c ++)
 	{
 
@@ -175,9 +181,9 @@ void display_consoles_and_buttons(void)
 	 for (i = 0; i < console[c].h_lines; i ++)
 		{
 			sancheck(line_index, 0, CLINES, "display_consoles_and_buttons: line_index");
-			if (console[c].cline[line_index].time_written > w.world_time - 64)
+			if (console[c].cline[line_index].time_written > dw->world_time - 64)
 			 add_menu_button(console[c].x + 3, console[c].y + console[c].h_pixels - ((i+1)*CONSOLE_LINE_HEIGHT) + 1, console[c].x + console[c].w_pixels - 6, console[c].y + console[c].h_pixels - ((i)*CONSOLE_LINE_HEIGHT) - 1,
-																				al_map_rgba(80, 120, 200, 129 - (w.world_time - console[c].cline[line_index].time_written) * 2), 5, 3);
+																				al_map_rgba(80, 120, 200, 129 - (dw->world_time - console[c].cline[line_index].time_written) * 2), 5, 3);
 
 //				 															colours.base_trans [COL_BLUE] [SHADE_MED] [TRANS_MED], 3, 1);
 
@@ -210,10 +216,10 @@ void display_consoles_and_buttons(void)
 
 c = CONSOLE_SYSTEM; // system console gets special minimalist treatment:
 
- if (console[c].time_written > w.world_time - 64)
+ if (console[c].time_written > dw->world_time - 64)
 	{
 			add_menu_button(console[c].x, console[c].y, console[c].x + console[c].w_pixels, console[c].y + console[c].h_pixels,
-																			colours.packet [1] [(console[c].time_written + 64 - w.world_time) / 2], 7, 3);
+																			colours.packet [1] [(console[c].time_written + 64 - dw->world_time) / 2], 7, 3);
 	}
 
 
@@ -229,6 +235,8 @@ c = CONSOLE_SYSTEM; // system console gets special minimalist treatment:
 				line_index = CLINES-1;
 		}
 
+ unlock_consoles();
+
 #endif
 
 
@@ -246,7 +254,7 @@ c = CONSOLE_SYSTEM; // system console gets special minimalist treatment:
 		int template_index = 1;
 
 // Only display the build command buttons in command mode (the queue is displayed in auto mode though)
-	if (w.command_mode == COMMAND_MODE_COMMAND)
+	if (dw->command_mode == COMMAND_MODE_COMMAND)
 	{
   for (i = 0; i < TEMPLATES_PER_PLAYER; i ++)
 		{
@@ -317,7 +325,7 @@ c = CONSOLE_SYSTEM; // system console gets special minimalist treatment:
 			  al_draw_textf(font[FONT_SQUARE].fnt, colours.base_trans [COL_GREY] [SHADE_HIGH] [TRANS_THICK], view.build_buttons_x2 - 8, text_y, ALLEGRO_ALIGN_RIGHT, "%i", templ[game.user_player_index][template_index].data_cost);
 //			  al_draw_textf(font[FONT_SQUARE].fnt, colours.base_trans [COL_GREY] [SHADE_HIGH] [TRANS_THICK], view.build_buttons_x2 - 8, button_y + (i * BUILD_BUTTON_H) + 10, ALLEGRO_ALIGN_RIGHT, "%i", templ[game.user_player_index][template_index].data_cost);
 
-//				 core->build_cooldown_time = w.world_time + ((templ[core->player_index][build_template].build_cooldown_time / core->number_of_build_objects + 1) * EXECUTION_COUNT); // number_of_build_objects has been confirmed to be non-zero above
+//				 core->build_cooldown_time = dw->world_time + ((templ[core->player_index][build_template].build_cooldown_time / core->number_of_build_objects + 1) * EXECUTION_COUNT); // number_of_build_objects has been confirmed to be non-zero above
 
 			 }
 			  else
@@ -377,7 +385,7 @@ c = CONSOLE_SYSTEM; // system console gets special minimalist treatment:
 
 		button_y = view.build_buttons_y2 - (BUILD_BUTTON_H * (TEMPLATES_PER_PLAYER + 3)) - 10;
 
-	} // end if w.command_mode == COMMAND_MODE_COMMAND
+	} // end if dw->command_mode == COMMAND_MODE_COMMAND
 	 else
  		button_y = view.build_buttons_y2 - BUILD_BUTTON_H * 2 - 10;
 
@@ -388,13 +396,13 @@ c = CONSOLE_SYSTEM; // system console gets special minimalist treatment:
 
 //  for (i = 0; i < BUILD_COMMAND_QUEUE; i ++)
 		{
-//   fpr(" %i", w.core[command.builder_core_index].build_command_queue[i].active);
+//   fpr(" %i", dw->core[command.builder_core_index].build_command_queue[i].active);
 
 		}
 /*
   for (i = 0; i < BUILD_QUEUE_LENGTH; i ++)
 		{
-			if (w.core[command.builder_core_index].build_command_queue[i].active == 0)
+			if (dw->core[command.builder_core_index].build_command_queue[i].active == 0)
 				break;
 
 			  if (view.mouse_on_build_queue_button_timestamp == game.total_time
@@ -412,12 +420,12 @@ c = CONSOLE_SYSTEM; // system console gets special minimalist treatment:
 
   for (i = 0; i < BUILD_COMMAND_QUEUE; i ++)
 		{
-			if (w.core[command.builder_core_index].build_command_queue[i].active == 0)
+			if (dw->core[command.builder_core_index].build_command_queue[i].active == 0)
 				break;
 
-			template_index = w.core[command.builder_core_index].build_command_queue[i].build_template;
+			template_index = dw->core[command.builder_core_index].build_command_queue[i].build_template;
 	  al_draw_textf(font[FONT_SQUARE].fnt, colours.base_trans [COL_GREY] [SHADE_HIGH] [TRANS_THICK], view.build_buttons_x1 + 22, button_y - (i * BUILD_BUTTON_H) + 10, ALLEGRO_ALIGN_LEFT, "%s", templ[game.user_player_index][template_index].name);
-   if (w.core[command.builder_core_index].build_command_queue[i].build_command_ctrl)
+   if (dw->core[command.builder_core_index].build_command_queue[i].build_command_ctrl)
 	   al_draw_textf(font[FONT_SQUARE].fnt, colours.base_trans [COL_TURQUOISE] [SHADE_MAX] [TRANS_THICK], view.build_buttons_x2 - 8, button_y - (i * BUILD_BUTTON_H) + 10, ALLEGRO_ALIGN_RIGHT, "+");
 
 		}
@@ -430,17 +438,17 @@ c = CONSOLE_SYSTEM; // system console gets special minimalist treatment:
 // red means error or permanent failure (e.g. invalid template or build location out of bounds)
   char queue_header_text [50] = "Queue";
 
-  switch(w.player[game.user_player_index].build_queue_fail_reason)
+  switch(dw->player[game.user_player_index].build_queue_fail_reason)
   {
 			case BUILD_FAIL_DATA:
-				if (w.player[game.user_player_index].build_queue[0].template_index != -1
-					&& templ[game.user_player_index][w.player[game.user_player_index].build_queue[0].template_index].data_cost > w.player[game.user_player_index].data)
-			  sprintf(queue_header_text, "Need %i data", templ[game.user_player_index][w.player[game.user_player_index].build_queue[0].template_index].data_cost - w.player[game.user_player_index].data);
+				if (dw->player[game.user_player_index].build_queue[0].template_index != -1
+					&& templ[game.user_player_index][dw->player[game.user_player_index].build_queue[0].template_index].data_cost > dw->player[game.user_player_index].data)
+			  sprintf(queue_header_text, "Need %i data", templ[game.user_player_index][dw->player[game.user_player_index].build_queue[0].template_index].data_cost - dw->player[game.user_player_index].data);
 		  break;
 			case BUILD_FAIL_NOT_READY:
-				sancheck(w.player[game.user_player_index].build_queue[0].core_index, 0, w.max_cores, "display_consoles_and_buttons: core_index");
-				if (w.core[w.player[game.user_player_index].build_queue[0].core_index].build_cooldown_time > w.world_time)
-		   sprintf(queue_header_text, "Recycle %i", (w.core[w.player[game.user_player_index].build_queue[0].core_index].build_cooldown_time - w.world_time) / EXECUTION_COUNT);
+				sancheck(dw->player[game.user_player_index].build_queue[0].core_index, 0, dw->max_cores, "display_consoles_and_buttons: core_index");
+				if (dw->core[dw->player[game.user_player_index].build_queue[0].core_index].build_cooldown_time > dw->world_time)
+		   sprintf(queue_header_text, "Recycle %i", (dw->core[dw->player[game.user_player_index].build_queue[0].core_index].build_cooldown_time - dw->world_time) / EXECUTION_COUNT);
 		  break;
 			case BUILD_FAIL_COLLISION:
 		  strcpy(queue_header_text, "Collision");
@@ -451,7 +459,7 @@ c = CONSOLE_SYSTEM; // system console gets special minimalist treatment:
     queue_header_col = COL_YELLOW;
     break;
    case BUILD_FAIL_OUT_OF_BOUNDS:
-		  strcpy(queue_header_text, "Invalid location");//, w.player[game.user_player_index].build_queue[0].build_x, w.player[game.user_player_index].build_queue[0].build_y);
+		  strcpy(queue_header_text, "Invalid location");//, dw->player[game.user_player_index].build_queue[0].build_x, dw->player[game.user_player_index].build_queue[0].build_y);
     queue_header_col = COL_RED;
     break;
    case BUILD_FAIL_OUT_OF_RANGE:
@@ -522,7 +530,7 @@ c = CONSOLE_SYSTEM; // system console gets special minimalist treatment:
 
   for (i = 0; i < BUILD_QUEUE_LENGTH; i ++)
 		{
-			if (w.player[game.user_player_index].build_queue[i].active == 0)
+			if (dw->player[game.user_player_index].build_queue[i].active == 0)
 				break;
 
 			if (i == queue_button_highlight_mouseover)
@@ -553,9 +561,9 @@ c = CONSOLE_SYSTEM; // system console gets special minimalist treatment:
 
 // add cancel button:
     if (queue_button_highlight_mouseover != -1
-					&& w.player[game.user_player_index].build_queue[queue_button_highlight_mouseover].active
+					&& dw->player[game.user_player_index].build_queue[queue_button_highlight_mouseover].active
 				 && queue_button_highlight_drag == -1
-				 && w.command_mode == COMMAND_MODE_COMMAND)
+				 && dw->command_mode == COMMAND_MODE_COMMAND)
 				{
 
 					draw_cancel_x = 1;
@@ -590,14 +598,14 @@ c = CONSOLE_SYSTEM; // system console gets special minimalist treatment:
 
   for (i = 0; i < BUILD_QUEUE_LENGTH; i ++)
 		{
-			if (w.player[game.user_player_index].build_queue[i].active == 0)
+			if (dw->player[game.user_player_index].build_queue[i].active == 0)
 				break;
 
-			template_index = w.player[game.user_player_index].build_queue[i].template_index;
+			template_index = dw->player[game.user_player_index].build_queue[i].template_index;
 			sancheck(template_index, 0, TEMPLATES_PER_PLAYER, "console template_index");
-	  al_draw_textf(font[FONT_BASIC].fnt, colours.base_trans [COL_GREY] [SHADE_HIGH] [TRANS_THICK], view.build_buttons_x1 + 10, button_y - (i * BUILD_BUTTON_H) + scaleUI_y(FONT_BASIC,9), ALLEGRO_ALIGN_LEFT, "%i", w.player[game.user_player_index].build_queue[i].core_index);
+	  al_draw_textf(font[FONT_BASIC].fnt, colours.base_trans [COL_GREY] [SHADE_HIGH] [TRANS_THICK], view.build_buttons_x1 + 10, button_y - (i * BUILD_BUTTON_H) + scaleUI_y(FONT_BASIC,9), ALLEGRO_ALIGN_LEFT, "%i", dw->player[game.user_player_index].build_queue[i].core_index);
 	  al_draw_textf(font[FONT_SQUARE].fnt, colours.base_trans [COL_GREY] [SHADE_HIGH] [TRANS_THICK], view.build_buttons_x1 + 32, button_y - (i * BUILD_BUTTON_H) + scaleUI_y(FONT_SQUARE,7), ALLEGRO_ALIGN_LEFT, "%s", templ[game.user_player_index][template_index].name);
-   if (w.player[game.user_player_index].build_queue[i].repeat)
+   if (dw->player[game.user_player_index].build_queue[i].repeat)
 	   al_draw_textf(font[FONT_SQUARE].fnt, colours.base_trans [COL_TURQUOISE] [SHADE_MAX] [TRANS_THICK], view.build_buttons_x2 - 8, button_y - (i * BUILD_BUTTON_H) + scaleUI_y(FONT_SQUARE,7), ALLEGRO_ALIGN_RIGHT, "+");
 
 		}
@@ -605,7 +613,7 @@ c = CONSOLE_SYSTEM; // system console gets special minimalist treatment:
 
 
 
-//			if (w.core[command.builder_core_index].build_command_queue[0].active != 0)
+//			if (dw->core[command.builder_core_index].build_command_queue[0].active != 0)
 			{
 
 
@@ -662,7 +670,7 @@ c = CONSOLE_SYSTEM; // system console gets special minimalist treatment:
      al_draw_textf(font[FONT_BASIC].fnt, colours.base [COL_RED] [SHADE_MAX], view.window_x_unzoomed / 2, view.window_y_unzoomed / 2 + scaleUI_y(FONT_SQUARE, 105), ALLEGRO_ALIGN_CENTRE, "Check the template and make sure it's loaded properly.");
      break;
    	case SPAWN_FAIL_DATA:
-     al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_RED] [SHADE_MAX], view.window_x_unzoomed / 2, view.window_y_unzoomed / 2 + scaleUI_y(FONT_SQUARE, 90), ALLEGRO_ALIGN_CENTRE, "Template 0 data cost too high (maximum %i).", w.player[game.spawn_fail].data);
+     al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_RED] [SHADE_MAX], view.window_x_unzoomed / 2, view.window_y_unzoomed / 2 + scaleUI_y(FONT_SQUARE, 90), ALLEGRO_ALIGN_CENTRE, "Template 0 data cost too high (maximum %i).", dw->player[game.spawn_fail].data);
      break;
    }
 
@@ -748,6 +756,15 @@ void write_text_to_console(int console_index, int print_colour, int text_source,
 
 sancheck(console_index, 0, CONSOLES, "write_text_to_console: console_index");
 
+ if (current_commit != NULL)
+	{
+// this thread is executing a core in the parallel phase (see g_proc_par.c), so the text is written in the commit phase:
+		defer_console_text(console_index, print_colour, text_source, source_core_created_timestamp, write_text);
+		return;
+	}
+
+ lock_consoles(); // the display may be drawing the consoles while this is called by a tick on the simulation thread (see g_sim.c)
+
 // if the most recently written line was written by a different core, or in a different tick, go to next line:
  if ((console[console_index].source_index != text_source
 		 || console[console_index].time_written != w.world_time)
@@ -797,6 +814,7 @@ sancheck(console_index, 0, CONSOLES, "write_text_to_console: console_index");
  console[console_index].source_index = text_source;
  console[console_index].time_written = w.world_time;
 
+ unlock_consoles();
 
 }
 
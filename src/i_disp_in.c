@@ -9,6 +9,7 @@
 #include "g_header.h"
 #include "g_misc.h"
 #include "i_background.h"
+#include "i_back_cache.h"
 #include "i_disp_in.h"
 #include "i_display.h"
 #include "i_header.h"
@@ -1047,6 +1048,9 @@ static void map_hex_colours(int p, int base_hex_colour)
 
   // colours.back_fill [0] [0] [0] = map_rgba(30,30,55,60);
   // colours.back_fill [0] [0] [0] = map_rgb(20,20,55);
+
+  // the cached background nodes have the old colours in their vertices:
+  invalidate_back_cache();
 }
 
 static void map_player_packet_colours(int p)
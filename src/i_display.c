@@ -6,8 +6,10 @@
 #include "m_config.h"
 
 #include <stdio.h>
+#include <stddef.h>
 #include <math.h>
 #include <string.h>
+#include <stdlib.h>
 
 #include "g_header.h"
 #include "m_globvars.h"
@@ -34,6 +36,9 @@
 #include "g_method.h"
 #include "v_interp.h"
 #include "v_draw_panel.h"
+#include "m_profile.h"
+#include "i_back_cache.h"
+#include "i_snapshot.h"
 
 /*
 
@@ -78,7 +83,6 @@ static float vertex_list [VERTEX_LIST_SIZE] [2];
 //static void add_outline_poly_layer(int layer, int vertices, ALLEGRO_COLOR fill_col, ALLEGRO_COLOR edge_col);
 static void add_poly_layer(int layer, int vertices, ALLEGRO_COLOR fill_col);
 void add_outline_diamond_layer(int layer, float vx1, float vy1, float vx2, float vy2, float vx3, float vy3, float vx4, float vy4, ALLEGRO_COLOR fill_col, ALLEGRO_COLOR edge_col);
-static void add_diamond_layer(int layer, float vx1, float vy1, float vx2, float vy2, float vx3, float vy3, float vx4, float vy4, ALLEGRO_COLOR fill_col);
 //static void add_outline_triangle_layer(int layer, float vx1, float vy1, float vx2, float vy2, float vx3, float vy3, ALLEGRO_COLOR fill_col, ALLEGRO_COLOR edge_col);
 //static void add_filled_rectangle(int layer, float x1, float y1, float x2, float y2, ALLEGRO_COLOR fill_col);
 void draw_stream_beam(float x1, float by1, float x2, float y2, int col, int status, int counter, int hit);
@@ -164,6 +168,7 @@ static void draw_notional_group(struct template_struct* draw_templ, al_fixed wor
 static void draw_spray(float x, float y, float spray_size, int base_bit_size, int player_index, int shade, int time_elapsed, int max_time, int spray_bits, int drand_seed);
 
 static void seed_drand(int seed);
+static void draw_profile_overlay(void);
 static int drand(int mod, int drand_pos_change);
 
 static void vision_check_for_display(void);
@@ -315,13 +320,22 @@ void add_simple_outline_triangle_layer(int layer, float x, float y, float angle_
 */
 
 void add_line(int layer, float x, float y, float xa, float ya, ALLEGRO_COLOR col);
-static void add_orthogonal_hexagon(int layer, float x, float y, float size, ALLEGRO_COLOR col1);
 static void add_stretched_hexagon(float x, float y, float size, ALLEGRO_COLOR col1);
 static void add_orthogonal_rect(int layer, float xa, float ya, float xb, float yb, ALLEGRO_COLOR col1);
 static void add_diagonal_octagon(int layer, float x, float y, float size, ALLEGRO_COLOR col1);
 
 static void draw_data_well_exclusion_zones(void);
 
+static void get_visible_blocks(int* min_bx, int* min_by, int* max_bx, int* max_by);
+static void build_visible_proc_list(void);
+static void build_visible_packet_list(void);
+static int next_drawn_core(int start);
+static int check_drawn_proc_visible_to_user(int proc_index);
+
+// counts calls to run_display() (data_well[].last_drawn is compared with this, as game.total_time doesn't change while the display
+//  is drawing frames during a tick on the simulation thread - see g_sim.c)
+static timestamp display_frame = 0;
+
 /*
 static void draw_burst(float x, float y,
 																							float size,
@@ -370,7 +384,7 @@ void construct_line(int layer, int v1, int v2)
 	vbuf.index_line [layer] [vbuf.index_pos_line [layer]++] = v2;
 }
 
-static void add_orthogonal_hexagon(int layer, float x, float y, float size, ALLEGRO_COLOR col1)
+void add_orthogonal_hexagon(int layer, float x, float y, float size, ALLEGRO_COLOR col1)
 {
 
 	int m = vbuf.vertex_pos_triangle;
@@ -456,6 +470,214 @@ static void add_orthogonal_rect(int layer, float xa, float ya, float xb, float y
 
 extern struct view_struct view;
 
+// Procs and packets are only drawn if they're within 200 screen pixels of the edge of the main panel.
+// Instead of checking every proc and packet, run_display() collects the ones in the blocks within that margin
+//  (from the dw->block blocklists) in visible_list, sorted so that they're drawn in the same order as if the whole
+//  arrays were searched. The lists only need to be a superset of what's drawn - the usual screen position check is still done.
+// The blocklists are rebuilt once a tick, but procs and packets created between rebuilds are put on them as they're created
+//  (add_proc_to_blocklist() in g_motion.c, add_packet_to_blocklist() in g_packet.c), and loading a game rebuilds them, so nothing is missed.
+#define VISIBLE_MARGIN 200
+
+struct visible_proc_struct
+{
+	int mobile;
+	int core_index;
+	int group_member_index;
+	int proc_index;
+};
+
+struct visible_list_struct
+{
+	struct visible_proc_struct* proc;
+	int procs;
+	int proc_capacity;
+	int* packet;
+	int packets;
+	int packet_capacity;
+};
+
+static struct visible_list_struct visible_list;
+
+// Finds the range of blocks that may contain a proc or packet close enough to the screen to be drawn.
+static void get_visible_blocks(int* min_bx, int* min_by, int* max_bx, int* max_by)
+{
+
+ al_fixed margin_x = al_ftofix((view.window_x_unzoomed / 2 + VISIBLE_MARGIN) / view.zoom);
+ al_fixed margin_y = al_ftofix((view.window_y_unzoomed / 2 + VISIBLE_MARGIN) / view.zoom);
+
+ *min_bx = fixed_to_block(view.camera_x - margin_x);
+ *min_by = fixed_to_block(view.camera_y - margin_y);
+ *max_bx = fixed_to_block(view.camera_x + margin_x) + 1; // +1 because fixed_to_block rounds towards zero
+ *max_by = fixed_to_block(view.camera_y + margin_y) + 1;
+
+ if (*min_bx < 0)
+		*min_bx = 0;
+ if (*min_by < 0)
+		*min_by = 0;
+ if (*max_bx > dw->blocks.x - 1)
+		*max_bx = dw->blocks.x - 1;
+ if (*max_by > dw->blocks.y - 1)
+		*max_by = dw->blocks.y - 1;
+
+}
+
+// immobile procs first, then by core, then by group member (this is the order they used to be drawn in)
+static int compare_visible_procs(const void* a, const void* b)
+{
+
+ const struct visible_proc_struct* va = a;
+ const struct visible_proc_struct* vb = b;
+
+ if (va->mobile != vb->mobile)
+		return va->mobile - vb->mobile;
+ if (va->core_index != vb->core_index)
+		return va->core_index - vb->core_index;
+ return va->group_member_index - vb->group_member_index;
+
+}
+
+static int compare_visible_packets(const void* a, const void* b)
+{
+
+ return *(const int*) a - *(const int*) b;
+
+}
+
+static void build_visible_proc_list(void)
+{
+
+ int bx, by, min_bx, min_by, max_bx, max_by;
+ int i, count;
+ struct proc_struct* pr;
+ struct core_struct* core;
+
+ if (visible_list.proc_capacity < dw->max_procs)
+	{
+		free(visible_list.proc);
+		visible_list.proc = malloc(sizeof(struct visible_proc_struct) * dw->max_procs);
+		if (visible_list.proc == NULL)
+		{
+			fprintf(stdout, "\nError: i_display.c: build_visible_proc_list(): couldn't allocate visible proc list.");
+			error_call();
+		}
+		visible_list.proc_capacity = dw->max_procs;
+	}
+
+ get_visible_blocks(&min_bx, &min_by, &max_bx, &max_by);
+
+ count = 0;
+
+ for (bx = min_bx; bx <= max_bx; bx ++)
+	{
+		for (by = min_by; by <= max_by; by ++)
+		{
+			if (dw->block [bx] [by].tag != dw->blocktag)
+				continue;
+// destroyed procs aren't taken off blocklists, so the count check stops a list that's been relinked through a reused proc from running on
+			for (pr = dw->block [bx] [by].blocklist_down; pr != NULL && count < visible_list.proc_capacity; pr = pr->blocklist_down)
+			{
+				if (pr->core_index < 0
+					|| pr->core_index >= dw->max_cores
+					|| pr->group_member_index < 0
+					|| pr->group_member_index >= GROUP_MAX_MEMBERS)
+					continue;
+				core = &dw->core [pr->core_index];
+// same checks as going through each core's group members:
+				if (core->exists == 0
+					|| pr->group_member_index >= core->group_members_max
+					|| core->group_member[pr->group_member_index].exists == 0
+					|| core->group_member[pr->group_member_index].index != pr->index)
+					continue;
+				visible_list.proc[count].mobile = core->mobile;
+				visible_list.proc[count].core_index = pr->core_index;
+				visible_list.proc[count].group_member_index = pr->group_member_index;
+				visible_list.proc[count].proc_index = pr->index;
+				count ++;
+			}
+		}
+	}
+
+ qsort(visible_list.proc, count, sizeof(struct visible_proc_struct), compare_visible_procs);
+
+// a relinked list could also have put a proc on the list twice:
+ visible_list.procs = 0;
+ for (i = 0; i < count; i ++)
+	{
+		if (visible_list.procs > 0
+			&& visible_list.proc[visible_list.procs - 1].proc_index == visible_list.proc[i].proc_index)
+			continue;
+		visible_list.proc[visible_list.procs] = visible_list.proc[i];
+		visible_list.procs ++;
+	}
+
+}
+
+// packet blocklists are kept current by g_packet.c until the next run_packets() call (see dw->packet_blocktag)
+static void build_visible_packet_list(void)
+{
+
+ int bx, by, min_bx, min_by, max_bx, max_by;
+ struct packet_struct* pack;
+
+ if (visible_list.packet_capacity < dw->max_packets)
+	{
+		free(visible_list.packet);
+		visible_list.packet = malloc(sizeof(int) * dw->max_packets);
+		if (visible_list.packet == NULL)
+		{
+			fprintf(stdout, "\nError: i_display.c: build_visible_packet_list(): couldn't allocate visible packet list.");
+			error_call();
+		}
+		visible_list.packet_capacity = dw->max_packets;
+	}
+
+ get_visible_blocks(&min_bx, &min_by, &max_bx, &max_by);
+
+ visible_list.packets = 0;
+
+ for (bx = min_bx; bx <= max_bx; bx ++)
+	{
+		for (by = min_by; by <= max_by; by ++)
+		{
+			if (dw->block [bx] [by].packet_tag != dw->packet_blocktag)
+				continue;
+			for (pack = dw->block [bx] [by].packet_down; pack != NULL && visible_list.packets < visible_list.packet_capacity; pack = pack->blocklist_down)
+			{
+				if (pack->exists == 0)
+					continue;
+				visible_list.packet [visible_list.packets] = pack->index;
+				visible_list.packets ++;
+			}
+		}
+	}
+
+// keeps the drawing order the same as going through dw->packet (it matters where packets overlap)
+ qsort(visible_list.packet, visible_list.packets, sizeof(int), compare_visible_packets);
+
+}
+
+// like next_used_core() (g_misc.c), but for dw
+static int next_drawn_core(int start)
+{
+
+ return find_pool_clear_bit(dw->core_free_bits, start, dw->max_cores);
+
+}
+
+// like check_proc_visible_to_user() (g_command.c), but for dw
+static int check_drawn_proc_visible_to_user(int proc_index)
+{
+
+ sancheck(proc_index, 0, dw->max_procs, "check_drawn_proc_visible_to_user");
+
+	if (game.vision_mask
+		&&	dw->vision_area[game.user_player_index][dw->proc[proc_index].block_position.x][dw->proc[proc_index].block_position.y].vision_time < dw->world_time - VISION_AREA_VISIBLE_TIME)
+		return 0;
+
+	return 1;
+
+}
+
 void run_display(void)
 {
 
@@ -468,6 +690,8 @@ void run_display(void)
  int shade;
  int bubble_list_index = -1; // part of linked list used to draw bubble text
 
+ display_frame ++;
+
  al_set_target_bitmap(vision_mask);
  al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
 // al_clear_to_color(colours.black);
@@ -477,7 +701,7 @@ void run_display(void)
    else
     al_clear_to_color(al_map_rgba(0,0,0,120));
 #else
- if (w.debug_mode == 0)
+ if (dw->debug_mode == 0)
   al_clear_to_color(colours.black);
 
 #endif
@@ -670,10 +894,10 @@ work out float x coordinate for that block in same way as for any object in worl
 	  min_block_x = 0;
   if (min_block_y < 0)
 	  min_block_y = 0;
-  if (max_block_x > w.blocks.x)
-	  max_block_x = w.blocks.x;
-  if (max_block_y > w.blocks.y)
-	  max_block_y = w.blocks.y;
+  if (max_block_x > dw->blocks.x)
+	  max_block_x = dw->blocks.x;
+  if (max_block_y > dw->blocks.y)
+	  max_block_y = dw->blocks.y;
 
   al_fixed special_camera_x [BACKBLOCK_LAYERS];
   al_fixed special_camera_y [BACKBLOCK_LAYERS];
@@ -684,11 +908,11 @@ work out float x coordinate for that block in same way as for any object in worl
 
   for (i = 0; i < BACKBLOCK_LAYERS; i ++)
 		{
-			special_camera_x [i] = view.camera_x * w.backblock_parallax [i];
-			special_camera_y [i] = view.camera_y * w.backblock_parallax [i];
+			special_camera_x [i] = view.camera_x * dw->backblock_parallax [i];
+			special_camera_y [i] = view.camera_y * dw->backblock_parallax [i];
 
-			int layer_min_block_x = screen_centre_block_x - ((screen_width_in_blocks / 2) / w.backblock_parallax [i]);
-			int layer_min_block_y = screen_centre_block_y - ((screen_height_in_blocks / 2) / w.backblock_parallax [i]);
+			int layer_min_block_x = screen_centre_block_x - ((screen_width_in_blocks / 2) / dw->backblock_parallax [i]);
+			int layer_min_block_y = screen_centre_block_y - ((screen_height_in_blocks / 2) / dw->backblock_parallax [i]);
 
    top_left_corner_x [i] = al_fixtof((layer_min_block_x * BLOCK_SIZE_PIXELS) - special_camera_x [i]) * view.zoom + (view.window_x_unzoomed / 2);
    top_left_corner_y [i] = al_fixtof((layer_min_block_y * BLOCK_SIZE_PIXELS) - special_camera_y [i]) * view.zoom + (view.window_y_unzoomed / 2);
@@ -718,262 +942,30 @@ work out float x coordinate for that block in same way as for any object in worl
 if (!settings.option[OPTION_NO_BACKGROUND])
 {
 
-	if (!settings.option[OPTION_FAST_BACKGROUND])
-	{
-// The following is the code to draw the full background:
-  for (i = min_block_x; i < max_block_x; i ++)
-  {
-
-   bx = i; //base_bx + i;
-
-   check_vbuf();
-
-
-   for (j = min_block_y; j < max_block_y; j ++)
-   {
-    by = j;//base_by + j;
-
-    backbl = &w.backblock [bx] [by];
-/*
-        bx2 = top_left_corner_x [3] + (BLOCK_SIZE_PIXELS * view.zoom * w.backblock_parallax [3]) * (i); //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
-        by2 = top_left_corner_y [3] + (BLOCK_SIZE_PIXELS * view.zoom * w.backblock_parallax [3]) * (j); //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
-        float bx4 = bx2 + (BLOCK_SIZE_PIXELS * view.zoom * w.backblock_parallax [backbl->node_depth [3]]);
-        float by4 = by2 + (BLOCK_SIZE_PIXELS * view.zoom * w.backblock_parallax [backbl->node_depth [3]]);
-        add_diamond_layer(4,
-																										bx2 + 3, by2 + 3,
-																										bx4 - 3, by2 + 3,
-																										bx4 - 3, by4 - 3,
-																										bx2 + 3, by4 - 3,
-																										colours.base_trans [COL_RED] [SHADE_LOW] [TRANS_FAINT]);
-
-*/
-
-    switch(backbl->backblock_type)
-    {
-				 case BACKBLOCK_BASIC_HEX:
-				 	{
-
-
-//       bx2 = top_left_corner_x [] + (BLOCK_SIZE_PIXELS * lower_level_zoom) * (i); //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
-//       by2 = top_left_corner_y + (BLOCK_SIZE_PIXELS * lower_level_zoom) * (j); //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
-
-       float nsize;
-       int nfillcol;
-       int node_colour;
-       int node_saturation;
-
-       for (k = 0; k < 9; k ++)
-       {
-        if (backbl->node_exists [k] == 0)
-									continue;
-
-								float specific_zoom = view.zoom * w.backblock_parallax [backbl->node_depth [k]];
-
-//						  top_left_corner_x = al_fixtof((min_block_x * BLOCK_SIZE_PIXELS) - (view.camera_x / backbl->node_depth [k])) * view.zoom + (view.window_x_unzoomed / 2);
-//        top_left_corner_y = al_fixtof((min_block_y * BLOCK_SIZE_PIXELS) - (view.camera_y / backbl->node_depth [k])) * view.zoom + (view.window_y_unzoomed / 2);
-
-       bx2 = top_left_corner_x [backbl->node_depth [k]] + (BLOCK_SIZE_PIXELS * specific_zoom) * (i); //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
-       by2 = top_left_corner_y [backbl->node_depth [k]] + (BLOCK_SIZE_PIXELS * specific_zoom) * (j); //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
-
-
-        nsize = backbl->node_size [k];
-        nfillcol = 0;
-        node_colour = backbl->node_team_col [k];
-        node_saturation = backbl->node_col_saturation [k];
-        if (w.world_time > backbl->node_colour_change_timestamp [k])
-								{
-         node_colour = backbl->node_new_colour [k];
-								 node_saturation = backbl->node_new_saturation [k];
-								}
+// the nodes (for both the full and the fast background) are cached in vertex arrays by i_back_cache.c, which draws them when draw_vbuf() is next called:
+  prepare_back_cache(min_block_x, min_block_y, max_block_x, max_block_y, top_left_corner_x, top_left_corner_y);
 
-        if (backbl->node_pending_explosion_timestamp [k] > w.world_time
-									&& backbl->node_pending_explosion_timestamp [k] < w.world_time + 32)
-								{
-//									float explosion_strength_at_node =
-         float size_increase = (backbl->node_pending_explosion_timestamp [k] - w.world_time) / 2;
-         if (size_increase > 6)
-										size_increase = 6;
-         nsize += size_increase;
-         nfillcol = (backbl->node_pending_explosion_timestamp [k] - w.world_time) / 4;
-
-         if (nfillcol >= BACK_COL_FADE)
-          nfillcol = BACK_COL_FADE - 1;
-         if (nfillcol < 0)
-										nfillcol = 0;
-
-
-								}
-
-        nsize += 0.5;
-
-
-
-       add_orthogonal_hexagon((BACKBLOCK_LAYERS - 1) - backbl->node_depth [k], bx2 + (backbl->node_x [k]) * specific_zoom, by2 + (backbl->node_y [k]) * specific_zoom, nsize * specific_zoom,
-                                      colours.back_fill [backbl->node_depth [k]] [node_colour] [node_saturation] [nfillcol]);
-
-
-//               al_draw_textf(font[FONT_BASIC].fnt, colours.base [COL_GREEN] [SHADE_MAX],
-//																				bx2 + (backbl->node_x [k]) * specific_zoom, by2 + (backbl->node_y [k]) * specific_zoom,
-//																				0, "%i:%i", j & 1, k);
-
-//               al_draw_textf(font[FONT_BASIC].fnt, colours.base [COL_GREEN] [SHADE_MAX],
-//																				bx2 + (backbl->node_x [k]) * specific_zoom, by2 + (backbl->node_y [k]) * specific_zoom, 0,
-//																													"%i", backbl->node_depth [k]);
-
-
-       }
-				 	}
-					 break;
-
-					case BACKBLOCK_DATA_WELL:
-					case BACKBLOCK_DATA_WELL_EDGE:
-						{
-							if (w.data_well[backbl->backblock_value].last_drawn == game.total_time)
-								continue;
-
-							w.data_well[backbl->backblock_value].last_drawn = game.total_time;
-
-							sancheck(deferred_data_wells, 0, DEFERRED_DATA_WELL_DRAWINGS, "deferred_data_wells");
-
-      	deferred_data_well_draw_i [deferred_data_wells] = i;
-	      deferred_data_well_draw_j [deferred_data_wells] = j;
-	      deferred_data_well_draw_backbl [deferred_data_wells] = backbl;
-       deferred_data_wells ++;
-
-
-
-						}
-      break; // end data well drawing code
-
-    	default:
-						break;
-
-    }
-
-
-   }
-  }
-
-	} // end if (!settings.option[OPTION_FAST_BACKGROUND])
-	 else
-		{
-
-// The following is the code to draw the reduced detail (1) background:
+// data wells are still found here:
   for (i = min_block_x; i < max_block_x; i ++)
   {
 
    bx = i; //base_bx + i;
 
-   check_vbuf();
-
-
    for (j = min_block_y; j < max_block_y; j ++)
    {
     by = j;//base_by + j;
 
-    backbl = &w.backblock [bx] [by];
+    backbl = &dw->backblock [bx] [by];
 
     switch(backbl->backblock_type)
     {
-				 case BACKBLOCK_BASIC_HEX:
-				 	{
-
-       float nsize;
-       int nfillcol;
-       int node_colour;
-       int node_saturation;
-
-       for (k = 0; k < 9; k ++)
-       {
-        if (backbl->node_exists [k] == 0)
-									continue;
-
-								float specific_zoom = view.zoom * w.backblock_parallax [backbl->node_depth [k]];
-
-       bx2 = top_left_corner_x [backbl->node_depth [k]] + (BLOCK_SIZE_PIXELS * specific_zoom) * (i); //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
-       by2 = top_left_corner_y [backbl->node_depth [k]] + (BLOCK_SIZE_PIXELS * specific_zoom) * (j); //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
-
-// node_size is set a bit smaller (in the world generation functions) with this setting activated
-        nsize = backbl->node_size [k];
-        nfillcol = 0;
-        node_colour = backbl->node_team_col [k];
-        node_saturation = backbl->node_col_saturation [k];
-        if (w.world_time > backbl->node_colour_change_timestamp [k])
-								{
-         node_colour = backbl->node_new_colour [k];
-								 node_saturation = backbl->node_new_saturation [k];
-								}
-
-        if (backbl->node_pending_explosion_timestamp [k] > w.world_time
-									&& backbl->node_pending_explosion_timestamp [k] < w.world_time + 32)
-								{
-//									float explosion_strength_at_node =
-         float size_increase = (backbl->node_pending_explosion_timestamp [k] - w.world_time) / 2;
-         if (size_increase > 6)
-										size_increase = 6;
-         nsize += size_increase;
-         nfillcol = (backbl->node_pending_explosion_timestamp [k] - w.world_time) / 4;
-
-         if (nfillcol >= BACK_COL_FADE)
-          nfillcol = BACK_COL_FADE - 1;
-         if (nfillcol < 0)
-										nfillcol = 0;
-
-
-								}
-
-//        nsize -= 1;
-        nsize *= specific_zoom;
-
-        float diamond_centre_x = bx2 + (backbl->node_x [k]) * specific_zoom;
-        float diamond_centre_y = by2 + (backbl->node_y [k]) * specific_zoom;
-
-/*
-        add_diamond_layer((BACKBLOCK_LAYERS - 1) - backbl->node_depth [k],
-																										diamond_centre_x,
-																										diamond_centre_y - nsize,
-																										diamond_centre_x + nsize,
-																										diamond_centre_y,
-																										diamond_centre_x,
-																										diamond_centre_y + nsize,
-																										diamond_centre_x - nsize,
-																										diamond_centre_y,
-                          colours.back_fill [backbl->node_depth [k]] [node_colour] [node_saturation] [nfillcol]);
-*/
-
-        add_diamond_layer((BACKBLOCK_LAYERS - 1) - backbl->node_depth [k],
-																										diamond_centre_x - nsize,
-																										diamond_centre_y - nsize,
-																										diamond_centre_x + nsize,
-																										diamond_centre_y - nsize,
-																										diamond_centre_x + nsize,
-																										diamond_centre_y + nsize,
-																										diamond_centre_x - nsize,
-																										diamond_centre_y + nsize,
-                          colours.back_fill [backbl->node_depth [k]] [node_colour] [node_saturation] [nfillcol]);
-
-
-
-//               al_draw_textf(font[FONT_BASIC].fnt, colours.base [COL_GREEN] [SHADE_MAX],
-//																				bx2 + (backbl->node_x [k]) * specific_zoom, by2 + (backbl->node_y [k]) * specific_zoom,
-//																				0, "%i:%i", j & 1, k);
-
-//               al_draw_textf(font[FONT_BASIC].fnt, colours.base [COL_GREEN] [SHADE_MAX],
-//																				bx2 + (backbl->node_x [k]) * specific_zoom, by2 + (backbl->node_y [k]) * specific_zoom, 0,
-//																													"%i", backbl->node_depth [k]);
-
-
-       }
-				 	}
-					 break;
-
 					case BACKBLOCK_DATA_WELL:
 					case BACKBLOCK_DATA_WELL_EDGE:
 						{
-							if (w.data_well[backbl->backblock_value].last_drawn == game.total_time)
+							if (dw->data_well[backbl->backblock_value].last_drawn == display_frame)
 								continue;
 
-							w.data_well[backbl->backblock_value].last_drawn = game.total_time;
+							dw->data_well[backbl->backblock_value].last_drawn = display_frame;
 
 							sancheck(deferred_data_wells, 0, DEFERRED_DATA_WELL_DRAWINGS, "deferred_data_wells");
 
@@ -996,15 +988,6 @@ if (!settings.option[OPTION_NO_BACKGROUND])
    }
   }
 
-
-
-
-
-
-
-		}
-
-
   i = 0;
 
   while (i < deferred_data_wells)
@@ -1014,7 +997,7 @@ if (!settings.option[OPTION_NO_BACKGROUND])
 																						deferred_data_well_draw_j [i],
 																						deferred_data_well_draw_backbl [i],
 																						top_left_corner_x, top_left_corner_y,
-																						w.story_area, 0);
+																						dw->story_area, 0);
 
 
 			i++;
@@ -1032,22 +1015,22 @@ if (!settings.option[OPTION_NO_BACKGROUND])
   deferred_data_wells = 0;
 
 
-  for (i = 0; i < w.data_wells; i ++)
+  for (i = 0; i < dw->data_wells; i ++)
 		{
-			if (w.data_well[i].block_position.x >= min_block_x - 6
-				&& w.data_well[i].block_position.x <= max_block_x + 6
-				&& w.data_well[i].block_position.y >= min_block_y - 6
-				&& w.data_well[i].block_position.y <= max_block_y + 6)
+			if (dw->data_well[i].block_position.x >= min_block_x - 6
+				&& dw->data_well[i].block_position.x <= max_block_x + 6
+				&& dw->data_well[i].block_position.y >= min_block_y - 6
+				&& dw->data_well[i].block_position.y <= max_block_y + 6)
 			{
-       draw_data_well(w.data_well[i].block_position.x,
-																						w.data_well[i].block_position.y,
-																						&w.backblock[w.data_well[i].block_position.x][w.data_well[i].block_position.y],
+       draw_data_well(dw->data_well[i].block_position.x,
+																						dw->data_well[i].block_position.y,
+																						&dw->backblock[dw->data_well[i].block_position.x][dw->data_well[i].block_position.y],
 																						top_left_corner_x, top_left_corner_y,
-																						w.story_area, 0);
+																						dw->story_area, 0);
 
-      	deferred_data_well_draw_i [deferred_data_wells] = w.data_well[i].block_position.x;
-	      deferred_data_well_draw_j [deferred_data_wells] = w.data_well[i].block_position.y;
-	      deferred_data_well_draw_backbl [deferred_data_wells] = &w.backblock[w.data_well[i].block_position.x][w.data_well[i].block_position.y];
+      	deferred_data_well_draw_i [deferred_data_wells] = dw->data_well[i].block_position.x;
+	      deferred_data_well_draw_j [deferred_data_wells] = dw->data_well[i].block_position.y;
+	      deferred_data_well_draw_backbl [deferred_data_wells] = &dw->backblock[dw->data_well[i].block_position.x][dw->data_well[i].block_position.y];
        deferred_data_wells ++;
 
 
@@ -1097,7 +1080,7 @@ if (!settings.option[OPTION_NO_BACKGROUND])
 
    if (bx < 0)
     continue;
-   if (bx >= w.blocks.x)
+   if (bx >= dw->blocks.x)
     break;
 
    check_vbuf();
@@ -1109,10 +1092,10 @@ if (!settings.option[OPTION_NO_BACKGROUND])
 
     if (by < 0)
      continue;
-    if (by >= w.blocks.y)
+    if (by >= dw->blocks.y)
      break;
 
-    backbl = &w.backblock [BACKBLOCK_LEVEL_UPPER] [bx] [by];
+    backbl = &dw->backblock [BACKBLOCK_LEVEL_UPPER] [bx] [by];
 
     switch(backbl->backblock_type)
     {
@@ -1134,21 +1117,21 @@ if (!settings.option[OPTION_NO_BACKGROUND])
         nfillcol = 0;
         node_colour = backbl->node_team_col [k];
         node_saturation = backbl->node_col_saturation [k];
-        if (w.world_time > backbl->node_colour_change_timestamp [k])
+        if (dw->world_time > backbl->node_colour_change_timestamp [k])
 								{
          node_colour = backbl->node_new_colour [k];
 								 node_saturation = backbl->node_new_saturation [k];
 								}
 
-        if (backbl->node_pending_explosion_timestamp [k] > w.world_time
-									&& backbl->node_pending_explosion_timestamp [k] < w.world_time + 32)
+        if (backbl->node_pending_explosion_timestamp [k] > dw->world_time
+									&& backbl->node_pending_explosion_timestamp [k] < dw->world_time + 32)
 								{
 //									float explosion_strength_at_node =
-         float size_increase = (backbl->node_pending_explosion_timestamp [k] - w.world_time) / 2;
+         float size_increase = (backbl->node_pending_explosion_timestamp [k] - dw->world_time) / 2;
          if (size_increase > 6)
 										size_increase = 6;
          nsize += size_increase;
-         nfillcol = (backbl->node_pending_explosion_timestamp [k] - w.world_time) / 4;
+         nfillcol = (backbl->node_pending_explosion_timestamp [k] - dw->world_time) / 4;
 
          if (nfillcol >= BACK_COL_FADE)
           nfillcol = BACK_COL_FADE - 1;
@@ -1213,17 +1196,17 @@ well_size = base_dist + 32;
 
 							int transfer_colour_adjust;
 
-       if (w.world_time - w.data_well[backbl->backblock_value].last_transferred < 32)
-								transfer_colour_adjust = 32 - (w.world_time - w.data_well[backbl->backblock_value].last_transferred);
+       if (dw->world_time - dw->data_well[backbl->backblock_value].last_transferred < 32)
+								transfer_colour_adjust = 32 - (dw->world_time - dw->data_well[backbl->backblock_value].last_transferred);
 							  else
 										transfer_colour_adjust = 0;
 
-							if (w.data_well[backbl->backblock_value].data > 0)
+							if (dw->data_well[backbl->backblock_value].data > 0)
 							{
-        add_orthogonal_hexagon(0, bx2, by2, (30 * w.data_well[backbl->backblock_value].data * view.zoom) / w.data_well[backbl->backblock_value].data_max, al_map_rgba(220 + transfer_colour_adjust, 200 - transfer_colour_adjust, 50 - transfer_colour_adjust, 180 + transfer_colour_adjust));
+        add_orthogonal_hexagon(0, bx2, by2, (30 * dw->data_well[backbl->backblock_value].data * view.zoom) / dw->data_well[backbl->backblock_value].data_max, al_map_rgba(220 + transfer_colour_adjust, 200 - transfer_colour_adjust, 50 - transfer_colour_adjust, 180 + transfer_colour_adjust));
 							}
 
-							float base_well_ring_angle = PI/6 + (w.world_time * w.data_well[backbl->backblock_value].spin_rate);
+							float base_well_ring_angle = PI/6 + (dw->world_time * dw->data_well[backbl->backblock_value].spin_rate);
 #define WELL_RING_RADIUS (140)
        ALLEGRO_COLOR reserve_colour;
 
@@ -1234,18 +1217,18 @@ well_size = base_dist + 32;
 
        for (k = 0; k < DATA_WELL_RESERVES; k++)
 							{
-								if (w.data_well[backbl->backblock_value].reserve_data [k] == 0)
+								if (dw->data_well[backbl->backblock_value].reserve_data [k] == 0)
 									continue;
 								int l;
 								float reserve_square_arc = 0.13;
 								float reserve_square_length = 36;
-								float reserve_data_proportion = w.data_well[backbl->backblock_value].reserve_data [k] * 0.002;
+								float reserve_data_proportion = dw->data_well[backbl->backblock_value].reserve_data [k] * 0.002;
 								reserve_square_length *= reserve_data_proportion;
 								if (reserve_data_proportion < 1)
 								 reserve_square_arc *= reserve_data_proportion;
-								for (l = 0; l < w.data_well[backbl->backblock_value].reserve_squares; l ++)
+								for (l = 0; l < dw->data_well[backbl->backblock_value].reserve_squares; l ++)
 								{
-									float square_angle = base_well_ring_angle + ((PI*2) / w.data_well[backbl->backblock_value].reserve_squares) * l;
+									float square_angle = base_well_ring_angle + ((PI*2) / dw->data_well[backbl->backblock_value].reserve_squares) * l;
 									add_diamond_layer(0,
 																											bx2 + cos(square_angle - reserve_square_arc) * WELL_RING_RADIUS*view.zoom,
 																											by2 + sin(square_angle - reserve_square_arc) * WELL_RING_RADIUS*view.zoom,
@@ -1257,7 +1240,7 @@ well_size = base_dist + 32;
 																											by2 + sin(square_angle - reserve_square_arc) * (WELL_RING_RADIUS + reserve_square_length)*view.zoom,
 																											reserve_colour);
 								}
-								base_well_ring_angle += PI / w.data_well[backbl->backblock_value].reserve_squares;
+								base_well_ring_angle += PI / dw->data_well[backbl->backblock_value].reserve_squares;
 							}
 
 
@@ -1456,7 +1439,7 @@ well_size = base_dist + 32;
 
    if (bx < 0)
     continue;
-   if (bx >= w.blocks.x)
+   if (bx >= dw->blocks.x)
     break;
 
    check_vbuf();
@@ -1470,12 +1453,12 @@ well_size = base_dist + 32;
 
     if (by < 0)
      continue;
-    if (by >= w.blocks.y)
+    if (by >= dw->blocks.y)
      break;
 
 //    fprintf(stdout, "\nbx,by %i,%i", bx, by);
 
-    bl = &w.block [bx] [by];
+    bl = &dw->block [bx] [by];
 
     switch(bl->backblock_type)
     {
@@ -1497,36 +1480,36 @@ well_size = base_dist + 32;
         nfillcol = 0;
         node_colour = bl->node_team_col [k];
         node_saturation = bl->node_col_saturation [k];
-        if (w.world_time > bl->node_colour_change_timestamp [k])
+        if (dw->world_time > bl->node_colour_change_timestamp [k])
 								{
          node_colour = bl->node_new_colour [k];
 								 node_saturation = bl->node_new_saturation [k];
 								}
 
 /*
-        if (bl->node_disrupt_timestamp [k] > w.world_time)
+        if (bl->node_disrupt_timestamp [k] > dw->world_time)
         {
-         float size_increase = (bl->node_disrupt_timestamp [k] - w.world_time) / 2;
+         float size_increase = (bl->node_disrupt_timestamp [k] - dw->world_time) / 2;
          if (size_increase > 6)
 										size_increase = 6;
          nsize += size_increase;
-         nfillcol = (bl->node_disrupt_timestamp [k] - w.world_time) / 2;
+         nfillcol = (bl->node_disrupt_timestamp [k] - dw->world_time) / 2;
          if (nfillcol >= BACK_COL_FADE)
           nfillcol = BACK_COL_FADE - 1;
 
         }
 */
 
-        if (bl->node_pending_explosion_timestamp [k] > w.world_time
-									&& bl->node_pending_explosion_timestamp [k] < w.world_time + 32)
+        if (bl->node_pending_explosion_timestamp [k] > dw->world_time
+									&& bl->node_pending_explosion_timestamp [k] < dw->world_time + 32)
 								{
 //									float explosion_strength_at_node =
-         float size_increase = (bl->node_pending_explosion_timestamp [k] - w.world_time) / 2;
+         float size_increase = (bl->node_pending_explosion_timestamp [k] - dw->world_time) / 2;
          if (size_increase > 6)
 										size_increase = 6;
          nsize += size_increase;
-         nfillcol = (bl->node_pending_explosion_timestamp [k] - w.world_time) / 4;
-//         nfillcol = (bl->node_pending_explosion_timestamp [k] - w.world_time) - (32 - BACK_COL_FADE);
+         nfillcol = (bl->node_pending_explosion_timestamp [k] - dw->world_time) / 4;
+//         nfillcol = (bl->node_pending_explosion_timestamp [k] - dw->world_time) - (32 - BACK_COL_FADE);
 //   al_draw_textf(font[FONT_BASIC].fnt, colours.base [COL_GREEN] [SHADE_MAX],
 //																				(bx2 + bl->node_x [k]) * view.zoom, (by2 + bl->node_y [k]) * view.zoom,
 //																				0, "%i", nfillcol);
@@ -1613,17 +1596,17 @@ well_size = base_dist + 32;
 
 							int transfer_colour_adjust;
 
-       if (w.world_time - w.data_well[bl->backblock_value].last_transferred < 16)
-								transfer_colour_adjust = 32 - (w.world_time - w.data_well[bl->backblock_value].last_transferred) * 2;
+       if (dw->world_time - dw->data_well[bl->backblock_value].last_transferred < 16)
+								transfer_colour_adjust = 32 - (dw->world_time - dw->data_well[bl->backblock_value].last_transferred) * 2;
 							  else
 										transfer_colour_adjust = 0;
 
-							if (w.data_well[bl->backblock_value].data > 0)
+							if (dw->data_well[bl->backblock_value].data > 0)
 							{
-        add_orthogonal_hexagon(bx2, by2, (30 * w.data_well[bl->backblock_value].data * view.zoom) / w.data_well[bl->backblock_value].data_max, al_map_rgba(220 + transfer_colour_adjust, 200, 50, 180 + transfer_colour_adjust));
+        add_orthogonal_hexagon(bx2, by2, (30 * dw->data_well[bl->backblock_value].data * view.zoom) / dw->data_well[bl->backblock_value].data_max, al_map_rgba(220 + transfer_colour_adjust, 200, 50, 180 + transfer_colour_adjust));
 							}
 
-							float base_well_ring_angle = PI/6 + (w.world_time * w.data_well[bl->backblock_value].spin_rate);
+							float base_well_ring_angle = PI/6 + (dw->world_time * dw->data_well[bl->backblock_value].spin_rate);
 #define WELL_RING_RADIUS (140)
        ALLEGRO_COLOR reserve_colour;
 							reserve_colour = al_map_rgba(180 + transfer_colour_adjust,
@@ -1633,18 +1616,18 @@ well_size = base_dist + 32;
 
        for (k = 0; k < DATA_WELL_RESERVES; k++)
 							{
-								if (w.data_well[bl->backblock_value].reserve_data [k] == 0)
+								if (dw->data_well[bl->backblock_value].reserve_data [k] == 0)
 									continue;
 								int l;
 								float reserve_square_arc = 0.13;
 								float reserve_square_length = 36;
-								float reserve_data_proportion = w.data_well[bl->backblock_value].reserve_data [k] * 0.002;
+								float reserve_data_proportion = dw->data_well[bl->backblock_value].reserve_data [k] * 0.002;
 								reserve_square_length *= reserve_data_proportion;
 								if (reserve_data_proportion < 1)
 								 reserve_square_arc *= reserve_data_proportion;
-								for (l = 0; l < w.data_well[bl->backblock_value].reserve_squares; l ++)
+								for (l = 0; l < dw->data_well[bl->backblock_value].reserve_squares; l ++)
 								{
-									float square_angle = base_well_ring_angle + ((PI*2) / w.data_well[bl->backblock_value].reserve_squares) * l;
+									float square_angle = base_well_ring_angle + ((PI*2) / dw->data_well[bl->backblock_value].reserve_squares) * l;
 									add_diamond_layer(0,
 																											bx2 + cos(square_angle - reserve_square_arc) * WELL_RING_RADIUS*view.zoom,
 																											by2 + sin(square_angle - reserve_square_arc) * WELL_RING_RADIUS*view.zoom,
@@ -1656,7 +1639,7 @@ well_size = base_dist + 32;
 																											by2 + sin(square_angle - reserve_square_arc) * (WELL_RING_RADIUS + reserve_square_length)*view.zoom,
 																											reserve_colour);
 								}
-								base_well_ring_angle += PI / w.data_well[bl->backblock_value].reserve_squares;
+								base_well_ring_angle += PI / dw->data_well[bl->backblock_value].reserve_squares;
 							}
 
 
@@ -1704,37 +1687,40 @@ well_size = base_dist + 32;
  struct core_struct* core;
 
  int immobile_or_mobile;
- int core_index, group_member_index;
+ int core_index;
+ int visible_pos;
 
- for (immobile_or_mobile = 0; immobile_or_mobile < 2; immobile_or_mobile ++)
-	{
-		for (core_index = 0; core_index < w.max_cores; core_index ++)
-		{
-			if (w.core[core_index].exists == 0)
-				continue;
+ build_visible_proc_list();
 
-// all immobile procs are drawn, then all mobile procs
-			if (immobile_or_mobile != w.core[core_index].mobile)
-				continue;
+ visible_pos = 0;
 
-			for (group_member_index = 0; group_member_index < w.core[core_index].group_members_max; group_member_index ++)
+ for (immobile_or_mobile = 0; immobile_or_mobile < 2; immobile_or_mobile ++)
+	{
+// all immobile procs are drawn, then all mobile procs (visible_list.proc is sorted this way)
+			for (; visible_pos < visible_list.procs; visible_pos ++)
 			{
 
-				if (w.core[core_index].group_member[group_member_index].exists == 0)
-					continue;
+				if (visible_list.proc[visible_pos].mobile != immobile_or_mobile)
+					break;
 
-				p = w.core[core_index].group_member[group_member_index].index;
+				core_index = visible_list.proc[visible_pos].core_index;
+				p = visible_list.proc[visible_pos].proc_index;
 
-// for (p = 0; p < w.max_procs; p ++)
+// check_vbuf() is called between cores:
+				if (visible_pos > 0
+					&& visible_list.proc[visible_pos - 1].core_index != core_index)
+					check_vbuf();
+
+// for (p = 0; p < dw->max_procs; p ++)
 // {
 
-//  if (w.proc[p].exists == 0)
+//  if (dw->proc[p].exists == 0)
 //   continue; - shouldn't be necessary, because of group_member[].exists check above
 
-  pr = &w.proc [p];
-		core = &w.core[core_index];//[pr->core_index];
+  pr = &dw->proc [p];
+		core = &dw->core[core_index];//[pr->core_index];
 
-//  pr_player = &w.player [pr->player_index];
+//  pr_player = &dw->player [pr->player_index];
 
   x = al_fixtof(pr->position.x - view.camera_x) * view.zoom;
   y = al_fixtof(pr->position.y - view.camera_y) * view.zoom;
@@ -1752,16 +1738,16 @@ well_size = base_dist + 32;
     shade = (pr->hp * 15) / pr->hp_max;
    }
 //   fill_colour = 0;
-//   if (pr->hit >= w.world_time - 16)
+//   if (pr->hit >= dw->world_time - 16)
 //    fill_colour = 1;
 
    int draw_proc = 1;
 
 // if the proc has just been created, we show a special graphic thing:
-   if (pr->created_timestamp + 64 > w.world_time)
+   if (pr->created_timestamp + 64 > dw->world_time)
    {
-   	shade = w.world_time - pr->created_timestamp;
-   	shade -= templ[pr->player_index][w.core[pr->core_index].template_index].member[pr->group_member_index].downlinks_from_core * 8;
+   	shade = dw->world_time - pr->created_timestamp;
+   	shade -= templ[pr->player_index][dw->core[pr->core_index].template_index].member[pr->group_member_index].downlinks_from_core * 8;
 
     if (shade < 0)
 					continue;
@@ -1779,9 +1765,9 @@ well_size = base_dist + 32;
      float float_shade = shade;
 
 
-   	shade = w.world_time - pr->created_timestamp;
+   	shade = dw->world_time - pr->created_timestamp;
 
-   	shade -= templ[pr->player_index][w.core[pr->core_index].template_index].member[pr->group_member_index].downlinks_from_core * 8;
+   	shade -= templ[pr->player_index][dw->core[pr->core_index].template_index].member[pr->group_member_index].downlinks_from_core * 8;
    	if (shade < 16)
 					draw_proc = 0;
    	if (shade > 16)
@@ -1810,10 +1796,10 @@ well_size = base_dist + 32;
     else
 				{
 
-     if (core->construction_complete_timestamp > w.world_time)
+     if (core->construction_complete_timestamp > dw->world_time)
 			  {
 
-			  	int pulse_time = (w.world_time - pr->created_timestamp) & 31;
+			  	int pulse_time = (dw->world_time - pr->created_timestamp) & 31;
 
       float outline_scale = 1.6 - pulse_time * 0.02;
 
@@ -1836,10 +1822,10 @@ well_size = base_dist + 32;
 
 				}
 
-				if (pr->repaired_timestamp > w.world_time - 16)
+				if (pr->repaired_timestamp > dw->world_time - 16)
 				{
 
-			  	int repair_pulse_time = (w.world_time - pr->repaired_timestamp);
+			  	int repair_pulse_time = (dw->world_time - pr->repaired_timestamp);
 
       float outline_scale = 1.6 - repair_pulse_time * 0.04;
 
@@ -1880,23 +1866,23 @@ int damage_level = (pr->hp * (PROC_DAMAGE_COLS-1)) / pr->hp_max;
     int stress_tint = 0;
     if (core->stress > 0)
 				{
-//					int pulse_time = w.world_time - core->last_execution_timestamp;
+//					int pulse_time = dw->world_time - core->last_execution_timestamp;
      switch(core->stress_level)
      {
      	case STRESS_EXTREME:
- 						stress_tint = (core->next_execution_timestamp - w.world_time) * 3;
+ 						stress_tint = (core->next_execution_timestamp - dw->world_time) * 3;
  						break;
  					case STRESS_HIGH:
 				  	if (!(core->cycles_executed & 1))
-					   stress_tint = (core->next_execution_timestamp - w.world_time) * 2;
+					   stress_tint = (core->next_execution_timestamp - dw->world_time) * 2;
 					  break;
  					case STRESS_MODERATE:
 		  	  if (!(core->cycles_executed & 3))
-				     stress_tint = (core->next_execution_timestamp - w.world_time) * 1.5; // float okay as this is just used for display
+				     stress_tint = (core->next_execution_timestamp - dw->world_time) * 1.5; // float okay as this is just used for display
 				   break;
 				  case STRESS_LOW:
 	  	   if (!(core->cycles_executed & 7))
-		      stress_tint = (core->next_execution_timestamp - w.world_time); // float okay as this is just used for display
+		      stress_tint = (core->next_execution_timestamp - dw->world_time); // float okay as this is just used for display
 							break;
 
      }
@@ -1915,9 +1901,9 @@ int damage_level = (pr->hp * (PROC_DAMAGE_COLS-1)) / pr->hp_max;
 
      int core_pulse_level = 0;
 
-     if (w.world_time - core->last_execution_timestamp < 16)
+     if (dw->world_time - core->last_execution_timestamp < 16)
 					{
-						core_pulse_level = (16 - (w.world_time - core->last_execution_timestamp)) * 2;
+						core_pulse_level = (16 - (dw->world_time - core->last_execution_timestamp)) * 2;
 					}
 
      colours.proc_col [pr->player_index] [damage_level] [0] [PROC_COL_CORE_MUTABLE] = map_rgb(colours.base_core_r [pr->player_index] + core_pulse_level,
@@ -1926,11 +1912,11 @@ int damage_level = (pr->hp * (PROC_DAMAGE_COLS-1)) / pr->hp_max;
 
 colours.proc_col [pr->player_index] [damage_level] [1] [PROC_COL_CORE_MUTABLE] = colours.proc_col [pr->player_index] [damage_level] [0] [PROC_COL_CORE_MUTABLE]; // fix this!
 
-					if (core->construction_complete_timestamp > w.world_time)
+					if (core->construction_complete_timestamp > dw->world_time)
 					{
 
 
-				   int time_until_construction_ends = core->construction_complete_timestamp - w.world_time;
+				   int time_until_construction_ends = core->construction_complete_timestamp - dw->world_time;
 
 				   float bcon_size = (time_until_construction_ends * 0.02);
 				   if (bcon_size > 32)
@@ -2048,9 +2034,9 @@ width = 6;
 /*
 					int hit_pulse_level = 0;
 
-     if (w.world_time - pr->hit_pulse_time < 16)
+     if (dw->world_time - pr->hit_pulse_time < 16)
 					{
-						hit_pulse_level = 48;//(16 - (w.world_time - pr->hit_pulse_time)) * 8;
+						hit_pulse_level = 48;//(16 - (dw->world_time - pr->hit_pulse_time)) * 8;
 					}
 
      colours.proc_col [pr->player_index] [damage_level] [PROC_COL_MAIN_1] = map_rgb(colours.base_proc_main_r [pr->player_index] [damage_level] + hit_pulse_level,
@@ -2058,9 +2044,9 @@ width = 6;
 																																																																  colours.base_proc_main_b [pr->player_index] [damage_level] + hit_pulse_level); // map_rgb is bounds-checked wrapper for al_map_rgb
 */
 
-//   colours.proc_col [pr->player_index] [damage_level] [PROC_COL_MAIN_1] = colours.proc_col_main_hit_pulse [pr->player_index] [damage_level] [(w.world_time - pr->hit_pulse_time < 8)];
+//   colours.proc_col [pr->player_index] [damage_level] [PROC_COL_MAIN_1] = colours.proc_col_main_hit_pulse [pr->player_index] [damage_level] [(dw->world_time - pr->hit_pulse_time < 8)];
 
- int hit_pulse = (w.world_time - pr->hit_pulse_time < 4);
+ int hit_pulse = (dw->world_time - pr->hit_pulse_time < 4);
 
 // This is the main proc drawing call:
   if (draw_proc)
@@ -2139,8 +2125,8 @@ width = 6;
     float charge_shade = (float) core->interface_strength / (float) core->interface_strength_max;
 
     float hit_shade = 0;
-				if (pr->interface_hit_time > w.world_time - 16)
-				 hit_shade = (pr->interface_hit_time + 16 - w.world_time) * 0.0625; // *0.0625 is /16
+				if (pr->interface_hit_time > dw->world_time - 16)
+				 hit_shade = (pr->interface_hit_time + 16 - dw->world_time) * 0.0625; // *0.0625 is /16
 
 				float interface_opacity = 0.2 + core->interface_strength * 0.001;
 				if (interface_opacity > 1)
@@ -2151,17 +2137,17 @@ width = 6;
 
 				float interface_size_proportion = 1.3;
 
-				if (pr->interface_raised_time > w.world_time - 64)
+				if (pr->interface_raised_time > dw->world_time - 64)
 				{
-					float raised_modifier = (pr->interface_raised_time + 64 - w.world_time) * 0.0156;//312;
+					float raised_modifier = (pr->interface_raised_time + 64 - dw->world_time) * 0.0156;//312;
 					if (raised_modifier > hit_shade)
 						hit_shade = raised_modifier;
-					interface_size_proportion -= (pr->interface_raised_time + 64 - w.world_time) * 0.0025;
+					interface_size_proportion -= (pr->interface_raised_time + 64 - dw->world_time) * 0.0025;
 				}
 
-				if (core->interface_charged_time > w.world_time - 8)
+				if (core->interface_charged_time > dw->world_time - 8)
 				{
-					hit_shade += (float) (8 + core->interface_charged_time - w.world_time) * 0.01;
+					hit_shade += (float) (8 + core->interface_charged_time - dw->world_time) * 0.01;
 					if (hit_shade > 1)
 						hit_shade = 1;
 				}
@@ -2169,14 +2155,14 @@ width = 6;
 
 // interface colour is based on absolute interface strength rather than a proportional value to make the colour more informative
 //  * think about this - would it be better to use absolute strength but spread over the components with active interfaces?
-				ALLEGRO_COLOR interface_colour = map_rgba(w.player[pr->player_index].interface_colour_base [0] + (w.player[pr->player_index].interface_colour_hit [0] * hit_shade) + (w.player[pr->player_index].interface_colour_charge [0] * charge_shade),
-																																																	w.player[pr->player_index].interface_colour_base [1] + (w.player[pr->player_index].interface_colour_hit [1] * hit_shade) + (w.player[pr->player_index].interface_colour_charge [1] * charge_shade),
-																																																	w.player[pr->player_index].interface_colour_base [2] + (w.player[pr->player_index].interface_colour_hit [2] * hit_shade) + (w.player[pr->player_index].interface_colour_charge [2] * charge_shade),
+				ALLEGRO_COLOR interface_colour = map_rgba(dw->player[pr->player_index].interface_colour_base [0] + (dw->player[pr->player_index].interface_colour_hit [0] * hit_shade) + (dw->player[pr->player_index].interface_colour_charge [0] * charge_shade),
+																																																	dw->player[pr->player_index].interface_colour_base [1] + (dw->player[pr->player_index].interface_colour_hit [1] * hit_shade) + (dw->player[pr->player_index].interface_colour_charge [1] * charge_shade),
+																																																	dw->player[pr->player_index].interface_colour_base [2] + (dw->player[pr->player_index].interface_colour_hit [2] * hit_shade) + (dw->player[pr->player_index].interface_colour_charge [2] * charge_shade),
 																																																	16 + interface_opacity * 16 + hit_shade * 128);
 				ALLEGRO_COLOR interface_edge_colour = map_rgba(
-																																																	w.player[pr->player_index].interface_colour_base [0] + (w.player[pr->player_index].interface_colour_hit [0] * hit_shade) + (w.player[pr->player_index].interface_colour_charge [0] * charge_shade),
-																																																	w.player[pr->player_index].interface_colour_base [1] + (w.player[pr->player_index].interface_colour_hit [1] * hit_shade) + (w.player[pr->player_index].interface_colour_charge [1] * charge_shade),
-																																																	w.player[pr->player_index].interface_colour_base [2] + (w.player[pr->player_index].interface_colour_hit [2] * hit_shade) + (w.player[pr->player_index].interface_colour_charge [2] * charge_shade),
+																																																	dw->player[pr->player_index].interface_colour_base [0] + (dw->player[pr->player_index].interface_colour_hit [0] * hit_shade) + (dw->player[pr->player_index].interface_colour_charge [0] * charge_shade),
+																																																	dw->player[pr->player_index].interface_colour_base [1] + (dw->player[pr->player_index].interface_colour_hit [1] * hit_shade) + (dw->player[pr->player_index].interface_colour_charge [1] * charge_shade),
+																																																	dw->player[pr->player_index].interface_colour_base [2] + (dw->player[pr->player_index].interface_colour_hit [2] * hit_shade) + (dw->player[pr->player_index].interface_colour_charge [2] * charge_shade),
 																																																	25 + interface_opacity * 40);
 
 // if the 1.3 scaling factor is changed, may also need to change interface collision mask generation code in init_nshape_collision_masks() in g_shape.c (see the * 13 / 10 bit)
@@ -2185,22 +2171,22 @@ width = 6;
 			}
 			 else
 				{
-					if (pr->interface_lowered_time > w.world_time - 16) // this means the core's interface is unbroken (and may be active) but this proc's interface has been specifically lowered
+					if (pr->interface_lowered_time > dw->world_time - 16) // this means the core's interface is unbroken (and may be active) but this proc's interface has been specifically lowered
 					{
 
-      float hit_shade = (pr->interface_lowered_time + 16 - w.world_time) * 0.0625; // *0.0625 is /16
+      float hit_shade = (pr->interface_lowered_time + 16 - dw->world_time) * 0.0625; // *0.0625 is /16
 
-				  float interface_size_proportion = 1.3 - (w.world_time - pr->interface_lowered_time) * 0.01;
+				  float interface_size_proportion = 1.3 - (dw->world_time - pr->interface_lowered_time) * 0.01;
 
 // interface colour is based on absolute interface strength rather than a proportional value to make the colour more informative
 //  * think about this - would it be better to use absolute strength but spread over the components with active interfaces?
-				  ALLEGRO_COLOR interface_colour = map_rgba(w.player[pr->player_index].interface_colour_base [0] + (w.player[pr->player_index].interface_colour_hit [0] * hit_shade),
-																																																	  w.player[pr->player_index].interface_colour_base [1] + (w.player[pr->player_index].interface_colour_hit [1] * hit_shade),
-																																																	  w.player[pr->player_index].interface_colour_base [2] + (w.player[pr->player_index].interface_colour_hit [2] * hit_shade),
+				  ALLEGRO_COLOR interface_colour = map_rgba(dw->player[pr->player_index].interface_colour_base [0] + (dw->player[pr->player_index].interface_colour_hit [0] * hit_shade),
+																																																	  dw->player[pr->player_index].interface_colour_base [1] + (dw->player[pr->player_index].interface_colour_hit [1] * hit_shade),
+																																																	  dw->player[pr->player_index].interface_colour_base [2] + (dw->player[pr->player_index].interface_colour_hit [2] * hit_shade),
 																																																	  5 + hit_shade * 128);
-				  ALLEGRO_COLOR interface_edge_colour = map_rgba(w.player[pr->player_index].interface_colour_base [0] + (w.player[pr->player_index].interface_colour_hit [0] * hit_shade),
-																																															  		w.player[pr->player_index].interface_colour_base [1] + (w.player[pr->player_index].interface_colour_hit [1] * hit_shade),
-																																																	  w.player[pr->player_index].interface_colour_base [2] + (w.player[pr->player_index].interface_colour_hit [2] * hit_shade),
+				  ALLEGRO_COLOR interface_edge_colour = map_rgba(dw->player[pr->player_index].interface_colour_base [0] + (dw->player[pr->player_index].interface_colour_hit [0] * hit_shade),
+																																															  		dw->player[pr->player_index].interface_colour_base [1] + (dw->player[pr->player_index].interface_colour_hit [1] * hit_shade),
+																																																	  dw->player[pr->player_index].interface_colour_base [2] + (dw->player[pr->player_index].interface_colour_hit [2] * hit_shade),
 																																																	  25);
 
 // if the 1.3 scaling factor is changed, may also need to change interface collision mask generation code in init_nshape_collision_masks() in g_shape.c (see the * 13 / 10 bit)
@@ -2214,16 +2200,16 @@ width = 6;
 
   if (pr->group_member_index == 0)
 		{
-			if (w.core[pr->core_index].bubble_text_time >= w.world_time - BUBBLE_TOTAL_TIME)
+			if (dw->core[pr->core_index].bubble_text_time >= dw->world_time - BUBBLE_TOTAL_TIME)
 			{
-  			w.core[pr->core_index].bubble_list = bubble_list_index;
+  			dw->core[pr->core_index].bubble_list = bubble_list_index;
 					bubble_list_index = pr->core_index;
-		 		w.core[pr->core_index].bubble_x = x;
-				 w.core[pr->core_index].bubble_y = y - 120 * view.zoom;//;// - scaleUI_y(FONT_SQUARE,120) * view.zoom;
+		 		dw->core[pr->core_index].bubble_x = x;
+				 dw->core[pr->core_index].bubble_y = y - 120 * view.zoom;//;// - scaleUI_y(FONT_SQUARE,120) * view.zoom;
 			}
-			if (w.core[pr->core_index].selected != -1)
+			if (dw->core[pr->core_index].selected != -1)
 			{
-				int time_since_selection = game.total_time - w.core[pr->core_index].select_time;
+				int time_since_selection = game.total_time - dw->core[pr->core_index].select_time;
 				if (time_since_selection > 12)
 					time_since_selection = 12;
 
@@ -2245,10 +2231,10 @@ width = 6;
 //		if (pr->group_member_index != 0
 			if (command.selected_core [0] == pr->core_index
 			 && command.selected_member == pr->group_member_index
-			 && w.core[pr->core_index].group_members_current > 1) // don't display this for single-member groups
+			 && dw->core[pr->core_index].group_members_current > 1) // don't display this for single-member groups
 		{
 
-				int time_since_selection = game.total_time - w.core[pr->core_index].select_time;
+				int time_since_selection = game.total_time - dw->core[pr->core_index].select_time;
 				if (time_since_selection > 12)
 					time_since_selection = 12;
 
@@ -2261,11 +2247,7 @@ width = 6;
 																		colours.base [COL_GREY] [SHADE_MAX]);// [TRANS_THICK]); //ALLEGRO_COLOR arrow_col)
 		}
 
-			} // end of group_member loop
-
-  check_vbuf();
-
- } // end of core draw loop
+			} // end of visible proc loop
 
  draw_vbuf();
 
@@ -2276,12 +2258,12 @@ width = 6;
 // if (view.mouse_on_build_queue_button_timestamp == game.total_time)
 //	{
 /*		if (command.select_mode == SELECT_MODE_SINGLE_CORE
-			&& w.core[command.selected_core [0]].build_command_queue [view.mouse_on_build_queue_button].active == 1)
+			&& dw->core[command.selected_core [0]].build_command_queue [view.mouse_on_build_queue_button].active == 1)
 		{
-	  draw_notional_group(&templ[game.user_player_index][w.core[command.selected_core[0]].build_command_queue[view.mouse_on_build_queue_button].build_template],
-																								al_itofix(w.core[command.selected_core[0]].build_command_queue[view.mouse_on_build_queue_button].build_x),
-																								al_itofix(w.core[command.selected_core[0]].build_command_queue[view.mouse_on_build_queue_button].build_y),
-																								int_angle_to_fixed(w.core[command.selected_core[0]].build_command_queue[view.mouse_on_build_queue_button].build_angle),
+	  draw_notional_group(&templ[game.user_player_index][dw->core[command.selected_core[0]].build_command_queue[view.mouse_on_build_queue_button].build_template],
+																								al_itofix(dw->core[command.selected_core[0]].build_command_queue[view.mouse_on_build_queue_button].build_x),
+																								al_itofix(dw->core[command.selected_core[0]].build_command_queue[view.mouse_on_build_queue_button].build_y),
+																								int_angle_to_fixed(dw->core[command.selected_core[0]].build_command_queue[view.mouse_on_build_queue_button].build_angle),
 																								view.zoom);
 		}*/
 //	}
@@ -2292,12 +2274,12 @@ width = 6;
 		{
 			i = 0;
 			int notional_group_draw_col;
-			while(w.player[game.user_player_index].build_queue[i].active
+			while(dw->player[game.user_player_index].build_queue[i].active
 						&& i <	BUILD_QUEUE_LENGTH)
 			{
 //				sancheck(i, 0, BUILD_QUEUE_LENGTH, "command.display_build_buttons: i outside BUILD_QUEUE_LENGTH");
-				sancheck(w.player[game.user_player_index].build_queue[i].template_index, 0, TEMPLATES_PER_PLAYER, "command.display_build_buttons template index");
-				if (!templ[game.user_player_index][w.player[game.user_player_index].build_queue[i].template_index].active)
+				sancheck(dw->player[game.user_player_index].build_queue[i].template_index, 0, TEMPLATES_PER_PLAYER, "command.display_build_buttons template index");
+				if (!templ[game.user_player_index][dw->player[game.user_player_index].build_queue[i].template_index].active)
 				{
 					i ++;
 					continue;
@@ -2309,10 +2291,10 @@ width = 6;
 						else
    				notional_group_draw_col = PLAN_COL_BUILD_QUEUE;
 
-    draw_notional_group(&templ[game.user_player_index][w.player[game.user_player_index].build_queue[i].template_index],
-																								al_itofix(w.player[game.user_player_index].build_queue[i].build_x),
-																								al_itofix(w.player[game.user_player_index].build_queue[i].build_y),
-																								int_angle_to_fixed(w.player[game.user_player_index].build_queue[i].angle),
+    draw_notional_group(&templ[game.user_player_index][dw->player[game.user_player_index].build_queue[i].template_index],
+																								al_itofix(dw->player[game.user_player_index].build_queue[i].build_x),
+																								al_itofix(dw->player[game.user_player_index].build_queue[i].build_y),
+																								int_angle_to_fixed(dw->player[game.user_player_index].build_queue[i].angle),
 																								view.zoom,
 																								notional_group_draw_col,
 																								notional_group_draw_col); // errors aren't worked out for queued builds anyway
@@ -2369,13 +2351,12 @@ draw_link_shape(x, y,
  struct packet_struct* pack;
  int pk;
 
- for (pk = 0; pk < w.max_packets; pk ++)
- {
-// TO DO: consider optimising this to use blocks instead of searching the entire packet array
-  if (w.packet[pk].exists == 0)
-   continue;
+ build_visible_packet_list();
 
-  pack = &w.packet [pk];
+ for (i = 0; i < visible_list.packets; i ++)
+ {
+  pk = visible_list.packet [i];
+  pack = &dw->packet [pk];
 
 //  x = al_fixtof(pack->x - view.camera_x) + (view.window_x/2);
 //  y = al_fixtof(pack->y - view.camera_y) + (view.window_y/2);
@@ -2406,9 +2387,9 @@ draw_link_shape(x, y,
 		 case PACKET_TYPE_BURST:
 //  	case PACKET_TYPE_BURST_DIR:
 			 {
-     packet_time = w.world_time - pack->created_timestamp;
+     packet_time = dw->world_time - pack->created_timestamp;
 
-//  			float sharpness = 4 + (w.world_time - pack->created_timestamp) * 0.1;
+//  			float sharpness = 4 + (dw->world_time - pack->created_timestamp) * 0.1;
 //  			if (sharpness > 10)
 //						sharpness = 10;
      seed_drand(pk - (packet_time/3));
@@ -2481,7 +2462,7 @@ draw_link_shape(x, y,
 /*
 		 case PACKET_TYPE_SURGE:
   		{
-//  			float sharpness = 4 + (w.world_time - pack->created_timestamp) * 0.16;
+//  			float sharpness = 4 + (dw->world_time - pack->created_timestamp) * 0.16;
 //  			if (sharpness > 10)
 
 				packet_angle = atan2(al_fixtof(pack->speed.y), al_fixtof(pack->speed.x)); // looks better if the movement direction rather than the acceleration direction is displayed
@@ -2517,7 +2498,7 @@ draw_link_shape(x, y,
   	case PACKET_TYPE_SPIKE3:
 //  	case PACKET_TYPE_SPIKE4:
   		{
-  			float sharpness = 4 + (w.world_time - pack->created_timestamp) * 0.1;
+  			float sharpness = 4 + (dw->world_time - pack->created_timestamp) * 0.1;
   			if (sharpness > 8)
 						sharpness = 8;
 					float damage_extra_size = 0;
@@ -2567,7 +2548,7 @@ draw_link_shape(x, y,
 																														*/
      bloom_circle(1, x, y, colours.bloom_centre [pack->colour] [20], colours.bloom_edge [pack->colour] [0], 32 * view.zoom);
 
-//al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_GREY] [SHADE_MAX], x + 30, y, ALLEGRO_ALIGN_CENTRE, "%i:%i", w.world_time - pack->created_timestamp, pack->damage);
+//al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_GREY] [SHADE_MAX], x + 30, y, ALLEGRO_ALIGN_CENTRE, "%i:%i", dw->world_time - pack->created_timestamp, pack->damage);
 
   		}
 			 continue;
@@ -2576,7 +2557,7 @@ draw_link_shape(x, y,
 
 // if (pack->status > 0)
 			 {
-     packet_time = w.world_time - pack->created_timestamp;
+     packet_time = dw->world_time - pack->created_timestamp;
 
      int pulse_or_burst = (pack->type == PACKET_TYPE_BURST);
 
@@ -2643,7 +2624,7 @@ draw_link_shape(x, y,
 			case PACKET_TYPE_ULTRA:
 // if (pack->status > 0)
 			 {
-     packet_time = w.world_time - pack->created_timestamp;
+     packet_time = dw->world_time - pack->created_timestamp;
 
      float x_step = al_fixtof(0 - pack->speed.x) * view.zoom;
      float y_step = al_fixtof(0 - pack->speed.y) * view.zoom;
@@ -2708,7 +2689,7 @@ draw_link_shape(x, y,
 			case PACKET_TYPE_PULSE:
 			case PACKET_TYPE_BURST:
 			 {
-     packet_time = w.world_time - pack->created_timestamp;
+     packet_time = dw->world_time - pack->created_timestamp;
 
 //     int pulse_or_burst = (pack->type == PACKET_TYPE_BURST);
 
@@ -2767,8 +2748,8 @@ draw_link_shape(x, y,
 
      int total_length = 16 + pack->status * 12; // see also cloud code (in g_packet.c)
      int origin_cutoff;
-     if (pack->created_timestamp + total_length > w.world_time)
-						origin_cutoff = pack->created_timestamp + total_length - w.world_time;
+     if (pack->created_timestamp + total_length > dw->world_time)
+						origin_cutoff = pack->created_timestamp + total_length - dw->world_time;
 					  else origin_cutoff = 0;
 
 					float blob_size;
@@ -2857,12 +2838,12 @@ draw_link_shape(x, y,
  {
 
 // TO DO: optimise this to use blocks instead of searching the entire cloud array?
-  if (w.fragment[fr_index].destruction_timestamp < w.world_time)
+  if (dw->fragment[fr_index].destruction_timestamp < dw->world_time)
    continue;
 
 
-  x = al_fixtof(w.fragment[fr_index].position.x - view.camera_x) * view.zoom;
-  y = al_fixtof(w.fragment[fr_index].position.y - view.camera_y) * view.zoom;
+  x = al_fixtof(dw->fragment[fr_index].position.x - view.camera_x) * view.zoom;
+  y = al_fixtof(dw->fragment[fr_index].position.y - view.camera_y) * view.zoom;
   x += view.window_x_unzoomed / 2;
   y += view.window_y_unzoomed / 2;
 
@@ -2873,17 +2854,17 @@ draw_link_shape(x, y,
 
 
 
-     int fr_time = w.world_time - w.fragment[fr_index].created_timestamp;
-   	 int fr_time_left = w.fragment[fr_index].destruction_timestamp - w.world_time;
+     int fr_time = dw->world_time - dw->fragment[fr_index].created_timestamp;
+   	 int fr_time_left = dw->fragment[fr_index].destruction_timestamp - dw->world_time;
 
 //   	 int explode_time_left;
 
      if (fr_time_left > 31)
 					{
-      float fragment_x = x;// + (al_fixtof(w.fragment[fr_index].speed.x) * (cl_time - (cl_time * cl_time * 0.003)) * view.zoom);
-      float fragment_y = y;// + (al_fixtof(w.fragment[fr_index].speed.y) * (cl_time - (cl_time * cl_time * 0.003)) * view.zoom);
-      float fragment_angle = (fr_index * 0.23) + w.fragment[fr_index].spin * fr_time;//fixed_to_radians(w.fragment[fr_index].spin * fr_time);
-      float fragment_size = w.fragment[fr_index].fragment_size;
+      float fragment_x = x;// + (al_fixtof(dw->fragment[fr_index].speed.x) * (cl_time - (cl_time * cl_time * 0.003)) * view.zoom);
+      float fragment_y = y;// + (al_fixtof(dw->fragment[fr_index].speed.y) * (cl_time - (cl_time * cl_time * 0.003)) * view.zoom);
+      float fragment_angle = (fr_index * 0.23) + dw->fragment[fr_index].spin * fr_time;//fixed_to_radians(dw->fragment[fr_index].spin * fr_time);
+      float fragment_size = dw->fragment[fr_index].fragment_size;
 //      explode_time_left = 31;
    		 add_outline_diamond_layer(3,
 																															  fragment_x + cos(fragment_angle) * fragment_size * view.zoom,
@@ -2894,8 +2875,8 @@ draw_link_shape(x, y,
 																															  fragment_y + sin(fragment_angle + PI) * fragment_size * view.zoom,
 																															  fragment_x + cos(fragment_angle - PI / 2) * fragment_size * 0.6 * view.zoom,
 																															  fragment_y + sin(fragment_angle - PI / 2) * fragment_size * 0.6 * view.zoom,
-																															  colours.proc_col [w.fragment[fr_index].colour] [0] [0] [3],
-																															  colours.proc_outline [w.fragment[fr_index].colour]  [0] [3]);
+																															  colours.proc_col [dw->fragment[fr_index].colour] [0] [0] [3],
+																															  colours.proc_outline [dw->fragment[fr_index].colour]  [0] [3]);
 
 					}
 					 else
@@ -2908,10 +2889,10 @@ draw_link_shape(x, y,
 				   if (shade < 0)
 							 shade = 0;
 
-							float expl_size = fr_time_left + (w.fragment[fr_index].fragment_size) - 8;
+							float expl_size = fr_time_left + (dw->fragment[fr_index].fragment_size) - 8;
 
 							if (expl_size > 0)
-     	  double_circle_with_bloom(3, x, y, expl_size, w.fragment[fr_index].colour, shade);
+     	  double_circle_with_bloom(3, x, y, expl_size, dw->fragment[fr_index].colour, shade);
      	   else
 										continue;
 /*
@@ -2925,13 +2906,13 @@ draw_link_shape(x, y,
 															(16 + explode_time * 3 - (explode_time * explode_time * 0.03) + 16),// * size_modifier,
 															fr_time_left / 4 + 4,
 															36,
-															colours.packet [w.fragment[fr_index].colour] [shade]);
+															colours.packet [dw->fragment[fr_index].colour] [shade]);
 */
 
 						}
 /*
-     float x_step = al_fixtof(w.fragment[fr_index].speed.x) * 3.0 * view.zoom;
-     float y_step = al_fixtof(w.fragment[fr_index].speed.y) * 3.0 * view.zoom;
+     float x_step = al_fixtof(dw->fragment[fr_index].speed.x) * 3.0 * view.zoom;
+     float y_step = al_fixtof(dw->fragment[fr_index].speed.y) * 3.0 * view.zoom;
 
      int trail_shade = explode_time_left;// - explode_time / 6;
 
@@ -2948,13 +2929,13 @@ draw_link_shape(x, y,
 																		y + y_step,
 																		x + y_step,
 																		y - x_step,
-																		colours.packet [w.fragment[fr_index].colour] [trail_shade / 2]);
+																		colours.packet [dw->fragment[fr_index].colour] [trail_shade / 2]);
 					add_ribbon_vertex(x - y_step,
 																		     y + x_step,
-																		colours.packet [w.fragment[fr_index].colour] [trail_shade / 2]);
+																		colours.packet [dw->fragment[fr_index].colour] [trail_shade / 2]);
 					add_ribbon_vertex(x - x_step * end_mult,
 																		     y - y_step * end_mult,
-																		     colours.packet [w.fragment[fr_index].colour] [0]);
+																		     colours.packet [dw->fragment[fr_index].colour] [0]);
 
 x_step *= 0.5;
 y_step *= 0.5;
@@ -2964,32 +2945,32 @@ y_step *= 0.5;
 																		y + y_step,
 																		x + y_step,
 																		y - x_step,
-																		colours.packet [w.fragment[fr_index].colour] [trail_shade]);
+																		colours.packet [dw->fragment[fr_index].colour] [trail_shade]);
 					add_ribbon_vertex(x - y_step,
 																		     y + x_step,
-																		colours.packet [w.fragment[fr_index].colour] [trail_shade]);
+																		colours.packet [dw->fragment[fr_index].colour] [trail_shade]);
 					add_ribbon_vertex(x - x_step * end_mult,
 																		     y - y_step * end_mult,
-																		     colours.packet [w.fragment[fr_index].colour] [0]);
+																		     colours.packet [dw->fragment[fr_index].colour] [0]);
 */
 /*
-     float fragment_move_angle = atan2(al_fixtof(w.fragment[fr_index].speed.y), al_fixtof(0 - w.fragment[fr_index].speed.y));
+     float fragment_move_angle = atan2(al_fixtof(dw->fragment[fr_index].speed.y), al_fixtof(0 - dw->fragment[fr_index].speed.y));
 
    		start_ribbon(2,
 																		x + cos(fragment_move_angle) * 3.0 * view.zoom,
 																		y + sin(fragment_move_angle) * 3.0 * view.zoom,
 																		x + cos(fragment_move_angle + PI*0.5) * 3.0 * view.zoom,
 																		y + sin(fragment_move_angle + PI*0.5) * 3.0 * view.zoom,
-																		colours.packet [w.fragment[fr_index].colour] [22]);
+																		colours.packet [dw->fragment[fr_index].colour] [22]);
 					add_ribbon_vertex(x + cos(fragment_move_angle - PI*0.5) * 3.0 * view.zoom,
 																		     y + sin(fragment_move_angle - PI*0.5) * 3.0 * view.zoom,
-																		colours.packet [w.fragment[fr_index].colour] [22]);
-					add_ribbon_vertex(x + cos(fragment_move_angle + PI) * al_fixtof(w.fragment[fr_index].speed.x) * 7.0 * view.zoom,
-																		     y + sin(fragment_move_angle + PI) * al_fixtof(w.fragment[fr_index].speed.x) * 7.0 * view.zoom,
+																		colours.packet [dw->fragment[fr_index].colour] [22]);
+					add_ribbon_vertex(x + cos(fragment_move_angle + PI) * al_fixtof(dw->fragment[fr_index].speed.x) * 7.0 * view.zoom,
+																		     y + sin(fragment_move_angle + PI) * al_fixtof(dw->fragment[fr_index].speed.x) * 7.0 * view.zoom,
 																		     colours.none);
 */
 
-if (w.world_time > w.fragment[fr_index].explosion_timestamp)
+if (dw->world_time > dw->fragment[fr_index].explosion_timestamp)
 	continue;
 
      int end_time = fr_time;// / 4;
@@ -2997,25 +2978,25 @@ if (w.world_time > w.fragment[fr_index].explosion_timestamp)
      if (end_time > max_time)
 						end_time = max_time;
 
-     float x_step = al_fixtof(0 - w.fragment[fr_index].speed.x) * 1 * view.zoom;
-     float y_step = al_fixtof(0 - w.fragment[fr_index].speed.y) * 1 * view.zoom;
+     float x_step = al_fixtof(0 - dw->fragment[fr_index].speed.x) * 1 * view.zoom;
+     float y_step = al_fixtof(0 - dw->fragment[fr_index].speed.y) * 1 * view.zoom;
 
      float fragment_move_angle = atan2(y_step, x_step) + PI;
 
 					int start_time;
 
-					if (w.world_time <= w.fragment[fr_index].explosion_timestamp)
+					if (dw->world_time <= dw->fragment[fr_index].explosion_timestamp)
 						start_time = 0;
 					  else
 							{
-						   start_time = (w.world_time - w.fragment[fr_index].explosion_timestamp);// + 1;
+						   start_time = (dw->world_time - dw->fragment[fr_index].explosion_timestamp);// + 1;
 					    if (start_time >= end_time)
 						    continue;
 							}
 
 //							start_time /= 4;
 
-         int time_until_explode = w.fragment[fr_index].explosion_timestamp - w.world_time;
+         int time_until_explode = dw->fragment[fr_index].explosion_timestamp - dw->world_time;
 
 
          float size_prop = time_until_explode * 0.03;
@@ -3033,7 +3014,7 @@ if (w.world_time > w.fragment[fr_index].explosion_timestamp)
 																												end_time,
 																												max_time,
 																												0.9 * size_prop,
-																												w.fragment[fr_index].colour,
+																												dw->fragment[fr_index].colour,
 																												16,
 																												fr_index - fr_time, // drand_seed
 																												0,
@@ -3048,7 +3029,7 @@ if (w.world_time > w.fragment[fr_index].explosion_timestamp)
 																												end_time,
 																												max_time,
 																												0.5 * size_prop,
-																												w.fragment[fr_index].colour,
+																												dw->fragment[fr_index].colour,
 																												22,
 																												fr_index - fr_time, // drand_seed
 																												0,
@@ -3109,14 +3090,14 @@ if (w.world_time > w.fragment[fr_index].explosion_timestamp)
  int c;
 
 
- for (c = 0; c < w.max_clouds; c ++)
+ for (c = 0; c < dw->max_clouds; c ++)
  {
 
 // TO DO: optimise this to use blocks instead of searching the entire cloud array?
-  if (w.cloud[c].destruction_timestamp < w.world_time)
+  if (dw->cloud[c].destruction_timestamp < dw->world_time)
    continue;
 
-  cl = &w.cloud [c];
+  cl = &dw->cloud [c];
 
   x = al_fixtof(cl->position.x - view.camera_x) * view.zoom;
   y = al_fixtof(cl->position.y - view.camera_y) * view.zoom;
@@ -3129,7 +3110,7 @@ if (w.world_time > w.fragment[fr_index].explosion_timestamp)
     continue;
 
 
-  cl_time = w.world_time - cl->created_timestamp;
+  cl_time = dw->world_time - cl->created_timestamp;
 
   switch(cl->type)
   {
@@ -3138,12 +3119,12 @@ if (w.world_time > w.fragment[fr_index].explosion_timestamp)
 	 	case CLOUD_BURST_MISS:
 	 		{
 
-     int cloud_time = w.world_time - cl->data[1]; // data[1] was packet.created_timestamp
+     int cloud_time = dw->world_time - cl->data[1]; // data[1] was packet.created_timestamp
 
-//     cl_time = w.world_time - cl->created_timestamp;
+//     cl_time = dw->world_time - cl->created_timestamp;
      cl_angle = fixed_to_radians(cl->angle);
 
-//  			float sharpness = 4 + (w.world_time - pack->created_timestamp) * 0.1;
+//  			float sharpness = 4 + (dw->world_time - pack->created_timestamp) * 0.1;
 //  			if (sharpness > 10)
 //						sharpness = 10;
 //     seed_drand(cl->data[0] - ((cl->data[1]+cl_time)/3)); // data [0] holds packet index
@@ -3180,7 +3161,7 @@ if (w.world_time > w.fragment[fr_index].explosion_timestamp)
      float x_step = al_fixtof(0 - cl->speed.x) * view.zoom;
      float y_step = al_fixtof(0 - cl->speed.y) * view.zoom;
 /*
-//     int end_time = (w.world_time - cl->data[1]) / 3;
+//     int end_time = (dw->world_time - cl->data[1]) / 3;
      int end_time = (cl->data[1] + cl_time) / 3;
      if (end_time > 16)
 						end_time = 16;
@@ -3194,7 +3175,7 @@ if (w.world_time > w.fragment[fr_index].explosion_timestamp)
      int end_time = cloud_time / 3;
      if (end_time > 16)
 						end_time = 16;
-					int start_time = (w.world_time - cl->created_timestamp) / 3;
+					int start_time = (dw->world_time - cl->created_timestamp) / 3;
 
 					x += x_step * 3;
 					y += y_step * 3;
@@ -3300,12 +3281,12 @@ if (w.world_time > w.fragment[fr_index].explosion_timestamp)
 			case CLOUD_SPIKE_HIT_AT_LONG_RANGE:
 				{
 
-//     int cloud_time = w.world_time - cl->data[1]; // data[1] was packet.created_timestamp
+//     int cloud_time = dw->world_time - cl->data[1]; // data[1] was packet.created_timestamp
 
-//     cl_time = w.world_time - cl->created_timestamp;
+//     cl_time = dw->world_time - cl->created_timestamp;
      cl_angle = fixed_to_radians(cl->angle);
 
-//  			float sharpness = 4 + (w.world_time - pack->created_timestamp) * 0.1;
+//  			float sharpness = 4 + (dw->world_time - pack->created_timestamp) * 0.1;
 //  			if (sharpness > 10)
 //						sharpness = 10;
 //     seed_drand(cl->data[0] - ((cl->data[1]+cl_time)/3)); // data [0] holds packet index
@@ -3502,7 +3483,7 @@ if (w.world_time > w.fragment[fr_index].explosion_timestamp)
      int max_time = 29;
      if (end_time > max_time)
 						end_time = max_time;
-					int start_time = (w.world_time - cl->created_timestamp);
+					int start_time = (dw->world_time - cl->created_timestamp);
 
 					if (start_time >= end_time)
 						break;
@@ -3616,12 +3597,12 @@ break;
      float x_step = al_fixtof(0 - cl->speed.x) * view.zoom;
      float y_step = al_fixtof(0 - cl->speed.y) * view.zoom;
 
-     int cloud_time = w.world_time - cl->created_timestamp; // data[4] was w.world_time - packet.created_timestamp
+     int cloud_time = dw->world_time - cl->created_timestamp; // data[4] was dw->world_time - packet.created_timestamp
 
      int total_max_time = 16 + cl->data [0] * 12;
 
 
-     int max_time = total_max_time;//(w.world_time - cl->created_timestamp);//total_max_time;//38 + cl->data [0] * 4;
+     int max_time = total_max_time;//(dw->world_time - cl->created_timestamp);//total_max_time;//38 + cl->data [0] * 4;
      int end_time = total_max_time - cloud_time;// * 2;//cloud_time;
      if (end_time > max_time)
 						end_time = max_time;
@@ -3629,7 +3610,7 @@ break;
 						end_time = cl->data [4];
 //					if (end_time < 3)
 //							break;
-//					int start_time = (w.world_time - cl->created_timestamp);// * 2;
+//					int start_time = (dw->world_time - cl->created_timestamp);// * 2;
 
 //					if (start_time >= end_time)
 //						break;
@@ -3714,7 +3695,7 @@ break;
      int max_time = 6 + cl->data [0] * 4;
      if (end_time > max_time)
 						end_time = max_time;
-					int start_time = (w.world_time - cl->created_timestamp);
+					int start_time = (dw->world_time - cl->created_timestamp);
 
 					if (start_time >= end_time)
 						break;
@@ -4242,48 +4223,48 @@ break;
 					int trail_cloud_index = cl->index;
 					float trail_angle = fixed_to_radians(cl->angle);
 					int next_cloud_index;
-					int trail_shade = (cl->created_timestamp + cl->lifetime - w.world_time) * 2;
+					int trail_shade = (cl->created_timestamp + cl->lifetime - dw->world_time) * 2;
 //					if (trail_shade < 0)
 //						trail_shade = 0;
 #define SURGE_FRONT_SIZE 3
 //#define SURGE_TRAIL_SIZE 3
 					start_ribbon(4,
-																		(al_fixtof(w.cloud[trail_cloud_index].position.x - view.camera_x) + cos(trail_angle) * SURGE_FRONT_SIZE) * view.zoom + (view.window_x_unzoomed/2),
-																		(al_fixtof(w.cloud[trail_cloud_index].position.y - view.camera_y) + sin(trail_angle) * SURGE_FRONT_SIZE) * view.zoom + (view.window_y_unzoomed/2),
-																		(al_fixtof(w.cloud[trail_cloud_index].position.x - view.camera_x) + cos(trail_angle + PI/2) * SURGE_FRONT_SIZE) * view.zoom + (view.window_x_unzoomed/2),
-																		(al_fixtof(w.cloud[trail_cloud_index].position.y - view.camera_y) + sin(trail_angle + PI/2) * SURGE_FRONT_SIZE) * view.zoom + (view.window_y_unzoomed/2),
+																		(al_fixtof(dw->cloud[trail_cloud_index].position.x - view.camera_x) + cos(trail_angle) * SURGE_FRONT_SIZE) * view.zoom + (view.window_x_unzoomed/2),
+																		(al_fixtof(dw->cloud[trail_cloud_index].position.y - view.camera_y) + sin(trail_angle) * SURGE_FRONT_SIZE) * view.zoom + (view.window_y_unzoomed/2),
+																		(al_fixtof(dw->cloud[trail_cloud_index].position.x - view.camera_x) + cos(trail_angle + PI/2) * SURGE_FRONT_SIZE) * view.zoom + (view.window_x_unzoomed/2),
+																		(al_fixtof(dw->cloud[trail_cloud_index].position.y - view.camera_y) + sin(trail_angle + PI/2) * SURGE_FRONT_SIZE) * view.zoom + (view.window_y_unzoomed/2),
 																		colours.packet [cl->colour] [trail_shade]);
 
-						add_ribbon_vertex((al_fixtof(w.cloud[trail_cloud_index].position.x - view.camera_x) + cos(trail_angle - PI/2) * SURGE_FRONT_SIZE) * view.zoom + (view.window_x_unzoomed/2),
-																		      (al_fixtof(w.cloud[trail_cloud_index].position.y - view.camera_y) + sin(trail_angle - PI/2) * SURGE_FRONT_SIZE) * view.zoom + (view.window_y_unzoomed/2),
+						add_ribbon_vertex((al_fixtof(dw->cloud[trail_cloud_index].position.x - view.camera_x) + cos(trail_angle - PI/2) * SURGE_FRONT_SIZE) * view.zoom + (view.window_x_unzoomed/2),
+																		      (al_fixtof(dw->cloud[trail_cloud_index].position.y - view.camera_y) + sin(trail_angle - PI/2) * SURGE_FRONT_SIZE) * view.zoom + (view.window_y_unzoomed/2),
 																		      colours.packet [cl->colour] [trail_shade]);
 
-				 	trail_cloud_index = w.cloud[trail_cloud_index].data[0];
+				 	trail_cloud_index = dw->cloud[trail_cloud_index].data[0];
 
 				 	if (trail_cloud_index == -1)
 							break;
 
    	 while(TRUE)
 				 {
-				 	next_cloud_index = w.cloud[trail_cloud_index].data[0];
+				 	next_cloud_index = dw->cloud[trail_cloud_index].data[0];
 				 	if (next_cloud_index == -1)
 							break;
 						trail_shade -= 2;
 						if (trail_shade < 0)
 							trail_shade = 0;
-						seed_drand(w.cloud[next_cloud_index].position.x + w.cloud[next_cloud_index].position.y);
+						seed_drand(dw->cloud[next_cloud_index].position.x + dw->cloud[next_cloud_index].position.y);
 						float trail_size = (200 + (drand(50, 1)) * trail_shade) * 0.008;
-						add_ribbon_vertex((al_fixtof(w.cloud[trail_cloud_index].position.x - view.camera_x) + cos(trail_angle + PI/2) * trail_size) * view.zoom + (view.window_x_unzoomed/2),
-																		      (al_fixtof(w.cloud[trail_cloud_index].position.y - view.camera_y) + sin(trail_angle + PI/2) * trail_size) * view.zoom + (view.window_y_unzoomed/2),
+						add_ribbon_vertex((al_fixtof(dw->cloud[trail_cloud_index].position.x - view.camera_x) + cos(trail_angle + PI/2) * trail_size) * view.zoom + (view.window_x_unzoomed/2),
+																		      (al_fixtof(dw->cloud[trail_cloud_index].position.y - view.camera_y) + sin(trail_angle + PI/2) * trail_size) * view.zoom + (view.window_y_unzoomed/2),
 																		      colours.packet [cl->colour] [trail_shade]);
 						trail_size = (200 + (drand(50, 1)) * trail_shade) * 0.008;
 //      trail_size += 12;
-						add_ribbon_vertex((al_fixtof(w.cloud[trail_cloud_index].position.x - view.camera_x) - cos(trail_angle + PI/2) * trail_size) * view.zoom + (view.window_x_unzoomed/2),
-																		      (al_fixtof(w.cloud[trail_cloud_index].position.y - view.camera_y) - sin(trail_angle + PI/2) * trail_size) * view.zoom + (view.window_y_unzoomed/2),
+						add_ribbon_vertex((al_fixtof(dw->cloud[trail_cloud_index].position.x - view.camera_x) - cos(trail_angle + PI/2) * trail_size) * view.zoom + (view.window_x_unzoomed/2),
+																		      (al_fixtof(dw->cloud[trail_cloud_index].position.y - view.camera_y) - sin(trail_angle + PI/2) * trail_size) * view.zoom + (view.window_y_unzoomed/2),
 																		      colours.packet [cl->colour] [trail_shade]);
 
 						trail_cloud_index = next_cloud_index;
-						if (w.cloud[trail_cloud_index].destruction_timestamp <= w.world_time)
+						if (dw->cloud[trail_cloud_index].destruction_timestamp <= dw->world_time)
 							break;
 				 }
    	}
@@ -4302,10 +4283,10 @@ break;
 					int trail_cloud_index = cl->index;
 					float trail_angle = fixed_to_radians(cl->angle);
 					int next_cloud_index;
-					int trail_shade = (cl->created_timestamp + cl->lifetime - w.world_time) * 2;
+					int trail_shade = (cl->created_timestamp + cl->lifetime - dw->world_time) * 2;
 					int adjusted_trail_shade;
 
-					if (!w.cloud[trail_cloud_index].data [2])
+					if (!dw->cloud[trail_cloud_index].data [2])
 					{
 						if (trail_shade > 12)
 							adjusted_trail_shade = 12;
@@ -4321,17 +4302,17 @@ break;
 #define SPIKE_FRONT_SIZE 3
 #define SPIKE_TRAIL_SIZE 2
 					start_ribbon(4,
-																		(al_fixtof(w.cloud[trail_cloud_index].position.x - view.camera_x) + cos(trail_angle) * SPIKE_FRONT_SIZE) * view.zoom + (view.window_x_unzoomed/2),
-																		(al_fixtof(w.cloud[trail_cloud_index].position.y - view.camera_y) + sin(trail_angle) * SPIKE_FRONT_SIZE) * view.zoom + (view.window_y_unzoomed/2),
-																		(al_fixtof(w.cloud[trail_cloud_index].position.x - view.camera_x) + cos(trail_angle + PI/2) * SPIKE_FRONT_SIZE) * view.zoom + (view.window_x_unzoomed/2),
-																		(al_fixtof(w.cloud[trail_cloud_index].position.y - view.camera_y) + sin(trail_angle + PI/2) * SPIKE_FRONT_SIZE) * view.zoom + (view.window_y_unzoomed/2),
+																		(al_fixtof(dw->cloud[trail_cloud_index].position.x - view.camera_x) + cos(trail_angle) * SPIKE_FRONT_SIZE) * view.zoom + (view.window_x_unzoomed/2),
+																		(al_fixtof(dw->cloud[trail_cloud_index].position.y - view.camera_y) + sin(trail_angle) * SPIKE_FRONT_SIZE) * view.zoom + (view.window_y_unzoomed/2),
+																		(al_fixtof(dw->cloud[trail_cloud_index].position.x - view.camera_x) + cos(trail_angle + PI/2) * SPIKE_FRONT_SIZE) * view.zoom + (view.window_x_unzoomed/2),
+																		(al_fixtof(dw->cloud[trail_cloud_index].position.y - view.camera_y) + sin(trail_angle + PI/2) * SPIKE_FRONT_SIZE) * view.zoom + (view.window_y_unzoomed/2),
 																		colours.packet [cl->colour] [adjusted_trail_shade]);
 
-						add_ribbon_vertex((al_fixtof(w.cloud[trail_cloud_index].position.x - view.camera_x) + cos(trail_angle - PI/2) * SPIKE_FRONT_SIZE) * view.zoom + (view.window_x_unzoomed/2),
-																		      (al_fixtof(w.cloud[trail_cloud_index].position.y - view.camera_y) + sin(trail_angle - PI/2) * SPIKE_FRONT_SIZE) * view.zoom + (view.window_y_unzoomed/2),
+						add_ribbon_vertex((al_fixtof(dw->cloud[trail_cloud_index].position.x - view.camera_x) + cos(trail_angle - PI/2) * SPIKE_FRONT_SIZE) * view.zoom + (view.window_x_unzoomed/2),
+																		      (al_fixtof(dw->cloud[trail_cloud_index].position.y - view.camera_y) + sin(trail_angle - PI/2) * SPIKE_FRONT_SIZE) * view.zoom + (view.window_y_unzoomed/2),
 																		      colours.packet [cl->colour] [adjusted_trail_shade]);
 
-				 	trail_cloud_index = w.cloud[trail_cloud_index].data[0];
+				 	trail_cloud_index = dw->cloud[trail_cloud_index].data[0];
 
 				 	if (trail_cloud_index == -1)
 							break;
@@ -4339,14 +4320,14 @@ break;
 
    	 while(TRUE)
 				 {
-				 	next_cloud_index = w.cloud[trail_cloud_index].data[0];
+				 	next_cloud_index = dw->cloud[trail_cloud_index].data[0];
 				 	if (next_cloud_index == -1)
 							break;
 						trail_shade -= 2;
 						if (trail_shade < 0)
 							trail_shade = 0;
 
-					 if (!w.cloud[trail_cloud_index].data [2])
+					 if (!dw->cloud[trail_cloud_index].data [2])
 					 {
  						if (trail_shade > 12)
 							 adjusted_trail_shade = 12;
@@ -4357,8 +4338,8 @@ break;
 							 adjusted_trail_shade = trail_shade;
 
 
-						float pos_x = al_fixtof(w.cloud[trail_cloud_index].position.x - view.camera_x) + view.window_x_zoomed / 2;
-						float pos_y = al_fixtof(w.cloud[trail_cloud_index].position.y - view.camera_y) + view.window_y_zoomed / 2;
+						float pos_x = al_fixtof(dw->cloud[trail_cloud_index].position.x - view.camera_x) + view.window_x_zoomed / 2;
+						float pos_y = al_fixtof(dw->cloud[trail_cloud_index].position.y - view.camera_y) + view.window_y_zoomed / 2;
 						float angle_cos = cos(trail_angle + PI/2);
 						float angle_sin = sin(trail_angle + PI/2);
 						add_ribbon_vertex((pos_x + angle_cos * SPIKE_TRAIL_SIZE) * view.zoom,
@@ -4368,9 +4349,9 @@ break;
 																		      (pos_y - angle_sin * SPIKE_TRAIL_SIZE) * view.zoom,
 																		      colours.packet [cl->colour] [adjusted_trail_shade]);
 /*
-						if (w.cloud[trail_cloud_index].data [2])
+						if (dw->cloud[trail_cloud_index].data [2])
 						{
-						 float side_size = (trail_shade + (w.cloud[trail_cloud_index].position.x & 7)) * 0.4;
+						 float side_size = (trail_shade + (dw->cloud[trail_cloud_index].position.x & 7)) * 0.4;
 						 add_diamond_layer(3,
 																								 (pos_x + cos(trail_angle) * 3) * view.zoom,
 																								 (pos_y + sin(trail_angle) * 3) * view.zoom,
@@ -4384,7 +4365,7 @@ break;
 						}
 */
 						trail_cloud_index = next_cloud_index;
-						if (w.cloud[trail_cloud_index].destruction_timestamp <= w.world_time)
+						if (dw->cloud[trail_cloud_index].destruction_timestamp <= dw->world_time)
 							break;
 				 }
    	}
@@ -4451,9 +4432,9 @@ break;
 	    	if (hit_shade > 1)
 							hit_shade = 1;
 
-				ALLEGRO_COLOR interface_colour = map_rgba(w.player[cl->colour].interface_colour_base [0] + (w.player[cl->colour].interface_colour_hit [0] * hit_shade) + (w.player[cl->colour].interface_colour_charge [0] * hit_shade),
-																																														w.player[cl->colour].interface_colour_base [1] + (w.player[cl->colour].interface_colour_hit [1] * hit_shade) + (w.player[cl->colour].interface_colour_charge [1] * hit_shade),
-																																														w.player[cl->colour].interface_colour_base [2] + (w.player[cl->colour].interface_colour_hit [2] * hit_shade) + (w.player[cl->colour].interface_colour_charge [2] * hit_shade),
+				ALLEGRO_COLOR interface_colour = map_rgba(dw->player[cl->colour].interface_colour_base [0] + (dw->player[cl->colour].interface_colour_hit [0] * hit_shade) + (dw->player[cl->colour].interface_colour_charge [0] * hit_shade),
+																																														dw->player[cl->colour].interface_colour_base [1] + (dw->player[cl->colour].interface_colour_hit [1] * hit_shade) + (dw->player[cl->colour].interface_colour_charge [1] * hit_shade),
+																																														dw->player[cl->colour].interface_colour_base [2] + (dw->player[cl->colour].interface_colour_hit [2] * hit_shade) + (dw->player[cl->colour].interface_colour_charge [2] * hit_shade),
 																																														hit_shade * 250);
 
 	    	add_diamond_layer(2,
@@ -4494,9 +4475,9 @@ break;
 
 	    	float hit_shade = time_left * 0.0312;
 
-				ALLEGRO_COLOR interface_colour = al_map_rgba(w.player[cl->colour].interface_colour_base [0] + (w.player[cl->colour].interface_colour_var [0] * hit_shade),
-																																																	w.player[cl->colour].interface_colour_base [1] + (w.player[cl->colour].interface_colour_var [1] * hit_shade),
-																																																	w.player[cl->colour].interface_colour_base [2] + (w.player[cl->colour].interface_colour_var [2] * hit_shade),
+				ALLEGRO_COLOR interface_colour = al_map_rgba(dw->player[cl->colour].interface_colour_base [0] + (dw->player[cl->colour].interface_colour_var [0] * hit_shade),
+																																																	dw->player[cl->colour].interface_colour_base [1] + (dw->player[cl->colour].interface_colour_var [1] * hit_shade),
+																																																	dw->player[cl->colour].interface_colour_base [2] + (dw->player[cl->colour].interface_colour_var [2] * hit_shade),
 																																																	hit_shade * 160);
 
 	    	add_triangle(2,
@@ -4548,15 +4529,15 @@ break;
     break;
 
    case CLOUD_BUBBLE_TEXT:
-//			 if (w.core[pr->core_index].bubble_text_time >= w.world_time - BUBBLE_TOTAL_TIME)
+//			 if (dw->core[pr->core_index].bubble_text_time >= dw->world_time - BUBBLE_TOTAL_TIME)
 			 {
 // This cloud probably exists because the core has been destroyed.
 // However, it should be safe to refer to the core's data structure because
 //  it will still be deallocating:
-  		 	w.core[cl->data [0]].bubble_list = bubble_list_index;
+  		 	dw->core[cl->data [0]].bubble_list = bubble_list_index;
 				 	bubble_list_index = cl->data [0];
-		 	 	w.core[cl->data [0]].bubble_x = x;
-				  w.core[cl->data [0]].bubble_y = y - 120 * view.zoom;//scaleUI_y(FONT_SQUARE,120) * view.zoom;
+		 	 	dw->core[cl->data [0]].bubble_x = x;
+				  dw->core[cl->data [0]].bubble_y = y - 120 * view.zoom;//scaleUI_y(FONT_SQUARE,120) * view.zoom;
 			 }
 			 break;
 
@@ -4565,8 +4546,8 @@ break;
     case CLOUD_HARVEST_LINE:
     {
 // first check the proc that produced the line still exists:
-    if (w.proc[cl->data[0]].exists <= 0
-					|| w.proc[cl->data[0]].created_timestamp != cl->associated_proc_timestamp)
+    if (dw->proc[cl->data[0]].exists <= 0
+					|| dw->proc[cl->data[0]].created_timestamp != cl->associated_proc_timestamp)
 						break;
 // assume:
 //  data[0] is associated proc index
@@ -4576,13 +4557,13 @@ break;
 				float well_y = al_fixtof(cl->position.y - view.camera_y) * view.zoom;
     well_x += view.window_x_unzoomed / 2;
     well_y += view.window_y_unzoomed / 2;
-    al_fixed vertex_x_fixed = w.proc[cl->data[0]].position.x + fixed_xpart(w.proc[cl->data[0]].angle + w.proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], w.proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
-    al_fixed vertex_y_fixed = w.proc[cl->data[0]].position.y + fixed_ypart(w.proc[cl->data[0]].angle + w.proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], w.proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
+    al_fixed vertex_x_fixed = dw->proc[cl->data[0]].position.x + fixed_xpart(dw->proc[cl->data[0]].angle + dw->proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], dw->proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
+    al_fixed vertex_y_fixed = dw->proc[cl->data[0]].position.y + fixed_ypart(dw->proc[cl->data[0]].angle + dw->proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], dw->proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
     float vx, vy;
-    vx = al_fixtof(w.proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
-    vx += (cos(fixed_to_radians(w.proc[cl->data[0]].angle) + dshape[w.proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[w.proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
-    vy = al_fixtof(w.proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
-    vy += (sin(fixed_to_radians(w.proc[cl->data[0]].angle) + dshape[w.proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[w.proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
+    vx = al_fixtof(dw->proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
+    vx += (cos(fixed_to_radians(dw->proc[cl->data[0]].angle) + dshape[dw->proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[dw->proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
+    vy = al_fixtof(dw->proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
+    vy += (sin(fixed_to_radians(dw->proc[cl->data[0]].angle) + dshape[dw->proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[dw->proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
 
     float angle_from_well = atan2(vy - well_y, vx - well_x);
     float harvest_line_length_unzoomed = hypot(al_fixtoi(cl->position.y - vertex_y_fixed), al_fixtoi(cl->position.x - vertex_x_fixed));
@@ -4595,7 +4576,7 @@ break;
 
 #define HARVEST_LINE_TIME 16
 
-    int line_time = w.world_time - cl->created_timestamp;
+    int line_time = dw->world_time - cl->created_timestamp;
 
     float oscil_angle = PI + (cl->created_timestamp + line_time) * 0.01;
     float oscil_angle_inc = (5 + drand(5, 1)) * -0.03;
@@ -4687,8 +4668,8 @@ break;
     case CLOUD_TAKE_LINE:
     {
 // first check the proc that produced the line still exists:
-    if (w.proc[cl->data[0]].exists <= 0
-					|| w.proc[cl->data[0]].created_timestamp != cl->associated_proc_timestamp)
+    if (dw->proc[cl->data[0]].exists <= 0
+					|| dw->proc[cl->data[0]].created_timestamp != cl->associated_proc_timestamp)
 						break;
 // assume:
 //  data[0] is associated proc index
@@ -4706,12 +4687,12 @@ break;
     if (cl->type == CLOUD_HARVEST_LINE)
     {
 // target of harvest line is harvest object.
-     vertex_x_fixed = w.proc[cl->data[0]].position.x + fixed_xpart(w.proc[cl->data[0]].angle + w.proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], w.proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
-     vertex_y_fixed = w.proc[cl->data[0]].position.y + fixed_ypart(w.proc[cl->data[0]].angle + w.proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], w.proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
-     vx = al_fixtof(w.proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
-     vx += (cos(fixed_to_radians(w.proc[cl->data[0]].angle) + dshape[w.proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[w.proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
-     vy = al_fixtof(w.proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
-     vy += (sin(fixed_to_radians(w.proc[cl->data[0]].angle) + dshape[w.proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[w.proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
+     vertex_x_fixed = dw->proc[cl->data[0]].position.x + fixed_xpart(dw->proc[cl->data[0]].angle + dw->proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], dw->proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
+     vertex_y_fixed = dw->proc[cl->data[0]].position.y + fixed_ypart(dw->proc[cl->data[0]].angle + dw->proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], dw->proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
+     vx = al_fixtof(dw->proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
+     vx += (cos(fixed_to_radians(dw->proc[cl->data[0]].angle) + dshape[dw->proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[dw->proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
+     vy = al_fixtof(dw->proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
+     vy += (sin(fixed_to_radians(dw->proc[cl->data[0]].angle) + dshape[dw->proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[dw->proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
 // source is well
 				 well_x = al_fixtof(cl->position.x - view.camera_x) * view.zoom; // if this is a data transfer to another proc, this could be the proc's location at transfer time
      well_x += view.window_x_unzoomed / 2;
@@ -4728,12 +4709,12 @@ break;
        vertex_x_fixed = cl->position.x;
        vertex_y_fixed = cl->position.y;
 // source is transferrer object
-//      well_x = al_fixtof(w.proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
-//      well_y = al_fixtof(w.proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
-       well_x = al_fixtof(w.proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
-       well_x += (cos(fixed_to_radians(w.proc[cl->data[0]].angle) + dshape[w.proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[w.proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
-       well_y = al_fixtof(w.proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
-       well_y += (sin(fixed_to_radians(w.proc[cl->data[0]].angle) + dshape[w.proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[w.proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
+//      well_x = al_fixtof(dw->proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
+//      well_y = al_fixtof(dw->proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
+       well_x = al_fixtof(dw->proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
+       well_x += (cos(fixed_to_radians(dw->proc[cl->data[0]].angle) + dshape[dw->proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[dw->proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
+       well_y = al_fixtof(dw->proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
+       well_y += (sin(fixed_to_radians(dw->proc[cl->data[0]].angle) + dshape[dw->proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[dw->proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
 
 // target of give line is core of transfer target
 				   vx = al_fixtof(cl->position.x - view.camera_x) * view.zoom; // if this is a data transfer to another proc, this could be the proc's location at transfer time
@@ -4741,7 +4722,7 @@ break;
 				   vy = al_fixtof(cl->position.y - view.camera_y) * view.zoom;
        vy += view.window_y_unzoomed / 2;
 
-       harvest_line_length_unzoomed = hypot(al_fixtoi(cl->position.y - w.proc[cl->data[0]].position.y), al_fixtoi(cl->position.x - w.proc[cl->data[0]].position.x));
+       harvest_line_length_unzoomed = hypot(al_fixtoi(cl->position.y - dw->proc[cl->data[0]].position.y), al_fixtoi(cl->position.x - dw->proc[cl->data[0]].position.x));
 						}
 						 else // must be CLOUD_TAKE_LINE
 							{
@@ -4750,10 +4731,10 @@ break;
         vertex_y_fixed = cl->position.y;
 
 // target of give line is harvest object
-        vx = al_fixtof(w.proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
-        vx += (cos(fixed_to_radians(w.proc[cl->data[0]].angle) + dshape[w.proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[w.proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
-        vy = al_fixtof(w.proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
-        vy += (sin(fixed_to_radians(w.proc[cl->data[0]].angle) + dshape[w.proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[w.proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
+        vx = al_fixtof(dw->proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
+        vx += (cos(fixed_to_radians(dw->proc[cl->data[0]].angle) + dshape[dw->proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[dw->proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
+        vy = al_fixtof(dw->proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
+        vy += (sin(fixed_to_radians(dw->proc[cl->data[0]].angle) + dshape[dw->proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * (dshape[dw->proc[cl->data[0]].shape].link_point_dist [cl->data[1]] [1] + 7)) * view.zoom;
 
 // source is transferrer core
 				    well_x = al_fixtof(cl->position.x - view.camera_x) * view.zoom; // if this is a data transfer to another proc, this could be the proc's location at transfer time
@@ -4761,7 +4742,7 @@ break;
 				    well_y = al_fixtof(cl->position.y - view.camera_y) * view.zoom;
         well_y += view.window_y_unzoomed / 2;
 
-        harvest_line_length_unzoomed = hypot(al_fixtoi(cl->position.y - w.proc[cl->data[0]].position.y), al_fixtoi(cl->position.x - w.proc[cl->data[0]].position.x));
+        harvest_line_length_unzoomed = hypot(al_fixtoi(cl->position.y - dw->proc[cl->data[0]].position.y), al_fixtoi(cl->position.x - dw->proc[cl->data[0]].position.x));
 							}
 					}
 
@@ -4780,7 +4761,7 @@ break;
 
 #define HARVEST_LINE_TIME 32
 
-    int line_time = w.world_time - cl->created_timestamp;
+    int line_time = dw->world_time - cl->created_timestamp;
     int adjusted_line_time = (line_time * 2) - 32;
     if (adjusted_line_time < 0)
 					adjusted_line_time = 0;
@@ -4956,8 +4937,8 @@ break;
 //    case CLOUD_BUILD_LINE:
     {
 // first check the proc that produced the line still exists:
-    if (w.proc[cl->data[0]].exists <= 0
-					|| w.proc[cl->data[0]].created_timestamp != cl->associated_proc_timestamp)
+    if (dw->proc[cl->data[0]].exists <= 0
+					|| dw->proc[cl->data[0]].created_timestamp != cl->associated_proc_timestamp)
 						break;
 // assume:
 //  data[0] is associated proc index
@@ -4968,20 +4949,20 @@ break;
 
     built_core_x += view.window_x_unzoomed / 2;
     built_core_y += view.window_y_unzoomed / 2;
-//    al_fixed vertex_x_fixed = w.proc[cl->data[0]].position.x + fixed_xpart(w.proc[cl->data[0]].angle + w.proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], w.proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
-//    al_fixed vertex_y_fixed = w.proc[cl->data[0]].position.y + fixed_ypart(w.proc[cl->data[0]].angle + w.proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], w.proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
+//    al_fixed vertex_x_fixed = dw->proc[cl->data[0]].position.x + fixed_xpart(dw->proc[cl->data[0]].angle + dw->proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], dw->proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
+//    al_fixed vertex_y_fixed = dw->proc[cl->data[0]].position.y + fixed_ypart(dw->proc[cl->data[0]].angle + dw->proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], dw->proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
     float vx, vy;
-    vx = al_fixtof(w.proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
-    vx += (cos(fixed_to_radians(w.proc[cl->data[0]].angle) + dshape[w.proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * dshape[w.proc[cl->data[0]].shape].link_object_dist [cl->data[1]]) * view.zoom;
-    vy = al_fixtof(w.proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
-    vy += (sin(fixed_to_radians(w.proc[cl->data[0]].angle) + dshape[w.proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * dshape[w.proc[cl->data[0]].shape].link_object_dist [cl->data[1]]) * view.zoom;
+    vx = al_fixtof(dw->proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
+    vx += (cos(fixed_to_radians(dw->proc[cl->data[0]].angle) + dshape[dw->proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * dshape[dw->proc[cl->data[0]].shape].link_object_dist [cl->data[1]]) * view.zoom;
+    vy = al_fixtof(dw->proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
+    vy += (sin(fixed_to_radians(dw->proc[cl->data[0]].angle) + dshape[dw->proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * dshape[dw->proc[cl->data[0]].shape].link_object_dist [cl->data[1]]) * view.zoom;
 
 
 //    float total_line_length = hypot(built_core_y - vy, built_core_x - vx);
 //    float line_length_unzoomed = hypot(al_fixtoi(cl->position.y - vertex_y_fixed), al_fixtoi(cl->position.x - vertex_x_fixed));
 
 
-    int line_time = w.world_time - cl->created_timestamp;
+    int line_time = dw->world_time - cl->created_timestamp;
 
     float angle_to_target = atan2(built_core_y - vy, built_core_x - vx);
 
@@ -5012,7 +4993,7 @@ break;
 
 					add_ribbon_vertex(vx + cos(angle_to_target - PI/2) * line_thickness * 3 * view.zoom, vy + sin(angle_to_target - PI/2) * line_thickness * 3 * view.zoom, ribstate.fill_col);
 
-     float far_dist = hypot(al_fixtoi(cl->position.y - w.proc[cl->data[0]].position.y), al_fixtoi(cl->position.x - w.proc[cl->data[0]].position.x));
+     float far_dist = hypot(al_fixtoi(cl->position.y - dw->proc[cl->data[0]].position.y), al_fixtoi(cl->position.x - dw->proc[cl->data[0]].position.x));
 
 //     if (far_dist > 400)// - (shade * 4))
 //						far_dist = 400;// - (shade * 4);
@@ -5046,7 +5027,7 @@ far_dist = 12 + (shade);//*= 0.1;
 
     seed_drand(cl->created_timestamp + c);
 
-//    int line_time = w.world_time - cl->created_timestamp;
+//    int line_time = dw->world_time - cl->created_timestamp;
 
     float oscil_angle = PI + (cl->created_timestamp + line_time) * 0.01;
     float oscil_angle_inc = (5 + drand(5, 1)) * -0.03;
@@ -5134,8 +5115,8 @@ far_dist = 12 + (shade);//*= 0.1;
     case CLOUD_BUILD_LINE:
     {
 // first check the proc that produced the line still exists:
-    if (w.proc[cl->data[0]].exists <= 0
-					|| w.proc[cl->data[0]].created_timestamp != cl->associated_proc_timestamp)
+    if (dw->proc[cl->data[0]].exists <= 0
+					|| dw->proc[cl->data[0]].created_timestamp != cl->associated_proc_timestamp)
 						break;
 // assume:
 //  data[0] is associated proc index
@@ -5146,20 +5127,20 @@ far_dist = 12 + (shade);//*= 0.1;
 
     built_core_x += view.window_x_unzoomed / 2;
     built_core_y += view.window_y_unzoomed / 2;
-//    al_fixed vertex_x_fixed = w.proc[cl->data[0]].position.x + fixed_xpart(w.proc[cl->data[0]].angle + w.proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], w.proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
-//    al_fixed vertex_y_fixed = w.proc[cl->data[0]].position.y + fixed_ypart(w.proc[cl->data[0]].angle + w.proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], w.proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
+//    al_fixed vertex_x_fixed = dw->proc[cl->data[0]].position.x + fixed_xpart(dw->proc[cl->data[0]].angle + dw->proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], dw->proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
+//    al_fixed vertex_y_fixed = dw->proc[cl->data[0]].position.y + fixed_ypart(dw->proc[cl->data[0]].angle + dw->proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], dw->proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
     float vx, vy;
-    vx = al_fixtof(w.proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
-    vx += (cos(fixed_to_radians(w.proc[cl->data[0]].angle) + dshape[w.proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * dshape[w.proc[cl->data[0]].shape].link_object_dist [cl->data[1]]) * view.zoom;
-    vy = al_fixtof(w.proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
-    vy += (sin(fixed_to_radians(w.proc[cl->data[0]].angle) + dshape[w.proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * dshape[w.proc[cl->data[0]].shape].link_object_dist [cl->data[1]]) * view.zoom;
+    vx = al_fixtof(dw->proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
+    vx += (cos(fixed_to_radians(dw->proc[cl->data[0]].angle) + dshape[dw->proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * dshape[dw->proc[cl->data[0]].shape].link_object_dist [cl->data[1]]) * view.zoom;
+    vy = al_fixtof(dw->proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
+    vy += (sin(fixed_to_radians(dw->proc[cl->data[0]].angle) + dshape[dw->proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * dshape[dw->proc[cl->data[0]].shape].link_object_dist [cl->data[1]]) * view.zoom;
 
 
     float total_line_length = hypot(built_core_y - vy, built_core_x - vx);
 //    float line_length_unzoomed = hypot(al_fixtoi(cl->position.y - vertex_y_fixed), al_fixtoi(cl->position.x - vertex_x_fixed));
 
 
-    int line_time = w.world_time - cl->created_timestamp;
+    int line_time = dw->world_time - cl->created_timestamp;
 
     float angle_from_target = atan2(vy - built_core_y, vx - built_core_x);
 
@@ -5193,7 +5174,7 @@ far_dist = 12 + (shade);//*= 0.1;
 
     seed_drand(cl->created_timestamp + c);
 
-//    int line_time = w.world_time - cl->created_timestamp;
+//    int line_time = dw->world_time - cl->created_timestamp;
 
     float oscil_angle = PI + (cl->created_timestamp + line_time) * 0.01;
     float oscil_angle_inc = (5 + drand(5, 1)) * -0.03;
@@ -5280,8 +5261,8 @@ far_dist = 12 + (shade);//*= 0.1;
 //		case CLOUD_REPAIR_LINE:
 		{
 // first check the proc that produced the line still exists:
-    if (w.proc[cl->data[0]].exists <= 0
-					|| w.proc[cl->data[0]].created_timestamp != cl->associated_proc_timestamp)
+    if (dw->proc[cl->data[0]].exists <= 0
+					|| dw->proc[cl->data[0]].created_timestamp != cl->associated_proc_timestamp)
 						break;
 // assume:
 //  data[0] is associated proc index
@@ -5292,18 +5273,18 @@ far_dist = 12 + (shade);//*= 0.1;
 
     built_core_x += view.window_x_unzoomed / 2;
     built_core_y += view.window_y_unzoomed / 2;
-//    al_fixed vertex_x_fixed = w.proc[cl->data[0]].position.x + fixed_xpart(w.proc[cl->data[0]].angle + w.proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], w.proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
-//    al_fixed vertex_y_fixed = w.proc[cl->data[0]].position.y + fixed_ypart(w.proc[cl->data[0]].angle + w.proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], w.proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
+//    al_fixed vertex_x_fixed = dw->proc[cl->data[0]].position.x + fixed_xpart(dw->proc[cl->data[0]].angle + dw->proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], dw->proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
+//    al_fixed vertex_y_fixed = dw->proc[cl->data[0]].position.y + fixed_ypart(dw->proc[cl->data[0]].angle + dw->proc[cl->data[0]].nshape_ptr->object_angle_fixed [cl->data[1]], dw->proc[cl->data[0]].nshape_ptr->object_dist_fixed [cl->data[1]]);
     float vx, vy;
-    vx = al_fixtof(w.proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
-    vx += (cos(fixed_to_radians(w.proc[cl->data[0]].angle) + dshape[w.proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * dshape[w.proc[cl->data[0]].shape].link_object_dist [cl->data[1]]) * view.zoom;
-    vy = al_fixtof(w.proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
-    vy += (sin(fixed_to_radians(w.proc[cl->data[0]].angle) + dshape[w.proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * dshape[w.proc[cl->data[0]].shape].link_object_dist [cl->data[1]]) * view.zoom;
+    vx = al_fixtof(dw->proc[cl->data[0]].position.x - view.camera_x) * view.zoom + (view.window_x_unzoomed / 2);
+    vx += (cos(fixed_to_radians(dw->proc[cl->data[0]].angle) + dshape[dw->proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * dshape[dw->proc[cl->data[0]].shape].link_object_dist [cl->data[1]]) * view.zoom;
+    vy = al_fixtof(dw->proc[cl->data[0]].position.y - view.camera_y) * view.zoom + (view.window_y_unzoomed / 2);
+    vy += (sin(fixed_to_radians(dw->proc[cl->data[0]].angle) + dshape[dw->proc[cl->data[0]].shape].link_object_angle [cl->data[1]]) * dshape[dw->proc[cl->data[0]].shape].link_object_dist [cl->data[1]]) * view.zoom;
 
     float total_line_length = hypot(built_core_y - vy, built_core_x - vx);
 
 
-    int line_time = w.world_time - cl->created_timestamp;
+    int line_time = dw->world_time - cl->created_timestamp;
 //    shade = 32 - (line_time * 2);
 //    if (shade > CLOUD_SHADES - 1)
 //					shade = CLOUD_SHADES - 1;
@@ -5373,20 +5354,20 @@ far_dist = 12 + (shade);//*= 0.1;
 //   be valid for use in things like this)
 
 			 int draw_triangle;
-			 if (w.core[bubble_core_index].exists)
+			 if (dw->core[bubble_core_index].exists)
 					draw_triangle = 1;
 				  else
 							draw_triangle = 0;
 
-    draw_text_bubble(w.core[bubble_core_index].bubble_x,
-																					w.core[bubble_core_index].bubble_y,
-																					w.world_time - w.core[bubble_core_index].bubble_text_time_adjusted,
-																					w.core[bubble_core_index].player_index,
-																					w.core[bubble_core_index].bubble_text_length,
-																					w.core[bubble_core_index].bubble_text,
+    draw_text_bubble(dw->core[bubble_core_index].bubble_x,
+																					dw->core[bubble_core_index].bubble_y,
+																					dw->world_time - dw->core[bubble_core_index].bubble_text_time_adjusted,
+																					dw->core[bubble_core_index].player_index,
+																					dw->core[bubble_core_index].bubble_text_length,
+																					dw->core[bubble_core_index].bubble_text,
 																					draw_triangle);
 
-				bubble_core_index = w.core[bubble_core_index].bubble_list;
+				bubble_core_index = dw->core[bubble_core_index].bubble_list;
 
 	}
 #endif
@@ -5394,11 +5375,11 @@ far_dist = 12 + (shade);//*= 0.1;
 /*
 				int bubble_shade;
 				int bubble_text_shade;
-				int bubble_time = w.world_time - w.core[bubble_core_index].bubble_text_time_adjusted;
+				int bubble_time = dw->world_time - dw->core[bubble_core_index].bubble_text_time_adjusted;
 				float bubble_size_reduce;
 				bubble_shade = bubble_time;
 				bubble_shade = 16;
-				float adjusted_bubble_x = w.core[bubble_core_index].bubble_x - 20;
+				float adjusted_bubble_x = dw->core[bubble_core_index].bubble_x - 20;
 			 if (bubble_time < 16)
 				{
 					bubble_shade = 31 - (bubble_time);
@@ -5424,29 +5405,29 @@ far_dist = 12 + (shade);//*= 0.1;
 
 
  add_menu_button(adjusted_bubble_x - (10 - bubble_size_reduce),
-																	w.core[bubble_core_index].bubble_y - (10 - bubble_size_reduce),
-																	adjusted_bubble_x + (10) + w.core[bubble_core_index].bubble_text_length * 7,
-																	w.core[bubble_core_index].bubble_y + (20 - bubble_size_reduce),
+																	dw->core[bubble_core_index].bubble_y - (10 - bubble_size_reduce),
+																	adjusted_bubble_x + (10) + dw->core[bubble_core_index].bubble_text_length * 7,
+																	dw->core[bubble_core_index].bubble_y + (20 - bubble_size_reduce),
 //																	colours.packet [pr->player_index] [bubble_shade],
-																	colours.packet [w.core[bubble_core_index].player_index] [bubble_shade],
+																	colours.packet [dw->core[bubble_core_index].player_index] [bubble_shade],
 																	3, 8);
 
 	add_triangle(4,
 														adjusted_bubble_x,
-														w.core[bubble_core_index].bubble_y + 22,
+														dw->core[bubble_core_index].bubble_y + 22,
 														adjusted_bubble_x + 19,
-														w.core[bubble_core_index].bubble_y + 22,
+														dw->core[bubble_core_index].bubble_y + 22,
 														adjusted_bubble_x + 19,
-														w.core[bubble_core_index].bubble_y + 52,
-														colours.packet [w.core[bubble_core_index].player_index] [bubble_shade]);
+														dw->core[bubble_core_index].bubble_y + 52,
+														colours.packet [dw->core[bubble_core_index].player_index] [bubble_shade]);
 
 				int text_shade = bubble_shade * 2;
 				if (text_shade > 31)
 					text_shade = 31;
 
-				al_draw_textf(font[FONT_SQUARE].fnt, colours.packet [w.core[bubble_core_index].player_index] [text_shade], adjusted_bubble_x, w.core[bubble_core_index].bubble_y, ALLEGRO_ALIGN_LEFT, "%s", w.core[bubble_core_index].bubble_text);
+				al_draw_textf(font[FONT_SQUARE].fnt, colours.packet [dw->core[bubble_core_index].player_index] [text_shade], adjusted_bubble_x, dw->core[bubble_core_index].bubble_y, ALLEGRO_ALIGN_LEFT, "%s", dw->core[bubble_core_index].bubble_text);
 
-				bubble_core_index = w.core[bubble_core_index].bubble_list;
+				bubble_core_index = dw->core[bubble_core_index].bubble_list;
 
 	}
 */
@@ -5470,7 +5451,7 @@ far_dist = 12 + (shade);//*= 0.1;
   vision_check_for_display(); // sets up block data for visibility (fog of war)
 
   if (game.phase == GAME_PHASE_PREGAME)
-			special_visible_area(w.player[game.user_player_index].spawn_position);
+			special_visible_area(dw->player[game.user_player_index].spawn_position);
 /*
   for (i = -1; i < screen_width_in_blocks; i ++)
   {
@@ -5479,7 +5460,7 @@ far_dist = 12 + (shade);//*= 0.1;
 
    if (bx < 1)
     continue;
-   if (bx >= w.blocks.x - 1)
+   if (bx >= dw->blocks.x - 1)
     break;
 
  check_vbuf();
@@ -5490,12 +5471,12 @@ far_dist = 12 + (shade);//*= 0.1;
 
     if (by < 1)
      continue;
-    if (by >= w.blocks.y - 1)
+    if (by >= dw->blocks.y - 1)
      break;
 
     	if (bx < 2 || by < 2
-						|| bx >= w.blocks.x - 2
-						|| by >= w.blocks.y - 2)
+						|| bx >= dw->blocks.x - 2
+						|| by >= dw->blocks.y - 2)
 							continue;
 
     bx2 = ((i * BLOCK_SIZE_PIXELS) - camera_offset_x) * view.zoom;
@@ -5512,15 +5493,15 @@ far_dist = 12 + (shade);//*= 0.1;
   while (i < deferred_data_wells)
 		{
 
-			if (w.vision_block[deferred_data_well_draw_i [i]][deferred_data_well_draw_j [i]].clear_time == w.world_time)
+			if (dw->vision_block[deferred_data_well_draw_i [i]][deferred_data_well_draw_j [i]].clear_time == dw->world_time)
 			 continue;
 
 			float alpha_ch;
 
-							if (w.vision_block[deferred_data_well_draw_i [i]][deferred_data_well_draw_j [i]].proximity_time == w.world_time
-								&& w.vision_block[deferred_data_well_draw_i [i]][deferred_data_well_draw_j [i]].clear_time != w.world_time)
+							if (dw->vision_block[deferred_data_well_draw_i [i]][deferred_data_well_draw_j [i]].proximity_time == dw->world_time
+								&& dw->vision_block[deferred_data_well_draw_i [i]][deferred_data_well_draw_j [i]].clear_time != dw->world_time)
        {
-        alpha_ch = w.vision_block[deferred_data_well_draw_i [i]][deferred_data_well_draw_j [i]].proximity;// * 0.1;
+        alpha_ch = dw->vision_block[deferred_data_well_draw_i [i]][deferred_data_well_draw_j [i]].proximity;// * 0.1;
         if (alpha_ch > 255)
 	        alpha_ch = 255;
        }
@@ -5560,7 +5541,7 @@ far_dist = 12 + (shade);//*= 0.1;
 
    if (bx < 0)
     continue;
-   if (bx >= w.blocks.x)
+   if (bx >= dw->blocks.x)
     break;
 
    check_vbuf();
@@ -5573,7 +5554,7 @@ far_dist = 12 + (shade);//*= 0.1;
 
     if (by < 0)
      continue;
-    if (by >= w.blocks.y)
+    if (by >= dw->blocks.y)
      break;
 
 //    fprintf(stdout, "[bx,by %i,%i]", bx, by);
@@ -5582,11 +5563,11 @@ far_dist = 12 + (shade);//*= 0.1;
        by2 = top_left_corner_y [0] + (BLOCK_SIZE_PIXELS * view.zoom) * (j); //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
 
 
-//    if (w.vision_area [bx] [by].vision_time < w.world_time)
-    if (//w.block[bx][by].vision_block_proximity_time == w.world_time
- 				w.vision_block[bx][by].clear_time == w.world_time)
+//    if (dw->vision_area [bx] [by].vision_time < dw->world_time)
+    if (//dw->block[bx][by].vision_block_proximity_time == dw->world_time
+ 				dw->vision_block[bx][by].clear_time == dw->world_time)
     {
-//    	int shadow_prop = w.world_time - w.vision_area [bx] [by].vision_time;
+//    	int shadow_prop = dw->world_time - dw->vision_area [bx] [by].vision_time;
 
 //    	if (shadow_prop >= 128)
 //					{
@@ -5604,13 +5585,13 @@ far_dist = 12 + (shade);//*= 0.1;
 			}
 					 else
 						{
-							if (w.vision_block[bx][by].proximity_time == w.world_time
-								&& w.vision_block[bx][by].clear_time != w.world_time)
+							if (dw->vision_block[bx][by].proximity_time == dw->world_time
+								&& dw->vision_block[bx][by].clear_time != dw->world_time)
 							{
 
-//									float block_size = 0.95;//BLOCK_SIZE_PIXELS * 0.6; //(w.block[bx][by].vision_block_proximity [k * 2 + l] - 108) * 0.2;//(float) ((w.block[bx][by].vision_block_proximity [k * 2 + l] - (BLOCK_SIZE_PIXELS * 6))) * view.zoom;
+//									float block_size = 0.95;//BLOCK_SIZE_PIXELS * 0.6; //(dw->block[bx][by].vision_block_proximity [k * 2 + l] - 108) * 0.2;//(float) ((dw->block[bx][by].vision_block_proximity [k * 2 + l] - (BLOCK_SIZE_PIXELS * 6))) * view.zoom;
 
-//									block_size *= 	w.block[bx][by].vision_block_x_shrink [k * 2 + l];
+//									block_size *= 	dw->block[bx][by].vision_block_x_shrink [k * 2 + l];
 
 //									if (block_size < 0)
 //										continue;
@@ -5618,7 +5599,7 @@ far_dist = 12 + (shade);//*= 0.1;
 //										block_size = 60;
 
 
-float alpha_ch = w.vision_block[bx][by].proximity;// * 0.1;
+float alpha_ch = dw->vision_block[bx][by].proximity;// * 0.1;
 if (alpha_ch > 255)
 	alpha_ch = 255;
 
@@ -5673,7 +5654,7 @@ add_stretched_hexagon(bx2 + x_offset, by2 + BLOCK_SIZE_PIXELS * 0.5 * view.zoom,
   vision_check_for_display(); // sets up block data for visibility (fog of war)
 
   if (game.phase == GAME_PHASE_PREGAME)
-			special_visible_area(w.player[game.user_player_index].spawn_position);
+			special_visible_area(dw->player[game.user_player_index].spawn_position);
 /*
   for (i = -1; i < screen_width_in_blocks; i ++)
   {
@@ -5682,7 +5663,7 @@ add_stretched_hexagon(bx2 + x_offset, by2 + BLOCK_SIZE_PIXELS * 0.5 * view.zoom,
 
    if (bx < 1)
     continue;
-   if (bx >= w.blocks.x - 1)
+   if (bx >= dw->blocks.x - 1)
     break;
 
  check_vbuf();
@@ -5693,12 +5674,12 @@ add_stretched_hexagon(bx2 + x_offset, by2 + BLOCK_SIZE_PIXELS * 0.5 * view.zoom,
 
     if (by < 1)
      continue;
-    if (by >= w.blocks.y - 1)
+    if (by >= dw->blocks.y - 1)
      break;
 
     	if (bx < 2 || by < 2
-						|| bx >= w.blocks.x - 2
-						|| by >= w.blocks.y - 2)
+						|| bx >= dw->blocks.x - 2
+						|| by >= dw->blocks.y - 2)
 							continue;
 
     bx2 = ((i * BLOCK_SIZE_PIXELS) - camera_offset_x) * view.zoom;
@@ -5721,7 +5702,7 @@ add_stretched_hexagon(bx2 + x_offset, by2 + BLOCK_SIZE_PIXELS * 0.5 * view.zoom,
 
    if (bx < 0)
     continue;
-   if (bx >= w.blocks.x)
+   if (bx >= dw->blocks.x)
     break;
 
    check_vbuf();
@@ -5734,7 +5715,7 @@ add_stretched_hexagon(bx2 + x_offset, by2 + BLOCK_SIZE_PIXELS * 0.5 * view.zoom,
 
     if (by < 0)
      continue;
-    if (by >= w.blocks.y)
+    if (by >= dw->blocks.y)
      break;
 
 //    fprintf(stdout, "[bx,by %i,%i]", bx, by);
@@ -5743,11 +5724,11 @@ add_stretched_hexagon(bx2 + x_offset, by2 + BLOCK_SIZE_PIXELS * 0.5 * view.zoom,
        by2 = top_left_corner_y + (BLOCK_SIZE_PIXELS * view.zoom) * (j); //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
 
 
-//    if (w.vision_area [bx] [by].vision_time < w.world_time)
-    if (w.block[bx][by].vision_block_proximity_time != w.world_time
- 				&& w.block[bx][by].vision_block_clear_time != w.world_time)
+//    if (dw->vision_area [bx] [by].vision_time < dw->world_time)
+    if (dw->block[bx][by].vision_block_proximity_time != dw->world_time
+ 				&& dw->block[bx][by].vision_block_clear_time != dw->world_time)
     {
-//    	int shadow_prop = w.world_time - w.vision_area [bx] [by].vision_time;
+//    	int shadow_prop = dw->world_time - dw->vision_area [bx] [by].vision_time;
 
 //    	if (shadow_prop >= 128)
 //					{
@@ -5771,13 +5752,13 @@ add_stretched_hexagon(bx2 + x_offset, by2 + BLOCK_SIZE_PIXELS * 0.5 * view.zoom,
 			}
 					 else
 						{
-							if (w.block[bx][by].vision_block_proximity_time == w.world_time
-								&& w.block[bx][by].vision_block_clear_time != w.world_time)
+							if (dw->block[bx][by].vision_block_proximity_time == dw->world_time
+								&& dw->block[bx][by].vision_block_clear_time != dw->world_time)
 							{
 
-									float block_size = BLOCK_SIZE_PIXELS * 0.6 * view.zoom; //(w.block[bx][by].vision_block_proximity [k * 2 + l] - 108) * 0.2;//(float) ((w.block[bx][by].vision_block_proximity [k * 2 + l] - (BLOCK_SIZE_PIXELS * 6))) * view.zoom;
+									float block_size = BLOCK_SIZE_PIXELS * 0.6 * view.zoom; //(dw->block[bx][by].vision_block_proximity [k * 2 + l] - 108) * 0.2;//(float) ((dw->block[bx][by].vision_block_proximity [k * 2 + l] - (BLOCK_SIZE_PIXELS * 6))) * view.zoom;
 
-//									block_size *= 	w.block[bx][by].vision_block_x_shrink [k * 2 + l];
+//									block_size *= 	dw->block[bx][by].vision_block_x_shrink [k * 2 + l];
 
 //									if (block_size < 0)
 //										continue;
@@ -5785,7 +5766,7 @@ add_stretched_hexagon(bx2 + x_offset, by2 + BLOCK_SIZE_PIXELS * 0.5 * view.zoom,
 //										block_size = 60;
 
 
-float alpha_ch = w.block[bx][by].vision_block_proximity;// * 0.5;
+float alpha_ch = dw->block[bx][by].vision_block_proximity;// * 0.5;
 if (alpha_ch > 255)
 	alpha_ch = 255;
 
@@ -5803,17 +5784,17 @@ add_stretched_hexagon(bx2 + x_offset, by2 + BLOCK_SIZE_PIXELS * 0.5 * view.zoom,
 
 /*
 							int l;
-//							float shadow_square_size = (w.world_time - w.vision_area [bx] [by].vision_time) * view.zoom * (BLOCK_SIZE_PIXELS / 4) / 128;
+//							float shadow_square_size = (dw->world_time - dw->vision_area [bx] [by].vision_time) * view.zoom * (BLOCK_SIZE_PIXELS / 4) / 128;
 							for (k = 0; k < 2; k ++)
 							{
 								for (l = 0; l < 2; l ++)
 								{
-									float kx = bx2 + w.block[bx][by].vision_block_x [k * 2 + l] * view.zoom;
-									float ky = by2 + w.block[bx][by].vision_block_y [k * 2 + l] * view.zoom;
+									float kx = bx2 + dw->block[bx][by].vision_block_x [k * 2 + l] * view.zoom;
+									float ky = by2 + dw->block[bx][by].vision_block_y [k * 2 + l] * view.zoom;
 
-									float block_size = (w.block[bx][by].vision_block_proximity [k * 2 + l] - 108) * 0.2;//(float) ((w.block[bx][by].vision_block_proximity [k * 2 + l] - (BLOCK_SIZE_PIXELS * 6))) * view.zoom;
+									float block_size = (dw->block[bx][by].vision_block_proximity [k * 2 + l] - 108) * 0.2;//(float) ((dw->block[bx][by].vision_block_proximity [k * 2 + l] - (BLOCK_SIZE_PIXELS * 6))) * view.zoom;
 
-									block_size *= 	w.block[bx][by].vision_block_x_shrink [k * 2 + l];
+									block_size *= 	dw->block[bx][by].vision_block_x_shrink [k * 2 + l];
 
 									if (block_size < 0)
 										continue;
@@ -5866,9 +5847,9 @@ add_orthogonal_hexagon(kx, ky, block_size, al_map_rgba(0,0,0, alpha_ch)); //colo
 
 
 
- for (i = w.player[game.user_player_index].core_index_start; i < w.player[game.user_player_index].core_index_end; i++)
+ for (i = dw->player[game.user_player_index].core_index_start; i < dw->player[game.user_player_index].core_index_end; i++)
 	{
-  core = &w.core[i];
+  core = &dw->core[i];
   x = al_fixtof(core->core_position.x - view.camera_x) * view.zoom;
   y = al_fixtof(core->core_position.y - view.camera_y) * view.zoom;
   x += view.window_x_unzoomed / 2;
@@ -5982,8 +5963,8 @@ add_orthogonal_hexagon(kx, ky, block_size, al_map_rgba(0,0,0, alpha_ch)); //colo
 		&& bcp_state.bcp_mode == BCP_MODE_PROCESS)
 	{
 
-    x = al_fixtof(w.core[bcp_state.watch_core_index].core_position.x - view.camera_x) * view.zoom;
-    y = al_fixtof(w.core[bcp_state.watch_core_index].core_position.y - view.camera_y) * view.zoom;
+    x = al_fixtof(dw->core[bcp_state.watch_core_index].core_position.x - view.camera_x) * view.zoom;
+    y = al_fixtof(dw->core[bcp_state.watch_core_index].core_position.y - view.camera_y) * view.zoom;
 
     x += view.window_x_unzoomed / 2;
     y += view.window_y_unzoomed / 2;
@@ -6005,12 +5986,12 @@ add_orthogonal_hexagon(kx, ky, block_size, al_map_rgba(0,0,0, alpha_ch)); //colo
 
     if (bcp_state.mouseover_time == inter.running_time - 1
 				 &&	bcp_state.mouseover_type == BCP_MOUSEOVER_CORE_INDEX
-				 && bcp_state.mouseover_value >= 0 && bcp_state.mouseover_value < w.max_cores)
+				 && bcp_state.mouseover_value >= 0 && bcp_state.mouseover_value < dw->max_cores)
 				{
 
 
-     x = al_fixtof(w.core[bcp_state.mouseover_value].core_position.x - view.camera_x) * view.zoom;
-     y = al_fixtof(w.core[bcp_state.mouseover_value].core_position.y - view.camera_y) * view.zoom;
+     x = al_fixtof(dw->core[bcp_state.mouseover_value].core_position.x - view.camera_x) * view.zoom;
+     y = al_fixtof(dw->core[bcp_state.mouseover_value].core_position.y - view.camera_y) * view.zoom;
 
      x += view.window_x_unzoomed / 2;
      y += view.window_y_unzoomed / 2;
@@ -6106,16 +6087,16 @@ if (inter.block_mode_button_area_scrolling)
 
  draw_vbuf();
 
- al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_GREY] [SHADE_MAX], text_x, (int) (box_y + 10), ALLEGRO_ALIGN_LEFT, "%s", w.player[game.user_player_index].name);
+ al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_GREY] [SHADE_MAX], text_x, (int) (box_y + 10), ALLEGRO_ALIGN_LEFT, "%s", dw->player[game.user_player_index].name);
  text_y = box_y + BOX_HEADER_H + 7;// + BOX_LINE_H;
  al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_BLUE] [SHADE_MAX], text_x, text_y, ALLEGRO_ALIGN_LEFT, "data");
- al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_BLUE] [SHADE_MAX], text_x2, text_y, ALLEGRO_ALIGN_RIGHT, "%i", w.player[game.user_player_index].data);
+ al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_BLUE] [SHADE_MAX], text_x2, text_y, ALLEGRO_ALIGN_RIGHT, "%i", dw->player[game.user_player_index].data);
  text_y += BOX_LINE_H;
  al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_BLUE] [SHADE_MAX], text_x, text_y, ALLEGRO_ALIGN_LEFT, "processes");
- al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_BLUE] [SHADE_MAX], text_x2, text_y, ALLEGRO_ALIGN_RIGHT, "%i (%i)", w.player[game.user_player_index].processes, w.cores_per_player);
+ al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_BLUE] [SHADE_MAX], text_x2, text_y, ALLEGRO_ALIGN_RIGHT, "%i (%i)", dw->player[game.user_player_index].processes, dw->cores_per_player);
  text_y += BOX_LINE_H;
  al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_BLUE] [SHADE_MAX], text_x, text_y, ALLEGRO_ALIGN_LEFT, "components");
- al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_BLUE] [SHADE_MAX], text_x2, text_y, ALLEGRO_ALIGN_RIGHT, "%i (%i) (%i)", w.player[game.user_player_index].components_current, w.player[game.user_player_index].components_reserved, w.procs_per_player);
+ al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_BLUE] [SHADE_MAX], text_x2, text_y, ALLEGRO_ALIGN_RIGHT, "%i (%i) (%i)", dw->player[game.user_player_index].components_current, dw->player[game.user_player_index].components_reserved, dw->procs_per_player);
 #endif
 
 // draw data box:
@@ -6133,7 +6114,7 @@ if (inter.block_mode_button_area_scrolling)
 
 		process_box_y = box_y; // this may be used later if the component box needs to be moved out of the way of the map
 
-		core = &w.core[command.selected_core [0]];
+		core = &dw->core[command.selected_core [0]];
 
   int button_shade = SHADE_HIGH;
 
@@ -6246,7 +6227,7 @@ if (inter.block_mode_button_area_scrolling)
 							bar_col = COL_ORANGE;
 							bar_shade = SHADE_MAX;
 
-      if (core->interface_broken_time + INTERFACE_BROKEN_TIMER > w.world_time)
+      if (core->interface_broken_time + INTERFACE_BROKEN_TIMER > dw->world_time)
 						{
 							bar_col = COL_PURPLE;
 							bar_shade = SHADE_MAX;
@@ -6260,9 +6241,9 @@ if (inter.block_mode_button_area_scrolling)
 
 				float bar_shade = 0.9;
 
-				ALLEGRO_COLOR integrity_bar_colour = al_map_rgba(w.player[core->player_index].interface_colour_base [0] + (w.player[core->player_index].interface_colour_charge [0] * bar_shade),
-																																																    	w.player[core->player_index].interface_colour_base [1] + (w.player[core->player_index].interface_colour_charge [1] * bar_shade),
-																																															    		w.player[core->player_index].interface_colour_base [2] + (w.player[core->player_index].interface_colour_charge [2] * bar_shade),
+				ALLEGRO_COLOR integrity_bar_colour = al_map_rgba(dw->player[core->player_index].interface_colour_base [0] + (dw->player[core->player_index].interface_colour_charge [0] * bar_shade),
+																																																    	dw->player[core->player_index].interface_colour_base [1] + (dw->player[core->player_index].interface_colour_charge [1] * bar_shade),
+																																															    		dw->player[core->player_index].interface_colour_base [2] + (dw->player[core->player_index].interface_colour_charge [2] * bar_shade),
 																																															    		150);
 
     add_orthogonal_rect(2, text_x + 12, text_y, text_x + 12 + (core->group_total_hp * (integrity_bar_max-4) / core->group_total_hp_max_undamaged), text_y + 8, integrity_bar_colour);
@@ -6271,9 +6252,9 @@ if (inter.block_mode_button_area_scrolling)
 				if (core->group_total_hp == core->group_total_hp_max_undamaged)
 					bar_shade = 0.6;
 
-				integrity_bar_colour = al_map_rgba(w.player[core->player_index].interface_colour_base [0] + (w.player[core->player_index].interface_colour_charge [0] * bar_shade),
-																																																    	w.player[core->player_index].interface_colour_base [1] + (w.player[core->player_index].interface_colour_charge [1] * bar_shade),
-																																															    		w.player[core->player_index].interface_colour_base [2] + (w.player[core->player_index].interface_colour_charge [2] * bar_shade),
+				integrity_bar_colour = al_map_rgba(dw->player[core->player_index].interface_colour_base [0] + (dw->player[core->player_index].interface_colour_charge [0] * bar_shade),
+																																																    	dw->player[core->player_index].interface_colour_base [1] + (dw->player[core->player_index].interface_colour_charge [1] * bar_shade),
+																																															    		dw->player[core->player_index].interface_colour_base [2] + (dw->player[core->player_index].interface_colour_charge [2] * bar_shade),
 																																															    		150);
 
     add_orthogonal_rect(2, text_x + 12, text_y, text_x + 12 + (core->group_total_hp_max_current * (integrity_bar_max-4) / core->group_total_hp_max_undamaged), text_y + 8, integrity_bar_colour);*/
@@ -6287,9 +6268,9 @@ if (inter.block_mode_button_area_scrolling)
 
 				float bar_shade = 0.9;
 
-				ALLEGRO_COLOR integrity_bar_colour = al_map_rgba(w.player[core->player_index].interface_colour_base [0] + (w.player[core->player_index].interface_colour_charge [0] * bar_shade),
-																																																    	w.player[core->player_index].interface_colour_base [1] + (w.player[core->player_index].interface_colour_charge [1] * bar_shade),
-																																															    		w.player[core->player_index].interface_colour_base [2] + (w.player[core->player_index].interface_colour_charge [2] * bar_shade),
+				ALLEGRO_COLOR integrity_bar_colour = al_map_rgba(dw->player[core->player_index].interface_colour_base [0] + (dw->player[core->player_index].interface_colour_charge [0] * bar_shade),
+																																																    	dw->player[core->player_index].interface_colour_base [1] + (dw->player[core->player_index].interface_colour_charge [1] * bar_shade),
+																																															    		dw->player[core->player_index].interface_colour_base [2] + (dw->player[core->player_index].interface_colour_charge [2] * bar_shade),
 																																															    		150);
 
     add_orthogonal_rect(2, text_x + 12, text_y, text_x + 12 + (core->group_total_hp * (integrity_bar_max-4) / core->group_total_hp_max_undamaged), text_y + 8, integrity_bar_colour);
@@ -6298,9 +6279,9 @@ if (inter.block_mode_button_area_scrolling)
 				if (core->group_total_hp == core->group_total_hp_max_undamaged)
 					bar_shade = 0.6;
 
-				integrity_bar_colour = al_map_rgba(w.player[core->player_index].interface_colour_base [0] + (w.player[core->player_index].interface_colour_charge [0] * bar_shade),
-																																																    	w.player[core->player_index].interface_colour_base [1] + (w.player[core->player_index].interface_colour_charge [1] * bar_shade),
-																																															    		w.player[core->player_index].interface_colour_base [2] + (w.player[core->player_index].interface_colour_charge [2] * bar_shade),
+				integrity_bar_colour = al_map_rgba(dw->player[core->player_index].interface_colour_base [0] + (dw->player[core->player_index].interface_colour_charge [0] * bar_shade),
+																																																    	dw->player[core->player_index].interface_colour_base [1] + (dw->player[core->player_index].interface_colour_charge [1] * bar_shade),
+																																															    		dw->player[core->player_index].interface_colour_base [2] + (dw->player[core->player_index].interface_colour_charge [2] * bar_shade),
 																																															    		150);
 
     add_orthogonal_rect(2, text_x + 12, text_y, text_x + 12 + (core->group_total_hp_max_current * (integrity_bar_max-4) / core->group_total_hp_max_undamaged), text_y + 8, integrity_bar_colour);
@@ -6331,9 +6312,9 @@ if (inter.block_mode_button_area_scrolling)
 				if (core->interface_strength == core->interface_strength_max)
 					bar_shade = 0.7;
 
-				ALLEGRO_COLOR interface_bar_colour = al_map_rgba(w.player[core->player_index].interface_colour_base [0] + (w.player[core->player_index].interface_colour_charge [0] * bar_shade),
-																																																    	w.player[core->player_index].interface_colour_base [1] + (w.player[core->player_index].interface_colour_charge [1] * bar_shade),
-																																															    		w.player[core->player_index].interface_colour_base [2] + (w.player[core->player_index].interface_colour_charge [2] * bar_shade),
+				ALLEGRO_COLOR interface_bar_colour = al_map_rgba(dw->player[core->player_index].interface_colour_base [0] + (dw->player[core->player_index].interface_colour_charge [0] * bar_shade),
+																																																    	dw->player[core->player_index].interface_colour_base [1] + (dw->player[core->player_index].interface_colour_charge [1] * bar_shade),
+																																															    		dw->player[core->player_index].interface_colour_base [2] + (dw->player[core->player_index].interface_colour_charge [2] * bar_shade),
 																																															    		150);
 */
 
@@ -6346,7 +6327,7 @@ if (inter.block_mode_button_area_scrolling)
 				}
 				 else
 					{
-      if (core->interface_broken_time + INTERFACE_BROKEN_TIMER > w.world_time)
+      if (core->interface_broken_time + INTERFACE_BROKEN_TIMER > dw->world_time)
 						{
 							bar_col = COL_PURPLE;
 							bar_shade = SHADE_MAX;
@@ -6360,8 +6341,8 @@ if (inter.block_mode_button_area_scrolling)
     add_orthogonal_rect(2, text_x + 12, text_y, text_x + 12 + (core->interface_strength * (interface_bar_max-4) / core->interface_strength_max), text_y + 8, colours.base_trans [bar_col] [bar_shade] [TRANS_MED]);
 		}
 
-   if (core->interface_broken_time + INTERFACE_BROKEN_TIMER > w.world_time)
-    al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_RED] [SHADE_MAX], text_x2, text_y, ALLEGRO_ALIGN_RIGHT, "broken (%i)", (core->interface_broken_time + INTERFACE_BROKEN_TIMER - w.world_time) / EXECUTION_COUNT);
+   if (core->interface_broken_time + INTERFACE_BROKEN_TIMER > dw->world_time)
+    al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_RED] [SHADE_MAX], text_x2, text_y, ALLEGRO_ALIGN_RIGHT, "broken (%i)", (core->interface_broken_time + INTERFACE_BROKEN_TIMER - dw->world_time) / EXECUTION_COUNT);
      else
 					{
 
@@ -6406,7 +6387,7 @@ if (inter.block_mode_button_area_scrolling)
   text_y += BOX_LINE_H;
 
   al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_TURQUOISE] [SHADE_MAX], text_x, text_y, ALLEGRO_ALIGN_LEFT, "next cycle");
-  al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_TURQUOISE] [SHADE_MAX], text_x2, text_y, ALLEGRO_ALIGN_RIGHT, "%i", core->next_execution_timestamp - w.world_time);
+  al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_TURQUOISE] [SHADE_MAX], text_x2, text_y, ALLEGRO_ALIGN_RIGHT, "%i", core->next_execution_timestamp - dw->world_time);
   text_y += BOX_LINE_H;
 
   al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_TURQUOISE] [SHADE_MAX], text_x, text_y, ALLEGRO_ALIGN_LEFT, "instructions used");
@@ -6423,14 +6404,14 @@ if (inter.block_mode_button_area_scrolling)
 #define CONSTRUCT_BOX_Y scaled_construct_box_y
    float power_box_y;// = text_y + CONSTRUCT_BOX_Y;//_BOX_H;// + 2;
 
-  if (core->construction_complete_timestamp > w.world_time)
+  if (core->construction_complete_timestamp > dw->world_time)
 		{
 
    power_box_y = text_y + CONSTRUCT_BOX_Y;//_BOX_H;// + 2;
 
    al_draw_textf(font[FONT_SQUARE].fnt, colours.base_trans [COL_YELLOW] [SHADE_MAX] [TRANS_THICK], (int) (text_x + scaleUI_x(FONT_SQUARE,20)), (int) (text_y + (CONSTRUCT_BOX_Y) - scaleUI_y(FONT_SQUARE,25)), ALLEGRO_ALIGN_LEFT, "Constructing...");
-   al_draw_textf(font[FONT_SQUARE].fnt, colours.base_trans [COL_YELLOW] [SHADE_HIGH] [TRANS_THICK], (int) (text_x + scaleUI_x(FONT_SQUARE,70)), (int) (text_y + (CONSTRUCT_BOX_Y)), ALLEGRO_ALIGN_LEFT, "Ready in %i", (core->construction_complete_timestamp - w.world_time) / EXECUTION_COUNT);
-   int line_pos = (core->construction_complete_timestamp - w.world_time) % 20;
+   al_draw_textf(font[FONT_SQUARE].fnt, colours.base_trans [COL_YELLOW] [SHADE_HIGH] [TRANS_THICK], (int) (text_x + scaleUI_x(FONT_SQUARE,70)), (int) (text_y + (CONSTRUCT_BOX_Y)), ALLEGRO_ALIGN_LEFT, "Ready in %i", (core->construction_complete_timestamp - dw->world_time) / EXECUTION_COUNT);
+   int line_pos = (core->construction_complete_timestamp - dw->world_time) % 20;
 
    add_orthogonal_rect(2, text_x + scaleUI_x(FONT_SQUARE,10), text_y + CONSTRUCT_BOX_Y - scaleUI_y(FONT_SQUARE,35), text_x + scaleUI_x(FONT_SQUARE,210), text_y + CONSTRUCT_BOX_Y + scaleUI_y(FONT_SQUARE,20), colours.base_trans [COL_ORANGE] [SHADE_MED] [TRANS_FAINT]);
    add_orthogonal_rect(2, text_x + scaleUI_x(FONT_SQUARE,10) + line_pos * scaleUI_x(FONT_SQUARE,10), text_y + CONSTRUCT_BOX_Y - scaleUI_y(FONT_SQUARE,35), text_x + scaleUI_x(FONT_SQUARE,20) + line_pos * scaleUI_x(FONT_SQUARE,10), text_y + CONSTRUCT_BOX_Y + scaleUI_y(FONT_SQUARE,20), colours.base_trans [COL_ORANGE] [SHADE_MAX] [TRANS_MED]);
@@ -6515,7 +6496,7 @@ if (inter.block_mode_button_area_scrolling)
 // note that this code is inside if (command.select_mode == COMMAND_SINGLE_CORE)
   if (command.selected_member != -1) // can be -1 if e.g. selected member destroyed since selection, but core survives
 		{
-			struct proc_struct* selected_proc = &w.proc[core->group_member[command.selected_member].index];
+			struct proc_struct* selected_proc = &dw->proc[core->group_member[command.selected_member].index];
 			box_y = text_y + 8;//box_y + box_h + 8 + STRESS_BOX_H;
 			box_lines = 4 + selected_proc->nshape_ptr->links;
 
@@ -6552,9 +6533,9 @@ if (inter.block_mode_button_area_scrolling)
 /*
 				float bar_shade = 0.9;
 
-				ALLEGRO_COLOR integrity_bar_colour = al_map_rgba(w.player[core->player_index].interface_colour_base [0] + (w.player[core->player_index].interface_colour_charge [0] * bar_shade),
-																																																    	w.player[core->player_index].interface_colour_base [1] + (w.player[core->player_index].interface_colour_charge [1] * bar_shade),
-																																															    		w.player[core->player_index].interface_colour_base [2] + (w.player[core->player_index].interface_colour_charge [2] * bar_shade),
+				ALLEGRO_COLOR integrity_bar_colour = al_map_rgba(dw->player[core->player_index].interface_colour_base [0] + (dw->player[core->player_index].interface_colour_charge [0] * bar_shade),
+																																																    	dw->player[core->player_index].interface_colour_base [1] + (dw->player[core->player_index].interface_colour_charge [1] * bar_shade),
+																																															    		dw->player[core->player_index].interface_colour_base [2] + (dw->player[core->player_index].interface_colour_charge [2] * bar_shade),
 																																															    		150);
 */
     add_orthogonal_rect(2, text_x + 12, text_y, text_x + 12 + (selected_proc->hp * (integrity_bar_max-4) / selected_proc->hp_max), text_y + 8, colours.base_trans [COL_ORANGE] [SHADE_HIGH] [TRANS_THICK]);
@@ -6563,9 +6544,9 @@ if (inter.block_mode_button_area_scrolling)
 				if (core->group_total_hp == core->group_total_hp_max_undamaged)
 					bar_shade = 0.6;
 
-				integrity_bar_colour = al_map_rgba(w.player[core->player_index].interface_colour_base [0] + (w.player[core->player_index].interface_colour_var [0] * bar_shade),
-																																																    	w.player[core->player_index].interface_colour_base [1] + (w.player[core->player_index].interface_colour_var [1] * bar_shade),
-																																															    		w.player[core->player_index].interface_colour_base [2] + (w.player[core->player_index].interface_colour_var [2] * bar_shade),
+				integrity_bar_colour = al_map_rgba(dw->player[core->player_index].interface_colour_base [0] + (dw->player[core->player_index].interface_colour_var [0] * bar_shade),
+																																																    	dw->player[core->player_index].interface_colour_base [1] + (dw->player[core->player_index].interface_colour_var [1] * bar_shade),
+																																															    		dw->player[core->player_index].interface_colour_base [2] + (dw->player[core->player_index].interface_colour_var [2] * bar_shade),
 																																															    		150);
 
     add_orthogonal_rect(text_x + 12, text_y, text_x + 12 + (core->group_total_hp_max_current * (integrity_bar_max-4) / core->group_total_hp_max_undamaged), text_y + 8, integrity_bar_colour);*/
@@ -6586,15 +6567,15 @@ if (inter.block_mode_button_area_scrolling)
        switch(selected_proc->object[i].type)
        {
 							 case OBJECT_TYPE_BUILD:
-							 	if (core->build_cooldown_time > w.world_time)
-          print_object_information(text_x2, text_y, COL_YELLOW, "recycle", (core->build_cooldown_time - w.world_time) / EXECUTION_COUNT, 1);
+							 	if (core->build_cooldown_time > dw->world_time)
+          print_object_information(text_x2, text_y, COL_YELLOW, "recycle", (core->build_cooldown_time - dw->world_time) / EXECUTION_COUNT, 1);
            else
             print_object_information(text_x2, text_y, COL_AQUA, "ready", 0, 0);
 								 break;
 							 case OBJECT_TYPE_REPAIR:
 							 case OBJECT_TYPE_REPAIR_OTHER:
-							 	if (core->restore_cooldown_time > w.world_time)
-          print_object_information(text_x2, text_y, COL_YELLOW, "recycle", (core->restore_cooldown_time - w.world_time) / EXECUTION_COUNT, 1);
+							 	if (core->restore_cooldown_time > dw->world_time)
+          print_object_information(text_x2, text_y, COL_YELLOW, "recycle", (core->restore_cooldown_time - dw->world_time) / EXECUTION_COUNT, 1);
            else
             print_object_information(text_x2, text_y, COL_AQUA, "ready", 0, 0);
 								 break;
@@ -6610,30 +6591,30 @@ if (inter.block_mode_button_area_scrolling)
 							 case OBJECT_TYPE_SPIKE:
 							 case OBJECT_TYPE_ULTRA:
 							 case OBJECT_TYPE_ULTRA_DIR:
-							 	if (selected_proc->object_instance[i].attack_recycle_timestamp > w.world_time)
-          print_object_information(text_x2, text_y, COL_YELLOW, "recycle", (selected_proc->object_instance[i].attack_recycle_timestamp - w.world_time) / EXECUTION_COUNT, 1);
+							 	if (selected_proc->object_instance[i].attack_recycle_timestamp > dw->world_time)
+          print_object_information(text_x2, text_y, COL_YELLOW, "recycle", (selected_proc->object_instance[i].attack_recycle_timestamp - dw->world_time) / EXECUTION_COUNT, 1);
            else
             print_object_information(text_x2, text_y, COL_AQUA, "ready", 0, 0);
          break;
 							 case OBJECT_TYPE_STREAM:
 							 case OBJECT_TYPE_STREAM_DIR:
-							 	if (selected_proc->object_instance[i].attack_last_fire_timestamp >= w.world_time - STREAM_TOTAL_FIRING_TIME)
+							 	if (selected_proc->object_instance[i].attack_last_fire_timestamp >= dw->world_time - STREAM_TOTAL_FIRING_TIME)
           print_object_information(text_x2, text_y, COL_RED, "firing", 0, 0);
            else
 											{
-   							 	if (selected_proc->object_instance[i].attack_recycle_timestamp > w.world_time)
-             print_object_information(text_x2, text_y, COL_YELLOW, "recycle", (selected_proc->object_instance[i].attack_recycle_timestamp - w.world_time) / EXECUTION_COUNT, 1);
+   							 	if (selected_proc->object_instance[i].attack_recycle_timestamp > dw->world_time)
+             print_object_information(text_x2, text_y, COL_YELLOW, "recycle", (selected_proc->object_instance[i].attack_recycle_timestamp - dw->world_time) / EXECUTION_COUNT, 1);
               else
                print_object_information(text_x2, text_y, COL_AQUA, "ready", 0, 0);
 											}
 							 	break;
 							 case OBJECT_TYPE_SLICE:
-							 	if (selected_proc->object_instance[i].attack_last_fire_timestamp >= w.world_time - SLICE_TOTAL_FIRING_TIME)
+							 	if (selected_proc->object_instance[i].attack_last_fire_timestamp >= dw->world_time - SLICE_TOTAL_FIRING_TIME)
           print_object_information(text_x2, text_y, COL_RED, "firing", 0, 0);
            else
 											{
-   							 	if (selected_proc->object_instance[i].attack_recycle_timestamp > w.world_time)
-             print_object_information(text_x2, text_y, COL_YELLOW, "recycle", (selected_proc->object_instance[i].attack_recycle_timestamp - w.world_time) / EXECUTION_COUNT, 1);
+   							 	if (selected_proc->object_instance[i].attack_recycle_timestamp > dw->world_time)
+             print_object_information(text_x2, text_y, COL_YELLOW, "recycle", (selected_proc->object_instance[i].attack_recycle_timestamp - dw->world_time) / EXECUTION_COUNT, 1);
               else
                print_object_information(text_x2, text_y, COL_AQUA, "ready", 0, 0);
 											}
@@ -6662,8 +6643,8 @@ if (inter.block_mode_button_area_scrolling)
 //				if (time_since_selection > 12)
 //					time_since_selection = 12;
 
-   x = al_fixtof(w.data_well[command.selected_data_well].position.x - view.camera_x) * view.zoom;
-   y = al_fixtof(w.data_well[command.selected_data_well].position.y - view.camera_y) * view.zoom;
+   x = al_fixtof(dw->data_well[command.selected_data_well].position.x - view.camera_x) * view.zoom;
+   y = al_fixtof(dw->data_well[command.selected_data_well].position.y - view.camera_y) * view.zoom;
    x += view.window_x_unzoomed / 2;
    y += view.window_y_unzoomed / 2;
 
@@ -6699,21 +6680,21 @@ if (inter.block_mode_button_area_scrolling)
   al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_GREY] [SHADE_MAX], text_x, text_y + 10, ALLEGRO_ALIGN_LEFT, "data well");
 
   al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_ORANGE] [SHADE_MAX], text_x, (int) (text_y + BOX_HEADER_H + 7), ALLEGRO_ALIGN_LEFT, "data");
-  al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_ORANGE] [SHADE_MAX], text_x2, (int) (text_y + BOX_HEADER_H + 7), ALLEGRO_ALIGN_RIGHT, "%i (%i)", w.data_well[command.selected_data_well].data, w.data_well[command.selected_data_well].data_max);
+  al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_ORANGE] [SHADE_MAX], text_x2, (int) (text_y + BOX_HEADER_H + 7), ALLEGRO_ALIGN_RIGHT, "%i (%i)", dw->data_well[command.selected_data_well].data, dw->data_well[command.selected_data_well].data_max);
   text_y += BOX_LINE_H;
   al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_ORANGE] [SHADE_MAX], text_x, (int) (text_y + BOX_HEADER_H + 7), ALLEGRO_ALIGN_LEFT, "replenish");
   int replenish_rate = 0;
-  if (w.data_well[command.selected_data_well].reserve_data [0] > 0)
-			replenish_rate += w.data_well[command.selected_data_well].reserve_squares * DATA_WELL_REPLENISH_RATE;
-  if (w.data_well[command.selected_data_well].reserve_data [1] > 0)
-			replenish_rate += w.data_well[command.selected_data_well].reserve_squares * DATA_WELL_REPLENISH_RATE;
+  if (dw->data_well[command.selected_data_well].reserve_data [0] > 0)
+			replenish_rate += dw->data_well[command.selected_data_well].reserve_squares * DATA_WELL_REPLENISH_RATE;
+  if (dw->data_well[command.selected_data_well].reserve_data [1] > 0)
+			replenish_rate += dw->data_well[command.selected_data_well].reserve_squares * DATA_WELL_REPLENISH_RATE;
   al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_ORANGE] [SHADE_MAX], text_x2, (int) (text_y + BOX_HEADER_H + 7), ALLEGRO_ALIGN_RIGHT, "%i", replenish_rate);
   text_y += BOX_LINE_H;
   al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_ORANGE] [SHADE_MAX], text_x, (int) (text_y + BOX_HEADER_H + 7), ALLEGRO_ALIGN_LEFT, "reserve A");
-  al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_ORANGE] [SHADE_MAX], text_x2, (int) (text_y + BOX_HEADER_H + 7), ALLEGRO_ALIGN_RIGHT, "%i", w.data_well[command.selected_data_well].reserve_data [0]);
+  al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_ORANGE] [SHADE_MAX], text_x2, (int) (text_y + BOX_HEADER_H + 7), ALLEGRO_ALIGN_RIGHT, "%i", dw->data_well[command.selected_data_well].reserve_data [0]);
   text_y += BOX_LINE_H;
   al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_ORANGE] [SHADE_MAX], text_x, (int) (text_y + BOX_HEADER_H + 7), ALLEGRO_ALIGN_LEFT, "reserve B");
-  al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_ORANGE] [SHADE_MAX], text_x2, (int) (text_y + BOX_HEADER_H + 7), ALLEGRO_ALIGN_RIGHT, "%i", w.data_well[command.selected_data_well].reserve_data [1]);
+  al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_ORANGE] [SHADE_MAX], text_x2, (int) (text_y + BOX_HEADER_H + 7), ALLEGRO_ALIGN_RIGHT, "%i", dw->data_well[command.selected_data_well].reserve_data [1]);
 	}
 
  draw_vbuf(); // sends poly_buffer and line_buffer to the screen - do it here to make sure any selection graphics are drawn before the map
@@ -6721,7 +6702,7 @@ if (inter.block_mode_button_area_scrolling)
 #ifndef RECORDING_VIDEO_2
  draw_map();
 #else
- if (w.debug_mode == 1)
+ if (dw->debug_mode == 1)
 		draw_map();
 #endif
 //  al_draw_circle(view.window_x / 2, view.window_y / 2, 2, base_col [COL_GREY] [SHADE_MIN], 1);
@@ -6730,41 +6711,41 @@ if (inter.block_mode_button_area_scrolling)
 
 //  al_draw_textf(font[FONT_BASIC].fnt, colours.base [COL_GREY] [SHADE_HIGH], 2, 2, ALLEGRO_ALIGN_LEFT, "fps %i", view.fps);
 /*
-  if (w.players >= 2)
+  if (dw->players >= 2)
   {
    i = 1;
-//   al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "p %i(%i)", w.player[i].processes, w.procs_per_player);
-   al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "data %i", w.player[i].data);
+//   al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "p %i(%i)", dw->player[i].processes, dw->procs_per_player);
+   al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "data %i", dw->player[i].data);
    sx -= 80;
-   al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "%s", w.player[i].name);
+   al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "%s", dw->player[i].name);
    sx -= 90;
   }
 
   i = 0;
 // Player 1
-  al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "data %i", w.player[i].data);
+  al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "data %i", dw->player[i].data);
   sx -= 80;
-  al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "%s", w.player[i].name);
+  al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "%s", dw->player[i].name);
   sx -= 90;
 
-  if (w.players >= 3)
+  if (dw->players >= 3)
   {
    sx = STATUS_X;
    sy += 12;
 
-   if (w.players == 4)
+   if (dw->players == 4)
    {
     i = 3;
-    al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "data %i", w.player[i].data);
+    al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "data %i", dw->player[i].data);
     sx -= 80;
-    al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "%s", w.player[i].name);
+    al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "%s", dw->player[i].name);
     sx -= 90;
    }
 
    i = 2;
-   al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "data %i", w.player[i].data);
+   al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "data %i", dw->player[i].data);
    sx -= 80;
-   al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "%s", w.player[i].name);
+   al_draw_textf(font[FONT_SQUARE].fnt, text_col, sx, sy, ALLEGRO_ALIGN_RIGHT, "%s", dw->player[i].name);
    sx -= 90;
   }
 
@@ -6834,7 +6815,7 @@ if (inter.block_mode_button_area_scrolling)
      break;
     case GAME_END_PLAYER_WON:
      al_draw_textf(font[FONT_SQUARE_LARGE].fnt, colours.base [COL_GREY] [SHADE_MAX], view.window_x_unzoomed / 2, view.window_y_unzoomed / 2 - GO_LINE_1_Y, ALLEGRO_ALIGN_CENTRE, "GAME OVER");
-     al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_GREY] [SHADE_MAX], view.window_x_unzoomed / 2, view.window_y_unzoomed / 2 - GO_LINE_2_Y, ALLEGRO_ALIGN_CENTRE, "%s WINS!", w.player[game.game_over_value].name);
+     al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_GREY] [SHADE_MAX], view.window_x_unzoomed / 2, view.window_y_unzoomed / 2 - GO_LINE_2_Y, ALLEGRO_ALIGN_CENTRE, "%s WINS!", dw->player[game.game_over_value].name);
      break;
     case GAME_END_DRAW:
      al_draw_textf(font[FONT_SQUARE_LARGE].fnt, colours.base [COL_GREY] [SHADE_MAX], view.window_x_unzoomed / 2, view.window_y_unzoomed / 2 - GO_LINE_1_Y, ALLEGRO_ALIGN_CENTRE, "GAME OVER");
@@ -6860,7 +6841,7 @@ if (inter.block_mode_button_area_scrolling)
    if (view.following)
     al_draw_textf(font[FONT_SQUARE_LARGE].fnt, colours.base [COL_GREY] [SHADE_MAX], view.window_x_unzoomed / 2, view.window_y_unzoomed / 2 + LINE_1_Y + 90, ALLEGRO_ALIGN_CENTRE, "FOLLOWING");
 #endif
-//   if (view.under_attack_marker_last_time > w.world_time - UNDER_ATTACK_MARKER_DURATION)
+//   if (view.under_attack_marker_last_time > dw->world_time - UNDER_ATTACK_MARKER_DURATION)
 //    al_draw_textf(font[FONT_SQUARE_LARGE].fnt, colours.base [COL_RED] [SHADE_MAX], view.window_x_unzoomed / 2, view.window_y_unzoomed / 2 + LINE_1_Y + 80, ALLEGRO_ALIGN_CENTRE, "UNDER ATTACK");
    if (game.fast_forward > 0)
    {
@@ -6878,6 +6859,9 @@ if (inter.block_mode_button_area_scrolling)
 
  }
 
+ if (profile.on)
+		draw_profile_overlay();
+
  display_consoles_and_buttons();
 
 /*
@@ -6892,6 +6876,7 @@ if (inter.block_mode_button_area_scrolling)
   al_set_clipping_rectangle(0, 0, settings.option [OPTION_WINDOW_W], settings.option [OPTION_WINDOW_H]);
   draw_mouse_cursor();
 	}
+ vbuf_stream_end_frame();
  al_flip_display();
  al_set_target_bitmap(al_get_backbuffer(display));
 
@@ -7742,7 +7727,7 @@ static void draw_notional_group(struct template_struct* draw_templ, al_fixed wor
 static void draw_command_marker(int core_index)
 {
 
-	struct core_struct* core = &w.core[core_index];
+	struct core_struct* core = &dw->core[core_index];
 
 	int member_proc_index;
  int time_since_selection;
@@ -7784,24 +7769,24 @@ static void draw_command_marker(int core_index)
 
 			 break;
 		 case COM_TARGET:
-				 if (w.core[core->command_queue[queue_index].target_core].exists == 0
- 					|| w.core[core->command_queue[queue_index].target_core].created_timestamp != core->command_queue[queue_index].target_core_created
- 					|| !check_proc_visible_to_user(w.core[core->command_queue[queue_index].target_core].process_index))
+				 if (dw->core[core->command_queue[queue_index].target_core].exists == 0
+ 					|| dw->core[core->command_queue[queue_index].target_core].created_timestamp != core->command_queue[queue_index].target_core_created
+ 					|| !check_drawn_proc_visible_to_user(dw->core[core->command_queue[queue_index].target_core].process_index))
 					 continue;
 				 if (core->command_queue[queue_index].target_member == -1)
- 				 member_proc_index = w.core[core->command_queue[queue_index].target_core].process_index;
+ 				 member_proc_index = dw->core[core->command_queue[queue_index].target_core].process_index;
 				   else
 							{
-								if (!w.core[core->command_queue[queue_index].target_core].group_member [core->command_queue[queue_index].target_member].exists)
+								if (!dw->core[core->command_queue[queue_index].target_core].group_member [core->command_queue[queue_index].target_member].exists)
 									member_proc_index = -1;
 								  else
- 				      member_proc_index = w.core[core->command_queue[queue_index].target_core].group_member [core->command_queue[queue_index].target_member].index;
+ 				      member_proc_index = dw->core[core->command_queue[queue_index].target_core].group_member [core->command_queue[queue_index].target_member].index;
 							}
 				 if (member_proc_index == -1) // possible if member destroyed
  					continue; // or highlight core?
 
-     x = (al_fixtof(w.proc[member_proc_index].position.x - view.camera_x)) * view.zoom;
-     y = (al_fixtof(w.proc[member_proc_index].position.y - view.camera_y)) * view.zoom;
+     x = (al_fixtof(dw->proc[member_proc_index].position.x - view.camera_x)) * view.zoom;
+     y = (al_fixtof(dw->proc[member_proc_index].position.y - view.camera_y)) * view.zoom;
 
      x += view.window_x_unzoomed / 2;
      y += view.window_y_unzoomed / 2;
@@ -7824,14 +7809,14 @@ static void draw_command_marker(int core_index)
 
 			 break;
 		 case COM_FRIEND:
-				 if (w.core[core->command_queue[queue_index].target_core].exists == 0
- 					|| w.core[core->command_queue[queue_index].target_core].created_timestamp != core->command_queue[queue_index].target_core_created)
+				 if (dw->core[core->command_queue[queue_index].target_core].exists == 0
+ 					|| dw->core[core->command_queue[queue_index].target_core].created_timestamp != core->command_queue[queue_index].target_core_created)
 					 continue;
 // ignore target_member - just highlight core
-				 member_proc_index = w.core[core->command_queue[queue_index].target_core].process_index;
+				 member_proc_index = dw->core[core->command_queue[queue_index].target_core].process_index;
 
-     x = (al_fixtof(w.proc[member_proc_index].position.x - view.camera_x)) * view.zoom;
-     y = (al_fixtof(w.proc[member_proc_index].position.y - view.camera_y)) * view.zoom;
+     x = (al_fixtof(dw->proc[member_proc_index].position.x - view.camera_x)) * view.zoom;
+     y = (al_fixtof(dw->proc[member_proc_index].position.y - view.camera_y)) * view.zoom;
 
      x += view.window_x_unzoomed / 2;
      y += view.window_y_unzoomed / 2;
@@ -8171,7 +8156,7 @@ static unsigned int proc_rand(struct proc_struct* pr, int special, int mod)
 {
 
 // The mixture of int and al_fixed shouldn't matter.
- return (pr->position.x + pr->position.y + special + w.core[pr->core_index].execution_count) % mod;
+ return (pr->position.x + pr->position.y + special + dw->core[pr->core_index].execution_count) % mod;
 
 }*/
 
@@ -9196,17 +9181,17 @@ void draw_object(float proc_x, float proc_y,
 	  if (obj_inst != NULL) // will be NULL if this is being drawn on the design screen
 			{
 
-			if	(core->last_repair_restore_time > w.world_time - 32)
+			if	(core->last_repair_restore_time > dw->world_time - 32)
 			{
 // This could be repair or restore
-    int line_time = w.world_time - core->last_repair_restore_time;
+    int line_time = dw->world_time - core->last_repair_restore_time;
     outwards += (float) (32 - line_time) * 0.08;
 			}
 
 
-			if	(core->restore_cooldown_time > w.world_time)
+			if	(core->restore_cooldown_time > dw->world_time)
 			{
-				int time_until_cooldown_ends = core->restore_cooldown_time - w.world_time;
+				int time_until_cooldown_ends = core->restore_cooldown_time - dw->world_time;
 
     outwards += time_until_cooldown_ends * 0.03;
     if (outwards > 3)
@@ -9331,10 +9316,10 @@ void draw_object(float proc_x, float proc_y,
 				}
 
 				if (core != NULL
-					&&	core->restore_cooldown_time > w.world_time)
+					&&	core->restore_cooldown_time > dw->world_time)
 				{
 
-     int cooldown_time = core->restore_cooldown_time - w.world_time;
+     int cooldown_time = core->restore_cooldown_time - dw->world_time;
 
      int circle_time = (cooldown_time % 16);
 
@@ -9362,7 +9347,7 @@ void draw_object(float proc_x, float proc_y,
 	  if (obj_inst != NULL) // will be NULL if this is being drawn on the design screen
 			{
 
-    fire_time = w.world_time - obj_inst->attack_last_fire_timestamp;
+    fire_time = dw->world_time - obj_inst->attack_last_fire_timestamp;
     if (fire_time < 32)
 				{
      fire_outwards -= (float) (32 - fire_time) * 0.06;
@@ -9613,9 +9598,9 @@ void draw_object(float proc_x, float proc_y,
      if (core->interface_strength == core->interface_strength_max)
 						shade = 16;
 
-     if (core->interface_charged_time > w.world_time - 16)
+     if (core->interface_charged_time > dw->world_time - 16)
 					{
-      shade = 12 + 8 + (core->interface_charged_time + 16 - w.world_time) / 2;
+      shade = 12 + 8 + (core->interface_charged_time + 16 - dw->world_time) / 2;
 					}
 
      add_poly_layer(OBJECT_MAIN_LAYER, 5, colours.packet [core->player_index] [shade]);
@@ -9688,7 +9673,7 @@ void draw_object(float proc_x, float proc_y,
      f_angle = angle_float + dshape[proc_shape].link_object_angle [proc_link_index] + object_angle_offset;
 
 			  if (obj_inst != NULL // will be NULL if this is being drawn on the design screen
-						&& obj_inst->attack_last_fire_timestamp > w.world_time - 16)
+						&& obj_inst->attack_last_fire_timestamp > dw->world_time - 16)
 					{
 
 // first draw the underlay:
@@ -9705,7 +9690,7 @@ void draw_object(float proc_x, float proc_y,
 
 
 
-      float time_since_firing = w.world_time - obj_inst->attack_last_fire_timestamp;
+      float time_since_firing = dw->world_time - obj_inst->attack_last_fire_timestamp;
       float separation;
 
 							  separation = (16 - (time_since_firing)) / 2;
@@ -9858,7 +9843,7 @@ void draw_object(float proc_x, float proc_y,
      f_angle = angle_float + dshape[proc_shape].link_object_angle [proc_link_index] + object_angle_offset;
 
 			  if (obj_inst != NULL // will be NULL if this is being drawn on the design screen
-						&& obj_inst->attack_last_fire_timestamp > w.world_time - 16)
+						&& obj_inst->attack_last_fire_timestamp > dw->world_time - 16)
 					{
 
 // first draw the underlay:
@@ -9875,7 +9860,7 @@ void draw_object(float proc_x, float proc_y,
 
 
 
-      float time_since_firing = w.world_time - obj_inst->attack_last_fire_timestamp;
+      float time_since_firing = dw->world_time - obj_inst->attack_last_fire_timestamp;
       float separation;
 
 				  separation = (16 - (time_since_firing)) / 2;
@@ -10028,11 +10013,11 @@ void draw_object(float proc_x, float proc_y,
     float inner_point_y = proc_y + (sin(angle_float + dshape[proc_shape].link_point_angle [proc_link_index] [1]) * (dshape[proc_shape].link_point_dist [proc_link_index] [1])) * zoom;
 
 	  if (obj_inst != NULL // will be NULL if this is being drawn on the design screen
-//				&& core->last_build_time > w.world_time - 32)
-				&& core->build_cooldown_time > w.world_time)
+//				&& core->last_build_time > dw->world_time - 32)
+				&& core->build_cooldown_time > dw->world_time)
 			{
-				int time_since_build = w.world_time - core->last_build_time;
-				int time_until_cooldown_ends = core->build_cooldown_time - w.world_time;
+				int time_since_build = dw->world_time - core->last_build_time;
+				int time_until_cooldown_ends = core->build_cooldown_time - dw->world_time;
 /*
 
      shade = time_until_cooldown_ends;
@@ -10045,11 +10030,11 @@ void draw_object(float proc_x, float proc_y,
 
      radial_blob(4,
 																	inner_point_x + cos(angle_float + dshape[proc_shape].link_point_angle [proc_link_index] [1]) * 7 * zoom,
-																	inner_point_y + sin(angle_float + dshape[proc_shape].link_point_angle [proc_link_index] [1]) * 7 * zoom, 0, 12, colours.packet [core->player_index] [shade / 2], blob_size * 0.12, 4, w.world_time * 2, w.world_time * 3);
+																	inner_point_y + sin(angle_float + dshape[proc_shape].link_point_angle [proc_link_index] [1]) * 7 * zoom, 0, 12, colours.packet [core->player_index] [shade / 2], blob_size * 0.12, 4, dw->world_time * 2, dw->world_time * 3);
 
      radial_blob(4,
 																	inner_point_x + cos(angle_float + dshape[proc_shape].link_point_angle [proc_link_index] [1]) * 7 * zoom,
-																	inner_point_y + sin(angle_float + dshape[proc_shape].link_point_angle [proc_link_index] [1]) * 7 * zoom, 0, 12, colours.packet [core->player_index] [shade], blob_size * 0.06, 3, w.world_time * 2, w.world_time * 3);
+																	inner_point_y + sin(angle_float + dshape[proc_shape].link_point_angle [proc_link_index] [1]) * 7 * zoom, 0, 12, colours.packet [core->player_index] [shade], blob_size * 0.06, 3, dw->world_time * 2, dw->world_time * 3);
 */
 
     outwards += time_until_cooldown_ends * 0.03;
@@ -10148,13 +10133,13 @@ void draw_object(float proc_x, float proc_y,
 //#define BCOOL_APPROACH_1
 #ifdef BCOOL_APPROACH_1
 	  if (obj_inst != NULL // will be NULL if this is being drawn on the design screen
-//				&& core->last_build_time > w.world_time - 32)
-				&& core->build_cooldown_time > w.world_time)
+//				&& core->last_build_time > dw->world_time - 32)
+				&& core->build_cooldown_time > dw->world_time)
 			{
-				int time_since_build = w.world_time - core->last_build_time;
-				int time_until_cooldown_ends = core->build_cooldown_time - w.world_time;
+				int time_since_build = dw->world_time - core->last_build_time;
+				int time_until_cooldown_ends = core->build_cooldown_time - dw->world_time;
 
-    int line_time = w.world_time - core->last_build_time;
+    int line_time = dw->world_time - core->last_build_time;
     outwards += time_until_cooldown_ends * 0.03;
     if (outwards > 3)
 					outwards = 3;
@@ -10230,13 +10215,13 @@ void draw_object(float proc_x, float proc_y,
 #endif
 /*
 	  if (obj_inst != NULL // will be NULL if this is being drawn on the design screen
-//				&& core->last_build_time > w.world_time - 32)
-				&& core->build_cooldown_time > w.world_time)
+//				&& core->last_build_time > dw->world_time - 32)
+				&& core->build_cooldown_time > dw->world_time)
 			{
-				int time_since_build = w.world_time - core->last_build_time;
-				int time_until_cooldown_ends = core->build_cooldown_time - w.world_time;
+				int time_since_build = dw->world_time - core->last_build_time;
+				int time_until_cooldown_ends = core->build_cooldown_time - dw->world_time;
 
-    int line_time = w.world_time - core->last_build_time;
+    int line_time = dw->world_time - core->last_build_time;
     outwards += time_until_cooldown_ends * 0.03;
     if (outwards > 3)
 					outwards = 3;
@@ -10360,9 +10345,9 @@ void draw_object(float proc_x, float proc_y,
 
 		   float outwards = 0;
 		   if (obj_inst != NULL
-						&& w.world_time < core->build_cooldown)
+						&& dw->world_time < core->build_cooldown)
 					{
-      int line_time = core->build_cooldown - w.world_time;
+      int line_time = core->build_cooldown - dw->world_time;
       outwards = (float) (line_time) * 0.2;
       if (outwards > (32 * 0.2))
 							outwards = 32 * 0.2;
@@ -10482,20 +10467,20 @@ void draw_object(float proc_x, float proc_y,
 
 
 	  if (obj_inst == NULL
-				||	obj_inst->last_allocate < w.world_time - 32)
+				||	obj_inst->last_allocate < dw->world_time - 32)
 				break; // nothing to show
 			float vane_size; // 0 to 15
 			int vane_shade;
-	  if (obj_inst->first_unbroken_allocate > w.world_time - 16) // just started allocating
+	  if (obj_inst->first_unbroken_allocate > dw->world_time - 16) // just started allocating
 			{
-				vane_size = w.world_time - obj_inst->first_unbroken_allocate;
+				vane_size = dw->world_time - obj_inst->first_unbroken_allocate;
 				vane_shade = 31 - vane_size;
 			}
 			 else
 				{
-					if (obj_inst->last_allocate < w.world_time - 16)
+					if (obj_inst->last_allocate < dw->world_time - 16)
 					{
-						vane_size = 32 + obj_inst->last_allocate - w.world_time;
+						vane_size = 32 + obj_inst->last_allocate - dw->world_time;
   				vane_shade = vane_size;
 					}
 					 else
@@ -10507,7 +10492,7 @@ void draw_object(float proc_x, float proc_y,
 				vane_size *= 0.7 * zoom;
 				for (i = 0; i < 3; i ++)
 				{
-					float vane_angle = f_angle + (PI*0.6667) * i + ((w.world_time & 63) * PI/96);
+					float vane_angle = f_angle + (PI*0.6667) * i + ((dw->world_time & 63) * PI/96);
 					float vane_x = vx + cos(vane_angle) * 20 * zoom;
 					float vane_y = vy + sin(vane_angle) * 20 * zoom;
 					add_outline_diamond_layer(OBJECT_MAIN_LAYER, vane_x + cos(vane_angle - PI/6) * vane_size,
@@ -10584,7 +10569,7 @@ void draw_object(float proc_x, float proc_y,
 					{
 
 						int move_power_display = obj_inst->move_power;
-						int move_time = 16 - (core->next_execution_timestamp - w.world_time);
+						int move_time = 16 - (core->next_execution_timestamp - dw->world_time);
 
 					 if (obj_inst->move_power < obj_inst->move_power_last_cycle)
 					 {
@@ -10754,7 +10739,7 @@ void draw_object(float proc_x, float proc_y,
 
 
       radial_elongated_blob_10(OBJECT_OVER_LAYER, pulse_x, pulse_y, f_angle, colours.packet [proc->player_index] [6 + pulse_shade],
-																															pulse_size, 2, proc->position.x ^ w.world_time, proc->position.y);
+																															pulse_size, 2, proc->position.x ^ dw->world_time, proc->position.y);
 
 // inner part
    	  pulse_size = 1 + ((float) obj_inst->move_power / 40) + drand(30,1) * 0.1;
@@ -10766,11 +10751,11 @@ void draw_object(float proc_x, float proc_y,
 
 
 //      radial_elongated_blob_10(2, pulse_x, pulse_y, f_angle, colours.packet [proc->player_index] [6 + pulse_shade],
-//																															pulse_size, 2, (int) proc_x ^ w.world_time, proc_y);
+//																															pulse_size, 2, (int) proc_x ^ dw->world_time, proc_y);
 
       radial_blob(OBJECT_OVER_LAYER, pulse_x, pulse_y,
 																		f_angle, 8, colours.packet [proc->player_index] [18 + pulse_shade],
-																		pulse_size, 2, proc->position.x ^ w.world_time, proc->position.y);
+																		pulse_size, 2, proc->position.x ^ dw->world_time, proc->position.y);
 */
 					}
 
@@ -10805,7 +10790,7 @@ void draw_object(float proc_x, float proc_y,
      f_angle = angle_float + dshape[proc_shape].link_object_angle [proc_link_index] + object_angle_offset;
 
 			  if (obj_inst != NULL // will be NULL if this is being drawn on the design screen
-						&& obj_inst->attack_last_fire_timestamp > w.world_time - 16)
+						&& obj_inst->attack_last_fire_timestamp > dw->world_time - 16)
 					{
 
 // first draw the underlay:
@@ -10824,7 +10809,7 @@ void draw_object(float proc_x, float proc_y,
 
 
 
-      float time_since_firing = w.world_time - obj_inst->attack_last_fire_timestamp;
+      float time_since_firing = dw->world_time - obj_inst->attack_last_fire_timestamp;
       float separation;
 /*      if (time_since_firing < 4)
 							separation = time_since_firing;
@@ -11049,7 +11034,7 @@ void draw_object(float proc_x, float proc_y,
      f_angle = angle_float + dshape[proc_shape].link_object_angle [proc_link_index] + object_angle_offset;
 
 			  if (obj_inst != NULL // will be NULL if this is being drawn on the design screen
-						&& obj_inst->attack_last_fire_timestamp > w.world_time - 16)
+						&& obj_inst->attack_last_fire_timestamp > dw->world_time - 16)
 					{
 
 // first draw the underlay:
@@ -11066,7 +11051,7 @@ void draw_object(float proc_x, float proc_y,
 
 
 
-      float time_since_firing = w.world_time - obj_inst->attack_last_fire_timestamp;
+      float time_since_firing = dw->world_time - obj_inst->attack_last_fire_timestamp;
       float separation;
 / *      if (time_since_firing < 4)
 							separation = time_since_firing;
@@ -11249,7 +11234,7 @@ void draw_object(float proc_x, float proc_y,
 
 
 			  if (obj_inst != NULL // will be NULL if this is being drawn on the design screen
-						&& obj_inst->attack_last_fire_timestamp > w.world_time - STREAM_TOTAL_FIRING_TIME)
+						&& obj_inst->attack_last_fire_timestamp > dw->world_time - STREAM_TOTAL_FIRING_TIME)
 					{
        vertex_list [0] [0] = vx + cos(f_angle + PI) * 6 * zoom;
        vertex_list [0] [1] = vy + sin(f_angle + PI) * 6 * zoom;
@@ -11278,7 +11263,7 @@ void draw_object(float proc_x, float proc_y,
 
        add_poly_layer(OBJECT_MAIN_LAYER, 5, proc_col [PROC_COL_OBJECT_1]);
 
-       int side_angle_base = (w.world_time - obj_inst->attack_last_fire_timestamp);
+       int side_angle_base = (dw->world_time - obj_inst->attack_last_fire_timestamp);
 
        if (side_angle_base > 24)
 							{
@@ -11361,9 +11346,9 @@ void draw_object(float proc_x, float proc_y,
 							float back_separation_amount = 0.5;
 
 			  if (obj_inst != NULL // will be NULL if this is being drawn on the design screen
-						&& obj_inst->attack_last_fire_timestamp > w.world_time - 128)
+						&& obj_inst->attack_last_fire_timestamp > dw->world_time - 128)
 					{
-							float time_since_firing = w.world_time - obj_inst->attack_last_fire_timestamp;
+							float time_since_firing = dw->world_time - obj_inst->attack_last_fire_timestamp;
 							if (time_since_firing < 8)
 							{
 								side_separation_amount = time_since_firing / 4;
@@ -11534,9 +11519,9 @@ void draw_object(float proc_x, float proc_y,
 							float back_separation_amount = 0.5;
 
 			  if (obj_inst != NULL // will be NULL if this is being drawn on the design screen
-						&& obj_inst->attack_last_fire_timestamp > w.world_time - 128)
+						&& obj_inst->attack_last_fire_timestamp > dw->world_time - 128)
 					{
-							float time_since_firing = w.world_time - obj_inst->attack_last_fire_timestamp;
+							float time_since_firing = dw->world_time - obj_inst->attack_last_fire_timestamp;
 							if (time_since_firing < 8)
 							{
 								side_separation_amount = time_since_firing / 4;
@@ -11707,10 +11692,10 @@ void draw_object(float proc_x, float proc_y,
 
 	  if (obj_inst != NULL) // will be NULL if this is being drawn on the design screen
 			{
-				if (obj_inst->last_gather_or_give > w.world_time - (HARVEST_RECYCLE_TIME + 16)) // HARVEST_RECYCLE_TIME currently 64
+				if (obj_inst->last_gather_or_give > dw->world_time - (HARVEST_RECYCLE_TIME + 16)) // HARVEST_RECYCLE_TIME currently 64
 				{
 
-     int line_time = w.world_time - obj_inst->last_gather_or_give;
+     int line_time = dw->world_time - obj_inst->last_gather_or_give;
 
      int circle_time = (line_time % 32);
 
@@ -11757,16 +11742,16 @@ void draw_object(float proc_x, float proc_y,
 /*
      radial_blob(4,
 																	inner_point_x + cos(angle_float + dshape[proc_shape].link_point_angle [proc_link_index] [1]) * 7 * zoom,
-																	inner_point_y + sin(angle_float + dshape[proc_shape].link_point_angle [proc_link_index] [1]) * 7 * zoom, 0, 12, colours.packet [core->player_index] [shade / 2], (80 - line_time) * 0.12, 4, w.world_time * 2, w.world_time * 3);
+																	inner_point_y + sin(angle_float + dshape[proc_shape].link_point_angle [proc_link_index] [1]) * 7 * zoom, 0, 12, colours.packet [core->player_index] [shade / 2], (80 - line_time) * 0.12, 4, dw->world_time * 2, dw->world_time * 3);
 
      radial_blob(4,
 																	inner_point_x + cos(angle_float + dshape[proc_shape].link_point_angle [proc_link_index] [1]) * 7 * zoom,
-																	inner_point_y + sin(angle_float + dshape[proc_shape].link_point_angle [proc_link_index] [1]) * 7 * zoom, 0, 12, colours.packet [core->player_index] [shade], (80 - line_time) * 0.06, 3, w.world_time * 2, w.world_time * 3);
+																	inner_point_y + sin(angle_float + dshape[proc_shape].link_point_angle [proc_link_index] [1]) * 7 * zoom, 0, 12, colours.packet [core->player_index] [shade], (80 - line_time) * 0.06, 3, dw->world_time * 2, dw->world_time * 3);
 */
      if (line_time < 8)
 				 {
       outwards += (float) line_time * 0.16;
-      if (obj_inst->second_last_gather_or_give > w.world_time - 80)
+      if (obj_inst->second_last_gather_or_give > dw->world_time - 80)
        outer_outwards += 8 * 0.32;
         else
          outer_outwards += line_time * 0.32;
@@ -11820,7 +11805,7 @@ void draw_object(float proc_x, float proc_y,
 						}
 */
 /*
-				if (obj_inst->last_gather_or_give > w.world_time - 32)//HARVEST_LINE_TIME
+				if (obj_inst->last_gather_or_give > dw->world_time - 32)//HARVEST_LINE_TIME
 //				&& obj_inst->gather_or_give == 0) // gather
 			 {
      outwards += (float) (32 - line_time) * 0.08;
@@ -11913,11 +11898,11 @@ void draw_object(float proc_x, float proc_y,
      float outwards = 0;
 
 	  if (obj_inst != NULL // will be NULL if this is being drawn on the design screen
-				&& obj_inst->last_gather_or_give > w.world_time - HARVEST_LINE_TIME
+				&& obj_inst->last_gather_or_give > dw->world_time - HARVEST_LINE_TIME
 				&& obj_inst->gather_or_give == 0) // gather
 			{
 
-    int line_time = w.world_time - obj_inst->last_gather_or_give;
+    int line_time = dw->world_time - obj_inst->last_gather_or_give;
     outwards = (float) (HARVEST_LINE_TIME - line_time) * 0.2;
 
 			}
@@ -12317,6 +12302,42 @@ void check_vbuf(void)
 
 
 
+// Large flushes of vbuf are sent to the GPU through vertex and index buffers that stay allocated for the whole game.
+// Locking one of these buffers while the GPU may still be drawing from it can make the driver wait for the GPU (or copy the buffer),
+//  so each set of buffers is filled at most once a frame, and there's a set for each of the last VBUF_STREAM_FRAMES frames.
+//  A set isn't filled again until the game display has been flipped VBUF_STREAM_FRAMES times (see vbuf_stream_end_frame()).
+// This means that only the first flush each frame with at least VBUF_STREAM_MIN_INDICES indices is streamed (for the game display,
+//  this is the first part of the world view with much in it). Any other flush (the rest of the world view, consoles, buttons, the map and so on)
+//  is drawn from memory with al_draw_indexed_prim(), which is also used if the buffers can't be created (or locked).
+#define VBUF_STREAM_FRAMES 3
+#define VBUF_STREAM_MIN_INDICES 4096
+
+struct vbuf_stream_part_struct
+{
+ ALLEGRO_VERTEX_BUFFER* vertex_buffer [VBUF_STREAM_FRAMES];
+ ALLEGRO_INDEX_BUFFER* index_buffer [VBUF_STREAM_FRAMES];
+ int filled; // 1 if the set of buffers for this frame has already been filled
+ int streamed; // 1 if this frame's buffers hold what's in vbuf. If 0, vbuf is drawn from memory.
+ int index_start [DISPLAY_LAYERS]; // where each layer's indices start in index_buffer [vbuf_stream.frame]
+};
+
+struct vbuf_stream_struct
+{
+ int initialised;
+ ALLEGRO_VERTEX_DECL* vertex_decl; // describes struct vbuf_vertex_struct
+ int use_buffers; // 0 if the buffers couldn't be created
+ int frame; // the set of buffers used this frame
+ struct vbuf_stream_part_struct triangle;
+ struct vbuf_stream_part_struct line;
+};
+
+static struct vbuf_stream_struct vbuf_stream;
+
+static void init_vbuf_stream(void);
+static int create_vbuf_stream_part(struct vbuf_stream_part_struct* part);
+static void stream_vbuf_part(struct vbuf_stream_part_struct* part, struct vbuf_vertex_struct* vertex, int vertices, int index [DISPLAY_LAYERS] [VERTEX_INDEX_SIZE], int* index_pos, int first_layer, int last_layer);
+static void draw_vbuf_part_layer(struct vbuf_stream_part_struct* part, struct vbuf_vertex_struct* vertex, int index [DISPLAY_LAYERS] [VERTEX_INDEX_SIZE], int* index_pos, int layer, int prim_type);
+
 void draw_vbuf(void)
 {
 //al_hold_bitmap_drawing(1);
@@ -12324,40 +12345,271 @@ void draw_vbuf(void)
 //fprintf(stdout, "\ndraw_vbuf");
 	int i;
 
+ PROFILE_START(PROFILE_DRAW_VBUF);
+
+// each part is uploaded once, then drawn one layer at a time:
+ stream_vbuf_part(&vbuf_stream.triangle, vbuf.buffer_triangle, vbuf.vertex_pos_triangle, vbuf.index_triangle, vbuf.index_pos_triangle, 0, DISPLAY_LAYERS - 1);
+ stream_vbuf_part(&vbuf_stream.line, vbuf.buffer_line, vbuf.vertex_pos_line, vbuf.index_line, vbuf.index_pos_line, 0, DISPLAY_LAYERS - 1);
+
 	for (i = 0; i < DISPLAY_LAYERS; i ++)
 	{
 //  fprintf(stdout, "tp[%i] %i ", i, vbuf.index_pos_triangle [i]);
 
-		if (vbuf.index_pos_triangle [i] > 0)
-   al_draw_indexed_prim(vbuf.buffer_triangle,
-																							 NULL, // vertex declaration
-																							 NULL, // texture
-																							 vbuf.index_triangle [i],
-																							 vbuf.index_pos_triangle [i],
-																							 ALLEGRO_PRIM_TRIANGLE_LIST);
-//  if (game.pause_soft == 0)
-		vbuf.index_pos_triangle [i] = 0;
+// any cached background nodes in this layer go underneath everything else in it:
+  draw_back_cache_layer(i);
 
-
-		if (vbuf.index_pos_line [i] > 0)
-   al_draw_indexed_prim(vbuf.buffer_line,
-																							 NULL, // vertex declaration
-																							 NULL, // texture
-																							 vbuf.index_line [i],
-																							 vbuf.index_pos_line [i],
-																							 ALLEGRO_PRIM_LINE_LIST);
-// if (i == 0)
-  //fprintf(stdout, "lp[%i] %i ", i, vbuf.index_pos_line [i]);
-
-		vbuf.index_pos_line [i] = 0;
+  draw_vbuf_part_layer(&vbuf_stream.triangle, vbuf.buffer_triangle, vbuf.index_triangle, vbuf.index_pos_triangle, i, ALLEGRO_PRIM_TRIANGLE_LIST);
+  draw_vbuf_part_layer(&vbuf_stream.line, vbuf.buffer_line, vbuf.index_line, vbuf.index_pos_line, i, ALLEGRO_PRIM_LINE_LIST);
 
 	}
 
 	vbuf.vertex_pos_triangle = 0;
 	vbuf.vertex_pos_line = 0;
+
+	finish_back_cache_draw();
+
+ PROFILE_END(PROFILE_DRAW_VBUF);
 //al_hold_bitmap_drawing(0);
 }
 
+// Draws (and clears) the triangles in a single layer of vbuf. Doesn't reset the vertex position (draw_vbuf() does that).
+void draw_vbuf_triangles(int layer)
+{
+
+ stream_vbuf_part(&vbuf_stream.triangle, vbuf.buffer_triangle, vbuf.vertex_pos_triangle, vbuf.index_triangle, vbuf.index_pos_triangle, layer, layer);
+ draw_vbuf_part_layer(&vbuf_stream.triangle, vbuf.buffer_triangle, vbuf.index_triangle, vbuf.index_pos_triangle, layer, ALLEGRO_PRIM_TRIANGLE_LIST);
+
+}
+
+// Same as draw_vbuf_triangles() but for lines.
+void draw_vbuf_lines(int layer)
+{
+
+ stream_vbuf_part(&vbuf_stream.line, vbuf.buffer_line, vbuf.vertex_pos_line, vbuf.index_line, vbuf.index_pos_line, layer, layer);
+ draw_vbuf_part_layer(&vbuf_stream.line, vbuf.buffer_line, vbuf.index_line, vbuf.index_pos_line, layer, ALLEGRO_PRIM_LINE_LIST);
+
+}
+
+// Called just before the game display is flipped. Moves on to the next set of buffers, which was last filled VBUF_STREAM_FRAMES frames ago.
+// Other displays (menus, the editor etc.) don't call this, so after the first large flush they draw everything from memory.
+void vbuf_stream_end_frame(void)
+{
+
+ vbuf_stream.frame ++;
+ if (vbuf_stream.frame >= VBUF_STREAM_FRAMES)
+		vbuf_stream.frame = 0;
+
+ vbuf_stream.triangle.filled = 0;
+ vbuf_stream.line.filled = 0;
+
+}
+
+// Called the first time vbuf is drawn (the buffers need a display).
+static void init_vbuf_stream(void)
+{
+
+ ALLEGRO_VERTEX_ELEMENT vertex_elements [] =
+ {
+  {ALLEGRO_PRIM_POSITION, ALLEGRO_PRIM_FLOAT_2, offsetof(struct vbuf_vertex_struct, x)},
+  {ALLEGRO_PRIM_COLOR_ATTR, 0, offsetof(struct vbuf_vertex_struct, color)}, // storage is ignored for colours (it's always ALLEGRO_COLOR)
+  {0, 0, 0}
+ };
+
+ vbuf_stream.initialised = 1;
+
+ vbuf_stream.vertex_decl = al_create_vertex_decl(vertex_elements, sizeof(struct vbuf_vertex_struct));
+
+ if (vbuf_stream.vertex_decl == NULL)
+	{
+		fpr("\nError: i_display.c: init_vbuf_stream(): couldn't create vertex declaration.");
+		error_call();
+	}
+
+ vbuf_stream.use_buffers = create_vbuf_stream_part(&vbuf_stream.triangle)
+                        && create_vbuf_stream_part(&vbuf_stream.line);
+
+ if (!vbuf_stream.use_buffers)
+		fpr("\nVertex buffers not available; drawing from memory instead.");
+
+}
+
+// Returns 1 on success, 0 on failure (after destroying any buffers that were created).
+static int create_vbuf_stream_part(struct vbuf_stream_part_struct* part)
+{
+
+ int i;
+ int success = 1;
+
+ for (i = 0; i < VBUF_STREAM_FRAMES; i ++)
+	{
+		part->vertex_buffer [i] = al_create_vertex_buffer(vbuf_stream.vertex_decl, NULL, VERTEX_BUFFER_SIZE, ALLEGRO_PRIM_BUFFER_STREAM);
+		part->index_buffer [i] = al_create_index_buffer(sizeof(int), NULL, VERTEX_INDEX_SIZE * DISPLAY_LAYERS, ALLEGRO_PRIM_BUFFER_STREAM);
+		if (part->vertex_buffer [i] == NULL
+			|| part->index_buffer [i] == NULL)
+			success = 0;
+	}
+
+ if (success)
+		return 1;
+
+ for (i = 0; i < VBUF_STREAM_FRAMES; i ++)
+	{
+		if (part->vertex_buffer [i] != NULL)
+			al_destroy_vertex_buffer(part->vertex_buffer [i]);
+		if (part->index_buffer [i] != NULL)
+			al_destroy_index_buffer(part->index_buffer [i]);
+		part->vertex_buffer [i] = NULL;
+		part->index_buffer [i] = NULL;
+	}
+
+ return 0;
+
+}
+
+// Copies the vertices and the indices for layers first_layer to last_layer into this frame's set of buffers.
+// Sets part->streamed to 0 if this wasn't possible (or if the flush is too small to be worth streaming, or this frame's buffers have
+//  already been filled), in which case draw_vbuf_part_layer() draws from memory.
+static void stream_vbuf_part(struct vbuf_stream_part_struct* part, struct vbuf_vertex_struct* vertex, int vertices, int index [DISPLAY_LAYERS] [VERTEX_INDEX_SIZE], int* index_pos, int first_layer, int last_layer)
+{
+
+ int i;
+ int total_indices = 0;
+
+ if (!vbuf_stream.initialised)
+		init_vbuf_stream();
+
+ part->streamed = 0;
+
+ if (!vbuf_stream.use_buffers)
+		return;
+
+ for (i = first_layer; i <= last_layer; i ++)
+	{
+		part->index_start [i] = total_indices;
+		total_indices += index_pos [i];
+	}
+
+ if (total_indices < VBUF_STREAM_MIN_INDICES
+		|| vertices == 0
+		|| part->filled)
+		return;
+
+ part->filled = 1;
+
+ struct vbuf_vertex_struct* locked_vertices = al_lock_vertex_buffer(part->vertex_buffer [vbuf_stream.frame], 0, vertices, ALLEGRO_LOCK_WRITEONLY);
+
+ if (locked_vertices == NULL)
+		return;
+
+ memcpy(locked_vertices, vertex, vertices * sizeof(struct vbuf_vertex_struct));
+ al_unlock_vertex_buffer(part->vertex_buffer [vbuf_stream.frame]);
+
+ int* locked_indices = al_lock_index_buffer(part->index_buffer [vbuf_stream.frame], 0, total_indices, ALLEGRO_LOCK_WRITEONLY);
+
+ if (locked_indices == NULL)
+		return;
+
+ for (i = first_layer; i <= last_layer; i ++)
+	{
+		memcpy(locked_indices + part->index_start [i], index [i], index_pos [i] * sizeof(int));
+	}
+ al_unlock_index_buffer(part->index_buffer [vbuf_stream.frame]);
+
+ part->streamed = 1;
+
+}
+
+// Draws one layer of a part of vbuf, then clears that layer's indices.
+static void draw_vbuf_part_layer(struct vbuf_stream_part_struct* part, struct vbuf_vertex_struct* vertex, int index [DISPLAY_LAYERS] [VERTEX_INDEX_SIZE], int* index_pos, int layer, int prim_type)
+{
+
+ if (index_pos [layer] > 0)
+	{
+		if (part->streamed)
+   al_draw_indexed_buffer(part->vertex_buffer [vbuf_stream.frame],
+																										NULL, // texture
+																										part->index_buffer [vbuf_stream.frame],
+																										part->index_start [layer],
+																										part->index_start [layer] + index_pos [layer],
+																										prim_type);
+		 else
+    al_draw_indexed_prim(vertex,
+																									vbuf_stream.vertex_decl,
+																									NULL, // texture
+																									index [layer],
+																									index_pos [layer],
+																									prim_type);
+	}
+
+ index_pos [layer] = 0;
+
+}
+
+#define PROFILE_OVERLAY_X 10
+#define PROFILE_OVERLAY_Y 50
+#define PROFILE_OVERLAY_H 100
+// PROFILE_OVERLAY_MS is the time (in milliseconds) shown by a bar PROFILE_OVERLAY_H high - one frame at 60fps
+#define PROFILE_OVERLAY_MS 16.67
+
+// Draws the profiler's timing history for recent ticks (see m_profile.c) as a stacked bar for each tick, with averages for each phase underneath.
+// draw_vbuf time isn't stacked as it's part of the display time.
+static void draw_profile_overlay(void)
+{
+
+ int i, k;
+ float average [PROFILE_PHASES];
+ int average_cores = 0;
+ int phase_col [PROFILE_PHASES] = {COL_GREY, COL_GREEN, COL_RED, COL_YELLOW, COL_PURPLE, COL_BLUE, COL_CYAN};
+ float scale = PROFILE_OVERLAY_H / PROFILE_OVERLAY_MS;
+ float base_y = PROFILE_OVERLAY_Y + PROFILE_OVERLAY_H;
+
+ al_draw_filled_rectangle(PROFILE_OVERLAY_X, PROFILE_OVERLAY_Y, PROFILE_OVERLAY_X + PROFILE_HISTORY * 2, base_y + (PROFILE_PHASES + 2) * scaleUI_y(FONT_BASIC,12), colours.base [COL_BLUE] [SHADE_MIN]);
+ al_draw_line(PROFILE_OVERLAY_X, PROFILE_OVERLAY_Y, PROFILE_OVERLAY_X + PROFILE_HISTORY * 2, PROFILE_OVERLAY_Y, colours.base [COL_GREY] [SHADE_LOW], 1);
+
+ for (i = 0; i < PROFILE_PHASES; i ++)
+	{
+		average [i] = 0;
+	}
+
+// oldest tick on the left
+ for (k = 0; k < profile.history_length; k ++)
+	{
+		int h = profile.history_pos - profile.history_length + k;
+		if (h < 0)
+			h += PROFILE_HISTORY;
+		float x = PROFILE_OVERLAY_X + k * 2;
+		float y = base_y;
+		for (i = 0; i < PROFILE_PHASES; i ++)
+		{
+			average [i] += profile.history [h] [i];
+			if (i == PROFILE_DRAW_VBUF)
+				continue;
+			float bar_h = profile.history [h] [i] * scale;
+			if (y - bar_h < PROFILE_OVERLAY_Y)
+				bar_h = y - PROFILE_OVERLAY_Y;
+			if (bar_h > 0)
+				al_draw_filled_rectangle(x, y - bar_h, x + 2, y, colours.base [phase_col [i]] [SHADE_HIGH]);
+			y -= bar_h;
+		}
+		average_cores += profile.history_cores [h];
+	}
+
+ float text_y = base_y + 4;
+
+ for (i = 0; i < PROFILE_PHASES; i ++)
+	{
+		if (profile.history_length > 0)
+			average [i] /= profile.history_length;
+  al_draw_textf(font[FONT_BASIC].fnt, colours.base [phase_col [i]] [SHADE_MAX], PROFILE_OVERLAY_X + 4, text_y, ALLEGRO_ALIGN_LEFT, "%s %.3f ms", profile_phase_name [i], average [i]);
+  text_y += scaleUI_y(FONT_BASIC,12);
+	}
+
+	if (profile.history_length > 0)
+		average_cores /= profile.history_length;
+ al_draw_textf(font[FONT_BASIC].fnt, colours.base [COL_GREY] [SHADE_HIGH], PROFILE_OVERLAY_X + 4, text_y, ALLEGRO_ALIGN_LEFT, "cores executed %i", average_cores);
+
+}
+
 
 static void bloom_circle(int layer, float x, float y, ALLEGRO_COLOR col_centre, ALLEGRO_COLOR col_edge, float circle_size_zoomed)
 {
@@ -12831,7 +13083,7 @@ void add_outline_diamond_layer(int layer, float vx1, float vy1, float vx2, float
 }
 
 
-static void add_diamond_layer(int layer, float vx1, float vy1, float vx2, float vy2, float vx3, float vy3, float vx4, float vy4, ALLEGRO_COLOR fill_col)
+void add_diamond_layer(int layer, float vx1, float vy1, float vx2, float vy2, float vx3, float vy3, float vx4, float vy4, ALLEGRO_COLOR fill_col)
 {
 
 	int m = vbuf.vertex_pos_triangle;
@@ -12946,6 +13198,34 @@ static void add_filled_rectangle(int layer, float x1, float y1, float x2, float
 #define MAP_DETAIL_LAYER 2
 // MAP_DETAIL_LAYER must be different from VISION_CIRCLE_LAYER
 
+// The vision mask (vision_mask_map [MAP_MASK_DRAWN]) is only redrawn when the holes cut in it around the user's cores
+//  have changed since it was last drawn. Otherwise the bitmap from the last frame is used again.
+struct map_vision_circle_struct
+{
+	float x, y; // relative to the top left of the map
+	float size;
+};
+
+struct map_vision_cache_struct
+{
+	int valid; // set to 0 by reset_map_vision_cache() when the mask bitmaps that the vision mask is drawn from change
+	int opaque; // whether the mask was drawn from MAP_MASK_OPAQUE (rather than MAP_MASK_TRANS)
+	int circles;
+	struct map_vision_circle_struct circle [MAP_VERTICES];
+	int new_circles;
+	struct map_vision_circle_struct new_circle [MAP_VERTICES]; // circles for the current frame
+};
+
+static struct map_vision_cache_struct map_vision_cache;
+
+// Call whenever the bitmaps in vision_mask_map are redrawn (e.g. for a new map).
+void reset_map_vision_cache(void)
+{
+
+ map_vision_cache.valid = 0;
+
+}
+
 /*
 Can't use any of the drawing buffers except the basic line buffer
 (to change this, add tests for other buffers to the end of this function)
@@ -12969,10 +13249,10 @@ static void draw_map(void)
 // al_draw_filled_rectangle(map_base_x, map_base_y, map_base_x + MAP_W, map_base_y + MAP_H, al_map_rgb(10,20,40));
 // al_draw_rectangle(map_base_x, map_base_y, map_base_x + MAP_W, map_base_y + MAP_H, colours.base [COL_BLUE] [SHADE_HIGH], 1);
 
- if (w.world_seconds > 3599)
-  al_draw_textf(font[FONT_BASIC].fnt, colours.base [COL_GREY] [SHADE_HIGH], map_base_x + MAP_W, map_base_y - scaleUI_y(FONT_BASIC,12), ALLEGRO_ALIGN_RIGHT, "%i:%.2i:%.2i", w.world_seconds / 3600, (int) (w.world_seconds / 60) % 60, w.world_seconds % 60);
+ if (dw->world_seconds > 3599)
+  al_draw_textf(font[FONT_BASIC].fnt, colours.base [COL_GREY] [SHADE_HIGH], map_base_x + MAP_W, map_base_y - scaleUI_y(FONT_BASIC,12), ALLEGRO_ALIGN_RIGHT, "%i:%.2i:%.2i", dw->world_seconds / 3600, (int) (dw->world_seconds / 60) % 60, dw->world_seconds % 60);
    else
-    al_draw_textf(font[FONT_BASIC].fnt, colours.base [COL_GREY] [SHADE_HIGH], map_base_x + MAP_W, map_base_y - scaleUI_y(FONT_BASIC,12), ALLEGRO_ALIGN_RIGHT, "%i:%.2i", (int) (w.world_seconds / 60) % 60, w.world_seconds % 60);
+    al_draw_textf(font[FONT_BASIC].fnt, colours.base [COL_GREY] [SHADE_HIGH], map_base_x + MAP_W, map_base_y - scaleUI_y(FONT_BASIC,12), ALLEGRO_ALIGN_RIGHT, "%i:%.2i", (int) (dw->world_seconds / 60) % 60, dw->world_seconds % 60);
 
   al_draw_textf(font[FONT_BASIC].fnt, colours.base [COL_GREY] [SHADE_MED], map_base_x + MAP_W, map_base_y + MAP_H + 5, ALLEGRO_ALIGN_RIGHT, "fps %i", view.fps);
 
@@ -12985,14 +13265,15 @@ static void draw_map(void)
  ALLEGRO_VERTEX map_pixel [MAP_VERTICES];
 
 #ifdef SANITY_CHECK
- if (MAP_VERTICES < w.max_cores)
+ if (MAP_VERTICES < dw->max_cores)
 	{
-		fpr("\n Error: i_display.c: draw_map(): MAP_VERTICES (%i) less than w.max_cores (%i)", MAP_VERTICES, w.max_cores);
+		fpr("\n Error: i_display.c: draw_map(): MAP_VERTICES (%i) less than dw->max_cores (%i)", MAP_VERTICES, dw->max_cores);
 		error_call();
 	}
 #endif
 
  i = 0;
+ map_vision_cache.new_circles = 0;
 
  struct core_struct* core;
 
@@ -13005,9 +13286,9 @@ static void draw_map(void)
 // float xa, ya;
 
 
- for (c = 0; c < w.max_cores; c ++)
+ for (c = next_drawn_core(0); c != -1; c = next_drawn_core(c + 1))
  {
-  core = &w.core [c];
+  core = &dw->core [c];
   if (core->exists == 0)
    continue;
 
@@ -13109,25 +13390,24 @@ static void draw_map(void)
   }
 
 // prepare to draw holes in the vision mask around the player's cores:
-//  (these will actually be drawn below)
+//  (these will actually be drawn below, if they've changed)
   if (core->player_index == game.user_player_index)
 		{
 
  		vcircle_size = core->scan_range_float * al_fixtof(view.map_proportion_x);
- 		add_diagonal_octagon(VISION_CIRCLE_LAYER,
-																								  point_pos_x - map_base_x,
-																								  point_pos_y - map_base_y,
-																								  vcircle_size,
-																								  visible);
+ 		map_vision_cache.new_circle [map_vision_cache.new_circles].x = point_pos_x - map_base_x;
+ 		map_vision_cache.new_circle [map_vision_cache.new_circles].y = point_pos_y - map_base_y;
+ 		map_vision_cache.new_circle [map_vision_cache.new_circles].size = vcircle_size;
+ 		map_vision_cache.new_circles ++;
   }
 
 
  }
 
 /*
- for (c = 0; c < w.max_cores; c ++)
+ for (c = 0; c < dw->max_cores; c ++)
  {
-  core = &w.core [c];
+  core = &dw->core [c];
   if (core->exists == 0)
    continue;
 
@@ -13171,9 +13451,9 @@ static void draw_map(void)
  float last_x, last_y;
 
 // now draw map selection:
- for (c = 0; c < w.max_cores; c ++)
+ for (c = next_drawn_core(0); c != -1; c = next_drawn_core(c + 1))
  {
-  core = &w.core [c];
+  core = &dw->core [c];
   if (core->exists == 0
 			|| core->selected == -1)
    continue;
@@ -13249,19 +13529,19 @@ static void draw_map(void)
 
 					break;
 			 case COM_TARGET:
-			 	if (w.core[core->command_queue[j].target_core].exists <= 0
-						|| core->command_queue[j].target_core_created != w.core[core->command_queue[j].target_core].created_timestamp
-						|| !check_proc_visible_to_user(w.core[core->command_queue[j].target_core].process_index))
+			 	if (dw->core[core->command_queue[j].target_core].exists <= 0
+						|| core->command_queue[j].target_core_created != dw->core[core->command_queue[j].target_core].created_timestamp
+						|| !check_drawn_proc_visible_to_user(dw->core[core->command_queue[j].target_core].process_index))
 						break;
 			 	add_line(MAP_DETAIL_LAYER,
 														last_x,
 														last_y,
-														map_base_x + al_fixtof(al_fixmul(view.map_proportion_x, w.core[core->command_queue[j].target_core].core_position.x)),
-														map_base_y + al_fixtof(al_fixmul(view.map_proportion_y, w.core[core->command_queue[j].target_core].core_position.y)),
+														map_base_x + al_fixtof(al_fixmul(view.map_proportion_x, dw->core[core->command_queue[j].target_core].core_position.x)),
+														map_base_y + al_fixtof(al_fixmul(view.map_proportion_y, dw->core[core->command_queue[j].target_core].core_position.y)),
 														colours.base_trans [COL_RED] [SHADE_MED] [TRANS_MED]);
 
-														last_x = map_base_x + al_fixtof(al_fixmul(view.map_proportion_x, w.core[core->command_queue[j].target_core].core_position.x));
-														last_y = map_base_y + al_fixtof(al_fixmul(view.map_proportion_y, w.core[core->command_queue[j].target_core].core_position.y));
+														last_x = map_base_x + al_fixtof(al_fixmul(view.map_proportion_x, dw->core[core->command_queue[j].target_core].core_position.x));
+														last_y = map_base_y + al_fixtof(al_fixmul(view.map_proportion_y, dw->core[core->command_queue[j].target_core].core_position.y));
      map_pixel[i].x = last_x;
      map_pixel[i].y = last_y;
      map_pixel[i].z = 0;
@@ -13271,18 +13551,18 @@ static void draw_map(void)
 
 					break;
 			 case COM_FRIEND:
-			 	if (w.core[core->command_queue[j].target_core].exists <= 0
-						|| core->command_queue[j].target_core_created != w.core[core->command_queue[j].target_core].created_timestamp)
+			 	if (dw->core[core->command_queue[j].target_core].exists <= 0
+						|| core->command_queue[j].target_core_created != dw->core[core->command_queue[j].target_core].created_timestamp)
 						break;
 			 	add_line(MAP_DETAIL_LAYER,
 														last_x,
 														last_y,
-														map_base_x + al_fixtof(al_fixmul(view.map_proportion_x, w.core[core->command_queue[j].target_core].core_position.x)),
-														map_base_y + al_fixtof(al_fixmul(view.map_proportion_y, w.core[core->command_queue[j].target_core].core_position.y)),
+														map_base_x + al_fixtof(al_fixmul(view.map_proportion_x, dw->core[core->command_queue[j].target_core].core_position.x)),
+														map_base_y + al_fixtof(al_fixmul(view.map_proportion_y, dw->core[core->command_queue[j].target_core].core_position.y)),
 														colours.base_trans [COL_CYAN] [SHADE_MED] [TRANS_MED]);
 
-														last_x = map_base_x + al_fixtof(al_fixmul(view.map_proportion_x, w.core[core->command_queue[j].target_core].core_position.x));
-														last_y = map_base_y + al_fixtof(al_fixmul(view.map_proportion_y, w.core[core->command_queue[j].target_core].core_position.y));
+														last_x = map_base_x + al_fixtof(al_fixmul(view.map_proportion_x, dw->core[core->command_queue[j].target_core].core_position.x));
+														last_y = map_base_y + al_fixtof(al_fixmul(view.map_proportion_y, dw->core[core->command_queue[j].target_core].core_position.y));
      map_pixel[i].x = last_x;
      map_pixel[i].y = last_y;
      map_pixel[i].z = 0;
@@ -13309,34 +13589,50 @@ static void draw_map(void)
 
 // now draw the vision mask:
 
- al_set_target_bitmap(vision_mask_map [MAP_MASK_DRAWN]);
- al_set_blender(ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_INVERSE_ALPHA);
-
-// al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
+ int opaque_mask = 0;
 #ifndef RECORDING_VIDEO_2
  if (game.vision_mask
  	&& !mission_state.reveal_player1)
- 	al_draw_bitmap(vision_mask_map [MAP_MASK_OPAQUE], 0, 0, 0);
+		opaque_mask = 1;
+#endif
+
+ if (!map_vision_cache.valid
+		|| map_vision_cache.opaque != opaque_mask
+		|| map_vision_cache.circles != map_vision_cache.new_circles
+		|| memcmp(map_vision_cache.circle, map_vision_cache.new_circle, sizeof(struct map_vision_circle_struct) * map_vision_cache.new_circles) != 0)
+	{
+
+  for (c = 0; c < map_vision_cache.new_circles; c ++)
+		{
+ 		add_diagonal_octagon(VISION_CIRCLE_LAYER,
+																								  map_vision_cache.new_circle [c].x,
+																								  map_vision_cache.new_circle [c].y,
+																								  map_vision_cache.new_circle [c].size,
+																								  visible);
+		}
+
+  al_set_target_bitmap(vision_mask_map [MAP_MASK_DRAWN]);
+  al_set_blender(ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_INVERSE_ALPHA);
+
+// al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
+  if (opaque_mask)
+ 	 al_draw_bitmap(vision_mask_map [MAP_MASK_OPAQUE], 0, 0, 0);
 //  al_clear_to_color(colours.black);
-   else
-   	al_draw_bitmap(vision_mask_map [MAP_MASK_TRANS], 0, 0, 0);
+    else
+   	 al_draw_bitmap(vision_mask_map [MAP_MASK_TRANS], 0, 0, 0);
 //    al_clear_to_color(al_map_rgba(0,0,0,120));
-#else
-   	al_draw_bitmap(vision_mask_map [MAP_MASK_TRANS], 0, 0, 0);
-#endif
 
- al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
+  al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
 
 // this bit is code from draw_vbuf(), but just for a single layer:
-		if (vbuf.index_pos_triangle [VISION_CIRCLE_LAYER] > 0)
-   al_draw_indexed_prim(vbuf.buffer_triangle,
-																							 NULL, // vertex declaration
-																							 NULL, // texture
-																							 vbuf.index_triangle [VISION_CIRCLE_LAYER],
-																							 vbuf.index_pos_triangle [VISION_CIRCLE_LAYER],
-																							 ALLEGRO_PRIM_TRIANGLE_LIST);
-		vbuf.index_pos_triangle [VISION_CIRCLE_LAYER] = 0;
+		draw_vbuf_triangles(VISION_CIRCLE_LAYER);
+
+  map_vision_cache.valid = 1;
+  map_vision_cache.opaque = opaque_mask;
+  map_vision_cache.circles = map_vision_cache.new_circles;
+  memcpy(map_vision_cache.circle, map_vision_cache.new_circle, sizeof(struct map_vision_circle_struct) * map_vision_cache.new_circles);
 
+ }
 
  al_set_target_bitmap(al_get_backbuffer(display));
 // al_set_clipping_rectangle(0, 0, panel[PANEL_MAIN].w, panel[PANEL_MAIN].h);
@@ -13350,23 +13646,23 @@ static void draw_map(void)
 
 
 // add data wells:
- for (j = 0; j < w.data_wells; j ++)
+ for (j = 0; j < dw->data_wells; j ++)
 	{
-		 		add_orthogonal_hexagon(MAP_DETAIL_LAYER, map_base_x + al_fixtof(al_fixmul(view.map_proportion_x, w.data_well[j].position.x)),
-																												map_base_y + al_fixtof(al_fixmul(view.map_proportion_y, w.data_well[j].position.y)),
+		 		add_orthogonal_hexagon(MAP_DETAIL_LAYER, map_base_x + al_fixtof(al_fixmul(view.map_proportion_x, dw->data_well[j].position.x)),
+																												map_base_y + al_fixtof(al_fixmul(view.map_proportion_y, dw->data_well[j].position.y)),
 																												3,
 																												colours.base_trans [COL_YELLOW] [SHADE_HIGH] [TRANS_MED]);
 
 	}
 
 // add under attack markers
-  if (view.under_attack_marker_last_time >= w.world_time - UNDER_ATTACK_MARKER_DURATION)
+  if (view.under_attack_marker_last_time >= dw->world_time - UNDER_ATTACK_MARKER_DURATION)
 		{
 			for (i = 0; i < UNDER_ATTACK_MARKERS; i ++)
 			{
-				if (view.under_attack_marker [i].time_placed_world >= w.world_time - UNDER_ATTACK_MARKER_DURATION)
+				if (view.under_attack_marker [i].time_placed_world >= dw->world_time - UNDER_ATTACK_MARKER_DURATION)
 				{
-					int marker_shade = 31 - ((w.world_time - view.under_attack_marker [i].time_placed_world) % 32);
+					int marker_shade = 31 - ((dw->world_time - view.under_attack_marker [i].time_placed_world) % 32);
 
 		 		add_orthogonal_hexagon(MAP_DETAIL_LAYER, map_base_x + al_fixtof(al_fixmul(view.map_proportion_x, view.under_attack_marker[i].position.x)),
 																												map_base_y + al_fixtof(al_fixmul(view.map_proportion_y, view.under_attack_marker[i].position.y)),
@@ -13377,28 +13673,11 @@ static void draw_map(void)
 			}
 		}
 
-		if (vbuf.index_pos_triangle [MAP_DETAIL_LAYER] > 0)
-   al_draw_indexed_prim(vbuf.buffer_triangle,
-																							 NULL, // vertex declaration
-																							 NULL, // texture
-																							 vbuf.index_triangle [MAP_DETAIL_LAYER],
-																							 vbuf.index_pos_triangle [MAP_DETAIL_LAYER],
-																							 ALLEGRO_PRIM_TRIANGLE_LIST);
-		vbuf.index_pos_triangle [MAP_DETAIL_LAYER] = 0;
+		draw_vbuf_triangles(MAP_DETAIL_LAYER);
 
 
 
-	if (vbuf.index_pos_line [MAP_DETAIL_LAYER] > 0)
-	{
-   al_draw_indexed_prim(vbuf.buffer_line,
-																							 NULL, // vertex declaration
-																							 NULL, // texture
-																							 vbuf.index_line [MAP_DETAIL_LAYER],
-																							 vbuf.index_pos_line [MAP_DETAIL_LAYER],
-																							 ALLEGRO_PRIM_LINE_LIST);
-
-		vbuf.index_pos_line [MAP_DETAIL_LAYER] = 0;
-	}
+	draw_vbuf_lines(MAP_DETAIL_LAYER);
 
 // finally draw the box indicating what's on the screen:
  al_draw_rectangle(map_base_x + base_x - box_size_x/2, map_base_y + base_y - box_size_y/2, map_base_x + base_x + box_size_x/2, map_base_y + base_y + box_size_y/2,
@@ -13559,15 +13838,15 @@ static void draw_data_well_exclusion_zones(void)
  for (i = 0; i < DATA_WELLS; i ++)
 	{
 
-		if (w.data_well[i].active == 0)
+		if (dw->data_well[i].active == 0)
 			continue;
 
-  float x = al_fixtof(w.data_well[i].position.x - view.camera_x) * view.zoom;
-  float y = al_fixtof(w.data_well[i].position.y - view.camera_y) * view.zoom;
+  float x = al_fixtof(dw->data_well[i].position.x - view.camera_x) * view.zoom;
+  float y = al_fixtof(dw->data_well[i].position.y - view.camera_y) * view.zoom;
   x += view.window_x_unzoomed / 2;
   y += view.window_y_unzoomed / 2;
 
-  float exclusion_zone_pixels_zoomed = al_fixtof(w.data_well[i].static_build_exclusion) * view.zoom;
+  float exclusion_zone_pixels_zoomed = al_fixtof(dw->data_well[i].static_build_exclusion) * view.zoom;
 
   if (x < 0 - exclusion_zone_pixels_zoomed
 		 || x > view.window_x_unzoomed + exclusion_zone_pixels_zoomed
@@ -13808,13 +14087,7 @@ add_outline_diamond_layer(0,
 
    i = 0;
 
-   al_draw_indexed_prim(vbuf.buffer_triangle,
-																							 NULL, // vertex declaration
-																							 NULL, // texture
-																							 vbuf.index_triangle [i],
-																							 vbuf.index_pos_triangle [i],
-																							 ALLEGRO_PRIM_TRIANGLE_LIST);
-		vbuf.index_pos_triangle [i] = 0;
+   draw_vbuf_triangles(i);
 /*
    al_draw_indexed_prim(vbuf.buffer_line,
 																							 NULL, // vertex declaration
@@ -13907,7 +14180,7 @@ if (draw_triangle)
 
 // this function does the fog-of-war effect for the display routines
 // it ignores cores that are too far out of range
-// it doesn't affect the w.vision_area array and doesn't affect gameplay, so it doesn't have to be run if there's no fog-of-war.
+// it doesn't affect the dw->vision_area array and doesn't affect gameplay, so it doesn't have to be run if there's no fog-of-war.
 static void vision_check_for_display(void)
 {
 
@@ -13926,25 +14199,25 @@ static void vision_check_for_display(void)
 	if (block_min_y < 1)
 		block_min_y = 1;
 	int block_max_x = block_min_x + ((view.window_x_unzoomed / BLOCK_SIZE_PIXELS) / view.zoom) + 7;
-	if (block_max_x >= w.blocks.x - 1)
-		block_max_x = w.blocks.x - 1;
+	if (block_max_x >= dw->blocks.x - 1)
+		block_max_x = dw->blocks.x - 1;
 	int block_max_y = block_min_y + ((view.window_y_unzoomed / BLOCK_SIZE_PIXELS) / view.zoom) + 6;
-	if (block_max_y >= w.blocks.y - 1)
-		block_max_y = w.blocks.y - 1;
+	if (block_max_y >= dw->blocks.y - 1)
+		block_max_y = dw->blocks.y - 1;
 
-	for (c = w.player[game.user_player_index].core_index_start; c < w.player[game.user_player_index].core_index_end; c ++)
+	for (c = dw->player[game.user_player_index].core_index_start; c < dw->player[game.user_player_index].core_index_end; c ++)
 	{
-		if (w.core[c].exists <= 0
-			&& w.core[c].destroyed_timestamp < w.world_time - DEALLOCATE_COUNTER) // this means deallocating cores are still seen for a little while
+		if (dw->core[c].exists <= 0
+			&& dw->core[c].destroyed_timestamp < dw->world_time - DEALLOCATE_COUNTER) // this means deallocating cores are still seen for a little while
 			continue; // TO DO: vision areas generated by recently destroyed procs should shrink for a while
-		core = &w.core[c];
+		core = &dw->core[c];
 
 //#define VISION_SIZE_BLOCKS 6
 
-		base_min_x = w.proc[core->process_index].block_position.x - SCAN_RANGE_BASE_BLOCKS - 1;
-		base_min_y = w.proc[core->process_index].block_position.y - SCAN_RANGE_BASE_BLOCKS - 1;
-		base_max_x = w.proc[core->process_index].block_position.x + SCAN_RANGE_BASE_BLOCKS + 2;
-		base_max_y = w.proc[core->process_index].block_position.y + SCAN_RANGE_BASE_BLOCKS + 2;
+		base_min_x = dw->proc[core->process_index].block_position.x - SCAN_RANGE_BASE_BLOCKS - 1;
+		base_min_y = dw->proc[core->process_index].block_position.y - SCAN_RANGE_BASE_BLOCKS - 1;
+		base_max_x = dw->proc[core->process_index].block_position.x + SCAN_RANGE_BASE_BLOCKS + 2;
+		base_max_y = dw->proc[core->process_index].block_position.y + SCAN_RANGE_BASE_BLOCKS + 2;
 
 		if (base_min_x > block_max_x
 			|| base_min_y > block_max_y
@@ -13974,16 +14247,16 @@ static void vision_check_for_display(void)
 
 		int vision_range = al_fixtoi(core->scan_range_fixed) + 64;
 
-		if (w.core[c].exists <= 0)
+		if (dw->core[c].exists <= 0)
 		{
-			vision_range *= DEALLOCATE_COUNTER - (w.world_time - w.core[c].destroyed_timestamp);
+			vision_range *= DEALLOCATE_COUNTER - (dw->world_time - dw->core[c].destroyed_timestamp);
 			vision_range /= DEALLOCATE_COUNTER;
 		}
 		 else
 			{
-				if (w.core[c].created_timestamp > w.world_time - 16)
+				if (dw->core[c].created_timestamp > dw->world_time - 16)
 				{
-			  vision_range *= (w.world_time - w.core[c].created_timestamp);
+			  vision_range *= (dw->world_time - dw->core[c].created_timestamp);
 			  vision_range /= 16;
 				}
 			}
@@ -13992,9 +14265,9 @@ static void vision_check_for_display(void)
 		{
 		 for (j = min_y; j < max_y;	j ++)
 		 {
-//		 	struct block_struct* bl = &w.block[i][j];
+//		 	struct block_struct* bl = &dw->block[i][j];
 
-		 	if (w.vision_block[i][j].clear_time == w.world_time)
+		 	if (dw->vision_block[i][j].clear_time == dw->world_time)
 					continue;
 
     int dist_x = abs(core_x - (i * BLOCK_SIZE_PIXELS + (j&1) * (BLOCK_SIZE_PIXELS / 2)));
@@ -14018,25 +14291,25 @@ static void vision_check_for_display(void)
 
 
 
-				if (w.vision_block[i][j].proximity_time != w.world_time)
+				if (dw->vision_block[i][j].proximity_time != dw->world_time)
 				{
-					w.vision_block[i][j].proximity_time = w.world_time;
-					w.vision_block[i][j].proximity = 100000;
+					dw->vision_block[i][j].proximity_time = dw->world_time;
+					dw->vision_block[i][j].proximity = 100000;
 				}
 /*
 				if (dist < BLOCK_SIZE_PIXELS * 2)
 				{
-//		   w.block[i][j].vision_block_clear_time = w.world_time;
-//		   w.block[i][j].vision_block_proximity_time = w.world_time;
+//		   dw->block[i][j].vision_block_clear_time = dw->world_time;
+//		   dw->block[i][j].vision_block_proximity_time = dw->world_time;
 //					continue;
 				}*/
 
 				if (dist > vision_range)//BLOCK_SIZE_PIXELS * 5)
 				{
-//					if (bl->vision_block_proximity_time != w.world_time)
+//					if (bl->vision_block_proximity_time != dw->world_time)
 //					{
-//		    w.block[i][j].vision_block_clear_time = w.world_time;
-//					 bl->vision_block_proximity_time = w.world_time;
+//		    dw->block[i][j].vision_block_clear_time = dw->world_time;
+//					 bl->vision_block_proximity_time = dw->world_time;
 //					 bl->vision_block_proximity = 100000;
 //					}
 					continue;
@@ -14049,9 +14322,9 @@ static void vision_check_for_display(void)
 				if (dist < 0)
 					dist = 0;
 
-				w.vision_block[i][j].proximity_time = w.world_time;
-				if (w.vision_block[i][j].proximity > dist)
-					w.vision_block[i][j].proximity = dist;
+				dw->vision_block[i][j].proximity_time = dw->world_time;
+				if (dw->vision_block[i][j].proximity > dist)
+					dw->vision_block[i][j].proximity = dist;
 
 		 }
 		}
@@ -14064,11 +14337,11 @@ static void vision_check_for_display(void)
   if (clear_min_y < 0)
 			clear_min_y = 0;
   int clear_max_x = base_max_x;
-  if (clear_max_x > w.blocks.x)
-			clear_max_x = w.blocks.x;
+  if (clear_max_x > dw->blocks.x)
+			clear_max_x = dw->blocks.x;
   int clear_max_y = base_max_y;
-  if (clear_max_y > w.blocks.y)
-			clear_max_y = w.blocks.y;
+  if (clear_max_y > dw->blocks.y)
+			clear_max_y = dw->blocks.y;
 
 // clear out the centre:
 		for (j = clear_min_y + 2; j < clear_max_y - 2;	j ++)
@@ -14077,7 +14350,7 @@ static void vision_check_for_display(void)
 		 for (i = clear_min_x + 2; i < clear_max_x - 2;	i ++)
 //		 for (i = min_x; i < max_x;	i ++)
 		 {
-		   w.block[i][j].vision_block_clear_time = w.world_time;
+		   dw->block[i][j].vision_block_clear_time = dw->world_time;
 		 }
 		}
 
@@ -14116,7 +14389,7 @@ static void vision_check_for_display(void)
  		for (j = min_y + 1; j < max_y - 1;	j ++)
 	 	{
 	 		x_offset = (BLOCK_SIZE_PIXELS / 2) * !(j & 1);
-				vision_block_check(&w.block[column][j],
+				vision_block_check(&dw->block[column][j],
 																							(column * BLOCK_SIZE_PIXELS) + x_offset - core_x);
 	 	}
 
@@ -14125,7 +14398,7 @@ static void vision_check_for_display(void)
   		for (j = min_y + 1; j < max_y - 1;	j ++)
 	 	 {
  	 		x_offset = (BLOCK_SIZE_PIXELS / 2) * !(j & 1);
- 				vision_block_check(&w.block[min_x][j],
+ 				vision_block_check(&dw->block[min_x][j],
 																							 (min_x * BLOCK_SIZE_PIXELS) + x_offset - core_x);
 	 	 }
 		 }
@@ -14139,7 +14412,7 @@ static void vision_check_for_display(void)
  		for (j = min_y + 1; j < max_y - 1;	j ++)
 	 	{
 	 		x_offset = (BLOCK_SIZE_PIXELS / 2) * !(j & 1);
-				vision_block_check(&w.block[column][j],
+				vision_block_check(&dw->block[column][j],
 																						 (column * BLOCK_SIZE_PIXELS) + x_offset - core_x);
 	 	}
 
@@ -14149,7 +14422,7 @@ static void vision_check_for_display(void)
   		for (j = min_y + 1; j < max_y - 1;	j ++)
 	 	 {
  	 		x_offset = (BLOCK_SIZE_PIXELS / 2) * !(j & 1);
- 				vision_block_check(&w.block[column][j],
+ 				vision_block_check(&dw->block[column][j],
 																						 (column * BLOCK_SIZE_PIXELS) + x_offset - core_x);
 	 	 }
 		 }
@@ -14164,7 +14437,7 @@ static void vision_check_for_display(void)
 		{
  		for (i = min_x + 1; i < max_x - 1;	i ++)
 	 	{
-				vision_block_check(&w.block[i][row],
+				vision_block_check(&dw->block[i][row],
 																							(row * BLOCK_SIZE_PIXELS) - core_y);
 	 	}
 //   row = min_y + 1;
@@ -14172,7 +14445,7 @@ static void vision_check_for_display(void)
  		{
   		for (i = min_x + 1; i < max_x - 1;	i ++)
 	  	{
-			 	vision_block_check(&w.block[i][min_y],
+			 	vision_block_check(&dw->block[i][min_y],
 																							(min_y * BLOCK_SIZE_PIXELS) - core_y);
 	 	 }
 		 }
@@ -14186,7 +14459,7 @@ static void vision_check_for_display(void)
 		{
  		for (i = min_x + 1; i < max_x - 1;	i ++)
 	 	{
-				vision_block_check(&w.block[i][row],
+				vision_block_check(&dw->block[i][row],
 																							(row * BLOCK_SIZE_PIXELS) - core_y);
 	 	}
    row = max_y - 1;
@@ -14194,7 +14467,7 @@ static void vision_check_for_display(void)
 		 {
   		for (i = min_x + 1; i < max_x - 1;	i ++)
 	 	 {
- 				vision_block_check(&w.block[i][row],
+ 				vision_block_check(&dw->block[i][row],
 																							(row * BLOCK_SIZE_PIXELS) - core_y);
 	 	 }
 		 }
@@ -14204,32 +14477,32 @@ static void vision_check_for_display(void)
 		if (min_x <= base_min_x + 1)
 	 {
 		 if (min_y <= base_min_y + 1)
-    vision_block_check_corner(&w.block[min_x+1][min_y+1], ((min_x+1) * BLOCK_SIZE_PIXELS) - core_x, ((min_y+1) * BLOCK_SIZE_PIXELS) - core_y);
+    vision_block_check_corner(&dw->block[min_x+1][min_y+1], ((min_x+1) * BLOCK_SIZE_PIXELS) - core_x, ((min_y+1) * BLOCK_SIZE_PIXELS) - core_y);
 		 if (max_y >= base_max_y - 1)
-    vision_block_check_corner(&w.block[min_x+1][max_y-2], ((min_x+1) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-2) * BLOCK_SIZE_PIXELS) - core_y);
+    vision_block_check_corner(&dw->block[min_x+1][max_y-2], ((min_x+1) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-2) * BLOCK_SIZE_PIXELS) - core_y);
 
 			if (min_x == base_min_x)
 		 {
 			 if (min_y == base_min_y)
-     vision_block_check_corner(&w.block[min_x][min_y], (min_x * BLOCK_SIZE_PIXELS) - core_x, (min_y * BLOCK_SIZE_PIXELS) - core_y);
+     vision_block_check_corner(&dw->block[min_x][min_y], (min_x * BLOCK_SIZE_PIXELS) - core_x, (min_y * BLOCK_SIZE_PIXELS) - core_y);
 			 if (max_y == base_max_y)
-     vision_block_check_corner(&w.block[min_x][max_y-1], (min_x * BLOCK_SIZE_PIXELS) - core_x, ((max_y-1) * BLOCK_SIZE_PIXELS) - core_y);
+     vision_block_check_corner(&dw->block[min_x][max_y-1], (min_x * BLOCK_SIZE_PIXELS) - core_x, ((max_y-1) * BLOCK_SIZE_PIXELS) - core_y);
 		 }
 	 }
 
 		if (max_x >= base_max_x - 1)
 	 {
 		 if (min_y <= base_min_y + 1)
-    vision_block_check_corner(&w.block[max_x-2][min_y+1], ((max_x-2) * BLOCK_SIZE_PIXELS) - core_x, ((min_y+1) * BLOCK_SIZE_PIXELS) - core_y);
+    vision_block_check_corner(&dw->block[max_x-2][min_y+1], ((max_x-2) * BLOCK_SIZE_PIXELS) - core_x, ((min_y+1) * BLOCK_SIZE_PIXELS) - core_y);
 		 if (max_y >= base_max_y - 1)
-    vision_block_check_corner(&w.block[max_x-2][max_y-2], ((max_x-2) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-2) * BLOCK_SIZE_PIXELS) - core_y);
+    vision_block_check_corner(&dw->block[max_x-2][max_y-2], ((max_x-2) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-2) * BLOCK_SIZE_PIXELS) - core_y);
 
 			if (max_x == base_max_x)
 		 {
 			 if (min_y == base_min_y)
-     vision_block_check_corner(&w.block[max_x-1][min_y], ((max_x-1) * BLOCK_SIZE_PIXELS) - core_x, (min_y * BLOCK_SIZE_PIXELS) - core_y);
+     vision_block_check_corner(&dw->block[max_x-1][min_y], ((max_x-1) * BLOCK_SIZE_PIXELS) - core_x, (min_y * BLOCK_SIZE_PIXELS) - core_y);
 			 if (max_y == base_max_y)
-     vision_block_check_corner(&w.block[max_x-1][max_y-1], ((max_x-1) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-1) * BLOCK_SIZE_PIXELS) - core_y);
+     vision_block_check_corner(&dw->block[max_x-1][max_y-1], ((max_x-1) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-1) * BLOCK_SIZE_PIXELS) - core_y);
 		 }
 	 }
 */
@@ -14261,25 +14534,25 @@ static void vision_check_for_display(void)
 	if (block_min_y < 1)
 		block_min_y = 1;
 	int block_max_x = block_min_x + ((view.window_x_unzoomed / BLOCK_SIZE_PIXELS) / view.zoom) + 6;
-	if (block_max_x >= w.blocks.x - 1)
-		block_max_x = w.blocks.x - 1;
+	if (block_max_x >= dw->blocks.x - 1)
+		block_max_x = dw->blocks.x - 1;
 	int block_max_y = block_min_y + ((view.window_y_unzoomed / BLOCK_SIZE_PIXELS) / view.zoom) + 6;
-	if (block_max_y >= w.blocks.y - 1)
-		block_max_y = w.blocks.y - 1;
+	if (block_max_y >= dw->blocks.y - 1)
+		block_max_y = dw->blocks.y - 1;
 
-	for (c = w.player[game.user_player_index].core_index_start; c < w.player[game.user_player_index].core_index_end; c ++)
+	for (c = dw->player[game.user_player_index].core_index_start; c < dw->player[game.user_player_index].core_index_end; c ++)
 	{
-		if (w.core[c].exists <= 0
-			&& w.core[c].destroyed_timestamp < w.world_time - DEALLOCATE_COUNTER) // this means deallocating cores are still seen for a little while
+		if (dw->core[c].exists <= 0
+			&& dw->core[c].destroyed_timestamp < dw->world_time - DEALLOCATE_COUNTER) // this means deallocating cores are still seen for a little while
 			continue; // TO DO: vision areas generated by recently destroyed procs should shrink for a while
-		core = &w.core[c];
+		core = &dw->core[c];
 
 #define VISION_SIZE_BLOCKS 6
 
-		base_min_x = w.proc[core->process_index].block_position.x - VISION_SIZE_BLOCKS;
-		base_min_y = w.proc[core->process_index].block_position.y - VISION_SIZE_BLOCKS;
-		base_max_x = w.proc[core->process_index].block_position.x + VISION_SIZE_BLOCKS + 1;
-		base_max_y = w.proc[core->process_index].block_position.y + VISION_SIZE_BLOCKS + 1;
+		base_min_x = dw->proc[core->process_index].block_position.x - VISION_SIZE_BLOCKS;
+		base_min_y = dw->proc[core->process_index].block_position.y - VISION_SIZE_BLOCKS;
+		base_max_x = dw->proc[core->process_index].block_position.x + VISION_SIZE_BLOCKS + 1;
+		base_max_y = dw->proc[core->process_index].block_position.y + VISION_SIZE_BLOCKS + 1;
 
 		if (base_min_x > block_max_x
 			|| base_min_y > block_max_y
@@ -14311,11 +14584,11 @@ static void vision_check_for_display(void)
   if (clear_min_y < 0)
 			clear_min_y = 0;
   int clear_max_x = base_max_x;
-  if (clear_max_x > w.blocks.x)
-			clear_max_x = w.blocks.x;
+  if (clear_max_x > dw->blocks.x)
+			clear_max_x = dw->blocks.x;
   int clear_max_y = base_max_y;
-  if (clear_max_y > w.blocks.y)
-			clear_max_y = w.blocks.y;
+  if (clear_max_y > dw->blocks.y)
+			clear_max_y = dw->blocks.y;
 
 // clear out the centre:
 		for (j = clear_min_y + 2; j < clear_max_y - 2;	j ++)
@@ -14324,7 +14597,7 @@ static void vision_check_for_display(void)
 		 for (i = clear_min_x + 2; i < clear_max_x - 2;	i ++)
 //		 for (i = min_x; i < max_x;	i ++)
 		 {
-		   w.block[i][j].vision_block_clear_time = w.world_time;
+		   dw->block[i][j].vision_block_clear_time = dw->world_time;
 		 }
 		}
 
@@ -14356,18 +14629,18 @@ static void vision_check_for_display(void)
    column = min_x + 1;
  		for (j = min_y + 1; j < max_y - 1;	j ++)
 	 	{
-				vision_block_check(&w.block[column][j],
+				vision_block_check(&dw->block[column][j],
 																							(column * BLOCK_SIZE_PIXELS) - core_x,
-																							w.block[column][j].vision_block_x);
+																							dw->block[column][j].vision_block_x);
 	 	}
 
    if (min_x == base_min_x)
 		 {
   		for (j = min_y + 1; j < max_y - 1;	j ++)
 	 	 {
- 				vision_block_check(&w.block[min_x][j],
+ 				vision_block_check(&dw->block[min_x][j],
 																							 (min_x * BLOCK_SIZE_PIXELS) - core_x,
- 																							w.block[column][j].vision_block_x);
+ 																							dw->block[column][j].vision_block_x);
 	 	 }
 		 }
 		}
@@ -14379,9 +14652,9 @@ static void vision_check_for_display(void)
    column = max_x - 2;
  		for (j = min_y + 1; j < max_y - 1;	j ++)
 	 	{
-				vision_block_check(&w.block[column][j],
+				vision_block_check(&dw->block[column][j],
 																						 (column * BLOCK_SIZE_PIXELS) - core_x,
-																							w.block[column][j].vision_block_x);
+																							dw->block[column][j].vision_block_x);
 	 	}
 
    column = max_x - 1;
@@ -14389,9 +14662,9 @@ static void vision_check_for_display(void)
 		 {
   		for (j = min_y + 1; j < max_y - 1;	j ++)
 	 	 {
- 				vision_block_check(&w.block[column][j],
+ 				vision_block_check(&dw->block[column][j],
 																						 (column * BLOCK_SIZE_PIXELS) - core_x,
-																							w.block[column][j].vision_block_x);
+																							dw->block[column][j].vision_block_x);
 	 	 }
 		 }
 		}
@@ -14405,18 +14678,18 @@ static void vision_check_for_display(void)
 		{
  		for (i = min_x + 1; i < max_x - 1;	i ++)
 	 	{
-				vision_block_check(&w.block[i][row],
+				vision_block_check(&dw->block[i][row],
 																							(row * BLOCK_SIZE_PIXELS) - core_y,
-																							w.block[i][row].vision_block_y);
+																							dw->block[i][row].vision_block_y);
 	 	}
 //   row = min_y + 1;
 	  if (min_y == base_min_y)
  		{
   		for (i = min_x + 1; i < max_x - 1;	i ++)
 	  	{
-			 	vision_block_check(&w.block[i][min_y],
+			 	vision_block_check(&dw->block[i][min_y],
 																							(min_y * BLOCK_SIZE_PIXELS) - core_y,
-																							w.block[i][row].vision_block_y);
+																							dw->block[i][row].vision_block_y);
 	 	 }
 		 }
 		}
@@ -14429,18 +14702,18 @@ static void vision_check_for_display(void)
 		{
  		for (i = min_x + 1; i < max_x - 1;	i ++)
 	 	{
-				vision_block_check(&w.block[i][row],
+				vision_block_check(&dw->block[i][row],
 																							(row * BLOCK_SIZE_PIXELS) - core_y,
-																							w.block[i][row].vision_block_y);
+																							dw->block[i][row].vision_block_y);
 	 	}
    row = max_y - 1;
    if (max_y == base_max_y)
 		 {
   		for (i = min_x + 1; i < max_x - 1;	i ++)
 	 	 {
- 				vision_block_check(&w.block[i][row],
+ 				vision_block_check(&dw->block[i][row],
 																							(row * BLOCK_SIZE_PIXELS) - core_y,
-																							w.block[i][row].vision_block_y);
+																							dw->block[i][row].vision_block_y);
 	 	 }
 		 }
 		}
@@ -14449,32 +14722,32 @@ static void vision_check_for_display(void)
 		if (min_x <= base_min_x + 1)
 	 {
 		 if (min_y <= base_min_y + 1)
-    vision_block_check_corner(&w.block[min_x+1][min_y+1], ((min_x+1) * BLOCK_SIZE_PIXELS) - core_x, ((min_y+1) * BLOCK_SIZE_PIXELS) - core_y);
+    vision_block_check_corner(&dw->block[min_x+1][min_y+1], ((min_x+1) * BLOCK_SIZE_PIXELS) - core_x, ((min_y+1) * BLOCK_SIZE_PIXELS) - core_y);
 		 if (max_y >= base_max_y - 1)
-    vision_block_check_corner(&w.block[min_x+1][max_y-2], ((min_x+1) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-2) * BLOCK_SIZE_PIXELS) - core_y);
+    vision_block_check_corner(&dw->block[min_x+1][max_y-2], ((min_x+1) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-2) * BLOCK_SIZE_PIXELS) - core_y);
 
 			if (min_x == base_min_x)
 		 {
 			 if (min_y == base_min_y)
-     vision_block_check_corner(&w.block[min_x][min_y], (min_x * BLOCK_SIZE_PIXELS) - core_x, (min_y * BLOCK_SIZE_PIXELS) - core_y);
+     vision_block_check_corner(&dw->block[min_x][min_y], (min_x * BLOCK_SIZE_PIXELS) - core_x, (min_y * BLOCK_SIZE_PIXELS) - core_y);
 			 if (max_y == base_max_y)
-     vision_block_check_corner(&w.block[min_x][max_y-1], (min_x * BLOCK_SIZE_PIXELS) - core_x, ((max_y-1) * BLOCK_SIZE_PIXELS) - core_y);
+     vision_block_check_corner(&dw->block[min_x][max_y-1], (min_x * BLOCK_SIZE_PIXELS) - core_x, ((max_y-1) * BLOCK_SIZE_PIXELS) - core_y);
 		 }
 	 }
 
 		if (max_x >= base_max_x - 1)
 	 {
 		 if (min_y <= base_min_y + 1)
-    vision_block_check_corner(&w.block[max_x-2][min_y+1], ((max_x-2) * BLOCK_SIZE_PIXELS) - core_x, ((min_y+1) * BLOCK_SIZE_PIXELS) - core_y);
+    vision_block_check_corner(&dw->block[max_x-2][min_y+1], ((max_x-2) * BLOCK_SIZE_PIXELS) - core_x, ((min_y+1) * BLOCK_SIZE_PIXELS) - core_y);
 		 if (max_y >= base_max_y - 1)
-    vision_block_check_corner(&w.block[max_x-2][max_y-2], ((max_x-2) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-2) * BLOCK_SIZE_PIXELS) - core_y);
+    vision_block_check_corner(&dw->block[max_x-2][max_y-2], ((max_x-2) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-2) * BLOCK_SIZE_PIXELS) - core_y);
 
 			if (max_x == base_max_x)
 		 {
 			 if (min_y == base_min_y)
-     vision_block_check_corner(&w.block[max_x-1][min_y], ((max_x-1) * BLOCK_SIZE_PIXELS) - core_x, (min_y * BLOCK_SIZE_PIXELS) - core_y);
+     vision_block_check_corner(&dw->block[max_x-1][min_y], ((max_x-1) * BLOCK_SIZE_PIXELS) - core_x, (min_y * BLOCK_SIZE_PIXELS) - core_y);
 			 if (max_y == base_max_y)
-     vision_block_check_corner(&w.block[max_x-1][max_y-1], ((max_x-1) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-1) * BLOCK_SIZE_PIXELS) - core_y);
+     vision_block_check_corner(&dw->block[max_x-1][max_y-1], ((max_x-1) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-1) * BLOCK_SIZE_PIXELS) - core_y);
 		 }
 	 }
 
@@ -14525,8 +14798,8 @@ static void draw_data_well(int i, int j, struct backblock_struct* backbl,
 
 							if (backbl->backblock_type == BACKBLOCK_DATA_WELL_EDGE)
 							{
-								special_i = w.data_well[backbl->backblock_value].block_position.x;
-								special_j = w.data_well[backbl->backblock_value].block_position.y;
+								special_i = dw->data_well[backbl->backblock_value].block_position.x;
+								special_j = dw->data_well[backbl->backblock_value].block_position.y;
 							}
 							 else
 								{
@@ -14534,14 +14807,14 @@ static void draw_data_well(int i, int j, struct backblock_struct* backbl,
 									special_j = j;
 								}
 
-							float specific_zoom = view.zoom * w.backblock_parallax [2];
+							float specific_zoom = view.zoom * dw->backblock_parallax [2];
 
 							float bx3 [2];
 							float by3 [2];
 							float base_part_zoom [2];
 
-							base_part_zoom [0] = view.zoom * w.backblock_parallax [2];;
-							base_part_zoom [1] = view.zoom * w.backblock_parallax [3];;
+							base_part_zoom [0] = view.zoom * dw->backblock_parallax [2];;
+							base_part_zoom [1] = view.zoom * dw->backblock_parallax [3];;
 
        bx3 [0] = top_left_corner_x [2] + (BLOCK_SIZE_PIXELS * base_part_zoom [0]) * (special_i) + (BLOCK_SIZE_PIXELS/2) * base_part_zoom [0]; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
        by3 [0] = top_left_corner_y [2] + (BLOCK_SIZE_PIXELS * base_part_zoom [0]) * (special_j) + (BLOCK_SIZE_PIXELS/2) * base_part_zoom [0]; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
@@ -14562,15 +14835,15 @@ static void draw_data_well(int i, int j, struct backblock_struct* backbl,
 
 							 case -1: // this is drawn on top of the vision mask
 								 add_orthogonal_hexagon(4,
-																																top_left_corner_x [0] + (BLOCK_SIZE_PIXELS * view.zoom * w.backblock_parallax [0]) * (special_i) + (BLOCK_SIZE_PIXELS/2) * view.zoom * w.backblock_parallax [0],
-																																top_left_corner_y [0] + (BLOCK_SIZE_PIXELS * view.zoom * w.backblock_parallax [0]) * (special_j) + (BLOCK_SIZE_PIXELS/2) * view.zoom * w.backblock_parallax [0],
+																																top_left_corner_x [0] + (BLOCK_SIZE_PIXELS * view.zoom * dw->backblock_parallax [0]) * (special_i) + (BLOCK_SIZE_PIXELS/2) * view.zoom * dw->backblock_parallax [0],
+																																top_left_corner_y [0] + (BLOCK_SIZE_PIXELS * view.zoom * dw->backblock_parallax [0]) * (special_j) + (BLOCK_SIZE_PIXELS/2) * view.zoom * dw->backblock_parallax [0],
 																																								24,// - overlay_alpha * 0.02,
 																																								al_map_rgb(overlay_alpha * 0.5, overlay_alpha * 0.35, overlay_alpha * 0.15));
 																																								//al_map_rgba(200, 160, 100, overlay_alpha));
 
 								 add_orthogonal_hexagon(4,
-																																top_left_corner_x [0] + (BLOCK_SIZE_PIXELS * view.zoom * w.backblock_parallax [0]) * (special_i) + (BLOCK_SIZE_PIXELS/2) * view.zoom * w.backblock_parallax [0],
-																																top_left_corner_y [0] + (BLOCK_SIZE_PIXELS * view.zoom * w.backblock_parallax [0]) * (special_j) + (BLOCK_SIZE_PIXELS/2) * view.zoom * w.backblock_parallax [0],
+																																top_left_corner_x [0] + (BLOCK_SIZE_PIXELS * view.zoom * dw->backblock_parallax [0]) * (special_i) + (BLOCK_SIZE_PIXELS/2) * view.zoom * dw->backblock_parallax [0],
+																																top_left_corner_y [0] + (BLOCK_SIZE_PIXELS * view.zoom * dw->backblock_parallax [0]) * (special_j) + (BLOCK_SIZE_PIXELS/2) * view.zoom * dw->backblock_parallax [0],
 																																								20,// - overlay_alpha * 0.02,
 																																								colours.black);
 
@@ -14621,7 +14894,7 @@ static void draw_data_well(int i, int j, struct backblock_struct* backbl,
 
 
                             well_size = 40;
-                            specific_zoom = view.zoom * w.backblock_parallax [1];
+                            specific_zoom = view.zoom * dw->backblock_parallax [1];
 
                             bx2 = top_left_corner_x [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
@@ -14660,12 +14933,12 @@ static void draw_data_well(int i, int j, struct backblock_struct* backbl,
 
                             int transfer_colour_adjust;
 
-                            if (w.world_time - w.data_well[backbl->backblock_value].last_transferred < 32)
-                             transfer_colour_adjust = 32 - (w.world_time - w.data_well[backbl->backblock_value].last_transferred);
+                            if (dw->world_time - dw->data_well[backbl->backblock_value].last_transferred < 32)
+                             transfer_colour_adjust = 32 - (dw->world_time - dw->data_well[backbl->backblock_value].last_transferred);
                               else
                                transfer_colour_adjust = 0;
 
-                            if (w.data_well[backbl->backblock_value].data > 0)
+                            if (dw->data_well[backbl->backblock_value].data > 0)
                             {
 
                                 specific_zoom = view.zoom;
@@ -14673,15 +14946,15 @@ static void draw_data_well(int i, int j, struct backblock_struct* backbl,
                                 bx2 = top_left_corner_x [0] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                                 by2 = top_left_corner_y [0] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
 
-                                add_orthogonal_hexagon(2, bx2, by2, (30 * w.data_well[backbl->backblock_value].data * view.zoom) / w.data_well[backbl->backblock_value].data_max, map_rgba(220 + transfer_colour_adjust, 200 - transfer_colour_adjust, 50 - transfer_colour_adjust, 180 + transfer_colour_adjust));
+                                add_orthogonal_hexagon(2, bx2, by2, (30 * dw->data_well[backbl->backblock_value].data * view.zoom) / dw->data_well[backbl->backblock_value].data_max, map_rgba(220 + transfer_colour_adjust, 200 - transfer_colour_adjust, 50 - transfer_colour_adjust, 180 + transfer_colour_adjust));
                             }
 
-                            specific_zoom = view.zoom * w.backblock_parallax [1];
+                            specific_zoom = view.zoom * dw->backblock_parallax [1];
 
                             bx2 = top_left_corner_x [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
 
-                            float base_well_ring_angle = PI/6 + (w.world_time * w.data_well[backbl->backblock_value].spin_rate);
+                            float base_well_ring_angle = PI/6 + (dw->world_time * dw->data_well[backbl->backblock_value].spin_rate);
 #define WELL_RING_RADIUS (110)
                             ALLEGRO_COLOR reserve_colour;
 
@@ -14692,18 +14965,18 @@ static void draw_data_well(int i, int j, struct backblock_struct* backbl,
 
                             for (k = 0; k < DATA_WELL_RESERVES; k++)
                             {
-                                if (w.data_well[backbl->backblock_value].reserve_data [k] == 0)
+                                if (dw->data_well[backbl->backblock_value].reserve_data [k] == 0)
                                     continue;
                                 int l;
                                 float reserve_square_arc = 0.13;
                                 float reserve_square_length = 36;
-                                float reserve_data_proportion = w.data_well[backbl->backblock_value].reserve_data [k] * 0.002;
+                                float reserve_data_proportion = dw->data_well[backbl->backblock_value].reserve_data [k] * 0.002;
                                 reserve_square_length *= reserve_data_proportion;
                                 if (reserve_data_proportion < 1)
                                  reserve_square_arc *= reserve_data_proportion;
-                                for (l = 0; l < w.data_well[backbl->backblock_value].reserve_squares; l ++)
+                                for (l = 0; l < dw->data_well[backbl->backblock_value].reserve_squares; l ++)
                                 {
-                                    float square_angle = base_well_ring_angle + ((PI*2) / w.data_well[backbl->backblock_value].reserve_squares) * l;
+                                    float square_angle = base_well_ring_angle + ((PI*2) / dw->data_well[backbl->backblock_value].reserve_squares) * l;
                                     add_diamond_layer(1,
                                     bx2 + cos(square_angle - reserve_square_arc) * WELL_RING_RADIUS*specific_zoom,
                                     by2 + sin(square_angle - reserve_square_arc) * WELL_RING_RADIUS*specific_zoom,
@@ -14715,7 +14988,7 @@ static void draw_data_well(int i, int j, struct backblock_struct* backbl,
                                     by2 + sin(square_angle - reserve_square_arc) * (WELL_RING_RADIUS + reserve_square_length)*specific_zoom,
                                     reserve_colour);
                                 }
-                                base_well_ring_angle += PI / w.data_well[backbl->backblock_value].reserve_squares;
+                                base_well_ring_angle += PI / dw->data_well[backbl->backblock_value].reserve_squares;
                             }
 
 								}
@@ -14728,7 +15001,7 @@ default:
 
 
                             well_size = 140;
-                            specific_zoom = view.zoom * w.backblock_parallax [3];
+                            specific_zoom = view.zoom * dw->backblock_parallax [3];
 
                             bx2 = top_left_corner_x [3] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [3] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
@@ -14767,7 +15040,7 @@ default:
 
 
                             well_size = 140;
-                            specific_zoom = view.zoom * w.backblock_parallax [2];
+                            specific_zoom = view.zoom * dw->backblock_parallax [2];
 
                             bx2 = top_left_corner_x [2] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [2] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
@@ -14807,7 +15080,7 @@ default:
 
 
                             well_size = 40;
-                            specific_zoom = view.zoom * w.backblock_parallax [1];
+                            specific_zoom = view.zoom * dw->backblock_parallax [1];
 
                             bx2 = top_left_corner_x [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
@@ -14848,12 +15121,12 @@ default:
 
                             int transfer_colour_adjust;
 
-                            if (w.world_time - w.data_well[backbl->backblock_value].last_transferred < 32)
-                             transfer_colour_adjust = 32 - (w.world_time - w.data_well[backbl->backblock_value].last_transferred);
+                            if (dw->world_time - dw->data_well[backbl->backblock_value].last_transferred < 32)
+                             transfer_colour_adjust = 32 - (dw->world_time - dw->data_well[backbl->backblock_value].last_transferred);
                               else
                                transfer_colour_adjust = 0;
 
-                            if (w.data_well[backbl->backblock_value].data > 0)
+                            if (dw->data_well[backbl->backblock_value].data > 0)
                             {
 
                                 specific_zoom = view.zoom;
@@ -14861,15 +15134,15 @@ default:
                                 bx2 = top_left_corner_x [0] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                                 by2 = top_left_corner_y [0] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
 
-                                add_orthogonal_hexagon(2, bx2, by2, (30 * w.data_well[backbl->backblock_value].data * view.zoom) / w.data_well[backbl->backblock_value].data_max, al_map_rgba(220 + transfer_colour_adjust, 200 - transfer_colour_adjust, 50 - transfer_colour_adjust, 180 + transfer_colour_adjust));
+                                add_orthogonal_hexagon(2, bx2, by2, (30 * dw->data_well[backbl->backblock_value].data * view.zoom) / dw->data_well[backbl->backblock_value].data_max, al_map_rgba(220 + transfer_colour_adjust, 200 - transfer_colour_adjust, 50 - transfer_colour_adjust, 180 + transfer_colour_adjust));
                             }
 
-                            specific_zoom = view.zoom * w.backblock_parallax [1];
+                            specific_zoom = view.zoom * dw->backblock_parallax [1];
 
                             bx2 = top_left_corner_x [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
 
-                            float base_well_ring_angle = PI/6 + (w.world_time * w.data_well[backbl->backblock_value].spin_rate);
+                            float base_well_ring_angle = PI/6 + (dw->world_time * dw->data_well[backbl->backblock_value].spin_rate);
 
 #undef WELL_RING_RADIUS
 #define WELL_RING_RADIUS 140
@@ -14882,7 +15155,7 @@ default:
 
                             for (k = 0; k < DATA_WELL_RESERVES; k++)
                             {
-                                if (w.data_well[backbl->backblock_value].reserve_data [k] == 0)
+                                if (dw->data_well[backbl->backblock_value].reserve_data [k] == 0)
                                     continue;
                                 int l;
                                 float well_ring_radius;
@@ -14892,13 +15165,13 @@ default:
 																																	  well_ring_radius = 120 * specific_zoom;
                                 float reserve_square_arc = 0.26;
                                 float reserve_square_length = 18.0 * specific_zoom;
-                                float reserve_data_proportion = w.data_well[backbl->backblock_value].reserve_data [k] * 0.002;
+                                float reserve_data_proportion = dw->data_well[backbl->backblock_value].reserve_data [k] * 0.002;
                                 reserve_square_length *= reserve_data_proportion;
                                 if (reserve_data_proportion < 1)
                                  reserve_square_arc *= reserve_data_proportion;
-                                for (l = 0; l < w.data_well[backbl->backblock_value].reserve_squares; l ++)
+                                for (l = 0; l < dw->data_well[backbl->backblock_value].reserve_squares; l ++)
                                 {
-                                    float square_angle = base_well_ring_angle + ((PI*2) / w.data_well[backbl->backblock_value].reserve_squares) * l;
+                                    float square_angle = base_well_ring_angle + ((PI*2) / dw->data_well[backbl->backblock_value].reserve_squares) * l;
                                     add_diamond_layer(1,
                                     bx2 + cos(square_angle + reserve_square_arc) * well_ring_radius,
                                     by2 + sin(square_angle + reserve_square_arc) * well_ring_radius,
@@ -14910,7 +15183,7 @@ default:
                                     by2 + sin(square_angle) * (well_ring_radius - reserve_square_length),
                                     reserve_colour);
                                 }
-                                base_well_ring_angle += PI / w.data_well[backbl->backblock_value].reserve_squares;
+                                base_well_ring_angle += PI / dw->data_well[backbl->backblock_value].reserve_squares;
                             }
 
 
@@ -14942,7 +15215,7 @@ default:
 										{
 
 
-                            specific_zoom = view.zoom * w.backblock_parallax [k + 1];
+                            specific_zoom = view.zoom * dw->backblock_parallax [k + 1];
 
                             bx2 = top_left_corner_x [k + 1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [k + 1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
@@ -14991,12 +15264,12 @@ default:
 
                             int transfer_colour_adjust;
 
-                            if (w.world_time - w.data_well[backbl->backblock_value].last_transferred < 32)
-                             transfer_colour_adjust = 32 - (w.world_time - w.data_well[backbl->backblock_value].last_transferred);
+                            if (dw->world_time - dw->data_well[backbl->backblock_value].last_transferred < 32)
+                             transfer_colour_adjust = 32 - (dw->world_time - dw->data_well[backbl->backblock_value].last_transferred);
                               else
                                transfer_colour_adjust = 0;
 
-                            if (w.data_well[backbl->backblock_value].data > 0)
+                            if (dw->data_well[backbl->backblock_value].data > 0)
                             {
 
                                 specific_zoom = view.zoom;
@@ -15004,16 +15277,16 @@ default:
                                 bx2 = top_left_corner_x [0] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                                 by2 = top_left_corner_y [0] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
 
-                                add_orthogonal_hexagon(4, bx2, by2, (30 * w.data_well[backbl->backblock_value].data * view.zoom) / w.data_well[backbl->backblock_value].data_max, al_map_rgba(220 + transfer_colour_adjust, 200 - transfer_colour_adjust, 50 - transfer_colour_adjust, 180 + transfer_colour_adjust));
+                                add_orthogonal_hexagon(4, bx2, by2, (30 * dw->data_well[backbl->backblock_value].data * view.zoom) / dw->data_well[backbl->backblock_value].data_max, al_map_rgba(220 + transfer_colour_adjust, 200 - transfer_colour_adjust, 50 - transfer_colour_adjust, 180 + transfer_colour_adjust));
                             }
 
 
-                            specific_zoom = view.zoom * w.backblock_parallax [1];
+                            specific_zoom = view.zoom * dw->backblock_parallax [1];
 
                             bx2 = top_left_corner_x [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
 
-                            float base_well_ring_angle = PI/6 + (w.world_time * w.data_well[backbl->backblock_value].spin_rate);
+                            float base_well_ring_angle = PI/6 + (dw->world_time * dw->data_well[backbl->backblock_value].spin_rate);
 #undef WELL_RING_RADIUS
 #define WELL_RING_RADIUS (80)
                             ALLEGRO_COLOR reserve_colour;
@@ -15025,22 +15298,22 @@ default:
 
                             for (k = 0; k < DATA_WELL_RESERVES; k++)
                             {
-                                if (w.data_well[backbl->backblock_value].reserve_data [k] == 0)
+                                if (dw->data_well[backbl->backblock_value].reserve_data [k] == 0)
                                     continue;
                                 int l;
                                 float reserve_square_arc_inner = 0.16;
                                 float reserve_square_arc_outer = 0.13;
                                 float reserve_square_length = 42;
-                                float reserve_data_proportion = w.data_well[backbl->backblock_value].reserve_data [k] * 0.002;
+                                float reserve_data_proportion = dw->data_well[backbl->backblock_value].reserve_data [k] * 0.002;
                                 reserve_square_length *= reserve_data_proportion * specific_zoom;
                                 if (reserve_data_proportion < 1)
 																																{
                                  reserve_square_arc_inner *= reserve_data_proportion;
                                  reserve_square_arc_outer *= reserve_data_proportion;
 																																}
-                                for (l = 0; l < w.data_well[backbl->backblock_value].reserve_squares; l ++)
+                                for (l = 0; l < dw->data_well[backbl->backblock_value].reserve_squares; l ++)
                                 {
-                                    float square_angle = base_well_ring_angle + ((PI*2) / w.data_well[backbl->backblock_value].reserve_squares) * l;
+                                    float square_angle = base_well_ring_angle + ((PI*2) / dw->data_well[backbl->backblock_value].reserve_squares) * l;
                                     float square_dist = 70 * specific_zoom;//(80 + drand(60, 1)) * specific_zoom;
                                     float special_bx2 = bx2;// + (drand(60, 1) - 30) * specific_zoom;
                                     float special_by2 = by2;// + (drand(60, 1) - 30) * specific_zoom;
@@ -15055,7 +15328,7 @@ default:
                                     special_by2 + sin(square_angle - reserve_square_arc_outer) * (square_dist + reserve_square_length),
                                     reserve_colour);
                                 }
-                                base_well_ring_angle += PI / w.data_well[backbl->backblock_value].reserve_squares;
+                                base_well_ring_angle += PI / dw->data_well[backbl->backblock_value].reserve_squares;
                             }
 
 
@@ -15070,7 +15343,7 @@ default:
 
 
 #define ORANGE_WELL_BASE_LAYER 2
-                            specific_zoom = view.zoom * w.backblock_parallax [ORANGE_WELL_BASE_LAYER];
+                            specific_zoom = view.zoom * dw->backblock_parallax [ORANGE_WELL_BASE_LAYER];
 
                             bx2 = top_left_corner_x [ORANGE_WELL_BASE_LAYER] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [ORANGE_WELL_BASE_LAYER] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
@@ -15078,7 +15351,7 @@ default:
                             add_orthogonal_hexagon(1, bx2, by2, 112 * specific_zoom, colours.data_well_hexes [1]);
                             add_orthogonal_hexagon(1, bx2, by2, 80 * specific_zoom, colours.world_background);
 
-                            specific_zoom = view.zoom * w.backblock_parallax [1];
+                            specific_zoom = view.zoom * dw->backblock_parallax [1];
 
                             bx2 = top_left_corner_x [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
@@ -15094,7 +15367,7 @@ default:
                                 float base_dist = 36;//drand(30, special_i) + 24;
                                 well_size = base_dist + 22;
 
-                                float base_angle = (float) w.world_time * w.data_well [backbl->backblock_value].spin_rate;
+                                float base_angle = (float) dw->world_time * dw->data_well [backbl->backblock_value].spin_rate;
 
 
                                 float left_xpart = cos(base_angle + (PI/3)*k + 0.05) * specific_zoom;
@@ -15151,12 +15424,12 @@ default:
 
                             int transfer_colour_adjust;
 
-                            if (w.world_time - w.data_well[backbl->backblock_value].last_transferred < 32)
-                             transfer_colour_adjust = 32 - (w.world_time - w.data_well[backbl->backblock_value].last_transferred);
+                            if (dw->world_time - dw->data_well[backbl->backblock_value].last_transferred < 32)
+                             transfer_colour_adjust = 32 - (dw->world_time - dw->data_well[backbl->backblock_value].last_transferred);
                               else
                                transfer_colour_adjust = 0;
 
-                            if (w.data_well[backbl->backblock_value].data > 0)
+                            if (dw->data_well[backbl->backblock_value].data > 0)
                             {
 
                                 specific_zoom = view.zoom;
@@ -15164,15 +15437,15 @@ default:
                                 bx2 = top_left_corner_x [0] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                                 by2 = top_left_corner_y [0] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
 
-                                add_orthogonal_hexagon(2, bx2, by2, (30 * w.data_well[backbl->backblock_value].data * view.zoom) / w.data_well[backbl->backblock_value].data_max, al_map_rgba(220 + transfer_colour_adjust, 200 - transfer_colour_adjust, 50 - transfer_colour_adjust, 180 + transfer_colour_adjust));
+                                add_orthogonal_hexagon(2, bx2, by2, (30 * dw->data_well[backbl->backblock_value].data * view.zoom) / dw->data_well[backbl->backblock_value].data_max, al_map_rgba(220 + transfer_colour_adjust, 200 - transfer_colour_adjust, 50 - transfer_colour_adjust, 180 + transfer_colour_adjust));
                             }
 
-                            specific_zoom = view.zoom * w.backblock_parallax [1];
+                            specific_zoom = view.zoom * dw->backblock_parallax [1];
 
                             bx2 = top_left_corner_x [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
 
-//                            float base_well_ring_angle = PI/6 + (w.world_time * w.data_well[backbl->backblock_value].spin_rate);
+//                            float base_well_ring_angle = PI/6 + (dw->world_time * dw->data_well[backbl->backblock_value].spin_rate);
 //#define WELL_ORANGE_RING_RADIUS (140)
 /*                            ALLEGRO_COLOR reserve_colour;
 
@@ -15184,23 +15457,23 @@ default:
                             for (k = 0; k < DATA_WELL_RESERVES; k++)
                             {
 
-                                if (w.data_well[backbl->backblock_value].reserve_data [k] == 0)
+                                if (dw->data_well[backbl->backblock_value].reserve_data [k] == 0)
                                     continue;
 
                                 int l;
 
 																																float circle_base_rad = 220 - k * 70;
 
-																																int circle_distribution = w.data_well[backbl->backblock_value].reserve_squares * 24;
+																																int circle_distribution = dw->data_well[backbl->backblock_value].reserve_squares * 24;
 
-																																float circle_thickness = w.data_well[backbl->backblock_value].reserve_data [k] * 0.005;
+																																float circle_thickness = dw->data_well[backbl->backblock_value].reserve_data [k] * 0.005;
 																																if (circle_thickness > 10)
 																																	circle_thickness = 10;
 
-                                for (l = 0; l < w.data_well[backbl->backblock_value].reserve_squares * 2; l ++)
+                                for (l = 0; l < dw->data_well[backbl->backblock_value].reserve_squares * 2; l ++)
                                 {
 
-                                	float circle_rad = ((w.world_time) + (l * 24)) % (circle_distribution * 2);
+                                	float circle_rad = ((dw->world_time) + (l * 24)) % (circle_distribution * 2);
                                 	circle_rad *= 0.5;
 
                                 	int circle_alpha;
@@ -15226,13 +15499,13 @@ default:
                                 int l;
                                 float reserve_square_arc = 0.13;
                                 float reserve_square_length = 36;
-                                float reserve_data_proportion = w.data_well[backbl->backblock_value].reserve_data [k] * 0.002;
+                                float reserve_data_proportion = dw->data_well[backbl->backblock_value].reserve_data [k] * 0.002;
                                 reserve_square_length *= reserve_data_proportion;
                                 if (reserve_data_proportion < 1)
                                  reserve_square_arc *= reserve_data_proportion;
-                                for (l = 0; l < w.data_well[backbl->backblock_value].reserve_squares; l ++)
+                                for (l = 0; l < dw->data_well[backbl->backblock_value].reserve_squares; l ++)
                                 {
-                                    float square_angle = base_well_ring_angle + ((PI*2) / w.data_well[backbl->backblock_value].reserve_squares) * l;
+                                    float square_angle = base_well_ring_angle + ((PI*2) / dw->data_well[backbl->backblock_value].reserve_squares) * l;
                                     add_diamond_layer(1,
                                     bx2 + cos(square_angle - reserve_square_arc) * WELL_RING_RADIUS*specific_zoom,
                                     by2 + sin(square_angle - reserve_square_arc) * WELL_RING_RADIUS*specific_zoom,
@@ -15244,7 +15517,7 @@ default:
                                     by2 + sin(square_angle - reserve_square_arc) * (WELL_RING_RADIUS + reserve_square_length)*specific_zoom,
                                     reserve_colour);
                                 }
-                                base_well_ring_angle += PI / w.data_well[backbl->backblock_value].reserve_squares;
+                                base_well_ring_angle += PI / dw->data_well[backbl->backblock_value].reserve_squares;
 
 */
                             }
@@ -15260,7 +15533,7 @@ default:
 
 
 
-                            specific_zoom = view.zoom * w.backblock_parallax [1];
+                            specific_zoom = view.zoom * dw->backblock_parallax [1];
 
                             bx2 = top_left_corner_x [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
@@ -15319,12 +15592,12 @@ default:
 
                             int transfer_colour_adjust;
 
-                            if (w.world_time - w.data_well[backbl->backblock_value].last_transferred < 32)
-                             transfer_colour_adjust = 32 - (w.world_time - w.data_well[backbl->backblock_value].last_transferred);
+                            if (dw->world_time - dw->data_well[backbl->backblock_value].last_transferred < 32)
+                             transfer_colour_adjust = 32 - (dw->world_time - dw->data_well[backbl->backblock_value].last_transferred);
                               else
                                transfer_colour_adjust = 0;
 
-                            if (w.data_well[backbl->backblock_value].data > 0)
+                            if (dw->data_well[backbl->backblock_value].data > 0)
                             {
 
                                 specific_zoom = view.zoom;
@@ -15332,10 +15605,10 @@ default:
                                 bx2 = top_left_corner_x [0] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                                 by2 = top_left_corner_y [0] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
 
-                                add_orthogonal_hexagon(2, bx2, by2, (30 * w.data_well[backbl->backblock_value].data * view.zoom) / w.data_well[backbl->backblock_value].data_max, al_map_rgba(220 + transfer_colour_adjust, 200 - transfer_colour_adjust, 50 - transfer_colour_adjust, 180 + transfer_colour_adjust));
+                                add_orthogonal_hexagon(2, bx2, by2, (30 * dw->data_well[backbl->backblock_value].data * view.zoom) / dw->data_well[backbl->backblock_value].data_max, al_map_rgba(220 + transfer_colour_adjust, 200 - transfer_colour_adjust, 50 - transfer_colour_adjust, 180 + transfer_colour_adjust));
                             }
 
-                            specific_zoom = view.zoom * w.backblock_parallax [1];
+                            specific_zoom = view.zoom * dw->backblock_parallax [1];
 
                             bx2 = top_left_corner_x [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
@@ -15350,15 +15623,15 @@ default:
 
                             for (k = 0; k < DATA_WELL_RESERVES; k++)
                             {
-                                if (w.data_well[backbl->backblock_value].reserve_data [k] == 0)
+                                if (dw->data_well[backbl->backblock_value].reserve_data [k] == 0)
                                     continue;
                                 int l;
                                 float reserve_square_arc_inner;// = 0.16;
                                 float reserve_square_arc_outer;// = 0.13;
                                 float reserve_square_length = 42;
-                                float reserve_data_proportion = w.data_well[backbl->backblock_value].reserve_data [k] * 0.001;
+                                float reserve_data_proportion = dw->data_well[backbl->backblock_value].reserve_data [k] * 0.001;
                                 float base_dist, base_well_ring_angle;
-//                                base_well_ring_angle += (PI / w.data_well[backbl->backblock_value].reserve_squares) * l;
+//                                base_well_ring_angle += (PI / dw->data_well[backbl->backblock_value].reserve_squares) * l;
                                 reserve_square_length *= reserve_data_proportion * specific_zoom;
                                 if (reserve_data_proportion < 1)
 																																{
@@ -15368,24 +15641,24 @@ default:
 																																if (k == 0)
 																																{
                                      base_dist = 180 * specific_zoom;//(80 + drand(60, 1)) * specific_zoom;
-                                     base_well_ring_angle = PI/6 + (w.world_time * w.data_well[backbl->backblock_value].spin_rate);
+                                     base_well_ring_angle = PI/6 + (dw->world_time * dw->data_well[backbl->backblock_value].spin_rate);
                                      reserve_square_arc_inner = 0.16;
                                      reserve_square_arc_outer = 0.13;
 																																}
 																																 else
 																																	{
                                       base_dist = 150 * specific_zoom;//(80 + drand(60, 1)) * specific_zoom;
-                                      base_well_ring_angle = PI/6 + (w.world_time * w.data_well[backbl->backblock_value].spin_rate * -1);
+                                      base_well_ring_angle = PI/6 + (dw->world_time * dw->data_well[backbl->backblock_value].spin_rate * -1);
                                       reserve_square_arc_inner = 0.24;
                                       reserve_square_arc_outer = 0.32;
 																																	}
-                                for (l = 0; l < w.data_well[backbl->backblock_value].reserve_squares; l ++)
+                                for (l = 0; l < dw->data_well[backbl->backblock_value].reserve_squares; l ++)
                                 {
                                     float special_bx2 = bx2;// + (drand(60, 1) - 30) * specific_zoom;
                                     float special_by2 = by2;// + (drand(60, 1) - 30) * specific_zoom;
                                     if (k == 0)
 																																				{
-                                     float square_angle = base_well_ring_angle + ((PI*2) / w.data_well[backbl->backblock_value].reserve_squares) * l;
+                                     float square_angle = base_well_ring_angle + ((PI*2) / dw->data_well[backbl->backblock_value].reserve_squares) * l;
                                      add_diamond_layer(3,
                                       special_bx2 + cos(square_angle - reserve_square_arc_inner) * base_dist,
                                       special_by2 + sin(square_angle - reserve_square_arc_inner) * base_dist,
@@ -15399,7 +15672,7 @@ default:
 																																				}
 																																				   else
 																																							{
-                                        float square_angle = base_well_ring_angle + ((PI*2) / w.data_well[backbl->backblock_value].reserve_squares) * l;
+                                        float square_angle = base_well_ring_angle + ((PI*2) / dw->data_well[backbl->backblock_value].reserve_squares) * l;
                                         add_diamond_layer(3,
                                          special_bx2 + cos(square_angle - reserve_square_arc_inner) * base_dist,
                                          special_by2 + sin(square_angle - reserve_square_arc_inner) * base_dist,
@@ -15411,8 +15684,8 @@ default:
                                          special_by2 + sin(square_angle - reserve_square_arc_outer) * (base_dist - reserve_square_length),
                                          reserve_colour);
                                        }
-//                                base_well_ring_angle += (PI/2) / w.data_well[backbl->backblock_value].reserve_squares;
-//                                     base_well_ring_angle += (PI / w.data_well[backbl->backblock_value].reserve_squares);
+//                                base_well_ring_angle += (PI/2) / dw->data_well[backbl->backblock_value].reserve_squares;
+//                                     base_well_ring_angle += (PI / dw->data_well[backbl->backblock_value].reserve_squares);
                               }
                             }
 
@@ -15427,7 +15700,7 @@ default:
 
 /*
                             well_size = 140;
-                            specific_zoom = view.zoom * w.backblock_parallax [3];
+                            specific_zoom = view.zoom * dw->backblock_parallax [3];
 
                             bx2 = top_left_corner_x [3] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [3] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
@@ -15467,7 +15740,7 @@ default:
 
 
                             well_size = 140;
-                            specific_zoom = view.zoom * w.backblock_parallax [2];
+                            specific_zoom = view.zoom * dw->backblock_parallax [2];
 
                             bx2 = top_left_corner_x [2] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [2] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
@@ -15509,7 +15782,7 @@ default:
 
 
                             well_size = 40;
-                            specific_zoom = view.zoom * w.backblock_parallax [1];
+                            specific_zoom = view.zoom * dw->backblock_parallax [1];
 
                             bx2 = top_left_corner_x [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
@@ -15549,12 +15822,12 @@ default:
 
                             int transfer_colour_adjust;
 
-                            if (w.world_time - w.data_well[backbl->backblock_value].last_transferred < 32)
-                             transfer_colour_adjust = 32 - (w.world_time - w.data_well[backbl->backblock_value].last_transferred);
+                            if (dw->world_time - dw->data_well[backbl->backblock_value].last_transferred < 32)
+                             transfer_colour_adjust = 32 - (dw->world_time - dw->data_well[backbl->backblock_value].last_transferred);
                               else
                                transfer_colour_adjust = 0;
 
-                            if (w.data_well[backbl->backblock_value].data > 0)
+                            if (dw->data_well[backbl->backblock_value].data > 0)
                             {
 
                                 specific_zoom = view.zoom;
@@ -15562,15 +15835,15 @@ default:
                                 bx2 = top_left_corner_x [0] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                                 by2 = top_left_corner_y [0] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
 
-                                add_orthogonal_hexagon(2, bx2, by2, (30 * w.data_well[backbl->backblock_value].data * view.zoom) / w.data_well[backbl->backblock_value].data_max, al_map_rgba(220 + transfer_colour_adjust, 200 - transfer_colour_adjust, 50 - transfer_colour_adjust, 180 + transfer_colour_adjust));
+                                add_orthogonal_hexagon(2, bx2, by2, (30 * dw->data_well[backbl->backblock_value].data * view.zoom) / dw->data_well[backbl->backblock_value].data_max, al_map_rgba(220 + transfer_colour_adjust, 200 - transfer_colour_adjust, 50 - transfer_colour_adjust, 180 + transfer_colour_adjust));
                             }
 
-                            specific_zoom = view.zoom * w.backblock_parallax [1];
+                            specific_zoom = view.zoom * dw->backblock_parallax [1];
 
                             bx2 = top_left_corner_x [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_i) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
                             by2 = top_left_corner_y [1] + (BLOCK_SIZE_PIXELS * specific_zoom) * (special_j) + (BLOCK_SIZE_PIXELS/2) * specific_zoom; //((i * BLOCK_SIZE_PIXELS) - camera_offset_x);
 
-//                            float base_well_ring_angle = (w.world_time * w.data_well[backbl->backblock_value].spin_rate);
+//                            float base_well_ring_angle = (dw->world_time * dw->data_well[backbl->backblock_value].spin_rate);
 
 #undef WELL_RING_RADIUS
 #define WELL_RING_RADIUS 140
@@ -15581,27 +15854,27 @@ default:
                             30,
                             140);
 
-                            seed_drand(special_i+special_j + w.world_time);
+                            seed_drand(special_i+special_j + dw->world_time);
 
 
                             for (k = 0; k < DATA_WELL_RESERVES; k++)
                             {
-                                if (w.data_well[backbl->backblock_value].reserve_data [k] == 0)
+                                if (dw->data_well[backbl->backblock_value].reserve_data [k] == 0)
                                     continue;
                                 int swirl, l;
                                 float reserve_angle;
                                 float swirl_spin;
                                 if (k == 0)
-																																	swirl_spin = w.data_well[backbl->backblock_value].spin_rate;
+																																	swirl_spin = dw->data_well[backbl->backblock_value].spin_rate;
 																																	 else
-  																																	swirl_spin = 0 - w.data_well[backbl->backblock_value].spin_rate;
-																																reserve_angle = (w.world_time * swirl_spin);
-																																int reserve_swirl_steps = 10 + w.data_well[backbl->backblock_value].reserve_data [k] / 35;//3 + w.data_well[backbl->backblock_value].reserve_data [k] / 100;
+  																																	swirl_spin = 0 - dw->data_well[backbl->backblock_value].spin_rate;
+																																reserve_angle = (dw->world_time * swirl_spin);
+																																int reserve_swirl_steps = 10 + dw->data_well[backbl->backblock_value].reserve_data [k] / 35;//3 + dw->data_well[backbl->backblock_value].reserve_data [k] / 100;
 																																float reserve_dist = (250 - k * 100) * specific_zoom;
 																																float reserve_step_arc = 0 - swirl_spin;
                               	 float reserve_width;// = ((reserve_swirl_steps) * 0.4 + drand(6, -1)) * specific_zoom;
                               	 float reserve_width_prop = 1;
-                              	 for (swirl = 0; swirl < w.data_well[backbl->backblock_value].reserve_squares; swirl ++)
+                              	 for (swirl = 0; swirl < dw->data_well[backbl->backblock_value].reserve_squares; swirl ++)
 																																{
 //																																	float reserve_front_x = bx2 + cos(reserve_angle) * reserve_dist;
 //																																	float reserve_front_y = by2 + sin(reserve_angle) * reserve_dist;
@@ -15650,7 +15923,7 @@ default:
 
                                  }
 
-                                 reserve_angle += (2 * PI) / w.data_well[backbl->backblock_value].reserve_squares;
+                                 reserve_angle += (2 * PI) / dw->data_well[backbl->backblock_value].reserve_squares;
 
 																																}
                             }
@@ -15689,9 +15962,9 @@ static void vision_block_check(struct block_struct* bl, int base_pos)
 {
     int dist;
 
-				if (bl->vision_block_proximity_time != w.world_time)
+				if (bl->vision_block_proximity_time != dw->world_time)
 				{
-					bl->vision_block_proximity_time = w.world_time;
+					bl->vision_block_proximity_time = dw->world_time;
 					bl->vision_block_proximity = 100000;
 				}
 
@@ -15709,9 +15982,9 @@ static void vision_block_check_corner(struct block_struct* bl, int base_pos_x, i
  int dist_x, dist_y, dist;
 
 
-				if (bl->vision_block_proximity_time != w.world_time)
+				if (bl->vision_block_proximity_time != dw->world_time)
 				{
-					bl->vision_block_proximity_time = w.world_time;
+					bl->vision_block_proximity_time = dw->world_time;
 					bl->vision_block_proximity = 100000;
 				}
 
@@ -15729,12 +16002,12 @@ static void vision_block_check_corner(struct block_struct* bl, int base_pos_x, i
 static void set_outer_edge_vision_block(int block_x, int block_y)
 {
 
-	if (w.block[block_x][block_y].vision_block_proximity_time == w.world_time)
+	if (dw->block[block_x][block_y].vision_block_proximity_time == dw->world_time)
 		return; // if anything has been done to the block this tick, we don't need to do anything here
 
-	w.block[block_x][block_y].vision_block_proximity_time = w.world_time;
+	dw->block[block_x][block_y].vision_block_proximity_time = dw->world_time;
 
-	w.block[block_x][block_y].vision_block_proximity = 50000;
+	dw->block[block_x][block_y].vision_block_proximity = 50000;
 
 }*/
 
@@ -15760,11 +16033,11 @@ static void special_visible_area(cart notional_core_position)
 	if (block_min_y < 2)
 		block_min_y = 2;
 	int block_max_x = block_min_x + ((view.window_x_unzoomed / BLOCK_SIZE_PIXELS) / view.zoom) + 6;
-	if (block_max_x >= w.blocks.x - 2)
-		block_max_x = w.blocks.x - 2;
+	if (block_max_x >= dw->blocks.x - 2)
+		block_max_x = dw->blocks.x - 2;
 	int block_max_y = block_min_y + ((view.window_y_unzoomed / BLOCK_SIZE_PIXELS) / view.zoom) + 6;
-	if (block_max_y >= w.blocks.y - 2)
-		block_max_y = w.blocks.y - 2;
+	if (block_max_y >= dw->blocks.y - 2)
+		block_max_y = dw->blocks.y - 2;
 
 //#define VISION_SIZE_BLOCKS 6
 
@@ -15802,9 +16075,9 @@ static void special_visible_area(cart notional_core_position)
 		{
 		 for (j = min_y; j < max_y;	j ++)
 		 {
-//		 	struct block_struct* bl = &w.block[i][j];
+//		 	struct block_struct* bl = &dw->block[i][j];
 
-		 	if (w.vision_block[i][j].clear_time == w.world_time)
+		 	if (dw->vision_block[i][j].clear_time == dw->world_time)
 					continue;
 
 //    int dist_x = abs(core_x - (i * BLOCK_SIZE_PIXELS + (j&1) * (BLOCK_SIZE_PIXELS / 2)));
@@ -15828,10 +16101,10 @@ static void special_visible_area(cart notional_core_position)
 
 // Surely this rubbish can be optimised
 
-				if (w.vision_block[i][j].proximity_time != w.world_time)
+				if (dw->vision_block[i][j].proximity_time != dw->world_time)
 				{
-					w.vision_block[i][j].proximity_time = w.world_time;
-					w.vision_block[i][j].proximity = 100000;
+					dw->vision_block[i][j].proximity_time = dw->world_time;
+					dw->vision_block[i][j].proximity = 100000;
 				}
 
 
@@ -15845,9 +16118,9 @@ static void special_visible_area(cart notional_core_position)
 				if (dist < 0)
 					dist = 0;
 
-				w.vision_block[i][j].proximity_time = w.world_time;
-				if (w.vision_block[i][j].proximity > dist)
-					w.vision_block[i][j].proximity = dist;
+				dw->vision_block[i][j].proximity_time = dw->world_time;
+				if (dw->vision_block[i][j].proximity > dist)
+					dw->vision_block[i][j].proximity = dist;
 
 		 }
 		}
@@ -15869,11 +16142,11 @@ static void special_visible_area(cart notional_core_position)
 	if (block_min_y < 1)
 		block_min_y = 1;
 	int block_max_x = block_min_x + ((view.window_x_unzoomed / BLOCK_SIZE_PIXELS) / view.zoom) + 6;
-	if (block_max_x >= w.blocks.x - 1)
-		block_max_x = w.blocks.x - 1;
+	if (block_max_x >= dw->blocks.x - 1)
+		block_max_x = dw->blocks.x - 1;
 	int block_max_y = block_min_y + ((view.window_y_unzoomed / BLOCK_SIZE_PIXELS) / view.zoom) + 6;
-	if (block_max_y >= w.blocks.y - 1)
-		block_max_y = w.blocks.y - 1;
+	if (block_max_y >= dw->blocks.y - 1)
+		block_max_y = dw->blocks.y - 1;
 
 
 		base_min_x = block_x - VISION_SIZE_BLOCKS;
@@ -15911,11 +16184,11 @@ static void special_visible_area(cart notional_core_position)
   if (clear_min_y < 0)
 			clear_min_y = 0;
   int clear_max_x = base_max_x;
-  if (clear_max_x > w.blocks.x)
-			clear_max_x = w.blocks.x;
+  if (clear_max_x > dw->blocks.x)
+			clear_max_x = dw->blocks.x;
   int clear_max_y = base_max_y;
-  if (clear_max_y > w.blocks.y)
-			clear_max_y = w.blocks.y;
+  if (clear_max_y > dw->blocks.y)
+			clear_max_y = dw->blocks.y;
 
 
 // clear out the centre:
@@ -15923,7 +16196,7 @@ static void special_visible_area(cart notional_core_position)
 		{
 		 for (i = clear_min_x + 2; i < clear_max_x - 2;	i ++)
 		 {
-		   w.block[i][j].vision_block_clear_time = w.world_time;
+		   dw->block[i][j].vision_block_clear_time = dw->world_time;
 		 }
 		}
 
@@ -15955,7 +16228,7 @@ static void special_visible_area(cart notional_core_position)
    column = min_x + 1;
  		for (j = min_y + 1; j < max_y - 1;	j ++)
 	 	{
-				vision_block_check(&w.block[column][j],
+				vision_block_check(&dw->block[column][j],
 																							(column * BLOCK_SIZE_PIXELS) - core_x);
 	 	}
 
@@ -15963,7 +16236,7 @@ static void special_visible_area(cart notional_core_position)
 		 {
   		for (j = min_y + 1; j < max_y - 1;	j ++)
 	 	 {
- 				vision_block_check(&w.block[min_x][j],
+ 				vision_block_check(&dw->block[min_x][j],
 																							 (min_x * BLOCK_SIZE_PIXELS) - core_x);
 	 	 }
 		 }
@@ -15976,7 +16249,7 @@ static void special_visible_area(cart notional_core_position)
    column = max_x - 2;
  		for (j = min_y + 1; j < max_y - 1;	j ++)
 	 	{
-				vision_block_check(&w.block[column][j],
+				vision_block_check(&dw->block[column][j],
 																						 (column * BLOCK_SIZE_PIXELS) - core_x);
 	 	}
 
@@ -15985,7 +16258,7 @@ static void special_visible_area(cart notional_core_position)
 		 {
   		for (j = min_y + 1; j < max_y - 1;	j ++)
 	 	 {
- 				vision_block_check(&w.block[column][j],
+ 				vision_block_check(&dw->block[column][j],
 																						 (column * BLOCK_SIZE_PIXELS) - core_x);
 	 	 }
 		 }
@@ -16000,7 +16273,7 @@ static void special_visible_area(cart notional_core_position)
 		{
  		for (i = min_x + 1; i < max_x - 1;	i ++)
 	 	{
-				vision_block_check(&w.block[i][row],
+				vision_block_check(&dw->block[i][row],
 																							(row * BLOCK_SIZE_PIXELS) - core_y);
 	 	}
 //   row = min_y + 1;
@@ -16008,7 +16281,7 @@ static void special_visible_area(cart notional_core_position)
  		{
   		for (i = min_x + 1; i < max_x - 1;	i ++)
 	  	{
-			 	vision_block_check(&w.block[i][min_y],
+			 	vision_block_check(&dw->block[i][min_y],
 																							(min_y * BLOCK_SIZE_PIXELS) - core_y);
 	 	 }
 		 }
@@ -16022,7 +16295,7 @@ static void special_visible_area(cart notional_core_position)
 		{
  		for (i = min_x + 1; i < max_x - 1;	i ++)
 	 	{
-				vision_block_check(&w.block[i][row],
+				vision_block_check(&dw->block[i][row],
 																							(row * BLOCK_SIZE_PIXELS) - core_y);
 	 	}
    row = max_y - 1;
@@ -16030,7 +16303,7 @@ static void special_visible_area(cart notional_core_position)
 		 {
   		for (i = min_x + 1; i < max_x - 1;	i ++)
 	 	 {
- 				vision_block_check(&w.block[i][row],
+ 				vision_block_check(&dw->block[i][row],
 																							(row * BLOCK_SIZE_PIXELS) - core_y);
 	 	 }
 		 }
@@ -16040,32 +16313,32 @@ static void special_visible_area(cart notional_core_position)
 		if (min_x <= base_min_x + 1)
 	 {
 		 if (min_y <= base_min_y + 1)
-    vision_block_check_corner(&w.block[min_x+1][min_y+1], ((min_x+1) * BLOCK_SIZE_PIXELS) - core_x, ((min_y+1) * BLOCK_SIZE_PIXELS) - core_y);
+    vision_block_check_corner(&dw->block[min_x+1][min_y+1], ((min_x+1) * BLOCK_SIZE_PIXELS) - core_x, ((min_y+1) * BLOCK_SIZE_PIXELS) - core_y);
 		 if (max_y >= base_max_y - 1)
-    vision_block_check_corner(&w.block[min_x+1][max_y-2], ((min_x+1) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-2) * BLOCK_SIZE_PIXELS) - core_y);
+    vision_block_check_corner(&dw->block[min_x+1][max_y-2], ((min_x+1) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-2) * BLOCK_SIZE_PIXELS) - core_y);
 
 			if (min_x == base_min_x)
 		 {
 			 if (min_y == base_min_y)
-     vision_block_check_corner(&w.block[min_x][min_y], (min_x * BLOCK_SIZE_PIXELS) - core_x, (min_y * BLOCK_SIZE_PIXELS) - core_y);
+     vision_block_check_corner(&dw->block[min_x][min_y], (min_x * BLOCK_SIZE_PIXELS) - core_x, (min_y * BLOCK_SIZE_PIXELS) - core_y);
 			 if (max_y == base_max_y)
-     vision_block_check_corner(&w.block[min_x][max_y-1], (min_x * BLOCK_SIZE_PIXELS) - core_x, ((max_y-1) * BLOCK_SIZE_PIXELS) - core_y);
+     vision_block_check_corner(&dw->block[min_x][max_y-1], (min_x * BLOCK_SIZE_PIXELS) - core_x, ((max_y-1) * BLOCK_SIZE_PIXELS) - core_y);
 		 }
 	 }
 
 		if (max_x >= base_max_x - 1)
 	 {
 		 if (min_y <= base_min_y + 1)
-    vision_block_check_corner(&w.block[max_x-2][min_y+1], ((max_x-2) * BLOCK_SIZE_PIXELS) - core_x, ((min_y+1) * BLOCK_SIZE_PIXELS) - core_y);
+    vision_block_check_corner(&dw->block[max_x-2][min_y+1], ((max_x-2) * BLOCK_SIZE_PIXELS) - core_x, ((min_y+1) * BLOCK_SIZE_PIXELS) - core_y);
 		 if (max_y >= base_max_y - 1)
-    vision_block_check_corner(&w.block[max_x-2][max_y-2], ((max_x-2) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-2) * BLOCK_SIZE_PIXELS) - core_y);
+    vision_block_check_corner(&dw->block[max_x-2][max_y-2], ((max_x-2) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-2) * BLOCK_SIZE_PIXELS) - core_y);
 
 			if (max_x == base_max_x)
 		 {
 			 if (min_y == base_min_y)
-     vision_block_check_corner(&w.block[max_x-1][min_y], ((max_x-1) * BLOCK_SIZE_PIXELS) - core_x, (min_y * BLOCK_SIZE_PIXELS) - core_y);
+     vision_block_check_corner(&dw->block[max_x-1][min_y], ((max_x-1) * BLOCK_SIZE_PIXELS) - core_x, (min_y * BLOCK_SIZE_PIXELS) - core_y);
 			 if (max_y == base_max_y)
-     vision_block_check_corner(&w.block[max_x-1][max_y-1], ((max_x-1) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-1) * BLOCK_SIZE_PIXELS) - core_y);
+     vision_block_check_corner(&dw->block[max_x-1][max_y-1], ((max_x-1) * BLOCK_SIZE_PIXELS) - core_x, ((max_y-1) * BLOCK_SIZE_PIXELS) - core_y);
 		 }
 	 }
 
@@ -20,9 +20,14 @@ void add_line_vertex(float x, float y, ALLEGRO_COLOR col);
 void construct_line(int layer, int v1, int v2);
 void add_tri_vertex(float x, float y, ALLEGRO_COLOR col);
 void construct_triangle(int layer, int v1, int v2, int v3);
+void add_orthogonal_hexagon(int layer, float x, float y, float size, ALLEGRO_COLOR col1);
+void add_diamond_layer(int layer, float vx1, float vy1, float vx2, float vy2, float vx3, float vy3, float vx4, float vy4, ALLEGRO_COLOR fill_col);
 
 void check_vbuf(void);
 void draw_vbuf(void);
+void draw_vbuf_triangles(int layer);
+void draw_vbuf_lines(int layer);
+void vbuf_stream_end_frame(void);
 
 void add_proc_shape(float x, float y, al_fixed angle, int shape, int size, ALLEGRO_COLOR* proc_col, float zoom);
 void draw_proc_shape(float x, float y, al_fixed angle, int shape, int player_index, float zoom, ALLEGRO_COLOR* proc_col);
@@ -64,4 +69,6 @@ void draw_object(float proc_x, float proc_y,
 
 void draw_proc_outline(float x, float y, al_fixed angle, int shape, float scale, int lines_only, ALLEGRO_COLOR fill_col, ALLEGRO_COLOR edge_col, float zoom);
 
+void reset_map_vision_cache(void);
+
 #endif
@@ -146,16 +146,24 @@ enum
 //#define VERTEX_INDEX_SIZE 4000
 //#define VERTEX_INDEX_TRIGGER 3000
 
+// vbuf only uses the position and colour of each vertex, so it doesn't use ALLEGRO_VERTEX (which also has z, u and v).
+// draw_vbuf() describes this format to Allegro with vbuf_stream.vertex_decl (in i_display.c).
+struct vbuf_vertex_struct
+{
+  float x, y;
+  ALLEGRO_COLOR color;
+};
+
 struct vbuf_struct
 {
 
   int vertex_pos_triangle; // position in buffer
-  ALLEGRO_VERTEX buffer_triangle[VERTEX_BUFFER_SIZE];
+  struct vbuf_vertex_struct buffer_triangle[VERTEX_BUFFER_SIZE];
   int index_triangle[DISPLAY_LAYERS][VERTEX_INDEX_SIZE];
   int index_pos_triangle[DISPLAY_LAYERS]; // position in triangle index
 
   int vertex_pos_line;							  // position in buffer
-  ALLEGRO_VERTEX buffer_line[VERTEX_BUFFER_SIZE]; // this could be made much smaller
+  struct vbuf_vertex_struct buffer_line[VERTEX_BUFFER_SIZE]; // this could be made much smaller
   int index_line[DISPLAY_LAYERS][VERTEX_INDEX_SIZE];
   int index_pos_line[DISPLAY_LAYERS]; // position in line index
   // the indices don't really need to be as large as the buffer
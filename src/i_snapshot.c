@@ -0,0 +1,492 @@
+/*
+
+World snapshots for the display
+
+While world ticks are running on the simulation thread (see g_sim.c), the display can't look at w because the tick is changing it.
+Instead, main_game_loop() calls publish_world_snapshot() after each tick to copy everything that the display reads from w into
+ a snapshot, and the display draws the snapshot. The display gets to the world through dw, which points to the snapshot while
+ it's in use and to w otherwise.
+
+The snapshot is a world_struct with its own copies of the arrays that the display uses:
+ - core, proc, packet, cloud, block, vision_area and the free entry bitmaps are copied each tick. The pointers in procs, packets
+    and blocks (blocklists and group connections) are then moved to point to the same entries in the snapshot's arrays.
+ - backblocks are only copied when they change. The functions that change block nodes call back_cache_block_changed(), which
+    passes them to snapshot_block_changed() while the snapshot is in use. The next publish copies those blocks and then
+    marks their back cache chunks (i_back_cache.c) dirty with mark_back_cache_block_dirty() (not back_cache_block_changed(),
+    which would just list them again), so that the chunks are rebuilt from the new nodes.
+ - vision_block is only used by the display, so the snapshot shares w's.
+ - proc_box and channel_listener aren't used by the display and are left NULL.
+
+The display runs more often than ticks finish (it doesn't wait for the tick), so interpolate_world_snapshot() moves procs, cores
+ and packets smoothly from where they were in the previous snapshot to where they are in the latest one. This means the display
+ is about one tick behind the world, which isn't noticeable.
+
+*/
+
+#include <allegro5/allegro.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "m_config.h"
+#include "g_header.h"
+#include "m_globvars.h"
+#include "m_maths.h"
+
+#include "g_misc.h"
+#include "i_back_cache.h"
+#include "i_snapshot.h"
+
+// if more blocks than this change in a tick, all chunks of the back cache are rebuilt:
+#define SNAPSHOT_CHANGED_BLOCKS 1024
+
+struct world_struct* dw = &w;
+
+// where something was in a snapshot (used for interpolation)
+struct snapshot_motion_struct
+{
+ int exists;
+ timestamp created_timestamp; // used to make sure that an entry hasn't been reused for something else
+ cart position;
+ al_fixed angle;
+};
+
+struct world_snapshot_struct
+{
+ int allocated; // 1 if the arrays below have been allocated for the current world
+ int published; // 1 if world is a copy of w from the end of the latest tick (0 after stop_world_snapshots())
+ struct world_struct world;
+
+// the snapshot's own arrays (world is copied from w by each publish, so its pointers need to be set back to these afterwards):
+ struct core_struct* core;
+ struct proc_struct* proc;
+ struct packet_struct* packet;
+ struct cloud_struct* cloud;
+ struct block_struct** block;
+ struct backblock_struct** backblock;
+ struct vision_area_struct** vision_area [PLAYERS];
+ unsigned int* core_free_bits;
+ unsigned int* proc_free_bits;
+ unsigned int* packet_free_bits;
+
+// motion [latest] is from the latest publish and motion [latest ^ 1] is from the one before:
+ int latest;
+ double publish_time [2];
+ struct snapshot_motion_struct* proc_motion [2];
+ struct snapshot_motion_struct* core_motion [2];
+ struct snapshot_motion_struct* packet_motion [2];
+
+// blocks whose nodes have changed since the last publish:
+ unsigned char* block_changed; // one for each block, so that each block is only listed once
+ int changed_block [SNAPSHOT_CHANGED_BLOCKS]; // (bx * w.blocks.y) + by
+ int changed_blocks;
+ int changed_blocks_overflow; // 1 if more blocks changed than changed_block can hold
+};
+
+static struct world_snapshot_struct snapshot;
+
+static void allocate_world_snapshot(void);
+static void record_snapshot_motion(int m);
+static void mark_changed_blocks(void);
+static struct proc_struct* snapshot_proc_pointer(struct proc_struct* pr);
+static struct packet_struct* snapshot_packet_pointer(struct packet_struct* pack);
+static al_fixed interpolate_fixed(al_fixed from, al_fixed to, al_fixed fraction);
+
+
+// Called by main_game_loop() between ticks, before starting a tick on the simulation thread.
+// Copies the world into the snapshot and makes the display use the snapshot.
+void publish_world_snapshot(void)
+{
+
+ int i, d;
+ int blocks = w.blocks.x * w.blocks.y;
+ struct world_struct* sw = &snapshot.world;
+
+ if (!snapshot.allocated)
+		allocate_world_snapshot();
+
+ *sw = w;
+
+ sw->core = snapshot.core;
+ sw->proc = snapshot.proc;
+ sw->proc_box = NULL;
+ sw->packet = snapshot.packet;
+ sw->cloud = snapshot.cloud;
+ sw->block = snapshot.block;
+ sw->backblock = snapshot.backblock;
+ sw->vision_block = w.vision_block;
+ for (i = 0; i < PLAYERS; i ++)
+	{
+		sw->vision_area [i] = snapshot.vision_area [i];
+	}
+ for (i = 0; i < CHANNELS; i ++)
+	{
+		sw->channel_listener [i] = NULL;
+	}
+ sw->core_free_bits = snapshot.core_free_bits;
+ sw->proc_free_bits = snapshot.proc_free_bits;
+ sw->packet_free_bits = snapshot.packet_free_bits;
+
+ memcpy(snapshot.core, w.core, sizeof(struct core_struct) * w.max_cores);
+ memcpy(snapshot.proc, w.proc, sizeof(struct proc_struct) * w.max_procs);
+ memcpy(snapshot.packet, w.packet, sizeof(struct packet_struct) * w.max_packets);
+ memcpy(snapshot.cloud, w.cloud, sizeof(struct cloud_struct) * w.max_clouds);
+ memcpy(snapshot.block [0], w.block [0], sizeof(struct block_struct) * blocks);
+// all players' vision areas are in one array (see new_world_from_world_init() in g_world.c):
+ memcpy(snapshot.vision_area [0] [0], w.vision_area [0] [0], sizeof(struct vision_area_struct) * w.players * w.vision_areas_x * w.vision_areas_y);
+ memcpy(snapshot.core_free_bits, w.core_free_bits, sizeof(unsigned int) * POOL_BITS_WORDS(w.max_cores));
+ memcpy(snapshot.proc_free_bits, w.proc_free_bits, sizeof(unsigned int) * POOL_BITS_WORDS(w.max_procs));
+ memcpy(snapshot.packet_free_bits, w.packet_free_bits, sizeof(unsigned int) * POOL_BITS_WORDS(w.max_packets));
+
+ for (i = 0; i < w.max_procs; i ++)
+	{
+		snapshot.proc[i].blocklist_up = snapshot_proc_pointer(w.proc[i].blocklist_up);
+		snapshot.proc[i].blocklist_down = snapshot_proc_pointer(w.proc[i].blocklist_down);
+		for (d = 0; d < GROUP_CONNECTIONS; d ++)
+		{
+			snapshot.proc[i].group_connection_ptr [d] = snapshot_proc_pointer(w.proc[i].group_connection_ptr [d]);
+		}
+	}
+
+ for (i = 0; i < w.max_packets; i ++)
+	{
+		snapshot.packet[i].blocklist_up = snapshot_packet_pointer(w.packet[i].blocklist_up);
+		snapshot.packet[i].blocklist_down = snapshot_packet_pointer(w.packet[i].blocklist_down);
+	}
+
+ for (i = 0; i < blocks; i ++)
+	{
+		snapshot.block [0] [i].blocklist_down = snapshot_proc_pointer(w.block [0] [i].blocklist_down);
+		snapshot.block [0] [i].packet_down = snapshot_packet_pointer(w.block [0] [i].packet_down);
+	}
+
+// backblocks hardly ever change, so only the ones that have changed since the last publish are copied:
+ if (!snapshot.published
+		|| snapshot.changed_blocks_overflow)
+		memcpy(snapshot.backblock [0], w.backblock [0], sizeof(struct backblock_struct) * blocks);
+	 else
+		{
+			for (i = 0; i < snapshot.changed_blocks; i ++)
+			{
+				snapshot.backblock [0] [snapshot.changed_block [i]] = w.backblock [0] [snapshot.changed_block [i]];
+			}
+		}
+
+ mark_changed_blocks();
+
+ snapshot.latest ^= 1;
+ record_snapshot_motion(snapshot.latest);
+ snapshot.publish_time [snapshot.latest] = al_get_time();
+ if (!snapshot.published)
+		snapshot.publish_time [snapshot.latest ^ 1] = snapshot.publish_time [snapshot.latest]; // there's no previous snapshot to interpolate from
+
+ snapshot.published = 1;
+ dw = sw;
+
+}
+
+// Called by main_game_loop() when the next tick isn't going to be run on the simulation thread (so the display can use w again).
+// The snapshot is copied in full at the next publish.
+void stop_world_snapshots(void)
+{
+
+ if (!snapshot.published)
+		return;
+
+ mark_changed_blocks(); // changes from the last tick haven't been published
+
+ snapshot.published = 0;
+ dw = &w;
+
+}
+
+// Called by main_game_loop() just before run_display().
+// Moves the procs, cores and packets in the snapshot part of the way from the previous snapshot to the latest one, depending on how long ago
+//  the latest one was published and how long the tick before it took.
+void interpolate_world_snapshot(void)
+{
+
+ int i;
+ int latest = snapshot.latest;
+ int previous = snapshot.latest ^ 1;
+ double tick_time, tick_fraction;
+ al_fixed fraction;
+ struct snapshot_motion_struct* from;
+ struct snapshot_motion_struct* to;
+
+ if (dw == &w)
+		return;
+
+ tick_time = snapshot.publish_time [latest] - snapshot.publish_time [previous];
+
+ if (tick_time <= 0)
+		return;
+
+ tick_fraction = (al_get_time() - snapshot.publish_time [latest]) / tick_time;
+ if (tick_fraction > 1)
+		tick_fraction = 1;
+ if (tick_fraction < 0)
+		tick_fraction = 0;
+ fraction = al_ftofix(tick_fraction);
+
+ for (i = 0; i < w.max_procs; i ++)
+	{
+		to = &snapshot.proc_motion [latest] [i];
+		from = &snapshot.proc_motion [previous] [i];
+		if (!to->exists
+			|| !from->exists
+			|| from->created_timestamp != to->created_timestamp)
+			continue;
+		snapshot.proc[i].position.x = interpolate_fixed(from->position.x, to->position.x, fraction);
+		snapshot.proc[i].position.y = interpolate_fixed(from->position.y, to->position.y, fraction);
+		snapshot.proc[i].angle = from->angle + al_fixmul(angle_difference_signed(from->angle, to->angle), fraction);
+		fix_fixed_angle(&snapshot.proc[i].angle);
+	}
+
+ for (i = 0; i < w.max_cores; i ++)
+	{
+		to = &snapshot.core_motion [latest] [i];
+		from = &snapshot.core_motion [previous] [i];
+		if (!to->exists
+			|| !from->exists
+			|| from->created_timestamp != to->created_timestamp)
+			continue;
+		snapshot.core[i].core_position.x = interpolate_fixed(from->position.x, to->position.x, fraction);
+		snapshot.core[i].core_position.y = interpolate_fixed(from->position.y, to->position.y, fraction);
+	}
+
+ for (i = 0; i < w.max_packets; i ++)
+	{
+		to = &snapshot.packet_motion [latest] [i];
+		from = &snapshot.packet_motion [previous] [i];
+		if (!to->exists
+			|| !from->exists
+			|| from->created_timestamp != to->created_timestamp)
+			continue;
+		snapshot.packet[i].position.x = interpolate_fixed(from->position.x, to->position.x, fraction);
+		snapshot.packet[i].position.y = interpolate_fixed(from->position.y, to->position.y, fraction);
+	}
+
+}
+
+// Called by back_cache_block_changed() when the nodes of block bx,by (which must be in bounds) change while the display is using the snapshot.
+// The block is copied to the snapshot, and its back cache chunk marked dirty, at the next publish.
+void snapshot_block_changed(int bx, int by)
+{
+
+ int block_index = (bx * w.blocks.y) + by;
+
+ if (snapshot.block_changed [block_index])
+		return;
+
+ if (snapshot.changed_blocks >= SNAPSHOT_CHANGED_BLOCKS)
+	{
+		snapshot.changed_blocks_overflow = 1;
+		return;
+	}
+
+ snapshot.block_changed [block_index] = 1;
+ snapshot.changed_block [snapshot.changed_blocks] = block_index;
+ snapshot.changed_blocks ++;
+
+}
+
+// Call when the world is deallocated (deallocate_world() in g_world.c). Safe to call if no snapshot has been published.
+void free_world_snapshot(void)
+{
+
+ int m;
+
+ dw = &w;
+
+ if (!snapshot.allocated)
+		return;
+
+ free(snapshot.core);
+ free(snapshot.proc);
+ free(snapshot.packet);
+ free(snapshot.cloud);
+ free(snapshot.block [0]);
+ free(snapshot.block);
+ free(snapshot.backblock [0]);
+ free(snapshot.backblock);
+ free(snapshot.vision_area [0] [0]);
+ free(snapshot.vision_area [0]);
+ free(snapshot.core_free_bits);
+ free(snapshot.proc_free_bits);
+ free(snapshot.packet_free_bits);
+ for (m = 0; m < 2; m ++)
+	{
+		free(snapshot.proc_motion [m]);
+		free(snapshot.core_motion [m]);
+		free(snapshot.packet_motion [m]);
+	}
+ free(snapshot.block_changed);
+
+ snapshot.allocated = 0;
+ snapshot.published = 0;
+
+}
+
+// allocates the snapshot's arrays at the same sizes as w's (see new_world_from_world_init() in g_world.c)
+static void allocate_world_snapshot(void)
+{
+
+ int i, p, m;
+ int failed = 0;
+ struct vision_area_struct** vision_area_columns;
+ struct vision_area_struct* vision_area_data;
+
+ snapshot.core = malloc(sizeof(struct core_struct) * w.max_cores);
+ snapshot.proc = malloc(sizeof(struct proc_struct) * w.max_procs);
+ snapshot.packet = malloc(sizeof(struct packet_struct) * w.max_packets);
+ snapshot.cloud = malloc(sizeof(struct cloud_struct) * w.max_clouds);
+ snapshot.block = calloc(w.blocks.x, sizeof(struct block_struct*));
+ snapshot.backblock = calloc(w.blocks.x, sizeof(struct backblock_struct*));
+ vision_area_columns = calloc(w.players * w.vision_areas_x, sizeof(struct vision_area_struct*));
+ vision_area_data = calloc(w.players * w.vision_areas_x * w.vision_areas_y, sizeof(struct vision_area_struct));
+ snapshot.core_free_bits = calloc(POOL_BITS_WORDS(w.max_cores), sizeof(unsigned int));
+ snapshot.proc_free_bits = calloc(POOL_BITS_WORDS(w.max_procs), sizeof(unsigned int));
+ snapshot.packet_free_bits = calloc(POOL_BITS_WORDS(w.max_packets), sizeof(unsigned int));
+ for (m = 0; m < 2; m ++)
+	{
+		snapshot.proc_motion [m] = calloc(w.max_procs, sizeof(struct snapshot_motion_struct));
+		snapshot.core_motion [m] = calloc(w.max_cores, sizeof(struct snapshot_motion_struct));
+		snapshot.packet_motion [m] = calloc(w.max_packets, sizeof(struct snapshot_motion_struct));
+		if (snapshot.proc_motion [m] == NULL
+			|| snapshot.core_motion [m] == NULL
+			|| snapshot.packet_motion [m] == NULL)
+			failed = 1;
+	}
+ snapshot.block_changed = calloc(w.blocks.x * w.blocks.y, sizeof(unsigned char));
+
+ if (failed
+		|| snapshot.core == NULL
+		|| snapshot.proc == NULL
+		|| snapshot.packet == NULL
+		|| snapshot.cloud == NULL
+		|| snapshot.block == NULL
+		|| snapshot.backblock == NULL
+		|| vision_area_columns == NULL
+		|| vision_area_data == NULL
+		|| snapshot.core_free_bits == NULL
+		|| snapshot.proc_free_bits == NULL
+		|| snapshot.packet_free_bits == NULL
+		|| snapshot.block_changed == NULL)
+	{
+      fprintf(stdout, "i_snapshot.c: Out of memory in allocating world snapshot");
+      error_call();
+	}
+
+ snapshot.block [0] = calloc(w.blocks.x * w.blocks.y, sizeof(struct block_struct));
+ snapshot.backblock [0] = calloc(w.blocks.x * w.blocks.y, sizeof(struct backblock_struct));
+ if (snapshot.block [0] == NULL
+		|| snapshot.backblock [0] == NULL)
+	{
+      fprintf(stdout, "i_snapshot.c: Out of memory in allocating world snapshot");
+      error_call();
+	}
+ for (i = 1; i < w.blocks.x; i ++)
+	{
+		snapshot.block [i] = snapshot.block [0] + (i * w.blocks.y);
+		snapshot.backblock [i] = snapshot.backblock [0] + (i * w.blocks.y);
+	}
+
+ for (p = 0; p < PLAYERS; p ++)
+	{
+		snapshot.vision_area [p] = NULL;
+	}
+ for (p = 0; p < w.players; p ++)
+	{
+  snapshot.vision_area [p] = vision_area_columns + (p * w.vision_areas_x);
+  for (i = 0; i < w.vision_areas_x; i ++)
+  {
+   snapshot.vision_area [p] [i] = vision_area_data + ((p * w.vision_areas_x + i) * w.vision_areas_y);
+  }
+	}
+
+ snapshot.changed_blocks = 0;
+ snapshot.changed_blocks_overflow = 0;
+ snapshot.latest = 0;
+ snapshot.published = 0;
+ snapshot.allocated = 1;
+
+}
+
+static void record_snapshot_motion(int m)
+{
+
+ int i;
+
+ for (i = 0; i < w.max_procs; i ++)
+	{
+		snapshot.proc_motion [m] [i].exists = (w.proc[i].exists == 1);
+		snapshot.proc_motion [m] [i].created_timestamp = w.proc[i].created_timestamp;
+		snapshot.proc_motion [m] [i].position = w.proc[i].position;
+		snapshot.proc_motion [m] [i].angle = w.proc[i].angle;
+	}
+
+ for (i = 0; i < w.max_cores; i ++)
+	{
+		snapshot.core_motion [m] [i].exists = (w.core[i].exists == 1);
+		snapshot.core_motion [m] [i].created_timestamp = w.core[i].created_timestamp;
+		snapshot.core_motion [m] [i].position = w.core[i].core_position;
+	}
+
+ for (i = 0; i < w.max_packets; i ++)
+	{
+		snapshot.packet_motion [m] [i].exists = (w.packet[i].exists == 1);
+		snapshot.packet_motion [m] [i].created_timestamp = w.packet[i].created_timestamp;
+		snapshot.packet_motion [m] [i].position = w.packet[i].position;
+	}
+
+}
+
+// marks the back cache chunks of the blocks listed by snapshot_block_changed() dirty, and clears the list
+static void mark_changed_blocks(void)
+{
+
+ int i;
+
+ if (snapshot.changed_blocks_overflow)
+		invalidate_back_cache();
+
+ for (i = 0; i < snapshot.changed_blocks; i ++)
+	{
+		snapshot.block_changed [snapshot.changed_block [i]] = 0;
+		if (!snapshot.changed_blocks_overflow)
+			mark_back_cache_block_dirty(snapshot.changed_block [i] / w.blocks.y, snapshot.changed_block [i] % w.blocks.y);
+	}
+
+ snapshot.changed_blocks = 0;
+ snapshot.changed_blocks_overflow = 0;
+
+}
+
+static struct proc_struct* snapshot_proc_pointer(struct proc_struct* pr)
+{
+
+ if (pr == NULL)
+		return NULL;
+
+ return snapshot.proc + (pr - w.proc);
+
+}
+
+static struct packet_struct* snapshot_packet_pointer(struct packet_struct* pack)
+{
+
+ if (pack == NULL)
+		return NULL;
+
+ return snapshot.packet + (pack - w.packet);
+
+}
+
+static al_fixed interpolate_fixed(al_fixed from, al_fixed to, al_fixed fraction)
+{
+
+ return from + al_fixmul(to - from, fraction);
+
+}
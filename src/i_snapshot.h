@@ -0,0 +1,14 @@
+
+#ifndef H_I_SNAPSHOT
+#define H_I_SNAPSHOT
+
+// the world that the display draws: &w, or a snapshot of it while world ticks are running on the simulation thread (see i_snapshot.c)
+extern struct world_struct* dw;
+
+void publish_world_snapshot(void);
+void stop_world_snapshots(void);
+void interpolate_world_snapshot(void);
+void free_world_snapshot(void);
+void snapshot_block_changed(int bx, int by);
+
+#endif
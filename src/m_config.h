@@ -28,6 +28,14 @@
 
 
 
+// THREAD_LOCAL gives each thread its own copy of a global or static variable.
+// It's used for the interpreter state (vmstate etc.) so that cores can be executed on several threads at once (see g_proc_par.c).
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
 #ifndef TRUE
 #define TRUE 1
 #define FALSE 0
@@ -0,0 +1,777 @@
+/*
+
+Headless simulation runner.
+
+This runs complete custom games (the same kind of game that's started from the setup menu)
+ without a display, input, sound or any of the panels. It's used for throughput-testing
+ process code: every tick just calls run_world_tick() as fast as the CPU allows.
+
+It's built as a separate binary (bin/libcirc_headless - see the "headless" targets in the Makefile
+ and justfile). The binary is the normal game compiled with HEADLESS defined, which makes main()
+ in m_main.c call run_headless() instead of setting up a display.
+
+Templates are loaded in the same way as the normal game loads default templates, from the
+ "template" lines in init.txt (or the file given by -init). A player with no "template" lines gets
+ player 0's templates (the init.txt that comes with the game only has lines for player 0).
+
+The checks (-check_optimise etc.) compare how games end, which only tests something if the processes
+ in them actually do things. So the checks also count the cores built, packets fired and broadcast
+ messages received in the games they play, and fail if any of them is zero. The check targets in the
+ Makefile use -init headless_check.txt, which gives every player the AI templates from the first orange
+ mission (they build, fight and broadcast).
+
+Command line options (all optional):
+ -matches <n>  number of games to run (default 1)
+ -ticks <n>    stop a game after this many ticks even if it hasn't finished (default 0 = no limit;
+               games always end after one hour of game time anyway)
+ -players <n>  2 to 4 (default 2)
+ -cores <n>    core setting, 0 to 3 (default 2)
+ -size <n>     map size setting, 0 to 3 (default 2)
+ -data <n>     starting data setting, 0 to 3 (default 0)
+ -seed <n>     map seed of the first game (default 0). Each later game uses the next seed.
+ -init <file>  reads the settings and "template" lines from file instead of init.txt (which still needs to be there).
+ -core_threads <n>
+               executes cores in phases using n threads (see g_proc_par.c), or one at a time if n is 0. Overrides the
+               "core_threads" line in init.txt.
+ -check_optimise
+               plays each game twice, first with the compiler's optimiser (c_optimise.c) off and then with it on for
+               all compile modes, and checks that both games end in the same way (same length, result and final
+               state of every proc). Returns 1 if any game differs. This can be used as a test for the optimiser.
+ -check_save <n>
+               saves each game after n ticks (to HEADLESS_SAVE_FILE in the current directory) and plays on to the end, then
+               loads the saved game and plays it to the end again, and checks that both end in the same way. Returns 1 if any
+               game differs or the save can't be loaded. This can be used as a test for save_game() and load_game().
+ -check_core_threads <n>
+               plays each game twice, with cores executed in phases first by 1 thread and then by n threads, and checks that
+               both games end in the same way. Returns 1 if any game differs. This can be used as a test for g_proc_par.c.
+
+*/
+
+#include <allegro5/allegro.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "m_config.h"
+#include "g_header.h"
+#include "m_globvars.h"
+
+#include "g_game.h"
+#include "g_misc.h"
+#include "g_proc_par.h"
+#include "g_world.h"
+#include "g_world_back.h"
+#include "g_world_map.h"
+#include "g_shapes.h"
+#include "h_story.h"
+#include "i_display.h"
+#include "m_input.h"
+#include "m_maths.h"
+#include "t_files.h"
+#include "t_template.h"
+#include "x_sound.h"
+#include "m_profile.h"
+#include "c_cache.h"
+#include "c_header.h"
+#include "e_header.h"
+#include "f_save.h"
+#include "f_load.h"
+#include "e_editor.h"
+
+#include "m_headless.h"
+
+extern struct world_init_struct w_init; // declared in s_menu.c
+extern struct game_struct game;
+extern ALLEGRO_EVENT_SOURCE sound_event_source; // in x_init.c
+extern struct log_struct mlog; // in e_log.c
+extern struct fontstruct font [FONTS]; // in m_main.c
+
+#define HEADLESS_SAVE_FILE "headless_check.sav"
+
+void read_initfile(void); // in m_main.c
+void init_inter(void); // in m_main.c
+
+struct headless_options_struct
+{
+ int matches;
+ int max_ticks; // 0 means no limit
+ int players;
+ int core_setting;
+ int size_setting;
+ int data_setting;
+ int seed;
+ int check_optimise;
+ int check_save; // tick to save at (0 = don't check)
+ int core_threads; // -1 means use the value from init.txt
+ int check_core_threads; // number of threads to compare with 1 thread (0 = don't check)
+ char init_file [FILE_PATH_LENGTH]; // "init.txt" unless -init is used
+};
+
+// what the processes have done during a game (see record_activity())
+struct headless_activity_struct
+{
+ timestamp start_time; // w.world_time when the game started (the first processes are created then, but not built)
+ int cores_built;
+ int packets_fired;
+ int broadcasts_received;
+ int messages_received [MAX_CORES]; // each core's messages_received at the end of the last tick
+};
+
+static struct headless_activity_struct activity;
+
+// what a game ended with (used by -check_optimise, -check_save and -check_core_threads to compare two games)
+struct headless_result_struct
+{
+ int ticks;
+ int game_phase;
+ int game_over_status;
+ int game_over_value;
+ int processes [PLAYERS];
+ int data [PLAYERS];
+ unsigned int proc_hash;
+ int cores_built;
+ int packets_fired;
+ int broadcasts_received;
+};
+
+// activity in all games played by a check, which fails if the games didn't build, fire and broadcast (see check_activity())
+static struct headless_result_struct checked_activity;
+
+static int read_headless_options(struct headless_options_struct* hopt, int argc, char** argv);
+static void init_headless(struct headless_options_struct* hopt);
+static int run_headless_match(struct headless_options_struct* hopt, int match, struct headless_result_struct* result);
+static int start_headless_match(struct headless_options_struct* hopt, int match);
+static int run_headless_ticks(struct headless_options_struct* hopt, int ticks, int stop_tick);
+static void finish_headless_match(int match, int ticks, double elapsed, struct headless_result_struct* result);
+static int check_optimised_match(struct headless_options_struct* hopt, int match);
+static int check_saved_match(struct headless_options_struct* hopt, int match);
+static int check_core_threads_match(struct headless_options_struct* hopt, int match);
+static int compare_results(struct headless_result_struct* result1, struct headless_result_struct* result2, int match, const char* description);
+static void record_activity(void);
+static int check_activity(const char* check_name);
+static void print_last_log_line(void);
+static unsigned int hash_procs(void);
+static const char* game_end_name(int game_end_status);
+
+// Called from main() in m_main.c instead of the normal startup when compiled with HEADLESS.
+// Returns the process exit value.
+int run_headless(int argc, char** argv)
+{
+
+ struct headless_options_struct hopt;
+ int i;
+
+ if (!read_headless_options(&hopt, argc, argv))
+		return 1;
+
+ init_headless(&hopt);
+
+ if (hopt.core_threads != -1)
+		settings.option [OPTION_CORE_THREADS] = hopt.core_threads;
+
+ unsigned int total_ticks = 0;
+ double start_time = al_get_time();
+ struct headless_result_struct result;
+ int mismatches = 0;
+
+ memset(&checked_activity, 0, sizeof(struct headless_result_struct));
+
+ for (i = 0; i < hopt.matches; i ++)
+	{
+		if (hopt.check_optimise
+			|| hopt.check_save
+			|| hopt.check_core_threads)
+		{
+			int check;
+			if (hopt.check_optimise)
+				check = check_optimised_match(&hopt, i);
+			 else
+				 if (hopt.check_save)
+				  check = check_saved_match(&hopt, i);
+				   else
+				    check = check_core_threads_match(&hopt, i);
+			if (check < 0)
+				return 1;
+			mismatches += check;
+			continue;
+		}
+		if (!run_headless_match(&hopt, i, &result))
+			return 1;
+		total_ticks += result.ticks;
+	}
+
+ if (hopt.check_optimise)
+	{
+		fprintf(stdout, "\n\nOptimiser check: %i of %i matches differ.\n", mismatches, hopt.matches);
+		return (mismatches != 0) | check_activity("Optimiser check");
+	}
+
+ if (hopt.check_save)
+	{
+		fprintf(stdout, "\n\nSave check: %i of %i matches differ.\n", mismatches, hopt.matches);
+		return (mismatches != 0) | check_activity("Save check");
+	}
+
+ if (hopt.check_core_threads)
+	{
+		fprintf(stdout, "\n\nCore threads check: %i of %i matches differ.\n", mismatches, hopt.matches);
+		return (mismatches != 0) | check_activity("Core threads check");
+	}
+
+ double elapsed = al_get_time() - start_time;
+
+ fprintf(stdout, "\n\nTotal: %i matches, %u ticks in %.3f seconds", hopt.matches, total_ticks, elapsed);
+ if (elapsed > 0)
+		fprintf(stdout, " (%.1f ticks/second)", total_ticks / elapsed);
+ fprintf(stdout, "\n");
+
+ return 0;
+
+}
+
+// Returns 1 on success, 0 on a bad option (after printing a message).
+static int read_headless_options(struct headless_options_struct* hopt, int argc, char** argv)
+{
+
+ int i;
+
+ hopt->matches = 1;
+ hopt->max_ticks = 0;
+ hopt->players = 2;
+ hopt->core_setting = 2;
+ hopt->size_setting = 2;
+ hopt->data_setting = 0;
+ hopt->seed = 0;
+ hopt->check_optimise = 0;
+ hopt->check_save = 0;
+ hopt->core_threads = -1;
+ hopt->check_core_threads = 0;
+ strcpy(hopt->init_file, "init.txt");
+
+ for (i = 1; i < argc; i ++)
+	{
+		int* target = NULL;
+		int min = 0, max = 0;
+
+		if (strcmp(argv[i], "-check_optimise") == 0)
+		{
+			hopt->check_optimise = 1;
+			continue;
+		}
+
+		if (strcmp(argv[i], "-init") == 0
+			&& i + 1 < argc)
+		{
+			i ++;
+			if (strlen(argv[i]) >= FILE_PATH_LENGTH)
+			{
+				fprintf(stdout, "\nError: -init file name too long.\n");
+				return 0;
+			}
+			strcpy(hopt->init_file, argv[i]);
+			continue;
+		}
+
+		if (strcmp(argv[i], "-matches") == 0)
+		{
+			target = &hopt->matches; min = 1; max = 1000000;
+		}
+		else if (strcmp(argv[i], "-ticks") == 0)
+		{
+			target = &hopt->max_ticks; min = 0; max = 100000000;
+		}
+		else if (strcmp(argv[i], "-players") == 0)
+		{
+			target = &hopt->players; min = 2; max = PLAYERS;
+		}
+		else if (strcmp(argv[i], "-cores") == 0)
+		{
+			target = &hopt->core_setting; min = 0; max = 3;
+		}
+		else if (strcmp(argv[i], "-size") == 0)
+		{
+			target = &hopt->size_setting; min = 0; max = 3;
+		}
+		else if (strcmp(argv[i], "-data") == 0)
+		{
+			target = &hopt->data_setting; min = 0; max = 3;
+		}
+		else if (strcmp(argv[i], "-seed") == 0)
+		{
+			target = &hopt->seed; min = 0; max = 999;
+		}
+		else if (strcmp(argv[i], "-check_save") == 0)
+		{
+			target = &hopt->check_save; min = 1; max = 100000000;
+		}
+		else if (strcmp(argv[i], "-core_threads") == 0)
+		{
+			target = &hopt->core_threads; min = 0; max = CORE_THREADS_MAX;
+		}
+		else if (strcmp(argv[i], "-check_core_threads") == 0)
+		{
+			target = &hopt->check_core_threads; min = 1; max = CORE_THREADS_MAX;
+		}
+
+		if (target == NULL
+			|| i + 1 >= argc)
+		{
+			fprintf(stdout, "\nUsage: %s [-matches n] [-ticks n] [-players n] [-cores n] [-size n] [-data n] [-seed n] [-init file] [-core_threads n] [-check_optimise] [-check_save n] [-check_core_threads n]\n", argv[0]);
+			return 0;
+		}
+
+		i ++;
+		*target = atoi(argv[i]);
+
+		if (*target < min
+			|| *target > max)
+		{
+			fprintf(stdout, "\nError: %s %i out of bounds (should be %i to %i).\n", argv[i - 1], *target, min, max);
+			return 0;
+		}
+	}
+
+ if ((hopt->check_optimise != 0) + (hopt->check_save != 0) + (hopt->check_core_threads != 0) > 1)
+	{
+		fprintf(stdout, "\nError: only one of -check_optimise, -check_save and -check_core_threads can be used at once.\n");
+		return 0;
+	}
+
+ if (hopt->check_save
+		&& hopt->max_ticks != 0
+		&& hopt->max_ticks <= hopt->check_save)
+	{
+		fprintf(stdout, "\nError: -ticks %i ends the game before -check_save %i.\n", hopt->max_ticks, hopt->check_save);
+		return 0;
+	}
+
+ return 1;
+
+}
+
+// Does the parts of m_main.c's startup that the simulation needs (everything except display, input, sound and panels).
+static void init_headless(struct headless_options_struct* hopt)
+{
+
+ int i, j;
+
+ fprintf(stdout, "Liberation Circuit (headless)");
+
+ settings.sound_on = 0;
+ settings.option [OPTION_VOL_MUSIC] = 0;
+ settings.option [OPTION_VOL_EFFECT] = 0;
+ strcpy(settings.path_to_init_txt_file, hopt->init_file);
+
+// the sound functions still emit events (e.g. turn_music_off() when a game ends), so the event source needs to be valid even though nothing listens to it:
+ al_init_user_event_source(&sound_event_source);
+
+ init_key_maps(); // read_initfile() may remap keys
+ read_initfile();
+
+// players without any "template" lines use player 0's:
+ for (i = 1; i < PLAYERS; i ++)
+	{
+		if (settings.default_template_path [i] [0] [0] != 0)
+			continue;
+		for (j = 0; j < TEMPLATES_PER_PLAYER; j ++)
+		{
+			strcpy(settings.default_template_path [i] [j], settings.default_template_path [0] [j]);
+		}
+	}
+
+ init_trig();
+ init_drand();
+ init_vision_area_map();
+ init_compile_cache();
+ init_nshapes_and_dshapes();
+
+// templates are loaded through the editor, which lays out its (undrawn) panels from the display size and font metrics.
+// Nothing is displayed and no fonts are loaded here, so give them nominal values:
+ settings.option [OPTION_WINDOW_W] = 1024;
+ settings.option [OPTION_WINDOW_H] = 768;
+ for (i = 0; i < FONTS; i ++)
+	{
+		font[i].width = 6;
+		font[i].height = 12;
+		font[i].font_scale_x = 1;
+		font[i].font_scale_y = 1;
+	}
+ init_inter();
+ init_editor();
+
+ w.allocated = 0;
+
+ init_all_templates();
+ load_default_templates();
+
+ fprintf(stdout, "\nInitialised.");
+
+}
+
+// Runs one complete game and fills in result. Returns 1 on success, 0 if the game couldn't be started.
+static int run_headless_match(struct headless_options_struct* hopt, int match, struct headless_result_struct* result)
+{
+
+ if (!start_headless_match(hopt, match))
+		return 0;
+
+ double start_time = al_get_time();
+
+ int ticks = run_headless_ticks(hopt, 0, 0);
+
+ finish_headless_match(match, ticks, al_get_time() - start_time, result);
+
+ return 1;
+
+}
+
+// Sets up a new world for a game and spawns each player's first process. Returns 1 on success, 0 if the game couldn't be started.
+static int start_headless_match(struct headless_options_struct* hopt, int match)
+{
+
+ int i;
+
+ game.type = GAME_TYPE_BASIC;
+ game.story_type = STORY_TYPE_NORMAL;
+ game.area_index = AREA_BLUE;
+ game.region_in_area_index = 0;
+
+ w_init.players = hopt->players;
+ w_init.core_setting = hopt->core_setting;
+ w_init.size_setting = hopt->size_setting;
+ w_init.game_seed = (hopt->seed + match) % 1000;
+ w_init.command_mode = COMMAND_MODE_AUTO;
+ w_init.story_area = AREA_BLUE;
+ fix_w_init_size();
+
+ for (i = 0; i < PLAYERS; i ++)
+	{
+		sprintf(w_init.player_name [i], "Player %i", i);
+		w_init.starting_data_setting [i] = hopt->data_setting;
+	}
+
+ prepare_templates_for_new_game();
+
+ new_world_from_world_init();
+ generate_random_map(w_init.story_area, w_init.map_size_blocks, w_init.players, w_init.game_seed);
+
+ start_game();
+
+ if (!start_world_phase())
+	{
+		fprintf(stdout, "\nError: player %i can't spawn (%s). Check the template lines in %s.\n",
+										game.spawn_fail,
+										game.spawn_fail_reason == SPAWN_FAIL_DATA? "template 0 costs too much data" : "template 0 missing or invalid",
+										hopt->init_file);
+		deallocate_world();
+		return 0;
+	}
+
+ memset(&activity, 0, sizeof(struct headless_activity_struct));
+ activity.start_time = w.world_time;
+
+ profile_start_game();
+
+ return 1;
+
+}
+
+// Runs the game on from tick number ticks until it ends, reaches the -ticks limit or reaches stop_tick (0 = don't stop).
+// Returns the number of ticks the game has run for.
+static int run_headless_ticks(struct headless_options_struct* hopt, int ticks, int stop_tick)
+{
+
+ while(game.phase == GAME_PHASE_WORLD)
+	{
+		if ((hopt->max_ticks != 0
+			 && ticks >= hopt->max_ticks)
+			|| (stop_tick != 0
+			 && ticks >= stop_tick))
+			break;
+		run_world_tick();
+		record_activity();
+		ticks ++;
+	}
+
+ return ticks;
+
+}
+
+// Prints how a game ended, fills in result and deallocates the world.
+static void finish_headless_match(int match, int ticks, double elapsed, struct headless_result_struct* result)
+{
+
+ int i;
+
+ fprintf(stdout, "\nMatch %i (seed %i): %i ticks in %.3f seconds", match, w_init.game_seed, ticks, elapsed);
+ if (elapsed > 0)
+		fprintf(stdout, " (%.1f ticks/second)", ticks / elapsed);
+
+ if (game.phase == GAME_PHASE_OVER)
+	{
+		fprintf(stdout, ": %s", game_end_name(game.game_over_status));
+		if (game.game_over_status == GAME_END_PLAYER_WON)
+			fprintf(stdout, " (player %i)", game.game_over_value);
+	}
+	 else
+			fprintf(stdout, ": tick limit reached");
+
+ for (i = 0; i < w.players; i ++)
+	{
+		fprintf(stdout, "\n Player %i: %i processes, %i data", i, w.player[i].processes, w.player[i].data);
+	}
+ fprintf(stdout, "\n Activity: %i cores built, %i packets fired, %i broadcast messages received", activity.cores_built, activity.packets_fired, activity.broadcasts_received);
+
+ result->ticks = ticks;
+ result->game_phase = game.phase;
+ result->game_over_status = game.game_over_status;
+ result->game_over_value = game.game_over_value;
+ for (i = 0; i < PLAYERS; i ++)
+	{
+		result->processes [i] = 0;
+		result->data [i] = 0;
+		if (i < w.players)
+		{
+			result->processes [i] = w.player[i].processes;
+			result->data [i] = w.player[i].data;
+		}
+	}
+ result->proc_hash = hash_procs();
+ result->cores_built = activity.cores_built;
+ result->packets_fired = activity.packets_fired;
+ result->broadcasts_received = activity.broadcasts_received;
+
+ checked_activity.cores_built += activity.cores_built;
+ checked_activity.packets_fired += activity.packets_fired;
+ checked_activity.broadcasts_received += activity.broadcasts_received;
+
+ profile_end_game();
+
+ deallocate_world();
+
+}
+
+// Plays a game with the optimiser off and then on (templates are recompiled in COMPILE_MODE_LOCK when a game starts, so this is enough to change the bcode).
+// Returns 0 if both games ended in the same way, 1 if they didn't, or -1 if a game couldn't be started.
+static int check_optimised_match(struct headless_options_struct* hopt, int match)
+{
+
+ struct headless_result_struct unoptimised, optimised;
+ int saved_optimise = settings.option [OPTION_OPTIMISE];
+
+ settings.option [OPTION_OPTIMISE] = 0;
+ int started = run_headless_match(hopt, match, &unoptimised);
+
+ settings.option [OPTION_OPTIMISE] = OPTIMISE_MODES_ALL;
+ if (started)
+		started = run_headless_match(hopt, match, &optimised);
+
+ settings.option [OPTION_OPTIMISE] = saved_optimise;
+
+ if (!started)
+		return -1;
+
+ return compare_results(&unoptimised, &optimised, match, "with optimiser");
+
+}
+
+// Plays a game with cores executed in phases by 1 thread and then by hopt->check_core_threads threads.
+// Returns 0 if both games ended in the same way, 1 if they didn't, or -1 if a game couldn't be started.
+static int check_core_threads_match(struct headless_options_struct* hopt, int match)
+{
+
+ struct headless_result_struct single, multiple;
+ int saved_core_threads = settings.option [OPTION_CORE_THREADS];
+ char description [40];
+
+ settings.option [OPTION_CORE_THREADS] = 1;
+ int started = run_headless_match(hopt, match, &single);
+
+ settings.option [OPTION_CORE_THREADS] = hopt->check_core_threads;
+ if (started)
+		started = run_headless_match(hopt, match, &multiple);
+
+ settings.option [OPTION_CORE_THREADS] = saved_core_threads;
+
+ if (!started)
+		return -1;
+
+ sprintf(description, "with %i core threads", hopt->check_core_threads);
+
+ return compare_results(&single, &multiple, match, description);
+
+}
+
+// Plays a game, saving it after hopt->check_save ticks, then loads the save and plays it again from there.
+// Returns 0 if both games ended in the same way (or the game ended before it could be saved), 1 if they didn't, or -1 if
+//  a game couldn't be started, saved or loaded.
+static int check_saved_match(struct headless_options_struct* hopt, int match)
+{
+
+ struct headless_result_struct continuous, loaded;
+ static struct headless_activity_struct saved_activity; // activity up to the save (static because it's large)
+
+ if (!start_headless_match(hopt, match))
+		return -1;
+
+ double start_time = al_get_time();
+ int ticks = run_headless_ticks(hopt, 0, hopt->check_save);
+
+ if (game.phase != GAME_PHASE_WORLD)
+	{
+		finish_headless_match(match, ticks, al_get_time() - start_time, &continuous);
+		fprintf(stdout, "\nMatch %i: ended before tick %i, so wasn't saved.", match, hopt->check_save);
+		return 0;
+	}
+
+ if (!save_game_to_path(HEADLESS_SAVE_FILE))
+	{
+		fprintf(stdout, "\nError: couldn't save match %i", match);
+		print_last_log_line();
+		finish_headless_match(match, ticks, al_get_time() - start_time, &continuous);
+		return -1;
+	}
+
+ saved_activity = activity;
+
+ ticks = run_headless_ticks(hopt, ticks, 0);
+ finish_headless_match(match, ticks, al_get_time() - start_time, &continuous);
+
+// finish_headless_match() has deallocated the world, and load_game_from_path() allocates a new one:
+ if (!load_game_from_path(HEADLESS_SAVE_FILE))
+	{
+		fprintf(stdout, "\nError: couldn't load match %i", match);
+		print_last_log_line();
+		remove(HEADLESS_SAVE_FILE);
+		return -1;
+	}
+
+ remove(HEADLESS_SAVE_FILE);
+
+// the loaded game carries on counting from where the saved one was:
+ activity = saved_activity;
+
+ profile_start_game();
+ start_time = al_get_time();
+ ticks = run_headless_ticks(hopt, hopt->check_save, 0);
+ finish_headless_match(match, ticks, al_get_time() - start_time, &loaded);
+
+ return compare_results(&continuous, &loaded, match, "after loading");
+
+}
+
+// Returns 0 if the results are the same, 1 if they aren't (after printing the difference).
+static int compare_results(struct headless_result_struct* result1, struct headless_result_struct* result2, int match, const char* description)
+{
+
+ if (memcmp(result1, result2, sizeof(struct headless_result_struct)) == 0)
+	{
+		fprintf(stdout, "\nMatch %i: same %s.", match, description);
+		return 0;
+	}
+
+ fprintf(stdout, "\nMatch %i: DIFFERENT %s (ticks %i/%i, proc hash %08x/%08x).",
+									match, description, result1->ticks, result2->ticks, result1->proc_hash, result2->proc_hash);
+ return 1;
+
+}
+
+// Called after each tick. Counts the cores built, packets fired and broadcast messages received during the tick.
+static void record_activity(void)
+{
+
+ int i, j;
+ timestamp tick_time = w.world_time - 1; // the tick has incremented w.world_time
+
+ for (i = 0; i < w.max_cores; i ++)
+	{
+		if (w.core[i].exists != 1)
+		{
+			activity.messages_received [i] = 0;
+			continue;
+		}
+		if (w.core[i].created_timestamp == tick_time
+			&& tick_time != activity.start_time)
+			activity.cores_built ++;
+// messages_received is reset when the core executes, so if it's gone down the messages from index 0 are new:
+		j = activity.messages_received [i];
+		if (w.core[i].messages_received < j)
+			j = 0;
+		for (; j < w.core[i].messages_received; j ++)
+		{
+			if (w.core[i].message[j].type == MESSAGE_TYPE_BROADCAST
+				|| w.core[i].message[j].type == MESSAGE_TYPE_BROADCAST_TARGET)
+				activity.broadcasts_received ++;
+		}
+		activity.messages_received [i] = w.core[i].messages_received;
+	}
+
+ for (i = 0; i < w.max_packets; i ++)
+	{
+		if (w.packet[i].exists == 1
+			&& w.packet[i].created_timestamp == tick_time)
+			activity.packets_fired ++;
+	}
+
+}
+
+// Returns 1 (after printing a message) if the games played by a check didn't build, fire and broadcast, as they wouldn't have tested much.
+static int check_activity(const char* check_name)
+{
+
+ if (checked_activity.cores_built > 0
+		&& checked_activity.packets_fired > 0
+		&& checked_activity.broadcasts_received > 0)
+		return 0;
+
+ fprintf(stdout, "%s failed: the games didn't build cores, fire packets and broadcast (%i cores built, %i packets fired, %i broadcast messages received). Use longer games or templates that do more (see -init).\n",
+									check_name, checked_activity.cores_built, checked_activity.packets_fired, checked_activity.broadcasts_received);
+
+ return 1;
+
+}
+
+// save and load errors go to the log, which isn't displayed when headless
+static void print_last_log_line(void)
+{
+
+ fprintf(stdout, ": %s\n", mlog.log_line[(mlog.lpos + LOG_LINES - 1) % LOG_LINES].text);
+
+}
+
+// Combines the index, hp and position of every existing proc (FNV-1a).
+static unsigned int hash_procs(void)
+{
+
+ unsigned int hash = 2166136261u;
+ int i, j;
+
+ for (i = 0; i < w.max_procs; i ++)
+	{
+		if (w.proc[i].exists != 1)
+			continue;
+		int values [4] = {i, w.proc[i].hp, w.proc[i].position.x, w.proc[i].position.y};
+		for (j = 0; j < 4; j ++)
+		{
+			hash = (hash ^ (unsigned int) values [j]) * 16777619u;
+		}
+	}
+
+ return hash;
+
+}
+
+static const char* game_end_name(int game_end_status)
+{
+
+ switch(game_end_status)
+ {
+  case GAME_END_PLAYER_WON: return "player won";
+  case GAME_END_DRAW: return "draw";
+  case GAME_END_DRAW_OUT_OF_TIME: return "draw (out of time)";
+  default: return "game over";
+ }
+
+}
+
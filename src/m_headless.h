@@ -0,0 +1,8 @@
+
+#ifndef H_M_HEADLESS
+#define H_M_HEADLESS
+
+int run_headless(int argc, char** argv);
+
+#endif
+
@@ -67,7 +67,9 @@ Main/miscellaneous
 
 m_input.c - contains Allegro calls that read user input (see also i_input.c)
 m_main.c - this file. Contains the main function and some initialisation stuff
+m_headless.c - the headless simulation runner (used instead of the normal startup when compiled with HEADLESS)
 m_maths.c - special maths functions
+m_profile.c - optional tick-phase profiler (turned on from init.txt)
 
 m_config.h - header file containing some configuration options
 m_globvars.h - a few global variable extern declarations
@@ -112,6 +114,7 @@ h_story.c - general story code
 Interface (runs the display)
 
 i_background.c - some background stuff. May not actually do anything at the moment.
+i_back_cache.c - keeps the vertices for the background nodes between frames
 i_buttons.c - contains code for interface buttons
 i_console.c - runs consoles (the text boxes that appear on the game display) and a few other things
 i_disp_in.c - contains some display initialisation code
@@ -165,12 +168,14 @@ v_interp.c - contains the bcode interpreter
 
 Compiler
 
+c_cache.c - caches compiled templates on disk so unchanged source doesn't need to be compiled again
 c_compile.c - the compiler
 c_fix.c - converts the #process header into a process design for a template
 c_generate.c - generates bcode from the compiler's output
 c_init.c - initialises the compiler
 c_keywords.c - giant list of compiler keywords
 c_lexer.c - the compiler's lexer
+c_optimise.c - removes redundant instructions from the compiler's output before bcode is generated
 c_prepr.c - the minimal preprocessor
 
 c_header.h - contains a lot of compiler-related stuff
@@ -231,6 +236,7 @@ z_poly.c - an editor for me to use to design components. Generates code
 
 #include "g_game.h"
 #include "g_misc.h"
+#include "g_proc_par.h"
 #include "i_disp_in.h"
 #include "i_display.h"
 #include "i_header.h"
@@ -238,6 +244,7 @@ z_poly.c - an editor for me to use to design components. Generates code
 #include "i_view.h"
 
 #include "c_header.h"
+#include "c_cache.h"
 #include "e_editor.h"
 #include "e_header.h"
 #include "e_slider.h"
@@ -265,6 +272,10 @@ z_poly.c - an editor for me to use to design components. Generates code
 
 #include "z_poly.h"
 
+#ifdef HEADLESS
+#include "m_headless.h"
+#endif
+
 // timer interrupt functions and variables:
 void framecount(void);
 
@@ -310,6 +321,11 @@ int main(int argc, char **argv)
 	return -1;
   }
 
+#ifdef HEADLESS
+  // the headless runner (m_headless.c) doesn't need a display, timers or any of the startup below
+  return run_headless(argc, argv);
+#endif
+
   timer = al_create_timer((float)1.0 / 60);
   if (!timer)
   {
@@ -356,6 +372,8 @@ int main(int argc, char **argv)
 
   fpr("\n editor");
 
+  init_compile_cache(); // in c_cache.c. This call must be before load_default_templates()
+
   init_all_templates(); // in t_template.c. This call must be after init_editor() and init_at_startup()
 
   load_default_templates(); // in t_template.c. This call must be after init_all_templates() and also after read_initfile().
@@ -458,6 +476,11 @@ void init_at_startup(void)
   settings.option[OPTION_CAPTURE_MOUSE] = 0;
   settings.option[OPTION_DOUBLE_FONTS] = 0;
   settings.option[OPTION_LARGE_FONTS] = 0;
+  settings.option[OPTION_PROFILE] = 0;
+  settings.option[OPTION_OPTIMISE] = 0;
+  settings.option[OPTION_COMPILE_THREADS] = 0;
+  settings.option[OPTION_CORE_THREADS] = 0;
+  settings.option[OPTION_SIM_THREAD] = 0;
 
   ALLEGRO_PATH *data_path = al_get_standard_path(ALLEGRO_USER_DATA_PATH);
   al_make_directory(al_path_cstr(data_path, ALLEGRO_NATIVE_PATH_SEP));
@@ -855,6 +878,20 @@ int read_initfile_line(char *buffer, int buffer_length, int bpos)
 	return bpos;
   }
 
+  if (strcmp(initfile_word, "profile") == 0)
+  {
+	bpos = read_initfile_number(&read_number, buffer, buffer_length, bpos);
+	if (bpos == -1)
+	  return -1;
+	if (read_number < 0 || read_number > 2)
+	{
+	  fprintf(stdout, "\nProfile value (%i) should be 0, 1 or 2.", read_number);
+	  read_number = 0;
+	}
+	settings.option[OPTION_PROFILE] = read_number;
+	return bpos;
+  }
+
   if (strcmp(initfile_word, "true_fullscreen") == 0)
   {
 	settings.option[OPTION_FULLSCREEN_TRUE] = 1;
@@ -867,6 +904,54 @@ int read_initfile_line(char *buffer, int buffer_length, int bpos)
 	return bpos;
   }
 
+  if (strcmp(initfile_word, "optimise") == 0)
+  {
+	bpos = read_initfile_number(&read_number, buffer, buffer_length, bpos);
+	if (bpos == -1)
+	  return -1;
+	if (read_number < 0 || read_number > OPTIMISE_MODES_ALL)
+	{
+	  fprintf(stdout, "\nOptimise value (%i) should be 0 to %i.", read_number, OPTIMISE_MODES_ALL);
+	  read_number = 0;
+	}
+	settings.option[OPTION_OPTIMISE] = read_number;
+	return bpos;
+  }
+
+  if (strcmp(initfile_word, "compile_threads") == 0)
+  {
+	bpos = read_initfile_number(&read_number, buffer, buffer_length, bpos);
+	if (bpos == -1)
+	  return -1;
+	if (read_number < 0 || read_number > COMPILE_THREADS_MAX)
+	{
+	  fprintf(stdout, "\nCompile_threads value (%i) should be 0 to %i.", read_number, COMPILE_THREADS_MAX);
+	  read_number = 0;
+	}
+	settings.option[OPTION_COMPILE_THREADS] = read_number;
+	return bpos;
+  }
+
+  if (strcmp(initfile_word, "core_threads") == 0)
+  {
+	bpos = read_initfile_number(&read_number, buffer, buffer_length, bpos);
+	if (bpos == -1)
+	  return -1;
+	if (read_number < 0 || read_number > CORE_THREADS_MAX)
+	{
+	  fprintf(stdout, "\nCore_threads value (%i) should be 0 to %i.", read_number, CORE_THREADS_MAX);
+	  read_number = 0;
+	}
+	settings.option[OPTION_CORE_THREADS] = read_number;
+	return bpos;
+  }
+
+  if (strcmp(initfile_word, "sim_thread") == 0)
+  {
+	settings.option[OPTION_SIM_THREAD] = 1;
+	return bpos;
+  }
+
   if (strcmp(initfile_word, "capture_mouse") == 0)
   {
 	settings.option[OPTION_CAPTURE_MOUSE] = 1;
@@ -0,0 +1,144 @@
+/*
+
+Tick-phase profiler.
+
+Times each phase of a world tick (and the display) with al_get_time(), which uses the system's monotonic high-resolution clock.
+ The results for the most recent ticks are kept in profile.history for the overlay drawn by draw_profile_overlay() in i_display.c,
+ and can also be written to profile.csv (one line per tick).
+
+The display isn't run every tick (and is run while paused), so time spent on the display is added to the next tick's line.
+
+Profiling is off unless turned on by the "profile" line in init.txt (see m_profile.h). When off, each PROFILE_START/PROFILE_END is just a test of profile.on.
+
+*/
+
+#include <allegro5/allegro.h>
+
+#include <stdio.h>
+
+#include "m_config.h"
+#include "g_header.h"
+#include "m_globvars.h"
+
+#include "m_profile.h"
+
+struct profile_struct profile;
+
+const char* profile_phase_name [PROFILE_PHASES] =
+{
+"world", // PROFILE_RUN_WORLD
+"motion", // PROFILE_MOTION
+"cores", // PROFILE_CORES
+"packets", // PROFILE_PACKETS
+"vision", // PROFILE_VISION
+"display", // PROFILE_DISPLAY
+"draw_vbuf", // PROFILE_DRAW_VBUF
+};
+
+// Call at the start of each game (after the world has been set up).
+void profile_start_game(void)
+{
+
+ int i;
+
+ profile.on = settings.option [OPTION_PROFILE];
+
+ for (i = 0; i < PROFILE_PHASES; i ++)
+	{
+		profile.phase_time [i] = 0;
+		profile.total_time [i] = 0;
+	}
+	profile.cores_executed = 0;
+	profile.history_pos = 0;
+	profile.history_length = 0;
+	profile.total_ticks = 0;
+	profile.csv_file = NULL;
+
+	if (profile.on < 2)
+		return;
+
+	profile.csv_file = fopen("profile.csv", "wt");
+
+	if (profile.csv_file == NULL)
+	{
+		fprintf(stdout, "\nFailed to open profile.csv for writing.");
+		return;
+	}
+
+	fprintf(profile.csv_file, "tick");
+ for (i = 0; i < PROFILE_PHASES; i ++)
+	{
+		fprintf(profile.csv_file, ",%s_ms", profile_phase_name [i]);
+	}
+	fprintf(profile.csv_file, ",cores_executed\n");
+
+}
+
+// Call at the end of each world tick. Moves the times accumulated during the tick into the history (and the csv file)
+void profile_end_tick(void)
+{
+
+ int i;
+
+ if (!profile.on)
+		return;
+
+ for (i = 0; i < PROFILE_PHASES; i ++)
+	{
+		profile.history [profile.history_pos] [i] = profile.phase_time [i] * 1000;
+		profile.total_time [i] += profile.phase_time [i];
+	}
+	profile.history_cores [profile.history_pos] = profile.cores_executed;
+
+	if (profile.csv_file != NULL)
+	{
+		fprintf(profile.csv_file, "%u", w.world_time);
+  for (i = 0; i < PROFILE_PHASES; i ++)
+		{
+			fprintf(profile.csv_file, ",%.4f", profile.history [profile.history_pos] [i]);
+		}
+		fprintf(profile.csv_file, ",%i\n", profile.cores_executed);
+	}
+
+ for (i = 0; i < PROFILE_PHASES; i ++)
+	{
+		profile.phase_time [i] = 0;
+	}
+	profile.cores_executed = 0;
+
+	profile.history_pos ++;
+	if (profile.history_pos >= PROFILE_HISTORY)
+		profile.history_pos = 0;
+	if (profile.history_length < PROFILE_HISTORY)
+		profile.history_length ++;
+	profile.total_ticks ++;
+
+}
+
+// Call at the end of each game. Prints the average time per tick for each phase, and closes the csv file.
+void profile_end_game(void)
+{
+
+ int i;
+
+ if (!profile.on)
+		return;
+
+ if (profile.total_ticks > 0)
+	{
+		fprintf(stdout, "\nProfile (average ms per tick over %u ticks):", profile.total_ticks);
+  for (i = 0; i < PROFILE_PHASES; i ++)
+		{
+			fprintf(stdout, " %s %.3f", profile_phase_name [i], profile.total_time [i] * 1000 / profile.total_ticks);
+		}
+	}
+
+	if (profile.csv_file != NULL)
+	{
+		fclose(profile.csv_file);
+		profile.csv_file = NULL;
+	}
+
+	profile.on = 0;
+
+}
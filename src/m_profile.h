@@ -0,0 +1,61 @@
+
+#ifndef H_M_PROFILE
+#define H_M_PROFILE
+
+/*
+
+Tick-phase profiler (see m_profile.c).
+
+Turned on by the "profile" line in init.txt:
+ profile 1 - shows the timing overlay at the top left of the main panel
+ profile 2 - also writes a line for each tick to profile.csv
+
+*/
+
+enum
+{
+PROFILE_RUN_WORLD, // run_world() (data wells etc)
+PROFILE_MOTION, // run_motion()
+PROFILE_CORES, // execute_bcode() for all cores that executed this tick
+PROFILE_PACKETS, // run_packets()
+PROFILE_VISION, // update_vision_area()
+PROFILE_DISPLAY, // run_display() (includes PROFILE_DRAW_VBUF)
+PROFILE_DRAW_VBUF, // draw_vbuf() - sending the layered vertex buffers to the screen
+
+PROFILE_PHASES
+};
+
+#define PROFILE_HISTORY 128
+
+struct profile_struct
+{
+ int on; // 0, 1 or 2 (set from settings.option [OPTION_PROFILE])
+
+ double phase_start [PROFILE_PHASES];
+ double phase_time [PROFILE_PHASES]; // accumulated (in seconds) since the end of the previous tick
+ int cores_executed;
+
+ float history [PROFILE_HISTORY] [PROFILE_PHASES]; // milliseconds per tick for the last PROFILE_HISTORY ticks
+ int history_cores [PROFILE_HISTORY];
+ int history_pos; // index of the next entry to be written
+ int history_length; // number of valid entries (up to PROFILE_HISTORY)
+
+ double total_time [PROFILE_PHASES]; // totals for the current game, for the summary printed by profile_end_game()
+ unsigned int total_ticks;
+
+ FILE* csv_file;
+};
+
+extern struct profile_struct profile;
+
+extern const char* profile_phase_name [PROFILE_PHASES];
+
+// PROFILE_START and PROFILE_END should surround each call that's being timed. Time between them is added to the phase's total for the current tick.
+#define PROFILE_START(phase) do {if (profile.on) profile.phase_start [phase] = al_get_time();} while(0)
+#define PROFILE_END(phase) do {if (profile.on) profile.phase_time [phase] += al_get_time() - profile.phase_start [phase];} while(0)
+
+void profile_start_game(void);
+void profile_end_tick(void);
+void profile_end_game(void);
+
+#endif
@@ -2038,7 +2038,7 @@ void run_menu_input(void)
 
 		  case EL_ACTION_RANDOMISE_CODE:
 			play_interface_sound(SAMPLE_BLIP1, TONE_2A);
-			w_init.game_seed = grand(1000);
+			w_init.game_seed = irand(1000);
 			fix_map_code();
 			reset_map_for_menu();
 			break;
@@ -2518,10 +2518,10 @@ void run_menu_stripes(int draw)
 
   if (mstate.stripe_next_group_count <= 0)
   {
-	mstate.stripe_next_group_count = 300 + grand(300);
+	mstate.stripe_next_group_count = 300 + irand(300);
 	mstate.stripe_group_time = 0;
 	mstate.stripe_next_stripe = 1;
-	int new_col = grand(STRIPE_COLS - 1);
+	int new_col = irand(STRIPE_COLS - 1);
 	if (new_col == mstate.stripe_group_col)
 	  new_col++; // this is the only way to get col 11
 	mstate.stripe_group_col = new_col;
@@ -2546,8 +2546,8 @@ void run_menu_stripes(int draw)
 		  mstate.stripe_shade[i] = mstate.stripe_group_shade;
 		  if (mstate.stripe_group_time < 100)
 		  {
-			mstate.stripe_size[i] = 10 + grand(40);
-			mstate.stripe_next_stripe = mstate.stripe_size[i] + 5 + grand(50);
+			mstate.stripe_size[i] = 10 + irand(40);
+			mstate.stripe_next_stripe = mstate.stripe_size[i] + 5 + irand(50);
 		  }
 		  else
 		  {
@@ -22,6 +22,7 @@
 
 #include "p_panels.h"
 #include "d_draw.h"
+#include "i_snapshot.h"
 
 extern struct game_struct game;
 extern struct fontstruct font [FONTS];
@@ -42,7 +43,7 @@ void draw_template_panel(void)
  al_draw_textf(font[FONT_SQUARE].fnt, colours.base [COL_GREY] [SHADE_MAX], panel[PANEL_TEMPLATE].x1 + 2, panel[PANEL_TEMPLATE].y1 + 2, ALLEGRO_ALIGN_LEFT, "Templates");
 
 // first draw the tabs along the top:
- for (i = 0; i < w.players; i ++)
+ for (i = 0; i < dw->players; i ++)
 	{
     		el = FPE_TEMPLATES_TAB_P0 + i;
     		int button_col = COL_BLUE;
@@ -21,6 +21,7 @@
 #include "e_log.h"
 #include "e_files.h"
 
+#include "c_compile.h"
 #include "c_fix.h"
 #include "c_prepr.h"
 #include "t_template.h"
@@ -40,7 +41,6 @@ TFILE_ERROR_TEMPLATE, // something wrong with template
 };
 
 extern struct tstatestruct tstate;
-extern struct procdef_struct procdef;
 extern struct template_struct templ [PLAYERS] [TEMPLATES_PER_PLAYER];
 extern ALLEGRO_DISPLAY* display;
 
@@ -52,6 +52,7 @@ struct tfilestruct
  int template_file_buffer_pos;
  int error_state;
  struct template_struct* templ;
+ struct procdef_struct procdef; // the process definition of the template being written or read
 	int procdef_address [TEMPLATES_PER_PLAYER];
 	int procdef_end [TEMPLATES_PER_PLAYER];
 	int bcode_address [TEMPLATES_PER_PLAYER];
@@ -256,7 +257,7 @@ static int write_bcode_to_tfile(void)
 int write_procdef_to_tfile(void)
 {
 
- if (!derive_procdef_from_template(tfile.templ))
+ if (!derive_procdef_from_template(&tfile.procdef, tfile.templ))
 	{
   write_line_to_log("Failed to derive process definition from template.", MLOG_COL_ERROR);
   return 0; // not sure this is possible (lock_template() should have failed earlier if there's a problem with the template)
@@ -264,18 +265,18 @@ int write_procdef_to_tfile(void)
 
 	int i = 0;
 
-	while(procdef.template_name [i] != 0)
+	while(tfile.procdef.template_name [i] != 0)
 	{
-		write_tbuffer(procdef.template_name [i++]);
+		write_tbuffer(tfile.procdef.template_name [i++]);
 // I'm pretty sure we can assume that this will be null-terminated within TEMPLATE_NAME_LENGTH
 	}
 	write_tbuffer(0); // terminates string
 
-	for (i = 0; i < procdef.buffer_length; i ++)
+	for (i = 0; i < tfile.procdef.buffer_length; i ++)
 	{
-		write_tbuffer_s16b(procdef.buffer [i]);
+		write_tbuffer_s16b(tfile.procdef.buffer [i]);
 	}
-//fpr("\n procdef.buffer_length %i tfile.template_file_buffer_pos %i\n", procdef.buffer_length, tfile.template_file_buffer_pos);
+//fpr("\n tfile.procdef.buffer_length %i tfile.template_file_buffer_pos %i\n", tfile.procdef.buffer_length, tfile.template_file_buffer_pos);
 	if (tfile.error_state != TFILE_ERROR_NONE)
 		return 0;
 
@@ -451,7 +452,7 @@ void load_template_file(int player_index)
 					}
 					if (!read_procdef_from_tfile(tfile.procdef_end [i]))
 						return;
-					if (!fix_template_design_from_procdef(&templ[player_index][i]))
+					if (!fix_template_design_from_procdef(&tfile.procdef, &templ[player_index][i]))
 						return;
 					if (!read_bcode_from_tfile(&templ[player_index][i], tfile.bcode_end [i]))
 						return;
@@ -465,7 +466,7 @@ void load_template_file(int player_index)
      strcpy(templ[player_index][i].source_edit->text [1], "//  and does not have source code. ");
       // clear_source_edit_struct() call above reset the line index, so text[0] is the first line
 
-     prepare_template_debug(player_index, i, 0); // sets up the BC panel information. ,0 means no identifier (variable and label name) information will be included.
+     prepare_template_debug(player_index, i, NULL); // sets up the BC panel information. NULL means no identifier (variable and label name) information will be included.
 				}
 
 
@@ -487,8 +488,8 @@ static int read_procdef_from_tfile(int end_address)
 
 	for (i = 0; i < TEMPLATE_NAME_LENGTH; i++)
 	{
-		procdef.template_name [i] = read_tbuffer();
-		if (procdef.template_name [i] == 0)
+		tfile.procdef.template_name [i] = read_tbuffer();
+		if (tfile.procdef.template_name [i] == 0)
 			break;
 	}
 	if (i == TEMPLATE_NAME_LENGTH)
@@ -499,14 +500,14 @@ static int read_procdef_from_tfile(int end_address)
 
 	for (i = 0; i < PROCDEF_BUFFER; i ++)
 	{
-		procdef.buffer [i] = read_tbuffer_s16b();
-		procdef.buffer_source_line [i] = 0;
+		tfile.procdef.buffer [i] = read_tbuffer_s16b();
+		tfile.procdef.buffer_source_line [i] = 0;
 		if (tfile.template_file_buffer_pos >= end_address)
 			break;
 	}
 
-	procdef.buffer_length = i+1;
-//	fpr("\n template buffer pos %i", procdef.buffer_length);
+	tfile.procdef.buffer_length = i+1;
+//	fpr("\n template buffer pos %i", tfile.procdef.buffer_length);
 	return 1;
 
 }
@@ -660,10 +661,14 @@ static int choose_template_file(int filechooser_mode)
 
 
 // called at startup. Loads any templates specified as default templates by init.txt.
+// Works like calling load_source_file_into_template() for each template, but the sources are all loaded first and then compiled
+//  together by compile_templates() (which can compile several at once).
 void load_default_templates(void)
 {
 
 	int i, j;
+	struct template_struct* compile_templ [PLAYERS * TEMPLATES_PER_PLAYER];
+	int templates = 0;
 
 	for (i = 0; i < PLAYERS; i ++)
 	{
@@ -671,10 +676,14 @@ void load_default_templates(void)
 		{
 			if (settings.default_template_path [i] [j] [0] == 0)
 				continue; // no default for this template
-			load_source_file_into_template(settings.default_template_path [i] [j], i, j);
+			if (load_source_file_into_template_without_compiling(settings.default_template_path [i] [j], i, j, (templ[i][j].locked == 0)) == -1)
+				continue;
+			compile_templ [templates] = &templ[i][j];
+			templates ++;
 		}
 	}
 
+	compile_templates(compile_templ, templates, COMPILE_MODE_BUILD);
 
 }
 
@@ -97,7 +97,6 @@ void init_template(struct template_struct* tpl, int player_index, int templ_inde
 
  tpl->esource_index = (player_index * TEMPLATES_PER_PLAYER) + templ_index;
  tpl->source_edit = &editor.source_edit [tpl->esource_index];
-	init_source_edit_struct(templ[player_index][templ_index].source_edit);
 	snprintf(tpl->menu_button_title, TEMPLATE_BUTTON_TITLE_STRING_LENGTH-1, "Player %i template %i", player_index, templ_index);
 
  clear_template_including_source(tpl);
@@ -125,7 +124,7 @@ void clear_template_including_source(struct template_struct* tpl)
 //	tpl->power_use_smoothed = 0;
 	tpl->power_use_base = 0;
 
-	init_source_edit_struct(tpl->source_edit);
+	release_source_edit_struct(tpl->source_edit); // the source is allocated again when needed (e.g. by open_new_template() below)
 
 }
 
@@ -233,6 +232,7 @@ void open_new_template(struct template_struct* tpl)
 	tpl->locked = 0;
 
 	clear_template_including_source(tpl);
+	clear_source_edit_struct(tpl->source_edit);
 
 	tpl->active = 1;
 //	tpl->locked = 0;
@@ -44,7 +44,7 @@ extern struct ex_control_struct ex_control;
 extern struct slider_struct slider [SLIDERS];
 extern struct game_struct game;
 extern struct command_struct command;
-extern struct vmstate_struct vmstate;
+extern THREAD_LOCAL struct vmstate_struct vmstate;
 extern struct view_struct view;
 
 extern struct call_type_struct call_type [CALL_TYPES];
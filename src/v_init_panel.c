@@ -79,11 +79,11 @@ static void clear_template_debug(int player_index, int template_index)
 }
 
 
-// This is called (with use_user_identifiers=1) when the compiler has finished compiling (not test compiling)
+// This is called (with the compiler's identifier list as user_identifier) when the compiler has finished compiling (not test compiling)
 // it builds the template_debug_struct for the template
-// it is also called from the multi-binary loading function with use_user_identifiers=0,
+// it is also called from the multi-binary loading function with user_identifier=NULL,
 //  because multi-binaries don't have identifier information.
-void prepare_template_debug(int player_index, int template_index, int use_user_identifiers)
+void prepare_template_debug(int player_index, int template_index, struct identifierstruct* user_identifier)
 {
 
  int i;
@@ -101,23 +101,23 @@ void prepare_template_debug(int player_index, int template_index, int use_user_i
 		bcode_op_special_type [i] = 0;
 	}
 
- if (use_user_identifiers)
+ if (user_identifier != NULL)
 	{
 // USER_IDENTIFIERS is the start of user-defined identifiers (after all keywords etc)
  for (i = USER_IDENTIFIERS; i < IDENTIFIERS; i ++)
 	{
-		switch(identifier[i].type)
+		switch(user_identifier[i].type)
 		{
 		 case CTOKEN_TYPE_IDENTIFIER_USER_VARIABLE:
-		 	if (identifier[i].address >= MEMORY_SIZE)
+		 	if (user_identifier[i].address >= MEMORY_SIZE)
 					break;
-			 strncpy(tdb->variable[identifier[i].address].name, identifier[i].name, DEBUGGER_NAME_LENGTH);
+			 strncpy(tdb->variable[user_identifier[i].address].name, user_identifier[i].name, DEBUGGER_NAME_LENGTH);
 			 break;
 			case CTOKEN_TYPE_IDENTIFIER_LABEL:
 				if (label_index >= DEBUGGER_LABELS)
 					break;
-			 strncpy(tdb->label[label_index].name, identifier[i].name, DEBUGGER_NAME_LENGTH);
-			 tdb->label[label_index].address = identifier[i].address;
+			 strncpy(tdb->label[label_index].name, user_identifier[i].name, DEBUGGER_NAME_LENGTH);
+			 tdb->label[label_index].address = user_identifier[i].address;
 //			 fpr("\n adding label %i (%s) to address %i", label_index, tdb->label[label_index].name, tdb->label[label_index].address);
 			 if (tdb->label[label_index].address > 0)
 			  bcode_op_special_type [tdb->label[label_index].address] = SOURCE_LINE_LABEL;
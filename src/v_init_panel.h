@@ -5,7 +5,8 @@
 
 
 
-void prepare_template_debug(int player_index, int template_index, int use_user_identifiers);
+struct identifierstruct;
+void prepare_template_debug(int player_index, int template_index, struct identifierstruct* user_identifier);
 
 
 #endif
@@ -17,10 +17,11 @@
 
 #include "v_interp.h"
 #include "v_draw_panel.h"
+#include "g_proc_par.h"
 
-struct vmstate_struct vmstate;
+THREAD_LOCAL struct vmstate_struct vmstate;
 extern struct instruction_set_struct instruction_set [INSTRUCTIONS]; // in c_compile.c
-extern struct scanlist_struct scanlist; // in g_method_std.c. scanlist.current is reset to 0 every cycle.
+extern THREAD_LOCAL struct scanlist_struct scanlist; // in g_method_std.c. scanlist.current is reset to 0 every cycle.
 extern struct bcode_panel_state_struct bcp_state;
 extern struct game_struct game;
 extern struct slider_struct slider [SLIDERS];
@@ -37,12 +38,38 @@ extern struct umethod_call_type_struct umethod_call_type [UMETHOD_CALL_TYPES];
 
 #define get_next_instr if (vmstate.bcode_pos >= BCODE_POS_MAX) goto bcode_bounds_error; instr = vmstate.bcode->op [++vmstate.bcode_pos];
 #define get_next_instr_expect_address if (vmstate.bcode_pos >= BCODE_POS_MAX) goto bcode_bounds_error; instr = vmstate.bcode->op [++vmstate.bcode_pos]; if (instr < 0 || instr >= MEMORY_SIZE) goto memory_address_error;
+// When a core is executed in the parallel phase (see g_proc_par.c), a call that has to wait for the commit phase stops execution
+//  before the call is made, and the core resumes from the same instruction in the commit phase (see suspend_for_commit below).
+// The method type is peeked at here; if it's out of bounds, the get_next_instr in the call itself will find the error.
+#define WAIT_FOR_COMMIT(call_op) if (current_commit != NULL && parallel_call_must_wait(call_op, vmstate.bcode_pos < BCODE_POS_MAX ? vmstate.bcode->op [vmstate.bcode_pos + 1] : -1)) goto suspend_for_commit
+
+// execute_bcode() uses direct threaded dispatch if the compiler supports labels as values (gcc and clang do):
+//  each instruction ends by fetching the next instruction and jumping straight to its code through vm_dispatch_table,
+//  instead of going back through a single switch. This makes branch prediction much better.
+// The code for each instruction is the same either way, so results and instruction counts are identical.
+// Define VM_SWITCH_DISPATCH to use the switch instead (also needed if SHOW_BCODE is turned on in execute_bcode()).
+#if defined(__GNUC__) && !defined(VM_SWITCH_DISPATCH)
+#define VM_THREADED_DISPATCH
+#endif
+
+#ifdef VM_THREADED_DISPATCH
+#define VM_CASE(op) vm_##op
+#define VM_DEFAULT vm_invalid_instruction
+#define VM_DISPATCH if (instr < 0 || instr >= INSTRUCTIONS) goto vm_invalid_instruction; goto *vm_dispatch_table [instr]
+#define VM_NEXT do {get_next_instr; vmstate.instructions_left --; if (vmstate.instructions_left <= 0) goto out_of_instructions_error; VM_DISPATCH;} while(0)
+#else
+#define VM_CASE(op) case op
+#define VM_DEFAULT default
+#define VM_NEXT break
+#endif
 
+static int run_bcode(struct core_struct* core);
 static void	print_execution_error(const char* error_message, int values, int value1);
 int execute_bcode_single_step_for_watch(void);
 static void print_method_parameters(int parameters, char* log_line_string, char* first_parameter_text, char* second_parameter_text);
 
-void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memory)
+// returns 1 if execution stopped to wait for the commit phase (which can only happen if current_commit is set - see g_proc_par.c), 0 otherwise
+int execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memory)
 {
 
 	vmstate.core = core;
@@ -56,8 +83,6 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 	vmstate.nearby_well_index = -2; // means this has not yet been calculated
 	scanlist.current = 0; // means the scanlist will need to be built if a scanning function is called.
 
-	char print_string [STRING_MAX_LENGTH];
-
 	int i;
 
 	for (i = 0; i < VM_STACK_SIZE; i ++)
@@ -70,9 +95,52 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 		vmstate.vm_register [i] = 0;
 	}
 
+	return run_bcode(core);
+
+}
+
+// continues an execution that stopped to wait for the commit phase. saved_vmstate is the vmstate when it stopped.
+// returns the same as execute_bcode()
+int resume_bcode(struct core_struct* core, struct vmstate_struct* saved_vmstate)
+{
+
+	vmstate = *saved_vmstate;
+	scanlist.current = 0; // the scanlist belongs to the thread that was executing the core, so it needs to be built again
+
+	return run_bcode(core);
+
+}
+
+static int run_bcode(struct core_struct* core)
+{
+
+	s16b* memory = vmstate.memory;
+	char print_string [STRING_MAX_LENGTH];
+
+	int i;
+
 	s16b instr;
 	int value [3];
 
+#ifdef VM_THREADED_DISPATCH
+// must be in the same order as the OP_ enum in c_header.h
+	static const void* const vm_dispatch_table [INSTRUCTIONS] =
+	{
+		&&vm_OP_nop, &&vm_OP_pushA, &&vm_OP_popB, &&vm_OP_add, &&vm_OP_sub_BA, &&vm_OP_sub_AB, &&vm_OP_mul,
+		&&vm_OP_div_BA, &&vm_OP_div_AB, &&vm_OP_mod_BA, &&vm_OP_mod_AB, &&vm_OP_not, &&vm_OP_and, &&vm_OP_or,
+		&&vm_OP_xor, &&vm_OP_lsh_BA, &&vm_OP_lsh_AB, &&vm_OP_rsh_BA, &&vm_OP_rsh_AB, &&vm_OP_lnot,
+		&&vm_OP_setA_num, &&vm_OP_setA_mem, &&vm_OP_copyA_to_mem, &&vm_OP_push_num, &&vm_OP_push_mem,
+		&&vm_OP_incr_mem, &&vm_OP_decr_mem, &&vm_OP_jump_num, &&vm_OP_jumpA, &&vm_OP_comp_eq, &&vm_OP_comp_gr,
+		&&vm_OP_comp_greq, &&vm_OP_comp_ls, &&vm_OP_comp_lseq, &&vm_OP_comp_neq, &&vm_OP_iftrue_jump,
+		&&vm_OP_iffalse_jump, &&vm_OP_mulA_num, &&vm_OP_addA_num, &&vm_OP_derefA, &&vm_OP_copyA_to_derefB,
+		&&vm_OP_incr_derefA, &&vm_OP_decr_derefA, &&vm_OP_copyAtoB, &&vm_OP_deref_stack_toA,
+		&&vm_OP_push_return_address, &&vm_OP_return_sub, &&vm_OP_switchA, &&vm_OP_pcomp_eq, &&vm_OP_pcomp_neq,
+		&&vm_OP_print, &&vm_OP_printA, &&vm_OP_bubble, &&vm_OP_bubbleA, &&vm_OP_call_object, &&vm_OP_call_member,
+		&&vm_OP_call_core, &&vm_OP_call_extern_member, &&vm_OP_call_extern_core, &&vm_OP_call_std,
+		&&vm_OP_call_std_var, &&vm_OP_call_uni, &&vm_OP_call_class, &&vm_OP_stop, &&vm_OP_terminate
+	};
+#endif
+
 //#define SHOW_BCODE
 
 #ifdef SHOW_BCODE
@@ -94,50 +162,55 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 			fpr("\n%04d [%i] %s", vmstate.bcode_pos, w.core[0].memory[1], instruction_set[instr].name);
 #endif
 
+#ifdef VM_THREADED_DISPATCH
+		VM_DISPATCH;
+		{
+#else
 		switch(instr)
 		{
-		 case OP_nop:
-			 break;
-			case OP_pushA:
+#endif
+		 VM_CASE(OP_nop):
+			 VM_NEXT;
+			VM_CASE(OP_pushA):
 				vmstate.vm_stack [vmstate.stack_pos++] = vmstate.vm_register [VM_REG_A];
 				if (vmstate.stack_pos >= VM_STACK_SIZE)
 					goto stack_full_error;
-				break;
-			case OP_popB:
+				VM_NEXT;
+			VM_CASE(OP_popB):
 				vmstate.stack_pos --;
 				if (vmstate.stack_pos <= 0)
 					goto stack_below_zero_error;
 				vmstate.vm_register [VM_REG_B] = vmstate.vm_stack [vmstate.stack_pos];
-				break;
-			case OP_add:
+				VM_NEXT;
+			VM_CASE(OP_add):
 				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_B] + vmstate.vm_register [VM_REG_A];
-				break;
-			case OP_sub_BA:
+				VM_NEXT;
+			VM_CASE(OP_sub_BA):
 				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_B] - vmstate.vm_register [VM_REG_A];
-				break;
-			case OP_sub_AB:
+				VM_NEXT;
+			VM_CASE(OP_sub_AB):
 				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_A] - vmstate.vm_register [VM_REG_B];
-				break;
-			case OP_mul:
+				VM_NEXT;
+			VM_CASE(OP_mul):
 				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_B] * vmstate.vm_register [VM_REG_A];
-				break;
-			case OP_div_BA:
+				VM_NEXT;
+			VM_CASE(OP_div_BA):
 // division costs an extra instruction:
 		  vmstate.instructions_left --;
 				if (vmstate.vm_register [VM_REG_A] == 0)
 					vmstate.vm_register [VM_REG_A] = 0;
 				  else
    				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_B] / vmstate.vm_register [VM_REG_A];
-				break;
-			case OP_div_AB:
+				VM_NEXT;
+			VM_CASE(OP_div_AB):
 // division costs an extra instruction:
 		  vmstate.instructions_left --;
 				if (vmstate.vm_register [VM_REG_B] == 0)
 					vmstate.vm_register [VM_REG_A] = 0;
 				  else
    				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_A] / vmstate.vm_register [VM_REG_B];
-				break;
-			case OP_mod_BA:
+				VM_NEXT;
+			VM_CASE(OP_mod_BA):
 		  vmstate.instructions_left --;
 				if (vmstate.vm_register [VM_REG_A] == 0)
 				{
@@ -146,8 +219,8 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 				}
 				  else
    				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_B] % vmstate.vm_register [VM_REG_A];
-				break;
-			case OP_mod_AB:
+				VM_NEXT;
+			VM_CASE(OP_mod_AB):
 		  vmstate.instructions_left --;
 				if (vmstate.vm_register [VM_REG_B] == 0)
 				{
@@ -156,59 +229,59 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 				}
 				  else
    				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_A] % vmstate.vm_register [VM_REG_B];
-				break;
-			case OP_not:
+				VM_NEXT;
+			VM_CASE(OP_not):
 				vmstate.vm_register [VM_REG_A] = ~vmstate.vm_register [VM_REG_A];
-				break;
-			case OP_and:
+				VM_NEXT;
+			VM_CASE(OP_and):
 				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_B] & vmstate.vm_register [VM_REG_A];
-				break;
-			case OP_or:
+				VM_NEXT;
+			VM_CASE(OP_or):
 				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_B] | vmstate.vm_register [VM_REG_A];
-				break;
-			case OP_xor:
+				VM_NEXT;
+			VM_CASE(OP_xor):
 				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_B] ^ vmstate.vm_register [VM_REG_A];
-				break;
-			case OP_lsh_BA:
+				VM_NEXT;
+			VM_CASE(OP_lsh_BA):
 				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_B] << vmstate.vm_register [VM_REG_A];
-				break;
-			case OP_lsh_AB:
+				VM_NEXT;
+			VM_CASE(OP_lsh_AB):
 				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_A] << vmstate.vm_register [VM_REG_B];
-				break;
-			case OP_rsh_BA:
+				VM_NEXT;
+			VM_CASE(OP_rsh_BA):
 				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_B] >> vmstate.vm_register [VM_REG_A];
-				break;
-			case OP_rsh_AB:
+				VM_NEXT;
+			VM_CASE(OP_rsh_AB):
 				vmstate.vm_register [VM_REG_A] = vmstate.vm_register [VM_REG_A] >> vmstate.vm_register [VM_REG_B];
-				break;
-			case OP_lnot:
+				VM_NEXT;
+			VM_CASE(OP_lnot):
 				vmstate.vm_register [VM_REG_A] = !vmstate.vm_register [VM_REG_A];
-				break;
-			case OP_setA_num:
+				VM_NEXT;
+			VM_CASE(OP_setA_num):
 		  vmstate.instructions_left --;
 				get_next_instr;
 				vmstate.vm_register [VM_REG_A] = instr;
 #ifdef SHOW_BCODE
     fpr(" %i", instr);
 #endif
-				break;
-			case OP_setA_mem:
+				VM_NEXT;
+			VM_CASE(OP_setA_mem):
 		  vmstate.instructions_left --;
 				get_next_instr_expect_address;
 				vmstate.vm_register [VM_REG_A] = memory [instr];
 #ifdef SHOW_BCODE
     fpr(" %i", instr);
 #endif
-				break;
-			case OP_copyA_to_mem:
+				VM_NEXT;
+			VM_CASE(OP_copyA_to_mem):
 		  vmstate.instructions_left --;
 				get_next_instr_expect_address;
 				memory [instr] = vmstate.vm_register [VM_REG_A];
 #ifdef SHOW_BCODE
     fpr(" %i", instr);
 #endif
-				break;
-			case OP_push_num:
+				VM_NEXT;
+			VM_CASE(OP_push_num):
 		  vmstate.instructions_left --;
 				get_next_instr;
 #ifdef SHOW_BCODE
@@ -217,8 +290,8 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 				vmstate.vm_stack [vmstate.stack_pos++] = instr;
 				if (vmstate.stack_pos >= VM_STACK_SIZE)
 					goto stack_full_error;
-				break;
-			case OP_push_mem:
+				VM_NEXT;
+			VM_CASE(OP_push_mem):
 		  vmstate.instructions_left --;
 				get_next_instr_expect_address;
 #ifdef SHOW_BCODE
@@ -227,25 +300,25 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 				vmstate.vm_stack [vmstate.stack_pos++] = memory [instr];
 				if (vmstate.stack_pos >= VM_STACK_SIZE)
 					goto stack_full_error;
-				break;
-			case OP_incr_mem:
+				VM_NEXT;
+			VM_CASE(OP_incr_mem):
 		  vmstate.instructions_left --;
 				get_next_instr_expect_address;
 				memory [instr] ++;
 #ifdef SHOW_BCODE
     fpr(" %i", instr);
 #endif
-				break;
-			case OP_decr_mem:
+				VM_NEXT;
+			VM_CASE(OP_decr_mem):
 		  vmstate.instructions_left --;
 				get_next_instr_expect_address;
 				memory [instr] --;
 #ifdef SHOW_BCODE
     fpr(" %i", instr);
 #endif
-				break;
+				VM_NEXT;
 
-			case OP_jump_num:
+			VM_CASE(OP_jump_num):
 		  vmstate.instructions_left --;
 				get_next_instr;
 #ifdef SHOW_BCODE
@@ -254,94 +327,94 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 				if (instr < 0 || instr >= BCODE_POS_MAX)
 					goto jump_target_bounds_error;
 				vmstate.bcode_pos = instr - 1;
-				break;
-			case OP_jumpA:
+				VM_NEXT;
+			VM_CASE(OP_jumpA):
 				if (vmstate.vm_register [VM_REG_A] < 0 || vmstate.vm_register [VM_REG_A] >= BCODE_POS_MAX)
 					goto jump_target_bounds_error;
 				vmstate.bcode_pos = vmstate.vm_register [VM_REG_A] - 1;
-				break;
+				VM_NEXT;
 
-			case OP_comp_eq:
+			VM_CASE(OP_comp_eq):
 				if (vmstate.vm_register [VM_REG_B] == vmstate.vm_register [VM_REG_A]) // note B before A
 					vmstate.vm_register [VM_REG_A] = 1;
 				  else
 						 vmstate.vm_register [VM_REG_A] = 0;
-				break;
-			case OP_comp_gr:
+				VM_NEXT;
+			VM_CASE(OP_comp_gr):
 				if (vmstate.vm_register [VM_REG_B] > vmstate.vm_register [VM_REG_A]) // note B before A
 					vmstate.vm_register [VM_REG_A] = 1;
 				  else
 						 vmstate.vm_register [VM_REG_A] = 0;
-				break;
-			case OP_comp_greq:
+				VM_NEXT;
+			VM_CASE(OP_comp_greq):
 				if (vmstate.vm_register [VM_REG_B] >= vmstate.vm_register [VM_REG_A]) // note B before A
 					vmstate.vm_register [VM_REG_A] = 1;
 				  else
 						 vmstate.vm_register [VM_REG_A] = 0;
-				break;
-			case OP_comp_ls:
+				VM_NEXT;
+			VM_CASE(OP_comp_ls):
 				if (vmstate.vm_register [VM_REG_B] < vmstate.vm_register [VM_REG_A]) // note B before A
 					vmstate.vm_register [VM_REG_A] = 1;
 				  else
 						 vmstate.vm_register [VM_REG_A] = 0;
-				break;
-			case OP_comp_lseq:
+				VM_NEXT;
+			VM_CASE(OP_comp_lseq):
 				if (vmstate.vm_register [VM_REG_B] <= vmstate.vm_register [VM_REG_A]) // note B before A
 					vmstate.vm_register [VM_REG_A] = 1;
 				  else
 						 vmstate.vm_register [VM_REG_A] = 0;
-				break;
-			case OP_comp_neq:
+				VM_NEXT;
+			VM_CASE(OP_comp_neq):
 				if (vmstate.vm_register [VM_REG_B] != vmstate.vm_register [VM_REG_A]) // note B before A
 					vmstate.vm_register [VM_REG_A] = 1;
 				  else
 						 vmstate.vm_register [VM_REG_A] = 0;
-				break;
+				VM_NEXT;
 
-			case OP_mulA_num:
+			VM_CASE(OP_mulA_num):
 		  vmstate.instructions_left --;
 				get_next_instr;
 				vmstate.vm_register [VM_REG_A] *= instr;
 #ifdef SHOW_BCODE
     fpr(" %i", instr);
 #endif
-				break;
-			case OP_addA_num:
+				VM_NEXT;
+			VM_CASE(OP_addA_num):
 		  vmstate.instructions_left --;
 				get_next_instr;
 #ifdef SHOW_BCODE
     fpr(" %i", instr);
 #endif
 				vmstate.vm_register [VM_REG_A] += instr;
-				break;
-			case OP_derefA:
+				VM_NEXT;
+			VM_CASE(OP_derefA):
 				if (vmstate.vm_register [VM_REG_A] < 0
 					|| vmstate.vm_register [VM_REG_A] >= MEMORY_SIZE)
 						goto invalid_derefA_error;
 				vmstate.vm_register [VM_REG_A] = memory [vmstate.vm_register [VM_REG_A]];
-				break;
-			case OP_copyA_to_derefB:
+				VM_NEXT;
+			VM_CASE(OP_copyA_to_derefB):
 				if (vmstate.vm_register [VM_REG_B] < 0
 				 || vmstate.vm_register [VM_REG_B] >= MEMORY_SIZE)
 						goto invalid_derefB_error;
 				memory [vmstate.vm_register [VM_REG_B]] = vmstate.vm_register [VM_REG_A];
-				break;
-			case OP_incr_derefA:
+				VM_NEXT;
+			VM_CASE(OP_incr_derefA):
 				if (vmstate.vm_register [VM_REG_A] < 0
 					|| vmstate.vm_register [VM_REG_A] >= MEMORY_SIZE)
 						goto invalid_derefA_error;
 				memory [vmstate.vm_register [VM_REG_A]] ++;
-				break;
-			case OP_decr_derefA:
+				VM_NEXT;
+			VM_CASE(OP_decr_derefA):
 				if (vmstate.vm_register [VM_REG_A] < 0
 					|| vmstate.vm_register [VM_REG_A] >= MEMORY_SIZE)
 						goto invalid_derefA_error;
 				memory [vmstate.vm_register [VM_REG_A]] --;
-				break;
-			case OP_copyAtoB:
+				VM_NEXT;
+			VM_CASE(OP_copyAtoB):
 				vmstate.vm_register [VM_REG_B] = vmstate.vm_register [VM_REG_A];
-				break;
-   case OP_deref_stack_toA:
+				VM_NEXT;
+   VM_CASE(OP_deref_stack_toA):
 				if (vmstate.stack_pos <= 0)
 					goto stack_below_zero_error;
 				if (vmstate.vm_stack [vmstate.stack_pos - 1] < 0
@@ -349,14 +422,14 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 					goto memory_address_error;
 				vmstate.vm_register [VM_REG_A] = memory [vmstate.vm_stack [vmstate.stack_pos - 1]];
 // note: does not change the stack pointer, so the value stays on the stack
-				break;
+				VM_NEXT;
 
-   case OP_push_return_address:
+   VM_CASE(OP_push_return_address):
 				vmstate.vm_stack [vmstate.stack_pos++] = vmstate.bcode_pos + 2;
 				if (vmstate.stack_pos >= VM_STACK_SIZE)
 					goto stack_full_error;
-   	break;
-   case OP_return_sub:
+   	VM_NEXT;
+   VM_CASE(OP_return_sub):
 		  vmstate.instructions_left --;
 				vmstate.stack_pos --;
 				if (vmstate.stack_pos <= 0)
@@ -366,9 +439,9 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 					|| instr >= BCODE_POS_MAX)
 					goto return_sub_bounds_error;
 				vmstate.bcode_pos = instr;
-				break;
+				VM_NEXT;
 
-			case OP_switchA:
+			VM_CASE(OP_switchA):
 		  vmstate.instructions_left -= 5;
 // switchA instruction should be followed by three operands: address of start of jump table, lowest case value, highest case value.
     get_next_instr; // TO DO: optimise these!!
@@ -400,15 +473,15 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 				if (vmstate.bcode_pos < 0
 			  || vmstate.bcode_pos >= BCODE_MAX - 8)
 						goto switch_jump_table_error;
-				break;
+				VM_NEXT;
 
 // remove:
-			case OP_pcomp_eq:
-				break;
-			case OP_pcomp_neq:
-				break;
+			VM_CASE(OP_pcomp_eq):
+				VM_NEXT;
+			VM_CASE(OP_pcomp_neq):
+				VM_NEXT;
 
-			case OP_iftrue_jump:
+			VM_CASE(OP_iftrue_jump):
 		  vmstate.instructions_left --;
 				get_next_instr;
 #ifdef SHOW_BCODE
@@ -418,8 +491,8 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 					goto jump_target_bounds_error;
 				if (vmstate.vm_register [VM_REG_A] != 0)
 				 vmstate.bcode_pos = instr - 1;
-				break;
-			case OP_iffalse_jump:
+				VM_NEXT;
+			VM_CASE(OP_iffalse_jump):
 		  vmstate.instructions_left --;
 				get_next_instr;
 #ifdef SHOW_BCODE
@@ -429,9 +502,10 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 					goto jump_target_bounds_error;
 				if (vmstate.vm_register [VM_REG_A] == 0)
 				 vmstate.bcode_pos = instr - 1;
-				break;
+				VM_NEXT;
 
-			case OP_print:
+			VM_CASE(OP_print):
+				WAIT_FOR_COMMIT(OP_print);
 				{
 //				fpr("\nprint ");
 				i = 0;
@@ -459,9 +533,10 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
     write_text_to_console(CONSOLE_GENERAL, PRINT_COL_WHITE, source_index, source_created_timestamp, print_string);
 //				fpr("[%s]", print_string);
 				}
-				break;
+				VM_NEXT;
 
-			case OP_printA:
+			VM_CASE(OP_printA):
+				WAIT_FOR_COMMIT(OP_printA);
 				{
 					sprintf(print_string, "%i", vmstate.vm_register [VM_REG_A]);
 //				fpr(" [A=%i] ", vmstate.vm_register [VM_REG_A]);
@@ -474,11 +549,11 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 					}
      write_text_to_console(CONSOLE_GENERAL, PRINT_COL_WHITE, source_index2, source_created_timestamp, print_string);
 				}
-				break;
+				VM_NEXT;
 
 
 
-			case OP_bubble:
+			VM_CASE(OP_bubble):
 				{
 //				fpr("\nprint ");
 				i = 0;
@@ -499,17 +574,18 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
     write_text_to_bubble(core->index, w.world_time, print_string);
 //				fpr("[%s]", print_string);
 				}
-				break;
+				VM_NEXT;
 
-			case OP_bubbleA:
+			VM_CASE(OP_bubbleA):
 				{
 					sprintf(print_string, "%i", vmstate.vm_register [VM_REG_A]);
 //				fpr(" [A=%i] ", vmstate.vm_register [VM_REG_A]);
      write_text_to_bubble(core->index, w.world_time, print_string);
 				}
-				break;
+				VM_NEXT;
 
-			case OP_call_object:
+			VM_CASE(OP_call_object):
+				WAIT_FOR_COMMIT(OP_call_object);
 		  vmstate.instructions_left --;
 				get_next_instr; // instr is bounds-checked in call_object()
 #ifdef SHOW_BCODE
@@ -523,9 +599,10 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 				if (vmstate.error_state)
 					goto generic_error;
 // the call may have cost additional instructions. instructions_left will be checked next time through the loop.
-				break;
+				VM_NEXT;
 
-			case OP_call_member:
+			VM_CASE(OP_call_member):
+				WAIT_FOR_COMMIT(OP_call_member);
 		  vmstate.instructions_left --;
 				get_next_instr; // instr is bounds-checked in call_object()
 #ifdef SHOW_BCODE
@@ -539,9 +616,10 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 				if (vmstate.error_state)
 					goto generic_error;
 // the call may have cost additional instructions. instructions_left will be checked next time through the loop.
-				break;
+				VM_NEXT;
 
-			case OP_call_core:
+			VM_CASE(OP_call_core):
+				WAIT_FOR_COMMIT(OP_call_core);
 		  vmstate.instructions_left --;
 				get_next_instr; // instr is bounds-checked in call_core_method()
 #ifdef SHOW_BCODE
@@ -555,9 +633,10 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 				if (vmstate.error_state)
 					goto generic_error;
 // the call may have cost additional instructions. instructions_left will be checked next time through the loop.
-				break;
+				VM_NEXT;
 
-			case OP_call_extern_member:
+			VM_CASE(OP_call_extern_member):
+				WAIT_FOR_COMMIT(OP_call_extern_member);
 		  vmstate.instructions_left --;
 				get_next_instr; // instr is bounds-checked in call_object()
 #ifdef SHOW_BCODE
@@ -568,9 +647,10 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 				if (vmstate.error_state)
 					goto generic_error;
 // the call may have cost additional instructions. instructions_left will be checked next time through the loop.
-				break;
+				VM_NEXT;
 
-			case OP_call_extern_core:
+			VM_CASE(OP_call_extern_core):
+				WAIT_FOR_COMMIT(OP_call_extern_core);
 		  vmstate.instructions_left --;
 				get_next_instr; // instr is bounds-checked in call_object()
 #ifdef SHOW_BCODE
@@ -581,9 +661,10 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 				if (vmstate.error_state)
 					goto generic_error;
 // the call may have cost additional instructions. instructions_left will be checked next time through the loop.
-				break;
+				VM_NEXT;
 
-			case OP_call_std:
+			VM_CASE(OP_call_std):
+				WAIT_FOR_COMMIT(OP_call_std);
 		  vmstate.instructions_left --;
 				get_next_instr; // method type (is bounds-checked in call_object())
 #ifdef SHOW_BCODE
@@ -593,9 +674,10 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 				if (vmstate.error_state)
 					goto generic_error;
 // the call may have cost additional instructions. instructions_left will be checked next time through the loop.
-				break;
+				VM_NEXT;
 
-			case OP_call_std_var:
+			VM_CASE(OP_call_std_var):
+				WAIT_FOR_COMMIT(OP_call_std_var);
 				{
 		   vmstate.instructions_left --;
 				 get_next_instr; // method type
@@ -609,9 +691,10 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
  					goto generic_error;
 // the call may have cost additional instructions. instructions_left will be checked next time through the loop.
 				}
-				break;
+				VM_NEXT;
 
-			case OP_call_uni:
+			VM_CASE(OP_call_uni):
+				WAIT_FOR_COMMIT(OP_call_uni);
 		  vmstate.instructions_left --;
 				get_next_instr; // instr is bounds-checked in call_object()
 #ifdef SHOW_BCODE
@@ -621,9 +704,10 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 				if (vmstate.error_state)
 					goto generic_error;
 // the call may have cost additional instructions. instructions_left will be checked next time through the loop.
-				break;
+				VM_NEXT;
 
-			case OP_call_class:
+			VM_CASE(OP_call_class):
+				WAIT_FOR_COMMIT(OP_call_class);
 		  vmstate.instructions_left --;
 				get_next_instr;
 #ifdef SHOW_BCODE
@@ -633,16 +717,16 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 				if (vmstate.error_state)
 					goto generic_error;
 // the call may have cost additional instructions. instructions_left will be checked next time through the loop.
-				break;
+				VM_NEXT;
 
-			case OP_stop:
+			VM_CASE(OP_stop):
 				goto finished_execution;
 
-			case OP_terminate:
+			VM_CASE(OP_terminate):
 				core->self_destruct = 1; // core will self-destruct when this function returns
 				goto finished_execution;
 
-   default:
+   VM_DEFAULT:
 				goto invalid_instruction_error;
 
 		}
@@ -654,49 +738,49 @@ void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memo
 finished_execution:
 	core->instructions_used = core->instructions_per_cycle - vmstate.instructions_left;
 //	fpr("\n core %i instructions_left %i (used %i)", core->index, vmstate.instructions_left, INSTRUCTION_COUNT - vmstate.instructions_left);
- return; // success
+ return 0; // success
 
 bcode_bounds_error:
 	core->instructions_used = core->instructions_per_cycle - vmstate.instructions_left;
 	if (w.debug_mode)
 		print_execution_error("execution out of bounds", 0, 0);
- return;
+ return 0;
 
 memory_address_error:
 	core->instructions_used = core->instructions_per_cycle - vmstate.instructions_left;
 	if (w.debug_mode)
 		print_execution_error("invalid memory access", 1, instr);
- return;
+ return 0;
 
 invalid_instruction_error:
 	core->instructions_used = core->instructions_per_cycle - vmstate.instructions_left;
 	if (w.debug_mode)
 		print_execution_error("invalid instruction", 1, instr);
- return;
+ return 0;
 
 out_of_instructions_error:
 	core->instructions_used = core->instructions_per_cycle;// - vmstate.instructions_left;
 	if (w.debug_mode)
 		print_execution_error("instructions exhausted", 0, 0);
- return;
+ return 0;
 
 jump_target_bounds_error:
 	core->instructions_used = core->instructions_per_cycle - vmstate.instructions_left;
 	if (w.debug_mode)
 		print_execution_error("invalid jump target", 1, vmstate.bcode->op [vmstate.bcode_pos]);
- return;
+ return 0;
 
 stack_full_error:
 	core->instructions_used = core->instructions_per_cycle - vmstate.instructions_left;
 	if (w.debug_mode)
 		print_execution_error("stack overflow", 0, 0);
- return;
+ return 0;
 
 stack_below_zero_error:
 	core->instructions_used = core->instructions_per_cycle - vmstate.instructions_left;
 	if (w.debug_mode)
 		print_execution_error("stack base reached", 0, 0);
- return;
+ return 0;
 
 #ifdef DEBUG_MODE
 core_called_by_non_core_error:
@@ -704,21 +788,21 @@ core_called_by_non_core_error:
 	if (w.debug_mode)
 		print_execution_error("INVALID ERROR?!", 0, 0); // shouldn't happen - no non-core programs
 // fpr("\nError: self core method called by non-core program at bcode %i", vmstate.bcode_pos);
- return;
+ return 0;
 
 member_called_by_non_core_error:
 	core->instructions_used = core->instructions_per_cycle - vmstate.instructions_left;
 	if (w.debug_mode)
 		print_execution_error("INVALID ERROR?!", 0, 0); // shouldn't happen - no non-core programs
 // fpr("\nError: self member method called by non-core program at bcode %i", vmstate.bcode_pos);
- return;
+ return 0;
 
 object_called_by_non_core_error:
 	core->instructions_used = core->instructions_per_cycle - vmstate.instructions_left;
 	if (w.debug_mode)
 		print_execution_error("INVALID ERROR?!", 0, 0); // shouldn't happen - no non-core programs
 // fpr("\nError: self object method called by non-core program at bcode %i", vmstate.bcode_pos);
- return;
+ return 0;
 #endif
 
 invalid_derefB_error:
@@ -726,31 +810,37 @@ invalid_derefB_error:
 	if (w.debug_mode)
 		print_execution_error("invalid B dereference", 1, vmstate.vm_register [VM_REG_B]);
 // fpr("\nError: register B dereference is out of bounds (%i) at bcode %i", vmstate.vm_register [VM_REG_B], vmstate.bcode_pos);
- return;
+ return 0;
 
 invalid_derefA_error:
 	core->instructions_used = core->instructions_per_cycle - vmstate.instructions_left;
 	if (w.debug_mode)
 		print_execution_error("invalid A dereference", 1, vmstate.vm_register [VM_REG_A]);
 // fpr("\nError: register A dereference is out of bounds (%i) at bcode %i", vmstate.vm_register [VM_REG_A], vmstate.bcode_pos);
- return;
+ return 0;
 
 return_sub_bounds_error:
 	core->instructions_used = core->instructions_per_cycle - vmstate.instructions_left;
 	if (w.debug_mode)
 		print_execution_error("invalid return address", 1, instr);
 //	fpr("\nError: subroutine return value %i out of bounds", instr);
-	return;
+	return 0;
 
 switch_jump_table_error:
 	core->instructions_used = core->instructions_per_cycle - vmstate.instructions_left;
 	 if (w.debug_mode)
 		 print_execution_error("error in switch jump table", 0, 0); // this should be caught by the compiler
-		return;
+		return 0;
 
 generic_error:
 	core->instructions_used = core->instructions_per_cycle - vmstate.instructions_left;
-	return; // used when e.g. calling an object causes a fatal error, and an error essage has already been written.
+	return 0; // used when e.g. calling an object causes a fatal error, and an error essage has already been written.
+
+suspend_for_commit:
+// the call instruction will be fetched (and counted) again when execution resumes:
+	vmstate.bcode_pos --;
+	vmstate.instructions_left ++;
+	return 1;
 
 }
 
@@ -758,7 +848,7 @@ generic_error:
 static void	print_execution_error(const char* error_message, int values, int value1)
 {
 
- static char ex_error_string [120];
+ static THREAD_LOCAL char ex_error_string [120];
 
  if (vmstate.bcode_pos < 0
 		|| vmstate.bcode_pos >= BCODE_MAX)
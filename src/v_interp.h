@@ -32,7 +32,8 @@ struct vmstate_struct
 };
 
 
-void execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memory);
+int execute_bcode(struct core_struct* core, struct bcode_struct* bc, s16b* memory);
+int resume_bcode(struct core_struct* core, struct vmstate_struct* saved_vmstate);
 void run_bcode_watch(void);
 void init_bcode_execution_for_watch(struct core_struct* core, struct bcode_struct* bc, s16b* memory);
 void finish_executing_bcode_in_watch(void);
@@ -16,6 +16,8 @@
 #include "x_init.h"
 #include "x_synth.h"
 #include "x_music.h"
+#include "v_interp.h"
+#include "g_proc_par.h"
 
 extern struct game_struct game;
 extern struct view_struct view;
@@ -87,6 +89,13 @@ void play_interface_sound(int s, int pitch)
 void play_game_sound(int s, int pitch, int vol, int priority, al_fixed x, al_fixed y)
 {
 
+ if (current_commit != NULL)
+	{
+// called by a core executing in the parallel phase (see g_proc_par.c):
+		defer_game_sound(s, pitch, vol, priority, x, y);
+		return;
+	}
+
  if (settings.sound_on == 0
   || game.fast_forward != FAST_FORWARD_OFF
   || abs(x - view.camera_x) > (view.centre_x_zoomed + al_itofix(100))